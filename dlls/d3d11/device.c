@@ -29,1822 +29,5388 @@ static const struct wined3d_parent_ops d3d_null_wined3d_parent_ops =
     d3d_null_wined3d_object_destroyed,
 };
 
-/* ID3D11DeviceContext - immediate context methods */
+/* ID3D11CommandList methods */
+
+enum d3d11_deferred_op
+{
+    DEFERRED_OP_SET_SHADER,
+    DEFERRED_OP_SET_SHADER_RESOURCES,
+    DEFERRED_OP_SET_SAMPLERS,
+    DEFERRED_OP_SET_CONSTANT_BUFFERS,
+    DEFERRED_OP_SET_CS_UNORDERED_ACCESS_VIEWS,
+    DEFERRED_OP_IA_SET_INPUT_LAYOUT,
+    DEFERRED_OP_IA_SET_VERTEX_BUFFERS,
+    DEFERRED_OP_IA_SET_INDEX_BUFFER,
+    DEFERRED_OP_IA_SET_PRIMITIVE_TOPOLOGY,
+    DEFERRED_OP_OM_SET_RENDER_TARGETS,
+    DEFERRED_OP_OM_SET_BLEND_STATE,
+    DEFERRED_OP_OM_SET_DEPTH_STENCIL_STATE,
+    DEFERRED_OP_SO_SET_TARGETS,
+    DEFERRED_OP_RS_SET_STATE,
+    DEFERRED_OP_RS_SET_VIEWPORTS,
+    DEFERRED_OP_RS_SET_SCISSOR_RECTS,
+    DEFERRED_OP_SET_PREDICATION,
+    DEFERRED_OP_DRAW,
+    DEFERRED_OP_DRAW_INDEXED,
+    DEFERRED_OP_DRAW_INSTANCED,
+    DEFERRED_OP_DRAW_INDEXED_INSTANCED,
+    DEFERRED_OP_DRAW_INSTANCED_INDIRECT,
+    DEFERRED_OP_DRAW_INDEXED_INSTANCED_INDIRECT,
+    DEFERRED_OP_DRAW_AUTO,
+    DEFERRED_OP_DISPATCH,
+    DEFERRED_OP_DISPATCH_INDIRECT,
+    DEFERRED_OP_COPY_SUBRESOURCE_REGION,
+    DEFERRED_OP_COPY_RESOURCE,
+    DEFERRED_OP_COPY_STRUCTURE_COUNT,
+    DEFERRED_OP_RESOLVE_SUBRESOURCE,
+    DEFERRED_OP_UPDATE_SUBRESOURCE,
+    DEFERRED_OP_MAP,
+    DEFERRED_OP_CLEAR_RENDER_TARGET_VIEW,
+    DEFERRED_OP_CLEAR_UNORDERED_ACCESS_VIEW_UINT,
+    DEFERRED_OP_CLEAR_UNORDERED_ACCESS_VIEW_FLOAT,
+    DEFERRED_OP_CLEAR_DEPTH_STENCIL_VIEW,
+    DEFERRED_OP_GENERATE_MIPS,
+    DEFERRED_OP_BEGIN,
+    DEFERRED_OP_END,
+    DEFERRED_OP_CLEAR_STATE,
+    DEFERRED_OP_EXECUTE_COMMAND_LIST,
+};
 
-static inline struct d3d11_immediate_context *impl_from_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
+/* Packets are stored back to back in the command list, each one starting
+ * with a struct d3d11_deferred_packet and padded to pointer alignment. Every
+ * object referenced by a packet holds a reference owned by the command list. */
+struct d3d11_deferred_packet
 {
-    return CONTAINING_RECORD(iface, struct d3d11_immediate_context, ID3D11DeviceContext1_iface);
-}
+    enum d3d11_deferred_op op;
+    unsigned int size;
+};
 
-static inline struct d3d_device *device_from_immediate_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
+/* Packets referencing at most one object, e.g. shaders and state objects. */
+struct d3d11_deferred_object_packet
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
-    return CONTAINING_RECORD(context, struct d3d_device, immediate_context);
-}
+    struct d3d11_deferred_packet packet;
+    IUnknown *object;
+    unsigned int value;
+    unsigned int offset;
+};
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_QueryInterface(ID3D11DeviceContext1 *iface,
-        REFIID iid, void **out)
+/* Slot ranges of bound objects, optionally followed by "value_count" UINT
+ * arrays of "count" elements each (strides, offsets, initial counts). */
+struct d3d11_deferred_slots_packet
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_packet packet;
+    enum wined3d_shader_type shader_type;
+    unsigned int start_slot;
+    unsigned int count;
+    unsigned int value_count;
+    IUnknown *objects[1];
+};
 
-    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+struct d3d11_deferred_render_targets_packet
+{
+    struct d3d11_deferred_packet packet;
+    unsigned int rtv_count;
+    IUnknown *dsv;
+    unsigned int uav_start_slot;
+    unsigned int uav_count;
+    BOOL initial_counts;
+    /* rtv_count render target views, followed by uav_count unordered access
+     * views and their initial counts. */
+    IUnknown *objects[1];
+};
 
-    if (IsEqualGUID(iid, &IID_ID3D11DeviceContext1)
-            || IsEqualGUID(iid, &IID_ID3D11DeviceContext)
-            || IsEqualGUID(iid, &IID_ID3D11DeviceChild)
-            || IsEqualGUID(iid, &IID_IUnknown))
-    {
-        *out = &context->ID3D11DeviceContext1_iface;
-    }
-    else if (IsEqualGUID(iid, &IID_ID3D11Multithread))
+struct d3d11_deferred_blend_state_packet
+{
+    struct d3d11_deferred_packet packet;
+    IUnknown *state;
+    float blend_factor[4];
+    unsigned int sample_mask;
+};
+
+struct d3d11_deferred_rects_packet
+{
+    struct d3d11_deferred_packet packet;
+    unsigned int count;
+    union
     {
-        *out = &context->ID3D11Multithread_iface;
-    }
-    else
+        D3D11_VIEWPORT viewports[1];
+        D3D11_RECT rects[1];
+    } u;
+};
+
+struct d3d11_deferred_draw_packet
+{
+    struct d3d11_deferred_packet packet;
+    unsigned int args[5];
+};
+
+struct d3d11_deferred_copy_packet
+{
+    struct d3d11_deferred_packet packet;
+    IUnknown *dst;
+    unsigned int dst_idx;
+    unsigned int dst_x, dst_y, dst_z;
+    IUnknown *src;
+    unsigned int src_idx;
+    BOOL has_box;
+    D3D11_BOX box;
+    unsigned int flags;
+};
+
+struct d3d11_deferred_update_packet
+{
+    struct d3d11_deferred_packet packet;
+    IUnknown *resource;
+    unsigned int subresource_idx;
+    BOOL has_box;
+    D3D11_BOX box;
+    unsigned int row_pitch;
+    unsigned int depth_pitch;
+    unsigned int flags;
+    BYTE data[1];
+};
+
+/* Memory handed out by Map() on a deferred context. It is allocated
+ * separately from the packet stream, so that it stays valid while the
+ * application keeps recording, and uploaded through a WRITE_DISCARD map of
+ * the real resource when the packet is replayed. */
+struct d3d11_deferred_map
+{
+    struct list entry;
+    IUnknown *resource;
+    unsigned int subresource_idx;
+    unsigned int row_size;
+    unsigned int row_count;
+    unsigned int slice_count;
+    unsigned int row_pitch;
+    unsigned int slice_pitch;
+    BYTE *data;
+};
+
+struct d3d11_deferred_map_packet
+{
+    struct d3d11_deferred_packet packet;
+    struct d3d11_deferred_map *map;
+};
+
+struct d3d11_deferred_clear_packet
+{
+    struct d3d11_deferred_packet packet;
+    IUnknown *view;
+    union
     {
-        WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
-        *out = NULL;
-        return E_NOINTERFACE;
-    }
+        float f[4];
+        UINT u[4];
+    } values;
+    unsigned int flags;
+    float depth;
+    UINT8 stencil;
+};
 
-    ID3D11DeviceContext1_AddRef(iface);
-    return S_OK;
+struct d3d11_command_list
+{
+    ID3D11CommandList ID3D11CommandList_iface;
+    LONG refcount;
+
+    struct wined3d_private_store private_store;
+    ID3D11Device2 *device;
+
+    BYTE *data;
+    SIZE_T data_size;
+    SIZE_T data_capacity;
+    IUnknown **refs;
+    SIZE_T ref_count;
+    SIZE_T refs_capacity;
+    struct list maps;
+    BOOL failed;
+};
+
+static const struct ID3D11CommandListVtbl d3d11_command_list_vtbl;
+
+static inline struct d3d11_command_list *impl_from_ID3D11CommandList(ID3D11CommandList *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d11_command_list, ID3D11CommandList_iface);
 }
 
-static ULONG STDMETHODCALLTYPE d3d11_immediate_context_AddRef(ID3D11DeviceContext1 *iface)
+static struct d3d11_command_list *unsafe_impl_from_ID3D11CommandList(ID3D11CommandList *iface)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    ULONG refcount = InterlockedIncrement(&context->refcount);
+    if (!iface)
+        return NULL;
+    assert(iface->lpVtbl == &d3d11_command_list_vtbl);
+    return impl_from_ID3D11CommandList(iface);
+}
 
-    TRACE("%p increasing refcount to %u.\n", context, refcount);
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_QueryInterface(ID3D11CommandList *iface,
+        REFIID iid, void **out)
+{
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
 
-    if (refcount == 1)
+    if (IsEqualGUID(iid, &IID_ID3D11CommandList)
+            || IsEqualGUID(iid, &IID_ID3D11DeviceChild)
+            || IsEqualGUID(iid, &IID_IUnknown))
     {
-        ID3D11Device2_AddRef(&device->ID3D11Device2_iface);
+        ID3D11CommandList_AddRef(iface);
+        *out = iface;
+        return S_OK;
     }
 
-    return refcount;
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
+
+    *out = NULL;
+    return E_NOINTERFACE;
 }
 
-static ULONG STDMETHODCALLTYPE d3d11_immediate_context_Release(ID3D11DeviceContext1 *iface)
+static ULONG STDMETHODCALLTYPE d3d11_command_list_AddRef(ID3D11CommandList *iface)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    ULONG refcount = InterlockedDecrement(&context->refcount);
-
-    TRACE("%p decreasing refcount to %u.\n", context, refcount);
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+    ULONG refcount = InterlockedIncrement(&list->refcount);
 
-    if (!refcount)
-    {
-        ID3D11Device2_Release(&device->ID3D11Device2_iface);
-    }
+    TRACE("%p increasing refcount to %u.\n", list, refcount);
 
     return refcount;
 }
 
-static void d3d11_immediate_context_get_constant_buffers(ID3D11DeviceContext1 *iface,
-        enum wined3d_shader_type type, UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+static void d3d11_command_list_destroy(struct d3d11_command_list *list)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_map *map, *next;
+    ID3D11Device2 *device = list->device;
+    SIZE_T i;
 
-    wined3d_mutex_lock();
-    for (i = 0; i < buffer_count; ++i)
+    LIST_FOR_EACH_ENTRY_SAFE(map, next, &list->maps, struct d3d11_deferred_map, entry)
     {
-        struct wined3d_buffer *wined3d_buffer;
-        struct d3d_buffer *buffer_impl;
-
-        if (!(wined3d_buffer = wined3d_device_get_constant_buffer(device->wined3d_device,
-                type, start_slot + i)))
-        {
-            buffers[i] = NULL;
-            continue;
-        }
-
-        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
-        buffers[i] = &buffer_impl->ID3D11Buffer_iface;
-        ID3D11Buffer_AddRef(buffers[i]);
+        heap_free(map);
     }
-    wined3d_mutex_unlock();
+    for (i = 0; i < list->ref_count; ++i)
+        IUnknown_Release(list->refs[i]);
+    heap_free(list->refs);
+    heap_free(list->data);
+    wined3d_private_store_cleanup(&list->private_store);
+    heap_free(list);
+
+    ID3D11Device2_Release(device);
 }
 
-static void d3d11_immediate_context_set_constant_buffers(ID3D11DeviceContext1 *iface,
-        enum wined3d_shader_type type, UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+static ULONG STDMETHODCALLTYPE d3d11_command_list_Release(ID3D11CommandList *iface)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+    ULONG refcount = InterlockedDecrement(&list->refcount);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < buffer_count; ++i)
-    {
-        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+    TRACE("%p decreasing refcount to %u.\n", list, refcount);
 
-        wined3d_device_set_constant_buffer(device->wined3d_device, type, start_slot + i,
-                buffer ? buffer->wined3d_buffer : NULL);
-    }
-    wined3d_mutex_unlock();
+    if (!refcount)
+        d3d11_command_list_destroy(list);
+
+    return refcount;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GetDevice(ID3D11DeviceContext1 *iface, ID3D11Device **device)
+static void STDMETHODCALLTYPE d3d11_command_list_GetDevice(ID3D11CommandList *iface, ID3D11Device **device)
 {
-    struct d3d_device *device_object = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
 
     TRACE("iface %p, device %p.\n", iface, device);
 
-    *device = (ID3D11Device *)&device_object->ID3D11Device2_iface;
+    *device = (ID3D11Device *)list->device;
     ID3D11Device_AddRef(*device);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_GetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_GetPrivateData(ID3D11CommandList *iface, REFGUID guid,
         UINT *data_size, void *data)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
 
     TRACE("iface %p, guid %s, data_size %p, data %p.\n", iface, debugstr_guid(guid), data_size, data);
 
-    return d3d_get_private_data(&context->private_store, guid, data_size, data);
+    return d3d_get_private_data(&list->private_store, guid, data_size, data);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_SetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_SetPrivateData(ID3D11CommandList *iface, REFGUID guid,
         UINT data_size, const void *data)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
 
     TRACE("iface %p, guid %s, data_size %u, data %p.\n", iface, debugstr_guid(guid), data_size, data);
 
-    return d3d_set_private_data(&context->private_store, guid, data_size, data);
+    return d3d_set_private_data(&list->private_store, guid, data_size, data);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_SetPrivateDataInterface(ID3D11DeviceContext1 *iface,
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_SetPrivateDataInterface(ID3D11CommandList *iface,
         REFGUID guid, const IUnknown *data)
 {
-    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
 
     TRACE("iface %p, guid %s, data %p.\n", iface, debugstr_guid(guid), data);
 
-    return d3d_set_private_data_interface(&context->private_store, guid, data);
+    return d3d_set_private_data_interface(&list->private_store, guid, data);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetConstantBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+static UINT STDMETHODCALLTYPE d3d11_command_list_GetContextFlags(ID3D11CommandList *iface)
 {
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
+    TRACE("iface %p.\n", iface);
 
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot,
-            buffer_count, buffers);
+    return 0;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetShaderResources(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+static const struct ID3D11CommandListVtbl d3d11_command_list_vtbl =
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
-            iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
-
-        wined3d_device_set_ps_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
-    }
-    wined3d_mutex_unlock();
-}
+    /* IUnknown methods */
+    d3d11_command_list_QueryInterface,
+    d3d11_command_list_AddRef,
+    d3d11_command_list_Release,
+    /* ID3D11DeviceChild methods */
+    d3d11_command_list_GetDevice,
+    d3d11_command_list_GetPrivateData,
+    d3d11_command_list_SetPrivateData,
+    d3d11_command_list_SetPrivateDataInterface,
+    /* ID3D11CommandList methods */
+    d3d11_command_list_GetContextFlags,
+};
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetShader(ID3D11DeviceContext1 *iface,
-        ID3D11PixelShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+static HRESULT d3d11_command_list_create(struct d3d_device *device, struct d3d11_command_list **list)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_pixel_shader *ps = unsafe_impl_from_ID3D11PixelShader(shader);
+    struct d3d11_command_list *object;
 
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
-            iface, shader, class_instances, class_instance_count);
+    if (!(object = heap_alloc_zero(sizeof(*object))))
+        return E_OUTOFMEMORY;
 
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
+    object->ID3D11CommandList_iface.lpVtbl = &d3d11_command_list_vtbl;
+    object->refcount = 1;
+    wined3d_private_store_init(&object->private_store);
+    list_init(&object->maps);
+    ID3D11Device2_AddRef(object->device = &device->ID3D11Device2_iface);
 
-    wined3d_mutex_lock();
-    wined3d_device_set_pixel_shader(device->wined3d_device, ps ? ps->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+    *list = object;
+
+    return S_OK;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+static BOOL d3d11_command_list_reserve(void **elements, SIZE_T *capacity, SIZE_T count, SIZE_T size)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    SIZE_T max_capacity, new_capacity;
+    void *new_elements;
 
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
+    if (count <= *capacity)
+        return TRUE;
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+    max_capacity = ~(SIZE_T)0 / size;
+    if (count > max_capacity)
+        return FALSE;
 
-        wined3d_device_set_ps_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
-    }
-    wined3d_mutex_unlock();
+    new_capacity = max(64, *capacity);
+    while (new_capacity < count && new_capacity <= max_capacity / 2)
+        new_capacity *= 2;
+    if (new_capacity < count)
+        new_capacity = max_capacity;
+
+    if (!(new_elements = heap_realloc(*elements, new_capacity * size)))
+        return FALSE;
+
+    *elements = new_elements;
+    *capacity = new_capacity;
+    return TRUE;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetShader(ID3D11DeviceContext1 *iface,
-        ID3D11VertexShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+static void *d3d11_command_list_require_space(struct d3d11_command_list *list,
+        enum d3d11_deferred_op op, SIZE_T size)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_vertex_shader *vs = unsafe_impl_from_ID3D11VertexShader(shader);
+    struct d3d11_deferred_packet *packet;
 
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
-            iface, shader, class_instances, class_instance_count);
+    size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    if (list->failed || !d3d11_command_list_reserve((void **)&list->data, &list->data_capacity,
+            list->data_size + size, sizeof(*list->data)))
+    {
+        ERR("Failed to allocate %lu bytes for a deferred packet.\n", (unsigned long)size);
+        list->failed = TRUE;
+        return NULL;
+    }
 
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
+    packet = (struct d3d11_deferred_packet *)&list->data[list->data_size];
+    memset(packet, 0, size);
+    packet->op = op;
+    packet->size = size;
+    list->data_size += size;
 
-    wined3d_mutex_lock();
-    wined3d_device_set_vertex_shader(device->wined3d_device, vs ? vs->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+    return packet;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexed(ID3D11DeviceContext1 *iface,
-        UINT index_count, UINT start_index_location, INT base_vertex_location)
+static IUnknown *d3d11_command_list_add_ref(struct d3d11_command_list *list, void *object)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    IUnknown *unknown = object;
 
-    TRACE("iface %p, index_count %u, start_index_location %u, base_vertex_location %d.\n",
-            iface, index_count, start_index_location, base_vertex_location);
+    if (!unknown)
+        return NULL;
 
-    wined3d_mutex_lock();
-    wined3d_device_set_base_vertex_index(device->wined3d_device, base_vertex_location);
-    wined3d_device_draw_indexed_primitive(device->wined3d_device, start_index_location, index_count);
-    wined3d_mutex_unlock();
+    if (!d3d11_command_list_reserve((void **)&list->refs, &list->refs_capacity,
+            list->ref_count + 1, sizeof(*list->refs)))
+    {
+        ERR("Failed to reference object %p.\n", unknown);
+        list->failed = TRUE;
+        return unknown;
+    }
+
+    IUnknown_AddRef(unknown);
+    list->refs[list->ref_count++] = unknown;
+
+    return unknown;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_Draw(ID3D11DeviceContext1 *iface,
-        UINT vertex_count, UINT start_vertex_location)
+static void d3d11_deferred_map_upload(ID3D11DeviceContext1 *context, const struct d3d11_deferred_map *map)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    const BYTE *src;
+    unsigned int i, j;
+    BYTE *dst;
+    HRESULT hr;
 
-    TRACE("iface %p, vertex_count %u, start_vertex_location %u.\n",
-            iface, vertex_count, start_vertex_location);
+    if (FAILED(hr = ID3D11DeviceContext1_Map(context, (ID3D11Resource *)map->resource,
+            map->subresource_idx, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+    {
+        WARN("Failed to map resource %p, hr %#x.\n", map->resource, hr);
+        return;
+    }
 
-    wined3d_mutex_lock();
-    wined3d_device_draw_primitive(device->wined3d_device, start_vertex_location, vertex_count);
-    wined3d_mutex_unlock();
+    for (i = 0; i < map->slice_count; ++i)
+    {
+        src = &map->data[i * map->slice_pitch];
+        dst = (BYTE *)mapped.pData + i * mapped.DepthPitch;
+        if (map->row_pitch == mapped.RowPitch)
+        {
+            memcpy(dst, src, (map->row_count - 1) * map->row_pitch + map->row_size);
+            continue;
+        }
+        for (j = 0; j < map->row_count; ++j)
+            memcpy(&dst[j * mapped.RowPitch], &src[j * map->row_pitch], map->row_size);
+    }
+
+    ID3D11DeviceContext1_Unmap(context, (ID3D11Resource *)map->resource, map->subresource_idx);
+}
+
+static void d3d11_context_set_shader(ID3D11DeviceContext1 *context,
+        enum wined3d_shader_type type, IUnknown *shader)
+{
+    switch (type)
+    {
+        case WINED3D_SHADER_TYPE_VERTEX:
+            ID3D11DeviceContext1_VSSetShader(context, (ID3D11VertexShader *)shader, NULL, 0);
+            break;
+        case WINED3D_SHADER_TYPE_HULL:
+            ID3D11DeviceContext1_HSSetShader(context, (ID3D11HullShader *)shader, NULL, 0);
+            break;
+        case WINED3D_SHADER_TYPE_DOMAIN:
+            ID3D11DeviceContext1_DSSetShader(context, (ID3D11DomainShader *)shader, NULL, 0);
+            break;
+        case WINED3D_SHADER_TYPE_GEOMETRY:
+            ID3D11DeviceContext1_GSSetShader(context, (ID3D11GeometryShader *)shader, NULL, 0);
+            break;
+        case WINED3D_SHADER_TYPE_PIXEL:
+            ID3D11DeviceContext1_PSSetShader(context, (ID3D11PixelShader *)shader, NULL, 0);
+            break;
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            ID3D11DeviceContext1_CSSetShader(context, (ID3D11ComputeShader *)shader, NULL, 0);
+            break;
+        default:
+            ERR("Invalid shader type %#x.\n", type);
+            break;
+    }
+}
+
+static void d3d11_context_set_shader_resources(ID3D11DeviceContext1 *context,
+        enum wined3d_shader_type type, UINT start_slot, UINT count, IUnknown *const *objects)
+{
+    ID3D11ShaderResourceView *const *views = (ID3D11ShaderResourceView *const *)objects;
+
+    switch (type)
+    {
+        case WINED3D_SHADER_TYPE_VERTEX:
+            ID3D11DeviceContext1_VSSetShaderResources(context, start_slot, count, views);
+            break;
+        case WINED3D_SHADER_TYPE_HULL:
+            ID3D11DeviceContext1_HSSetShaderResources(context, start_slot, count, views);
+            break;
+        case WINED3D_SHADER_TYPE_DOMAIN:
+            ID3D11DeviceContext1_DSSetShaderResources(context, start_slot, count, views);
+            break;
+        case WINED3D_SHADER_TYPE_GEOMETRY:
+            ID3D11DeviceContext1_GSSetShaderResources(context, start_slot, count, views);
+            break;
+        case WINED3D_SHADER_TYPE_PIXEL:
+            ID3D11DeviceContext1_PSSetShaderResources(context, start_slot, count, views);
+            break;
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            ID3D11DeviceContext1_CSSetShaderResources(context, start_slot, count, views);
+            break;
+        default:
+            ERR("Invalid shader type %#x.\n", type);
+            break;
+    }
+}
+
+static void d3d11_context_set_samplers(ID3D11DeviceContext1 *context,
+        enum wined3d_shader_type type, UINT start_slot, UINT count, IUnknown *const *objects)
+{
+    ID3D11SamplerState *const *samplers = (ID3D11SamplerState *const *)objects;
+
+    switch (type)
+    {
+        case WINED3D_SHADER_TYPE_VERTEX:
+            ID3D11DeviceContext1_VSSetSamplers(context, start_slot, count, samplers);
+            break;
+        case WINED3D_SHADER_TYPE_HULL:
+            ID3D11DeviceContext1_HSSetSamplers(context, start_slot, count, samplers);
+            break;
+        case WINED3D_SHADER_TYPE_DOMAIN:
+            ID3D11DeviceContext1_DSSetSamplers(context, start_slot, count, samplers);
+            break;
+        case WINED3D_SHADER_TYPE_GEOMETRY:
+            ID3D11DeviceContext1_GSSetSamplers(context, start_slot, count, samplers);
+            break;
+        case WINED3D_SHADER_TYPE_PIXEL:
+            ID3D11DeviceContext1_PSSetSamplers(context, start_slot, count, samplers);
+            break;
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            ID3D11DeviceContext1_CSSetSamplers(context, start_slot, count, samplers);
+            break;
+        default:
+            ERR("Invalid shader type %#x.\n", type);
+            break;
+    }
+}
+
+static void d3d11_context_set_constant_buffers(ID3D11DeviceContext1 *context,
+        enum wined3d_shader_type type, UINT start_slot, UINT count, IUnknown *const *objects)
+{
+    ID3D11Buffer *const *buffers = (ID3D11Buffer *const *)objects;
+
+    switch (type)
+    {
+        case WINED3D_SHADER_TYPE_VERTEX:
+            ID3D11DeviceContext1_VSSetConstantBuffers(context, start_slot, count, buffers);
+            break;
+        case WINED3D_SHADER_TYPE_HULL:
+            ID3D11DeviceContext1_HSSetConstantBuffers(context, start_slot, count, buffers);
+            break;
+        case WINED3D_SHADER_TYPE_DOMAIN:
+            ID3D11DeviceContext1_DSSetConstantBuffers(context, start_slot, count, buffers);
+            break;
+        case WINED3D_SHADER_TYPE_GEOMETRY:
+            ID3D11DeviceContext1_GSSetConstantBuffers(context, start_slot, count, buffers);
+            break;
+        case WINED3D_SHADER_TYPE_PIXEL:
+            ID3D11DeviceContext1_PSSetConstantBuffers(context, start_slot, count, buffers);
+            break;
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            ID3D11DeviceContext1_CSSetConstantBuffers(context, start_slot, count, buffers);
+            break;
+        default:
+            ERR("Invalid shader type %#x.\n", type);
+            break;
+    }
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_Map(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
-        UINT subresource_idx, D3D11_MAP map_type, UINT map_flags, D3D11_MAPPED_SUBRESOURCE *mapped_subresource)
+/* Replays a command list on the immediate context. The packets are turned
+ * back into calls on "context", which emit the corresponding wined3d_cs
+ * packets, so the whole list ends up in the command stream in one go. */
+static void d3d11_command_list_execute(struct d3d11_command_list *list, ID3D11DeviceContext1 *context)
 {
-    struct wined3d_resource *wined3d_resource;
-    struct wined3d_map_desc map_desc;
-    HRESULT hr;
+    const struct d3d11_deferred_packet *packet;
+    SIZE_T offset;
 
-    TRACE("iface %p, resource %p, subresource_idx %u, map_type %u, map_flags %#x, mapped_subresource %p.\n",
-            iface, resource, subresource_idx, map_type, map_flags, mapped_subresource);
+    for (offset = 0; offset < list->data_size; offset += packet->size)
+    {
+        packet = (const struct d3d11_deferred_packet *)&list->data[offset];
 
-    if (map_flags)
-        FIXME("Ignoring map_flags %#x.\n", map_flags);
+        switch (packet->op)
+        {
+            case DEFERRED_OP_SET_SHADER:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                d3d11_context_set_shader(context, p->value, p->object);
+                break;
+            }
+
+            case DEFERRED_OP_SET_SHADER_RESOURCES:
+            {
+                const struct d3d11_deferred_slots_packet *p = (const void *)packet;
+                d3d11_context_set_shader_resources(context, p->shader_type, p->start_slot, p->count, p->objects);
+                break;
+            }
+
+            case DEFERRED_OP_SET_SAMPLERS:
+            {
+                const struct d3d11_deferred_slots_packet *p = (const void *)packet;
+                d3d11_context_set_samplers(context, p->shader_type, p->start_slot, p->count, p->objects);
+                break;
+            }
+
+            case DEFERRED_OP_SET_CONSTANT_BUFFERS:
+            {
+                const struct d3d11_deferred_slots_packet *p = (const void *)packet;
+                d3d11_context_set_constant_buffers(context, p->shader_type, p->start_slot, p->count, p->objects);
+                break;
+            }
+
+            case DEFERRED_OP_SET_CS_UNORDERED_ACCESS_VIEWS:
+            {
+                const struct d3d11_deferred_slots_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_CSSetUnorderedAccessViews(context, p->start_slot, p->count,
+                        (ID3D11UnorderedAccessView *const *)p->objects,
+                        p->value_count ? (const UINT *)&p->objects[p->count] : NULL);
+                break;
+            }
+
+            case DEFERRED_OP_IA_SET_INPUT_LAYOUT:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_IASetInputLayout(context, (ID3D11InputLayout *)p->object);
+                break;
+            }
+
+            case DEFERRED_OP_IA_SET_VERTEX_BUFFERS:
+            {
+                const struct d3d11_deferred_slots_packet *p = (const void *)packet;
+                const UINT *strides = (const UINT *)&p->objects[p->count];
+                ID3D11DeviceContext1_IASetVertexBuffers(context, p->start_slot, p->count,
+                        (ID3D11Buffer *const *)p->objects, strides, &strides[p->count]);
+                break;
+            }
+
+            case DEFERRED_OP_IA_SET_INDEX_BUFFER:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_IASetIndexBuffer(context, (ID3D11Buffer *)p->object, p->value, p->offset);
+                break;
+            }
+
+            case DEFERRED_OP_IA_SET_PRIMITIVE_TOPOLOGY:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_IASetPrimitiveTopology(context, p->value);
+                break;
+            }
+
+            case DEFERRED_OP_OM_SET_RENDER_TARGETS:
+            {
+                const struct d3d11_deferred_render_targets_packet *p = (const void *)packet;
+                unsigned int rtv_count = p->rtv_count == D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL
+                        ? 0 : p->rtv_count;
+                unsigned int uav_count = p->uav_count == D3D11_KEEP_UNORDERED_ACCESS_VIEWS
+                        ? 0 : p->uav_count;
+
+                ID3D11DeviceContext1_OMSetRenderTargetsAndUnorderedAccessViews(context, p->rtv_count,
+                        (ID3D11RenderTargetView *const *)p->objects, (ID3D11DepthStencilView *)p->dsv,
+                        p->uav_start_slot, p->uav_count,
+                        (ID3D11UnorderedAccessView *const *)&p->objects[rtv_count],
+                        p->initial_counts ? (const UINT *)&p->objects[rtv_count + uav_count] : NULL);
+                break;
+            }
+
+            case DEFERRED_OP_OM_SET_BLEND_STATE:
+            {
+                const struct d3d11_deferred_blend_state_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_OMSetBlendState(context, (ID3D11BlendState *)p->state,
+                        p->blend_factor, p->sample_mask);
+                break;
+            }
+
+            case DEFERRED_OP_OM_SET_DEPTH_STENCIL_STATE:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_OMSetDepthStencilState(context,
+                        (ID3D11DepthStencilState *)p->object, p->value);
+                break;
+            }
+
+            case DEFERRED_OP_SO_SET_TARGETS:
+            {
+                const struct d3d11_deferred_slots_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_SOSetTargets(context, p->count, (ID3D11Buffer *const *)p->objects,
+                        p->value_count ? (const UINT *)&p->objects[p->count] : NULL);
+                break;
+            }
+
+            case DEFERRED_OP_RS_SET_STATE:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_RSSetState(context, (ID3D11RasterizerState *)p->object);
+                break;
+            }
+
+            case DEFERRED_OP_RS_SET_VIEWPORTS:
+            {
+                const struct d3d11_deferred_rects_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_RSSetViewports(context, p->count, p->u.viewports);
+                break;
+            }
+
+            case DEFERRED_OP_RS_SET_SCISSOR_RECTS:
+            {
+                const struct d3d11_deferred_rects_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_RSSetScissorRects(context, p->count, p->u.rects);
+                break;
+            }
+
+            case DEFERRED_OP_SET_PREDICATION:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_SetPredication(context, (ID3D11Predicate *)p->object, p->value);
+                break;
+            }
+
+            case DEFERRED_OP_DRAW:
+            {
+                const struct d3d11_deferred_draw_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_Draw(context, p->args[0], p->args[1]);
+                break;
+            }
+
+            case DEFERRED_OP_DRAW_INDEXED:
+            {
+                const struct d3d11_deferred_draw_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_DrawIndexed(context, p->args[0], p->args[1], p->args[2]);
+                break;
+            }
+
+            case DEFERRED_OP_DRAW_INSTANCED:
+            {
+                const struct d3d11_deferred_draw_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_DrawInstanced(context, p->args[0], p->args[1], p->args[2], p->args[3]);
+                break;
+            }
+
+            case DEFERRED_OP_DRAW_INDEXED_INSTANCED:
+            {
+                const struct d3d11_deferred_draw_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_DrawIndexedInstanced(context, p->args[0], p->args[1],
+                        p->args[2], p->args[3], p->args[4]);
+                break;
+            }
+
+            case DEFERRED_OP_DRAW_INSTANCED_INDIRECT:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_DrawInstancedIndirect(context, (ID3D11Buffer *)p->object, p->offset);
+                break;
+            }
+
+            case DEFERRED_OP_DRAW_INDEXED_INSTANCED_INDIRECT:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_DrawIndexedInstancedIndirect(context, (ID3D11Buffer *)p->object, p->offset);
+                break;
+            }
+
+            case DEFERRED_OP_DRAW_AUTO:
+                ID3D11DeviceContext1_DrawAuto(context);
+                break;
+
+            case DEFERRED_OP_DISPATCH:
+            {
+                const struct d3d11_deferred_draw_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_Dispatch(context, p->args[0], p->args[1], p->args[2]);
+                break;
+            }
+
+            case DEFERRED_OP_DISPATCH_INDIRECT:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_DispatchIndirect(context, (ID3D11Buffer *)p->object, p->offset);
+                break;
+            }
+
+            case DEFERRED_OP_COPY_SUBRESOURCE_REGION:
+            {
+                const struct d3d11_deferred_copy_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_CopySubresourceRegion1(context, (ID3D11Resource *)p->dst, p->dst_idx,
+                        p->dst_x, p->dst_y, p->dst_z, (ID3D11Resource *)p->src, p->src_idx,
+                        p->has_box ? &p->box : NULL, p->flags);
+                break;
+            }
+
+            case DEFERRED_OP_COPY_RESOURCE:
+            {
+                const struct d3d11_deferred_copy_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_CopyResource(context, (ID3D11Resource *)p->dst, (ID3D11Resource *)p->src);
+                break;
+            }
+
+            case DEFERRED_OP_COPY_STRUCTURE_COUNT:
+            {
+                const struct d3d11_deferred_copy_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_CopyStructureCount(context, (ID3D11Buffer *)p->dst, p->dst_x,
+                        (ID3D11UnorderedAccessView *)p->src);
+                break;
+            }
+
+            case DEFERRED_OP_RESOLVE_SUBRESOURCE:
+            {
+                const struct d3d11_deferred_copy_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_ResolveSubresource(context, (ID3D11Resource *)p->dst, p->dst_idx,
+                        (ID3D11Resource *)p->src, p->src_idx, p->flags);
+                break;
+            }
+
+            case DEFERRED_OP_UPDATE_SUBRESOURCE:
+            {
+                const struct d3d11_deferred_update_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_UpdateSubresource1(context, (ID3D11Resource *)p->resource,
+                        p->subresource_idx, p->has_box ? &p->box : NULL, p->data,
+                        p->row_pitch, p->depth_pitch, p->flags);
+                break;
+            }
+
+            case DEFERRED_OP_MAP:
+            {
+                const struct d3d11_deferred_map_packet *p = (const void *)packet;
+                d3d11_deferred_map_upload(context, p->map);
+                break;
+            }
+
+            case DEFERRED_OP_CLEAR_RENDER_TARGET_VIEW:
+            {
+                const struct d3d11_deferred_clear_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_ClearRenderTargetView(context,
+                        (ID3D11RenderTargetView *)p->view, p->values.f);
+                break;
+            }
+
+            case DEFERRED_OP_CLEAR_UNORDERED_ACCESS_VIEW_UINT:
+            {
+                const struct d3d11_deferred_clear_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_ClearUnorderedAccessViewUint(context,
+                        (ID3D11UnorderedAccessView *)p->view, p->values.u);
+                break;
+            }
+
+            case DEFERRED_OP_CLEAR_UNORDERED_ACCESS_VIEW_FLOAT:
+            {
+                const struct d3d11_deferred_clear_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_ClearUnorderedAccessViewFloat(context,
+                        (ID3D11UnorderedAccessView *)p->view, p->values.f);
+                break;
+            }
+
+            case DEFERRED_OP_CLEAR_DEPTH_STENCIL_VIEW:
+            {
+                const struct d3d11_deferred_clear_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_ClearDepthStencilView(context,
+                        (ID3D11DepthStencilView *)p->view, p->flags, p->depth, p->stencil);
+                break;
+            }
+
+            case DEFERRED_OP_GENERATE_MIPS:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_GenerateMips(context, (ID3D11ShaderResourceView *)p->object);
+                break;
+            }
+
+            case DEFERRED_OP_BEGIN:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_Begin(context, (ID3D11Asynchronous *)p->object);
+                break;
+            }
+
+            case DEFERRED_OP_END:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_End(context, (ID3D11Asynchronous *)p->object);
+                break;
+            }
+
+            case DEFERRED_OP_CLEAR_STATE:
+                ID3D11DeviceContext1_ClearState(context);
+                break;
+
+            case DEFERRED_OP_EXECUTE_COMMAND_LIST:
+            {
+                const struct d3d11_deferred_object_packet *p = (const void *)packet;
+                ID3D11DeviceContext1_ExecuteCommandList(context, (ID3D11CommandList *)p->object, p->value);
+                break;
+            }
+
+            default:
+                ERR("Invalid deferred packet %#x.\n", packet->op);
+                return;
+        }
+    }
+}
+
+/* Pipeline state saved around ExecuteCommandList() with "restore_state" set. */
+struct d3d11_context_state
+{
+    struct
+    {
+        ID3D11DeviceChild *shader;
+        ID3D11ShaderResourceView *views[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT];
+        ID3D11SamplerState *samplers[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT];
+        ID3D11Buffer *constant_buffers[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+    } stages[WINED3D_SHADER_TYPE_COUNT];
+    ID3D11UnorderedAccessView *cs_uavs[D3D11_PS_CS_UAV_REGISTER_COUNT];
+
+    ID3D11InputLayout *input_layout;
+    ID3D11Buffer *vertex_buffers[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    UINT strides[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    UINT offsets[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    ID3D11Buffer *index_buffer;
+    DXGI_FORMAT index_format;
+    UINT index_offset;
+    D3D11_PRIMITIVE_TOPOLOGY topology;
+
+    ID3D11RenderTargetView *rtvs[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT];
+    ID3D11DepthStencilView *dsv;
+    ID3D11UnorderedAccessView *uavs[D3D11_PS_CS_UAV_REGISTER_COUNT];
+    ID3D11BlendState *blend_state;
+    float blend_factor[4];
+    UINT sample_mask;
+    ID3D11DepthStencilState *depth_stencil_state;
+    UINT stencil_ref;
+    ID3D11Buffer *so_buffers[D3D11_SO_BUFFER_SLOT_COUNT];
+
+    ID3D11RasterizerState *rasterizer_state;
+    D3D11_VIEWPORT viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    UINT viewport_count;
+    D3D11_RECT scissor_rects[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+    UINT scissor_rect_count;
+
+    ID3D11Predicate *predicate;
+    BOOL predicate_value;
+};
+
+static void d3d11_context_state_capture_stage(struct d3d11_context_state *state,
+        ID3D11DeviceContext1 *context, enum wined3d_shader_type type)
+{
+    ID3D11ShaderResourceView **views = state->stages[type].views;
+    ID3D11SamplerState **samplers = state->stages[type].samplers;
+    ID3D11Buffer **buffers = state->stages[type].constant_buffers;
+    ID3D11DeviceChild **shader = &state->stages[type].shader;
+    UINT view_count = ARRAY_SIZE(state->stages[type].views);
+    UINT sampler_count = ARRAY_SIZE(state->stages[type].samplers);
+    UINT buffer_count = ARRAY_SIZE(state->stages[type].constant_buffers);
+
+    switch (type)
+    {
+        case WINED3D_SHADER_TYPE_VERTEX:
+            ID3D11DeviceContext1_VSGetShader(context, (ID3D11VertexShader **)shader, NULL, NULL);
+            ID3D11DeviceContext1_VSGetShaderResources(context, 0, view_count, views);
+            ID3D11DeviceContext1_VSGetSamplers(context, 0, sampler_count, samplers);
+            ID3D11DeviceContext1_VSGetConstantBuffers(context, 0, buffer_count, buffers);
+            break;
+        case WINED3D_SHADER_TYPE_HULL:
+            ID3D11DeviceContext1_HSGetShader(context, (ID3D11HullShader **)shader, NULL, NULL);
+            ID3D11DeviceContext1_HSGetShaderResources(context, 0, view_count, views);
+            ID3D11DeviceContext1_HSGetSamplers(context, 0, sampler_count, samplers);
+            ID3D11DeviceContext1_HSGetConstantBuffers(context, 0, buffer_count, buffers);
+            break;
+        case WINED3D_SHADER_TYPE_DOMAIN:
+            ID3D11DeviceContext1_DSGetShader(context, (ID3D11DomainShader **)shader, NULL, NULL);
+            ID3D11DeviceContext1_DSGetShaderResources(context, 0, view_count, views);
+            ID3D11DeviceContext1_DSGetSamplers(context, 0, sampler_count, samplers);
+            ID3D11DeviceContext1_DSGetConstantBuffers(context, 0, buffer_count, buffers);
+            break;
+        case WINED3D_SHADER_TYPE_GEOMETRY:
+            ID3D11DeviceContext1_GSGetShader(context, (ID3D11GeometryShader **)shader, NULL, NULL);
+            ID3D11DeviceContext1_GSGetShaderResources(context, 0, view_count, views);
+            ID3D11DeviceContext1_GSGetSamplers(context, 0, sampler_count, samplers);
+            ID3D11DeviceContext1_GSGetConstantBuffers(context, 0, buffer_count, buffers);
+            break;
+        case WINED3D_SHADER_TYPE_PIXEL:
+            ID3D11DeviceContext1_PSGetShader(context, (ID3D11PixelShader **)shader, NULL, NULL);
+            ID3D11DeviceContext1_PSGetShaderResources(context, 0, view_count, views);
+            ID3D11DeviceContext1_PSGetSamplers(context, 0, sampler_count, samplers);
+            ID3D11DeviceContext1_PSGetConstantBuffers(context, 0, buffer_count, buffers);
+            break;
+        case WINED3D_SHADER_TYPE_COMPUTE:
+            ID3D11DeviceContext1_CSGetShader(context, (ID3D11ComputeShader **)shader, NULL, NULL);
+            ID3D11DeviceContext1_CSGetShaderResources(context, 0, view_count, views);
+            ID3D11DeviceContext1_CSGetSamplers(context, 0, sampler_count, samplers);
+            ID3D11DeviceContext1_CSGetConstantBuffers(context, 0, buffer_count, buffers);
+            break;
+        default:
+            ERR("Invalid shader type %#x.\n", type);
+            break;
+    }
+}
+
+static void d3d11_context_state_capture(struct d3d11_context_state *state, ID3D11DeviceContext1 *context)
+{
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(state->stages); ++i)
+        d3d11_context_state_capture_stage(state, context, i);
+    ID3D11DeviceContext1_CSGetUnorderedAccessViews(context, 0, ARRAY_SIZE(state->cs_uavs), state->cs_uavs);
+
+    ID3D11DeviceContext1_IAGetInputLayout(context, &state->input_layout);
+    ID3D11DeviceContext1_IAGetVertexBuffers(context, 0, ARRAY_SIZE(state->vertex_buffers),
+            state->vertex_buffers, state->strides, state->offsets);
+    ID3D11DeviceContext1_IAGetIndexBuffer(context, &state->index_buffer, &state->index_format, &state->index_offset);
+    ID3D11DeviceContext1_IAGetPrimitiveTopology(context, &state->topology);
+
+    ID3D11DeviceContext1_OMGetRenderTargetsAndUnorderedAccessViews(context, ARRAY_SIZE(state->rtvs),
+            state->rtvs, &state->dsv, 0, ARRAY_SIZE(state->uavs), state->uavs);
+    ID3D11DeviceContext1_OMGetBlendState(context, &state->blend_state, state->blend_factor, &state->sample_mask);
+    ID3D11DeviceContext1_OMGetDepthStencilState(context, &state->depth_stencil_state, &state->stencil_ref);
+    ID3D11DeviceContext1_SOGetTargets(context, ARRAY_SIZE(state->so_buffers), state->so_buffers);
+
+    ID3D11DeviceContext1_RSGetState(context, &state->rasterizer_state);
+    ID3D11DeviceContext1_RSGetViewports(context, &state->viewport_count, NULL);
+    state->viewport_count = min(state->viewport_count, ARRAY_SIZE(state->viewports));
+    ID3D11DeviceContext1_RSGetViewports(context, &state->viewport_count, state->viewports);
+    ID3D11DeviceContext1_RSGetScissorRects(context, &state->scissor_rect_count, NULL);
+    state->scissor_rect_count = min(state->scissor_rect_count, ARRAY_SIZE(state->scissor_rects));
+    ID3D11DeviceContext1_RSGetScissorRects(context, &state->scissor_rect_count, state->scissor_rects);
+
+    ID3D11DeviceContext1_GetPredication(context, &state->predicate, &state->predicate_value);
+}
+
+static void d3d11_release_objects(void *objects, unsigned int count)
+{
+    IUnknown **unknowns = objects;
+    unsigned int i;
+
+    for (i = 0; i < count; ++i)
+    {
+        if (unknowns[i])
+            IUnknown_Release(unknowns[i]);
+    }
+}
+
+/* Releases the references held by "state" and resets it to the default
+ * pipeline state, i.e. the state after ClearState(). */
+static void d3d11_context_state_cleanup(struct d3d11_context_state *state)
+{
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(state->stages); ++i)
+    {
+        d3d11_release_objects(&state->stages[i].shader, 1);
+        d3d11_release_objects(state->stages[i].views, ARRAY_SIZE(state->stages[i].views));
+        d3d11_release_objects(state->stages[i].samplers, ARRAY_SIZE(state->stages[i].samplers));
+        d3d11_release_objects(state->stages[i].constant_buffers, ARRAY_SIZE(state->stages[i].constant_buffers));
+    }
+    d3d11_release_objects(state->cs_uavs, ARRAY_SIZE(state->cs_uavs));
+    d3d11_release_objects(&state->input_layout, 1);
+    d3d11_release_objects(state->vertex_buffers, ARRAY_SIZE(state->vertex_buffers));
+    d3d11_release_objects(&state->index_buffer, 1);
+    d3d11_release_objects(state->rtvs, ARRAY_SIZE(state->rtvs));
+    d3d11_release_objects(&state->dsv, 1);
+    d3d11_release_objects(state->uavs, ARRAY_SIZE(state->uavs));
+    d3d11_release_objects(&state->blend_state, 1);
+    d3d11_release_objects(&state->depth_stencil_state, 1);
+    d3d11_release_objects(state->so_buffers, ARRAY_SIZE(state->so_buffers));
+    d3d11_release_objects(&state->rasterizer_state, 1);
+    d3d11_release_objects(&state->predicate, 1);
+
+    memset(state, 0, sizeof(*state));
+    state->blend_factor[0] = state->blend_factor[1] = state->blend_factor[2] = state->blend_factor[3] = 1.0f;
+    state->sample_mask = D3D11_DEFAULT_SAMPLE_MASK;
+}
+
+/* Applies the captured state to "context" and releases the references held
+ * by "state". Stream output offsets can't be queried and restart at zero. */
+static void d3d11_context_state_apply(struct d3d11_context_state *state, ID3D11DeviceContext1 *context)
+{
+    static const UINT so_offsets[D3D11_SO_BUFFER_SLOT_COUNT];
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(state->stages); ++i)
+    {
+        d3d11_context_set_shader(context, i, (IUnknown *)state->stages[i].shader);
+        d3d11_context_set_shader_resources(context, i, 0, ARRAY_SIZE(state->stages[i].views),
+                (IUnknown *const *)state->stages[i].views);
+        d3d11_context_set_samplers(context, i, 0, ARRAY_SIZE(state->stages[i].samplers),
+                (IUnknown *const *)state->stages[i].samplers);
+        d3d11_context_set_constant_buffers(context, i, 0, ARRAY_SIZE(state->stages[i].constant_buffers),
+                (IUnknown *const *)state->stages[i].constant_buffers);
+    }
+    ID3D11DeviceContext1_CSSetUnorderedAccessViews(context, 0, ARRAY_SIZE(state->cs_uavs), state->cs_uavs, NULL);
+
+    ID3D11DeviceContext1_IASetInputLayout(context, state->input_layout);
+    ID3D11DeviceContext1_IASetVertexBuffers(context, 0, ARRAY_SIZE(state->vertex_buffers),
+            state->vertex_buffers, state->strides, state->offsets);
+    ID3D11DeviceContext1_IASetIndexBuffer(context, state->index_buffer, state->index_format, state->index_offset);
+    ID3D11DeviceContext1_IASetPrimitiveTopology(context, state->topology);
+
+    ID3D11DeviceContext1_OMSetRenderTargetsAndUnorderedAccessViews(context, ARRAY_SIZE(state->rtvs),
+            state->rtvs, state->dsv, 0, ARRAY_SIZE(state->uavs), state->uavs, NULL);
+    ID3D11DeviceContext1_OMSetBlendState(context, state->blend_state, state->blend_factor, state->sample_mask);
+    ID3D11DeviceContext1_OMSetDepthStencilState(context, state->depth_stencil_state, state->stencil_ref);
+    ID3D11DeviceContext1_SOSetTargets(context, ARRAY_SIZE(state->so_buffers), state->so_buffers, so_offsets);
+
+    ID3D11DeviceContext1_RSSetState(context, state->rasterizer_state);
+    ID3D11DeviceContext1_RSSetViewports(context, state->viewport_count, state->viewports);
+    ID3D11DeviceContext1_RSSetScissorRects(context, state->scissor_rect_count, state->scissor_rects);
+
+    ID3D11DeviceContext1_SetPredication(context, state->predicate, state->predicate_value);
+
+    d3d11_context_state_cleanup(state);
+}
+
+/* ID3D11DeviceContext - immediate context methods */
+
+static inline struct d3d11_immediate_context *impl_from_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d11_immediate_context, ID3D11DeviceContext1_iface);
+}
+
+static inline struct d3d_device *device_from_immediate_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    return CONTAINING_RECORD(context, struct d3d_device, immediate_context);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_QueryInterface(ID3D11DeviceContext1 *iface,
+        REFIID iid, void **out)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+
+    if (IsEqualGUID(iid, &IID_ID3D11DeviceContext1)
+            || IsEqualGUID(iid, &IID_ID3D11DeviceContext)
+            || IsEqualGUID(iid, &IID_ID3D11DeviceChild)
+            || IsEqualGUID(iid, &IID_IUnknown))
+    {
+        *out = &context->ID3D11DeviceContext1_iface;
+    }
+    else if (IsEqualGUID(iid, &IID_ID3D11Multithread))
+    {
+        *out = &context->ID3D11Multithread_iface;
+    }
+    else
+    {
+        WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
+        *out = NULL;
+        return E_NOINTERFACE;
+    }
+
+    ID3D11DeviceContext1_AddRef(iface);
+    return S_OK;
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_immediate_context_AddRef(ID3D11DeviceContext1 *iface)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    ULONG refcount = InterlockedIncrement(&context->refcount);
+
+    TRACE("%p increasing refcount to %u.\n", context, refcount);
+
+    if (refcount == 1)
+    {
+        ID3D11Device2_AddRef(&device->ID3D11Device2_iface);
+    }
+
+    return refcount;
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_immediate_context_Release(ID3D11DeviceContext1 *iface)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    ULONG refcount = InterlockedDecrement(&context->refcount);
+
+    TRACE("%p decreasing refcount to %u.\n", context, refcount);
+
+    if (!refcount)
+    {
+        ID3D11Device2_Release(&device->ID3D11Device2_iface);
+    }
+
+    return refcount;
+}
+
+static void d3d11_immediate_context_get_constant_buffers(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    wined3d_mutex_lock();
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct wined3d_buffer *wined3d_buffer;
+        struct d3d_buffer *buffer_impl;
+
+        if (!(wined3d_buffer = wined3d_device_get_constant_buffer(device->wined3d_device,
+                type, start_slot + i)))
+        {
+            buffers[i] = NULL;
+            continue;
+        }
+
+        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
+        buffers[i] = &buffer_impl->ID3D11Buffer_iface;
+        ID3D11Buffer_AddRef(buffers[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void d3d11_immediate_context_set_constant_buffers(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    wined3d_mutex_lock();
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+
+        wined3d_device_set_constant_buffer(device->wined3d_device, type, start_slot + i,
+                buffer ? buffer->wined3d_buffer : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GetDevice(ID3D11DeviceContext1 *iface, ID3D11Device **device)
+{
+    struct d3d_device *device_object = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, device %p.\n", iface, device);
+
+    *device = (ID3D11Device *)&device_object->ID3D11Device2_iface;
+    ID3D11Device_AddRef(*device);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_GetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+        UINT *data_size, void *data)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, guid %s, data_size %p, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+
+    return d3d_get_private_data(&context->private_store, guid, data_size, data);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_SetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+        UINT data_size, const void *data)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, guid %s, data_size %u, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+
+    return d3d_set_private_data(&context->private_store, guid, data_size, data);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_SetPrivateDataInterface(ID3D11DeviceContext1 *iface,
+        REFGUID guid, const IUnknown *data)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, guid %s, data %p.\n", iface, debugstr_guid(guid), data);
+
+    return d3d_set_private_data_interface(&context->private_store, guid, data);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_ps_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11PixelShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_pixel_shader *ps = unsafe_impl_from_ID3D11PixelShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_pixel_shader(device->wined3d_device, ps ? ps->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_ps_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11VertexShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_vertex_shader *vs = unsafe_impl_from_ID3D11VertexShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_vertex_shader(device->wined3d_device, vs ? vs->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexed(ID3D11DeviceContext1 *iface,
+        UINT index_count, UINT start_index_location, INT base_vertex_location)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, index_count %u, start_index_location %u, base_vertex_location %d.\n",
+            iface, index_count, start_index_location, base_vertex_location);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_base_vertex_index(device->wined3d_device, base_vertex_location);
+    wined3d_device_draw_indexed_primitive(device->wined3d_device, start_index_location, index_count);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_Draw(ID3D11DeviceContext1 *iface,
+        UINT vertex_count, UINT start_vertex_location)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, vertex_count %u, start_vertex_location %u.\n",
+            iface, vertex_count, start_vertex_location);
+
+    wined3d_mutex_lock();
+    wined3d_device_draw_primitive(device->wined3d_device, start_vertex_location, vertex_count);
+    wined3d_mutex_unlock();
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_Map(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
+        UINT subresource_idx, D3D11_MAP map_type, UINT map_flags, D3D11_MAPPED_SUBRESOURCE *mapped_subresource)
+{
+    struct wined3d_resource *wined3d_resource;
+    struct wined3d_map_desc map_desc;
+    HRESULT hr;
+
+    TRACE("iface %p, resource %p, subresource_idx %u, map_type %u, map_flags %#x, mapped_subresource %p.\n",
+            iface, resource, subresource_idx, map_type, map_flags, mapped_subresource);
+
+    if (map_flags)
+        FIXME("Ignoring map_flags %#x.\n", map_flags);
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+
+    wined3d_mutex_lock();
+    hr = wined3d_resource_map(wined3d_resource, subresource_idx,
+            &map_desc, NULL, wined3d_map_flags_from_d3d11_map_type(map_type));
+    wined3d_mutex_unlock();
+
+    mapped_subresource->pData = map_desc.data;
+    mapped_subresource->RowPitch = map_desc.row_pitch;
+    mapped_subresource->DepthPitch = map_desc.slice_pitch;
+
+    return hr;
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_Unmap(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
+        UINT subresource_idx)
+{
+    struct wined3d_resource *wined3d_resource;
+
+    TRACE("iface %p, resource %p, subresource_idx %u.\n", iface, resource, subresource_idx);
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+
+    wined3d_mutex_lock();
+    wined3d_resource_unmap(wined3d_resource, subresource_idx);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IASetInputLayout(ID3D11DeviceContext1 *iface,
+        ID3D11InputLayout *input_layout)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_input_layout *layout = unsafe_impl_from_ID3D11InputLayout(input_layout);
+
+    TRACE("iface %p, input_layout %p.\n", iface, input_layout);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_vertex_declaration(device->wined3d_device, layout ? layout->wined3d_decl : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IASetVertexBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers, const UINT *strides, const UINT *offsets)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p.\n",
+            iface, start_slot, buffer_count, buffers, strides, offsets);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+
+        wined3d_device_set_stream_source(device->wined3d_device, start_slot + i,
+                buffer ? buffer->wined3d_buffer : NULL, offsets[i], strides[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IASetIndexBuffer(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, DXGI_FORMAT format, UINT offset)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_buffer *buffer_impl = unsafe_impl_from_ID3D11Buffer(buffer);
+
+    TRACE("iface %p, buffer %p, format %s, offset %u.\n",
+            iface, buffer, debug_dxgi_format(format), offset);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_index_buffer(device->wined3d_device,
+            buffer_impl ? buffer_impl->wined3d_buffer : NULL,
+            wined3dformat_from_dxgi_format(format), offset);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexedInstanced(ID3D11DeviceContext1 *iface,
+        UINT instance_index_count, UINT instance_count, UINT start_index_location, INT base_vertex_location,
+        UINT start_instance_location)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, instance_index_count %u, instance_count %u, start_index_location %u, "
+            "base_vertex_location %d, start_instance_location %u.\n",
+            iface, instance_index_count, instance_count, start_index_location,
+            base_vertex_location, start_instance_location);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_base_vertex_index(device->wined3d_device, base_vertex_location);
+    wined3d_device_draw_indexed_primitive_instanced(device->wined3d_device, start_index_location,
+            instance_index_count, start_instance_location, instance_count);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawInstanced(ID3D11DeviceContext1 *iface,
+        UINT instance_vertex_count, UINT instance_count, UINT start_vertex_location, UINT start_instance_location)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, instance_vertex_count %u, instance_count %u, start_vertex_location %u, "
+            "start_instance_location %u.\n",
+            iface, instance_vertex_count, instance_count, start_vertex_location,
+            start_instance_location);
+
+    wined3d_mutex_lock();
+    wined3d_device_draw_primitive_instanced(device->wined3d_device, start_vertex_location,
+            instance_vertex_count, start_instance_location, instance_count);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_GEOMETRY, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11GeometryShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_geometry_shader *gs = unsafe_impl_from_ID3D11GeometryShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_geometry_shader(device->wined3d_device, gs ? gs->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IASetPrimitiveTopology(ID3D11DeviceContext1 *iface,
+        D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    enum wined3d_primitive_type primitive_type;
+    unsigned int patch_vertex_count;
+
+    TRACE("iface %p, topology %#x.\n", iface, topology);
+
+    wined3d_primitive_type_from_d3d11_primitive_topology(topology, &primitive_type, &patch_vertex_count);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_primitive_type(device->wined3d_device, primitive_type, patch_vertex_count);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_vs_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_vs_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_Begin(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous)
+{
+    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
+    HRESULT hr;
+
+    TRACE("iface %p, asynchronous %p.\n", iface, asynchronous);
+
+    wined3d_mutex_lock();
+    if (FAILED(hr = wined3d_query_issue(query->wined3d_query, WINED3DISSUE_BEGIN)))
+        ERR("Failed to issue query, hr %#x.\n", hr);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_End(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous)
+{
+    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
+    HRESULT hr;
+
+    TRACE("iface %p, asynchronous %p.\n", iface, asynchronous);
+
+    wined3d_mutex_lock();
+    if (FAILED(hr = wined3d_query_issue(query->wined3d_query, WINED3DISSUE_END)))
+        ERR("Failed to issue query, hr %#x.\n", hr);
+    wined3d_mutex_unlock();
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_GetData(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous, void *data, UINT data_size, UINT data_flags)
+{
+    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
+    unsigned int wined3d_flags;
+    HRESULT hr;
+
+    TRACE("iface %p, asynchronous %p, data %p, data_size %u, data_flags %#x.\n",
+            iface, asynchronous, data, data_size, data_flags);
+
+    if (!data && data_size)
+        return E_INVALIDARG;
+
+    wined3d_flags = wined3d_getdata_flags_from_d3d11_async_getdata_flags(data_flags);
+
+    wined3d_mutex_lock();
+    if (!data_size || wined3d_query_get_data_size(query->wined3d_query) == data_size)
+    {
+        hr = wined3d_query_get_data(query->wined3d_query, data, data_size, wined3d_flags);
+        if (hr == WINED3DERR_INVALIDCALL)
+            hr = DXGI_ERROR_INVALID_CALL;
+    }
+    else
+    {
+        WARN("Invalid data size %u.\n", data_size);
+        hr = E_INVALIDARG;
+    }
+    wined3d_mutex_unlock();
+
+    return hr;
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_SetPredication(ID3D11DeviceContext1 *iface,
+        ID3D11Predicate *predicate, BOOL value)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_query *query;
+
+    TRACE("iface %p, predicate %p, value %#x.\n", iface, predicate, value);
+
+    query = unsafe_impl_from_ID3D11Query((ID3D11Query *)predicate);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_predication(device->wined3d_device, query ? query->wined3d_query : NULL, value);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_gs_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_gs_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetRenderTargets(ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView *const *render_target_views,
+        ID3D11DepthStencilView *depth_stencil_view)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_depthstencil_view *dsv;
+    unsigned int i;
+
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < render_target_view_count; ++i)
+    {
+        struct d3d_rendertarget_view *rtv = unsafe_impl_from_ID3D11RenderTargetView(render_target_views[i]);
+        wined3d_device_set_rendertarget_view(device->wined3d_device, i, rtv ? rtv->wined3d_view : NULL, FALSE);
+    }
+    for (; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+    {
+        wined3d_device_set_rendertarget_view(device->wined3d_device, i, NULL, FALSE);
+    }
+
+    dsv = unsafe_impl_from_ID3D11DepthStencilView(depth_stencil_view);
+    wined3d_device_set_depth_stencil_view(device->wined3d_device, dsv ? dsv->wined3d_view : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetRenderTargetsAndUnorderedAccessViews(
+        ID3D11DeviceContext1 *iface, UINT render_target_view_count,
+        ID3D11RenderTargetView *const *render_target_views, ID3D11DepthStencilView *depth_stencil_view,
+        UINT unordered_access_view_start_slot, UINT unordered_access_view_count,
+        ID3D11UnorderedAccessView *const *unordered_access_views, const UINT *initial_counts)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p, "
+            "unordered_access_view_start_slot %u, unordered_access_view_count %u, unordered_access_views %p, "
+            "initial_counts %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view,
+            unordered_access_view_start_slot, unordered_access_view_count, unordered_access_views,
+            initial_counts);
+
+    if (render_target_view_count != D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
+    {
+        d3d11_immediate_context_OMSetRenderTargets(iface, render_target_view_count, render_target_views,
+                depth_stencil_view);
+    }
+
+    if (unordered_access_view_count != D3D11_KEEP_UNORDERED_ACCESS_VIEWS)
+    {
+        wined3d_mutex_lock();
+        for (i = 0; i < unordered_access_view_start_slot; ++i)
+        {
+            wined3d_device_set_unordered_access_view(device->wined3d_device, i, NULL, ~0u);
+        }
+        for (i = 0; i < unordered_access_view_count; ++i)
+        {
+            struct d3d11_unordered_access_view *view
+                    = unsafe_impl_from_ID3D11UnorderedAccessView(unordered_access_views[i]);
+
+            wined3d_device_set_unordered_access_view(device->wined3d_device,
+                    unordered_access_view_start_slot + i,
+                    view ? view->wined3d_view : NULL, initial_counts ? initial_counts[i] : ~0u);
+        }
+        for (; unordered_access_view_start_slot + i < D3D11_PS_CS_UAV_REGISTER_COUNT; ++i)
+        {
+            wined3d_device_set_unordered_access_view(device->wined3d_device,
+                    unordered_access_view_start_slot + i, NULL, ~0u);
+        }
+        wined3d_mutex_unlock();
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetBlendState(ID3D11DeviceContext1 *iface,
+        ID3D11BlendState *blend_state, const float blend_factor[4], UINT sample_mask)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    static const float default_blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    struct d3d_blend_state *blend_state_impl;
+
+    TRACE("iface %p, blend_state %p, blend_factor %s, sample_mask 0x%08x.\n",
+            iface, blend_state, debug_float4(blend_factor), sample_mask);
+
+    if (!blend_factor)
+        blend_factor = default_blend_factor;
+
+    wined3d_mutex_lock();
+    if (!(blend_state_impl = unsafe_impl_from_ID3D11BlendState(blend_state)))
+        wined3d_device_set_blend_state(device->wined3d_device, NULL,
+                (const struct wined3d_color *)blend_factor, sample_mask);
+    else
+        wined3d_device_set_blend_state(device->wined3d_device, blend_state_impl->wined3d_state,
+                (const struct wined3d_color *)blend_factor, sample_mask);
+    wined3d_mutex_unlock();
+}
+
+static void set_default_depth_stencil_state(struct wined3d_device *wined3d_device)
+{
+    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZENABLE, TRUE);
+    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZWRITEENABLE, D3D11_DEPTH_WRITE_MASK_ALL);
+    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZFUNC, WINED3D_CMP_LESS);
+    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_STENCILENABLE, FALSE);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetDepthStencilState(ID3D11DeviceContext1 *iface,
+        ID3D11DepthStencilState *depth_stencil_state, UINT stencil_ref)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    const D3D11_DEPTH_STENCILOP_DESC *front, *back;
+    const D3D11_DEPTH_STENCIL_DESC *desc;
+
+    TRACE("iface %p, depth_stencil_state %p, stencil_ref %u.\n",
+            iface, depth_stencil_state, stencil_ref);
+
+    wined3d_mutex_lock();
+    device->stencil_ref = stencil_ref;
+    if (!(device->depth_stencil_state = unsafe_impl_from_ID3D11DepthStencilState(depth_stencil_state)))
+    {
+        set_default_depth_stencil_state(device->wined3d_device);
+        wined3d_mutex_unlock();
+        return;
+    }
+
+    desc = &device->depth_stencil_state->desc;
+
+    front = &desc->FrontFace;
+    back = &desc->BackFace;
+
+    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZENABLE, desc->DepthEnable);
+    if (desc->DepthEnable)
+    {
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZWRITEENABLE, desc->DepthWriteMask);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZFUNC, desc->DepthFunc);
+    }
+
+    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILENABLE, desc->StencilEnable);
+    if (desc->StencilEnable)
+    {
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILMASK, desc->StencilReadMask);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILWRITEMASK, desc->StencilWriteMask);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILREF, stencil_ref);
+
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILFAIL, front->StencilFailOp);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILZFAIL, front->StencilDepthFailOp);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILPASS, front->StencilPassOp);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILFUNC, front->StencilFunc);
+        if (front->StencilFailOp != back->StencilFailOp
+                || front->StencilDepthFailOp != back->StencilDepthFailOp
+                || front->StencilPassOp != back->StencilPassOp
+                || front->StencilFunc != back->StencilFunc)
+        {
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_TWOSIDEDSTENCILMODE, TRUE);
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILFAIL, back->StencilFailOp);
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILZFAIL,
+                    back->StencilDepthFailOp);
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILPASS, back->StencilPassOp);
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILFUNC, back->StencilFunc);
+        }
+        else
+        {
+            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_TWOSIDEDSTENCILMODE, FALSE);
+        }
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_SOSetTargets(ID3D11DeviceContext1 *iface, UINT buffer_count,
+        ID3D11Buffer *const *buffers, const UINT *offsets)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int count, i;
+
+    TRACE("iface %p, buffer_count %u, buffers %p, offsets %p.\n", iface, buffer_count, buffers, offsets);
+
+    count = min(buffer_count, D3D11_SO_BUFFER_SLOT_COUNT);
+    wined3d_mutex_lock();
+    for (i = 0; i < count; ++i)
+    {
+        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+
+        wined3d_device_set_stream_output(device->wined3d_device, i,
+                buffer ? buffer->wined3d_buffer : NULL, offsets ? offsets[i] : 0);
+    }
+    for (; i < D3D11_SO_BUFFER_SLOT_COUNT; ++i)
+    {
+        wined3d_device_set_stream_output(device->wined3d_device, i, NULL, 0);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawAuto(ID3D11DeviceContext1 *iface)
+{
+    FIXME("iface %p stub!\n", iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexedInstancedIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_buffer *d3d_buffer;
+
+    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
+
+    d3d_buffer = unsafe_impl_from_ID3D11Buffer(buffer);
+
+    wined3d_mutex_lock();
+    wined3d_device_draw_indexed_primitive_instanced_indirect(device->wined3d_device,
+            d3d_buffer->wined3d_buffer, offset);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DrawInstancedIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_buffer *d3d_buffer;
+
+    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
+
+    d3d_buffer = unsafe_impl_from_ID3D11Buffer(buffer);
+
+    wined3d_mutex_lock();
+    wined3d_device_draw_primitive_instanced_indirect(device->wined3d_device,
+            d3d_buffer->wined3d_buffer, offset);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_Dispatch(ID3D11DeviceContext1 *iface,
+        UINT thread_group_count_x, UINT thread_group_count_y, UINT thread_group_count_z)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, thread_group_count_x %u, thread_group_count_y %u, thread_group_count_z %u.\n",
+            iface, thread_group_count_x, thread_group_count_y, thread_group_count_z);
+
+    wined3d_mutex_lock();
+    wined3d_device_dispatch_compute(device->wined3d_device,
+            thread_group_count_x, thread_group_count_y, thread_group_count_z);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DispatchIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_buffer *buffer_impl;
+
+    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
+
+    buffer_impl = unsafe_impl_from_ID3D11Buffer(buffer);
+
+    wined3d_mutex_lock();
+    wined3d_device_dispatch_compute_indirect(device->wined3d_device,
+            buffer_impl->wined3d_buffer, offset);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetState(ID3D11DeviceContext1 *iface,
+        ID3D11RasterizerState *rasterizer_state)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_rasterizer_state *rasterizer_state_impl;
+    const D3D11_RASTERIZER_DESC *desc;
+
+    TRACE("iface %p, rasterizer_state %p.\n", iface, rasterizer_state);
+
+    wined3d_mutex_lock();
+    if (!(rasterizer_state_impl = unsafe_impl_from_ID3D11RasterizerState(rasterizer_state)))
+    {
+        wined3d_device_set_rasterizer_state(device->wined3d_device, NULL);
+        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_MULTISAMPLEANTIALIAS, FALSE);
+        wined3d_mutex_unlock();
+        return;
+    }
+
+    wined3d_device_set_rasterizer_state(device->wined3d_device, rasterizer_state_impl->wined3d_state);
+
+    desc = &rasterizer_state_impl->desc;
+    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_MULTISAMPLEANTIALIAS, desc->MultisampleEnable);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetViewports(ID3D11DeviceContext1 *iface,
+        UINT viewport_count, const D3D11_VIEWPORT *viewports)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_viewport wined3d_vp[WINED3D_MAX_VIEWPORTS];
+    unsigned int i;
+
+    TRACE("iface %p, viewport_count %u, viewports %p.\n", iface, viewport_count, viewports);
+
+    if (viewport_count > ARRAY_SIZE(wined3d_vp))
+        return;
+
+    for (i = 0; i < viewport_count; ++i)
+    {
+        wined3d_vp[i].x = viewports[i].TopLeftX;
+        wined3d_vp[i].y = viewports[i].TopLeftY;
+        wined3d_vp[i].width = viewports[i].Width;
+        wined3d_vp[i].height = viewports[i].Height;
+        wined3d_vp[i].min_z = viewports[i].MinDepth;
+        wined3d_vp[i].max_z = viewports[i].MaxDepth;
+    }
+
+    wined3d_mutex_lock();
+    wined3d_device_set_viewports(device->wined3d_device, viewport_count, wined3d_vp);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetScissorRects(ID3D11DeviceContext1 *iface,
+        UINT rect_count, const D3D11_RECT *rects)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, rect_count %u, rects %p.\n", iface, rect_count, rects);
+
+    if (rect_count > WINED3D_MAX_VIEWPORTS)
+        return;
+
+    wined3d_mutex_lock();
+    wined3d_device_set_scissor_rects(device->wined3d_device, rect_count, rects);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CopySubresourceRegion(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
+        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+    struct wined3d_box wined3d_src_box;
+
+    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
+            "src_resource %p, src_subresource_idx %u, src_box %p.\n",
+            iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
+            src_resource, src_subresource_idx, src_box);
+
+    if (!dst_resource || !src_resource)
+        return;
+
+    if (src_box)
+        wined3d_box_set(&wined3d_src_box, src_box->left, src_box->top,
+                src_box->right, src_box->bottom, src_box->front, src_box->back);
+
+    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
+    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
+    wined3d_mutex_lock();
+    wined3d_device_copy_sub_resource_region(device->wined3d_device, wined3d_dst_resource, dst_subresource_idx,
+            dst_x, dst_y, dst_z, wined3d_src_resource, src_subresource_idx, src_box ? &wined3d_src_box : NULL, 0);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CopyResource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, ID3D11Resource *src_resource)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+
+    TRACE("iface %p, dst_resource %p, src_resource %p.\n", iface, dst_resource, src_resource);
+
+    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
+    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
+    wined3d_mutex_lock();
+    wined3d_device_copy_resource(device->wined3d_device, wined3d_dst_resource, wined3d_src_resource);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_UpdateSubresource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box,
+        const void *data, UINT row_pitch, UINT depth_pitch)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_resource;
+    struct wined3d_box wined3d_box;
+
+    TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u.\n",
+            iface, resource, subresource_idx, box, data, row_pitch, depth_pitch);
+
+    if (box)
+        wined3d_box_set(&wined3d_box, box->left, box->top, box->right, box->bottom, box->front, box->back);
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+    wined3d_mutex_lock();
+    wined3d_device_update_sub_resource(device->wined3d_device, wined3d_resource,
+            subresource_idx, box ? &wined3d_box : NULL, data, row_pitch, depth_pitch, 0);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CopyStructureCount(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *dst_buffer, UINT dst_offset, ID3D11UnorderedAccessView *src_view)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_unordered_access_view *uav;
+    struct d3d_buffer *buffer_impl;
+
+    TRACE("iface %p, dst_buffer %p, dst_offset %u, src_view %p.\n",
+            iface, dst_buffer, dst_offset, src_view);
+
+    buffer_impl = unsafe_impl_from_ID3D11Buffer(dst_buffer);
+    uav = unsafe_impl_from_ID3D11UnorderedAccessView(src_view);
+
+    wined3d_mutex_lock();
+    wined3d_device_copy_uav_counter(device->wined3d_device,
+            buffer_impl->wined3d_buffer, dst_offset, uav->wined3d_view);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearRenderTargetView(ID3D11DeviceContext1 *iface,
+        ID3D11RenderTargetView *render_target_view, const float color_rgba[4])
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_rendertarget_view *view = unsafe_impl_from_ID3D11RenderTargetView(render_target_view);
+    const struct wined3d_color color = {color_rgba[0], color_rgba[1], color_rgba[2], color_rgba[3]};
+    HRESULT hr;
+
+    TRACE("iface %p, render_target_view %p, color_rgba %s.\n",
+            iface, render_target_view, debug_float4(color_rgba));
+
+    if (!view)
+        return;
+
+    wined3d_mutex_lock();
+    if (FAILED(hr = wined3d_device_clear_rendertarget_view(device->wined3d_device, view->wined3d_view, NULL,
+            WINED3DCLEAR_TARGET, &color, 0.0f, 0)))
+        ERR("Failed to clear view, hr %#x.\n", hr);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearUnorderedAccessViewUint(ID3D11DeviceContext1 *iface,
+        ID3D11UnorderedAccessView *unordered_access_view, const UINT values[4])
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_unordered_access_view *view;
+
+    TRACE("iface %p, unordered_access_view %p, values {%u, %u, %u, %u}.\n",
+            iface, unordered_access_view, values[0], values[1], values[2], values[3]);
+
+    view = unsafe_impl_from_ID3D11UnorderedAccessView(unordered_access_view);
+    wined3d_mutex_lock();
+    wined3d_device_clear_unordered_access_view_uint(device->wined3d_device,
+            view->wined3d_view, (const struct wined3d_uvec4 *)values);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearUnorderedAccessViewFloat(ID3D11DeviceContext1 *iface,
+        ID3D11UnorderedAccessView *unordered_access_view, const float values[4])
+{
+    FIXME("iface %p, unordered_access_view %p, values %s stub!\n",
+            iface, unordered_access_view, debug_float4(values));
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearDepthStencilView(ID3D11DeviceContext1 *iface,
+        ID3D11DepthStencilView *depth_stencil_view, UINT flags, FLOAT depth, UINT8 stencil)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_depthstencil_view *view = unsafe_impl_from_ID3D11DepthStencilView(depth_stencil_view);
+    DWORD wined3d_flags;
+    HRESULT hr;
+
+    TRACE("iface %p, depth_stencil_view %p, flags %#x, depth %.8e, stencil %u.\n",
+            iface, depth_stencil_view, flags, depth, stencil);
+
+    if (!view)
+        return;
+
+    wined3d_flags = wined3d_clear_flags_from_d3d11_clear_flags(flags);
+
+    wined3d_mutex_lock();
+    if (FAILED(hr = wined3d_device_clear_rendertarget_view(device->wined3d_device, view->wined3d_view, NULL,
+            wined3d_flags, NULL, depth, stencil)))
+        ERR("Failed to clear view, hr %#x.\n", hr);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GenerateMips(ID3D11DeviceContext1 *iface,
+        ID3D11ShaderResourceView *view)
+{
+    struct d3d_shader_resource_view *srv = unsafe_impl_from_ID3D11ShaderResourceView(view);
+
+    TRACE("iface %p, view %p.\n", iface, view);
+
+    wined3d_mutex_lock();
+    wined3d_shader_resource_view_generate_mipmaps(srv->wined3d_view);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_SetResourceMinLOD(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, FLOAT min_lod)
+{
+    FIXME("iface %p, resource %p, min_lod %f stub!\n", iface, resource, min_lod);
+}
+
+static FLOAT STDMETHODCALLTYPE d3d11_immediate_context_GetResourceMinLOD(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource)
+{
+    FIXME("iface %p, resource %p stub!\n", iface, resource);
+
+    return 0.0f;
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ResolveSubresource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx,
+        ID3D11Resource *src_resource, UINT src_subresource_idx,
+        DXGI_FORMAT format)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+    enum wined3d_format_id wined3d_format;
+
+    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, "
+            "src_resource %p, src_subresource_idx %u, format %s.\n",
+            iface, dst_resource, dst_subresource_idx,
+            src_resource, src_subresource_idx, debug_dxgi_format(format));
+
+    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
+    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
+    wined3d_format = wined3dformat_from_dxgi_format(format);
+    wined3d_mutex_lock();
+    wined3d_device_resolve_sub_resource(device->wined3d_device,
+            wined3d_dst_resource, dst_subresource_idx,
+            wined3d_src_resource, src_subresource_idx, wined3d_format);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ExecuteCommandList(ID3D11DeviceContext1 *iface,
+        ID3D11CommandList *command_list, BOOL restore_state)
+{
+    struct d3d11_command_list *list = unsafe_impl_from_ID3D11CommandList(command_list);
+    struct d3d11_context_state *state = NULL;
+
+    TRACE("iface %p, command_list %p, restore_state %#x.\n", iface, command_list, restore_state);
+
+    if (!list)
+        return;
+
+    wined3d_mutex_lock();
+    if (restore_state)
+    {
+        if ((state = heap_alloc_zero(sizeof(*state))))
+            d3d11_context_state_capture(state, iface);
+        else
+            ERR("Failed to allocate context state.\n");
+    }
+
+    /* Command lists don't inherit any state from the executing context. */
+    ID3D11DeviceContext1_ClearState(iface);
+    d3d11_command_list_execute(list, iface);
+
+    if (state)
+    {
+        d3d11_context_state_apply(state, iface);
+        heap_free(state);
+    }
+    else
+    {
+        ID3D11DeviceContext1_ClearState(iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_hs_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11HullShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_hull_shader *hs = unsafe_impl_from_ID3D11HullShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_hull_shader(device->wined3d_device, hs ? hs->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_hs_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_HULL, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_ds_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11DomainShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_domain_shader *ds = unsafe_impl_from_ID3D11DomainShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_domain_shader(device->wined3d_device, ds ? ds->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_ds_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+
+        wined3d_device_set_cs_resource_view(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11UnorderedAccessView *const *views, const UINT *initial_counts)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p, initial_counts %p.\n",
+            iface, start_slot, view_count, views, initial_counts);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d11_unordered_access_view *view = unsafe_impl_from_ID3D11UnorderedAccessView(views[i]);
+
+        wined3d_device_set_cs_uav(device->wined3d_device, start_slot + i,
+                view ? view->wined3d_view : NULL, initial_counts ? initial_counts[i] : ~0u);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11ComputeShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_compute_shader *cs = unsafe_impl_from_ID3D11ComputeShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    wined3d_mutex_lock();
+    wined3d_device_set_compute_shader(device->wined3d_device, cs ? cs->wined3d_shader : NULL);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+
+        wined3d_device_set_cs_sampler(device->wined3d_device, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_ps_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
+        ID3D11ShaderResourceView_AddRef(views[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11PixelShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_shader *wined3d_shader;
+    struct d3d_pixel_shader *shader_impl;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_pixel_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    *shader = &shader_impl->ID3D11PixelShader_iface;
+    ID3D11PixelShader_AddRef(*shader);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct wined3d_sampler *wined3d_sampler;
+        struct d3d_sampler_state *sampler_impl;
+
+        if (!(wined3d_sampler = wined3d_device_get_ps_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
+        ID3D11SamplerState_AddRef(samplers[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11VertexShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_vertex_shader *shader_impl;
+    struct wined3d_shader *wined3d_shader;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_vertex_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    *shader = &shader_impl->ID3D11VertexShader_iface;
+    ID3D11VertexShader_AddRef(*shader);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetInputLayout(ID3D11DeviceContext1 *iface,
+        ID3D11InputLayout **input_layout)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_vertex_declaration *wined3d_declaration;
+    struct d3d_input_layout *input_layout_impl;
+
+    TRACE("iface %p, input_layout %p.\n", iface, input_layout);
+
+    wined3d_mutex_lock();
+    if (!(wined3d_declaration = wined3d_device_get_vertex_declaration(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *input_layout = NULL;
+        return;
+    }
+
+    input_layout_impl = wined3d_vertex_declaration_get_parent(wined3d_declaration);
+    wined3d_mutex_unlock();
+    *input_layout = &input_layout_impl->ID3D11InputLayout_iface;
+    ID3D11InputLayout_AddRef(*input_layout);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetVertexBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *strides, UINT *offsets)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p.\n",
+            iface, start_slot, buffer_count, buffers, strides, offsets);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct wined3d_buffer *wined3d_buffer = NULL;
+        struct d3d_buffer *buffer_impl;
+
+        if (FAILED(wined3d_device_get_stream_source(device->wined3d_device, start_slot + i,
+                &wined3d_buffer, &offsets[i], &strides[i])))
+        {
+            FIXME("Failed to get vertex buffer %u.\n", start_slot + i);
+            if (strides)
+                strides[i] = 0;
+            if (offsets)
+                offsets[i] = 0;
+        }
+
+        if (!wined3d_buffer)
+        {
+            buffers[i] = NULL;
+            continue;
+        }
+
+        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
+        ID3D11Buffer_AddRef(buffers[i] = &buffer_impl->ID3D11Buffer_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetIndexBuffer(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer **buffer, DXGI_FORMAT *format, UINT *offset)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    enum wined3d_format_id wined3d_format;
+    struct wined3d_buffer *wined3d_buffer;
+    struct d3d_buffer *buffer_impl;
+
+    TRACE("iface %p, buffer %p, format %p, offset %p.\n", iface, buffer, format, offset);
+
+    wined3d_mutex_lock();
+    wined3d_buffer = wined3d_device_get_index_buffer(device->wined3d_device, &wined3d_format, offset);
+    *format = dxgi_format_from_wined3dformat(wined3d_format);
+    if (!wined3d_buffer)
+    {
+        wined3d_mutex_unlock();
+        *buffer = NULL;
+        return;
+    }
+
+    buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
+    wined3d_mutex_unlock();
+    ID3D11Buffer_AddRef(*buffer = &buffer_impl->ID3D11Buffer_iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_GEOMETRY, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11GeometryShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_geometry_shader *shader_impl;
+    struct wined3d_shader *wined3d_shader;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_geometry_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    *shader = &shader_impl->ID3D11GeometryShader_iface;
+    ID3D11GeometryShader_AddRef(*shader);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetPrimitiveTopology(ID3D11DeviceContext1 *iface,
+        D3D11_PRIMITIVE_TOPOLOGY *topology)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    enum wined3d_primitive_type primitive_type;
+    unsigned int patch_vertex_count;
+
+    TRACE("iface %p, topology %p.\n", iface, topology);
+
+    wined3d_mutex_lock();
+    wined3d_device_get_primitive_type(device->wined3d_device, &primitive_type, &patch_vertex_count);
+    wined3d_mutex_unlock();
+
+    d3d11_primitive_topology_from_wined3d_primitive_type(primitive_type, patch_vertex_count, topology);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_vs_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
+        ID3D11ShaderResourceView_AddRef(views[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct wined3d_sampler *wined3d_sampler;
+        struct d3d_sampler_state *sampler_impl;
+
+        if (!(wined3d_sampler = wined3d_device_get_vs_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
+        ID3D11SamplerState_AddRef(samplers[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GetPredication(ID3D11DeviceContext1 *iface,
+        ID3D11Predicate **predicate, BOOL *value)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_query *wined3d_predicate;
+    struct d3d_query *predicate_impl;
+
+    TRACE("iface %p, predicate %p, value %p.\n", iface, predicate, value);
+
+    wined3d_mutex_lock();
+    if (!(wined3d_predicate = wined3d_device_get_predication(device->wined3d_device, value)))
+    {
+        wined3d_mutex_unlock();
+        *predicate = NULL;
+        return;
+    }
+
+    predicate_impl = wined3d_query_get_parent(wined3d_predicate);
+    wined3d_mutex_unlock();
+    *predicate = (ID3D11Predicate *)&predicate_impl->ID3D11Query_iface;
+    ID3D11Predicate_AddRef(*predicate);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_gs_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
+        ID3D11ShaderResourceView_AddRef(views[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler_impl;
+        struct wined3d_sampler *wined3d_sampler;
+
+        if (!(wined3d_sampler = wined3d_device_get_gs_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
+        ID3D11SamplerState_AddRef(samplers[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetRenderTargets(ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView **render_target_views,
+        ID3D11DepthStencilView **depth_stencil_view)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_rendertarget_view *wined3d_view;
+
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view);
+
+    wined3d_mutex_lock();
+    if (render_target_views)
+    {
+        struct d3d_rendertarget_view *view_impl;
+        unsigned int i;
+
+        for (i = 0; i < render_target_view_count; ++i)
+        {
+            if (!(wined3d_view = wined3d_device_get_rendertarget_view(device->wined3d_device, i))
+                    || !(view_impl = wined3d_rendertarget_view_get_parent(wined3d_view)))
+            {
+                render_target_views[i] = NULL;
+                continue;
+            }
+
+            render_target_views[i] = &view_impl->ID3D11RenderTargetView_iface;
+            ID3D11RenderTargetView_AddRef(render_target_views[i]);
+        }
+    }
+
+    if (depth_stencil_view)
+    {
+        struct d3d_depthstencil_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_depth_stencil_view(device->wined3d_device))
+                || !(view_impl = wined3d_rendertarget_view_get_parent(wined3d_view)))
+        {
+            *depth_stencil_view = NULL;
+        }
+        else
+        {
+            *depth_stencil_view = &view_impl->ID3D11DepthStencilView_iface;
+            ID3D11DepthStencilView_AddRef(*depth_stencil_view);
+        }
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetRenderTargetsAndUnorderedAccessViews(
+        ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView **render_target_views,
+        ID3D11DepthStencilView **depth_stencil_view,
+        UINT unordered_access_view_start_slot, UINT unordered_access_view_count,
+        ID3D11UnorderedAccessView **unordered_access_views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_unordered_access_view *wined3d_view;
+    struct d3d11_unordered_access_view *view_impl;
+    unsigned int i;
+
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p, "
+            "unordered_access_view_start_slot %u, unordered_access_view_count %u, "
+            "unordered_access_views %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view,
+            unordered_access_view_start_slot, unordered_access_view_count, unordered_access_views);
+
+    if (render_target_views || depth_stencil_view)
+        d3d11_immediate_context_OMGetRenderTargets(iface, render_target_view_count,
+                render_target_views, depth_stencil_view);
+
+    if (unordered_access_views)
+    {
+        wined3d_mutex_lock();
+        for (i = 0; i < unordered_access_view_count; ++i)
+        {
+            if (!(wined3d_view = wined3d_device_get_unordered_access_view(device->wined3d_device,
+                    unordered_access_view_start_slot + i)))
+            {
+                unordered_access_views[i] = NULL;
+                continue;
+            }
+
+            view_impl = wined3d_unordered_access_view_get_parent(wined3d_view);
+            unordered_access_views[i] = &view_impl->ID3D11UnorderedAccessView_iface;
+            ID3D11UnorderedAccessView_AddRef(unordered_access_views[i]);
+        }
+        wined3d_mutex_unlock();
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetBlendState(ID3D11DeviceContext1 *iface,
+        ID3D11BlendState **blend_state, FLOAT blend_factor[4], UINT *sample_mask)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_blend_state *wined3d_state;
+    struct d3d_blend_state *blend_state_impl;
+
+    TRACE("iface %p, blend_state %p, blend_factor %p, sample_mask %p.\n",
+            iface, blend_state, blend_factor, sample_mask);
+
+    wined3d_mutex_lock();
+    if ((wined3d_state = wined3d_device_get_blend_state(device->wined3d_device,
+            (struct wined3d_color *)blend_factor, sample_mask)))
+    {
+        blend_state_impl = wined3d_blend_state_get_parent(wined3d_state);
+        ID3D11BlendState_AddRef(*blend_state = &blend_state_impl->ID3D11BlendState_iface);
+    }
+    else
+    {
+        *blend_state = NULL;
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetDepthStencilState(ID3D11DeviceContext1 *iface,
+        ID3D11DepthStencilState **depth_stencil_state, UINT *stencil_ref)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, depth_stencil_state %p, stencil_ref %p.\n",
+            iface, depth_stencil_state, stencil_ref);
+
+    if ((*depth_stencil_state = device->depth_stencil_state
+            ? &device->depth_stencil_state->ID3D11DepthStencilState_iface : NULL))
+        ID3D11DepthStencilState_AddRef(*depth_stencil_state);
+    *stencil_ref = device->stencil_ref;
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_SOGetTargets(ID3D11DeviceContext1 *iface,
+        UINT buffer_count, ID3D11Buffer **buffers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, buffer_count %u, buffers %p.\n", iface, buffer_count, buffers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct wined3d_buffer *wined3d_buffer;
+        struct d3d_buffer *buffer_impl;
+
+        if (!(wined3d_buffer = wined3d_device_get_stream_output(device->wined3d_device, i, NULL)))
+        {
+            buffers[i] = NULL;
+            continue;
+        }
+
+        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
+        buffers[i] = &buffer_impl->ID3D11Buffer_iface;
+        ID3D11Buffer_AddRef(buffers[i]);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetState(ID3D11DeviceContext1 *iface,
+        ID3D11RasterizerState **rasterizer_state)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d_rasterizer_state *rasterizer_state_impl;
+    struct wined3d_rasterizer_state *wined3d_state;
+
+    TRACE("iface %p, rasterizer_state %p.\n", iface, rasterizer_state);
+
+    wined3d_mutex_lock();
+    if ((wined3d_state = wined3d_device_get_rasterizer_state(device->wined3d_device)))
+    {
+        rasterizer_state_impl = wined3d_rasterizer_state_get_parent(wined3d_state);
+        ID3D11RasterizerState_AddRef(*rasterizer_state = &rasterizer_state_impl->ID3D11RasterizerState_iface);
+    }
+    else
+    {
+        *rasterizer_state = NULL;
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetViewports(ID3D11DeviceContext1 *iface,
+        UINT *viewport_count, D3D11_VIEWPORT *viewports)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_viewport wined3d_vp[WINED3D_MAX_VIEWPORTS];
+    unsigned int actual_count = ARRAY_SIZE(wined3d_vp), i;
+
+    TRACE("iface %p, viewport_count %p, viewports %p.\n", iface, viewport_count, viewports);
+
+    if (!viewport_count)
+        return;
+
+    wined3d_mutex_lock();
+    wined3d_device_get_viewports(device->wined3d_device, &actual_count, viewports ? wined3d_vp : NULL);
+    wined3d_mutex_unlock();
+
+    if (!viewports)
+    {
+        *viewport_count = actual_count;
+        return;
+    }
+
+    if (*viewport_count > actual_count)
+        memset(&viewports[actual_count], 0, (*viewport_count - actual_count) * sizeof(*viewports));
+
+    *viewport_count = min(actual_count, *viewport_count);
+    for (i = 0; i < *viewport_count; ++i)
+    {
+        viewports[i].TopLeftX = wined3d_vp[i].x;
+        viewports[i].TopLeftY = wined3d_vp[i].y;
+        viewports[i].Width = wined3d_vp[i].width;
+        viewports[i].Height = wined3d_vp[i].height;
+        viewports[i].MinDepth = wined3d_vp[i].min_z;
+        viewports[i].MaxDepth = wined3d_vp[i].max_z;
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetScissorRects(ID3D11DeviceContext1 *iface,
+        UINT *rect_count, D3D11_RECT *rects)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int actual_count;
+
+    TRACE("iface %p, rect_count %p, rects %p.\n", iface, rect_count, rects);
+
+    if (!rect_count)
+        return;
+
+    actual_count = *rect_count;
+
+    wined3d_mutex_lock();
+    wined3d_device_get_scissor_rects(device->wined3d_device, &actual_count, rects);
+    wined3d_mutex_unlock();
+
+    if (!rects)
+    {
+        *rect_count = actual_count;
+        return;
+    }
+
+    if (*rect_count > actual_count)
+        memset(&rects[actual_count], 0, (*rect_count - actual_count) * sizeof(*rects));
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_hs_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11HullShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_hull_shader *shader_impl;
+    struct wined3d_shader *wined3d_shader;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_hull_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    ID3D11HullShader_AddRef(*shader = &shader_impl->ID3D11HullShader_iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct wined3d_sampler *wined3d_sampler;
+        struct d3d_sampler_state *sampler_impl;
+
+        if (!(wined3d_sampler = wined3d_device_get_hs_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_HULL, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_ds_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11DomainShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_domain_shader *shader_impl;
+    struct wined3d_shader *wined3d_shader;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_domain_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    ID3D11DomainShader_AddRef(*shader = &shader_impl->ID3D11DomainShader_iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct wined3d_sampler *wined3d_sampler;
+        struct d3d_sampler_state *sampler_impl;
+
+        if (!(wined3d_sampler = wined3d_device_get_ds_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_shader_resource_view *wined3d_view;
+        struct d3d_shader_resource_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_cs_resource_view(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
+        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11UnorderedAccessView **views)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < view_count; ++i)
+    {
+        struct wined3d_unordered_access_view *wined3d_view;
+        struct d3d11_unordered_access_view *view_impl;
+
+        if (!(wined3d_view = wined3d_device_get_cs_uav(device->wined3d_device, start_slot + i)))
+        {
+            views[i] = NULL;
+            continue;
+        }
+
+        view_impl = wined3d_unordered_access_view_get_parent(wined3d_view);
+        ID3D11UnorderedAccessView_AddRef(views[i] = &view_impl->ID3D11UnorderedAccessView_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11ComputeShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_compute_shader *shader_impl;
+    struct wined3d_shader *wined3d_shader;
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
+
+    wined3d_mutex_lock();
+    if (!(wined3d_shader = wined3d_device_get_compute_shader(device->wined3d_device)))
+    {
+        wined3d_mutex_unlock();
+        *shader = NULL;
+        return;
+    }
+
+    shader_impl = wined3d_shader_get_parent(wined3d_shader);
+    wined3d_mutex_unlock();
+    ID3D11ComputeShader_AddRef(*shader = &shader_impl->ID3D11ComputeShader_iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    wined3d_mutex_lock();
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct wined3d_sampler *wined3d_sampler;
+        struct d3d_sampler_state *sampler_impl;
+
+        if (!(wined3d_sampler = wined3d_device_get_cs_sampler(device->wined3d_device, start_slot + i)))
+        {
+            samplers[i] = NULL;
+            continue;
+        }
+
+        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
+        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
+    }
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearState(ID3D11DeviceContext1 *iface)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    static const float blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    unsigned int i, j;
+
+    TRACE("iface %p.\n", iface);
+
+    wined3d_mutex_lock();
+    wined3d_device_set_vertex_shader(device->wined3d_device, NULL);
+    wined3d_device_set_hull_shader(device->wined3d_device, NULL);
+    wined3d_device_set_domain_shader(device->wined3d_device, NULL);
+    wined3d_device_set_geometry_shader(device->wined3d_device, NULL);
+    wined3d_device_set_pixel_shader(device->wined3d_device, NULL);
+    wined3d_device_set_compute_shader(device->wined3d_device, NULL);
+    for (i = 0; i < D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT; ++i)
+    {
+        wined3d_device_set_vs_sampler(device->wined3d_device, i, NULL);
+        wined3d_device_set_hs_sampler(device->wined3d_device, i, NULL);
+        wined3d_device_set_ds_sampler(device->wined3d_device, i, NULL);
+        wined3d_device_set_gs_sampler(device->wined3d_device, i, NULL);
+        wined3d_device_set_ps_sampler(device->wined3d_device, i, NULL);
+        wined3d_device_set_cs_sampler(device->wined3d_device, i, NULL);
+    }
+    for (i = 0; i < D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT; ++i)
+    {
+        wined3d_device_set_vs_resource_view(device->wined3d_device, i, NULL);
+        wined3d_device_set_hs_resource_view(device->wined3d_device, i, NULL);
+        wined3d_device_set_ds_resource_view(device->wined3d_device, i, NULL);
+        wined3d_device_set_gs_resource_view(device->wined3d_device, i, NULL);
+        wined3d_device_set_ps_resource_view(device->wined3d_device, i, NULL);
+        wined3d_device_set_cs_resource_view(device->wined3d_device, i, NULL);
+    }
+    for (i = 0; i < WINED3D_SHADER_TYPE_COUNT; ++i)
+    {
+        for (j = 0; j < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT; ++j)
+            wined3d_device_set_constant_buffer(device->wined3d_device, i, j, NULL);
+    }
+    for (i = 0; i < D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT; ++i)
+    {
+        wined3d_device_set_stream_source(device->wined3d_device, i, NULL, 0, 0);
+    }
+    wined3d_device_set_index_buffer(device->wined3d_device, NULL, WINED3DFMT_UNKNOWN, 0);
+    wined3d_device_set_vertex_declaration(device->wined3d_device, NULL);
+    wined3d_device_set_primitive_type(device->wined3d_device, WINED3D_PT_UNDEFINED, 0);
+    for (i = 0; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+    {
+        wined3d_device_set_rendertarget_view(device->wined3d_device, i, NULL, FALSE);
+    }
+    wined3d_device_set_depth_stencil_view(device->wined3d_device, NULL);
+    for (i = 0; i < D3D11_PS_CS_UAV_REGISTER_COUNT; ++i)
+    {
+        wined3d_device_set_unordered_access_view(device->wined3d_device, i, NULL, ~0u);
+        wined3d_device_set_cs_uav(device->wined3d_device, i, NULL, ~0u);
+    }
+    ID3D11DeviceContext1_OMSetDepthStencilState(iface, NULL, 0);
+    ID3D11DeviceContext1_OMSetBlendState(iface, NULL, blend_factor, D3D11_DEFAULT_SAMPLE_MASK);
+    ID3D11DeviceContext1_RSSetViewports(iface, 0, NULL);
+    ID3D11DeviceContext1_RSSetScissorRects(iface, 0, NULL);
+    ID3D11DeviceContext1_RSSetState(iface, NULL);
+    for (i = 0; i < D3D11_SO_BUFFER_SLOT_COUNT; ++i)
+    {
+        wined3d_device_set_stream_output(device->wined3d_device, i, NULL, 0);
+    }
+    wined3d_device_set_predication(device->wined3d_device, NULL, FALSE);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_Flush(ID3D11DeviceContext1 *iface)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p.\n", iface);
+
+    wined3d_mutex_lock();
+    wined3d_device_flush(device->wined3d_device);
+    wined3d_mutex_unlock();
+}
+
+static D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE d3d11_immediate_context_GetType(ID3D11DeviceContext1 *iface)
+{
+    TRACE("iface %p.\n", iface);
+
+    return D3D11_DEVICE_CONTEXT_IMMEDIATE;
+}
+
+static UINT STDMETHODCALLTYPE d3d11_immediate_context_GetContextFlags(ID3D11DeviceContext1 *iface)
+{
+    TRACE("iface %p.\n", iface);
+
+    return 0;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_FinishCommandList(ID3D11DeviceContext1 *iface,
+        BOOL restore, ID3D11CommandList **command_list)
+{
+    TRACE("iface %p, restore %#x, command_list %p.\n", iface, restore, command_list);
+
+    return DXGI_ERROR_INVALID_CALL;
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_CopySubresourceRegion1(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
+        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box, UINT flags)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+    struct wined3d_box wined3d_src_box;
+
+    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
+            "src_resource %p, src_subresource_idx %u, src_box %p, flags %#x.\n",
+            iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
+            src_resource, src_subresource_idx, src_box, flags);
+
+    if (!dst_resource || !src_resource)
+        return;
+
+    if (src_box)
+        wined3d_box_set(&wined3d_src_box, src_box->left, src_box->top,
+                src_box->right, src_box->bottom, src_box->front, src_box->back);
+
+    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
+    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
+    wined3d_mutex_lock();
+    wined3d_device_copy_sub_resource_region(device->wined3d_device, wined3d_dst_resource, dst_subresource_idx,
+            dst_x, dst_y, dst_z, wined3d_src_resource, src_subresource_idx, src_box ? &wined3d_src_box : NULL, flags);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_UpdateSubresource1(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box, const void *data,
+        UINT row_pitch, UINT depth_pitch, UINT flags)
+{
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_resource;
+    struct wined3d_box wined3d_box;
+
+    TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u, flags %#x.\n",
+            iface, resource, subresource_idx, box, data, row_pitch, depth_pitch, flags);
+
+    if (box)
+        wined3d_box_set(&wined3d_box, box->left, box->top, box->right, box->bottom,
+                box->front, box->back);
 
     wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+    wined3d_mutex_lock();
+    wined3d_device_update_sub_resource(device->wined3d_device, wined3d_resource, subresource_idx,
+            box ? &wined3d_box : NULL, data, row_pitch, depth_pitch, flags);
+    wined3d_mutex_unlock();
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardResource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource)
+{
+    FIXME("iface %p, resource %p stub!\n", iface, resource);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardView(ID3D11DeviceContext1 *iface, ID3D11View *view)
+{
+    FIXME("iface %p, view %p stub!\n", iface, view);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
 
-    wined3d_mutex_lock();
-    hr = wined3d_resource_map(wined3d_resource, subresource_idx,
-            &map_desc, NULL, wined3d_map_flags_from_d3d11_map_type(map_type));
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
 
-    mapped_subresource->pData = map_desc.data;
-    mapped_subresource->RowPitch = map_desc.row_pitch;
-    mapped_subresource->DepthPitch = map_desc.slice_pitch;
+static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
 
-    return hr;
+static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_Unmap(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
-        UINT subresource_idx)
+static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
-    struct wined3d_resource *wined3d_resource;
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
 
-    TRACE("iface %p, resource %p, subresource_idx %u.\n", iface, resource, subresource_idx);
+static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
 
-    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
 
-    wined3d_mutex_lock();
-    wined3d_resource_unmap(wined3d_resource, subresource_idx);
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetConstantBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+static void STDMETHODCALLTYPE d3d11_immediate_context_SwapDeviceContextState(ID3D11DeviceContext1 *iface,
+        ID3DDeviceContextState *state, ID3DDeviceContextState **prev_state)
 {
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
+    FIXME("iface %p, state %p, prev_state %p stub!\n", iface, state, prev_state);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_ClearView(ID3D11DeviceContext1 *iface, ID3D11View *view,
+        const FLOAT color[4], const D3D11_RECT *rect, UINT num_rects)
+{
+    FIXME("iface %p, view %p, color %p, rect %p, num_rects %u stub!\n", iface, view, color, rect, num_rects);
+}
+
+static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardView1(ID3D11DeviceContext1 *iface, ID3D11View *view,
+        const D3D11_RECT *rects, UINT num_rects)
+{
+    FIXME("iface %p, view %p, rects %p, num_rects %u stub!\n", iface, view, rects, num_rects);
+}
+
+static const struct ID3D11DeviceContext1Vtbl d3d11_immediate_context_vtbl =
+{
+    /* IUnknown methods */
+    d3d11_immediate_context_QueryInterface,
+    d3d11_immediate_context_AddRef,
+    d3d11_immediate_context_Release,
+    /* ID3D11DeviceChild methods */
+    d3d11_immediate_context_GetDevice,
+    d3d11_immediate_context_GetPrivateData,
+    d3d11_immediate_context_SetPrivateData,
+    d3d11_immediate_context_SetPrivateDataInterface,
+    /* ID3D11DeviceContext methods */
+    d3d11_immediate_context_VSSetConstantBuffers,
+    d3d11_immediate_context_PSSetShaderResources,
+    d3d11_immediate_context_PSSetShader,
+    d3d11_immediate_context_PSSetSamplers,
+    d3d11_immediate_context_VSSetShader,
+    d3d11_immediate_context_DrawIndexed,
+    d3d11_immediate_context_Draw,
+    d3d11_immediate_context_Map,
+    d3d11_immediate_context_Unmap,
+    d3d11_immediate_context_PSSetConstantBuffers,
+    d3d11_immediate_context_IASetInputLayout,
+    d3d11_immediate_context_IASetVertexBuffers,
+    d3d11_immediate_context_IASetIndexBuffer,
+    d3d11_immediate_context_DrawIndexedInstanced,
+    d3d11_immediate_context_DrawInstanced,
+    d3d11_immediate_context_GSSetConstantBuffers,
+    d3d11_immediate_context_GSSetShader,
+    d3d11_immediate_context_IASetPrimitiveTopology,
+    d3d11_immediate_context_VSSetShaderResources,
+    d3d11_immediate_context_VSSetSamplers,
+    d3d11_immediate_context_Begin,
+    d3d11_immediate_context_End,
+    d3d11_immediate_context_GetData,
+    d3d11_immediate_context_SetPredication,
+    d3d11_immediate_context_GSSetShaderResources,
+    d3d11_immediate_context_GSSetSamplers,
+    d3d11_immediate_context_OMSetRenderTargets,
+    d3d11_immediate_context_OMSetRenderTargetsAndUnorderedAccessViews,
+    d3d11_immediate_context_OMSetBlendState,
+    d3d11_immediate_context_OMSetDepthStencilState,
+    d3d11_immediate_context_SOSetTargets,
+    d3d11_immediate_context_DrawAuto,
+    d3d11_immediate_context_DrawIndexedInstancedIndirect,
+    d3d11_immediate_context_DrawInstancedIndirect,
+    d3d11_immediate_context_Dispatch,
+    d3d11_immediate_context_DispatchIndirect,
+    d3d11_immediate_context_RSSetState,
+    d3d11_immediate_context_RSSetViewports,
+    d3d11_immediate_context_RSSetScissorRects,
+    d3d11_immediate_context_CopySubresourceRegion,
+    d3d11_immediate_context_CopyResource,
+    d3d11_immediate_context_UpdateSubresource,
+    d3d11_immediate_context_CopyStructureCount,
+    d3d11_immediate_context_ClearRenderTargetView,
+    d3d11_immediate_context_ClearUnorderedAccessViewUint,
+    d3d11_immediate_context_ClearUnorderedAccessViewFloat,
+    d3d11_immediate_context_ClearDepthStencilView,
+    d3d11_immediate_context_GenerateMips,
+    d3d11_immediate_context_SetResourceMinLOD,
+    d3d11_immediate_context_GetResourceMinLOD,
+    d3d11_immediate_context_ResolveSubresource,
+    d3d11_immediate_context_ExecuteCommandList,
+    d3d11_immediate_context_HSSetShaderResources,
+    d3d11_immediate_context_HSSetShader,
+    d3d11_immediate_context_HSSetSamplers,
+    d3d11_immediate_context_HSSetConstantBuffers,
+    d3d11_immediate_context_DSSetShaderResources,
+    d3d11_immediate_context_DSSetShader,
+    d3d11_immediate_context_DSSetSamplers,
+    d3d11_immediate_context_DSSetConstantBuffers,
+    d3d11_immediate_context_CSSetShaderResources,
+    d3d11_immediate_context_CSSetUnorderedAccessViews,
+    d3d11_immediate_context_CSSetShader,
+    d3d11_immediate_context_CSSetSamplers,
+    d3d11_immediate_context_CSSetConstantBuffers,
+    d3d11_immediate_context_VSGetConstantBuffers,
+    d3d11_immediate_context_PSGetShaderResources,
+    d3d11_immediate_context_PSGetShader,
+    d3d11_immediate_context_PSGetSamplers,
+    d3d11_immediate_context_VSGetShader,
+    d3d11_immediate_context_PSGetConstantBuffers,
+    d3d11_immediate_context_IAGetInputLayout,
+    d3d11_immediate_context_IAGetVertexBuffers,
+    d3d11_immediate_context_IAGetIndexBuffer,
+    d3d11_immediate_context_GSGetConstantBuffers,
+    d3d11_immediate_context_GSGetShader,
+    d3d11_immediate_context_IAGetPrimitiveTopology,
+    d3d11_immediate_context_VSGetShaderResources,
+    d3d11_immediate_context_VSGetSamplers,
+    d3d11_immediate_context_GetPredication,
+    d3d11_immediate_context_GSGetShaderResources,
+    d3d11_immediate_context_GSGetSamplers,
+    d3d11_immediate_context_OMGetRenderTargets,
+    d3d11_immediate_context_OMGetRenderTargetsAndUnorderedAccessViews,
+    d3d11_immediate_context_OMGetBlendState,
+    d3d11_immediate_context_OMGetDepthStencilState,
+    d3d11_immediate_context_SOGetTargets,
+    d3d11_immediate_context_RSGetState,
+    d3d11_immediate_context_RSGetViewports,
+    d3d11_immediate_context_RSGetScissorRects,
+    d3d11_immediate_context_HSGetShaderResources,
+    d3d11_immediate_context_HSGetShader,
+    d3d11_immediate_context_HSGetSamplers,
+    d3d11_immediate_context_HSGetConstantBuffers,
+    d3d11_immediate_context_DSGetShaderResources,
+    d3d11_immediate_context_DSGetShader,
+    d3d11_immediate_context_DSGetSamplers,
+    d3d11_immediate_context_DSGetConstantBuffers,
+    d3d11_immediate_context_CSGetShaderResources,
+    d3d11_immediate_context_CSGetUnorderedAccessViews,
+    d3d11_immediate_context_CSGetShader,
+    d3d11_immediate_context_CSGetSamplers,
+    d3d11_immediate_context_CSGetConstantBuffers,
+    d3d11_immediate_context_ClearState,
+    d3d11_immediate_context_Flush,
+    d3d11_immediate_context_GetType,
+    d3d11_immediate_context_GetContextFlags,
+    d3d11_immediate_context_FinishCommandList,
+    /* ID3D11DeviceContext1 methods */
+    d3d11_immediate_context_CopySubresourceRegion1,
+    d3d11_immediate_context_UpdateSubresource1,
+    d3d11_immediate_context_DiscardResource,
+    d3d11_immediate_context_DiscardView,
+    d3d11_immediate_context_VSSetConstantBuffers1,
+    d3d11_immediate_context_HSSetConstantBuffers1,
+    d3d11_immediate_context_DSSetConstantBuffers1,
+    d3d11_immediate_context_GSSetConstantBuffers1,
+    d3d11_immediate_context_PSSetConstantBuffers1,
+    d3d11_immediate_context_CSSetConstantBuffers1,
+    d3d11_immediate_context_VSGetConstantBuffers1,
+    d3d11_immediate_context_HSGetConstantBuffers1,
+    d3d11_immediate_context_DSGetConstantBuffers1,
+    d3d11_immediate_context_GSGetConstantBuffers1,
+    d3d11_immediate_context_PSGetConstantBuffers1,
+    d3d11_immediate_context_CSGetConstantBuffers1,
+    d3d11_immediate_context_SwapDeviceContextState,
+    d3d11_immediate_context_ClearView,
+    d3d11_immediate_context_DiscardView1,
+};
+
+/* ID3D11Multithread methods */
+
+static inline struct d3d11_immediate_context *impl_from_ID3D11Multithread(ID3D11Multithread *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d11_immediate_context, ID3D11Multithread_iface);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_multithread_QueryInterface(ID3D11Multithread *iface,
+        REFIID iid, void **out)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
+
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+
+    return d3d11_immediate_context_QueryInterface(&context->ID3D11DeviceContext1_iface, iid, out);
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_multithread_AddRef(ID3D11Multithread *iface)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
+
+    TRACE("iface %p.\n", iface);
+
+    return d3d11_immediate_context_AddRef(&context->ID3D11DeviceContext1_iface);
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_multithread_Release(ID3D11Multithread *iface)
+{
+    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
+
+    TRACE("iface %p.\n", iface);
 
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot,
-            buffer_count, buffers);
+    return d3d11_immediate_context_Release(&context->ID3D11DeviceContext1_iface);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IASetInputLayout(ID3D11DeviceContext1 *iface,
-        ID3D11InputLayout *input_layout)
+static void STDMETHODCALLTYPE d3d11_multithread_Enter(ID3D11Multithread *iface)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_input_layout *layout = unsafe_impl_from_ID3D11InputLayout(input_layout);
-
-    TRACE("iface %p, input_layout %p.\n", iface, input_layout);
+    TRACE("iface %p.\n", iface);
 
     wined3d_mutex_lock();
-    wined3d_device_set_vertex_declaration(device->wined3d_device, layout ? layout->wined3d_decl : NULL);
-    wined3d_mutex_unlock();
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IASetVertexBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers, const UINT *strides, const UINT *offsets)
+static void STDMETHODCALLTYPE d3d11_multithread_Leave(ID3D11Multithread *iface)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p.\n",
-            iface, start_slot, buffer_count, buffers, strides, offsets);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < buffer_count; ++i)
-    {
-        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+    TRACE("iface %p.\n", iface);
 
-        wined3d_device_set_stream_source(device->wined3d_device, start_slot + i,
-                buffer ? buffer->wined3d_buffer : NULL, offsets[i], strides[i]);
-    }
     wined3d_mutex_unlock();
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IASetIndexBuffer(ID3D11DeviceContext1 *iface,
-        ID3D11Buffer *buffer, DXGI_FORMAT format, UINT offset)
+static BOOL STDMETHODCALLTYPE d3d11_multithread_SetMultithreadProtected(
+        ID3D11Multithread *iface, BOOL enable)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_buffer *buffer_impl = unsafe_impl_from_ID3D11Buffer(buffer);
-
-    TRACE("iface %p, buffer %p, format %s, offset %u.\n",
-            iface, buffer, debug_dxgi_format(format), offset);
+    FIXME("iface %p, enable %#x stub!\n", iface, enable);
 
-    wined3d_mutex_lock();
-    wined3d_device_set_index_buffer(device->wined3d_device,
-            buffer_impl ? buffer_impl->wined3d_buffer : NULL,
-            wined3dformat_from_dxgi_format(format), offset);
-    wined3d_mutex_unlock();
+    return TRUE;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexedInstanced(ID3D11DeviceContext1 *iface,
-        UINT instance_index_count, UINT instance_count, UINT start_index_location, INT base_vertex_location,
-        UINT start_instance_location)
+static BOOL STDMETHODCALLTYPE d3d11_multithread_GetMultithreadProtected(ID3D11Multithread *iface)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-
-    TRACE("iface %p, instance_index_count %u, instance_count %u, start_index_location %u, "
-            "base_vertex_location %d, start_instance_location %u.\n",
-            iface, instance_index_count, instance_count, start_index_location,
-            base_vertex_location, start_instance_location);
+    FIXME("iface %p stub!\n", iface);
 
-    wined3d_mutex_lock();
-    wined3d_device_set_base_vertex_index(device->wined3d_device, base_vertex_location);
-    wined3d_device_draw_indexed_primitive_instanced(device->wined3d_device, start_index_location,
-            instance_index_count, start_instance_location, instance_count);
-    wined3d_mutex_unlock();
+    return TRUE;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawInstanced(ID3D11DeviceContext1 *iface,
-        UINT instance_vertex_count, UINT instance_count, UINT start_vertex_location, UINT start_instance_location)
+static const struct ID3D11MultithreadVtbl d3d11_multithread_vtbl =
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    d3d11_multithread_QueryInterface,
+    d3d11_multithread_AddRef,
+    d3d11_multithread_Release,
+    d3d11_multithread_Enter,
+    d3d11_multithread_Leave,
+    d3d11_multithread_SetMultithreadProtected,
+    d3d11_multithread_GetMultithreadProtected,
+};
 
-    TRACE("iface %p, instance_vertex_count %u, instance_count %u, start_vertex_location %u, "
-            "start_instance_location %u.\n",
-            iface, instance_vertex_count, instance_count, start_vertex_location,
-            start_instance_location);
+static void d3d11_immediate_context_init(struct d3d11_immediate_context *context, struct d3d_device *device)
+{
+    context->ID3D11DeviceContext1_iface.lpVtbl = &d3d11_immediate_context_vtbl;
+    context->ID3D11Multithread_iface.lpVtbl = &d3d11_multithread_vtbl;
+    context->refcount = 1;
 
-    wined3d_mutex_lock();
-    wined3d_device_draw_primitive_instanced(device->wined3d_device, start_vertex_location,
-            instance_vertex_count, start_instance_location, instance_count);
-    wined3d_mutex_unlock();
+    ID3D11Device2_AddRef(&device->ID3D11Device2_iface);
+
+    wined3d_private_store_init(&context->private_store);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetConstantBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+static void d3d11_immediate_context_destroy(struct d3d11_immediate_context *context)
 {
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
-
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_GEOMETRY, start_slot,
-            buffer_count, buffers);
+    wined3d_private_store_cleanup(&context->private_store);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetShader(ID3D11DeviceContext1 *iface,
-        ID3D11GeometryShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+/* ID3D11DeviceContext - deferred context methods */
+
+struct d3d11_deferred_context
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_geometry_shader *gs = unsafe_impl_from_ID3D11GeometryShader(shader);
+    ID3D11DeviceContext1 ID3D11DeviceContext1_iface;
+    LONG refcount;
 
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
-            iface, shader, class_instances, class_instance_count);
+    struct wined3d_private_store private_store;
+    struct d3d_device *device;
 
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
+    /* The command list being recorded, and the state as seen by the
+     * application, which is only needed to answer the getters. */
+    struct d3d11_command_list *list;
+    struct d3d11_context_state state;
+};
 
-    wined3d_mutex_lock();
-    wined3d_device_set_geometry_shader(device->wined3d_device, gs ? gs->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+static inline struct d3d11_deferred_context *impl_from_deferred_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d11_deferred_context, ID3D11DeviceContext1_iface);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IASetPrimitiveTopology(ID3D11DeviceContext1 *iface,
-        D3D11_PRIMITIVE_TOPOLOGY topology)
+static void d3d11_set_object(void *slot, void *object)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    enum wined3d_primitive_type primitive_type;
-    unsigned int patch_vertex_count;
-
-    TRACE("iface %p, topology %#x.\n", iface, topology);
-
-    wined3d_primitive_type_from_d3d11_primitive_topology(topology, &primitive_type, &patch_vertex_count);
+    IUnknown **unknown = slot;
 
-    wined3d_mutex_lock();
-    wined3d_device_set_primitive_type(device->wined3d_device, primitive_type, patch_vertex_count);
-    wined3d_mutex_unlock();
+    if (object)
+        IUnknown_AddRef((IUnknown *)object);
+    if (*unknown)
+        IUnknown_Release(*unknown);
+    *unknown = object;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetShaderResources(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+static BOOL d3d11_set_objects(void *dst, unsigned int dst_count, UINT start_slot, UINT count, const void *src)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    IUnknown *const *objects = src;
+    IUnknown **slots = dst;
     unsigned int i;
 
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
+    if (start_slot > dst_count || count > dst_count - start_slot)
     {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
-
-        wined3d_device_set_vs_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
+        WARN("Invalid slot range %u, count %u.\n", start_slot, count);
+        return FALSE;
     }
-    wined3d_mutex_unlock();
+
+    for (i = 0; i < count; ++i)
+        d3d11_set_object(&slots[start_slot + i], objects ? objects[i] : NULL);
+
+    return TRUE;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+static void d3d11_get_objects(void *dst, UINT start_slot, UINT count, const void *src, unsigned int src_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    IUnknown *const *slots = src;
+    IUnknown **objects = dst;
     unsigned int i;
 
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
+    for (i = 0; i < count; ++i)
     {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
-
-        wined3d_device_set_vs_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
+        if ((objects[i] = start_slot + i < src_count ? slots[start_slot + i] : NULL))
+            IUnknown_AddRef(objects[i]);
     }
-    wined3d_mutex_unlock();
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_Begin(ID3D11DeviceContext1 *iface,
-        ID3D11Asynchronous *asynchronous)
+static void d3d11_deferred_context_record_object(struct d3d11_deferred_context *context,
+        enum d3d11_deferred_op op, void *object, unsigned int value, unsigned int offset)
 {
-    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
-    HRESULT hr;
+    struct d3d11_command_list *list = context->list;
+    struct d3d11_deferred_object_packet *p;
 
-    TRACE("iface %p, asynchronous %p.\n", iface, asynchronous);
+    if (!(p = d3d11_command_list_require_space(list, op, sizeof(*p))))
+        return;
+    p->object = d3d11_command_list_add_ref(list, object);
+    p->value = value;
+    p->offset = offset;
+}
 
-    wined3d_mutex_lock();
-    if (FAILED(hr = wined3d_query_issue(query->wined3d_query, WINED3DISSUE_BEGIN)))
-        ERR("Failed to issue query, hr %#x.\n", hr);
-    wined3d_mutex_unlock();
+static void d3d11_deferred_context_record_slots(struct d3d11_deferred_context *context,
+        enum d3d11_deferred_op op, enum wined3d_shader_type shader_type, UINT start_slot, UINT count,
+        const void *objects, const UINT *values0, const UINT *values1)
+{
+    unsigned int value_count = !!values0 + !!values1, i;
+    struct d3d11_command_list *list = context->list;
+    IUnknown *const *unknowns = objects;
+    struct d3d11_deferred_slots_packet *p;
+    UINT *values;
+
+    if (!(p = d3d11_command_list_require_space(list, op,
+            FIELD_OFFSET(struct d3d11_deferred_slots_packet, objects[count]) + value_count * count * sizeof(UINT))))
+        return;
+    p->shader_type = shader_type;
+    p->start_slot = start_slot;
+    p->count = count;
+    p->value_count = value_count;
+    for (i = 0; i < count; ++i)
+        p->objects[i] = d3d11_command_list_add_ref(list, unknowns ? unknowns[i] : NULL);
+
+    values = (UINT *)&p->objects[count];
+    if (values0)
+        memcpy(values, values0, count * sizeof(*values));
+    if (values1)
+        memcpy(&values[count], values1, count * sizeof(*values));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_End(ID3D11DeviceContext1 *iface,
-        ID3D11Asynchronous *asynchronous)
+static void d3d11_deferred_context_record_draw(struct d3d11_deferred_context *context,
+        enum d3d11_deferred_op op, unsigned int arg0, unsigned int arg1, unsigned int arg2,
+        unsigned int arg3, unsigned int arg4)
 {
-    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
-    HRESULT hr;
+    struct d3d11_deferred_draw_packet *p;
 
-    TRACE("iface %p, asynchronous %p.\n", iface, asynchronous);
+    if (!(p = d3d11_command_list_require_space(context->list, op, sizeof(*p))))
+        return;
+    p->args[0] = arg0;
+    p->args[1] = arg1;
+    p->args[2] = arg2;
+    p->args[3] = arg3;
+    p->args[4] = arg4;
+}
 
-    wined3d_mutex_lock();
-    if (FAILED(hr = wined3d_query_issue(query->wined3d_query, WINED3DISSUE_END)))
-        ERR("Failed to issue query, hr %#x.\n", hr);
-    wined3d_mutex_unlock();
+static void d3d11_deferred_context_record_clear(struct d3d11_deferred_context *context,
+        enum d3d11_deferred_op op, void *view, const void *values, unsigned int flags, float depth, UINT8 stencil)
+{
+    struct d3d11_command_list *list = context->list;
+    struct d3d11_deferred_clear_packet *p;
+
+    if (!(p = d3d11_command_list_require_space(list, op, sizeof(*p))))
+        return;
+    p->view = d3d11_command_list_add_ref(list, view);
+    if (values)
+        memcpy(&p->values, values, sizeof(p->values));
+    p->flags = flags;
+    p->depth = depth;
+    p->stencil = stencil;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_GetData(ID3D11DeviceContext1 *iface,
-        ID3D11Asynchronous *asynchronous, void *data, UINT data_size, UINT data_flags)
+static void d3d11_deferred_context_record_copy(struct d3d11_deferred_context *context,
+        enum d3d11_deferred_op op, void *dst, UINT dst_idx, UINT dst_x, UINT dst_y, UINT dst_z,
+        void *src, UINT src_idx, const D3D11_BOX *box, UINT flags)
 {
-    struct d3d_query *query = unsafe_impl_from_ID3D11Asynchronous(asynchronous);
-    unsigned int wined3d_flags;
-    HRESULT hr;
+    struct d3d11_command_list *list = context->list;
+    struct d3d11_deferred_copy_packet *p;
 
-    TRACE("iface %p, asynchronous %p, data %p, data_size %u, data_flags %#x.\n",
-            iface, asynchronous, data, data_size, data_flags);
+    if (!(p = d3d11_command_list_require_space(list, op, sizeof(*p))))
+        return;
+    p->dst = d3d11_command_list_add_ref(list, dst);
+    p->dst_idx = dst_idx;
+    p->dst_x = dst_x;
+    p->dst_y = dst_y;
+    p->dst_z = dst_z;
+    p->src = d3d11_command_list_add_ref(list, src);
+    p->src_idx = src_idx;
+    if ((p->has_box = !!box))
+        p->box = *box;
+    p->flags = flags;
+}
+
+static unsigned int d3d11_get_format_block_height(enum wined3d_format_id format)
+{
+    switch (format)
+    {
+        case WINED3DFMT_BC1_TYPELESS:
+        case WINED3DFMT_BC1_UNORM:
+        case WINED3DFMT_BC1_UNORM_SRGB:
+        case WINED3DFMT_BC2_TYPELESS:
+        case WINED3DFMT_BC2_UNORM:
+        case WINED3DFMT_BC2_UNORM_SRGB:
+        case WINED3DFMT_BC3_TYPELESS:
+        case WINED3DFMT_BC3_UNORM:
+        case WINED3DFMT_BC3_UNORM_SRGB:
+        case WINED3DFMT_BC4_TYPELESS:
+        case WINED3DFMT_BC4_UNORM:
+        case WINED3DFMT_BC4_SNORM:
+        case WINED3DFMT_BC5_TYPELESS:
+        case WINED3DFMT_BC5_UNORM:
+        case WINED3DFMT_BC5_SNORM:
+        case WINED3DFMT_BC6H_TYPELESS:
+        case WINED3DFMT_BC6H_UF16:
+        case WINED3DFMT_BC6H_SF16:
+        case WINED3DFMT_BC7_TYPELESS:
+        case WINED3DFMT_BC7_UNORM:
+        case WINED3DFMT_BC7_UNORM_SRGB:
+            return 4;
 
-    if (!data && data_size)
-        return E_INVALIDARG;
+        default:
+            return 1;
+    }
+}
 
-    wined3d_flags = wined3d_getdata_flags_from_d3d11_async_getdata_flags(data_flags);
+/* Returns the size in bytes of a row of blocks, the number of block rows and
+ * the number of slices covered by "box", or by the whole sub-resource. */
+static HRESULT d3d11_deferred_context_get_layout(struct d3d11_deferred_context *context,
+        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box,
+        unsigned int *row_size, unsigned int *row_count, unsigned int *slice_count)
+{
+    struct wined3d_device *wined3d_device = context->device->wined3d_device;
+    struct wined3d_device_creation_parameters params;
+    struct wined3d_sub_resource_desc sub_desc;
+    struct wined3d_resource *wined3d_resource;
+    struct wined3d_resource_desc desc;
+    struct wined3d_adapter *adapter;
+    unsigned int block_height;
+    HRESULT hr;
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
 
     wined3d_mutex_lock();
-    if (!data_size || wined3d_query_get_data_size(query->wined3d_query) == data_size)
+    wined3d_resource_get_desc(wined3d_resource, &desc);
+    if (desc.resource_type == WINED3D_RTYPE_BUFFER)
     {
-        hr = wined3d_query_get_data(query->wined3d_query, data, data_size, wined3d_flags);
-        if (hr == WINED3DERR_INVALIDCALL)
-            hr = DXGI_ERROR_INVALID_CALL;
+        wined3d_mutex_unlock();
+        *row_size = box ? box->right - box->left : desc.size;
+        *row_count = *slice_count = 1;
+        return S_OK;
     }
-    else
+
+    if (FAILED(hr = wined3d_texture_get_sub_resource_desc(wined3d_texture_from_resource(wined3d_resource),
+            subresource_idx, &sub_desc)))
     {
-        WARN("Invalid data size %u.\n", data_size);
-        hr = E_INVALIDARG;
+        wined3d_mutex_unlock();
+        return hr;
     }
-    wined3d_mutex_unlock();
-
-    return hr;
-}
-
-static void STDMETHODCALLTYPE d3d11_immediate_context_SetPredication(ID3D11DeviceContext1 *iface,
-        ID3D11Predicate *predicate, BOOL value)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_query *query;
 
-    TRACE("iface %p, predicate %p, value %#x.\n", iface, predicate, value);
+    wined3d_device_get_creation_parameters(wined3d_device, &params);
+    adapter = wined3d_get_adapter(wined3d_device_get_wined3d(wined3d_device), params.adapter_idx);
+    *row_size = wined3d_calculate_format_pitch(adapter, sub_desc.format,
+            box ? box->right - box->left : sub_desc.width);
+    wined3d_mutex_unlock();
 
-    query = unsafe_impl_from_ID3D11Query((ID3D11Query *)predicate);
+    block_height = d3d11_get_format_block_height(sub_desc.format);
+    *row_count = ((box ? box->bottom - box->top : sub_desc.height) + block_height - 1) / block_height;
+    *slice_count = box ? box->back - box->front : sub_desc.depth;
 
-    wined3d_mutex_lock();
-    wined3d_device_set_predication(device->wined3d_device, query ? query->wined3d_query : NULL, value);
-    wined3d_mutex_unlock();
+    return S_OK;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetShaderResources(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_QueryInterface(ID3D11DeviceContext1 *iface,
+        REFIID iid, void **out)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
+    if (IsEqualGUID(iid, &IID_ID3D11DeviceContext1)
+            || IsEqualGUID(iid, &IID_ID3D11DeviceContext)
+            || IsEqualGUID(iid, &IID_ID3D11DeviceChild)
+            || IsEqualGUID(iid, &IID_IUnknown))
     {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
-
-        wined3d_device_set_gs_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
+        ID3D11DeviceContext1_AddRef(iface);
+        *out = iface;
+        return S_OK;
     }
-    wined3d_mutex_unlock();
+
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
+
+    *out = NULL;
+    return E_NOINTERFACE;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+static ULONG STDMETHODCALLTYPE d3d11_deferred_context_AddRef(ID3D11DeviceContext1 *iface)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    ULONG refcount = InterlockedIncrement(&context->refcount);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+    TRACE("%p increasing refcount to %u.\n", context, refcount);
 
-        wined3d_device_set_gs_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
-    }
-    wined3d_mutex_unlock();
+    return refcount;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetRenderTargets(ID3D11DeviceContext1 *iface,
-        UINT render_target_view_count, ID3D11RenderTargetView *const *render_target_views,
-        ID3D11DepthStencilView *depth_stencil_view)
+static ULONG STDMETHODCALLTYPE d3d11_deferred_context_Release(ID3D11DeviceContext1 *iface)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_depthstencil_view *dsv;
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    ULONG refcount = InterlockedDecrement(&context->refcount);
 
-    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
-            iface, render_target_view_count, render_target_views, depth_stencil_view);
+    TRACE("%p decreasing refcount to %u.\n", context, refcount);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < render_target_view_count; ++i)
-    {
-        struct d3d_rendertarget_view *rtv = unsafe_impl_from_ID3D11RenderTargetView(render_target_views[i]);
-        wined3d_device_set_rendertarget_view(device->wined3d_device, i, rtv ? rtv->wined3d_view : NULL, FALSE);
-    }
-    for (; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+    if (!refcount)
     {
-        wined3d_device_set_rendertarget_view(device->wined3d_device, i, NULL, FALSE);
+        ID3D11Device2 *device = &context->device->ID3D11Device2_iface;
+
+        d3d11_context_state_cleanup(&context->state);
+        ID3D11CommandList_Release(&context->list->ID3D11CommandList_iface);
+        wined3d_private_store_cleanup(&context->private_store);
+        heap_free(context);
+
+        ID3D11Device2_Release(device);
     }
 
-    dsv = unsafe_impl_from_ID3D11DepthStencilView(depth_stencil_view);
-    wined3d_device_set_depth_stencil_view(device->wined3d_device, dsv ? dsv->wined3d_view : NULL);
-    wined3d_mutex_unlock();
+    return refcount;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetRenderTargetsAndUnorderedAccessViews(
-        ID3D11DeviceContext1 *iface, UINT render_target_view_count,
-        ID3D11RenderTargetView *const *render_target_views, ID3D11DepthStencilView *depth_stencil_view,
-        UINT unordered_access_view_start_slot, UINT unordered_access_view_count,
-        ID3D11UnorderedAccessView *const *unordered_access_views, const UINT *initial_counts)
+static void STDMETHODCALLTYPE d3d11_deferred_context_GetDevice(ID3D11DeviceContext1 *iface, ID3D11Device **device)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p, "
-            "unordered_access_view_start_slot %u, unordered_access_view_count %u, unordered_access_views %p, "
-            "initial_counts %p.\n",
-            iface, render_target_view_count, render_target_views, depth_stencil_view,
-            unordered_access_view_start_slot, unordered_access_view_count, unordered_access_views,
-            initial_counts);
+    TRACE("iface %p, device %p.\n", iface, device);
 
-    if (render_target_view_count != D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
-    {
-        d3d11_immediate_context_OMSetRenderTargets(iface, render_target_view_count, render_target_views,
-                depth_stencil_view);
-    }
+    *device = (ID3D11Device *)&context->device->ID3D11Device2_iface;
+    ID3D11Device_AddRef(*device);
+}
 
-    if (unordered_access_view_count != D3D11_KEEP_UNORDERED_ACCESS_VIEWS)
-    {
-        wined3d_mutex_lock();
-        for (i = 0; i < unordered_access_view_start_slot; ++i)
-        {
-            wined3d_device_set_unordered_access_view(device->wined3d_device, i, NULL, ~0u);
-        }
-        for (i = 0; i < unordered_access_view_count; ++i)
-        {
-            struct d3d11_unordered_access_view *view
-                    = unsafe_impl_from_ID3D11UnorderedAccessView(unordered_access_views[i]);
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_GetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+        UINT *data_size, void *data)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-            wined3d_device_set_unordered_access_view(device->wined3d_device,
-                    unordered_access_view_start_slot + i,
-                    view ? view->wined3d_view : NULL, initial_counts ? initial_counts[i] : ~0u);
-        }
-        for (; unordered_access_view_start_slot + i < D3D11_PS_CS_UAV_REGISTER_COUNT; ++i)
-        {
-            wined3d_device_set_unordered_access_view(device->wined3d_device,
-                    unordered_access_view_start_slot + i, NULL, ~0u);
-        }
-        wined3d_mutex_unlock();
-    }
+    TRACE("iface %p, guid %s, data_size %p, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+
+    return d3d_get_private_data(&context->private_store, guid, data_size, data);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetBlendState(ID3D11DeviceContext1 *iface,
-        ID3D11BlendState *blend_state, const float blend_factor[4], UINT sample_mask)
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_SetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+        UINT data_size, const void *data)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    static const float default_blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
-    struct d3d_blend_state *blend_state_impl;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, blend_state %p, blend_factor %s, sample_mask 0x%08x.\n",
-            iface, blend_state, debug_float4(blend_factor), sample_mask);
+    TRACE("iface %p, guid %s, data_size %u, data %p.\n", iface, debugstr_guid(guid), data_size, data);
 
-    if (!blend_factor)
-        blend_factor = default_blend_factor;
+    return d3d_set_private_data(&context->private_store, guid, data_size, data);
+}
 
-    wined3d_mutex_lock();
-    if (!(blend_state_impl = unsafe_impl_from_ID3D11BlendState(blend_state)))
-        wined3d_device_set_blend_state(device->wined3d_device, NULL,
-                (const struct wined3d_color *)blend_factor, sample_mask);
-    else
-        wined3d_device_set_blend_state(device->wined3d_device, blend_state_impl->wined3d_state,
-                (const struct wined3d_color *)blend_factor, sample_mask);
-    wined3d_mutex_unlock();
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_SetPrivateDataInterface(ID3D11DeviceContext1 *iface,
+        REFGUID guid, const IUnknown *data)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, guid %s, data %p.\n", iface, debugstr_guid(guid), data);
+
+    return d3d_set_private_data_interface(&context->private_store, guid, data);
 }
 
-static void set_default_depth_stencil_state(struct wined3d_device *wined3d_device)
+static void d3d11_deferred_context_set_shader(ID3D11DeviceContext1 *iface, enum wined3d_shader_type type,
+        void *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
 {
-    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZENABLE, TRUE);
-    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZWRITEENABLE, D3D11_DEPTH_WRITE_MASK_ALL);
-    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_ZFUNC, WINED3D_CMP_LESS);
-    wined3d_device_set_render_state(wined3d_device, WINED3D_RS_STENCILENABLE, FALSE);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, type %#x, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, type, shader, class_instances, class_instance_count);
+
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
+
+    d3d11_set_object(&context->state.stages[type].shader, shader);
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_SET_SHADER, shader, type, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMSetDepthStencilState(ID3D11DeviceContext1 *iface,
-        ID3D11DepthStencilState *depth_stencil_state, UINT stencil_ref)
+static void d3d11_deferred_context_set_shader_resources(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    const D3D11_DEPTH_STENCILOP_DESC *front, *back;
-    const D3D11_DEPTH_STENCIL_DESC *desc;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, depth_stencil_state %p, stencil_ref %u.\n",
-            iface, depth_stencil_state, stencil_ref);
+    TRACE("iface %p, type %#x, start_slot %u, view_count %u, views %p.\n",
+            iface, type, start_slot, view_count, views);
 
-    wined3d_mutex_lock();
-    device->stencil_ref = stencil_ref;
-    if (!(device->depth_stencil_state = unsafe_impl_from_ID3D11DepthStencilState(depth_stencil_state)))
-    {
-        set_default_depth_stencil_state(device->wined3d_device);
-        wined3d_mutex_unlock();
+    if (!d3d11_set_objects(context->state.stages[type].views,
+            ARRAY_SIZE(context->state.stages[type].views), start_slot, view_count, views))
         return;
-    }
+    d3d11_deferred_context_record_slots(context, DEFERRED_OP_SET_SHADER_RESOURCES,
+            type, start_slot, view_count, views, NULL, NULL);
+}
 
-    desc = &device->depth_stencil_state->desc;
+static void d3d11_deferred_context_set_samplers(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    front = &desc->FrontFace;
-    back = &desc->BackFace;
+    TRACE("iface %p, type %#x, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, type, start_slot, sampler_count, samplers);
 
-    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZENABLE, desc->DepthEnable);
-    if (desc->DepthEnable)
-    {
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZWRITEENABLE, desc->DepthWriteMask);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_ZFUNC, desc->DepthFunc);
-    }
+    if (!d3d11_set_objects(context->state.stages[type].samplers,
+            ARRAY_SIZE(context->state.stages[type].samplers), start_slot, sampler_count, samplers))
+        return;
+    d3d11_deferred_context_record_slots(context, DEFERRED_OP_SET_SAMPLERS,
+            type, start_slot, sampler_count, samplers, NULL, NULL);
+}
 
-    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILENABLE, desc->StencilEnable);
-    if (desc->StencilEnable)
-    {
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILMASK, desc->StencilReadMask);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILWRITEMASK, desc->StencilWriteMask);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILREF, stencil_ref);
+static void d3d11_deferred_context_set_constant_buffers(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILFAIL, front->StencilFailOp);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILZFAIL, front->StencilDepthFailOp);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILPASS, front->StencilPassOp);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_STENCILFUNC, front->StencilFunc);
-        if (front->StencilFailOp != back->StencilFailOp
-                || front->StencilDepthFailOp != back->StencilDepthFailOp
-                || front->StencilPassOp != back->StencilPassOp
-                || front->StencilFunc != back->StencilFunc)
-        {
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_TWOSIDEDSTENCILMODE, TRUE);
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILFAIL, back->StencilFailOp);
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILZFAIL,
-                    back->StencilDepthFailOp);
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILPASS, back->StencilPassOp);
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_BACK_STENCILFUNC, back->StencilFunc);
-        }
-        else
-        {
-            wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_TWOSIDEDSTENCILMODE, FALSE);
-        }
-    }
-    wined3d_mutex_unlock();
+    TRACE("iface %p, type %#x, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, type, start_slot, buffer_count, buffers);
+
+    if (!d3d11_set_objects(context->state.stages[type].constant_buffers,
+            ARRAY_SIZE(context->state.stages[type].constant_buffers), start_slot, buffer_count, buffers))
+        return;
+    d3d11_deferred_context_record_slots(context, DEFERRED_OP_SET_CONSTANT_BUFFERS,
+            type, start_slot, buffer_count, buffers, NULL, NULL);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_SOSetTargets(ID3D11DeviceContext1 *iface, UINT buffer_count,
-        ID3D11Buffer *const *buffers, const UINT *offsets)
+static void d3d11_deferred_context_get_shader(ID3D11DeviceContext1 *iface, enum wined3d_shader_type type,
+        void **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int count, i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, buffer_count %u, buffers %p, offsets %p.\n", iface, buffer_count, buffers, offsets);
+    TRACE("iface %p, type %#x, shader %p, class_instances %p, class_instance_count %p.\n",
+            iface, type, shader, class_instances, class_instance_count);
 
-    count = min(buffer_count, D3D11_SO_BUFFER_SLOT_COUNT);
-    wined3d_mutex_lock();
-    for (i = 0; i < count; ++i)
-    {
-        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+    if (class_instances || class_instance_count)
+        FIXME("Dynamic linking not implemented yet.\n");
+    if (class_instance_count)
+        *class_instance_count = 0;
 
-        wined3d_device_set_stream_output(device->wined3d_device, i,
-                buffer ? buffer->wined3d_buffer : NULL, offsets ? offsets[i] : 0);
-    }
-    for (; i < D3D11_SO_BUFFER_SLOT_COUNT; ++i)
-    {
-        wined3d_device_set_stream_output(device->wined3d_device, i, NULL, 0);
-    }
-    wined3d_mutex_unlock();
+    d3d11_get_objects(shader, 0, 1, &context->state.stages[type].shader, 1);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawAuto(ID3D11DeviceContext1 *iface)
+static void d3d11_deferred_context_get_shader_resources(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
 {
-    FIXME("iface %p stub!\n", iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, type %#x, start_slot %u, view_count %u, views %p.\n",
+            iface, type, start_slot, view_count, views);
+
+    d3d11_get_objects(views, start_slot, view_count, context->state.stages[type].views,
+            ARRAY_SIZE(context->state.stages[type].views));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawIndexedInstancedIndirect(ID3D11DeviceContext1 *iface,
-        ID3D11Buffer *buffer, UINT offset)
+static void d3d11_deferred_context_get_samplers(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_buffer *d3d_buffer;
-
-    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    d3d_buffer = unsafe_impl_from_ID3D11Buffer(buffer);
+    TRACE("iface %p, type %#x, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, type, start_slot, sampler_count, samplers);
 
-    wined3d_mutex_lock();
-    wined3d_device_draw_indexed_primitive_instanced_indirect(device->wined3d_device,
-            d3d_buffer->wined3d_buffer, offset);
-    wined3d_mutex_unlock();
+    d3d11_get_objects(samplers, start_slot, sampler_count, context->state.stages[type].samplers,
+            ARRAY_SIZE(context->state.stages[type].samplers));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DrawInstancedIndirect(ID3D11DeviceContext1 *iface,
-        ID3D11Buffer *buffer, UINT offset)
+static void d3d11_deferred_context_get_constant_buffers(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_buffer *d3d_buffer;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
+    TRACE("iface %p, type %#x, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, type, start_slot, buffer_count, buffers);
 
-    d3d_buffer = unsafe_impl_from_ID3D11Buffer(buffer);
+    d3d11_get_objects(buffers, start_slot, buffer_count, context->state.stages[type].constant_buffers,
+            ARRAY_SIZE(context->state.stages[type].constant_buffers));
+}
 
-    wined3d_mutex_lock();
-    wined3d_device_draw_primitive_instanced_indirect(device->wined3d_device,
-            d3d_buffer->wined3d_buffer, offset);
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_Dispatch(ID3D11DeviceContext1 *iface,
-        UINT thread_group_count_x, UINT thread_group_count_y, UINT thread_group_count_z)
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot, view_count, views);
+}
 
-    TRACE("iface %p, thread_group_count_x %u, thread_group_count_y %u, thread_group_count_z %u.\n",
-            iface, thread_group_count_x, thread_group_count_y, thread_group_count_z);
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11PixelShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_PIXEL,
+            shader, class_instances, class_instance_count);
+}
 
-    wined3d_mutex_lock();
-    wined3d_device_dispatch_compute(device->wined3d_device,
-            thread_group_count_x, thread_group_count_y, thread_group_count_z);
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DispatchIndirect(ID3D11DeviceContext1 *iface,
-        ID3D11Buffer *buffer, UINT offset)
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11VertexShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_buffer *buffer_impl;
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_VERTEX,
+            shader, class_instances, class_instance_count);
+}
 
-    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawIndexed(ID3D11DeviceContext1 *iface,
+        UINT index_count, UINT start_index_location, INT base_vertex_location)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    buffer_impl = unsafe_impl_from_ID3D11Buffer(buffer);
+    TRACE("iface %p, index_count %u, start_index_location %u, base_vertex_location %d.\n",
+            iface, index_count, start_index_location, base_vertex_location);
 
-    wined3d_mutex_lock();
-    wined3d_device_dispatch_compute_indirect(device->wined3d_device,
-            buffer_impl->wined3d_buffer, offset);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_record_draw(context, DEFERRED_OP_DRAW_INDEXED,
+            index_count, start_index_location, base_vertex_location, 0, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetState(ID3D11DeviceContext1 *iface,
-        ID3D11RasterizerState *rasterizer_state)
+static void STDMETHODCALLTYPE d3d11_deferred_context_Draw(ID3D11DeviceContext1 *iface,
+        UINT vertex_count, UINT start_vertex_location)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_rasterizer_state *rasterizer_state_impl;
-    const D3D11_RASTERIZER_DESC *desc;
-
-    TRACE("iface %p, rasterizer_state %p.\n", iface, rasterizer_state);
-
-    wined3d_mutex_lock();
-    if (!(rasterizer_state_impl = unsafe_impl_from_ID3D11RasterizerState(rasterizer_state)))
-    {
-        wined3d_device_set_rasterizer_state(device->wined3d_device, NULL);
-        wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_MULTISAMPLEANTIALIAS, FALSE);
-        wined3d_mutex_unlock();
-        return;
-    }
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    wined3d_device_set_rasterizer_state(device->wined3d_device, rasterizer_state_impl->wined3d_state);
+    TRACE("iface %p, vertex_count %u, start_vertex_location %u.\n",
+            iface, vertex_count, start_vertex_location);
 
-    desc = &rasterizer_state_impl->desc;
-    wined3d_device_set_render_state(device->wined3d_device, WINED3D_RS_MULTISAMPLEANTIALIAS, desc->MultisampleEnable);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_record_draw(context, DEFERRED_OP_DRAW, vertex_count, start_vertex_location, 0, 0, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetViewports(ID3D11DeviceContext1 *iface,
-        UINT viewport_count, const D3D11_VIEWPORT *viewports)
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_Map(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
+        UINT subresource_idx, D3D11_MAP map_type, UINT map_flags, D3D11_MAPPED_SUBRESOURCE *mapped_subresource)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_viewport wined3d_vp[WINED3D_MAX_VIEWPORTS];
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int row_size, row_count, slice_count;
+    struct d3d11_command_list *list = context->list;
+    struct d3d11_deferred_map_packet *p;
+    struct d3d11_deferred_map *map;
+    SIZE_T size;
+    HRESULT hr;
 
-    TRACE("iface %p, viewport_count %u, viewports %p.\n", iface, viewport_count, viewports);
+    TRACE("iface %p, resource %p, subresource_idx %u, map_type %u, map_flags %#x, mapped_subresource %p.\n",
+            iface, resource, subresource_idx, map_type, map_flags, mapped_subresource);
 
-    if (viewport_count > ARRAY_SIZE(wined3d_vp))
-        return;
+    if (map_flags)
+        FIXME("Ignoring map_flags %#x.\n", map_flags);
 
-    for (i = 0; i < viewport_count; ++i)
+    if (map_type == D3D11_MAP_WRITE_NO_OVERWRITE)
     {
-        wined3d_vp[i].x = viewports[i].TopLeftX;
-        wined3d_vp[i].y = viewports[i].TopLeftY;
-        wined3d_vp[i].width = viewports[i].Width;
-        wined3d_vp[i].height = viewports[i].Height;
-        wined3d_vp[i].min_z = viewports[i].MinDepth;
-        wined3d_vp[i].max_z = viewports[i].MaxDepth;
+        /* The resource contents aren't known until the command list is
+         * executed, so this only works on memory returned by an earlier
+         * WRITE_DISCARD map in the same command list. */
+        LIST_FOR_EACH_ENTRY_REV(map, &list->maps, struct d3d11_deferred_map, entry)
+        {
+            if (map->resource == (IUnknown *)resource && map->subresource_idx == subresource_idx)
+            {
+                mapped_subresource->pData = map->data;
+                mapped_subresource->RowPitch = map->row_pitch;
+                mapped_subresource->DepthPitch = map->slice_pitch;
+                return S_OK;
+            }
+        }
+
+        WARN("Resource %p, subresource %u was not mapped for discard.\n", resource, subresource_idx);
+        return E_INVALIDARG;
     }
 
-    wined3d_mutex_lock();
-    wined3d_device_set_viewports(device->wined3d_device, viewport_count, wined3d_vp);
-    wined3d_mutex_unlock();
-}
+    if (map_type != D3D11_MAP_WRITE_DISCARD)
+    {
+        WARN("Invalid map type %#x for a deferred context.\n", map_type);
+        return E_INVALIDARG;
+    }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSSetScissorRects(ID3D11DeviceContext1 *iface,
-        UINT rect_count, const D3D11_RECT *rects)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    if (FAILED(hr = d3d11_deferred_context_get_layout(context, resource, subresource_idx, NULL,
+            &row_size, &row_count, &slice_count)))
+        return hr;
 
-    TRACE("iface %p, rect_count %u, rects %p.\n", iface, rect_count, rects);
+    size = (SIZE_T)row_size * row_count * slice_count;
+    if (!(map = heap_alloc(sizeof(*map) + size + 15)))
+        return E_OUTOFMEMORY;
+    if (!(p = d3d11_command_list_require_space(list, DEFERRED_OP_MAP, sizeof(*p))))
+    {
+        heap_free(map);
+        return E_OUTOFMEMORY;
+    }
 
-    if (rect_count > WINED3D_MAX_VIEWPORTS)
-        return;
+    map->resource = d3d11_command_list_add_ref(list, resource);
+    map->subresource_idx = subresource_idx;
+    map->row_size = row_size;
+    map->row_count = row_count;
+    map->slice_count = slice_count;
+    map->row_pitch = row_size;
+    map->slice_pitch = row_size * row_count;
+    map->data = (BYTE *)(((ULONG_PTR)(map + 1) + 15) & ~(ULONG_PTR)15);
+    list_add_tail(&list->maps, &map->entry);
+    p->map = map;
 
-    wined3d_mutex_lock();
-    wined3d_device_set_scissor_rects(device->wined3d_device, rect_count, rects);
-    wined3d_mutex_unlock();
+    mapped_subresource->pData = map->data;
+    mapped_subresource->RowPitch = map->row_pitch;
+    mapped_subresource->DepthPitch = map->slice_pitch;
+
+    return S_OK;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CopySubresourceRegion(ID3D11DeviceContext1 *iface,
-        ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
-        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box)
+static void STDMETHODCALLTYPE d3d11_deferred_context_Unmap(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
+        UINT subresource_idx)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
-    struct wined3d_box wined3d_src_box;
+    TRACE("iface %p, resource %p, subresource_idx %u.\n", iface, resource, subresource_idx);
+}
 
-    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
-            "src_resource %p, src_subresource_idx %u, src_box %p.\n",
-            iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
-            src_resource, src_subresource_idx, src_box);
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot, buffer_count, buffers);
+}
 
-    if (!dst_resource || !src_resource)
-        return;
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetInputLayout(ID3D11DeviceContext1 *iface,
+        ID3D11InputLayout *input_layout)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    if (src_box)
-        wined3d_box_set(&wined3d_src_box, src_box->left, src_box->top,
-                src_box->right, src_box->bottom, src_box->front, src_box->back);
+    TRACE("iface %p, input_layout %p.\n", iface, input_layout);
 
-    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
-    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
-    wined3d_mutex_lock();
-    wined3d_device_copy_sub_resource_region(device->wined3d_device, wined3d_dst_resource, dst_subresource_idx,
-            dst_x, dst_y, dst_z, wined3d_src_resource, src_subresource_idx, src_box ? &wined3d_src_box : NULL, 0);
-    wined3d_mutex_unlock();
+    d3d11_set_object(&context->state.input_layout, input_layout);
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_IA_SET_INPUT_LAYOUT, input_layout, 0, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CopyResource(ID3D11DeviceContext1 *iface,
-        ID3D11Resource *dst_resource, ID3D11Resource *src_resource)
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetVertexBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers, const UINT *strides, const UINT *offsets)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_context_state *state = &context->state;
 
-    TRACE("iface %p, dst_resource %p, src_resource %p.\n", iface, dst_resource, src_resource);
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p.\n",
+            iface, start_slot, buffer_count, buffers, strides, offsets);
 
-    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
-    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
-    wined3d_mutex_lock();
-    wined3d_device_copy_resource(device->wined3d_device, wined3d_dst_resource, wined3d_src_resource);
-    wined3d_mutex_unlock();
+    if (!d3d11_set_objects(state->vertex_buffers, ARRAY_SIZE(state->vertex_buffers),
+            start_slot, buffer_count, buffers))
+        return;
+    memcpy(&state->strides[start_slot], strides, buffer_count * sizeof(*strides));
+    memcpy(&state->offsets[start_slot], offsets, buffer_count * sizeof(*offsets));
+    d3d11_deferred_context_record_slots(context, DEFERRED_OP_IA_SET_VERTEX_BUFFERS,
+            0, start_slot, buffer_count, buffers, strides, offsets);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_UpdateSubresource(ID3D11DeviceContext1 *iface,
-        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box,
-        const void *data, UINT row_pitch, UINT depth_pitch)
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetIndexBuffer(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, DXGI_FORMAT format, UINT offset)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_resource;
-    struct wined3d_box wined3d_box;
-
-    TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u.\n",
-            iface, resource, subresource_idx, box, data, row_pitch, depth_pitch);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    if (box)
-        wined3d_box_set(&wined3d_box, box->left, box->top, box->right, box->bottom, box->front, box->back);
+    TRACE("iface %p, buffer %p, format %s, offset %u.\n",
+            iface, buffer, debug_dxgi_format(format), offset);
 
-    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
-    wined3d_mutex_lock();
-    wined3d_device_update_sub_resource(device->wined3d_device, wined3d_resource,
-            subresource_idx, box ? &wined3d_box : NULL, data, row_pitch, depth_pitch, 0);
-    wined3d_mutex_unlock();
+    d3d11_set_object(&context->state.index_buffer, buffer);
+    context->state.index_format = format;
+    context->state.index_offset = offset;
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_IA_SET_INDEX_BUFFER, buffer, format, offset);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CopyStructureCount(ID3D11DeviceContext1 *iface,
-        ID3D11Buffer *dst_buffer, UINT dst_offset, ID3D11UnorderedAccessView *src_view)
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawIndexedInstanced(ID3D11DeviceContext1 *iface,
+        UINT instance_index_count, UINT instance_count, UINT start_index_location, INT base_vertex_location,
+        UINT start_instance_location)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_unordered_access_view *uav;
-    struct d3d_buffer *buffer_impl;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, dst_buffer %p, dst_offset %u, src_view %p.\n",
-            iface, dst_buffer, dst_offset, src_view);
-
-    buffer_impl = unsafe_impl_from_ID3D11Buffer(dst_buffer);
-    uav = unsafe_impl_from_ID3D11UnorderedAccessView(src_view);
+    TRACE("iface %p, instance_index_count %u, instance_count %u, start_index_location %u, "
+            "base_vertex_location %d, start_instance_location %u.\n",
+            iface, instance_index_count, instance_count, start_index_location,
+            base_vertex_location, start_instance_location);
 
-    wined3d_mutex_lock();
-    wined3d_device_copy_uav_counter(device->wined3d_device,
-            buffer_impl->wined3d_buffer, dst_offset, uav->wined3d_view);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_record_draw(context, DEFERRED_OP_DRAW_INDEXED_INSTANCED, instance_index_count,
+            instance_count, start_index_location, base_vertex_location, start_instance_location);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearRenderTargetView(ID3D11DeviceContext1 *iface,
-        ID3D11RenderTargetView *render_target_view, const float color_rgba[4])
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawInstanced(ID3D11DeviceContext1 *iface,
+        UINT instance_vertex_count, UINT instance_count, UINT start_vertex_location, UINT start_instance_location)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_rendertarget_view *view = unsafe_impl_from_ID3D11RenderTargetView(render_target_view);
-    const struct wined3d_color color = {color_rgba[0], color_rgba[1], color_rgba[2], color_rgba[3]};
-    HRESULT hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, render_target_view %p, color_rgba %s.\n",
-            iface, render_target_view, debug_float4(color_rgba));
-
-    if (!view)
-        return;
+    TRACE("iface %p, instance_vertex_count %u, instance_count %u, start_vertex_location %u, "
+            "start_instance_location %u.\n",
+            iface, instance_vertex_count, instance_count, start_vertex_location,
+            start_instance_location);
 
-    wined3d_mutex_lock();
-    if (FAILED(hr = wined3d_device_clear_rendertarget_view(device->wined3d_device, view->wined3d_view, NULL,
-            WINED3DCLEAR_TARGET, &color, 0.0f, 0)))
-        ERR("Failed to clear view, hr %#x.\n", hr);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_record_draw(context, DEFERRED_OP_DRAW_INSTANCED, instance_vertex_count,
+            instance_count, start_vertex_location, start_instance_location, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearUnorderedAccessViewUint(ID3D11DeviceContext1 *iface,
-        ID3D11UnorderedAccessView *unordered_access_view, const UINT values[4])
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_unordered_access_view *view;
-
-    TRACE("iface %p, unordered_access_view %p, values {%u, %u, %u, %u}.\n",
-            iface, unordered_access_view, values[0], values[1], values[2], values[3]);
-
-    view = unsafe_impl_from_ID3D11UnorderedAccessView(unordered_access_view);
-    wined3d_mutex_lock();
-    wined3d_device_clear_unordered_access_view_uint(device->wined3d_device,
-            view->wined3d_view, (const struct wined3d_uvec4 *)values);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_GEOMETRY,
+            start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearUnorderedAccessViewFloat(ID3D11DeviceContext1 *iface,
-        ID3D11UnorderedAccessView *unordered_access_view, const float values[4])
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11GeometryShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
 {
-    FIXME("iface %p, unordered_access_view %p, values %s stub!\n",
-            iface, unordered_access_view, debug_float4(values));
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_GEOMETRY,
+            shader, class_instances, class_instance_count);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearDepthStencilView(ID3D11DeviceContext1 *iface,
-        ID3D11DepthStencilView *depth_stencil_view, UINT flags, FLOAT depth, UINT8 stencil)
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetPrimitiveTopology(ID3D11DeviceContext1 *iface,
+        D3D11_PRIMITIVE_TOPOLOGY topology)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_depthstencil_view *view = unsafe_impl_from_ID3D11DepthStencilView(depth_stencil_view);
-    DWORD wined3d_flags;
-    HRESULT hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, depth_stencil_view %p, flags %#x, depth %.8e, stencil %u.\n",
-            iface, depth_stencil_view, flags, depth, stencil);
+    TRACE("iface %p, topology %#x.\n", iface, topology);
 
-    if (!view)
-        return;
+    context->state.topology = topology;
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_IA_SET_PRIMITIVE_TOPOLOGY, NULL, topology, 0);
+}
 
-    wined3d_flags = wined3d_clear_flags_from_d3d11_clear_flags(flags);
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot, view_count, views);
+}
 
-    wined3d_mutex_lock();
-    if (FAILED(hr = wined3d_device_clear_rendertarget_view(device->wined3d_device, view->wined3d_view, NULL,
-            wined3d_flags, NULL, depth, stencil)))
-        ERR("Failed to clear view, hr %#x.\n", hr);
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GenerateMips(ID3D11DeviceContext1 *iface,
-        ID3D11ShaderResourceView *view)
+static void STDMETHODCALLTYPE d3d11_deferred_context_Begin(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous)
 {
-    struct d3d_shader_resource_view *srv = unsafe_impl_from_ID3D11ShaderResourceView(view);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, view %p.\n", iface, view);
+    TRACE("iface %p, asynchronous %p.\n", iface, asynchronous);
 
-    wined3d_mutex_lock();
-    wined3d_shader_resource_view_generate_mipmaps(srv->wined3d_view);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_BEGIN, asynchronous, 0, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_SetResourceMinLOD(ID3D11DeviceContext1 *iface,
-        ID3D11Resource *resource, FLOAT min_lod)
+static void STDMETHODCALLTYPE d3d11_deferred_context_End(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous)
 {
-    FIXME("iface %p, resource %p, min_lod %f stub!\n", iface, resource, min_lod);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, asynchronous %p.\n", iface, asynchronous);
+
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_END, asynchronous, 0, 0);
 }
 
-static FLOAT STDMETHODCALLTYPE d3d11_immediate_context_GetResourceMinLOD(ID3D11DeviceContext1 *iface,
-        ID3D11Resource *resource)
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_GetData(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous, void *data, UINT data_size, UINT data_flags)
 {
-    FIXME("iface %p, resource %p stub!\n", iface, resource);
+    TRACE("iface %p, asynchronous %p, data %p, data_size %u, data_flags %#x.\n",
+            iface, asynchronous, data, data_size, data_flags);
 
-    return 0.0f;
+    return DXGI_ERROR_INVALID_CALL;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ResolveSubresource(ID3D11DeviceContext1 *iface,
-        ID3D11Resource *dst_resource, UINT dst_subresource_idx,
-        ID3D11Resource *src_resource, UINT src_subresource_idx,
-        DXGI_FORMAT format)
+static void STDMETHODCALLTYPE d3d11_deferred_context_SetPredication(ID3D11DeviceContext1 *iface,
+        ID3D11Predicate *predicate, BOOL value)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
-    enum wined3d_format_id wined3d_format;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, "
-            "src_resource %p, src_subresource_idx %u, format %s.\n",
-            iface, dst_resource, dst_subresource_idx,
-            src_resource, src_subresource_idx, debug_dxgi_format(format));
+    TRACE("iface %p, predicate %p, value %#x.\n", iface, predicate, value);
 
-    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
-    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
-    wined3d_format = wined3dformat_from_dxgi_format(format);
-    wined3d_mutex_lock();
-    wined3d_device_resolve_sub_resource(device->wined3d_device,
-            wined3d_dst_resource, dst_subresource_idx,
-            wined3d_src_resource, src_subresource_idx, wined3d_format);
-    wined3d_mutex_unlock();
+    d3d11_set_object(&context->state.predicate, predicate);
+    context->state.predicate_value = value;
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_SET_PREDICATION, predicate, value, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ExecuteCommandList(ID3D11DeviceContext1 *iface,
-        ID3D11CommandList *command_list, BOOL restore_state)
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
 {
-    FIXME("iface %p, command_list %p, restore_state %#x stub!\n", iface, command_list, restore_state);
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_GEOMETRY,
+            start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetShaderResources(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_GEOMETRY,
+            start_slot, sampler_count, samplers);
+}
 
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
-            iface, start_slot, view_count, views);
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetRenderTargetsAndUnorderedAccessViews(
+        ID3D11DeviceContext1 *iface, UINT render_target_view_count,
+        ID3D11RenderTargetView *const *render_target_views, ID3D11DepthStencilView *depth_stencil_view,
+        UINT unordered_access_view_start_slot, UINT unordered_access_view_count,
+        ID3D11UnorderedAccessView *const *unordered_access_views, const UINT *initial_counts)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_context_state *state = &context->state;
+    unsigned int rtv_count = 0, uav_count = 0, i;
+    struct d3d11_deferred_render_targets_packet *p;
+    struct d3d11_command_list *list = context->list;
+    UINT *counts;
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p, "
+            "unordered_access_view_start_slot %u, unordered_access_view_count %u, unordered_access_views %p, "
+            "initial_counts %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view,
+            unordered_access_view_start_slot, unordered_access_view_count, unordered_access_views,
+            initial_counts);
+
+    if (render_target_view_count != D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
     {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+        if (render_target_view_count > ARRAY_SIZE(state->rtvs))
+        {
+            WARN("Invalid render target view count %u.\n", render_target_view_count);
+            return;
+        }
+        rtv_count = render_target_view_count;
+    }
+    if (unordered_access_view_count != D3D11_KEEP_UNORDERED_ACCESS_VIEWS)
+    {
+        if (unordered_access_view_start_slot > ARRAY_SIZE(state->uavs)
+                || unordered_access_view_count > ARRAY_SIZE(state->uavs) - unordered_access_view_start_slot)
+        {
+            WARN("Invalid unordered access view range %u, count %u.\n",
+                    unordered_access_view_start_slot, unordered_access_view_count);
+            return;
+        }
+        uav_count = unordered_access_view_count;
+    }
 
-        wined3d_device_set_hs_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
+    if (render_target_view_count != D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
+    {
+        for (i = 0; i < ARRAY_SIZE(state->rtvs); ++i)
+            d3d11_set_object(&state->rtvs[i], i < rtv_count ? render_target_views[i] : NULL);
+        d3d11_set_object(&state->dsv, depth_stencil_view);
     }
-    wined3d_mutex_unlock();
+    if (unordered_access_view_count != D3D11_KEEP_UNORDERED_ACCESS_VIEWS)
+    {
+        for (i = 0; i < ARRAY_SIZE(state->uavs); ++i)
+        {
+            d3d11_set_object(&state->uavs[i], i >= unordered_access_view_start_slot && i - unordered_access_view_start_slot
+                    < uav_count ? unordered_access_views[i - unordered_access_view_start_slot] : NULL);
+        }
+    }
+
+    if (!(p = d3d11_command_list_require_space(list, DEFERRED_OP_OM_SET_RENDER_TARGETS,
+            FIELD_OFFSET(struct d3d11_deferred_render_targets_packet, objects[rtv_count + uav_count])
+            + (initial_counts ? uav_count * sizeof(*initial_counts) : 0))))
+        return;
+    p->rtv_count = render_target_view_count;
+    p->dsv = d3d11_command_list_add_ref(list, depth_stencil_view);
+    p->uav_start_slot = unordered_access_view_start_slot;
+    p->uav_count = unordered_access_view_count;
+    p->initial_counts = !!initial_counts;
+    for (i = 0; i < rtv_count; ++i)
+        p->objects[i] = d3d11_command_list_add_ref(list, render_target_views[i]);
+    for (i = 0; i < uav_count; ++i)
+        p->objects[rtv_count + i] = d3d11_command_list_add_ref(list, unordered_access_views[i]);
+    counts = (UINT *)&p->objects[rtv_count + uav_count];
+    if (initial_counts)
+        memcpy(counts, initial_counts, uav_count * sizeof(*counts));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetRenderTargets(ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView *const *render_target_views,
+        ID3D11DepthStencilView *depth_stencil_view)
+{
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view);
+
+    d3d11_deferred_context_OMSetRenderTargetsAndUnorderedAccessViews(iface, render_target_view_count,
+            render_target_views, depth_stencil_view, 0, D3D11_KEEP_UNORDERED_ACCESS_VIEWS, NULL, NULL);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetShader(ID3D11DeviceContext1 *iface,
-        ID3D11HullShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetBlendState(ID3D11DeviceContext1 *iface,
+        ID3D11BlendState *blend_state, const float blend_factor[4], UINT sample_mask)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_hull_shader *hs = unsafe_impl_from_ID3D11HullShader(shader);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    static const float default_blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    struct d3d11_command_list *list = context->list;
+    struct d3d11_deferred_blend_state_packet *p;
 
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
-            iface, shader, class_instances, class_instance_count);
+    TRACE("iface %p, blend_state %p, blend_factor %s, sample_mask 0x%08x.\n",
+            iface, blend_state, debug_float4(blend_factor), sample_mask);
 
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
+    if (!blend_factor)
+        blend_factor = default_blend_factor;
 
-    wined3d_mutex_lock();
-    wined3d_device_set_hull_shader(device->wined3d_device, hs ? hs->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+    d3d11_set_object(&context->state.blend_state, blend_state);
+    memcpy(context->state.blend_factor, blend_factor, sizeof(context->state.blend_factor));
+    context->state.sample_mask = sample_mask;
+
+    if (!(p = d3d11_command_list_require_space(list, DEFERRED_OP_OM_SET_BLEND_STATE, sizeof(*p))))
+        return;
+    p->state = d3d11_command_list_add_ref(list, blend_state);
+    memcpy(p->blend_factor, blend_factor, sizeof(p->blend_factor));
+    p->sample_mask = sample_mask;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetDepthStencilState(ID3D11DeviceContext1 *iface,
+        ID3D11DepthStencilState *depth_stencil_state, UINT stencil_ref)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, depth_stencil_state %p, stencil_ref %u.\n",
+            iface, depth_stencil_state, stencil_ref);
+
+    d3d11_set_object(&context->state.depth_stencil_state, depth_stencil_state);
+    context->state.stencil_ref = stencil_ref;
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_OM_SET_DEPTH_STENCIL_STATE,
+            depth_stencil_state, stencil_ref, 0);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_SOSetTargets(ID3D11DeviceContext1 *iface, UINT buffer_count,
+        ID3D11Buffer *const *buffers, const UINT *offsets)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_context_state *state = &context->state;
     unsigned int i;
 
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
+    TRACE("iface %p, buffer_count %u, buffers %p, offsets %p.\n", iface, buffer_count, buffers, offsets);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
+    if (buffer_count > ARRAY_SIZE(state->so_buffers))
     {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
-
-        wined3d_device_set_hs_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
+        WARN("Invalid buffer count %u.\n", buffer_count);
+        return;
     }
-    wined3d_mutex_unlock();
+
+    for (i = 0; i < ARRAY_SIZE(state->so_buffers); ++i)
+        d3d11_set_object(&state->so_buffers[i], i < buffer_count ? buffers[i] : NULL);
+    d3d11_deferred_context_record_slots(context, DEFERRED_OP_SO_SET_TARGETS,
+            0, 0, buffer_count, buffers, offsets, NULL);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetConstantBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawAuto(ID3D11DeviceContext1 *iface)
 {
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_HULL, start_slot,
-            buffer_count, buffers);
+    TRACE("iface %p.\n", iface);
+
+    d3d11_command_list_require_space(context->list, DEFERRED_OP_DRAW_AUTO, sizeof(struct d3d11_deferred_packet));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetShaderResources(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawIndexedInstancedIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
-            iface, start_slot, view_count, views);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
+    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
 
-        wined3d_device_set_ds_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_DRAW_INDEXED_INSTANCED_INDIRECT, buffer, 0, offset);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetShader(ID3D11DeviceContext1 *iface,
-        ID3D11DomainShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawInstancedIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_domain_shader *ds = unsafe_impl_from_ID3D11DomainShader(shader);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
-            iface, shader, class_instances, class_instance_count);
-
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
+    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
 
-    wined3d_mutex_lock();
-    wined3d_device_set_domain_shader(device->wined3d_device, ds ? ds->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_DRAW_INSTANCED_INDIRECT, buffer, 0, offset);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_Dispatch(ID3D11DeviceContext1 *iface,
+        UINT thread_group_count_x, UINT thread_group_count_y, UINT thread_group_count_z)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
+    TRACE("iface %p, thread_group_count_x %u, thread_group_count_y %u, thread_group_count_z %u.\n",
+            iface, thread_group_count_x, thread_group_count_y, thread_group_count_z);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+    d3d11_deferred_context_record_draw(context, DEFERRED_OP_DISPATCH,
+            thread_group_count_x, thread_group_count_y, thread_group_count_z, 0, 0);
+}
 
-        wined3d_device_set_ds_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
-    }
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_deferred_context_DispatchIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, buffer %p, offset %u.\n", iface, buffer, offset);
+
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_DISPATCH_INDIRECT, buffer, 0, offset);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetConstantBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetState(ID3D11DeviceContext1 *iface,
+        ID3D11RasterizerState *rasterizer_state)
 {
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot,
-            buffer_count, buffers);
+    TRACE("iface %p, rasterizer_state %p.\n", iface, rasterizer_state);
+
+    d3d11_set_object(&context->state.rasterizer_state, rasterizer_state);
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_RS_SET_STATE, rasterizer_state, 0, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetShaderResources(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetViewports(ID3D11DeviceContext1 *iface,
+        UINT viewport_count, const D3D11_VIEWPORT *viewports)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_rects_packet *p;
 
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
-            iface, start_slot, view_count, views);
+    TRACE("iface %p, viewport_count %u, viewports %p.\n", iface, viewport_count, viewports);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
+    if (viewport_count > ARRAY_SIZE(context->state.viewports))
     {
-        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
-
-        wined3d_device_set_cs_resource_view(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL);
+        WARN("Invalid viewport count %u.\n", viewport_count);
+        return;
     }
-    wined3d_mutex_unlock();
+
+    memcpy(context->state.viewports, viewports, viewport_count * sizeof(*viewports));
+    context->state.viewport_count = viewport_count;
+
+    if (!(p = d3d11_command_list_require_space(context->list, DEFERRED_OP_RS_SET_VIEWPORTS,
+            FIELD_OFFSET(struct d3d11_deferred_rects_packet, u.viewports[viewport_count]))))
+        return;
+    p->count = viewport_count;
+    memcpy(p->u.viewports, viewports, viewport_count * sizeof(*viewports));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT view_count, ID3D11UnorderedAccessView *const *views, const UINT *initial_counts)
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetScissorRects(ID3D11DeviceContext1 *iface,
+        UINT rect_count, const D3D11_RECT *rects)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_rects_packet *p;
 
-    TRACE("iface %p, start_slot %u, view_count %u, views %p, initial_counts %p.\n",
-            iface, start_slot, view_count, views, initial_counts);
+    TRACE("iface %p, rect_count %u, rects %p.\n", iface, rect_count, rects);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
+    if (rect_count > ARRAY_SIZE(context->state.scissor_rects))
     {
-        struct d3d11_unordered_access_view *view = unsafe_impl_from_ID3D11UnorderedAccessView(views[i]);
-
-        wined3d_device_set_cs_uav(device->wined3d_device, start_slot + i,
-                view ? view->wined3d_view : NULL, initial_counts ? initial_counts[i] : ~0u);
+        WARN("Invalid scissor rect count %u.\n", rect_count);
+        return;
     }
-    wined3d_mutex_unlock();
+
+    memcpy(context->state.scissor_rects, rects, rect_count * sizeof(*rects));
+    context->state.scissor_rect_count = rect_count;
+
+    if (!(p = d3d11_command_list_require_space(context->list, DEFERRED_OP_RS_SET_SCISSOR_RECTS,
+            FIELD_OFFSET(struct d3d11_deferred_rects_packet, u.rects[rect_count]))))
+        return;
+    p->count = rect_count;
+    memcpy(p->u.rects, rects, rect_count * sizeof(*rects));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetShader(ID3D11DeviceContext1 *iface,
-        ID3D11ComputeShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopySubresourceRegion(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
+        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_compute_shader *cs = unsafe_impl_from_ID3D11ComputeShader(shader);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
-            iface, shader, class_instances, class_instance_count);
+    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
+            "src_resource %p, src_subresource_idx %u, src_box %p.\n",
+            iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
+            src_resource, src_subresource_idx, src_box);
 
-    if (class_instances)
-        FIXME("Dynamic linking is not implemented yet.\n");
+    d3d11_deferred_context_record_copy(context, DEFERRED_OP_COPY_SUBRESOURCE_REGION, dst_resource,
+            dst_subresource_idx, dst_x, dst_y, dst_z, src_resource, src_subresource_idx, src_box, 0);
+}
 
-    wined3d_mutex_lock();
-    wined3d_device_set_compute_shader(device->wined3d_device, cs ? cs->wined3d_shader : NULL);
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopyResource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, ID3D11Resource *src_resource)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, dst_resource %p, src_resource %p.\n", iface, dst_resource, src_resource);
+
+    d3d11_deferred_context_record_copy(context, DEFERRED_OP_COPY_RESOURCE,
+            dst_resource, 0, 0, 0, 0, src_resource, 0, NULL, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_UpdateSubresource1(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box, const void *data,
+        UINT row_pitch, UINT depth_pitch, UINT flags)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int row_size, row_count, slice_count;
+    struct d3d11_command_list *list = context->list;
+    struct d3d11_deferred_update_packet *p;
+    SIZE_T size;
 
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
+    TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u, flags %#x.\n",
+            iface, resource, subresource_idx, box, data, row_pitch, depth_pitch, flags);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
+    if (box && (box->right <= box->left || box->bottom <= box->top || box->back <= box->front))
+        return;
 
-        wined3d_device_set_cs_sampler(device->wined3d_device, start_slot + i,
-                sampler ? sampler->wined3d_sampler : NULL);
+    if (FAILED(d3d11_deferred_context_get_layout(context, resource, subresource_idx, box,
+            &row_size, &row_count, &slice_count)))
+    {
+        WARN("Invalid sub-resource %u of resource %p.\n", subresource_idx, resource);
+        return;
     }
-    wined3d_mutex_unlock();
+
+    /* The source data is only guaranteed to stay valid until this call
+     * returns, so it has to be copied into the command list. */
+    size = (SIZE_T)(slice_count - 1) * depth_pitch + (SIZE_T)(row_count - 1) * row_pitch + row_size;
+    if (!(p = d3d11_command_list_require_space(list, DEFERRED_OP_UPDATE_SUBRESOURCE,
+            FIELD_OFFSET(struct d3d11_deferred_update_packet, data[size]))))
+        return;
+    p->resource = d3d11_command_list_add_ref(list, resource);
+    p->subresource_idx = subresource_idx;
+    if ((p->has_box = !!box))
+        p->box = *box;
+    p->row_pitch = row_pitch;
+    p->depth_pitch = depth_pitch;
+    p->flags = flags;
+    memcpy(p->data, data, size);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetConstantBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_UpdateSubresource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box,
+        const void *data, UINT row_pitch, UINT depth_pitch)
 {
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
-
-    d3d11_immediate_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_UpdateSubresource1(iface, resource, subresource_idx, box, data, row_pitch, depth_pitch, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetConstantBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopyStructureCount(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *dst_buffer, UINT dst_offset, ID3D11UnorderedAccessView *src_view)
 {
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot,
-            buffer_count, buffers);
+    TRACE("iface %p, dst_buffer %p, dst_offset %u, src_view %p.\n",
+            iface, dst_buffer, dst_offset, src_view);
+
+    d3d11_deferred_context_record_copy(context, DEFERRED_OP_COPY_STRUCTURE_COUNT,
+            dst_buffer, 0, dst_offset, 0, 0, src_view, 0, NULL, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetShaderResources(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearRenderTargetView(ID3D11DeviceContext1 *iface,
+        ID3D11RenderTargetView *render_target_view, const float color_rgba[4])
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
-            iface, start_slot, view_count, views);
+    TRACE("iface %p, render_target_view %p, color_rgba %s.\n",
+            iface, render_target_view, debug_float4(color_rgba));
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
+    d3d11_deferred_context_record_clear(context, DEFERRED_OP_CLEAR_RENDER_TARGET_VIEW,
+            render_target_view, color_rgba, 0, 0.0f, 0);
+}
 
-        if (!(wined3d_view = wined3d_device_get_ps_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearUnorderedAccessViewUint(ID3D11DeviceContext1 *iface,
+        ID3D11UnorderedAccessView *unordered_access_view, const UINT values[4])
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
-        ID3D11ShaderResourceView_AddRef(views[i]);
-    }
-    wined3d_mutex_unlock();
+    TRACE("iface %p, unordered_access_view %p, values {%u, %u, %u, %u}.\n",
+            iface, unordered_access_view, values[0], values[1], values[2], values[3]);
+
+    d3d11_deferred_context_record_clear(context, DEFERRED_OP_CLEAR_UNORDERED_ACCESS_VIEW_UINT,
+            unordered_access_view, values, 0, 0.0f, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetShader(ID3D11DeviceContext1 *iface,
-        ID3D11PixelShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearUnorderedAccessViewFloat(ID3D11DeviceContext1 *iface,
+        ID3D11UnorderedAccessView *unordered_access_view, const float values[4])
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_shader *wined3d_shader;
-    struct d3d_pixel_shader *shader_impl;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
-            iface, shader, class_instances, class_instance_count);
+    TRACE("iface %p, unordered_access_view %p, values %s.\n",
+            iface, unordered_access_view, debug_float4(values));
 
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
+    d3d11_deferred_context_record_clear(context, DEFERRED_OP_CLEAR_UNORDERED_ACCESS_VIEW_FLOAT,
+            unordered_access_view, values, 0, 0.0f, 0);
+}
 
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_pixel_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearDepthStencilView(ID3D11DeviceContext1 *iface,
+        ID3D11DepthStencilView *depth_stencil_view, UINT flags, FLOAT depth, UINT8 stencil)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    *shader = &shader_impl->ID3D11PixelShader_iface;
-    ID3D11PixelShader_AddRef(*shader);
+    TRACE("iface %p, depth_stencil_view %p, flags %#x, depth %.8e, stencil %u.\n",
+            iface, depth_stencil_view, flags, depth, stencil);
+
+    d3d11_deferred_context_record_clear(context, DEFERRED_OP_CLEAR_DEPTH_STENCIL_VIEW,
+            depth_stencil_view, NULL, flags, depth, stencil);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_GenerateMips(ID3D11DeviceContext1 *iface,
+        ID3D11ShaderResourceView *view)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct wined3d_sampler *wined3d_sampler;
-        struct d3d_sampler_state *sampler_impl;
+    TRACE("iface %p, view %p.\n", iface, view);
 
-        if (!(wined3d_sampler = wined3d_device_get_ps_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_GENERATE_MIPS, view, 0, 0);
+}
 
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
-        ID3D11SamplerState_AddRef(samplers[i]);
-    }
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_deferred_context_SetResourceMinLOD(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, FLOAT min_lod)
+{
+    FIXME("iface %p, resource %p, min_lod %f stub!\n", iface, resource, min_lod);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetShader(ID3D11DeviceContext1 *iface,
-        ID3D11VertexShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+static FLOAT STDMETHODCALLTYPE d3d11_deferred_context_GetResourceMinLOD(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_vertex_shader *shader_impl;
-    struct wined3d_shader *wined3d_shader;
+    FIXME("iface %p, resource %p stub!\n", iface, resource);
 
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
-            iface, shader, class_instances, class_instance_count);
+    return 0.0f;
+}
 
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
+static void STDMETHODCALLTYPE d3d11_deferred_context_ResolveSubresource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx,
+        ID3D11Resource *src_resource, UINT src_subresource_idx,
+        DXGI_FORMAT format)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_vertex_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
+    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, "
+            "src_resource %p, src_subresource_idx %u, format %s.\n",
+            iface, dst_resource, dst_subresource_idx,
+            src_resource, src_subresource_idx, debug_dxgi_format(format));
 
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    *shader = &shader_impl->ID3D11VertexShader_iface;
-    ID3D11VertexShader_AddRef(*shader);
+    /* The format is stored in the "flags" field of the copy packet. */
+    d3d11_deferred_context_record_copy(context, DEFERRED_OP_RESOLVE_SUBRESOURCE, dst_resource,
+            dst_subresource_idx, 0, 0, 0, src_resource, src_subresource_idx, NULL, format);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetConstantBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_ExecuteCommandList(ID3D11DeviceContext1 *iface,
+        ID3D11CommandList *command_list, BOOL restore_state)
 {
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot,
-            buffer_count, buffers);
+    TRACE("iface %p, command_list %p, restore_state %#x.\n", iface, command_list, restore_state);
+
+    if (!restore_state)
+        d3d11_context_state_cleanup(&context->state);
+    d3d11_deferred_context_record_object(context, DEFERRED_OP_EXECUTE_COMMAND_LIST,
+            command_list, restore_state, 0);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetInputLayout(ID3D11DeviceContext1 *iface,
-        ID3D11InputLayout **input_layout)
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_vertex_declaration *wined3d_declaration;
-    struct d3d_input_layout *input_layout_impl;
-
-    TRACE("iface %p, input_layout %p.\n", iface, input_layout);
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_HULL, start_slot, view_count, views);
+}
 
-    wined3d_mutex_lock();
-    if (!(wined3d_declaration = wined3d_device_get_vertex_declaration(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *input_layout = NULL;
-        return;
-    }
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11HullShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_HULL,
+            shader, class_instances, class_instance_count);
+}
 
-    input_layout_impl = wined3d_vertex_declaration_get_parent(wined3d_declaration);
-    wined3d_mutex_unlock();
-    *input_layout = &input_layout_impl->ID3D11InputLayout_iface;
-    ID3D11InputLayout_AddRef(*input_layout);
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_HULL, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetVertexBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *strides, UINT *offsets)
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_HULL, start_slot, buffer_count, buffers);
+}
 
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p.\n",
-            iface, start_slot, buffer_count, buffers, strides, offsets);
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot, view_count, views);
+}
 
-    wined3d_mutex_lock();
-    for (i = 0; i < buffer_count; ++i)
-    {
-        struct wined3d_buffer *wined3d_buffer = NULL;
-        struct d3d_buffer *buffer_impl;
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11DomainShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_DOMAIN,
+            shader, class_instances, class_instance_count);
+}
 
-        if (FAILED(wined3d_device_get_stream_source(device->wined3d_device, start_slot + i,
-                &wined3d_buffer, &offsets[i], &strides[i])))
-        {
-            FIXME("Failed to get vertex buffer %u.\n", start_slot + i);
-            if (strides)
-                strides[i] = 0;
-            if (offsets)
-                offsets[i] = 0;
-        }
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot, sampler_count, samplers);
+}
 
-        if (!wined3d_buffer)
-        {
-            buffers[i] = NULL;
-            continue;
-        }
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_DOMAIN,
+            start_slot, buffer_count, buffers);
+}
 
-        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
-        ID3D11Buffer_AddRef(buffers[i] = &buffer_impl->ID3D11Buffer_iface);
-    }
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_COMPUTE,
+            start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetIndexBuffer(ID3D11DeviceContext1 *iface,
-        ID3D11Buffer **buffer, DXGI_FORMAT *format, UINT *offset)
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11UnorderedAccessView *const *views, const UINT *initial_counts)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    enum wined3d_format_id wined3d_format;
-    struct wined3d_buffer *wined3d_buffer;
-    struct d3d_buffer *buffer_impl;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, buffer %p, format %p, offset %p.\n", iface, buffer, format, offset);
+    TRACE("iface %p, start_slot %u, view_count %u, views %p, initial_counts %p.\n",
+            iface, start_slot, view_count, views, initial_counts);
 
-    wined3d_mutex_lock();
-    wined3d_buffer = wined3d_device_get_index_buffer(device->wined3d_device, &wined3d_format, offset);
-    *format = dxgi_format_from_wined3dformat(wined3d_format);
-    if (!wined3d_buffer)
-    {
-        wined3d_mutex_unlock();
-        *buffer = NULL;
+    if (!d3d11_set_objects(context->state.cs_uavs, ARRAY_SIZE(context->state.cs_uavs),
+            start_slot, view_count, views))
         return;
-    }
+    d3d11_deferred_context_record_slots(context, DEFERRED_OP_SET_CS_UNORDERED_ACCESS_VIEWS,
+            WINED3D_SHADER_TYPE_COMPUTE, start_slot, view_count, views, initial_counts, NULL);
+}
 
-    buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
-    wined3d_mutex_unlock();
-    ID3D11Buffer_AddRef(*buffer = &buffer_impl->ID3D11Buffer_iface);
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11ComputeShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_COMPUTE,
+            shader, class_instances, class_instance_count);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetConstantBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
 {
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot, sampler_count, samplers);
+}
 
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_GEOMETRY, start_slot,
-            buffer_count, buffers);
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_COMPUTE,
+            start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetShader(ID3D11DeviceContext1 *iface,
-        ID3D11GeometryShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_geometry_shader *shader_impl;
-    struct wined3d_shader *wined3d_shader;
+    d3d11_deferred_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot, buffer_count, buffers);
+}
 
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
-            iface, shader, class_instances, class_instance_count);
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    d3d11_deferred_context_get_shader_resources(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot, view_count, views);
+}
 
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11PixelShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_PIXEL,
+            (void **)shader, class_instances, class_instance_count);
+}
 
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_geometry_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    d3d11_deferred_context_get_samplers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot, sampler_count, samplers);
+}
 
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    *shader = &shader_impl->ID3D11GeometryShader_iface;
-    ID3D11GeometryShader_AddRef(*shader);
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11VertexShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_VERTEX,
+            (void **)shader, class_instances, class_instance_count);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_IAGetPrimitiveTopology(ID3D11DeviceContext1 *iface,
-        D3D11_PRIMITIVE_TOPOLOGY *topology)
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    enum wined3d_primitive_type primitive_type;
-    unsigned int patch_vertex_count;
+    d3d11_deferred_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot, buffer_count, buffers);
+}
 
-    TRACE("iface %p, topology %p.\n", iface, topology);
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetInputLayout(ID3D11DeviceContext1 *iface,
+        ID3D11InputLayout **input_layout)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    wined3d_mutex_lock();
-    wined3d_device_get_primitive_type(device->wined3d_device, &primitive_type, &patch_vertex_count);
-    wined3d_mutex_unlock();
+    TRACE("iface %p, input_layout %p.\n", iface, input_layout);
 
-    d3d11_primitive_topology_from_wined3d_primitive_type(primitive_type, patch_vertex_count, topology);
+    d3d11_get_objects(input_layout, 0, 1, &context->state.input_layout, 1);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetShaderResources(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetVertexBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *strides, UINT *offsets)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_context_state *state = &context->state;
     unsigned int i;
 
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p.\n",
+            iface, start_slot, buffer_count, buffers, strides, offsets);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
+    if (buffers)
+        d3d11_get_objects(buffers, start_slot, buffer_count, state->vertex_buffers, ARRAY_SIZE(state->vertex_buffers));
+    for (i = 0; i < buffer_count; ++i)
     {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_vs_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
+        BOOL valid = start_slot + i < ARRAY_SIZE(state->vertex_buffers);
 
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
-        ID3D11ShaderResourceView_AddRef(views[i]);
+        if (strides)
+            strides[i] = valid ? state->strides[start_slot + i] : 0;
+        if (offsets)
+            offsets[i] = valid ? state->offsets[start_slot + i] : 0;
     }
-    wined3d_mutex_unlock();
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetIndexBuffer(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer **buffer, DXGI_FORMAT *format, UINT *offset)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct wined3d_sampler *wined3d_sampler;
-        struct d3d_sampler_state *sampler_impl;
+    TRACE("iface %p, buffer %p, format %p, offset %p.\n", iface, buffer, format, offset);
 
-        if (!(wined3d_sampler = wined3d_device_get_vs_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
+    if (buffer)
+        d3d11_get_objects(buffer, 0, 1, &context->state.index_buffer, 1);
+    if (format)
+        *format = context->state.index_format;
+    if (offset)
+        *offset = context->state.index_offset;
+}
 
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
-        ID3D11SamplerState_AddRef(samplers[i]);
-    }
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    d3d11_deferred_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_GEOMETRY,
+            start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GetPredication(ID3D11DeviceContext1 *iface,
-        ID3D11Predicate **predicate, BOOL *value)
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11GeometryShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_query *wined3d_predicate;
-    struct d3d_query *predicate_impl;
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_GEOMETRY,
+            (void **)shader, class_instances, class_instance_count);
+}
 
-    TRACE("iface %p, predicate %p, value %p.\n", iface, predicate, value);
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetPrimitiveTopology(ID3D11DeviceContext1 *iface,
+        D3D11_PRIMITIVE_TOPOLOGY *topology)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    wined3d_mutex_lock();
-    if (!(wined3d_predicate = wined3d_device_get_predication(device->wined3d_device, value)))
-    {
-        wined3d_mutex_unlock();
-        *predicate = NULL;
-        return;
-    }
+    TRACE("iface %p, topology %p.\n", iface, topology);
 
-    predicate_impl = wined3d_query_get_parent(wined3d_predicate);
-    wined3d_mutex_unlock();
-    *predicate = (ID3D11Predicate *)&predicate_impl->ID3D11Query_iface;
-    ID3D11Predicate_AddRef(*predicate);
+    *topology = context->state.topology;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_gs_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
-
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        views[i] = &view_impl->ID3D11ShaderResourceView_iface;
-        ID3D11ShaderResourceView_AddRef(views[i]);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_shader_resources(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetSamplers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetSamplers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct d3d_sampler_state *sampler_impl;
-        struct wined3d_sampler *wined3d_sampler;
-
-        if (!(wined3d_sampler = wined3d_device_get_gs_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
-
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        samplers[i] = &sampler_impl->ID3D11SamplerState_iface;
-        ID3D11SamplerState_AddRef(samplers[i]);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_samplers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetRenderTargets(ID3D11DeviceContext1 *iface,
-        UINT render_target_view_count, ID3D11RenderTargetView **render_target_views,
-        ID3D11DepthStencilView **depth_stencil_view)
+static void STDMETHODCALLTYPE d3d11_deferred_context_GetPredication(ID3D11DeviceContext1 *iface,
+        ID3D11Predicate **predicate, BOOL *value)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_rendertarget_view *wined3d_view;
-
-    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
-            iface, render_target_view_count, render_target_views, depth_stencil_view);
-
-    wined3d_mutex_lock();
-    if (render_target_views)
-    {
-        struct d3d_rendertarget_view *view_impl;
-        unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-        for (i = 0; i < render_target_view_count; ++i)
-        {
-            if (!(wined3d_view = wined3d_device_get_rendertarget_view(device->wined3d_device, i))
-                    || !(view_impl = wined3d_rendertarget_view_get_parent(wined3d_view)))
-            {
-                render_target_views[i] = NULL;
-                continue;
-            }
+    TRACE("iface %p, predicate %p, value %p.\n", iface, predicate, value);
 
-            render_target_views[i] = &view_impl->ID3D11RenderTargetView_iface;
-            ID3D11RenderTargetView_AddRef(render_target_views[i]);
-        }
-    }
+    d3d11_get_objects(predicate, 0, 1, &context->state.predicate, 1);
+    if (value)
+        *value = context->state.predicate_value;
+}
 
-    if (depth_stencil_view)
-    {
-        struct d3d_depthstencil_view *view_impl;
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    d3d11_deferred_context_get_shader_resources(iface, WINED3D_SHADER_TYPE_GEOMETRY,
+            start_slot, view_count, views);
+}
 
-        if (!(wined3d_view = wined3d_device_get_depth_stencil_view(device->wined3d_device))
-                || !(view_impl = wined3d_rendertarget_view_get_parent(wined3d_view)))
-        {
-            *depth_stencil_view = NULL;
-        }
-        else
-        {
-            *depth_stencil_view = &view_impl->ID3D11DepthStencilView_iface;
-            ID3D11DepthStencilView_AddRef(*depth_stencil_view);
-        }
-    }
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    d3d11_deferred_context_get_samplers(iface, WINED3D_SHADER_TYPE_GEOMETRY,
+            start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetRenderTargetsAndUnorderedAccessViews(
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetRenderTargetsAndUnorderedAccessViews(
         ID3D11DeviceContext1 *iface,
         UINT render_target_view_count, ID3D11RenderTargetView **render_target_views,
         ID3D11DepthStencilView **depth_stencil_view,
         UINT unordered_access_view_start_slot, UINT unordered_access_view_count,
         ID3D11UnorderedAccessView **unordered_access_views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_unordered_access_view *wined3d_view;
-    struct d3d11_unordered_access_view *view_impl;
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_context_state *state = &context->state;
 
     TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p, "
             "unordered_access_view_start_slot %u, unordered_access_view_count %u, "
@@ -1852,133 +5418,87 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetRenderTargetsAndUnord
             iface, render_target_view_count, render_target_views, depth_stencil_view,
             unordered_access_view_start_slot, unordered_access_view_count, unordered_access_views);
 
-    if (render_target_views || depth_stencil_view)
-        d3d11_immediate_context_OMGetRenderTargets(iface, render_target_view_count,
-                render_target_views, depth_stencil_view);
-
+    if (render_target_views)
+        d3d11_get_objects(render_target_views, 0, render_target_view_count, state->rtvs, ARRAY_SIZE(state->rtvs));
+    if (depth_stencil_view)
+        d3d11_get_objects(depth_stencil_view, 0, 1, &state->dsv, 1);
     if (unordered_access_views)
-    {
-        wined3d_mutex_lock();
-        for (i = 0; i < unordered_access_view_count; ++i)
-        {
-            if (!(wined3d_view = wined3d_device_get_unordered_access_view(device->wined3d_device,
-                    unordered_access_view_start_slot + i)))
-            {
-                unordered_access_views[i] = NULL;
-                continue;
-            }
+        d3d11_get_objects(unordered_access_views, unordered_access_view_start_slot,
+                unordered_access_view_count, state->uavs, ARRAY_SIZE(state->uavs));
+}
 
-            view_impl = wined3d_unordered_access_view_get_parent(wined3d_view);
-            unordered_access_views[i] = &view_impl->ID3D11UnorderedAccessView_iface;
-            ID3D11UnorderedAccessView_AddRef(unordered_access_views[i]);
-        }
-        wined3d_mutex_unlock();
-    }
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetRenderTargets(ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView **render_target_views,
+        ID3D11DepthStencilView **depth_stencil_view)
+{
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view);
+
+    d3d11_deferred_context_OMGetRenderTargetsAndUnorderedAccessViews(iface, render_target_view_count,
+            render_target_views, depth_stencil_view, 0, 0, NULL);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetBlendState(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetBlendState(ID3D11DeviceContext1 *iface,
         ID3D11BlendState **blend_state, FLOAT blend_factor[4], UINT *sample_mask)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_blend_state *wined3d_state;
-    struct d3d_blend_state *blend_state_impl;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p, blend_state %p, blend_factor %p, sample_mask %p.\n",
             iface, blend_state, blend_factor, sample_mask);
 
-    wined3d_mutex_lock();
-    if ((wined3d_state = wined3d_device_get_blend_state(device->wined3d_device,
-            (struct wined3d_color *)blend_factor, sample_mask)))
-    {
-        blend_state_impl = wined3d_blend_state_get_parent(wined3d_state);
-        ID3D11BlendState_AddRef(*blend_state = &blend_state_impl->ID3D11BlendState_iface);
-    }
-    else
-    {
-        *blend_state = NULL;
-    }
-    wined3d_mutex_unlock();
+    if (blend_state)
+        d3d11_get_objects(blend_state, 0, 1, &context->state.blend_state, 1);
+    if (blend_factor)
+        memcpy(blend_factor, context->state.blend_factor, sizeof(context->state.blend_factor));
+    if (sample_mask)
+        *sample_mask = context->state.sample_mask;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_OMGetDepthStencilState(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetDepthStencilState(ID3D11DeviceContext1 *iface,
         ID3D11DepthStencilState **depth_stencil_state, UINT *stencil_ref)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p, depth_stencil_state %p, stencil_ref %p.\n",
             iface, depth_stencil_state, stencil_ref);
 
-    if ((*depth_stencil_state = device->depth_stencil_state
-            ? &device->depth_stencil_state->ID3D11DepthStencilState_iface : NULL))
-        ID3D11DepthStencilState_AddRef(*depth_stencil_state);
-    *stencil_ref = device->stencil_ref;
+    if (depth_stencil_state)
+        d3d11_get_objects(depth_stencil_state, 0, 1, &context->state.depth_stencil_state, 1);
+    if (stencil_ref)
+        *stencil_ref = context->state.stencil_ref;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_SOGetTargets(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_SOGetTargets(ID3D11DeviceContext1 *iface,
         UINT buffer_count, ID3D11Buffer **buffers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p, buffer_count %u, buffers %p.\n", iface, buffer_count, buffers);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < buffer_count; ++i)
-    {
-        struct wined3d_buffer *wined3d_buffer;
-        struct d3d_buffer *buffer_impl;
-
-        if (!(wined3d_buffer = wined3d_device_get_stream_output(device->wined3d_device, i, NULL)))
-        {
-            buffers[i] = NULL;
-            continue;
-        }
-
-        buffer_impl = wined3d_buffer_get_parent(wined3d_buffer);
-        buffers[i] = &buffer_impl->ID3D11Buffer_iface;
-        ID3D11Buffer_AddRef(buffers[i]);
-    }
-    wined3d_mutex_unlock();
+    d3d11_get_objects(buffers, 0, buffer_count, context->state.so_buffers, ARRAY_SIZE(context->state.so_buffers));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetState(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSGetState(ID3D11DeviceContext1 *iface,
         ID3D11RasterizerState **rasterizer_state)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d_rasterizer_state *rasterizer_state_impl;
-    struct wined3d_rasterizer_state *wined3d_state;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p, rasterizer_state %p.\n", iface, rasterizer_state);
 
-    wined3d_mutex_lock();
-    if ((wined3d_state = wined3d_device_get_rasterizer_state(device->wined3d_device)))
-    {
-        rasterizer_state_impl = wined3d_rasterizer_state_get_parent(wined3d_state);
-        ID3D11RasterizerState_AddRef(*rasterizer_state = &rasterizer_state_impl->ID3D11RasterizerState_iface);
-    }
-    else
-    {
-        *rasterizer_state = NULL;
-    }
-    wined3d_mutex_unlock();
+    d3d11_get_objects(rasterizer_state, 0, 1, &context->state.rasterizer_state, 1);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetViewports(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSGetViewports(ID3D11DeviceContext1 *iface,
         UINT *viewport_count, D3D11_VIEWPORT *viewports)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_viewport wined3d_vp[WINED3D_MAX_VIEWPORTS];
-    unsigned int actual_count = ARRAY_SIZE(wined3d_vp), i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int actual_count = context->state.viewport_count;
 
     TRACE("iface %p, viewport_count %p, viewports %p.\n", iface, viewport_count, viewports);
 
     if (!viewport_count)
         return;
 
-    wined3d_mutex_lock();
-    wined3d_device_get_viewports(device->wined3d_device, &actual_count, viewports ? wined3d_vp : NULL);
-    wined3d_mutex_unlock();
-
     if (!viewports)
     {
         *viewport_count = actual_count;
@@ -1989,34 +5509,20 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetViewports(ID3D11Devic
         memset(&viewports[actual_count], 0, (*viewport_count - actual_count) * sizeof(*viewports));
 
     *viewport_count = min(actual_count, *viewport_count);
-    for (i = 0; i < *viewport_count; ++i)
-    {
-        viewports[i].TopLeftX = wined3d_vp[i].x;
-        viewports[i].TopLeftY = wined3d_vp[i].y;
-        viewports[i].Width = wined3d_vp[i].width;
-        viewports[i].Height = wined3d_vp[i].height;
-        viewports[i].MinDepth = wined3d_vp[i].min_z;
-        viewports[i].MaxDepth = wined3d_vp[i].max_z;
-    }
+    memcpy(viewports, context->state.viewports, *viewport_count * sizeof(*viewports));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetScissorRects(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSGetScissorRects(ID3D11DeviceContext1 *iface,
         UINT *rect_count, D3D11_RECT *rects)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int actual_count;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int actual_count = context->state.scissor_rect_count;
 
     TRACE("iface %p, rect_count %p, rects %p.\n", iface, rect_count, rects);
 
     if (!rect_count)
         return;
 
-    actual_count = *rect_count;
-
-    wined3d_mutex_lock();
-    wined3d_device_get_scissor_rects(device->wined3d_device, &actual_count, rects);
-    wined3d_mutex_unlock();
-
     if (!rects)
     {
         *rect_count = actual_count;
@@ -2025,471 +5531,201 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_RSGetScissorRects(ID3D11De
 
     if (*rect_count > actual_count)
         memset(&rects[actual_count], 0, (*rect_count - actual_count) * sizeof(*rects));
+    memcpy(rects, context->state.scissor_rects, min(actual_count, *rect_count) * sizeof(*rects));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_hs_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
-
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_shader_resources(iface, WINED3D_SHADER_TYPE_HULL, start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetShader(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetShader(ID3D11DeviceContext1 *iface,
         ID3D11HullShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_hull_shader *shader_impl;
-    struct wined3d_shader *wined3d_shader;
-
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
-            iface, shader, class_instances, class_instance_count);
-
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
-
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_hull_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
-
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    ID3D11HullShader_AddRef(*shader = &shader_impl->ID3D11HullShader_iface);
-}
-
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct wined3d_sampler *wined3d_sampler;
-        struct d3d_sampler_state *sampler_impl;
-
-        if (!(wined3d_sampler = wined3d_device_get_hs_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
-
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
-    }
-    wined3d_mutex_unlock();
-}
-
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetConstantBuffers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
-{
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
-
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_HULL, start_slot,
-            buffer_count, buffers);
-}
-
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetShaderResources(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
-            iface, start_slot, view_count, views);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_ds_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
-
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
-    }
-    wined3d_mutex_unlock();
-}
-
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetShader(ID3D11DeviceContext1 *iface,
-        ID3D11DomainShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_domain_shader *shader_impl;
-    struct wined3d_shader *wined3d_shader;
-
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
-            iface, shader, class_instances, class_instance_count);
-
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
-
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_domain_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
-
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    ID3D11DomainShader_AddRef(*shader = &shader_impl->ID3D11DomainShader_iface);
-}
-
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetSamplers(ID3D11DeviceContext1 *iface,
-        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct wined3d_sampler *wined3d_sampler;
-        struct d3d_sampler_state *sampler_impl;
-
-        if (!(wined3d_sampler = wined3d_device_get_ds_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
+{
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_HULL,
+            (void **)shader, class_instances, class_instance_count);
+}
 
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
-    }
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    d3d11_deferred_context_get_samplers(iface, WINED3D_SHADER_TYPE_HULL, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
 {
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
-
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_HULL, start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetShaderResources(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetShaderResources(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    d3d11_deferred_context_get_shader_resources(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot, view_count, views);
+}
 
-    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11DomainShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_DOMAIN,
+            (void **)shader, class_instances, class_instance_count);
+}
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_shader_resource_view *wined3d_view;
-        struct d3d_shader_resource_view *view_impl;
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    d3d11_deferred_context_get_samplers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot, sampler_count, samplers);
+}
 
-        if (!(wined3d_view = wined3d_device_get_cs_resource_view(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    d3d11_deferred_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_DOMAIN,
+            start_slot, buffer_count, buffers);
+}
 
-        view_impl = wined3d_shader_resource_view_get_parent(wined3d_view);
-        ID3D11ShaderResourceView_AddRef(views[i] = &view_impl->ID3D11ShaderResourceView_iface);
-    }
-    wined3d_mutex_unlock();
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    d3d11_deferred_context_get_shader_resources(iface, WINED3D_SHADER_TYPE_COMPUTE,
+            start_slot, view_count, views);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT view_count, ID3D11UnorderedAccessView **views)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p, start_slot %u, view_count %u, views %p.\n", iface, start_slot, view_count, views);
 
-    wined3d_mutex_lock();
-    for (i = 0; i < view_count; ++i)
-    {
-        struct wined3d_unordered_access_view *wined3d_view;
-        struct d3d11_unordered_access_view *view_impl;
-
-        if (!(wined3d_view = wined3d_device_get_cs_uav(device->wined3d_device, start_slot + i)))
-        {
-            views[i] = NULL;
-            continue;
-        }
-
-        view_impl = wined3d_unordered_access_view_get_parent(wined3d_view);
-        ID3D11UnorderedAccessView_AddRef(views[i] = &view_impl->ID3D11UnorderedAccessView_iface);
-    }
-    wined3d_mutex_unlock();
+    d3d11_get_objects(views, start_slot, view_count, context->state.cs_uavs, ARRAY_SIZE(context->state.cs_uavs));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetShader(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetShader(ID3D11DeviceContext1 *iface,
         ID3D11ComputeShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct d3d11_compute_shader *shader_impl;
-    struct wined3d_shader *wined3d_shader;
-
-    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %p.\n",
-            iface, shader, class_instances, class_instance_count);
-
-    if (class_instances || class_instance_count)
-        FIXME("Dynamic linking not implemented yet.\n");
-    if (class_instance_count)
-        *class_instance_count = 0;
-
-    wined3d_mutex_lock();
-    if (!(wined3d_shader = wined3d_device_get_compute_shader(device->wined3d_device)))
-    {
-        wined3d_mutex_unlock();
-        *shader = NULL;
-        return;
-    }
-
-    shader_impl = wined3d_shader_get_parent(wined3d_shader);
-    wined3d_mutex_unlock();
-    ID3D11ComputeShader_AddRef(*shader = &shader_impl->ID3D11ComputeShader_iface);
+    d3d11_deferred_context_get_shader(iface, WINED3D_SHADER_TYPE_COMPUTE,
+            (void **)shader, class_instances, class_instance_count);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetSamplers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetSamplers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    unsigned int i;
-
-    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
-            iface, start_slot, sampler_count, samplers);
-
-    wined3d_mutex_lock();
-    for (i = 0; i < sampler_count; ++i)
-    {
-        struct wined3d_sampler *wined3d_sampler;
-        struct d3d_sampler_state *sampler_impl;
-
-        if (!(wined3d_sampler = wined3d_device_get_cs_sampler(device->wined3d_device, start_slot + i)))
-        {
-            samplers[i] = NULL;
-            continue;
-        }
-
-        sampler_impl = wined3d_sampler_get_parent(wined3d_sampler);
-        ID3D11SamplerState_AddRef(samplers[i] = &sampler_impl->ID3D11SamplerState_iface);
-    }
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_get_samplers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot, sampler_count, samplers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetConstantBuffers(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
 {
-    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
-            iface, start_slot, buffer_count, buffers);
-
-    d3d11_immediate_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot,
-            buffer_count, buffers);
+    d3d11_deferred_context_get_constant_buffers(iface, WINED3D_SHADER_TYPE_COMPUTE,
+            start_slot, buffer_count, buffers);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearState(ID3D11DeviceContext1 *iface)
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearState(ID3D11DeviceContext1 *iface)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    static const float blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
-    unsigned int i, j;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p.\n", iface);
 
-    wined3d_mutex_lock();
-    wined3d_device_set_vertex_shader(device->wined3d_device, NULL);
-    wined3d_device_set_hull_shader(device->wined3d_device, NULL);
-    wined3d_device_set_domain_shader(device->wined3d_device, NULL);
-    wined3d_device_set_geometry_shader(device->wined3d_device, NULL);
-    wined3d_device_set_pixel_shader(device->wined3d_device, NULL);
-    wined3d_device_set_compute_shader(device->wined3d_device, NULL);
-    for (i = 0; i < D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT; ++i)
-    {
-        wined3d_device_set_vs_sampler(device->wined3d_device, i, NULL);
-        wined3d_device_set_hs_sampler(device->wined3d_device, i, NULL);
-        wined3d_device_set_ds_sampler(device->wined3d_device, i, NULL);
-        wined3d_device_set_gs_sampler(device->wined3d_device, i, NULL);
-        wined3d_device_set_ps_sampler(device->wined3d_device, i, NULL);
-        wined3d_device_set_cs_sampler(device->wined3d_device, i, NULL);
-    }
-    for (i = 0; i < D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT; ++i)
-    {
-        wined3d_device_set_vs_resource_view(device->wined3d_device, i, NULL);
-        wined3d_device_set_hs_resource_view(device->wined3d_device, i, NULL);
-        wined3d_device_set_ds_resource_view(device->wined3d_device, i, NULL);
-        wined3d_device_set_gs_resource_view(device->wined3d_device, i, NULL);
-        wined3d_device_set_ps_resource_view(device->wined3d_device, i, NULL);
-        wined3d_device_set_cs_resource_view(device->wined3d_device, i, NULL);
-    }
-    for (i = 0; i < WINED3D_SHADER_TYPE_COUNT; ++i)
-    {
-        for (j = 0; j < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT; ++j)
-            wined3d_device_set_constant_buffer(device->wined3d_device, i, j, NULL);
-    }
-    for (i = 0; i < D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT; ++i)
-    {
-        wined3d_device_set_stream_source(device->wined3d_device, i, NULL, 0, 0);
-    }
-    wined3d_device_set_index_buffer(device->wined3d_device, NULL, WINED3DFMT_UNKNOWN, 0);
-    wined3d_device_set_vertex_declaration(device->wined3d_device, NULL);
-    wined3d_device_set_primitive_type(device->wined3d_device, WINED3D_PT_UNDEFINED, 0);
-    for (i = 0; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
-    {
-        wined3d_device_set_rendertarget_view(device->wined3d_device, i, NULL, FALSE);
-    }
-    wined3d_device_set_depth_stencil_view(device->wined3d_device, NULL);
-    for (i = 0; i < D3D11_PS_CS_UAV_REGISTER_COUNT; ++i)
-    {
-        wined3d_device_set_unordered_access_view(device->wined3d_device, i, NULL, ~0u);
-        wined3d_device_set_cs_uav(device->wined3d_device, i, NULL, ~0u);
-    }
-    ID3D11DeviceContext1_OMSetDepthStencilState(iface, NULL, 0);
-    ID3D11DeviceContext1_OMSetBlendState(iface, NULL, blend_factor, D3D11_DEFAULT_SAMPLE_MASK);
-    ID3D11DeviceContext1_RSSetViewports(iface, 0, NULL);
-    ID3D11DeviceContext1_RSSetScissorRects(iface, 0, NULL);
-    ID3D11DeviceContext1_RSSetState(iface, NULL);
-    for (i = 0; i < D3D11_SO_BUFFER_SLOT_COUNT; ++i)
-    {
-        wined3d_device_set_stream_output(device->wined3d_device, i, NULL, 0);
-    }
-    wined3d_device_set_predication(device->wined3d_device, NULL, FALSE);
-    wined3d_mutex_unlock();
+    d3d11_context_state_cleanup(&context->state);
+    d3d11_command_list_require_space(context->list, DEFERRED_OP_CLEAR_STATE, sizeof(struct d3d11_deferred_packet));
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_Flush(ID3D11DeviceContext1 *iface)
+static void STDMETHODCALLTYPE d3d11_deferred_context_Flush(ID3D11DeviceContext1 *iface)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-
     TRACE("iface %p.\n", iface);
-
-    wined3d_mutex_lock();
-    wined3d_device_flush(device->wined3d_device);
-    wined3d_mutex_unlock();
 }
 
-static D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE d3d11_immediate_context_GetType(ID3D11DeviceContext1 *iface)
+static D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE d3d11_deferred_context_GetType(ID3D11DeviceContext1 *iface)
 {
     TRACE("iface %p.\n", iface);
 
-    return D3D11_DEVICE_CONTEXT_IMMEDIATE;
+    return D3D11_DEVICE_CONTEXT_DEFERRED;
 }
 
-static UINT STDMETHODCALLTYPE d3d11_immediate_context_GetContextFlags(ID3D11DeviceContext1 *iface)
+static UINT STDMETHODCALLTYPE d3d11_deferred_context_GetContextFlags(ID3D11DeviceContext1 *iface)
 {
     TRACE("iface %p.\n", iface);
 
     return 0;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_immediate_context_FinishCommandList(ID3D11DeviceContext1 *iface,
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_FinishCommandList(ID3D11DeviceContext1 *iface,
         BOOL restore, ID3D11CommandList **command_list)
 {
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_command_list *list = context->list;
+    struct d3d11_context_state *state;
+    HRESULT hr;
+
     TRACE("iface %p, restore %#x, command_list %p.\n", iface, restore, command_list);
 
-    return DXGI_ERROR_INVALID_CALL;
+    if (FAILED(hr = d3d11_command_list_create(context->device, &context->list)))
+    {
+        context->list = list;
+        *command_list = NULL;
+        return hr;
+    }
+
+    if (!restore)
+    {
+        d3d11_context_state_cleanup(&context->state);
+    }
+    else if ((state = heap_alloc_zero(sizeof(*state))))
+    {
+        /* Command lists always start from the default state, so the state
+         * carried over has to be recorded at the start of the next one. */
+        d3d11_context_state_capture(state, iface);
+        d3d11_context_state_apply(state, iface);
+        heap_free(state);
+    }
+    else
+    {
+        ERR("Failed to allocate context state.\n");
+    }
+
+    if (list->failed)
+    {
+        ID3D11CommandList_Release(&list->ID3D11CommandList_iface);
+        *command_list = NULL;
+        return E_OUTOFMEMORY;
+    }
+
+    TRACE("Created command list %p, %lu bytes, %lu references.\n",
+            list, (unsigned long)list->data_size, (unsigned long)list->ref_count);
+
+    *command_list = &list->ID3D11CommandList_iface;
+
+    return S_OK;
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CopySubresourceRegion1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopySubresourceRegion1(ID3D11DeviceContext1 *iface,
         ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
         ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box, UINT flags)
 {
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
-    struct wined3d_box wined3d_src_box;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
     TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
             "src_resource %p, src_subresource_idx %u, src_box %p, flags %#x.\n",
             iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
             src_resource, src_subresource_idx, src_box, flags);
 
-    if (!dst_resource || !src_resource)
-        return;
-
-    if (src_box)
-        wined3d_box_set(&wined3d_src_box, src_box->left, src_box->top,
-                src_box->right, src_box->bottom, src_box->front, src_box->back);
-
-    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
-    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
-    wined3d_mutex_lock();
-    wined3d_device_copy_sub_resource_region(device->wined3d_device, wined3d_dst_resource, dst_subresource_idx,
-            dst_x, dst_y, dst_z, wined3d_src_resource, src_subresource_idx, src_box ? &wined3d_src_box : NULL, flags);
-    wined3d_mutex_unlock();
-}
-
-static void STDMETHODCALLTYPE d3d11_immediate_context_UpdateSubresource1(ID3D11DeviceContext1 *iface,
-        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box, const void *data,
-        UINT row_pitch, UINT depth_pitch, UINT flags)
-{
-    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
-    struct wined3d_resource *wined3d_resource;
-    struct wined3d_box wined3d_box;
-
-    TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u, flags %#x.\n",
-            iface, resource, subresource_idx, box, data, row_pitch, depth_pitch, flags);
-
-    if (box)
-        wined3d_box_set(&wined3d_box, box->left, box->top, box->right, box->bottom,
-                box->front, box->back);
-
-    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
-    wined3d_mutex_lock();
-    wined3d_device_update_sub_resource(device->wined3d_device, wined3d_resource, subresource_idx,
-            box ? &wined3d_box : NULL, data, row_pitch, depth_pitch, flags);
-    wined3d_mutex_unlock();
+    d3d11_deferred_context_record_copy(context, DEFERRED_OP_COPY_SUBRESOURCE_REGION, dst_resource,
+            dst_subresource_idx, dst_x, dst_y, dst_z, src_resource, src_subresource_idx, src_box, flags);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardResource(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DiscardResource(ID3D11DeviceContext1 *iface,
         ID3D11Resource *resource)
 {
     FIXME("iface %p, resource %p stub!\n", iface, resource);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardView(ID3D11DeviceContext1 *iface, ID3D11View *view)
+static void STDMETHODCALLTYPE d3d11_deferred_context_DiscardView(ID3D11DeviceContext1 *iface, ID3D11View *view)
 {
     FIXME("iface %p, view %p stub!\n", iface, view);
 }
-
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2497,7 +5733,7 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_VSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2505,7 +5741,7 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2513,7 +5749,7 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_DSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2521,7 +5757,7 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_GSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2529,7 +5765,7 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_PSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
         const UINT *num_constants)
 {
@@ -2537,297 +5773,237 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_CSSetConstantBuffers1(ID3D
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_VSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_HSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_GSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_PSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_CSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
         UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
 {
     FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
             iface, start_slot, buffer_count, buffers, first_constant, num_constants);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_SwapDeviceContextState(ID3D11DeviceContext1 *iface,
+static void STDMETHODCALLTYPE d3d11_deferred_context_SwapDeviceContextState(ID3D11DeviceContext1 *iface,
         ID3DDeviceContextState *state, ID3DDeviceContextState **prev_state)
 {
     FIXME("iface %p, state %p, prev_state %p stub!\n", iface, state, prev_state);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_ClearView(ID3D11DeviceContext1 *iface, ID3D11View *view,
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearView(ID3D11DeviceContext1 *iface, ID3D11View *view,
         const FLOAT color[4], const D3D11_RECT *rect, UINT num_rects)
 {
     FIXME("iface %p, view %p, color %p, rect %p, num_rects %u stub!\n", iface, view, color, rect, num_rects);
 }
 
-static void STDMETHODCALLTYPE d3d11_immediate_context_DiscardView1(ID3D11DeviceContext1 *iface, ID3D11View *view,
+static void STDMETHODCALLTYPE d3d11_deferred_context_DiscardView1(ID3D11DeviceContext1 *iface, ID3D11View *view,
         const D3D11_RECT *rects, UINT num_rects)
 {
     FIXME("iface %p, view %p, rects %p, num_rects %u stub!\n", iface, view, rects, num_rects);
 }
 
-static const struct ID3D11DeviceContext1Vtbl d3d11_immediate_context_vtbl =
+static const struct ID3D11DeviceContext1Vtbl d3d11_deferred_context_vtbl =
 {
     /* IUnknown methods */
-    d3d11_immediate_context_QueryInterface,
-    d3d11_immediate_context_AddRef,
-    d3d11_immediate_context_Release,
+    d3d11_deferred_context_QueryInterface,
+    d3d11_deferred_context_AddRef,
+    d3d11_deferred_context_Release,
     /* ID3D11DeviceChild methods */
-    d3d11_immediate_context_GetDevice,
-    d3d11_immediate_context_GetPrivateData,
-    d3d11_immediate_context_SetPrivateData,
-    d3d11_immediate_context_SetPrivateDataInterface,
+    d3d11_deferred_context_GetDevice,
+    d3d11_deferred_context_GetPrivateData,
+    d3d11_deferred_context_SetPrivateData,
+    d3d11_deferred_context_SetPrivateDataInterface,
     /* ID3D11DeviceContext methods */
-    d3d11_immediate_context_VSSetConstantBuffers,
-    d3d11_immediate_context_PSSetShaderResources,
-    d3d11_immediate_context_PSSetShader,
-    d3d11_immediate_context_PSSetSamplers,
-    d3d11_immediate_context_VSSetShader,
-    d3d11_immediate_context_DrawIndexed,
-    d3d11_immediate_context_Draw,
-    d3d11_immediate_context_Map,
-    d3d11_immediate_context_Unmap,
-    d3d11_immediate_context_PSSetConstantBuffers,
-    d3d11_immediate_context_IASetInputLayout,
-    d3d11_immediate_context_IASetVertexBuffers,
-    d3d11_immediate_context_IASetIndexBuffer,
-    d3d11_immediate_context_DrawIndexedInstanced,
-    d3d11_immediate_context_DrawInstanced,
-    d3d11_immediate_context_GSSetConstantBuffers,
-    d3d11_immediate_context_GSSetShader,
-    d3d11_immediate_context_IASetPrimitiveTopology,
-    d3d11_immediate_context_VSSetShaderResources,
-    d3d11_immediate_context_VSSetSamplers,
-    d3d11_immediate_context_Begin,
-    d3d11_immediate_context_End,
-    d3d11_immediate_context_GetData,
-    d3d11_immediate_context_SetPredication,
-    d3d11_immediate_context_GSSetShaderResources,
-    d3d11_immediate_context_GSSetSamplers,
-    d3d11_immediate_context_OMSetRenderTargets,
-    d3d11_immediate_context_OMSetRenderTargetsAndUnorderedAccessViews,
-    d3d11_immediate_context_OMSetBlendState,
-    d3d11_immediate_context_OMSetDepthStencilState,
-    d3d11_immediate_context_SOSetTargets,
-    d3d11_immediate_context_DrawAuto,
-    d3d11_immediate_context_DrawIndexedInstancedIndirect,
-    d3d11_immediate_context_DrawInstancedIndirect,
-    d3d11_immediate_context_Dispatch,
-    d3d11_immediate_context_DispatchIndirect,
-    d3d11_immediate_context_RSSetState,
-    d3d11_immediate_context_RSSetViewports,
-    d3d11_immediate_context_RSSetScissorRects,
-    d3d11_immediate_context_CopySubresourceRegion,
-    d3d11_immediate_context_CopyResource,
-    d3d11_immediate_context_UpdateSubresource,
-    d3d11_immediate_context_CopyStructureCount,
-    d3d11_immediate_context_ClearRenderTargetView,
-    d3d11_immediate_context_ClearUnorderedAccessViewUint,
-    d3d11_immediate_context_ClearUnorderedAccessViewFloat,
-    d3d11_immediate_context_ClearDepthStencilView,
-    d3d11_immediate_context_GenerateMips,
-    d3d11_immediate_context_SetResourceMinLOD,
-    d3d11_immediate_context_GetResourceMinLOD,
-    d3d11_immediate_context_ResolveSubresource,
-    d3d11_immediate_context_ExecuteCommandList,
-    d3d11_immediate_context_HSSetShaderResources,
-    d3d11_immediate_context_HSSetShader,
-    d3d11_immediate_context_HSSetSamplers,
-    d3d11_immediate_context_HSSetConstantBuffers,
-    d3d11_immediate_context_DSSetShaderResources,
-    d3d11_immediate_context_DSSetShader,
-    d3d11_immediate_context_DSSetSamplers,
-    d3d11_immediate_context_DSSetConstantBuffers,
-    d3d11_immediate_context_CSSetShaderResources,
-    d3d11_immediate_context_CSSetUnorderedAccessViews,
-    d3d11_immediate_context_CSSetShader,
-    d3d11_immediate_context_CSSetSamplers,
-    d3d11_immediate_context_CSSetConstantBuffers,
-    d3d11_immediate_context_VSGetConstantBuffers,
-    d3d11_immediate_context_PSGetShaderResources,
-    d3d11_immediate_context_PSGetShader,
-    d3d11_immediate_context_PSGetSamplers,
-    d3d11_immediate_context_VSGetShader,
-    d3d11_immediate_context_PSGetConstantBuffers,
-    d3d11_immediate_context_IAGetInputLayout,
-    d3d11_immediate_context_IAGetVertexBuffers,
-    d3d11_immediate_context_IAGetIndexBuffer,
-    d3d11_immediate_context_GSGetConstantBuffers,
-    d3d11_immediate_context_GSGetShader,
-    d3d11_immediate_context_IAGetPrimitiveTopology,
-    d3d11_immediate_context_VSGetShaderResources,
-    d3d11_immediate_context_VSGetSamplers,
-    d3d11_immediate_context_GetPredication,
-    d3d11_immediate_context_GSGetShaderResources,
-    d3d11_immediate_context_GSGetSamplers,
-    d3d11_immediate_context_OMGetRenderTargets,
-    d3d11_immediate_context_OMGetRenderTargetsAndUnorderedAccessViews,
-    d3d11_immediate_context_OMGetBlendState,
-    d3d11_immediate_context_OMGetDepthStencilState,
-    d3d11_immediate_context_SOGetTargets,
-    d3d11_immediate_context_RSGetState,
-    d3d11_immediate_context_RSGetViewports,
-    d3d11_immediate_context_RSGetScissorRects,
-    d3d11_immediate_context_HSGetShaderResources,
-    d3d11_immediate_context_HSGetShader,
-    d3d11_immediate_context_HSGetSamplers,
-    d3d11_immediate_context_HSGetConstantBuffers,
-    d3d11_immediate_context_DSGetShaderResources,
-    d3d11_immediate_context_DSGetShader,
-    d3d11_immediate_context_DSGetSamplers,
-    d3d11_immediate_context_DSGetConstantBuffers,
-    d3d11_immediate_context_CSGetShaderResources,
-    d3d11_immediate_context_CSGetUnorderedAccessViews,
-    d3d11_immediate_context_CSGetShader,
-    d3d11_immediate_context_CSGetSamplers,
-    d3d11_immediate_context_CSGetConstantBuffers,
-    d3d11_immediate_context_ClearState,
-    d3d11_immediate_context_Flush,
-    d3d11_immediate_context_GetType,
-    d3d11_immediate_context_GetContextFlags,
-    d3d11_immediate_context_FinishCommandList,
+    d3d11_deferred_context_VSSetConstantBuffers,
+    d3d11_deferred_context_PSSetShaderResources,
+    d3d11_deferred_context_PSSetShader,
+    d3d11_deferred_context_PSSetSamplers,
+    d3d11_deferred_context_VSSetShader,
+    d3d11_deferred_context_DrawIndexed,
+    d3d11_deferred_context_Draw,
+    d3d11_deferred_context_Map,
+    d3d11_deferred_context_Unmap,
+    d3d11_deferred_context_PSSetConstantBuffers,
+    d3d11_deferred_context_IASetInputLayout,
+    d3d11_deferred_context_IASetVertexBuffers,
+    d3d11_deferred_context_IASetIndexBuffer,
+    d3d11_deferred_context_DrawIndexedInstanced,
+    d3d11_deferred_context_DrawInstanced,
+    d3d11_deferred_context_GSSetConstantBuffers,
+    d3d11_deferred_context_GSSetShader,
+    d3d11_deferred_context_IASetPrimitiveTopology,
+    d3d11_deferred_context_VSSetShaderResources,
+    d3d11_deferred_context_VSSetSamplers,
+    d3d11_deferred_context_Begin,
+    d3d11_deferred_context_End,
+    d3d11_deferred_context_GetData,
+    d3d11_deferred_context_SetPredication,
+    d3d11_deferred_context_GSSetShaderResources,
+    d3d11_deferred_context_GSSetSamplers,
+    d3d11_deferred_context_OMSetRenderTargets,
+    d3d11_deferred_context_OMSetRenderTargetsAndUnorderedAccessViews,
+    d3d11_deferred_context_OMSetBlendState,
+    d3d11_deferred_context_OMSetDepthStencilState,
+    d3d11_deferred_context_SOSetTargets,
+    d3d11_deferred_context_DrawAuto,
+    d3d11_deferred_context_DrawIndexedInstancedIndirect,
+    d3d11_deferred_context_DrawInstancedIndirect,
+    d3d11_deferred_context_Dispatch,
+    d3d11_deferred_context_DispatchIndirect,
+    d3d11_deferred_context_RSSetState,
+    d3d11_deferred_context_RSSetViewports,
+    d3d11_deferred_context_RSSetScissorRects,
+    d3d11_deferred_context_CopySubresourceRegion,
+    d3d11_deferred_context_CopyResource,
+    d3d11_deferred_context_UpdateSubresource,
+    d3d11_deferred_context_CopyStructureCount,
+    d3d11_deferred_context_ClearRenderTargetView,
+    d3d11_deferred_context_ClearUnorderedAccessViewUint,
+    d3d11_deferred_context_ClearUnorderedAccessViewFloat,
+    d3d11_deferred_context_ClearDepthStencilView,
+    d3d11_deferred_context_GenerateMips,
+    d3d11_deferred_context_SetResourceMinLOD,
+    d3d11_deferred_context_GetResourceMinLOD,
+    d3d11_deferred_context_ResolveSubresource,
+    d3d11_deferred_context_ExecuteCommandList,
+    d3d11_deferred_context_HSSetShaderResources,
+    d3d11_deferred_context_HSSetShader,
+    d3d11_deferred_context_HSSetSamplers,
+    d3d11_deferred_context_HSSetConstantBuffers,
+    d3d11_deferred_context_DSSetShaderResources,
+    d3d11_deferred_context_DSSetShader,
+    d3d11_deferred_context_DSSetSamplers,
+    d3d11_deferred_context_DSSetConstantBuffers,
+    d3d11_deferred_context_CSSetShaderResources,
+    d3d11_deferred_context_CSSetUnorderedAccessViews,
+    d3d11_deferred_context_CSSetShader,
+    d3d11_deferred_context_CSSetSamplers,
+    d3d11_deferred_context_CSSetConstantBuffers,
+    d3d11_deferred_context_VSGetConstantBuffers,
+    d3d11_deferred_context_PSGetShaderResources,
+    d3d11_deferred_context_PSGetShader,
+    d3d11_deferred_context_PSGetSamplers,
+    d3d11_deferred_context_VSGetShader,
+    d3d11_deferred_context_PSGetConstantBuffers,
+    d3d11_deferred_context_IAGetInputLayout,
+    d3d11_deferred_context_IAGetVertexBuffers,
+    d3d11_deferred_context_IAGetIndexBuffer,
+    d3d11_deferred_context_GSGetConstantBuffers,
+    d3d11_deferred_context_GSGetShader,
+    d3d11_deferred_context_IAGetPrimitiveTopology,
+    d3d11_deferred_context_VSGetShaderResources,
+    d3d11_deferred_context_VSGetSamplers,
+    d3d11_deferred_context_GetPredication,
+    d3d11_deferred_context_GSGetShaderResources,
+    d3d11_deferred_context_GSGetSamplers,
+    d3d11_deferred_context_OMGetRenderTargets,
+    d3d11_deferred_context_OMGetRenderTargetsAndUnorderedAccessViews,
+    d3d11_deferred_context_OMGetBlendState,
+    d3d11_deferred_context_OMGetDepthStencilState,
+    d3d11_deferred_context_SOGetTargets,
+    d3d11_deferred_context_RSGetState,
+    d3d11_deferred_context_RSGetViewports,
+    d3d11_deferred_context_RSGetScissorRects,
+    d3d11_deferred_context_HSGetShaderResources,
+    d3d11_deferred_context_HSGetShader,
+    d3d11_deferred_context_HSGetSamplers,
+    d3d11_deferred_context_HSGetConstantBuffers,
+    d3d11_deferred_context_DSGetShaderResources,
+    d3d11_deferred_context_DSGetShader,
+    d3d11_deferred_context_DSGetSamplers,
+    d3d11_deferred_context_DSGetConstantBuffers,
+    d3d11_deferred_context_CSGetShaderResources,
+    d3d11_deferred_context_CSGetUnorderedAccessViews,
+    d3d11_deferred_context_CSGetShader,
+    d3d11_deferred_context_CSGetSamplers,
+    d3d11_deferred_context_CSGetConstantBuffers,
+    d3d11_deferred_context_ClearState,
+    d3d11_deferred_context_Flush,
+    d3d11_deferred_context_GetType,
+    d3d11_deferred_context_GetContextFlags,
+    d3d11_deferred_context_FinishCommandList,
     /* ID3D11DeviceContext1 methods */
-    d3d11_immediate_context_CopySubresourceRegion1,
-    d3d11_immediate_context_UpdateSubresource1,
-    d3d11_immediate_context_DiscardResource,
-    d3d11_immediate_context_DiscardView,
-    d3d11_immediate_context_VSSetConstantBuffers1,
-    d3d11_immediate_context_HSSetConstantBuffers1,
-    d3d11_immediate_context_DSSetConstantBuffers1,
-    d3d11_immediate_context_GSSetConstantBuffers1,
-    d3d11_immediate_context_PSSetConstantBuffers1,
-    d3d11_immediate_context_CSSetConstantBuffers1,
-    d3d11_immediate_context_VSGetConstantBuffers1,
-    d3d11_immediate_context_HSGetConstantBuffers1,
-    d3d11_immediate_context_DSGetConstantBuffers1,
-    d3d11_immediate_context_GSGetConstantBuffers1,
-    d3d11_immediate_context_PSGetConstantBuffers1,
-    d3d11_immediate_context_CSGetConstantBuffers1,
-    d3d11_immediate_context_SwapDeviceContextState,
-    d3d11_immediate_context_ClearView,
-    d3d11_immediate_context_DiscardView1,
+    d3d11_deferred_context_CopySubresourceRegion1,
+    d3d11_deferred_context_UpdateSubresource1,
+    d3d11_deferred_context_DiscardResource,
+    d3d11_deferred_context_DiscardView,
+    d3d11_deferred_context_VSSetConstantBuffers1,
+    d3d11_deferred_context_HSSetConstantBuffers1,
+    d3d11_deferred_context_DSSetConstantBuffers1,
+    d3d11_deferred_context_GSSetConstantBuffers1,
+    d3d11_deferred_context_PSSetConstantBuffers1,
+    d3d11_deferred_context_CSSetConstantBuffers1,
+    d3d11_deferred_context_VSGetConstantBuffers1,
+    d3d11_deferred_context_HSGetConstantBuffers1,
+    d3d11_deferred_context_DSGetConstantBuffers1,
+    d3d11_deferred_context_GSGetConstantBuffers1,
+    d3d11_deferred_context_PSGetConstantBuffers1,
+    d3d11_deferred_context_CSGetConstantBuffers1,
+    d3d11_deferred_context_SwapDeviceContextState,
+    d3d11_deferred_context_ClearView,
+    d3d11_deferred_context_DiscardView1,
 };
 
-/* ID3D11Multithread methods */
-
-static inline struct d3d11_immediate_context *impl_from_ID3D11Multithread(ID3D11Multithread *iface)
-{
-    return CONTAINING_RECORD(iface, struct d3d11_immediate_context, ID3D11Multithread_iface);
-}
-
-static HRESULT STDMETHODCALLTYPE d3d11_multithread_QueryInterface(ID3D11Multithread *iface,
-        REFIID iid, void **out)
-{
-    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
-
-    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
-
-    return d3d11_immediate_context_QueryInterface(&context->ID3D11DeviceContext1_iface, iid, out);
-}
-
-static ULONG STDMETHODCALLTYPE d3d11_multithread_AddRef(ID3D11Multithread *iface)
-{
-    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
-
-    TRACE("iface %p.\n", iface);
-
-    return d3d11_immediate_context_AddRef(&context->ID3D11DeviceContext1_iface);
-}
-
-static ULONG STDMETHODCALLTYPE d3d11_multithread_Release(ID3D11Multithread *iface)
-{
-    struct d3d11_immediate_context *context = impl_from_ID3D11Multithread(iface);
-
-    TRACE("iface %p.\n", iface);
-
-    return d3d11_immediate_context_Release(&context->ID3D11DeviceContext1_iface);
-}
-
-static void STDMETHODCALLTYPE d3d11_multithread_Enter(ID3D11Multithread *iface)
-{
-    TRACE("iface %p.\n", iface);
-
-    wined3d_mutex_lock();
-}
-
-static void STDMETHODCALLTYPE d3d11_multithread_Leave(ID3D11Multithread *iface)
-{
-    TRACE("iface %p.\n", iface);
-
-    wined3d_mutex_unlock();
-}
-
-static BOOL STDMETHODCALLTYPE d3d11_multithread_SetMultithreadProtected(
-        ID3D11Multithread *iface, BOOL enable)
-{
-    FIXME("iface %p, enable %#x stub!\n", iface, enable);
-
-    return TRUE;
-}
-
-static BOOL STDMETHODCALLTYPE d3d11_multithread_GetMultithreadProtected(ID3D11Multithread *iface)
+static HRESULT d3d11_deferred_context_create(struct d3d_device *device, UINT flags,
+        struct d3d11_deferred_context **context)
 {
-    FIXME("iface %p stub!\n", iface);
+    struct d3d11_deferred_context *object;
+    HRESULT hr;
 
-    return TRUE;
-}
+    if (flags)
+        FIXME("Ignoring flags %#x.\n", flags);
 
-static const struct ID3D11MultithreadVtbl d3d11_multithread_vtbl =
-{
-    d3d11_multithread_QueryInterface,
-    d3d11_multithread_AddRef,
-    d3d11_multithread_Release,
-    d3d11_multithread_Enter,
-    d3d11_multithread_Leave,
-    d3d11_multithread_SetMultithreadProtected,
-    d3d11_multithread_GetMultithreadProtected,
-};
+    if (!(object = heap_alloc_zero(sizeof(*object))))
+        return E_OUTOFMEMORY;
 
-static void d3d11_immediate_context_init(struct d3d11_immediate_context *context, struct d3d_device *device)
-{
-    context->ID3D11DeviceContext1_iface.lpVtbl = &d3d11_immediate_context_vtbl;
-    context->ID3D11Multithread_iface.lpVtbl = &d3d11_multithread_vtbl;
-    context->refcount = 1;
+    if (FAILED(hr = d3d11_command_list_create(device, &object->list)))
+    {
+        heap_free(object);
+        return hr;
+    }
 
+    object->ID3D11DeviceContext1_iface.lpVtbl = &d3d11_deferred_context_vtbl;
+    object->refcount = 1;
+    d3d11_context_state_cleanup(&object->state);
+    wined3d_private_store_init(&object->private_store);
+    object->device = device;
     ID3D11Device2_AddRef(&device->ID3D11Device2_iface);
 
-    wined3d_private_store_init(&context->private_store);
-}
+    TRACE("Created deferred context %p.\n", object);
+    *context = object;
 
-static void d3d11_immediate_context_destroy(struct d3d11_immediate_context *context)
-{
-    wined3d_private_store_cleanup(&context->private_store);
+    return S_OK;
 }
 
 /* ID3D11Device methods */
@@ -3309,10 +6485,21 @@ static HRESULT STDMETHODCALLTYPE d3d11_device_CreateCounter(ID3D11Device2 *iface
 static HRESULT STDMETHODCALLTYPE d3d11_device_CreateDeferredContext(ID3D11Device2 *iface, UINT flags,
         ID3D11DeviceContext **context)
 {
-    FIXME("iface %p, flags %#x, context %p stub!\n", iface, flags, context);
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d11_deferred_context *object;
+    HRESULT hr;
 
-    *context = NULL;
-    return E_NOTIMPL;
+    TRACE("iface %p, flags %#x, context %p.\n", iface, flags, context);
+
+    if (FAILED(hr = d3d11_deferred_context_create(device, flags, &object)))
+    {
+        *context = NULL;
+        return hr;
+    }
+
+    *context = (ID3D11DeviceContext *)&object->ID3D11DeviceContext1_iface;
+
+    return S_OK;
 }
 
 static HRESULT STDMETHODCALLTYPE d3d11_device_OpenSharedResource(ID3D11Device2 *iface, HANDLE resource, REFIID iid,
@@ -3743,9 +6930,21 @@ static void STDMETHODCALLTYPE d3d11_device_GetImmediateContext1(ID3D11Device2 *i
 static HRESULT STDMETHODCALLTYPE d3d11_device_CreateDeferredContext1(ID3D11Device2 *iface, UINT flags,
         ID3D11DeviceContext1 **context)
 {
-    FIXME("iface %p, flags %#x, context %p stub!\n", iface, flags, context);
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d11_deferred_context *object;
+    HRESULT hr;
 
-    return E_NOTIMPL;
+    TRACE("iface %p, flags %#x, context %p.\n", iface, flags, context);
+
+    if (FAILED(hr = d3d11_deferred_context_create(device, flags, &object)))
+    {
+        *context = NULL;
+        return hr;
+    }
+
+    *context = &object->ID3D11DeviceContext1_iface;
+
+    return S_OK;
 }
 
 static HRESULT STDMETHODCALLTYPE d3d11_device_CreateBlendState1(ID3D11Device2 *iface,
@@ -2271,7 +2271,7 @@ static void test_create_deferred_context(void)
 
     expected_refcount = get_refcount(device) + 1;
     hr = ID3D11Device_CreateDeferredContext(device, 0, &context);
-    todo_wine ok(hr == S_OK, "Failed to create deferred context, hr %#x.\n", hr);
+    ok(hr == S_OK, "Failed to create deferred context, hr %#x.\n", hr);
     if (FAILED(hr))
         goto done;
     refcount = get_refcount(device);
@@ -2292,6 +2292,188 @@ done:
     ok(!refcount, "Device has %u references left.\n", refcount);
 }
 
+static void test_deferred_context(void)
+{
+    static const float white[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    static const float green[] = {0.0f, 1.0f, 0.0f, 1.0f};
+    static const DWORD data[] = {0x11111111, 0x22222222, 0x33333333, 0x44444444};
+    ID3D11DeviceContext *immediate, *deferred;
+    struct d3d11_test_context test_context;
+    D3D11_MAPPED_SUBRESOURCE map_desc;
+    ID3D11CommandList *list1, *list2;
+    D3D11_BUFFER_DESC buffer_desc;
+    struct resource_readback rb;
+    ID3D11RenderTargetView *rtv;
+    ID3D11Buffer *buffer, *dst;
+    ID3D11Device *device;
+    unsigned int i;
+    ULONG refcount;
+    HRESULT hr;
+
+    if (!init_test_context(&test_context, NULL))
+        return;
+
+    device = test_context.device;
+    immediate = test_context.immediate_context;
+
+    hr = ID3D11Device_CreateDeferredContext(device, 0, &deferred);
+    ok(hr == S_OK, "Failed to create deferred context, hr %#x.\n", hr);
+    ok(ID3D11DeviceContext_GetType(deferred) == D3D11_DEVICE_CONTEXT_DEFERRED,
+            "Got unexpected context type %#x.\n", ID3D11DeviceContext_GetType(deferred));
+
+    ID3D11DeviceContext_ClearRenderTargetView(immediate, test_context.backbuffer_rtv, white);
+    ID3D11DeviceContext_ClearRenderTargetView(deferred, test_context.backbuffer_rtv, green);
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, FALSE, &list1);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+    check_texture_color(test_context.backbuffer, 0xffffffff, 1);
+    ID3D11DeviceContext_ExecuteCommandList(immediate, list1, TRUE);
+    check_texture_color(test_context.backbuffer, 0xff00ff00, 1);
+
+    /* The immediate context state is restored. */
+    ID3D11DeviceContext_OMGetRenderTargets(immediate, 1, &rtv, NULL);
+    ok(rtv == test_context.backbuffer_rtv, "Got unexpected render target view %p.\n", rtv);
+    ID3D11RenderTargetView_Release(rtv);
+
+    ID3D11DeviceContext_OMSetRenderTargets(deferred, 1, &test_context.backbuffer_rtv, NULL);
+    ID3D11DeviceContext_OMGetRenderTargets(deferred, 1, &rtv, NULL);
+    ok(rtv == test_context.backbuffer_rtv, "Got unexpected render target view %p.\n", rtv);
+    ID3D11RenderTargetView_Release(rtv);
+
+    buffer_desc.ByteWidth = sizeof(data);
+    buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+    buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    buffer_desc.MiscFlags = 0;
+    buffer_desc.StructureByteStride = 0;
+    hr = ID3D11Device_CreateBuffer(device, &buffer_desc, NULL, &buffer);
+    ok(hr == S_OK, "Failed to create buffer, hr %#x.\n", hr);
+    dst = create_buffer(device, 0, sizeof(data), NULL);
+
+    hr = ID3D11DeviceContext_Map(deferred, (ID3D11Resource *)buffer, 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &map_desc);
+    ok(hr == E_INVALIDARG, "Got unexpected hr %#x.\n", hr);
+    hr = ID3D11DeviceContext_Map(deferred, (ID3D11Resource *)buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &map_desc);
+    ok(hr == S_OK, "Failed to map buffer, hr %#x.\n", hr);
+    memcpy(map_desc.pData, data, sizeof(data) / 2);
+    ID3D11DeviceContext_Unmap(deferred, (ID3D11Resource *)buffer, 0);
+    hr = ID3D11DeviceContext_Map(deferred, (ID3D11Resource *)buffer, 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &map_desc);
+    ok(hr == S_OK, "Failed to map buffer, hr %#x.\n", hr);
+    memcpy((BYTE *)map_desc.pData + sizeof(data) / 2, &data[2], sizeof(data) / 2);
+    ID3D11DeviceContext_Unmap(deferred, (ID3D11Resource *)buffer, 0);
+    ID3D11DeviceContext_CopyResource(deferred, (ID3D11Resource *)dst, (ID3D11Resource *)buffer);
+
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, FALSE, &list2);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+    ID3D11DeviceContext_OMGetRenderTargets(deferred, 1, &rtv, NULL);
+    ok(!rtv, "Got unexpected render target view %p.\n", rtv);
+
+    ID3D11DeviceContext_ExecuteCommandList(immediate, list2, FALSE);
+    ID3D11DeviceContext_OMGetRenderTargets(immediate, 1, &rtv, NULL);
+    ok(!rtv, "Got unexpected render target view %p.\n", rtv);
+
+    get_buffer_readback(dst, &rb);
+    for (i = 0; i < ARRAY_SIZE(data); ++i)
+    {
+        DWORD value = get_readback_u32(&rb, i, 0, 0);
+        ok(value == data[i], "Got unexpected value 0x%08x at %u.\n", value, i);
+    }
+    release_resource_readback(&rb);
+
+    ID3D11CommandList_Release(list2);
+    ID3D11CommandList_Release(list1);
+    ID3D11Buffer_Release(dst);
+    ID3D11Buffer_Release(buffer);
+    refcount = ID3D11DeviceContext_Release(deferred);
+    ok(!refcount, "Got unexpected refcount %u.\n", refcount);
+    release_test_context(&test_context);
+}
+
+static void test_command_stream(void)
+{
+    static const struct vec4 red = {1.0f, 0.0f, 0.0f, 1.0f};
+    static const struct vec4 green = {0.0f, 1.0f, 0.0f, 1.0f};
+    static const D3D11_BOX box = {0, 0, 0, 256, 1, 1};
+    struct d3d11_test_context test_context;
+    D3D11_TEXTURE2D_DESC texture_desc;
+    ID3D11Texture2D *texture, *dst;
+    LARGE_INTEGER start, end, freq;
+    unsigned int update_count, i, j;
+    ID3D11DeviceContext *context;
+    struct resource_readback rb;
+    ID3D11Device *device;
+    DWORD color, *data;
+    HRESULT hr;
+
+    if (!init_test_context(&test_context, NULL))
+        return;
+
+    device = test_context.device;
+    context = test_context.immediate_context;
+
+    draw_color_quad(&test_context, &red);
+    check_texture_color(test_context.backbuffer, 0xff0000ff, 1);
+
+    /* Many small updates, which are mostly command stream overhead. Only
+     * time a large number of them in interactive mode. */
+    update_count = winetest_interactive ? 100000 : 100;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    for (i = 0; i < update_count; ++i)
+        set_quad_color(&test_context, i & 1 ? &green : &red);
+    draw_quad(&test_context);
+    check_texture_color(test_context.backbuffer, 0xff00ff00, 1);
+    QueryPerformanceCounter(&end);
+    if (winetest_interactive)
+        trace("%u constant buffer updates took %.2f ms.\n",
+                update_count, 1000.0 * (end.QuadPart - start.QuadPart) / freq.QuadPart);
+
+    /* Large updates, which together don't fit in the command stream queue.
+     * The source data is modified right after each update. */
+    texture_desc.Width = 256;
+    texture_desc.Height = 256;
+    texture_desc.MipLevels = 1;
+    texture_desc.ArraySize = 1;
+    texture_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    texture_desc.SampleDesc.Count = 1;
+    texture_desc.SampleDesc.Quality = 0;
+    texture_desc.Usage = D3D11_USAGE_DEFAULT;
+    texture_desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    texture_desc.CPUAccessFlags = 0;
+    texture_desc.MiscFlags = 0;
+    hr = ID3D11Device_CreateTexture2D(device, &texture_desc, NULL, &texture);
+    ok(hr == S_OK, "Failed to create texture, hr %#x.\n", hr);
+    texture_desc.Height = 64;
+    hr = ID3D11Device_CreateTexture2D(device, &texture_desc, NULL, &dst);
+    ok(hr == S_OK, "Failed to create texture, hr %#x.\n", hr);
+
+    data = heap_alloc(256 * 256 * sizeof(*data));
+    QueryPerformanceCounter(&start);
+    for (i = 0; i < 64; ++i)
+    {
+        for (j = 0; j < 256 * 256; ++j)
+            data[j] = 0xff000000 | (i << 16) | (i << 8) | i;
+        ID3D11DeviceContext_UpdateSubresource(context, (ID3D11Resource *)texture, 0, NULL, data, 256 * 4, 0);
+        ID3D11DeviceContext_CopySubresourceRegion(context, (ID3D11Resource *)dst, 0, 0, i, 0,
+                (ID3D11Resource *)texture, 0, &box);
+    }
+    memset(data, 0, 256 * 256 * sizeof(*data));
+
+    get_texture_readback(dst, 0, &rb);
+    QueryPerformanceCounter(&end);
+    for (i = 0; i < 64; ++i)
+    {
+        color = get_readback_color(&rb, 255, i, 0);
+        ok(color == (0xff000000 | (i << 16) | (i << 8) | i), "Got unexpected color 0x%08x at row %u.\n", color, i);
+    }
+    release_resource_readback(&rb);
+    if (winetest_debug > 1)
+        trace("64 texture updates took %.2f ms.\n", 1000.0 * (end.QuadPart - start.QuadPart) / freq.QuadPart);
+
+    heap_free(data);
+    ID3D11Texture2D_Release(dst);
+    ID3D11Texture2D_Release(texture);
+    release_test_context(&test_context);
+}
+
 static void test_create_texture1d(void)
 {
     ULONG refcount, expected_refcount;
@@ -30271,6 +30453,8 @@ START_TEST(d3d11)
     queue_test(test_color_mask);
     queue_test(test_independent_blend);
     queue_test(test_dual_source_blend);
+    queue_test(test_deferred_context);
+    queue_test(test_command_stream);
 
     run_queued_tests();
 }
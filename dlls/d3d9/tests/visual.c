@@ -19110,6 +19110,270 @@ done:
     DestroyWindow(window);
 }
 
+static void volume_dxtn_texels_test(void)
+{
+    IDirect3DVolumeTexture9 *texture;
+    struct surface_readback rb;
+    IDirect3DDevice9 *device;
+    unsigned int i, x, y;
+    IDirect3DSurface9 *rt;
+    D3DLOCKED_BOX box;
+    DWORD colour, expected;
+    IDirect3D9 *d3d;
+    ULONG refcount;
+    HWND window;
+    HRESULT hr;
+
+    /* Single 4x4 blocks, with the colour indices of texel (x, y) set to
+     * (x + y) & 3, and the BC3 alpha index of texel i set to i & 7. */
+    static const BYTE dxt1_data[] =
+    {
+        0x00, 0xf8, 0x1f, 0x00, 0xe4, 0x39, 0x4e, 0x93,
+    };
+    static const BYTE dxt1_alpha_data[] =
+    {
+        0x1f, 0x00, 0x00, 0xf8, 0xe4, 0x39, 0x4e, 0x93,
+    };
+    static const BYTE dxt5_data[] =
+    {
+        0xff, 0x00, 0x88, 0xc6, 0xfa, 0x88, 0xc6, 0xfa, 0x00, 0xf8, 0x1f, 0x00, 0xe4, 0x39, 0x4e, 0x93,
+    };
+    static const DWORD dxt1_expected_colours[] =
+    {
+        0xffff0000, 0xff0000ff, 0xffaa0055, 0xff5500aa,
+        0xff0000ff, 0xffaa0055, 0xff5500aa, 0xffff0000,
+        0xffaa0055, 0xff5500aa, 0xffff0000, 0xff0000ff,
+        0xff5500aa, 0xffff0000, 0xff0000ff, 0xffaa0055,
+    };
+    static const DWORD dxt1_alpha_expected_colours[] =
+    {
+        0xff0000ff, 0xffff0000, 0xff7f007f, 0x00000000,
+        0xffff0000, 0xff7f007f, 0x00000000, 0xff0000ff,
+        0xff7f007f, 0x00000000, 0xff0000ff, 0xffff0000,
+        0x00000000, 0xff0000ff, 0xffff0000, 0xff7f007f,
+    };
+    static const DWORD dxt5_expected_colours[] =
+    {
+        0xffff0000, 0x000000ff, 0xdaaa0055, 0xb65500aa,
+        0x910000ff, 0x6daa0055, 0x485500aa, 0x24ff0000,
+        0xffaa0055, 0x005500aa, 0xdaff0000, 0xb60000ff,
+        0x915500aa, 0x6dff0000, 0x480000ff, 0x24aa0055,
+    };
+
+    static const struct
+    {
+        const char *name;
+        D3DFORMAT format;
+        const BYTE *data;
+        DWORD data_size;
+        const DWORD *expected_colours;
+    }
+    tests[] =
+    {
+        {"DXT1",       D3DFMT_DXT1, dxt1_data,       sizeof(dxt1_data),       dxt1_expected_colours},
+        {"DXT1 alpha", D3DFMT_DXT1, dxt1_alpha_data, sizeof(dxt1_alpha_data), dxt1_alpha_expected_colours},
+        {"DXT5",       D3DFMT_DXT5, dxt5_data,       sizeof(dxt5_data),       dxt5_expected_colours},
+    };
+
+    static const struct
+    {
+        struct vec3 position;
+        struct vec3 texcrd;
+    }
+    quad[] =
+    {
+        {{-1.0f, -1.0f, 0.0f}, {0.0f, 1.0f, 0.5f}},
+        {{-1.0f,  1.0f, 0.0f}, {0.0f, 0.0f, 0.5f}},
+        {{ 1.0f, -1.0f, 0.0f}, {1.0f, 1.0f, 0.5f}},
+        {{ 1.0f,  1.0f, 0.0f}, {1.0f, 0.0f, 0.5f}},
+    };
+
+    window = create_window();
+    d3d = Direct3DCreate9(D3D_SDK_VERSION);
+    ok(!!d3d, "Failed to create a D3D object.\n");
+
+    if (!(device = create_device(d3d, window, window, TRUE)))
+    {
+        skip("Failed to create a D3D device, skipping tests.\n");
+        goto done;
+    }
+
+    hr = IDirect3DDevice9_GetRenderTarget(device, 0, &rt);
+    ok(SUCCEEDED(hr), "Failed to get render target, hr %#x.\n", hr);
+
+    hr = IDirect3DDevice9_SetFVF(device, D3DFVF_XYZ | D3DFVF_TEX1 | D3DFVF_TEXCOORDSIZE3(0));
+    ok(SUCCEEDED(hr), "Failed to set FVF, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_SetTextureStageState(device, 0, D3DTSS_COLOROP, D3DTOP_SELECTARG1);
+    ok(SUCCEEDED(hr), "Failed to set colour op, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_SetTextureStageState(device, 0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+    ok(SUCCEEDED(hr), "Failed to set colour arg, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_SetTextureStageState(device, 1, D3DTSS_COLOROP, D3DTOP_DISABLE);
+    ok(SUCCEEDED(hr), "Failed to set colour op, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_SetSamplerState(device, 0, D3DSAMP_MAGFILTER, D3DTEXF_POINT);
+    ok(SUCCEEDED(hr), "Failed to set mag filter, hr %#x.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(tests); ++i)
+    {
+        if (FAILED(IDirect3D9_CheckDeviceFormat(d3d, D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL,
+                D3DFMT_X8R8G8B8, 0, D3DRTYPE_VOLUMETEXTURE, tests[i].format)))
+        {
+            skip("%s volume textures are not supported, skipping test.\n", tests[i].name);
+            continue;
+        }
+        hr = IDirect3DDevice9_CreateVolumeTexture(device, 4, 4, 1, 1, 0,
+                tests[i].format, D3DPOOL_MANAGED, &texture, NULL);
+        ok(SUCCEEDED(hr), "Failed to create volume texture, hr %#x.\n", hr);
+
+        hr = IDirect3DVolumeTexture9_LockBox(texture, 0, &box, NULL, 0);
+        ok(SUCCEEDED(hr), "Failed to lock volume texture, hr %#x.\n", hr);
+        memcpy(box.pBits, tests[i].data, tests[i].data_size);
+        hr = IDirect3DVolumeTexture9_UnlockBox(texture, 0);
+        ok(SUCCEEDED(hr), "Failed to unlock volume texture, hr %#x.\n", hr);
+
+        hr = IDirect3DDevice9_SetTexture(device, 0, (IDirect3DBaseTexture9 *)texture);
+        ok(SUCCEEDED(hr), "Failed to set texture, hr %#x.\n", hr);
+
+        hr = IDirect3DDevice9_Clear(device, 0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, 0x00ff00ff, 1.0f, 0);
+        ok(SUCCEEDED(hr), "Failed to clear, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_BeginScene(device);
+        ok(SUCCEEDED(hr), "Failed to begin scene, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_DrawPrimitiveUP(device, D3DPT_TRIANGLESTRIP, 2, quad, sizeof(*quad));
+        ok(SUCCEEDED(hr), "Failed to draw, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_EndScene(device);
+        ok(SUCCEEDED(hr), "Failed to end scene, hr %#x.\n", hr);
+
+        get_rt_readback(rt, &rb);
+        for (y = 0; y < 4; ++y)
+        {
+            for (x = 0; x < 4; ++x)
+            {
+                expected = tests[i].expected_colours[y * 4 + x];
+                colour = get_readback_color(&rb, 80 + 160 * x, 60 + 120 * y);
+                ok(color_match(colour, expected, 4),
+                        "Expected colour 0x%08x, got 0x%08x, format %s, texel %u,%u.\n",
+                        expected, colour, tests[i].name, x, y);
+            }
+        }
+        release_surface_readback(&rb);
+
+        hr = IDirect3DDevice9_SetTexture(device, 0, NULL);
+        ok(SUCCEEDED(hr), "Failed to set texture, hr %#x.\n", hr);
+        IDirect3DVolumeTexture9_Release(texture);
+    }
+
+    IDirect3DSurface9_Release(rt);
+    refcount = IDirect3DDevice9_Release(device);
+    ok(!refcount, "Device has %u references left.\n", refcount);
+done:
+    IDirect3D9_Release(d3d);
+    DestroyWindow(window);
+}
+
+static void volume_dxtn_upload_benchmark(void)
+{
+    IDirect3DVolumeTexture9 *texture;
+    LARGE_INTEGER frequency, start, end;
+    IDirect3DDevice9 *device;
+    unsigned int i, j, k, size;
+    D3DLOCKED_BOX box;
+    IDirect3D9 *d3d;
+    ULONG refcount;
+    BYTE *data;
+    HWND window;
+    HRESULT hr;
+
+    static const struct
+    {
+        const char *name;
+        D3DFORMAT format;
+        unsigned int block_size;
+    }
+    formats[] =
+    {
+        {"DXT1", D3DFMT_DXT1, 8},
+        {"DXT3", D3DFMT_DXT3, 16},
+        {"DXT5", D3DFMT_DXT5, 16},
+    };
+    /* The small size is converted on the calling thread, the large one is
+     * split across threads. */
+    static const struct
+    {
+        unsigned int width, height, depth;
+    }
+    sizes[] =
+    {
+        {256, 256, 1},
+        {1024, 1024, 2},
+    };
+
+    if (!winetest_interactive)
+    {
+        skip("Skipping DXTn upload benchmark, set WINETEST_INTERACTIVE to run it.\n");
+        return;
+    }
+
+    window = create_window();
+    d3d = Direct3DCreate9(D3D_SDK_VERSION);
+    ok(!!d3d, "Failed to create a D3D object.\n");
+
+    if (!(device = create_device(d3d, window, window, TRUE)))
+    {
+        skip("Failed to create a D3D device, skipping tests.\n");
+        goto done;
+    }
+
+    QueryPerformanceFrequency(&frequency);
+    for (i = 0; i < ARRAY_SIZE(formats); ++i)
+    {
+        if (FAILED(IDirect3D9_CheckDeviceFormat(d3d, D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL,
+                D3DFMT_X8R8G8B8, 0, D3DRTYPE_VOLUMETEXTURE, formats[i].format)))
+        {
+            skip("%s volume textures are not supported, skipping benchmark.\n", formats[i].name);
+            continue;
+        }
+
+        for (j = 0; j < ARRAY_SIZE(sizes); ++j)
+        {
+            hr = IDirect3DDevice9_CreateVolumeTexture(device, sizes[j].width, sizes[j].height,
+                    sizes[j].depth, 1, 0, formats[i].format, D3DPOOL_MANAGED, &texture, NULL);
+            ok(SUCCEEDED(hr), "Failed to create volume texture, hr %#x.\n", hr);
+
+            /* Arbitrary blocks, so that every colour and alpha index is used. */
+            size = sizes[j].width / 4 * sizes[j].height / 4 * sizes[j].depth * formats[i].block_size;
+            data = heap_alloc(size);
+            for (k = 0; k < size; ++k)
+                data[k] = k * 0x9e3779b1u >> 24;
+
+            QueryPerformanceCounter(&start);
+            for (k = 0; k < 8; ++k)
+            {
+                hr = IDirect3DVolumeTexture9_LockBox(texture, 0, &box, NULL, 0);
+                ok(SUCCEEDED(hr), "Failed to lock volume texture, hr %#x.\n", hr);
+                memcpy(box.pBits, data, size);
+                hr = IDirect3DVolumeTexture9_UnlockBox(texture, 0);
+                ok(SUCCEEDED(hr), "Failed to unlock volume texture, hr %#x.\n", hr);
+                IDirect3DVolumeTexture9_PreLoad(texture);
+            }
+            /* Reading back the render target waits for the uploads to finish. */
+            getPixelColor(device, 0, 0);
+            QueryPerformanceCounter(&end);
+            heap_free(data);
+
+            trace("%s %ux%ux%u: %.1f Mpixels/s.\n", formats[i].name, sizes[j].width, sizes[j].height,
+                    sizes[j].depth, 8.0 * sizes[j].width * sizes[j].height * sizes[j].depth
+                    * frequency.QuadPart / (end.QuadPart - start.QuadPart) / 1e6);
+
+            IDirect3DVolumeTexture9_Release(texture);
+        }
+    }
+
+    refcount = IDirect3DDevice9_Release(device);
+    ok(!refcount, "Device has %u references left.\n", refcount);
+done:
+    IDirect3D9_Release(d3d);
+    DestroyWindow(window);
+}
+
 static void volume_v16u16_test(void)
 {
     IDirect3DVolumeTexture9 *texture;
@@ -26829,6 +27093,97 @@ static void test_sample_mask(void)
     DestroyWindow(window);
 }
 
+static void test_shader_program_reuse(void)
+{
+    IDirect3DVertexShader9 *vs;
+    IDirect3DPixelShader9 *ps;
+    IDirect3DDevice9 *device;
+    IDirect3D9 *d3d;
+    unsigned int i;
+    ULONG refcount;
+    D3DCAPS9 caps;
+    DWORD colour;
+    HWND window;
+    HRESULT hr;
+
+    static const DWORD vs_code[] =
+    {
+        0xfffe0101,                                                             /* vs_1_1                      */
+        0x0000001f, 0x80000000, 0x900f0000,                                     /* dcl_position v0             */
+        0x00000001, 0xc00f0000, 0x90e40000,                                     /* mov oPos, v0                */
+        0x0000ffff                                                              /* end                         */
+    };
+    static const DWORD ps_code[] =
+    {
+        0xffff0200,                                                             /* ps_2_0                      */
+        0x05000051, 0xa00f0000, 0x3e800000, 0x3f000000, 0x3f400000, 0x3f800000, /* def c0, 0.25, 0.5, 0.75, 1.0 */
+        0x02000001, 0x800f0800, 0xa0e40000,                                     /* mov oC0, c0                 */
+        0x0000ffff                                                              /* end                         */
+    };
+    static const struct vec3 quad[] =
+    {
+        {-1.0f, -1.0f, 0.1f},
+        {-1.0f,  1.0f, 0.1f},
+        { 1.0f, -1.0f, 0.1f},
+        { 1.0f,  1.0f, 0.1f},
+    };
+
+    window = create_window();
+    d3d = Direct3DCreate9(D3D_SDK_VERSION);
+    ok(!!d3d, "Failed to create a D3D object.\n");
+
+    /* The second device links the same program again. With a program binary
+     * cache, that loads the binary stored by the first device. */
+    for (i = 0; i < 2; ++i)
+    {
+        if (!(device = create_device(d3d, window, window, TRUE)))
+        {
+            skip("Failed to create a D3D device, skipping tests.\n");
+            break;
+        }
+
+        hr = IDirect3DDevice9_GetDeviceCaps(device, &caps);
+        ok(SUCCEEDED(hr), "Failed to get device caps, hr %#x.\n", hr);
+        if (caps.PixelShaderVersion < D3DPS_VERSION(2, 0))
+        {
+            skip("No ps_2_0 support, skipping tests.\n");
+            IDirect3DDevice9_Release(device);
+            break;
+        }
+
+        hr = IDirect3DDevice9_CreateVertexShader(device, vs_code, &vs);
+        ok(SUCCEEDED(hr), "Failed to create vertex shader, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_CreatePixelShader(device, ps_code, &ps);
+        ok(SUCCEEDED(hr), "Failed to create pixel shader, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_SetVertexShader(device, vs);
+        ok(SUCCEEDED(hr), "Failed to set vertex shader, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_SetPixelShader(device, ps);
+        ok(SUCCEEDED(hr), "Failed to set pixel shader, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_SetFVF(device, D3DFVF_XYZ);
+        ok(SUCCEEDED(hr), "Failed to set FVF, hr %#x.\n", hr);
+
+        hr = IDirect3DDevice9_Clear(device, 0, NULL, D3DCLEAR_TARGET, 0xffff0000, 1.0f, 0);
+        ok(SUCCEEDED(hr), "Failed to clear, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_BeginScene(device);
+        ok(SUCCEEDED(hr), "Failed to begin scene, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_DrawPrimitiveUP(device, D3DPT_TRIANGLESTRIP, 2, quad, sizeof(*quad));
+        ok(SUCCEEDED(hr), "Failed to draw, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_EndScene(device);
+        ok(SUCCEEDED(hr), "Failed to end scene, hr %#x.\n", hr);
+
+        colour = getPixelColor(device, 320, 240);
+        ok(color_match(colour, 0x004080bf, 1), "Got unexpected colour 0x%08x, device %u.\n", colour, i);
+
+        IDirect3DPixelShader9_Release(ps);
+        IDirect3DVertexShader9_Release(vs);
+        refcount = IDirect3DDevice9_Release(device);
+        ok(!refcount, "Device has %u references left.\n", refcount);
+    }
+
+    IDirect3D9_Release(d3d);
+    DestroyWindow(window);
+}
+
 START_TEST(visual)
 {
     D3DADAPTER_IDENTIFIER9 identifier;
@@ -26936,6 +27291,8 @@ START_TEST(visual)
     fog_special_test();
     volume_srgb_test();
     volume_dxtn_test();
+    volume_dxtn_texels_test();
+    volume_dxtn_upload_benchmark();
     add_dirty_rect_test();
     multisampled_depth_buffer_test();
     resz_test();
@@ -26977,4 +27334,5 @@ START_TEST(visual)
     test_sample_attached_rendertarget();
     test_alpha_to_coverage();
     test_sample_mask();
+    test_shader_program_reuse();
 }
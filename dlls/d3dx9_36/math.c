@@ -1271,30 +1271,39 @@ D3DXPLANE * WINAPI D3DXPlaneNormalize(D3DXPLANE *out, const D3DXPLANE *p)
     return out;
 }
 
-D3DXPLANE* WINAPI D3DXPlaneTransform(D3DXPLANE *pout, const D3DXPLANE *pplane, const D3DXMATRIX *pm)
+/* The *_transform() helpers below are shared between the single element
+ * functions and the *Array() variants. The array functions pass a local copy
+ * of the matrix, so that the compiler can keep it in registers instead of
+ * reloading it for every element in case the output aliases it. */
+static inline void plane_transform(D3DXPLANE *out, const D3DXPLANE *in, const D3DXMATRIX *m)
 {
-    const D3DXPLANE plane = *pplane;
+    const D3DXPLANE plane = *in;
+
+    out->a = m->u.m[0][0] * plane.a + m->u.m[1][0] * plane.b + m->u.m[2][0] * plane.c + m->u.m[3][0] * plane.d;
+    out->b = m->u.m[0][1] * plane.a + m->u.m[1][1] * plane.b + m->u.m[2][1] * plane.c + m->u.m[3][1] * plane.d;
+    out->c = m->u.m[0][2] * plane.a + m->u.m[1][2] * plane.b + m->u.m[2][2] * plane.c + m->u.m[3][2] * plane.d;
+    out->d = m->u.m[0][3] * plane.a + m->u.m[1][3] * plane.b + m->u.m[2][3] * plane.c + m->u.m[3][3] * plane.d;
+}
 
+D3DXPLANE* WINAPI D3DXPlaneTransform(D3DXPLANE *pout, const D3DXPLANE *pplane, const D3DXMATRIX *pm)
+{
     TRACE("pout %p, pplane %p, pm %p\n", pout, pplane, pm);
 
-    pout->a = pm->u.m[0][0] * plane.a + pm->u.m[1][0] * plane.b + pm->u.m[2][0] * plane.c + pm->u.m[3][0] * plane.d;
-    pout->b = pm->u.m[0][1] * plane.a + pm->u.m[1][1] * plane.b + pm->u.m[2][1] * plane.c + pm->u.m[3][1] * plane.d;
-    pout->c = pm->u.m[0][2] * plane.a + pm->u.m[1][2] * plane.b + pm->u.m[2][2] * plane.c + pm->u.m[3][2] * plane.d;
-    pout->d = pm->u.m[0][3] * plane.a + pm->u.m[1][3] * plane.b + pm->u.m[2][3] * plane.c + pm->u.m[3][3] * plane.d;
+    plane_transform(pout, pplane, pm);
     return pout;
 }
 
 D3DXPLANE* WINAPI D3DXPlaneTransformArray(D3DXPLANE* out, UINT outstride, const D3DXPLANE* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXPlaneTransform(
-            (D3DXPLANE*)((char*)out + outstride * i),
-            (const D3DXPLANE*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        plane_transform((D3DXPLANE *)((char *)out + outstride * i),
+                (const D3DXPLANE *)((const char *)in + instride * i), &m);
     }
     return out;
 }
@@ -1673,88 +1682,100 @@ D3DXVECTOR2* WINAPI D3DXVec2Normalize(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv)
     return pout;
 }
 
-D3DXVECTOR4* WINAPI D3DXVec2Transform(D3DXVECTOR4 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+static inline void vec2_transform(D3DXVECTOR4 *out, const D3DXVECTOR2 *in, const D3DXMATRIX *m)
 {
-    D3DXVECTOR4 out;
+    const D3DXVECTOR2 v = *in;
+
+    out->x = m->u.m[0][0] * v.x + m->u.m[1][0] * v.y + m->u.m[3][0];
+    out->y = m->u.m[0][1] * v.x + m->u.m[1][1] * v.y + m->u.m[3][1];
+    out->z = m->u.m[0][2] * v.x + m->u.m[1][2] * v.y + m->u.m[3][2];
+    out->w = m->u.m[0][3] * v.x + m->u.m[1][3] * v.y + m->u.m[3][3];
+}
 
+D3DXVECTOR4* WINAPI D3DXVec2Transform(D3DXVECTOR4 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+{
     TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
-    out.x = pm->u.m[0][0] * pv->x + pm->u.m[1][0] * pv->y  + pm->u.m[3][0];
-    out.y = pm->u.m[0][1] * pv->x + pm->u.m[1][1] * pv->y  + pm->u.m[3][1];
-    out.z = pm->u.m[0][2] * pv->x + pm->u.m[1][2] * pv->y  + pm->u.m[3][2];
-    out.w = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y  + pm->u.m[3][3];
-    *pout = out;
+    vec2_transform(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR4* WINAPI D3DXVec2TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR2* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec2Transform(
-            (D3DXVECTOR4*)((char*)out + outstride * i),
-            (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        vec2_transform((D3DXVECTOR4 *)((char *)out + outstride * i),
+                (const D3DXVECTOR2 *)((const char *)in + instride * i), &m);
     }
     return out;
 }
 
-D3DXVECTOR2* WINAPI D3DXVec2TransformCoord(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+static inline void vec2_transform_coord(D3DXVECTOR2 *out, const D3DXVECTOR2 *in, const D3DXMATRIX *m)
 {
-    D3DXVECTOR2 v;
+    const D3DXVECTOR2 v = *in;
     FLOAT norm;
 
-    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
+    norm = m->u.m[0][3] * v.x + m->u.m[1][3] * v.y + m->u.m[3][3];
 
-    v = *pv;
-    norm = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y + pm->u.m[3][3];
+    out->x = (m->u.m[0][0] * v.x + m->u.m[1][0] * v.y + m->u.m[3][0]) / norm;
+    out->y = (m->u.m[0][1] * v.x + m->u.m[1][1] * v.y + m->u.m[3][1]) / norm;
+}
 
-    pout->x = (pm->u.m[0][0] * v.x + pm->u.m[1][0] * v.y + pm->u.m[3][0]) / norm;
-    pout->y = (pm->u.m[0][1] * v.x + pm->u.m[1][1] * v.y + pm->u.m[3][1]) / norm;
+D3DXVECTOR2* WINAPI D3DXVec2TransformCoord(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+{
+    TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
+    vec2_transform_coord(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR2* WINAPI D3DXVec2TransformCoordArray(D3DXVECTOR2* out, UINT outstride, const D3DXVECTOR2* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec2TransformCoord(
-            (D3DXVECTOR2*)((char*)out + outstride * i),
-            (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        vec2_transform_coord((D3DXVECTOR2 *)((char *)out + outstride * i),
+                (const D3DXVECTOR2 *)((const char *)in + instride * i), &m);
     }
     return out;
 }
 
-D3DXVECTOR2* WINAPI D3DXVec2TransformNormal(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+static inline void vec2_transform_normal(D3DXVECTOR2 *out, const D3DXVECTOR2 *in, const D3DXMATRIX *m)
 {
-    const D3DXVECTOR2 v = *pv;
+    const D3DXVECTOR2 v = *in;
 
+    out->x = m->u.m[0][0] * v.x + m->u.m[1][0] * v.y;
+    out->y = m->u.m[0][1] * v.x + m->u.m[1][1] * v.y;
+}
+
+D3DXVECTOR2* WINAPI D3DXVec2TransformNormal(D3DXVECTOR2 *pout, const D3DXVECTOR2 *pv, const D3DXMATRIX *pm)
+{
     TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
-    pout->x = pm->u.m[0][0] * v.x + pm->u.m[1][0] * v.y;
-    pout->y = pm->u.m[0][1] * v.x + pm->u.m[1][1] * v.y;
+    vec2_transform_normal(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR2* WINAPI D3DXVec2TransformNormalArray(D3DXVECTOR2* out, UINT outstride, const D3DXVECTOR2 *in, UINT instride, const D3DXMATRIX *matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec2TransformNormal(
-            (D3DXVECTOR2*)((char*)out + outstride * i),
-            (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        vec2_transform_normal((D3DXVECTOR2 *)((char *)out + outstride * i),
+                (const D3DXVECTOR2 *)((const char *)in + instride * i), &m);
     }
     return out;
 }
@@ -1821,134 +1842,178 @@ D3DXVECTOR3* WINAPI D3DXVec3Normalize(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv)
     return pout;
 }
 
-D3DXVECTOR3* WINAPI D3DXVec3Project(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DVIEWPORT9 *pviewport, const D3DXMATRIX *pprojection, const D3DXMATRIX *pview, const D3DXMATRIX *pworld)
+static inline void vec3_transform_coord(D3DXVECTOR3 *out, const D3DXVECTOR3 *in, const D3DXMATRIX *m)
 {
-    D3DXMATRIX m;
+    const D3DXVECTOR3 v = *in;
+    FLOAT norm;
 
-    TRACE("pout %p, pv %p, pviewport %p, pprojection %p, pview %p, pworld %p\n", pout, pv, pviewport, pprojection, pview, pworld);
+    norm = m->u.m[0][3] * v.x + m->u.m[1][3] * v.y + m->u.m[2][3] * v.z + m->u.m[3][3];
 
-    D3DXMatrixIdentity(&m);
-    if (pworld) D3DXMatrixMultiply(&m, &m, pworld);
-    if (pview) D3DXMatrixMultiply(&m, &m, pview);
-    if (pprojection) D3DXMatrixMultiply(&m, &m, pprojection);
+    out->x = (m->u.m[0][0] * v.x + m->u.m[1][0] * v.y + m->u.m[2][0] * v.z + m->u.m[3][0]) / norm;
+    out->y = (m->u.m[0][1] * v.x + m->u.m[1][1] * v.y + m->u.m[2][1] * v.z + m->u.m[3][1]) / norm;
+    out->z = (m->u.m[0][2] * v.x + m->u.m[1][2] * v.y + m->u.m[2][2] * v.z + m->u.m[3][2]) / norm;
+}
 
-    D3DXVec3TransformCoord(pout, pv, &m);
+static void get_world_view_projection(D3DXMATRIX *m, const D3DXMATRIX *projection,
+        const D3DXMATRIX *view, const D3DXMATRIX *world)
+{
+    D3DXMatrixIdentity(m);
+    if (world)
+        D3DXMatrixMultiply(m, m, world);
+    if (view)
+        D3DXMatrixMultiply(m, m, view);
+    if (projection)
+        D3DXMatrixMultiply(m, m, projection);
+}
 
-    if (pviewport)
+static inline void vec3_project(D3DXVECTOR3 *out, const D3DXVECTOR3 *in,
+        const D3DVIEWPORT9 *viewport, const D3DXMATRIX *m)
+{
+    vec3_transform_coord(out, in, m);
+
+    if (viewport)
     {
-        pout->x = pviewport->X +  ( 1.0f + pout->x ) * pviewport->Width / 2.0f;
-        pout->y = pviewport->Y +  ( 1.0f - pout->y ) * pviewport->Height / 2.0f;
-        pout->z = pviewport->MinZ + pout->z * ( pviewport->MaxZ - pviewport->MinZ );
+        out->x = viewport->X +  ( 1.0f + out->x ) * viewport->Width / 2.0f;
+        out->y = viewport->Y +  ( 1.0f - out->y ) * viewport->Height / 2.0f;
+        out->z = viewport->MinZ + out->z * ( viewport->MaxZ - viewport->MinZ );
     }
+}
+
+D3DXVECTOR3* WINAPI D3DXVec3Project(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DVIEWPORT9 *pviewport, const D3DXMATRIX *pprojection, const D3DXMATRIX *pview, const D3DXMATRIX *pworld)
+{
+    D3DXMATRIX m;
+
+    TRACE("pout %p, pv %p, pviewport %p, pprojection %p, pview %p, pworld %p\n", pout, pv, pviewport, pprojection, pview, pworld);
+
+    get_world_view_projection(&m, pprojection, pview, pworld);
+    vec3_project(pout, pv, pviewport, &m);
     return pout;
 }
 
 D3DXVECTOR3* WINAPI D3DXVec3ProjectArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DVIEWPORT9* viewport, const D3DXMATRIX* projection, const D3DXMATRIX* view, const D3DXMATRIX* world, UINT elements)
 {
+    D3DVIEWPORT9 vp;
+    D3DXMATRIX m;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, viewport %p, projection %p, view %p, world %p, elements %u\n",
         out, outstride, in, instride, viewport, projection, view, world, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec3Project(
-            (D3DXVECTOR3*)((char*)out + outstride * i),
-            (const D3DXVECTOR3*)((const char*)in + instride * i),
-            viewport, projection, view, world);
+    /* The combined matrix is the same for every element; only compute it once. */
+    get_world_view_projection(&m, projection, view, world);
+    if (viewport)
+        vp = *viewport;
+
+    for (i = 0; i < elements; ++i)
+    {
+        vec3_project((D3DXVECTOR3 *)((char *)out + outstride * i),
+                (const D3DXVECTOR3 *)((const char *)in + instride * i), viewport ? &vp : NULL, &m);
     }
     return out;
 }
 
-D3DXVECTOR4* WINAPI D3DXVec3Transform(D3DXVECTOR4 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
+static inline void vec3_transform(D3DXVECTOR4 *out, const D3DXVECTOR3 *in, const D3DXMATRIX *m)
 {
-    D3DXVECTOR4 out;
+    const D3DXVECTOR3 v = *in;
 
+    out->x = m->u.m[0][0] * v.x + m->u.m[1][0] * v.y + m->u.m[2][0] * v.z + m->u.m[3][0];
+    out->y = m->u.m[0][1] * v.x + m->u.m[1][1] * v.y + m->u.m[2][1] * v.z + m->u.m[3][1];
+    out->z = m->u.m[0][2] * v.x + m->u.m[1][2] * v.y + m->u.m[2][2] * v.z + m->u.m[3][2];
+    out->w = m->u.m[0][3] * v.x + m->u.m[1][3] * v.y + m->u.m[2][3] * v.z + m->u.m[3][3];
+}
+
+D3DXVECTOR4* WINAPI D3DXVec3Transform(D3DXVECTOR4 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
+{
     TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
-    out.x = pm->u.m[0][0] * pv->x + pm->u.m[1][0] * pv->y + pm->u.m[2][0] * pv->z + pm->u.m[3][0];
-    out.y = pm->u.m[0][1] * pv->x + pm->u.m[1][1] * pv->y + pm->u.m[2][1] * pv->z + pm->u.m[3][1];
-    out.z = pm->u.m[0][2] * pv->x + pm->u.m[1][2] * pv->y + pm->u.m[2][2] * pv->z + pm->u.m[3][2];
-    out.w = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y + pm->u.m[2][3] * pv->z + pm->u.m[3][3];
-    *pout = out;
+    vec3_transform(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR4* WINAPI D3DXVec3TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec3Transform(
-            (D3DXVECTOR4*)((char*)out + outstride * i),
-            (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        vec3_transform((D3DXVECTOR4 *)((char *)out + outstride * i),
+                (const D3DXVECTOR3 *)((const char *)in + instride * i), &m);
     }
     return out;
 }
 
 D3DXVECTOR3* WINAPI D3DXVec3TransformCoord(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
 {
-    D3DXVECTOR3 out;
-    FLOAT norm;
-
     TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
-    norm = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y + pm->u.m[2][3] *pv->z + pm->u.m[3][3];
-
-    out.x = (pm->u.m[0][0] * pv->x + pm->u.m[1][0] * pv->y + pm->u.m[2][0] * pv->z + pm->u.m[3][0]) / norm;
-    out.y = (pm->u.m[0][1] * pv->x + pm->u.m[1][1] * pv->y + pm->u.m[2][1] * pv->z + pm->u.m[3][1]) / norm;
-    out.z = (pm->u.m[0][2] * pv->x + pm->u.m[1][2] * pv->y + pm->u.m[2][2] * pv->z + pm->u.m[3][2]) / norm;
-
-    *pout = out;
-
+    vec3_transform_coord(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR3* WINAPI D3DXVec3TransformCoordArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec3TransformCoord(
-            (D3DXVECTOR3*)((char*)out + outstride * i),
-            (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        vec3_transform_coord((D3DXVECTOR3 *)((char *)out + outstride * i),
+                (const D3DXVECTOR3 *)((const char *)in + instride * i), &m);
     }
     return out;
 }
 
-D3DXVECTOR3* WINAPI D3DXVec3TransformNormal(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
+static inline void vec3_transform_normal(D3DXVECTOR3 *out, const D3DXVECTOR3 *in, const D3DXMATRIX *m)
 {
-    const D3DXVECTOR3 v = *pv;
+    const D3DXVECTOR3 v = *in;
+
+    out->x = m->u.m[0][0] * v.x + m->u.m[1][0] * v.y + m->u.m[2][0] * v.z;
+    out->y = m->u.m[0][1] * v.x + m->u.m[1][1] * v.y + m->u.m[2][1] * v.z;
+    out->z = m->u.m[0][2] * v.x + m->u.m[1][2] * v.y + m->u.m[2][2] * v.z;
+}
 
+D3DXVECTOR3* WINAPI D3DXVec3TransformNormal(D3DXVECTOR3 *pout, const D3DXVECTOR3 *pv, const D3DXMATRIX *pm)
+{
     TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
-    pout->x = pm->u.m[0][0] * v.x + pm->u.m[1][0] * v.y + pm->u.m[2][0] * v.z;
-    pout->y = pm->u.m[0][1] * v.x + pm->u.m[1][1] * v.y + pm->u.m[2][1] * v.z;
-    pout->z = pm->u.m[0][2] * v.x + pm->u.m[1][2] * v.y + pm->u.m[2][2] * v.z;
+    vec3_transform_normal(pout, pv, pm);
     return pout;
-
 }
 
 D3DXVECTOR3* WINAPI D3DXVec3TransformNormalArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec3TransformNormal(
-            (D3DXVECTOR3*)((char*)out + outstride * i),
-            (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        vec3_transform_normal((D3DXVECTOR3 *)((char *)out + outstride * i),
+                (const D3DXVECTOR3 *)((const char *)in + instride * i), &m);
     }
     return out;
 }
 
+static inline void vec3_unproject(D3DXVECTOR3 *out, const D3DXVECTOR3 *in,
+        const D3DVIEWPORT9 *viewport, const D3DXMATRIX *m)
+{
+    D3DXVECTOR3 v = *in;
+
+    if (viewport)
+    {
+        v.x = 2.0f * (v.x - viewport->X) / viewport->Width - 1.0f;
+        v.y = 1.0f - 2.0f * (v.y - viewport->Y) / viewport->Height;
+        v.z = (v.z - viewport->MinZ) / (viewport->MaxZ - viewport->MinZ);
+    }
+    vec3_transform_coord(out, &v, m);
+}
+
 D3DXVECTOR3 * WINAPI D3DXVec3Unproject(D3DXVECTOR3 *out, const D3DXVECTOR3 *v,
         const D3DVIEWPORT9 *viewport, const D3DXMATRIX *projection, const D3DXMATRIX *view,
         const D3DXMATRIX *world)
@@ -1958,38 +2023,33 @@ D3DXVECTOR3 * WINAPI D3DXVec3Unproject(D3DXVECTOR3 *out, const D3DXVECTOR3 *v,
     TRACE("out %p, v %p, viewport %p, projection %p, view %p, world %p.\n",
             out, v, viewport, projection, view, world);
 
-    D3DXMatrixIdentity(&m);
-    if (world)
-        D3DXMatrixMultiply(&m, &m, world);
-    if (view)
-        D3DXMatrixMultiply(&m, &m, view);
-    if (projection)
-        D3DXMatrixMultiply(&m, &m, projection);
+    get_world_view_projection(&m, projection, view, world);
     D3DXMatrixInverse(&m, NULL, &m);
 
-    *out = *v;
-    if (viewport)
-    {
-        out->x = 2.0f * (out->x - viewport->X) / viewport->Width - 1.0f;
-        out->y = 1.0f - 2.0f * (out->y - viewport->Y) / viewport->Height;
-        out->z = (out->z - viewport->MinZ) / (viewport->MaxZ - viewport->MinZ);
-    }
-    D3DXVec3TransformCoord(out, out, &m);
+    vec3_unproject(out, v, viewport, &m);
     return out;
 }
 
 D3DXVECTOR3* WINAPI D3DXVec3UnprojectArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DVIEWPORT9* viewport, const D3DXMATRIX* projection, const D3DXMATRIX* view, const D3DXMATRIX* world, UINT elements)
 {
+    D3DVIEWPORT9 vp;
+    D3DXMATRIX m;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, viewport %p, projection %p, view %p, world %p, elements %u\n",
         out, outstride, in, instride, viewport, projection, view, world, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec3Unproject(
-            (D3DXVECTOR3*)((char*)out + outstride * i),
-            (const D3DXVECTOR3*)((const char*)in + instride * i),
-            viewport, projection, view, world);
+    /* Inverting the combined matrix dominates the cost of a single unproject,
+     * so do it once for the whole array. */
+    get_world_view_projection(&m, projection, view, world);
+    D3DXMatrixInverse(&m, NULL, &m);
+    if (viewport)
+        vp = *viewport;
+
+    for (i = 0; i < elements; ++i)
+    {
+        vec3_unproject((D3DXVECTOR3 *)((char *)out + outstride * i),
+                (const D3DXVECTOR3 *)((const char *)in + instride * i), viewport ? &vp : NULL, &m);
     }
     return out;
 }
@@ -2066,31 +2126,35 @@ D3DXVECTOR4* WINAPI D3DXVec4Normalize(D3DXVECTOR4 *pout, const D3DXVECTOR4 *pv)
     return pout;
 }
 
-D3DXVECTOR4* WINAPI D3DXVec4Transform(D3DXVECTOR4 *pout, const D3DXVECTOR4 *pv, const D3DXMATRIX *pm)
+static inline void vec4_transform(D3DXVECTOR4 *out, const D3DXVECTOR4 *in, const D3DXMATRIX *m)
 {
-    D3DXVECTOR4 out;
+    const D3DXVECTOR4 v = *in;
 
+    out->x = m->u.m[0][0] * v.x + m->u.m[1][0] * v.y + m->u.m[2][0] * v.z + m->u.m[3][0] * v.w;
+    out->y = m->u.m[0][1] * v.x + m->u.m[1][1] * v.y + m->u.m[2][1] * v.z + m->u.m[3][1] * v.w;
+    out->z = m->u.m[0][2] * v.x + m->u.m[1][2] * v.y + m->u.m[2][2] * v.z + m->u.m[3][2] * v.w;
+    out->w = m->u.m[0][3] * v.x + m->u.m[1][3] * v.y + m->u.m[2][3] * v.z + m->u.m[3][3] * v.w;
+}
+
+D3DXVECTOR4* WINAPI D3DXVec4Transform(D3DXVECTOR4 *pout, const D3DXVECTOR4 *pv, const D3DXMATRIX *pm)
+{
     TRACE("pout %p, pv %p, pm %p\n", pout, pv, pm);
 
-    out.x = pm->u.m[0][0] * pv->x + pm->u.m[1][0] * pv->y + pm->u.m[2][0] * pv->z + pm->u.m[3][0] * pv->w;
-    out.y = pm->u.m[0][1] * pv->x + pm->u.m[1][1] * pv->y + pm->u.m[2][1] * pv->z + pm->u.m[3][1] * pv->w;
-    out.z = pm->u.m[0][2] * pv->x + pm->u.m[1][2] * pv->y + pm->u.m[2][2] * pv->z + pm->u.m[3][2] * pv->w;
-    out.w = pm->u.m[0][3] * pv->x + pm->u.m[1][3] * pv->y + pm->u.m[2][3] * pv->z + pm->u.m[3][3] * pv->w;
-    *pout = out;
+    vec4_transform(pout, pv, pm);
     return pout;
 }
 
 D3DXVECTOR4* WINAPI D3DXVec4TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR4* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    const D3DXMATRIX m = *matrix;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec4Transform(
-            (D3DXVECTOR4*)((char*)out + outstride * i),
-            (const D3DXVECTOR4*)((const char*)in + instride * i),
-            matrix);
+    for (i = 0; i < elements; ++i)
+    {
+        vec4_transform((D3DXVECTOR4 *)((char *)out + outstride * i),
+                (const D3DXVECTOR4 *)((const char *)in + instride * i), &m);
     }
     return out;
 }
@@ -875,12 +875,13 @@ struct edge_face_map
  * face.
  */
 static HRESULT init_edge_face_map(struct edge_face_map *edge_face_map, const DWORD *index_buffer,
-        const DWORD *point_reps, DWORD num_faces)
+        const DWORD *point_reps, DWORD num_faces, DWORD num_vertices)
 {
     DWORD face, edge;
     DWORD i;
 
-    edge_face_map->lists = HeapAlloc(GetProcessHeap(), 0, 3 * num_faces * sizeof(*edge_face_map->lists));
+    /* The lists are indexed by the (replaced) first vertex of each edge. */
+    edge_face_map->lists = HeapAlloc(GetProcessHeap(), 0, num_vertices * sizeof(*edge_face_map->lists));
     if (!edge_face_map->lists) return E_OUTOFMEMORY;
 
     edge_face_map->entries = HeapAlloc(GetProcessHeap(), 0, 3 * num_faces * sizeof(*edge_face_map->entries));
@@ -888,7 +889,7 @@ static HRESULT init_edge_face_map(struct edge_face_map *edge_face_map, const DWO
 
 
     /* Initialize all lists */
-    for (i = 0; i < 3 * num_faces; i++)
+    for (i = 0; i < num_vertices; i++)
     {
         list_init(&edge_face_map->lists[i]);
     }
@@ -1005,7 +1006,7 @@ static HRESULT WINAPI d3dx9_mesh_ConvertPointRepsToAdjacency(ID3DXMesh *iface,
         ib = ib_ptr;
     }
 
-    hr = init_edge_face_map(&edge_face_map, ib, point_reps_ptr, num_faces);
+    hr = init_edge_face_map(&edge_face_map, ib, point_reps_ptr, num_faces, num_vertices);
     if (FAILED(hr)) goto cleanup;
 
     /* Create adjacency */
@@ -1212,10 +1213,172 @@ static int __cdecl compare_vertex_keys(const void *a, const void *b)
     const struct vertex_metadata *left = a;
     const struct vertex_metadata *right = b;
     if (left->key == right->key)
-        return 0;
+        return left->vertex_index < right->vertex_index ? -1 : left->vertex_index > right->vertex_index;
     return left->key < right->key ? -1 : 1;
 }
 
+static int __cdecl compare_dwords(const void *a, const void *b)
+{
+    const DWORD *left = a;
+    const DWORD *right = b;
+    return *left < *right ? -1 : *left > *right;
+}
+
+/* Spatial hash of the sorted vertices, used to find coincident vertices
+ * without scanning every vertex with a similar sort key. The cell size is
+ * derived from the vertex density of the mesh, but never smaller than
+ * 2 * epsilon, so that a vertex only needs to look at neighbouring cells if
+ * it is within epsilon of a cell boundary. */
+struct vertex_grid
+{
+    DWORD *buckets;
+    DWORD bucket_mask;
+    DWORD *next;
+    INT64 (*cells)[3];
+    double cell_size;
+};
+
+static INT64 vertex_grid_get_cell(const struct vertex_grid *grid, double c)
+{
+    static const double limit = (double)((INT64)1 << 62);
+    double d = floor(c / grid->cell_size);
+
+    /* This also catches NaNs; their vertices are never coincident. */
+    if (!(d >= -limit))
+        return -((INT64)1 << 62);
+    if (d > limit)
+        return (INT64)1 << 62;
+    return d;
+}
+
+static DWORD vertex_grid_hash(const INT64 cell[3])
+{
+    UINT64 h;
+
+    h = (UINT64)cell[0] * 0x9e3779b97f4a7c15ull;
+    h ^= (UINT64)cell[1] * 0xc2b2ae3d27d4eb4full;
+    h ^= (UINT64)cell[2] * 0x165667b19e3779f9ull;
+    return h ^ (h >> 32);
+}
+
+static HRESULT vertex_grid_init(struct vertex_grid *grid, const struct vertex_metadata *sorted_vertices,
+        DWORD vertex_count, const BYTE *vertices, DWORD vertex_size, float epsilon)
+{
+    D3DXVECTOR3 lower = {FLT_MAX, FLT_MAX, FLT_MAX}, upper = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    DWORD bucket_count = 1;
+    double extent;
+    DWORD i, j;
+
+    for (i = 0; i < vertex_count; ++i)
+    {
+        const float *c = (const float *)(vertices + i * vertex_size);
+
+        for (j = 0; j < 3; ++j)
+        {
+            if (!isfinite(c[j]))
+                continue;
+            if (c[j] < (&lower.x)[j])
+                (&lower.x)[j] = c[j];
+            if (c[j] > (&upper.x)[j])
+                (&upper.x)[j] = c[j];
+        }
+    }
+    extent = max(max((double)upper.x - lower.x, (double)upper.y - lower.y), (double)upper.z - lower.z);
+
+    /* Meshes are mostly surfaces, so aim for about one vertex per cell on
+     * the surface. */
+    grid->cell_size = extent / sqrt(vertex_count);
+    if (grid->cell_size < 2.0 * epsilon)
+        grid->cell_size = 2.0 * epsilon;
+    if (!(grid->cell_size > 0.0) || !isfinite(grid->cell_size))
+        grid->cell_size = 1.0;
+
+    while (bucket_count < vertex_count && bucket_count < 0x80000000u)
+        bucket_count <<= 1;
+
+    grid->bucket_mask = bucket_count - 1;
+    grid->buckets = HeapAlloc(GetProcessHeap(), 0, bucket_count * sizeof(*grid->buckets));
+    grid->next = HeapAlloc(GetProcessHeap(), 0, vertex_count * sizeof(*grid->next));
+    grid->cells = HeapAlloc(GetProcessHeap(), 0, vertex_count * sizeof(*grid->cells));
+    if (!grid->buckets || !grid->next || !grid->cells)
+        return E_OUTOFMEMORY;
+
+    memset(grid->buckets, 0xff, bucket_count * sizeof(*grid->buckets));
+    for (i = 0; i < vertex_count; ++i)
+    {
+        const D3DXVECTOR3 *vertex = (const D3DXVECTOR3 *)(vertices + sorted_vertices[i].vertex_index * vertex_size);
+        DWORD bucket;
+
+        grid->cells[i][0] = vertex_grid_get_cell(grid, vertex->x);
+        grid->cells[i][1] = vertex_grid_get_cell(grid, vertex->y);
+        grid->cells[i][2] = vertex_grid_get_cell(grid, vertex->z);
+        bucket = vertex_grid_hash(grid->cells[i]) & grid->bucket_mask;
+        grid->next[i] = grid->buckets[bucket];
+        grid->buckets[bucket] = i;
+    }
+
+    return D3D_OK;
+}
+
+static void vertex_grid_cleanup(struct vertex_grid *grid)
+{
+    HeapFree(GetProcessHeap(), 0, grid->buckets);
+    HeapFree(GetProcessHeap(), 0, grid->next);
+    HeapFree(GetProcessHeap(), 0, grid->cells);
+}
+
+/* Stores the positions of the vertices coincident with sorted vertex "idx"
+ * that come after it in the sorted order, in ascending order. This is the same
+ * set of vertices, in the same order, as a forward scan through the sorted
+ * vertices that stops once the keys differ by more than 3 * epsilon. */
+static DWORD vertex_grid_find_coincident(const struct vertex_grid *grid,
+        const struct vertex_metadata *sorted_vertices, DWORD idx, const BYTE *vertices,
+        DWORD vertex_size, float epsilon, DWORD *coincident)
+{
+    const D3DXVECTOR3 *vertex_a = (const D3DXVECTOR3 *)(vertices + sorted_vertices[idx].vertex_index * vertex_size);
+    INT64 lo[3], hi[3], cell[3];
+    DWORD count = 0, i, j;
+
+    for (i = 0; i < 3; ++i)
+    {
+        double c = (&vertex_a->x)[i];
+        /* Allow for rounding in the float subtraction of the coincidence test. */
+        double margin = epsilon ? epsilon + (fabs(c) + epsilon) * 2.0 * FLT_EPSILON : 0.0;
+
+        lo[i] = vertex_grid_get_cell(grid, c - margin);
+        hi[i] = vertex_grid_get_cell(grid, c + margin);
+    }
+
+    for (cell[0] = lo[0]; cell[0] <= hi[0]; ++cell[0])
+    {
+        for (cell[1] = lo[1]; cell[1] <= hi[1]; ++cell[1])
+        {
+            for (cell[2] = lo[2]; cell[2] <= hi[2]; ++cell[2])
+            {
+                for (j = grid->buckets[vertex_grid_hash(cell) & grid->bucket_mask]; j != ~0u; j = grid->next[j])
+                {
+                    const D3DXVECTOR3 *vertex_b;
+
+                    if (j <= idx || memcmp(grid->cells[j], cell, sizeof(cell)))
+                        continue;
+                    if (sorted_vertices[j].key - sorted_vertices[idx].key > epsilon * 3.0f)
+                        continue;
+                    vertex_b = (const D3DXVECTOR3 *)(vertices + sorted_vertices[j].vertex_index * vertex_size);
+                    if (fabsf(vertex_a->x - vertex_b->x) <= epsilon &&
+                        fabsf(vertex_a->y - vertex_b->y) <= epsilon &&
+                        fabsf(vertex_a->z - vertex_b->z) <= epsilon)
+                        coincident[count++] = j;
+                }
+            }
+        }
+    }
+
+    if (count > 1)
+        qsort(coincident, count, sizeof(*coincident), compare_dwords);
+
+    return count;
+}
+
 static HRESULT WINAPI d3dx9_mesh_GenerateAdjacency(ID3DXMesh *iface, float epsilon, DWORD *adjacency)
 {
     struct d3dx9_mesh *This = impl_from_ID3DXMesh(iface);
@@ -1230,6 +1393,8 @@ static HRESULT WINAPI d3dx9_mesh_GenerateAdjacency(ID3DXMesh *iface, float epsil
      * that adjacency checks can be limited to faces sharing a vertex */
     DWORD *shared_indices = NULL;
     const FLOAT epsilon_sq = epsilon * epsilon;
+    struct vertex_grid grid = {0};
+    DWORD *coincident = NULL;
     DWORD i;
 
     TRACE("iface %p, epsilon %.8e, adjacency %p.\n", iface, epsilon, adjacency);
@@ -1273,15 +1438,30 @@ static HRESULT WINAPI d3dx9_mesh_GenerateAdjacency(ID3DXMesh *iface, float epsil
     }
     qsort(sorted_vertices, This->numvertices, sizeof(*sorted_vertices), compare_vertex_keys);
 
+    /* A negative epsilon never matches another vertex. */
+    if (epsilon >= 0.0f)
+    {
+        if (FAILED(hr = vertex_grid_init(&grid, sorted_vertices, This->numvertices, vertices, vertex_size, epsilon)))
+            goto cleanup;
+        if (!(coincident = HeapAlloc(GetProcessHeap(), 0, This->numvertices * sizeof(*coincident))))
+        {
+            hr = E_OUTOFMEMORY;
+            goto cleanup;
+        }
+    }
+
     for (i = 0; i < This->numvertices; i++) {
         struct vertex_metadata *sorted_vertex_a = &sorted_vertices[i];
-        D3DXVECTOR3 *vertex_a = (D3DXVECTOR3*)(vertices + sorted_vertex_a->vertex_index * vertex_size);
         DWORD shared_index_a = sorted_vertex_a->first_shared_index;
+        DWORD coincident_count = 0;
+
+        if (shared_index_a != -1 && coincident)
+            coincident_count = vertex_grid_find_coincident(&grid, sorted_vertices, i,
+                    vertices, vertex_size, epsilon, coincident);
 
         while (shared_index_a != -1) {
-            DWORD j = i;
+            DWORD j = 0;
             DWORD shared_index_b = shared_indices[shared_index_a];
-            struct vertex_metadata *sorted_vertex_b = sorted_vertex_a;
 
             while (TRUE) {
                 while (shared_index_b != -1) {
@@ -1326,27 +1506,10 @@ static HRESULT WINAPI d3dx9_mesh_GenerateAdjacency(ID3DXMesh *iface, float epsil
 
                     shared_index_b = shared_indices[shared_index_b];
                 }
-                while (++j < This->numvertices) {
-                    D3DXVECTOR3 *vertex_b;
-
-                    sorted_vertex_b++;
-                    if (sorted_vertex_b->key - sorted_vertex_a->key > epsilon * 3.0f) {
-                        /* no more coincident vertices to try */
-                        j = This->numvertices;
-                        break;
-                    }
-                    /* check for coincidence */
-                    vertex_b = (D3DXVECTOR3*)(vertices + sorted_vertex_b->vertex_index * vertex_size);
-                    if (fabsf(vertex_a->x - vertex_b->x) <= epsilon &&
-                        fabsf(vertex_a->y - vertex_b->y) <= epsilon &&
-                        fabsf(vertex_a->z - vertex_b->z) <= epsilon)
-                    {
-                        break;
-                    }
-                }
-                if (j >= This->numvertices)
+                /* move on to the next coincident vertex */
+                if (j >= coincident_count)
                     break;
-                shared_index_b = sorted_vertex_b->first_shared_index;
+                shared_index_b = sorted_vertices[coincident[j++]].first_shared_index;
             }
 
             sorted_vertex_a->first_shared_index = shared_indices[sorted_vertex_a->first_shared_index];
@@ -1358,6 +1521,8 @@ static HRESULT WINAPI d3dx9_mesh_GenerateAdjacency(ID3DXMesh *iface, float epsil
 cleanup:
     if (indices) iface->lpVtbl->UnlockIndexBuffer(iface);
     if (vertices) iface->lpVtbl->UnlockVertexBuffer(iface);
+    vertex_grid_cleanup(&grid);
+    HeapFree(GetProcessHeap(), 0, coincident);
     HeapFree(GetProcessHeap(), 0, shared_indices);
     return hr;
 }
@@ -7018,6 +7183,9 @@ HRESULT WINAPI D3DXWeldVertices(ID3DXMesh *mesh, DWORD flags, const D3DXWELDEPSI
     struct d3dx9_mesh *This = impl_from_ID3DXMesh(mesh);
     DWORD *vertex_face_map = NULL;
     BYTE *vertices = NULL;
+    FLOAT component_epsilons[MAX_FVF_DECL_SIZE];
+    DWORD vertex_size, num_vertex_components;
+    D3DVERTEXELEMENT9 *decl_ptr;
 
     TRACE("mesh %p, flags %#x, epsilons %p, adjacency %p, adjacency_out %p, face_remap_out %p, vertex_remap_out %p.\n",
             mesh, flags, epsilons, adjacency, adjacency_out, face_remap_out, vertex_remap_out);
@@ -7104,6 +7272,10 @@ HRESULT WINAPI D3DXWeldVertices(ID3DXMesh *mesh, DWORD flags, const D3DXWELDEPSI
             ERR("Couldn't lock vertex buffer.\n");
             goto cleanup;
         }
+        vertex_size = mesh->lpVtbl->GetNumBytesPerVertex(mesh);
+        for (decl_ptr = This->cached_declaration, num_vertex_components = 0; decl_ptr->Stream != 0xFF; decl_ptr++, num_vertex_components++)
+            component_epsilons[num_vertex_components] = get_component_epsilon(decl_ptr, epsilons);
+
         /* For each vertex that can be removed, compare its vertex components
          * with the vertex components from the vertex that can replace it. A
          * vertex is only fully replaced if all the components match and the
@@ -7113,27 +7285,21 @@ HRESULT WINAPI D3DXWeldVertices(ID3DXMesh *mesh, DWORD flags, const D3DXWELDEPSI
          */
         for (i = 0; i < 3 * This->numfaces; i++)
         {
-            D3DVERTEXELEMENT9 *decl_ptr;
-            DWORD vertex_size = mesh->lpVtbl->GetNumBytesPerVertex(mesh);
-            DWORD num_vertex_components;
+            DWORD index = read_ib(indices, indices_are_32bit, i);
+            DWORD component;
             INT matches = 0;
             BOOL all_match;
-            DWORD index = read_ib(indices, indices_are_32bit, i);
 
-            for (decl_ptr = This->cached_declaration, num_vertex_components = 0; decl_ptr->Stream != 0xFF; decl_ptr++, num_vertex_components++)
+            /* Don't weld self */
+            if (index == point_reps[index])
+                continue;
+
+            for (decl_ptr = This->cached_declaration, component = 0; decl_ptr->Stream != 0xFF; decl_ptr++, component++)
             {
                 BYTE *to = &vertices[vertex_size*index + decl_ptr->Offset];
                 BYTE *from = &vertices[vertex_size*point_reps[index] + decl_ptr->Offset];
-                FLOAT epsilon = get_component_epsilon(decl_ptr, epsilons);
-
-                /* Don't weld self */
-                if (index == point_reps[index])
-                {
-                    matches++;
-                    continue;
-                }
 
-                if (weld_component(to, from, decl_ptr->Type, epsilon))
+                if (weld_component(to, from, decl_ptr->Type, component_epsilons[component]))
                     matches++;
             }
 
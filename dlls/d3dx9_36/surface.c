@@ -1629,6 +1629,235 @@ void copy_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pitch,
     }
 }
 
+/* Images with at least this many pixels are filtered in bands of rows on the
+ * thread pool. */
+#define D3DX_FILTER_PARALLEL_MIN_PIXELS 0x40000
+#define D3DX_FILTER_MAX_THREADS 8
+
+struct filter_span
+{
+    unsigned int first, count;
+    const float *weights;
+};
+
+struct pixel_filter_job
+{
+    void (*filter_rows)(const struct pixel_filter_job *job, unsigned int z, unsigned int y, unsigned int row_count);
+
+    const BYTE *src;
+    UINT src_row_pitch, src_slice_pitch;
+    const struct volume *src_size;
+    const struct pixel_format_desc *src_format;
+    BYTE *dst;
+    UINT dst_row_pitch, dst_slice_pitch;
+    const struct volume *dst_size;
+    const struct pixel_format_desc *dst_format;
+    D3DCOLOR color_key;
+    const PALETTEENTRY *palette;
+
+    struct argb_conversion_info conv_info, ck_conv_info;
+    const struct pixel_format_desc *ck_format;
+    /* Both formats are plain ARGB formats of at most 32 bits. */
+    BOOL simple_argb;
+    /* The channels of both formats are at the same position and have the
+     * same size, so a pixel converts as (pixel & copy_mask) | channelmask. */
+    BOOL masked_copy;
+    DWORD copy_mask;
+    /* Source x offsets in bytes for each destination column, for stretching. */
+    UINT *src_x_offsets;
+    /* Source pixels covered by each destination column, row and slice. */
+    const struct filter_span *x_spans, *y_spans, *z_spans;
+
+    unsigned int width, height, depth;
+    unsigned int band_height, bands_per_slice;
+};
+
+static void init_pixel_filter_job(struct pixel_filter_job *job, const BYTE *src, UINT src_row_pitch,
+        UINT src_slice_pitch, const struct volume *src_size, const struct pixel_format_desc *src_format,
+        BYTE *dst, UINT dst_row_pitch, UINT dst_slice_pitch, const struct volume *dst_size,
+        const struct pixel_format_desc *dst_format, D3DCOLOR color_key, const PALETTEENTRY *palette)
+{
+    unsigned int i;
+
+    memset(job, 0, sizeof(*job));
+    job->src = src;
+    job->src_row_pitch = src_row_pitch;
+    job->src_slice_pitch = src_slice_pitch;
+    job->src_size = src_size;
+    job->src_format = src_format;
+    job->dst = dst;
+    job->dst_row_pitch = dst_row_pitch;
+    job->dst_slice_pitch = dst_slice_pitch;
+    job->dst_size = dst_size;
+    job->dst_format = dst_format;
+    job->color_key = color_key;
+    job->palette = palette;
+
+    init_argb_conversion_info(src_format, dst_format, &job->conv_info);
+
+    if (color_key)
+    {
+        /* Color keys are always represented in D3DFMT_A8R8G8B8 format. */
+        job->ck_format = get_format_info(D3DFMT_A8R8G8B8);
+        init_argb_conversion_info(src_format, job->ck_format, &job->ck_conv_info);
+    }
+
+    job->simple_argb = !src_format->to_rgba && !dst_format->from_rgba
+            && src_format->type == dst_format->type
+            && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4;
+
+    if (!job->simple_argb || color_key)
+        return;
+    for (i = 0; i < 4; ++i)
+    {
+        if (!job->conv_info.process_channel[i])
+            continue;
+        if (src_format->bits[i] != dst_format->bits[i] || src_format->shift[i] != dst_format->shift[i])
+            return;
+        job->copy_mask |= job->conv_info.srcmask[i];
+    }
+    job->masked_copy = TRUE;
+}
+
+static void pixel_to_rgba(const struct pixel_filter_job *job, const BYTE *src, struct vec4 *rgba)
+{
+    struct vec4 color;
+
+    format_to_vec4(job->src_format, src, &color);
+    if (job->src_format->to_rgba)
+        job->src_format->to_rgba(&color, rgba, job->palette);
+    else
+        *rgba = color;
+
+    if (job->ck_format)
+    {
+        DWORD ck_pixel;
+
+        format_from_vec4(job->ck_format, rgba, (BYTE *)&ck_pixel);
+        if (ck_pixel == job->color_key)
+            rgba->w = 0.0f;
+    }
+}
+
+static void pixel_from_rgba(const struct pixel_filter_job *job, const struct vec4 *rgba, BYTE *dst)
+{
+    struct vec4 color;
+
+    if (job->dst_format->from_rgba)
+        job->dst_format->from_rgba(rgba, &color);
+    else
+        color = *rgba;
+
+    format_from_vec4(job->dst_format, &color, dst);
+}
+
+static void convert_pixel(const struct pixel_filter_job *job, const BYTE *src, BYTE *dst)
+{
+    if (job->simple_argb)
+    {
+        DWORD channels[4] = {0};
+        DWORD val;
+
+        get_relevant_argb_components(&job->conv_info, src, channels);
+        val = make_argb_color(&job->conv_info, channels);
+
+        if (job->color_key)
+        {
+            DWORD ck_pixel;
+
+            get_relevant_argb_components(&job->ck_conv_info, src, channels);
+            ck_pixel = make_argb_color(&job->ck_conv_info, channels);
+            if (ck_pixel == job->color_key)
+                val &= ~job->conv_info.destmask[0];
+        }
+        memcpy(dst, &val, job->dst_format->bytes_per_pixel);
+    }
+    else
+    {
+        struct vec4 rgba;
+
+        pixel_to_rgba(job, src, &rgba);
+        pixel_from_rgba(job, &rgba, dst);
+    }
+}
+
+static void pixel_filter_band(void *ctx, unsigned int band)
+{
+    struct pixel_filter_job *job = ctx;
+    unsigned int y = (band % job->bands_per_slice) * job->band_height;
+
+    job->filter_rows(job, band / job->bands_per_slice, y, min(job->band_height, job->height - y));
+}
+
+/* Runs job->filter_rows() over a width x height x depth region. Large regions
+ * are split into bands of rows that are filtered in parallel on the thread
+ * pool. */
+static void run_pixel_filter_job(struct pixel_filter_job *job, unsigned int width,
+        unsigned int height, unsigned int depth)
+{
+    unsigned int thread_count, band_count, i;
+
+    job->width = width;
+    job->height = height;
+    job->depth = depth;
+    if (!width || !height || !depth)
+        return;
+
+    if ((UINT64)width * height * depth < D3DX_FILTER_PARALLEL_MIN_PIXELS
+            || (thread_count = wine_parallel_thread_count(D3DX_FILTER_MAX_THREADS)) < 2)
+    {
+        for (i = 0; i < depth; ++i)
+            job->filter_rows(job, i, 0, height);
+        return;
+    }
+
+    band_count = (thread_count * WINE_PARALLEL_ITEMS_PER_THREAD + depth - 1) / depth;
+    job->band_height = (height + band_count - 1) / band_count;
+    job->bands_per_slice = (height + job->band_height - 1) / job->band_height;
+
+    TRACE("Filtering %ux%ux%u pixels in %u bands of %u rows.\n",
+            width, height, depth, job->bands_per_slice * depth, job->band_height);
+
+    wine_parallel_for(job->bands_per_slice * depth, thread_count, pixel_filter_band, job);
+}
+
+static void convert_rows(const struct pixel_filter_job *job, unsigned int z, unsigned int y, unsigned int row_count)
+{
+    const struct pixel_format_desc *src_format = job->src_format, *dst_format = job->dst_format;
+    unsigned int x, row;
+
+    for (row = y; row < y + row_count; ++row)
+    {
+        const BYTE *src_ptr = job->src + z * job->src_slice_pitch + row * job->src_row_pitch;
+        BYTE *dst_ptr = job->dst + z * job->dst_slice_pitch + row * job->dst_row_pitch;
+
+        if (job->masked_copy && src_format->bytes_per_pixel == 4 && dst_format->bytes_per_pixel == 4)
+        {
+            for (x = 0; x < job->width; ++x)
+            {
+                DWORD val;
+
+                memcpy(&val, src_ptr + x * 4, sizeof(val));
+                val = (val & job->copy_mask) | job->conv_info.channelmask;
+                memcpy(dst_ptr + x * 4, &val, sizeof(val));
+            }
+            dst_ptr += job->width * 4;
+        }
+        else
+        {
+            for (x = 0; x < job->width; ++x)
+            {
+                convert_pixel(job, src_ptr, dst_ptr);
+                src_ptr += src_format->bytes_per_pixel;
+                dst_ptr += dst_format->bytes_per_pixel;
+            }
+        }
+
+        if (job->src_size->width < job->dst_size->width) /* black out remaining pixels */
+            memset(dst_ptr, 0, dst_format->bytes_per_pixel * (job->dst_size->width - job->src_size->width));
+    }
+}
+
 /************************************************************
  * convert_argb_pixels
  *
@@ -1641,100 +1870,69 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
         const struct volume *dst_size, const struct pixel_format_desc *dst_format, D3DCOLOR color_key,
         const PALETTEENTRY *palette)
 {
-    struct argb_conversion_info conv_info, ck_conv_info;
-    const struct pixel_format_desc *ck_format = NULL;
-    DWORD channels[4];
+    struct pixel_filter_job job;
     UINT min_width, min_height, min_depth;
-    UINT x, y, z;
+    UINT z;
 
     TRACE("src %p, src_row_pitch %u, src_slice_pitch %u, src_size %p, src_format %p, dst %p, "
             "dst_row_pitch %u, dst_slice_pitch %u, dst_size %p, dst_format %p, color_key 0x%08x, palette %p.\n",
             src, src_row_pitch, src_slice_pitch, src_size, src_format, dst, dst_row_pitch, dst_slice_pitch, dst_size,
             dst_format, color_key, palette);
 
-    ZeroMemory(channels, sizeof(channels));
-    init_argb_conversion_info(src_format, dst_format, &conv_info);
+    init_pixel_filter_job(&job, src, src_row_pitch, src_slice_pitch, src_size, src_format,
+            dst, dst_row_pitch, dst_slice_pitch, dst_size, dst_format, color_key, palette);
+    job.filter_rows = convert_rows;
 
     min_width = min(src_size->width, dst_size->width);
     min_height = min(src_size->height, dst_size->height);
     min_depth = min(src_size->depth, dst_size->depth);
 
-    if (color_key)
-    {
-        /* Color keys are always represented in D3DFMT_A8R8G8B8 format. */
-        ck_format = get_format_info(D3DFMT_A8R8G8B8);
-        init_argb_conversion_info(src_format, ck_format, &ck_conv_info);
-    }
+    run_pixel_filter_job(&job, min_width, min_height, min_depth);
 
     for (z = 0; z < min_depth; z++) {
-        const BYTE *src_slice_ptr = src + z * src_slice_pitch;
-        BYTE *dst_slice_ptr = dst + z * dst_slice_pitch;
-
-        for (y = 0; y < min_height; y++) {
-            const BYTE *src_ptr = src_slice_ptr + y * src_row_pitch;
-            BYTE *dst_ptr = dst_slice_ptr + y * dst_row_pitch;
-
-            for (x = 0; x < min_width; x++) {
-                if (!src_format->to_rgba && !dst_format->from_rgba
-                        && src_format->type == dst_format->type
-                        && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4)
-                {
-                    DWORD val;
-
-                    get_relevant_argb_components(&conv_info, src_ptr, channels);
-                    val = make_argb_color(&conv_info, channels);
-
-                    if (color_key)
-                    {
-                        DWORD ck_pixel;
-
-                        get_relevant_argb_components(&ck_conv_info, src_ptr, channels);
-                        ck_pixel = make_argb_color(&ck_conv_info, channels);
-                        if (ck_pixel == color_key)
-                            val &= ~conv_info.destmask[0];
-                    }
-                    memcpy(dst_ptr, &val, dst_format->bytes_per_pixel);
-                }
-                else
-                {
-                    struct vec4 color, tmp;
-
-                    format_to_vec4(src_format, src_ptr, &color);
-                    if (src_format->to_rgba)
-                        src_format->to_rgba(&color, &tmp, palette);
-                    else
-                        tmp = color;
-
-                    if (ck_format)
-                    {
-                        DWORD ck_pixel;
+        if (src_size->height < dst_size->height) /* black out remaining pixels */
+            memset(dst + src_size->height * dst_row_pitch, 0, dst_row_pitch * (dst_size->height - src_size->height));
+    }
+    if (src_size->depth < dst_size->depth) /* black out remaining pixels */
+        memset(dst + src_size->depth * dst_slice_pitch, 0, dst_slice_pitch * (dst_size->depth - src_size->depth));
+}
 
-                        format_from_vec4(ck_format, &tmp, (BYTE *)&ck_pixel);
-                        if (ck_pixel == color_key)
-                            tmp.w = 0.0f;
-                    }
+static void point_filter_rows(const struct pixel_filter_job *job, unsigned int z, unsigned int y, unsigned int row_count)
+{
+    const struct pixel_format_desc *src_format = job->src_format, *dst_format = job->dst_format;
+    const struct volume *src_size = job->src_size, *dst_size = job->dst_size;
+    const BYTE *src_slice_ptr = job->src + job->src_slice_pitch * (z * src_size->depth / dst_size->depth);
+    BYTE *dst_slice_ptr = job->dst + z * job->dst_slice_pitch;
+    unsigned int x, row;
 
-                    if (dst_format->from_rgba)
-                        dst_format->from_rgba(&tmp, &color);
-                    else
-                        color = tmp;
+    for (row = y; row < y + row_count; ++row)
+    {
+        const BYTE *src_row_ptr = src_slice_ptr + job->src_row_pitch * (row * src_size->height / dst_size->height);
+        BYTE *dst_ptr = dst_slice_ptr + row * job->dst_row_pitch;
 
-                    format_from_vec4(dst_format, &color, dst_ptr);
-                }
+        if (job->masked_copy && job->src_x_offsets
+                && src_format->bytes_per_pixel == 4 && dst_format->bytes_per_pixel == 4)
+        {
+            for (x = 0; x < dst_size->width; ++x)
+            {
+                DWORD val;
 
-                src_ptr += src_format->bytes_per_pixel;
-                dst_ptr += dst_format->bytes_per_pixel;
+                memcpy(&val, src_row_ptr + job->src_x_offsets[x], sizeof(val));
+                val = (val & job->copy_mask) | job->conv_info.channelmask;
+                memcpy(dst_ptr + x * 4, &val, sizeof(val));
             }
-
-            if (src_size->width < dst_size->width) /* black out remaining pixels */
-                memset(dst_ptr, 0, dst_format->bytes_per_pixel * (dst_size->width - src_size->width));
+            continue;
         }
 
-        if (src_size->height < dst_size->height) /* black out remaining pixels */
-            memset(dst + src_size->height * dst_row_pitch, 0, dst_row_pitch * (dst_size->height - src_size->height));
+        for (x = 0; x < dst_size->width; ++x)
+        {
+            const BYTE *src_ptr = src_row_ptr + (job->src_x_offsets ? job->src_x_offsets[x]
+                    : (x * src_size->width / dst_size->width) * src_format->bytes_per_pixel);
+
+            convert_pixel(job, src_ptr, dst_ptr);
+            dst_ptr += dst_format->bytes_per_pixel;
+        }
     }
-    if (src_size->depth < dst_size->depth) /* black out remaining pixels */
-        memset(dst + src_size->depth * dst_slice_pitch, 0, dst_slice_pitch * (dst_size->depth - src_size->depth));
 }
 
 /************************************************************
@@ -1749,93 +1947,249 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
         const struct volume *dst_size, const struct pixel_format_desc *dst_format, D3DCOLOR color_key,
         const PALETTEENTRY *palette)
 {
-    struct argb_conversion_info conv_info, ck_conv_info;
-    const struct pixel_format_desc *ck_format = NULL;
-    DWORD channels[4];
-    UINT x, y, z;
+    struct pixel_filter_job job;
+    UINT x;
 
     TRACE("src %p, src_row_pitch %u, src_slice_pitch %u, src_size %p, src_format %p, dst %p, "
             "dst_row_pitch %u, dst_slice_pitch %u, dst_size %p, dst_format %p, color_key 0x%08x, palette %p.\n",
             src, src_row_pitch, src_slice_pitch, src_size, src_format, dst, dst_row_pitch, dst_slice_pitch, dst_size,
             dst_format, color_key, palette);
 
-    ZeroMemory(channels, sizeof(channels));
-    init_argb_conversion_info(src_format, dst_format, &conv_info);
+    init_pixel_filter_job(&job, src, src_row_pitch, src_slice_pitch, src_size, src_format,
+            dst, dst_row_pitch, dst_slice_pitch, dst_size, dst_format, color_key, palette);
+    job.filter_rows = point_filter_rows;
 
-    if (color_key)
+    /* Not fatal, the offsets are recomputed for every pixel without it. */
+    if ((job.src_x_offsets = heap_alloc(dst_size->width * sizeof(*job.src_x_offsets))))
     {
-        /* Color keys are always represented in D3DFMT_A8R8G8B8 format. */
-        ck_format = get_format_info(D3DFMT_A8R8G8B8);
-        init_argb_conversion_info(src_format, ck_format, &ck_conv_info);
+        for (x = 0; x < dst_size->width; ++x)
+            job.src_x_offsets[x] = (x * src_size->width / dst_size->width) * src_format->bytes_per_pixel;
     }
 
-    for (z = 0; z < dst_size->depth; z++)
-    {
-        BYTE *dst_slice_ptr = dst + z * dst_slice_pitch;
-        const BYTE *src_slice_ptr = src + src_slice_pitch * (z * src_size->depth / dst_size->depth);
+    run_pixel_filter_job(&job, dst_size->width, dst_size->height, dst_size->depth);
 
-        for (y = 0; y < dst_size->height; y++)
-        {
-            BYTE *dst_ptr = dst_slice_ptr + y * dst_row_pitch;
-            const BYTE *src_row_ptr = src_slice_ptr + src_row_pitch * (y * src_size->height / dst_size->height);
+    heap_free(job.src_x_offsets);
+}
 
-            for (x = 0; x < dst_size->width; x++)
+static void box_filter_rows(const struct pixel_filter_job *job, unsigned int z, unsigned int y, unsigned int row_count)
+{
+    const struct pixel_format_desc *src_format = job->src_format, *dst_format = job->dst_format;
+    const struct volume *src_size = job->src_size, *dst_size = job->dst_size;
+    unsigned int fx = src_size->width / dst_size->width;
+    unsigned int fy = src_size->height / dst_size->height;
+    unsigned int fz = src_size->depth / dst_size->depth;
+    unsigned int count = fx * fy * fz;
+    UINT offsets[8];
+    unsigned int x, row, i, j, k, n;
+
+    for (k = 0, n = 0; k < fz; ++k)
+        for (j = 0; j < fy; ++j)
+            for (i = 0; i < fx; ++i)
+                offsets[n++] = k * job->src_slice_pitch + j * job->src_row_pitch + i * src_format->bytes_per_pixel;
+
+    for (row = y; row < y + row_count; ++row)
+    {
+        const BYTE *src_ptr = job->src + z * fz * job->src_slice_pitch + row * fy * job->src_row_pitch;
+        BYTE *dst_ptr = job->dst + z * job->dst_slice_pitch + row * job->dst_row_pitch;
+
+        if (job->masked_copy && src_format->bytes_per_pixel == 4 && dst_format->bytes_per_pixel == 4
+                && !((src_format->bits[0] | src_format->bits[1] | src_format->bits[2] | src_format->bits[3]) & ~8)
+                && !((src_format->shift[0] | src_format->shift[1] | src_format->shift[2] | src_format->shift[3]) & 7))
+        {
+            /* 8 bits per channel; average each byte. */
+            for (x = 0; x < dst_size->width; ++x)
             {
-                const BYTE *src_ptr = src_row_ptr + (x * src_size->width / dst_size->width) * src_format->bytes_per_pixel;
+                DWORD val = 0;
 
-                if (!src_format->to_rgba && !dst_format->from_rgba
-                        && src_format->type == dst_format->type
-                        && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4)
+                for (i = 0; i < 4; ++i)
                 {
-                    DWORD val;
+                    unsigned int sum = 0;
 
-                    get_relevant_argb_components(&conv_info, src_ptr, channels);
-                    val = make_argb_color(&conv_info, channels);
+                    for (n = 0; n < count; ++n)
+                        sum += src_ptr[offsets[n] + i];
+                    val |= ((sum + count / 2) / count) << (i * 8);
+                }
+                val = (val & job->copy_mask) | job->conv_info.channelmask;
+                memcpy(dst_ptr, &val, sizeof(val));
+                src_ptr += fx * 4;
+                dst_ptr += 4;
+            }
+            continue;
+        }
 
-                    if (color_key)
-                    {
-                        DWORD ck_pixel;
+        for (x = 0; x < dst_size->width; ++x)
+        {
+            struct vec4 sum = {0.0f, 0.0f, 0.0f, 0.0f}, rgba;
 
-                        get_relevant_argb_components(&ck_conv_info, src_ptr, channels);
-                        ck_pixel = make_argb_color(&ck_conv_info, channels);
-                        if (ck_pixel == color_key)
-                            val &= ~conv_info.destmask[0];
-                    }
-                    memcpy(dst_ptr, &val, dst_format->bytes_per_pixel);
-                }
-                else
-                {
-                    struct vec4 color, tmp;
+            for (n = 0; n < count; ++n)
+            {
+                pixel_to_rgba(job, src_ptr + offsets[n], &rgba);
+                sum.x += rgba.x;
+                sum.y += rgba.y;
+                sum.z += rgba.z;
+                sum.w += rgba.w;
+            }
+            sum.x /= count;
+            sum.y /= count;
+            sum.z /= count;
+            sum.w /= count;
+            pixel_from_rgba(job, &sum, dst_ptr);
+            src_ptr += fx * src_format->bytes_per_pixel;
+            dst_ptr += dst_format->bytes_per_pixel;
+        }
+    }
+}
+
+/* The fast path only handles reductions by 1 or 2 in each dimension, which
+ * is what mipmap generation needs. */
+static BOOL box_filter_supported(const struct volume *src_size, const struct volume *dst_size)
+{
+    return (src_size->width == dst_size->width || src_size->width == 2 * dst_size->width)
+            && (src_size->height == dst_size->height || src_size->height == 2 * dst_size->height)
+            && (src_size->depth == dst_size->depth || src_size->depth == 2 * dst_size->depth);
+}
 
-                    format_to_vec4(src_format, src_ptr, &color);
-                    if (src_format->to_rgba)
-                        src_format->to_rgba(&color, &tmp, palette);
-                    else
-                        tmp = color;
+/* Each destination pixel covers src_len / dst_len source pixels, which are
+ * weighted by how much of them it covers. When enlarging, every destination
+ * pixel falls inside a single source pixel, so this degrades to point
+ * filtering. */
+static struct filter_span *create_filter_spans(unsigned int src_len, unsigned int dst_len)
+{
+    unsigned int d, s, last;
+    struct filter_span *spans;
+    UINT64 lo, hi, start, end;
+    float *weights;
+
+    if (!(spans = heap_alloc(dst_len * sizeof(*spans) + dst_len * (src_len / dst_len + 2) * sizeof(*weights))))
+        return NULL;
+    weights = (float *)(spans + dst_len);
+
+    for (d = 0; d < dst_len; ++d)
+    {
+        /* The covered source range, in units of 1 / dst_len source pixels. */
+        lo = (UINT64)d * src_len;
+        hi = lo + src_len;
+        spans[d].first = lo / dst_len;
+        last = (hi - 1) / dst_len;
+        spans[d].count = last - spans[d].first + 1;
+        spans[d].weights = weights;
+        for (s = spans[d].first; s <= last; ++s)
+        {
+            start = max(lo, (UINT64)s * dst_len);
+            end = min(hi, (UINT64)(s + 1) * dst_len);
+            *weights++ = (float)(end - start) / src_len;
+        }
+    }
 
-                    if (ck_format)
-                    {
-                        DWORD ck_pixel;
+    return spans;
+}
 
-                        format_from_vec4(ck_format, &tmp, (BYTE *)&ck_pixel);
-                        if (ck_pixel == color_key)
-                            tmp.w = 0.0f;
-                    }
+static void area_filter_rows(const struct pixel_filter_job *job, unsigned int z, unsigned int y, unsigned int row_count)
+{
+    const struct pixel_format_desc *src_format = job->src_format, *dst_format = job->dst_format;
+    const struct filter_span *x_span, *y_span, *z_span = &job->z_spans[z];
+    unsigned int x, row, i, j, k;
+    struct vec4 sum, rgba;
+    const BYTE *src_ptr;
+    BYTE *dst_ptr;
+    float w;
 
-                    if (dst_format->from_rgba)
-                        dst_format->from_rgba(&tmp, &color);
-                    else
-                        color = tmp;
+    for (row = y; row < y + row_count; ++row)
+    {
+        y_span = &job->y_spans[row];
+        dst_ptr = job->dst + z * job->dst_slice_pitch + row * job->dst_row_pitch;
 
-                    format_from_vec4(dst_format, &color, dst_ptr);
-                }
+        for (x = 0; x < job->dst_size->width; ++x)
+        {
+            x_span = &job->x_spans[x];
+            sum.x = sum.y = sum.z = sum.w = 0.0f;
 
-                dst_ptr += dst_format->bytes_per_pixel;
+            for (k = 0; k < z_span->count; ++k)
+            {
+                for (j = 0; j < y_span->count; ++j)
+                {
+                    src_ptr = job->src + (z_span->first + k) * job->src_slice_pitch
+                            + (y_span->first + j) * job->src_row_pitch
+                            + x_span->first * src_format->bytes_per_pixel;
+                    for (i = 0; i < x_span->count; ++i)
+                    {
+                        w = z_span->weights[k] * y_span->weights[j] * x_span->weights[i];
+                        pixel_to_rgba(job, src_ptr, &rgba);
+                        sum.x += rgba.x * w;
+                        sum.y += rgba.y * w;
+                        sum.z += rgba.z * w;
+                        sum.w += rgba.w * w;
+                        src_ptr += src_format->bytes_per_pixel;
+                    }
+                }
             }
+
+            pixel_from_rgba(job, &sum, dst_ptr);
+            dst_ptr += dst_format->bytes_per_pixel;
         }
     }
 }
 
+/************************************************************
+ * box_filter_argb_pixels
+ *
+ * Copies the source buffer to the destination buffer, performing
+ * any necessary format conversion and color keying, and averaging
+ * the source pixels covered by each destination pixel, weighted by
+ * coverage. Enlarged images are point filtered.
+ */
+void box_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pitch, const struct volume *src_size,
+        const struct pixel_format_desc *src_format, BYTE *dst, UINT dst_row_pitch, UINT dst_slice_pitch,
+        const struct volume *dst_size, const struct pixel_format_desc *dst_format, D3DCOLOR color_key,
+        const PALETTEENTRY *palette)
+{
+    struct filter_span *x_spans = NULL, *y_spans = NULL, *z_spans = NULL;
+    struct pixel_filter_job job;
+
+    TRACE("src %p, src_row_pitch %u, src_slice_pitch %u, src_size %p, src_format %p, dst %p, "
+            "dst_row_pitch %u, dst_slice_pitch %u, dst_size %p, dst_format %p, color_key 0x%08x, palette %p.\n",
+            src, src_row_pitch, src_slice_pitch, src_size, src_format, dst, dst_row_pitch, dst_slice_pitch, dst_size,
+            dst_format, color_key, palette);
+
+    /* Nothing to average; this also keeps the exact conversions of the point
+     * filter for same size copies. */
+    if (dst_size->width >= src_size->width && dst_size->height >= src_size->height
+            && dst_size->depth >= src_size->depth)
+    {
+        point_filter_argb_pixels(src, src_row_pitch, src_slice_pitch, src_size, src_format,
+                dst, dst_row_pitch, dst_slice_pitch, dst_size, dst_format, color_key, palette);
+        return;
+    }
+
+    init_pixel_filter_job(&job, src, src_row_pitch, src_slice_pitch, src_size, src_format,
+            dst, dst_row_pitch, dst_slice_pitch, dst_size, dst_format, color_key, palette);
+
+    if (box_filter_supported(src_size, dst_size))
+    {
+        job.filter_rows = box_filter_rows;
+    }
+    else if ((x_spans = create_filter_spans(src_size->width, dst_size->width))
+            && (y_spans = create_filter_spans(src_size->height, dst_size->height))
+            && (z_spans = create_filter_spans(src_size->depth, dst_size->depth)))
+    {
+        job.filter_rows = area_filter_rows;
+        job.x_spans = x_spans;
+        job.y_spans = y_spans;
+        job.z_spans = z_spans;
+    }
+    else
+    {
+        ERR("Failed to allocate filter spans, using a point filter.\n");
+        job.filter_rows = point_filter_rows;
+    }
+
+    run_pixel_filter_job(&job, dst_size->width, dst_size->height, dst_size->depth);
+
+    heap_free(z_spans);
+    heap_free(y_spans);
+    heap_free(x_spans);
+}
+
 /************************************************************
  * D3DXLoadSurfaceFromMemory
  *
@@ -2072,13 +2426,19 @@ HRESULT WINAPI D3DXLoadSurfaceFromMemory(IDirect3DSurface9 *dst_surface,
             convert_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
                     dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette);
         }
+        else if ((filter & 0xf) == D3DX_FILTER_LINEAR || (filter & 0xf) == D3DX_FILTER_TRIANGLE
+                || (filter & 0xf) == D3DX_FILTER_BOX)
+        {
+            /* Linear and triangle filters are approximated with a box filter,
+             * which is exact for mipmap generation. */
+            box_filter_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
+                    dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette);
+        }
         else /* if ((filter & 0xf) == D3DX_FILTER_POINT) */
         {
             if ((filter & 0xf) != D3DX_FILTER_POINT)
                 FIXME("Unhandled filter %#x.\n", filter);
 
-            /* Always apply a point filter until D3DX_FILTER_LINEAR,
-             * D3DX_FILTER_TRIANGLE and D3DX_FILTER_BOX are implemented. */
             point_filter_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
                     dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette);
         }
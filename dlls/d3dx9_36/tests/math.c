@@ -3200,6 +3200,128 @@ static void test_D3DXVec_Array(void)
     }
 }
 
+static void test_D3DXVec_Array_stride(void)
+{
+    struct vertex
+    {
+        D3DXVECTOR3 position;
+        D3DCOLOR diffuse;
+        D3DXVECTOR3 normal;
+        float u, v;
+    } *vertices, *transformed;
+    static const unsigned int count = 4096;
+    LARGE_INTEGER frequency, start, end;
+    D3DXMATRIX mat, projection, view;
+    D3DXVECTOR3 exp_vec3, tmp;
+    D3DVIEWPORT9 viewport;
+    unsigned int i, j;
+    BOOL equal;
+
+    viewport.X = 10; viewport.Y = 5;
+    viewport.Width = 800; viewport.Height = 600;
+    viewport.MinZ = 0.0f; viewport.MaxZ = 1.0f;
+
+    set_matrix(&mat,
+            1.0f, 2.0f, 3.0f, 4.0f,
+            5.0f, 6.0f, 7.0f, 8.0f,
+            9.0f, 10.0f, 11.0f, 12.0f,
+            13.0f, 14.0f, 15.0f, 16.0f);
+    D3DXMatrixPerspectiveFovLH(&projection, D3DX_PI / 4.0f, 4.0f / 3.0f, 1.0f, 1000.0f);
+    D3DXMatrixTranslation(&view, 1.0f, -2.0f, 50.0f);
+
+    vertices = HeapAlloc(GetProcessHeap(), 0, count * sizeof(*vertices));
+    transformed = HeapAlloc(GetProcessHeap(), 0, count * sizeof(*transformed));
+    for (i = 0; i < count; ++i)
+    {
+        vertices[i].position.x = (i % 17) - 8.0f;
+        vertices[i].position.y = (i % 13) * 0.5f;
+        vertices[i].position.z = i * 0.01f;
+        vertices[i].diffuse = i;
+        vertices[i].normal.x = 1.0f / (i + 1);
+        vertices[i].normal.y = (i % 5) - 2.0f;
+        vertices[i].normal.z = 0.25f;
+        vertices[i].u = vertices[i].v = 0.5f;
+    }
+
+    /* Interleaved vertex data, transformed in place. */
+    memcpy(transformed, vertices, count * sizeof(*vertices));
+    D3DXVec3TransformCoordArray(&transformed->position, sizeof(*transformed),
+            &transformed->position, sizeof(*transformed), &mat, count);
+    D3DXVec3TransformNormalArray(&transformed->normal, sizeof(*transformed),
+            &transformed->normal, sizeof(*transformed), &mat, count);
+    for (i = 0; i < count; ++i)
+    {
+        D3DXVec3TransformCoord(&exp_vec3, &vertices[i].position, &mat);
+        equal = compare_vec3(&exp_vec3, &transformed[i].position, 0);
+        ok(equal, "Got unexpected position {%.8e, %.8e, %.8e} at index %u, expected {%.8e, %.8e, %.8e}.\n",
+                transformed[i].position.x, transformed[i].position.y, transformed[i].position.z, i,
+                exp_vec3.x, exp_vec3.y, exp_vec3.z);
+        if (!equal)
+            break;
+        D3DXVec3TransformNormal(&exp_vec3, &vertices[i].normal, &mat);
+        equal = compare_vec3(&exp_vec3, &transformed[i].normal, 0);
+        ok(equal, "Got unexpected normal {%.8e, %.8e, %.8e} at index %u, expected {%.8e, %.8e, %.8e}.\n",
+                transformed[i].normal.x, transformed[i].normal.y, transformed[i].normal.z, i,
+                exp_vec3.x, exp_vec3.y, exp_vec3.z);
+        if (!equal)
+            break;
+        ok(transformed[i].diffuse == i, "Got unexpected diffuse %#x at index %u.\n", transformed[i].diffuse, i);
+    }
+
+    D3DXVec3ProjectArray(&transformed->position, sizeof(*transformed), &vertices->position,
+            sizeof(*vertices), &viewport, &projection, &view, NULL, count);
+    for (i = 0; i < count; ++i)
+    {
+        D3DXVec3Project(&exp_vec3, &vertices[i].position, &viewport, &projection, &view, NULL);
+        equal = compare_vec3(&exp_vec3, &transformed[i].position, 0);
+        ok(equal, "Got unexpected vector {%.8e, %.8e, %.8e} at index %u, expected {%.8e, %.8e, %.8e}.\n",
+                transformed[i].position.x, transformed[i].position.y, transformed[i].position.z, i,
+                exp_vec3.x, exp_vec3.y, exp_vec3.z);
+        if (!equal)
+            break;
+    }
+
+    D3DXVec3UnprojectArray(&transformed->normal, sizeof(*transformed), &transformed->position,
+            sizeof(*transformed), &viewport, &projection, &view, NULL, count);
+    for (i = 0; i < count; ++i)
+    {
+        D3DXVec3Unproject(&tmp, &transformed[i].position, &viewport, &projection, &view, NULL);
+        equal = compare_vec3(&tmp, &transformed[i].normal, 0);
+        ok(equal, "Got unexpected vector {%.8e, %.8e, %.8e} at index %u, expected {%.8e, %.8e, %.8e}.\n",
+                transformed[i].normal.x, transformed[i].normal.y, transformed[i].normal.z, i,
+                tmp.x, tmp.y, tmp.z);
+        if (!equal)
+            break;
+    }
+
+    if (winetest_debug > 1)
+    {
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&start);
+        for (j = 0; j < 256; ++j)
+        {
+            D3DXVec3TransformCoordArray(&transformed->position, sizeof(*transformed),
+                    &vertices->position, sizeof(*vertices), &mat, count);
+            D3DXVec3TransformNormalArray(&transformed->normal, sizeof(*transformed),
+                    &vertices->normal, sizeof(*vertices), &mat, count);
+        }
+        QueryPerformanceCounter(&end);
+        trace("Transformed %u vertices in %.3f ms.\n", 256 * count,
+                (end.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart);
+
+        QueryPerformanceCounter(&start);
+        for (j = 0; j < 256; ++j)
+            D3DXVec3ProjectArray(&transformed->position, sizeof(*transformed), &vertices->position,
+                    sizeof(*vertices), &viewport, &projection, &view, NULL, count);
+        QueryPerformanceCounter(&end);
+        trace("Projected %u vertices in %.3f ms.\n", 256 * count,
+                (end.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart);
+    }
+
+    HeapFree(GetProcessHeap(), 0, transformed);
+    HeapFree(GetProcessHeap(), 0, vertices);
+}
+
 static void test_D3DXFloat_Array(void)
 {
     unsigned int i;
@@ -4379,6 +4501,7 @@ START_TEST(math)
     test_Matrix_Decompose();
     test_Matrix_Transformation2D();
     test_D3DXVec_Array();
+    test_D3DXVec_Array_stride();
     test_D3DXFloat_Array();
     test_D3DXSHAdd();
     test_D3DXSHDot();
@@ -4659,6 +4659,108 @@ static void D3DXGenerateAdjacencyTest(void)
     free_test_context(test_context);
 }
 
+/* A grid of n x n unwelded quads, as produced by importers that do not share
+ * vertices between faces. */
+static void test_generate_adjacency_large(void)
+{
+    static const unsigned int n = 256;
+    const DWORD num_faces = 2 * n * n, num_vertices = 4 * n * n;
+    LARGE_INTEGER frequency, start, end;
+    struct test_context *test_context;
+    D3DXWELDEPSILONS epsilons = {0};
+    DWORD *adjacency, *indices;
+    D3DXVECTOR3 *vertices;
+    unsigned int x, y, i;
+    ID3DXMesh *mesh;
+    HRESULT hr;
+
+    if (!(test_context = new_test_context()))
+    {
+        skip("Couldn't create test context\n");
+        return;
+    }
+
+    hr = D3DXCreateMeshFVF(num_faces, num_vertices, D3DXMESH_32BIT | D3DXMESH_SYSTEMMEM,
+            D3DFVF_XYZ, test_context->device, &mesh);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+
+    hr = mesh->lpVtbl->LockVertexBuffer(mesh, 0, (void **)&vertices);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    hr = mesh->lpVtbl->LockIndexBuffer(mesh, 0, (void **)&indices);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    for (y = 0; y < n; ++y)
+    {
+        for (x = 0; x < n; ++x)
+        {
+            DWORD base = 4 * (y * n + x);
+
+            vertices[base + 0].x = x;     vertices[base + 0].y = y;     vertices[base + 0].z = 0.0f;
+            vertices[base + 1].x = x + 1; vertices[base + 1].y = y;     vertices[base + 1].z = 0.0f;
+            vertices[base + 2].x = x + 1; vertices[base + 2].y = y + 1; vertices[base + 2].z = 0.0f;
+            vertices[base + 3].x = x;     vertices[base + 3].y = y + 1; vertices[base + 3].z = 0.0f;
+            indices[6 * (y * n + x) + 0] = base + 0;
+            indices[6 * (y * n + x) + 1] = base + 1;
+            indices[6 * (y * n + x) + 2] = base + 2;
+            indices[6 * (y * n + x) + 3] = base + 0;
+            indices[6 * (y * n + x) + 4] = base + 2;
+            indices[6 * (y * n + x) + 5] = base + 3;
+        }
+    }
+    mesh->lpVtbl->UnlockIndexBuffer(mesh);
+    mesh->lpVtbl->UnlockVertexBuffer(mesh);
+
+    adjacency = HeapAlloc(GetProcessHeap(), 0, 3 * num_faces * sizeof(*adjacency));
+
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+    hr = mesh->lpVtbl->GenerateAdjacency(mesh, 1.0e-6f, adjacency);
+    QueryPerformanceCounter(&end);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    if (winetest_debug > 1)
+        trace("Generated adjacency for %u faces in %.3f ms.\n", num_faces,
+                (end.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart);
+
+    for (y = 0; y < n; ++y)
+    {
+        for (x = 0; x < n; ++x)
+        {
+            DWORD face = 2 * (y * n + x);
+            DWORD expected[6];
+
+            expected[0] = y > 0 ? 2 * ((y - 1) * n + x) + 1 : ~0u;
+            expected[1] = x < n - 1 ? 2 * (y * n + x + 1) + 1 : ~0u;
+            expected[2] = face + 1;
+            expected[3] = face;
+            expected[4] = y < n - 1 ? 2 * ((y + 1) * n + x) : ~0u;
+            expected[5] = x > 0 ? 2 * (y * n + x - 1) : ~0u;
+            for (i = 0; i < 6; ++i)
+            {
+                if (adjacency[3 * face + i] != expected[i])
+                {
+                    ok(0, "Quad %u,%u: got unexpected adjacency %u for edge %u, expected %u.\n",
+                            x, y, adjacency[3 * face + i], i, expected[i]);
+                    goto done;
+                }
+            }
+        }
+    }
+
+    QueryPerformanceCounter(&start);
+    hr = D3DXWeldVertices(mesh, D3DXWELDEPSILONS_WELDALL, &epsilons, adjacency, NULL, NULL, NULL);
+    QueryPerformanceCounter(&end);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    if (winetest_debug > 1)
+        trace("Welded %u vertices in %.3f ms.\n", num_vertices,
+                (end.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart);
+    ok(mesh->lpVtbl->GetNumVertices(mesh) == (n + 1) * (n + 1), "Got unexpected vertex count %u.\n",
+            mesh->lpVtbl->GetNumVertices(mesh));
+
+done:
+    HeapFree(GetProcessHeap(), 0, adjacency);
+    mesh->lpVtbl->Release(mesh);
+    free_test_context(test_context);
+}
+
 static void test_update_semantics(void)
 {
     HRESULT hr;
@@ -11486,6 +11588,7 @@ START_TEST(mesh)
     test_get_decl_vertex_size();
     test_fvf_decl_conversion();
     D3DXGenerateAdjacencyTest();
+    test_generate_adjacency_large();
     test_update_semantics();
     test_create_skin_info();
     test_convert_adjacency_to_point_reps();
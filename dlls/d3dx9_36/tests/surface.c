@@ -1524,6 +1524,106 @@ static void test_D3DXLoadSurface(IDirect3DDevice9 *device)
     if(testbitmap_ok) DeleteFileA("testbitmap.bmp");
 }
 
+static BOOL compare_uint(unsigned int x, unsigned int y, unsigned int max_diff)
+{
+    unsigned int diff = x > y ? x - y : y - x;
+
+    return diff <= max_diff;
+}
+
+static BOOL compare_color(DWORD c1, DWORD c2, BYTE max_diff)
+{
+    return compare_uint(c1 & 0xff, c2 & 0xff, max_diff)
+            && compare_uint((c1 >> 8) & 0xff, (c2 >> 8) & 0xff, max_diff)
+            && compare_uint((c1 >> 16) & 0xff, (c2 >> 16) & 0xff, max_diff)
+            && compare_uint((c1 >> 24) & 0xff, (c2 >> 24) & 0xff, max_diff);
+}
+
+static void test_D3DXLoadSurface_box_filter(IDirect3DDevice9 *device)
+{
+    /* Each 2x2 block averages to 0x204060 in its RGB channels. */
+    static const DWORD pixels[] =
+    {
+        0xff103050, 0xff305070, 0x80103050, 0x80305070,
+        0xff305070, 0xff103050, 0x80305070, 0x80103050,
+        0x00204060, 0x00204060, 0xff000000, 0xff406080,
+        0x00204060, 0x00204060, 0xff406080, 0xff000000,
+    };
+    static const BYTE expected[] = {0x60, 0x40, 0x20};
+    IDirect3DSurface9 *surface;
+    DWORD pixels3[6 * 3], color;
+    D3DLOCKED_RECT lock_rect;
+    unsigned int x, y;
+    const BYTE *row;
+    RECT rect;
+    HRESULT hr;
+
+    hr = IDirect3DDevice9_CreateOffscreenPlainSurface(device, 2, 2, D3DFMT_R8G8B8, D3DPOOL_SCRATCH, &surface, NULL);
+    if (FAILED(hr))
+    {
+        skip("Failed to create R8G8B8 surface, hr %#x.\n", hr);
+        return;
+    }
+
+    /* Fill the surface so that writes past the end of a row show up. */
+    hr = IDirect3DSurface9_LockRect(surface, &lock_rect, NULL, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    for (y = 0; y < 2; ++y)
+        memset((BYTE *)lock_rect.pBits + y * lock_rect.Pitch, 0xcc, lock_rect.Pitch);
+    IDirect3DSurface9_UnlockRect(surface);
+
+    SetRect(&rect, 0, 0, 4, 4);
+    hr = D3DXLoadSurfaceFromMemory(surface, NULL, NULL, pixels, D3DFMT_A8R8G8B8,
+            4 * sizeof(*pixels), NULL, &rect, D3DX_FILTER_BOX, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+
+    hr = IDirect3DSurface9_LockRect(surface, &lock_rect, NULL, D3DLOCK_READONLY);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    for (y = 0; y < 2; ++y)
+    {
+        row = (const BYTE *)lock_rect.pBits + y * lock_rect.Pitch;
+        for (x = 0; x < 2; ++x)
+            ok(!memcmp(row + x * 3, expected, sizeof(expected)),
+                    "Got unexpected pixel (%u,%u) %02x%02x%02x.\n", x, y, row[x * 3 + 2], row[x * 3 + 1], row[x * 3]);
+        for (x = 6; x < lock_rect.Pitch; ++x)
+            ok(row[x] == 0xcc, "Row %u byte %u was overwritten with %#x.\n", y, x, row[x]);
+    }
+    IDirect3DSurface9_UnlockRect(surface);
+
+    check_release((IUnknown *)surface, 0);
+
+    /* 3:1 reduction. Each 3x3 block averages to its center pixel, while its
+     * top left pixel is different. */
+    for (y = 0; y < 3; ++y)
+    {
+        for (x = 0; x < 6; ++x)
+        {
+            static const int pattern[3][3] = {{-1, 0, 1}, {0, 0, 0}, {1, 0, -1}};
+            DWORD v = (x < 3 ? 0x40 : 0xc0) + pattern[y][x % 3] * 0x20;
+
+            pixels3[y * 6 + x] = 0xff000000 | v << 16 | v << 8 | v;
+        }
+    }
+
+    hr = IDirect3DDevice9_CreateOffscreenPlainSurface(device, 2, 1, D3DFMT_A8R8G8B8, D3DPOOL_SCRATCH, &surface, NULL);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+
+    SetRect(&rect, 0, 0, 6, 3);
+    hr = D3DXLoadSurfaceFromMemory(surface, NULL, NULL, pixels3, D3DFMT_A8R8G8B8,
+            6 * sizeof(*pixels3), NULL, &rect, D3DX_FILTER_BOX, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+
+    hr = IDirect3DSurface9_LockRect(surface, &lock_rect, NULL, D3DLOCK_READONLY);
+    ok(hr == D3D_OK, "Got unexpected hr %#x.\n", hr);
+    color = ((const DWORD *)lock_rect.pBits)[0];
+    ok(compare_color(color, 0xff404040, 1), "Got unexpected color 0x%08x.\n", color);
+    color = ((const DWORD *)lock_rect.pBits)[1];
+    ok(compare_color(color, 0xffc0c0c0, 1), "Got unexpected color 0x%08x.\n", color);
+    IDirect3DSurface9_UnlockRect(surface);
+
+    check_release((IUnknown *)surface, 0);
+}
+
 static void test_D3DXSaveSurfaceToFileInMemory(IDirect3DDevice9 *device)
 {
     static const struct
@@ -1787,6 +1887,7 @@ START_TEST(surface)
 
     test_D3DXGetImageInfo();
     test_D3DXLoadSurface(device);
+    test_D3DXLoadSurface_box_filter(device);
     test_D3DXSaveSurfaceToFileInMemory(device);
     test_D3DXSaveSurfaceToFile(device);
 
@@ -1058,6 +1058,83 @@ static void test_D3DXFilterTexture(IDirect3DDevice9 *device)
         skip("Failed to create texture\n");
 }
 
+static void test_D3DXFilterTexture_box(IDirect3DDevice9 *device)
+{
+    static const BYTE offsets[] = {0, 2, 4, 6};
+    LARGE_INTEGER frequency, start, end;
+    unsigned int size, x, y, i, level;
+    D3DLOCKED_RECT lock_rect;
+    IDirect3DTexture9 *tex;
+    HRESULT hr;
+
+    for (size = 16; size <= 2048; size *= 128)
+    {
+        hr = IDirect3DDevice9_CreateTexture(device, size, size, 0, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &tex, NULL);
+        if (FAILED(hr))
+        {
+            skip("Failed to create %ux%u texture, hr %#x.\n", size, size, hr);
+            continue;
+        }
+
+        /* Each 2x2 block averages to a value without rounding. */
+        hr = IDirect3DTexture9_LockRect(tex, 0, &lock_rect, NULL, 0);
+        ok(hr == D3D_OK, "Failed to lock texture, hr %#x.\n", hr);
+        for (y = 0; y < size; ++y)
+        {
+            DWORD *row = (DWORD *)((BYTE *)lock_rect.pBits + y * lock_rect.Pitch);
+
+            for (x = 0; x < size; ++x)
+            {
+                BYTE base = ((x / 2 + y / 2) & 0x3f) * 3, offset = offsets[(x & 1) + 2 * (y & 1)];
+
+                row[x] = 0xff000000 | (base + offset) << 16 | (0xf0 - base) << 8 | (base + 6 - offset);
+            }
+        }
+        IDirect3DTexture9_UnlockRect(tex, 0);
+
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&start);
+        hr = D3DXFilterTexture((IDirect3DBaseTexture9 *)tex, NULL, 0, D3DX_FILTER_BOX);
+        QueryPerformanceCounter(&end);
+        ok(hr == D3D_OK, "D3DXFilterTexture returned %#x.\n", hr);
+        if (winetest_debug > 1)
+            trace("Box filtered %u levels of a %ux%u texture in %.3f ms.\n", IDirect3DTexture9_GetLevelCount(tex),
+                    size, size, (end.QuadPart - start.QuadPart) * 1000.0 / frequency.QuadPart);
+
+        level = 1;
+        hr = IDirect3DTexture9_LockRect(tex, level, &lock_rect, NULL, D3DLOCK_READONLY);
+        ok(hr == D3D_OK, "Failed to lock texture, hr %#x.\n", hr);
+        for (y = 0; y < size / 2; ++y)
+        {
+            const DWORD *row = (const DWORD *)((BYTE *)lock_rect.pBits + y * lock_rect.Pitch);
+
+            for (x = 0; x < size / 2; ++x)
+            {
+                BYTE base = ((x + y) & 0x3f) * 3;
+                DWORD expected = 0xff000000 | (base + 3) << 16 | (0xf0 - base) << 8 | (base + 3);
+
+                for (i = 0; i < 32; i += 8)
+                {
+                    int diff = ((row[x] >> i) & 0xff) - ((expected >> i) & 0xff);
+
+                    if (diff < -1 || diff > 1)
+                        break;
+                }
+                if (i < 32)
+                    break;
+            }
+            if (x < size / 2)
+            {
+                ok(0, "Got unexpected color 0x%08x at (%u, %u) of level %u, size %u.\n", row[x], x, y, level, size);
+                break;
+            }
+        }
+        IDirect3DTexture9_UnlockRect(tex, level);
+
+        IDirect3DTexture9_Release(tex);
+    }
+}
+
 static BOOL color_match(const DWORD *value, const DWORD *expected)
 {
     int i;
@@ -2606,6 +2683,7 @@ START_TEST(texture)
     test_D3DXCheckVolumeTextureRequirements(device);
     test_D3DXCreateTexture(device);
     test_D3DXFilterTexture(device);
+    test_D3DXFilterTexture_box(device);
     test_D3DXFillTexture(device);
     test_D3DXFillCubeTexture(device);
     test_D3DXFillVolumeTexture(device);
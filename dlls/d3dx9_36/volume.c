@@ -207,6 +207,13 @@ HRESULT WINAPI D3DXLoadVolumeFromMemory(IDirect3DVolume9 *dst_volume,
                     locked_box.pBits, locked_box.RowPitch, locked_box.SlicePitch, &dst_size, dst_format_desc, color_key,
                     src_palette);
         }
+        else if ((filter & 0xf) == D3DX_FILTER_LINEAR || (filter & 0xf) == D3DX_FILTER_TRIANGLE
+                || (filter & 0xf) == D3DX_FILTER_BOX)
+        {
+            box_filter_argb_pixels(src_addr, src_row_pitch, src_slice_pitch, &src_size, src_format_desc,
+                    locked_box.pBits, locked_box.RowPitch, locked_box.SlicePitch, &dst_size, dst_format_desc, color_key,
+                    src_palette);
+        }
         else
         {
             if ((filter & 0xf) != D3DX_FILTER_POINT)
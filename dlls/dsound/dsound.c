@@ -207,6 +207,7 @@ static ULONG DirectSoundDevice_Release(DirectSoundDevice * device)
             WaitForSingleObject(device->thread, INFINITE);
             CloseHandle(device->thread);
         }
+        DSOUND_StopMixWorkers(device);
 
         EnterCriticalSection(&DSOUND_renderers_lock);
         list_remove(&device->entry);
@@ -234,8 +235,8 @@ static ULONG DirectSoundDevice_Release(DirectSoundDevice * device)
         if(device->mmdevice)
             IMMDevice_Release(device->mmdevice);
         CloseHandle(device->sleepev);
-        HeapFree(GetProcessHeap(), 0, device->tmp_buffer);
-        HeapFree(GetProcessHeap(), 0, device->cp_buffer);
+        HeapFree(GetProcessHeap(), 0, device->scratch.tmp_buffer);
+        HeapFree(GetProcessHeap(), 0, device->scratch.cp_buffer);
         HeapFree(GetProcessHeap(), 0, device->buffer);
         device->mixlock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&device->mixlock);
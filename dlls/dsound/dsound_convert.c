@@ -70,6 +70,18 @@ static float get16(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel)
     return sample / (float)0x8000;
 }
 
+void get16_frames(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, UINT count, float *dst)
+{
+    const BYTE* buf = dsb->buffer->memory + pos + 2 * channel;
+    UINT istride = dsb->pwfx->nBlockAlign;
+
+    while (count--)
+    {
+        *dst++ = (SHORT)le16(*(const SHORT*)buf) / (float)0x8000;
+        buf += istride;
+    }
+}
+
 static float get24(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel)
 {
     LONG sample;
@@ -150,14 +162,14 @@ static inline LONG f_to_32(float value)
 
 void putieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value)
 {
-    BYTE *buf = (BYTE *)dsb->device->tmp_buffer;
+    BYTE *buf = (BYTE *)dsb->scratch->tmp_buffer;
     float *fbuf = (float*)(buf + pos + sizeof(float) * channel);
     *fbuf = value;
 }
 
 void putieee32_sum(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value)
 {
-    BYTE *buf = (BYTE *)dsb->device->tmp_buffer;
+    BYTE *buf = (BYTE *)dsb->scratch->tmp_buffer;
     float *fbuf = (float*)(buf + pos + sizeof(float) * channel);
     *fbuf += value;
 }
@@ -46,6 +46,7 @@ typedef struct DirectSoundDevice             DirectSoundDevice;
 typedef float (*bitsgetfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD);
 typedef void (*bitsputfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD, float);
 extern const bitsgetfunc getbpp[5] DECLSPEC_HIDDEN;
+void get16_frames(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, UINT count, float *dst) DECLSPEC_HIDDEN;
 void putieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value) DECLSPEC_HIDDEN;
 void putieee32_sum(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value) DECLSPEC_HIDDEN;
 void mixieee32(float *src, float *dst, unsigned samples) DECLSPEC_HIDDEN;
@@ -65,6 +66,26 @@ typedef struct DSFilter {
     IMediaObjectInPlace* inplace;
 } DSFilter;
 
+/* scratch buffers used to mix secondary buffers, one set per mixing thread */
+typedef struct DSMixScratch
+{
+    float *tmp_buffer, *cp_buffer, *mix_buffer;
+    DWORD  tmp_buffer_len, cp_buffer_len, mix_buffer_len;
+} DSMixScratch;
+
+#define DS_MAX_MIX_WORKERS 3
+
+/* helper thread mixing a range of the device's buffers into its own accumulator */
+typedef struct DSMixWorker
+{
+    DirectSoundDevice          *device;
+    DSMixScratch                scratch;
+    HANDLE                      thread, start;
+    int                         first, last;
+    DWORD                       frames;
+    BOOL                        mixed;
+} DSMixWorker;
+
 /*****************************************************************************
  * IDirectSoundDevice implementation structure
  */
@@ -88,8 +109,12 @@ struct DirectSoundDevice
     int                         speaker_num[DS_MAX_CHANNELS];
     int                         num_speakers;
     int                         lfe_channel;
-    float *tmp_buffer, *cp_buffer;
-    DWORD                       tmp_buffer_len, cp_buffer_len;
+    DSMixScratch                scratch;
+    DSMixWorker                 workers[DS_MAX_MIX_WORKERS];
+    int                         num_workers;
+    LONG                        workers_pending;
+    HANDLE                      workers_done;
+    BOOL                        workers_quit;
 
     DSVOLUMEPAN                 volpan;
 
@@ -149,10 +174,13 @@ struct IDirectSoundBufferImpl
     ULONG                       freqneeded;
     DWORD                       firstep;
     float                       firgain;
+    float                      *fir_bank;
+    DWORD                       fir_bank_step, fir_bank_row_len;
     LONG64                      freqAdjustNum,freqAdjustDen;
     LONG64                      freqAccNum;
     /* used for mixing */
     DWORD                       sec_mixpos;
+    DSMixScratch               *scratch;    /* of the thread currently mixing the buffer */
 
     /* IDirectSoundNotify fields */
     LPDSBPOSITIONNOTIFY         notifies;
@@ -229,6 +257,7 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb) DECLSPEC_HIDDEN;
 DWORD DSOUND_secpos_to_bufpos(const IDirectSoundBufferImpl *dsb, DWORD secpos, DWORD secmixpos, float *overshot) DECLSPEC_HIDDEN;
 
 DWORD CALLBACK DSOUND_mixthread(void *ptr) DECLSPEC_HIDDEN;
+void DSOUND_StopMixWorkers(DirectSoundDevice *device) DECLSPEC_HIDDEN;
 
 /* sound3d.c */
 
@@ -283,11 +283,43 @@ static inline float get_current_sample(const IDirectSoundBufferImpl *dsb,
     return dsb->get(dsb, mixpos % dsb->buflen, channel);
 }
 
+/**
+ * Read count consecutive frames of one channel into dst, as floats.
+ */
+static void get_current_samples(const IDirectSoundBufferImpl *dsb, DWORD mixpos,
+        DWORD channel, UINT count, float *dst)
+{
+    UINT istride = dsb->pwfx->nBlockAlign;
+    UINT i;
+
+    if (dsb->get == getbpp[1] && mixpos + count * istride <= dsb->buflen)
+    {
+        /* 16-bit PCM, no wrap-around: skip the per-sample conversion call */
+        get16_frames(dsb, mixpos, channel, count, dst);
+        return;
+    }
+
+    for (i = 0; i < count; i++)
+        dst[i] = get_current_sample(dsb, mixpos + i * istride, channel);
+}
+
 static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
 {
     UINT istride = dsb->pwfx->nBlockAlign;
-    UINT ostride = dsb->device->pwfx->nChannels * sizeof(float);
+    UINT ochannels = dsb->device->pwfx->nChannels;
+    UINT ostride = ochannels * sizeof(float);
     DWORD channel, i;
+
+    if (dsb->put == putieee32)
+    {
+        /* same channel layout, write the samples directly */
+        float *out = dsb->scratch->tmp_buffer;
+        for (i = 0; i < count; i++, out += ochannels)
+            for (channel = 0; channel < dsb->mix_channels; channel++)
+                out[channel] = get_current_sample(dsb, dsb->sec_mixpos + i * istride, channel);
+        return count;
+    }
+
     for (i = 0; i < count; i++)
         for (channel = 0; channel < dsb->mix_channels; channel++)
             dsb->put(dsb, i * ostride, channel, get_current_sample(dsb,
@@ -295,11 +327,76 @@ static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
     return count;
 }
 
+/**
+ * Build the polyphase filter bank for the current FIR step.
+ *
+ * Row r holds fir[r], fir[r + firstep], fir[r + 2 * firstep], ... padded
+ * with zeroes, so that the taps used for one output sample are contiguous
+ * in memory instead of being firstep floats apart. The bank only depends
+ * on firstep, so it is rebuilt only when the frequency ratio changes.
+ */
+static BOOL update_fir_bank(IDirectSoundBufferImpl *dsb)
+{
+    UINT step = dsb->firstep, row_len = (fir_len + step - 1) / step;
+    UINT r, k;
+    float *bank;
+
+    if (dsb->fir_bank && dsb->fir_bank_step == step)
+        return TRUE;
+
+    TRACE("building filter bank for step %u, %u taps per phase\n", step, row_len);
+
+    if (!(bank = HeapAlloc(GetProcessHeap(), 0, (step + 1) * row_len * sizeof(float))))
+        return FALSE;
+    for (r = 0; r <= step; r++)
+        for (k = 0; k < row_len; k++)
+            bank[r * row_len + k] = r + k * step < fir_len ? fir[r + k * step] : 0.0f;
+
+    HeapFree(GetProcessHeap(), 0, dsb->fir_bank);
+    dsb->fir_bank = bank;
+    dsb->fir_bank_step = step;
+    dsb->fir_bank_row_len = row_len;
+    return TRUE;
+}
+
+/**
+ * Multiply-accumulate kernels. The independent partial sums let the
+ * compiler keep several vector lanes busy instead of serializing every
+ * addition on a single accumulator.
+ */
+static inline void fir_interpolate(float *dst, const float *row0, const float *row1,
+        float rem, UINT len)
+{
+    float rem0 = 1.0f - rem;
+    UINT j;
+
+    for (j = 0; j < len; j++)
+        dst[j] = row0[j] * rem0 + row1[j] * rem;
+}
+
+static inline float fir_dot(const float *coef, const float *input, UINT len)
+{
+    float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+    UINT j;
+
+    for (j = 0; j + 4 <= len; j += 4)
+    {
+        sum0 += coef[j] * input[j];
+        sum1 += coef[j + 1] * input[j + 1];
+        sum2 += coef[j + 2] * input[j + 2];
+        sum3 += coef[j + 3] * input[j + 3];
+    }
+    for (; j < len; j++)
+        sum0 += coef[j] * input[j];
+
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
 static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *freqAccNum)
 {
     UINT i, channel;
-    UINT istride = dsb->pwfx->nBlockAlign;
-    UINT ostride = dsb->device->pwfx->nChannels * sizeof(float);
+    UINT ochannels = dsb->device->pwfx->nChannels;
+    UINT ostride = ochannels * sizeof(float);
 
     LONG64 freqAcc_start = *freqAccNum;
     LONG64 freqAcc_end = freqAcc_start + count * dsb->freqAdjustNum;
@@ -309,21 +406,27 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
 
     UINT fir_cachesize = (fir_len + dsbfirstep - 2) / dsbfirstep;
     UINT required_input = max_ipos + fir_cachesize;
-    float *intermediate, *fir_copy, *itmp;
+    UINT row_len;
+    float *intermediate, *fir_copy, *out = dsb->scratch->tmp_buffer;
+    BOOL direct = dsb->put == putieee32;
 
     DWORD len = required_input * channels;
     len += fir_cachesize;
     len *= sizeof(float);
 
-    if (!dsb->device->cp_buffer) {
-        dsb->device->cp_buffer = HeapAlloc(GetProcessHeap(), 0, len);
-        dsb->device->cp_buffer_len = len;
-    } else if (len > dsb->device->cp_buffer_len) {
-        dsb->device->cp_buffer = HeapReAlloc(GetProcessHeap(), 0, dsb->device->cp_buffer, len);
-        dsb->device->cp_buffer_len = len;
+    if (!update_fir_bank(dsb))
+        return max_ipos;
+    row_len = dsb->fir_bank_row_len;
+
+    if (!dsb->scratch->cp_buffer) {
+        dsb->scratch->cp_buffer = HeapAlloc(GetProcessHeap(), 0, len);
+        dsb->scratch->cp_buffer_len = len;
+    } else if (len > dsb->scratch->cp_buffer_len) {
+        dsb->scratch->cp_buffer = HeapReAlloc(GetProcessHeap(), 0, dsb->scratch->cp_buffer, len);
+        dsb->scratch->cp_buffer_len = len;
     }
 
-    fir_copy = dsb->device->cp_buffer;
+    fir_copy = dsb->scratch->cp_buffer;
     intermediate = fir_copy + fir_cachesize;
 
 
@@ -331,11 +434,9 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
      * if you want -msse3 to have any effect.
      * This is good for CPU cache effects, too.
      */
-    itmp = intermediate;
     for (channel = 0; channel < channels; channel++)
-        for (i = 0; i < required_input; i++)
-            *(itmp++) = get_current_sample(dsb,
-                    dsb->sec_mixpos + i * istride, channel);
+        get_current_samples(dsb, dsb->sec_mixpos, channel, required_input,
+                intermediate + channel * required_input);
 
     for(i = 0; i < count; ++i) {
         UINT int_fir_steps = (freqAcc_start + i * dsb->freqAdjustNum) * dsbfirstep / dsb->freqAdjustDen;
@@ -345,22 +446,21 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
         UINT idx = (ipos + 1) * dsbfirstep - int_fir_steps - 1;
         float rem = int_fir_steps + 1.0 - total_fir_steps;
 
-        int fir_used = 0;
-        while (idx < fir_len - 1) {
-            fir_copy[fir_used++] = fir[idx] * (1.0 - rem) + fir[idx + 1] * rem;
-            idx += dsb->firstep;
-        }
+        /* number of taps with idx + j * firstep < fir_len - 1 */
+        UINT fir_used = idx < fir_len - 1 ? (fir_len - 2 - idx) / dsbfirstep + 1 : 0;
+        const float *row = dsb->fir_bank + idx * row_len;
 
         assert(fir_used <= fir_cachesize);
         assert(ipos + fir_used <= required_input);
 
-        for (channel = 0; channel < dsb->mix_channels; channel++) {
-            int j;
-            float sum = 0.0;
-            float* cache = &intermediate[channel * required_input + ipos];
-            for (j = 0; j < fir_used; j++)
-                sum += fir_copy[j] * cache[j];
-            dsb->put(dsb, i * ostride, channel, sum * dsb->firgain);
+        fir_interpolate(fir_copy, row, row + row_len, rem, fir_used);
+
+        for (channel = 0; channel < channels; channel++) {
+            float sum = fir_dot(fir_copy, &intermediate[channel * required_input + ipos], fir_used);
+            if (direct)
+                out[i * ochannels + channel] = sum * dsb->firgain;
+            else
+                dsb->put(dsb, i * ostride, channel, sum * dsb->firgain);
         }
     }
 
@@ -425,23 +525,23 @@ static void DSOUND_MixToTemporary(IDirectSoundBufferImpl *dsb, DWORD frames)
 	HRESULT hr;
 	int i;
 
-	if (dsb->device->tmp_buffer_len < size_bytes || !dsb->device->tmp_buffer)
+	if (dsb->scratch->tmp_buffer_len < size_bytes || !dsb->scratch->tmp_buffer)
 	{
-		dsb->device->tmp_buffer_len = size_bytes;
-		if (dsb->device->tmp_buffer)
-			dsb->device->tmp_buffer = HeapReAlloc(GetProcessHeap(), 0, dsb->device->tmp_buffer, size_bytes);
+		dsb->scratch->tmp_buffer_len = size_bytes;
+		if (dsb->scratch->tmp_buffer)
+			dsb->scratch->tmp_buffer = HeapReAlloc(GetProcessHeap(), 0, dsb->scratch->tmp_buffer, size_bytes);
 		else
-			dsb->device->tmp_buffer = HeapAlloc(GetProcessHeap(), 0, size_bytes);
+			dsb->scratch->tmp_buffer = HeapAlloc(GetProcessHeap(), 0, size_bytes);
 	}
 	if(dsb->put_aux == putieee32_sum)
-		memset(dsb->device->tmp_buffer, 0, dsb->device->tmp_buffer_len);
+		memset(dsb->scratch->tmp_buffer, 0, dsb->scratch->tmp_buffer_len);
 
 	cp_fields(dsb, frames, &dsb->freqAccNum);
 
 	if (size_bytes > 0) {
 		for (i = 0; i < dsb->num_filters; i++) {
 			if (dsb->filters[i].inplace) {
-				hr = IMediaObjectInPlace_Process(dsb->filters[i].inplace, size_bytes, (BYTE*)dsb->device->tmp_buffer, 0, DMO_INPLACE_NORMAL);
+				hr = IMediaObjectInPlace_Process(dsb->filters[i].inplace, size_bytes, (BYTE*)dsb->scratch->tmp_buffer, 0, DMO_INPLACE_NORMAL);
 
 				if (FAILED(hr))
 					WARN("IMediaObjectInPlace_Process failed for filter %u\n", i);
@@ -477,7 +577,7 @@ static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
 
 	for(i = 0; i < frames; ++i){
 		for(chan = 0; chan < channels; ++chan){
-			dsb->device->tmp_buffer[i * channels + chan] *= vols[chan];
+			dsb->scratch->tmp_buffer[i * channels + chan] *= vols[chan];
 		}
 	}
 }
@@ -505,7 +605,7 @@ static DWORD DSOUND_MixInBuffer(IDirectSoundBufferImpl *dsb, float *mix_buffer,
 	/* Resample buffer to temporary buffer specifically allocated for this purpose, if needed */
 	oldpos = dsb->sec_mixpos;
 	DSOUND_MixToTemporary(dsb, frames);
-	ibuf = dsb->device->tmp_buffer;
+	ibuf = dsb->scratch->tmp_buffer;
 
 	/* Apply volume if needed */
 	DSOUND_MixerVol(dsb, frames);
@@ -566,26 +666,23 @@ static DWORD DSOUND_MixOne(IDirectSoundBufferImpl *dsb, float *mix_buffer, DWORD
 	return primary_done;
 }
 
+/* below this many buffers the serial mix is cheaper than waking up the workers */
+#define DS_PARALLEL_MIX_MIN_BUFFERS 16
+
 /**
- * For a DirectSoundDevice, go through all the currently playing buffers and
- * mix them in to the device buffer.
- *
- * frames = the maximum amount to mix into the primary buffer
- * all_stopped = reports back if all buffers have stopped
+ * Mix the playing buffers device->buffers[first..last) into mix_buffer,
+ * using the given scratch buffers.
  *
- * Returns:  the length beyond the writepos that was mixed to.
+ * Returns: TRUE if any buffer was mixed.
  */
-
-static void DSOUND_MixToPrimary(const DirectSoundDevice *device, float *mix_buffer, DWORD frames, BOOL *all_stopped)
+static BOOL DSOUND_MixRange(const DirectSoundDevice *device, DSMixScratch *scratch, float *mix_buffer,
+		DWORD frames, int first, int last)
 {
 	INT i;
 	IDirectSoundBufferImpl	*dsb;
+	BOOL mixed = FALSE;
 
-	/* unless we find a running buffer, all have stopped */
-	*all_stopped = TRUE;
-
-	TRACE("(frames %d)\n", frames);
-	for (i = 0; i < device->nrofbuffers; i++) {
+	for (i = first; i < last; i++) {
 		dsb = device->buffers[i];
 
 		TRACE("MixToPrimary for %p, state=%d\n", dsb, dsb->state);
@@ -604,13 +701,172 @@ static void DSOUND_MixToPrimary(const DirectSoundDevice *device, float *mix_buff
 					dsb->state = STATE_PLAYING;
 
 				/* mix next buffer into the main buffer */
+				dsb->scratch = scratch;
 				DSOUND_MixOne(dsb, mix_buffer, frames);
+				dsb->scratch = NULL;
 
-				*all_stopped = FALSE;
+				mixed = TRUE;
 			}
 			ReleaseSRWLockShared(&dsb->lock);
 		}
 	}
+	return mixed;
+}
+
+static DWORD CALLBACK DSOUND_mixworker(void *p)
+{
+	DSMixWorker *worker = p;
+	DirectSoundDevice *device = worker->device;
+	DWORD len;
+
+	TRACE("(%p)\n", worker);
+
+	for (;;) {
+		WaitForSingleObject(worker->start, INFINITE);
+		if (device->workers_quit)
+			break;
+
+		len = worker->frames * device->pwfx->nChannels * sizeof(float);
+		if (worker->scratch.mix_buffer_len < len) {
+			HeapFree(GetProcessHeap(), 0, worker->scratch.mix_buffer);
+			worker->scratch.mix_buffer = HeapAlloc(GetProcessHeap(), 0, len);
+			worker->scratch.mix_buffer_len = worker->scratch.mix_buffer ? len : 0;
+		}
+
+		if (worker->scratch.mix_buffer) {
+			memset(worker->scratch.mix_buffer, 0, len);
+			worker->mixed = DSOUND_MixRange(device, &worker->scratch, worker->scratch.mix_buffer,
+					worker->frames, worker->first, worker->last);
+		} else {
+			ERR("out of memory, skipping buffers %d-%d\n", worker->first, worker->last - 1);
+			worker->mixed = FALSE;
+		}
+
+		if (!InterlockedDecrement(&device->workers_pending))
+			SetEvent(device->workers_done);
+	}
+	return 0;
+}
+
+static BOOL DSOUND_StartMixWorkers(DirectSoundDevice *device)
+{
+	SYSTEM_INFO info;
+	int i, count;
+
+	if (device->num_workers)
+		return TRUE;
+	if (device->workers_quit)
+		return FALSE;
+
+	GetSystemInfo(&info);
+	count = min(info.dwNumberOfProcessors - 1, DS_MAX_MIX_WORKERS);
+	if (count <= 0 || !(device->workers_done = CreateEventW(NULL, FALSE, FALSE, NULL))) {
+		/* don't try again */
+		device->workers_quit = TRUE;
+		return FALSE;
+	}
+
+	for (i = 0; i < count; i++) {
+		DSMixWorker *worker = &device->workers[i];
+
+		worker->device = device;
+		if (!(worker->start = CreateEventW(NULL, FALSE, FALSE, NULL)))
+			break;
+		if (!(worker->thread = CreateThread(NULL, 0, DSOUND_mixworker, worker, 0, NULL))) {
+			CloseHandle(worker->start);
+			break;
+		}
+		SetThreadPriority(worker->thread, THREAD_PRIORITY_TIME_CRITICAL);
+	}
+	device->num_workers = i;
+	TRACE("started %d mixing workers\n", device->num_workers);
+
+	if (!device->num_workers) {
+		CloseHandle(device->workers_done);
+		device->workers_done = NULL;
+		device->workers_quit = TRUE;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+void DSOUND_StopMixWorkers(DirectSoundDevice *device)
+{
+	int i;
+
+	device->workers_quit = TRUE;
+	for (i = 0; i < device->num_workers; i++)
+		SetEvent(device->workers[i].start);
+	for (i = 0; i < device->num_workers; i++) {
+		DSMixWorker *worker = &device->workers[i];
+
+		WaitForSingleObject(worker->thread, INFINITE);
+		CloseHandle(worker->thread);
+		CloseHandle(worker->start);
+		HeapFree(GetProcessHeap(), 0, worker->scratch.tmp_buffer);
+		HeapFree(GetProcessHeap(), 0, worker->scratch.cp_buffer);
+		HeapFree(GetProcessHeap(), 0, worker->scratch.mix_buffer);
+	}
+	device->num_workers = 0;
+	if (device->workers_done)
+		CloseHandle(device->workers_done);
+	device->workers_done = NULL;
+}
+
+/**
+ * For a DirectSoundDevice, go through all the currently playing buffers and
+ * mix them in to the device buffer.
+ *
+ * With many buffers, the buffer list is split into contiguous ranges that are
+ * mixed in parallel: the first range by the mixer thread straight into
+ * mix_buffer, the others by the workers into their own accumulators, which are
+ * then added to mix_buffer in range order, so that the result doesn't depend
+ * on which worker finishes first.
+ *
+ * frames = the maximum amount to mix into the primary buffer
+ * all_stopped = reports back if all buffers have stopped
+ *
+ * Returns:  the length beyond the writepos that was mixed to.
+ */
+
+static void DSOUND_MixToPrimary(DirectSoundDevice *device, float *mix_buffer, DWORD frames, BOOL *all_stopped)
+{
+	int i, parts, count = device->nrofbuffers;
+	BOOL mixed;
+
+	TRACE("(frames %d)\n", frames);
+
+	if (count < DS_PARALLEL_MIX_MIN_BUFFERS || !DSOUND_StartMixWorkers(device)) {
+		/* unless we find a running buffer, all have stopped */
+		*all_stopped = !DSOUND_MixRange(device, &device->scratch, mix_buffer, frames, 0, count);
+		return;
+	}
+
+	parts = device->num_workers + 1;
+	device->workers_pending = device->num_workers;
+	for (i = 0; i < device->num_workers; i++) {
+		DSMixWorker *worker = &device->workers[i];
+
+		worker->first = count * (i + 1) / parts;
+		worker->last = count * (i + 2) / parts;
+		worker->frames = frames;
+		SetEvent(worker->start);
+	}
+
+	mixed = DSOUND_MixRange(device, &device->scratch, mix_buffer, frames, 0, count / parts);
+
+	WaitForSingleObject(device->workers_done, INFINITE);
+
+	for (i = 0; i < device->num_workers; i++) {
+		DSMixWorker *worker = &device->workers[i];
+
+		if (!worker->mixed)
+			continue;
+		mixieee32(worker->scratch.mix_buffer, mix_buffer, frames * device->pwfx->nChannels);
+		mixed = TRUE;
+	}
+
+	*all_stopped = !mixed;
 }
 
 /**
@@ -656,8 +912,8 @@ static void DSOUND_WaveQueue(DirectSoundDevice *device, LPBYTE pos, DWORD bytes)
  * The mixing procedure goes:
  *
  * secondary->buffer (secondary format)
- *   =[Resample]=> device->tmp_buffer (float format)
- *   =[Volume]=> device->tmp_buffer (float format)
+ *   =[Resample]=> scratch tmp_buffer (float format)
+ *   =[Volume]=> scratch tmp_buffer (float format)
  *   =[Reformat]=> device->buffer (device format, skipped on float)
  */
 static void DSOUND_PerformMix(DirectSoundDevice *device)
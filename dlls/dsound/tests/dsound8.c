@@ -1809,6 +1809,97 @@ static void test_effects(void)
     ok(!ref, "Got outstanding refcount %u.\n", ref);
 }
 
+static ULONGLONG get_process_cpu_time(void)
+{
+    FILETIME creation, exit, kernel, user;
+
+    GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+    return (((ULONGLONG)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime)
+         + (((ULONGLONG)user.dwHighDateTime << 32) | user.dwLowDateTime);
+}
+
+/* Plays many buffers at different sample rates at once, which exercises the
+ * resampler, and reports the CPU time spent while they play. */
+static void test_mix_many_buffers(void)
+{
+    static const DWORD rates[] = {8000, 11025, 22050, 32000, 44100, 48000, 96000};
+    IDirectSoundBuffer *buffers[64];
+    DSBUFFERDESC bufdesc;
+    WAVEFORMATEX wfx;
+    IDirectSound8 *dso;
+    ULONGLONG cpu_time;
+    DWORD start, i, j, pos, count = 0;
+    SHORT *data;
+    HRESULT rc;
+
+    if (!winetest_interactive)
+    {
+        skip("Skipping mixing benchmark, set WINETEST_INTERACTIVE to run it.\n");
+        return;
+    }
+
+    rc = DirectSoundCreate8(NULL, &dso, NULL);
+    ok(rc == DS_OK || rc == DSERR_NODRIVER, "DirectSoundCreate8() failed: %08x\n", rc);
+    if (rc != DS_OK)
+        return;
+
+    rc = IDirectSound8_SetCooperativeLevel(dso, get_hwnd(), DSSCL_PRIORITY);
+    ok(rc == DS_OK, "SetCooperativeLevel() failed: %08x\n", rc);
+
+    for (i = 0; i < ARRAY_SIZE(buffers); i++)
+    {
+        void *ptr1, *ptr2;
+        DWORD len1, len2;
+
+        init_format(&wfx, WAVE_FORMAT_PCM, rates[i % ARRAY_SIZE(rates)], 16, i % 2 ? 2 : 1);
+
+        ZeroMemory(&bufdesc, sizeof(bufdesc));
+        bufdesc.dwSize = sizeof(bufdesc);
+        bufdesc.dwFlags = DSBCAPS_GETCURRENTPOSITION2 | DSBCAPS_CTRLVOLUME;
+        bufdesc.dwBufferBytes = align(wfx.nAvgBytesPerSec, wfx.nBlockAlign);
+        bufdesc.lpwfxFormat = &wfx;
+        rc = IDirectSound8_CreateSoundBuffer(dso, &bufdesc, &buffers[i], NULL);
+        ok(rc == DS_OK, "CreateSoundBuffer() failed: %08x\n", rc);
+        if (rc != DS_OK)
+            break;
+        count++;
+
+        rc = IDirectSoundBuffer_Lock(buffers[i], 0, 0, &ptr1, &len1, &ptr2, &len2, DSBLOCK_ENTIREBUFFER);
+        ok(rc == DS_OK, "Lock() failed: %08x\n", rc);
+        if (rc != DS_OK)
+            continue;
+        /* a quiet sawtooth, different for each buffer */
+        for (j = 0, data = ptr1; j < len1 / sizeof(SHORT); j++)
+            data[j] = ((j * (i + 1) * 37) % 2048) - 1024;
+        IDirectSoundBuffer_Unlock(buffers[i], ptr1, len1, ptr2, len2);
+        IDirectSoundBuffer_SetVolume(buffers[i], -2000);
+    }
+
+    cpu_time = get_process_cpu_time();
+    start = GetTickCount();
+    for (i = 0; i < count; i++)
+    {
+        rc = IDirectSoundBuffer_Play(buffers[i], 0, 0, DSBPLAY_LOOPING);
+        ok(rc == DS_OK, "Play() failed: %08x\n", rc);
+    }
+
+    Sleep(300);
+
+    for (i = 0; i < count; i++)
+    {
+        rc = IDirectSoundBuffer_GetCurrentPosition(buffers[i], &pos, NULL);
+        ok(rc == DS_OK, "GetCurrentPosition() failed: %08x\n", rc);
+        ok(pos != 0, "buffer %u didn't play\n", i);
+        IDirectSoundBuffer_Stop(buffers[i]);
+    }
+    trace("mixed %u buffers for %u ms using %u ms of CPU time\n", count,
+          GetTickCount() - start, (DWORD)((get_process_cpu_time() - cpu_time) / 10000));
+
+    for (i = 0; i < count; i++)
+        IDirectSoundBuffer_Release(buffers[i]);
+    IDirectSound8_Release(dso);
+}
+
 START_TEST(dsound8)
 {
     DWORD cookie;
@@ -1822,6 +1913,7 @@ START_TEST(dsound8)
     test_hw_buffers();
     test_first_device();
     test_primary_flags();
+    test_mix_many_buffers();
 
     hr = CoRegisterClassObject(&testdmo_clsid, (IUnknown *)&testdmo_cf,
             CLSCTX_INPROC_SERVER, REGCLS_MULTIPLEUSE, &cookie);
@@ -587,6 +587,8 @@ static ULONG WINAPI dwritefontface_Release(IDWriteFontFace5 *iface)
             heap_free(fontface->cached);
         }
         release_scriptshaping_cache(fontface->shaping_cache);
+        release_shaped_runs(fontface);
+        heap_free(fontface->table_directory);
         if (fontface->vdmx.context)
             IDWriteFontFace5_ReleaseFontTable(iface, fontface->vdmx.context);
         if (fontface->gasp.context)
@@ -762,14 +764,45 @@ static HRESULT WINAPI dwritefontface_TryGetFontTable(IDWriteFontFace5 *iface, UI
     const void **table_data, UINT32 *table_size, void **context, BOOL *exists)
 {
     struct dwrite_fontface *fontface = impl_from_IDWriteFontFace5(iface);
+    struct dwrite_table_directory *directory;
     struct file_stream_desc stream_desc;
+    unsigned int i;
 
     TRACE("%p, %s, %p, %p, %p, %p.\n", iface, debugstr_tag(table_tag), table_data, table_size, context, exists);
 
     stream_desc.stream = fontface->stream;
     stream_desc.face_type = fontface->type;
     stream_desc.face_index = fontface->index;
-    return opentype_try_get_font_table(&stream_desc, table_tag, table_data, context, table_size, exists);
+
+    if (!(directory = fontface->table_directory))
+    {
+        if (FAILED(opentype_get_table_directory(&stream_desc, &directory)))
+            return opentype_try_get_font_table(&stream_desc, table_tag, table_data, context, table_size, exists);
+
+        if (InterlockedCompareExchangePointer((void **)&fontface->table_directory, directory, NULL))
+        {
+            heap_free(directory);
+            directory = fontface->table_directory;
+        }
+    }
+
+    if (exists) *exists = FALSE;
+    if (table_size) *table_size = 0;
+    *table_data = NULL;
+    *context = NULL;
+
+    for (i = 0; i < directory->count; ++i)
+    {
+        if (directory->tables[i].tag != table_tag)
+            continue;
+
+        if (exists) *exists = TRUE;
+        if (table_size) *table_size = directory->tables[i].length;
+        return IDWriteFontFileStream_ReadFileFragment(fontface->stream, table_data, directory->tables[i].offset,
+                directory->tables[i].length, context);
+    }
+
+    return S_OK;
 }
 
 static void WINAPI dwritefontface_ReleaseFontTable(IDWriteFontFace5 *iface, void *table_context)
@@ -4932,6 +4965,7 @@ HRESULT create_fontface(const struct fontface_desc *desc, struct list *cached_li
     fontface->simulations = desc->simulations;
     fontface->factory = desc->factory;
     IDWriteFactory7_AddRef(fontface->factory);
+    list_init(&fontface->shaped_runs);
 
     for (i = 0; i < fontface->file_count; i++) {
         fontface->files[i] = desc->files[i];
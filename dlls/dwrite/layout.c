@@ -925,6 +925,207 @@ fatal:
     return hr;
 }
 
+/* Shaping results for short runs are kept per font face, so layouts that are recreated for the same
+   strings, or repeat the same words, don't have to go through shaping and placement again. */
+#define MAX_SHAPED_RUNS 64
+#define MAX_SHAPED_RUN_LENGTH 64
+
+struct shaped_run
+{
+    struct list entry;
+
+    /* Key */
+    WCHAR locale[LOCALE_NAME_MAX_LENGTH];
+    DWRITE_SCRIPT_ANALYSIS sa;
+    DWRITE_MEASURING_MODE measuringmode;
+    DWRITE_MATRIX transform;
+    FLOAT ppdip;
+    FLOAT emsize;
+    BOOL is_sideways;
+    BOOL is_rtl;
+    UINT32 length;
+    WCHAR *text;
+
+    UINT32 glyph_count;
+    UINT16 *clustermap;
+    UINT16 *glyphs;
+    FLOAT *advances;
+    DWRITE_GLYPH_OFFSET *offsets;
+};
+
+static BOOL shaped_run_matches(const struct shaped_run *cached, struct dwrite_textlayout *layout,
+        const struct regular_layout_run *run)
+{
+    if (cached->length != run->descr.stringLength ||
+            cached->emsize != run->run.fontEmSize ||
+            cached->is_sideways != run->run.isSideways ||
+            cached->is_rtl != (run->run.bidiLevel & 1) ||
+            cached->sa.script != run->sa.script ||
+            cached->sa.shapes != run->sa.shapes ||
+            cached->measuringmode != layout->measuringmode)
+        return FALSE;
+
+    if (is_layout_gdi_compatible(layout) && (cached->ppdip != layout->ppdip ||
+            memcmp(&cached->transform, &layout->transform, sizeof(layout->transform))))
+        return FALSE;
+
+    return !memcmp(cached->text, run->descr.string, run->descr.stringLength * sizeof(WCHAR)) &&
+            !strcmpW(cached->locale, run->descr.localeName);
+}
+
+static BOOL layout_get_shaped_run(struct dwrite_textlayout *layout, struct regular_layout_run *run)
+{
+    struct dwrite_fontface *fontface;
+    struct shaped_run *cached;
+    BOOL found = FALSE;
+
+    if (run->descr.stringLength > MAX_SHAPED_RUN_LENGTH)
+        return FALSE;
+
+    if (!(fontface = unsafe_impl_from_IDWriteFontFace(run->run.fontFace)))
+        return FALSE;
+
+    factory_lock(fontface->factory);
+
+    LIST_FOR_EACH_ENTRY(cached, &fontface->shaped_runs, struct shaped_run, entry)
+    {
+        if (!shaped_run_matches(cached, layout, run))
+            continue;
+
+        run->clustermap = heap_calloc(run->descr.stringLength, sizeof(*run->clustermap));
+        run->glyphs = heap_calloc(cached->glyph_count, sizeof(*run->glyphs));
+        run->advances = heap_calloc(cached->glyph_count, sizeof(*run->advances));
+        run->offsets = heap_calloc(cached->glyph_count, sizeof(*run->offsets));
+        if (run->clustermap && run->glyphs && run->advances && run->offsets)
+        {
+            memcpy(run->clustermap, cached->clustermap, run->descr.stringLength * sizeof(*run->clustermap));
+            memcpy(run->glyphs, cached->glyphs, cached->glyph_count * sizeof(*run->glyphs));
+            memcpy(run->advances, cached->advances, cached->glyph_count * sizeof(*run->advances));
+            memcpy(run->offsets, cached->offsets, cached->glyph_count * sizeof(*run->offsets));
+            run->glyphcount = cached->glyph_count;
+            found = TRUE;
+
+            /* Keep most recently used entries at the head. */
+            list_remove(&cached->entry);
+            list_add_head(&fontface->shaped_runs, &cached->entry);
+        }
+        else
+        {
+            heap_free(run->clustermap);
+            heap_free(run->glyphs);
+            heap_free(run->advances);
+            heap_free(run->offsets);
+            run->clustermap = NULL;
+            run->glyphs = NULL;
+            run->advances = NULL;
+            run->offsets = NULL;
+        }
+        break;
+    }
+
+    factory_unlock(fontface->factory);
+
+    return found;
+}
+
+static void layout_cache_shaped_run(struct dwrite_textlayout *layout, const struct regular_layout_run *run)
+{
+    struct dwrite_fontface *fontface;
+    struct shaped_run *cached;
+    SIZE_T size;
+    char *ptr;
+
+    if (run->descr.stringLength > MAX_SHAPED_RUN_LENGTH)
+        return;
+
+    if (!(fontface = unsafe_impl_from_IDWriteFontFace(run->run.fontFace)))
+        return;
+
+    /* Arrays are placed after the structure, ordered by decreasing alignment. */
+    size = sizeof(*cached) + run->glyphcount * (sizeof(*cached->offsets) + sizeof(*cached->advances) +
+            sizeof(*cached->glyphs)) + run->descr.stringLength * (sizeof(*cached->clustermap) + sizeof(WCHAR));
+    if (!(cached = heap_alloc(size)))
+        return;
+
+    ptr = (char *)(cached + 1);
+    cached->offsets = (DWRITE_GLYPH_OFFSET *)ptr;
+    ptr += run->glyphcount * sizeof(*cached->offsets);
+    cached->advances = (FLOAT *)ptr;
+    ptr += run->glyphcount * sizeof(*cached->advances);
+    cached->glyphs = (UINT16 *)ptr;
+    ptr += run->glyphcount * sizeof(*cached->glyphs);
+    cached->clustermap = (UINT16 *)ptr;
+    ptr += run->descr.stringLength * sizeof(*cached->clustermap);
+    cached->text = (WCHAR *)ptr;
+
+    strcpyW(cached->locale, run->descr.localeName);
+    cached->sa = run->sa;
+    cached->measuringmode = layout->measuringmode;
+    if (is_layout_gdi_compatible(layout))
+    {
+        cached->transform = layout->transform;
+        cached->ppdip = layout->ppdip;
+    }
+    else
+    {
+        memset(&cached->transform, 0, sizeof(cached->transform));
+        cached->ppdip = 0.0f;
+    }
+    cached->emsize = run->run.fontEmSize;
+    cached->is_sideways = run->run.isSideways;
+    cached->is_rtl = run->run.bidiLevel & 1;
+    cached->length = run->descr.stringLength;
+    memcpy(cached->text, run->descr.string, run->descr.stringLength * sizeof(WCHAR));
+
+    cached->glyph_count = run->glyphcount;
+    memcpy(cached->clustermap, run->clustermap, run->descr.stringLength * sizeof(*cached->clustermap));
+    memcpy(cached->glyphs, run->glyphs, run->glyphcount * sizeof(*cached->glyphs));
+    memcpy(cached->advances, run->advances, run->glyphcount * sizeof(*cached->advances));
+    memcpy(cached->offsets, run->offsets, run->glyphcount * sizeof(*cached->offsets));
+
+    factory_lock(fontface->factory);
+
+    if (fontface->shaped_run_count == MAX_SHAPED_RUNS)
+    {
+        struct shaped_run *oldest = LIST_ENTRY(list_tail(&fontface->shaped_runs), struct shaped_run, entry);
+        list_remove(&oldest->entry);
+        heap_free(oldest);
+    }
+    else
+        fontface->shaped_run_count++;
+    list_add_head(&fontface->shaped_runs, &cached->entry);
+
+    factory_unlock(fontface->factory);
+}
+
+void release_shaped_runs(struct dwrite_fontface *fontface)
+{
+    struct shaped_run *cached, *cached2;
+
+    LIST_FOR_EACH_ENTRY_SAFE(cached, cached2, &fontface->shaped_runs, struct shaped_run, entry)
+    {
+        list_remove(&cached->entry);
+        heap_free(cached);
+    }
+    fontface->shaped_run_count = 0;
+}
+
+static void layout_set_run_glyphs(struct regular_layout_run *run)
+{
+    run->run.glyphIndices = run->glyphs;
+    run->descr.clusterMap = run->clustermap;
+    run->run.glyphAdvances = run->advances;
+    run->run.glyphOffsets = run->offsets;
+
+    /* Special treatment for runs that don't produce visual output, shaping code adds normal glyphs for them,
+       with valid cluster map and potentially with non-zero advances; layout code exposes those as zero
+       width clusters. */
+    if (run->sa.shapes == DWRITE_SCRIPT_SHAPES_NO_VISUAL)
+        run->run.glyphCount = 0;
+    else
+        run->run.glyphCount = run->glyphcount;
+}
+
 static HRESULT layout_shape_run(struct dwrite_textlayout *layout, struct regular_layout_run *run)
 {
     DWRITE_SHAPING_GLYPH_PROPERTIES *glyph_props;
@@ -936,6 +1137,13 @@ static HRESULT layout_shape_run(struct dwrite_textlayout *layout, struct regular
 
     range = get_layout_range_by_pos(layout, run->descr.textPosition);
     run->descr.localeName = range->locale;
+
+    if (layout_get_shaped_run(layout, run))
+    {
+        layout_set_run_glyphs(run);
+        return S_OK;
+    }
+
     run->clustermap = heap_calloc(run->descr.stringLength, sizeof(*run->clustermap));
 
     max_count = 3 * run->descr.stringLength / 2 + 16;
@@ -1011,17 +1219,10 @@ static HRESULT layout_shape_run(struct dwrite_textlayout *layout, struct regular
         memset(run->offsets, 0, run->glyphcount * sizeof(*run->offsets));
         WARN("%s: failed to get glyph placement info, hr %#x.\n", debugstr_rundescr(&run->descr), hr);
     }
-
-    run->run.glyphAdvances = run->advances;
-    run->run.glyphOffsets = run->offsets;
-
-    /* Special treatment for runs that don't produce visual output, shaping code adds normal glyphs for them,
-       with valid cluster map and potentially with non-zero advances; layout code exposes those as zero
-       width clusters. */
-    if (run->sa.shapes == DWRITE_SCRIPT_SHAPES_NO_VISUAL)
-        run->run.glyphCount = 0;
     else
-        run->run.glyphCount = run->glyphcount;
+        layout_cache_shaped_run(layout, run);
+
+    layout_set_run_glyphs(run);
 
     return S_OK;
 }
@@ -1459,22 +1459,14 @@ HRESULT opentype_analyze_font(IDWriteFontFileStream *stream, BOOL *supported, DW
     return S_OK;
 }
 
-HRESULT opentype_try_get_font_table(const struct file_stream_desc *stream_desc, UINT32 tag, const void **table_data,
-    void **table_context, UINT32 *table_size, BOOL *found)
+static HRESULT opentype_read_table_records(const struct file_stream_desc *stream_desc,
+        const TT_TableRecord **records, UINT16 *count, void **context)
 {
-    void *table_directory_context, *sfnt_context;
-    TT_TableRecord *table_record = NULL;
     TTC_SFNT_V1 *font_header = NULL;
     UINT32 table_offset = 0;
-    UINT16 table_count;
+    void *sfnt_context;
     HRESULT hr;
 
-    if (found) *found = FALSE;
-    if (table_size) *table_size = 0;
-
-    *table_data = NULL;
-    *table_context = NULL;
-
     if (stream_desc->face_type == DWRITE_FONT_FACE_TYPE_OPENTYPE_COLLECTION) {
         const TTC_Header_V1 *ttc_header;
         void * ttc_context;
@@ -1495,13 +1487,30 @@ HRESULT opentype_try_get_font_table(const struct file_stream_desc *stream_desc,
     if (FAILED(hr))
         return hr;
 
-    table_count = GET_BE_WORD(font_header->numTables);
+    *count = GET_BE_WORD(font_header->numTables);
     table_offset += sizeof(*font_header);
 
     IDWriteFontFileStream_ReleaseFileFragment(stream_desc->stream, sfnt_context);
 
-    hr = IDWriteFontFileStream_ReadFileFragment(stream_desc->stream, (const void **)&table_record, table_offset,
-            table_count * sizeof(*table_record), &table_directory_context);
+    return IDWriteFontFileStream_ReadFileFragment(stream_desc->stream, (const void **)records, table_offset,
+            *count * sizeof(**records), context);
+}
+
+HRESULT opentype_try_get_font_table(const struct file_stream_desc *stream_desc, UINT32 tag, const void **table_data,
+    void **table_context, UINT32 *table_size, BOOL *found)
+{
+    const TT_TableRecord *table_record = NULL;
+    void *table_directory_context;
+    UINT16 table_count;
+    HRESULT hr;
+
+    if (found) *found = FALSE;
+    if (table_size) *table_size = 0;
+
+    *table_data = NULL;
+    *table_context = NULL;
+
+    hr = opentype_read_table_records(stream_desc, &table_record, &table_count, &table_directory_context);
     if (hr == S_OK) {
         UINT16 i;
 
@@ -1527,6 +1536,42 @@ HRESULT opentype_try_get_font_table(const struct file_stream_desc *stream_desc,
     return hr;
 }
 
+/* Reads the table directory once, so that font faces can look up tables
+ * without going through the file headers each time. */
+HRESULT opentype_get_table_directory(const struct file_stream_desc *stream_desc,
+        struct dwrite_table_directory **ret)
+{
+    const TT_TableRecord *records;
+    struct dwrite_table_directory *directory;
+    UINT16 i, count;
+    void *context;
+    HRESULT hr;
+
+    *ret = NULL;
+
+    if (FAILED(hr = opentype_read_table_records(stream_desc, &records, &count, &context)))
+        return hr;
+
+    if (!(directory = heap_alloc(FIELD_OFFSET(struct dwrite_table_directory, tables[count]))))
+    {
+        IDWriteFontFileStream_ReleaseFileFragment(stream_desc->stream, context);
+        return E_OUTOFMEMORY;
+    }
+
+    directory->count = count;
+    for (i = 0; i < count; ++i)
+    {
+        directory->tables[i].tag = records[i].tag;
+        directory->tables[i].offset = GET_BE_DWORD(records[i].offset);
+        directory->tables[i].length = GET_BE_DWORD(records[i].length);
+    }
+
+    IDWriteFontFileStream_ReleaseFileFragment(stream_desc->stream, context);
+
+    *ret = directory;
+    return S_OK;
+}
+
 static HRESULT opentype_get_font_table(const struct file_stream_desc *stream_desc, UINT32 tag,
         struct dwrite_fonttable *table)
 {
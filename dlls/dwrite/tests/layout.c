@@ -5732,6 +5732,48 @@ todo_wine {
     IDWriteFactory_Release(factory);
 }
 
+static void test_repeated_shaping(void)
+{
+    static const float sizes[] = { 10.0f, 20.0f, 10.0f };
+    DWRITE_CLUSTER_METRICS clusters[3][4];
+    IDWriteTextFormat *format;
+    IDWriteTextLayout *layout;
+    IDWriteFactory *factory;
+    unsigned int i, j;
+    UINT32 count;
+    HRESULT hr;
+
+    factory = create_factory();
+
+    /* Layouts repeating the same text have to agree on their metrics, and pick up size changes. */
+    for (i = 0; i < ARRAY_SIZE(sizes); ++i)
+    {
+        hr = IDWriteFactory_CreateTextFormat(factory, L"Tahoma", NULL, DWRITE_FONT_WEIGHT_NORMAL,
+                DWRITE_FONT_STYLE_NORMAL, DWRITE_FONT_STRETCH_NORMAL, sizes[i], L"en-us", &format);
+        ok(hr == S_OK, "Failed to create text format, hr %#x.\n", hr);
+
+        hr = IDWriteFactory_CreateTextLayout(factory, L"abcd", 4, format, 1000.0f, 1000.0f, &layout);
+        ok(hr == S_OK, "Failed to create text layout, hr %#x.\n", hr);
+
+        count = 0;
+        hr = IDWriteTextLayout_GetClusterMetrics(layout, clusters[i], 4, &count);
+        ok(hr == S_OK, "Failed to get cluster metrics, hr %#x.\n", hr);
+        ok(count == 4, "Unexpected cluster count %u.\n", count);
+
+        IDWriteTextLayout_Release(layout);
+        IDWriteTextFormat_Release(format);
+    }
+
+    for (j = 0; j < 4; ++j)
+    {
+        ok(clusters[0][j].width == clusters[2][j].width, "%u: unexpected width %f, expected %f.\n", j,
+                clusters[2][j].width, clusters[0][j].width);
+        ok(clusters[0][j].width < clusters[1][j].width, "%u: unexpected width %f.\n", j, clusters[1][j].width);
+    }
+
+    IDWriteFactory_Release(factory);
+}
+
 START_TEST(layout)
 {
     IDWriteFactory *factory;
@@ -5783,6 +5825,7 @@ START_TEST(layout)
     test_line_spacing();
     test_GetOverhangMetrics();
     test_tab_stops();
+    test_repeated_shaping();
 
     IDWriteFactory_Release(factory);
 }
@@ -20,16 +20,19 @@
 
 #include <assert.h>
 #include "gdi_private.h"
+#include "winreg.h"
 #include "dibdrv.h"
 
 #include "wine/unicode.h"
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(dib);
+WINE_DECLARE_DEBUG_CHANNEL(glyphcache);
 
 struct cached_glyph
 {
     GLYPHMETRICS metrics;
+    BOOL         used;  /* drawn since the last trim_font_glyphs() pass */
     BYTE         bits[1];
 };
 
@@ -43,10 +46,15 @@ enum glyph_type
 #define GLYPH_CACHE_PAGE_SIZE  0x100
 #define GLYPH_CACHE_PAGES      (0x10000 / GLYPH_CACHE_PAGE_SIZE)
 
+#define MAX_UNUSED_FONTS       5                  /* most-recently used fonts kept around */
+#define DEFAULT_GLYPH_CACHE    (4 * 1024 * 1024)  /* glyph bitmap memory budget in bytes */
+
 struct cached_font
 {
     struct list           entry;
     LONG                  ref;
+    LONG                  size;  /* memory used by the glyph bitmaps */
+    SRWLOCK               lock;  /* held shared while the glyphs are being drawn */
     DWORD                 hash;
     LOGFONTW              lf;
     XFORM                 xform;
@@ -55,6 +63,11 @@ struct cached_font
 };
 
 static struct list font_cache = LIST_INIT( font_cache );
+static SIZE_T glyph_cache_budget;
+static LONG glyph_cache_size;  /* memory used by the glyph bitmaps of all fonts */
+
+static LONG glyph_cache_hits;
+static LONG glyph_cache_misses;
 
 static CRITICAL_SECTION font_cache_cs;
 static CRITICAL_SECTION_DEBUG critsect_debug =
@@ -554,10 +567,144 @@ static int font_cache_cmp( const struct cached_font *p1, const struct cached_fon
     return ret;
 }
 
+/* glyph cache budget in kilobytes: HKCU\Software\Wine\Fonts\GlyphCacheSize */
+static SIZE_T get_glyph_cache_budget(void)
+{
+    static const WCHAR glyph_cache_sizeW[] = {'G','l','y','p','h','C','a','c','h','e','S','i','z','e',0};
+    SIZE_T budget = DEFAULT_GLYPH_CACHE;
+    WCHAR buffer[16];
+    DWORD type, size = sizeof(buffer);
+    HKEY hkey;
+
+    if (!RegOpenKeyExA( HKEY_CURRENT_USER, "Software\\Wine\\Fonts", 0, KEY_READ, &hkey ))
+    {
+        if (!RegQueryValueExW( hkey, glyph_cache_sizeW, NULL, &type, (BYTE *)buffer, &size ) &&
+            type == REG_SZ)
+            budget = (SIZE_T)max( atoiW( buffer ), 0 ) * 1024;
+        RegCloseKey( hkey );
+    }
+    TRACE_(glyphcache)( "glyph cache budget %lu bytes\n", budget );
+    return budget;
+}
+
+static void free_cached_font( struct cached_font *font )
+{
+    UINT i, j, k;
+
+    for (i = 0; i < GLYPH_NBTYPES; i++)
+    {
+        for (j = 0; j < GLYPH_CACHE_PAGES; j++)
+        {
+            if (!font->glyphs[i][j]) continue;
+            for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
+                HeapFree( GetProcessHeap(), 0, font->glyphs[i][j][k] );
+            HeapFree( GetProcessHeap(), 0, font->glyphs[i][j] );
+        }
+    }
+    InterlockedExchangeAdd( &glyph_cache_size, -font->size );
+    HeapFree( GetProcessHeap(), 0, font );
+}
+
+static int get_glyph_depth( UINT aa_flags );
+
+/***********************************************************************
+ *         trim_font_glyphs
+ *
+ * Free the glyphs of a font that haven't been drawn since the previous
+ * call, and mark the others as unused. The font lock must be held
+ * exclusively. Returns the number of bytes freed.
+ */
+static LONG trim_font_glyphs( struct cached_font *font )
+{
+    int bit_count = get_glyph_depth( font->aa_flags );
+    struct cached_glyph *glyph;
+    LONG freed = 0;
+    UINT i, j, k;
+
+    for (i = 0; i < GLYPH_NBTYPES; i++)
+    {
+        for (j = 0; j < GLYPH_CACHE_PAGES; j++)
+        {
+            if (!font->glyphs[i][j]) continue;
+            for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
+            {
+                if (!(glyph = font->glyphs[i][j][k])) continue;
+                if (glyph->used)
+                {
+                    glyph->used = FALSE;
+                    continue;
+                }
+                freed += FIELD_OFFSET( struct cached_glyph, bits[get_dib_stride( glyph->metrics.gmBlackBoxX,
+                                       bit_count ) * glyph->metrics.gmBlackBoxY] );
+                font->glyphs[i][j][k] = NULL;
+                HeapFree( GetProcessHeap(), 0, glyph );
+            }
+        }
+    }
+    InterlockedExchangeAdd( &font->size, -freed );
+    InterlockedExchangeAdd( &glyph_cache_size, -freed );
+    return freed;
+}
+
+/***********************************************************************
+ *         trim_font_cache
+ *
+ * Free the least recently used fonts that are no longer selected anywhere,
+ * until at most MAX_UNUSED_FONTS of them are left and the glyph bitmaps
+ * fit in the cache budget. Must be called with font_cache_cs held; fonts
+ * that are in use can't be freed since their glyphs are accessed without
+ * holding the lock. If that isn't enough, the least recently drawn glyphs
+ * of the fonts in use are freed, skipping fonts that are being drawn with.
+ */
+static void trim_font_cache(void)
+{
+    struct cached_font *font, *next;
+    SIZE_T total = 0;
+    UINT count = 0, unused = 0;
+    LONG freed;
+
+    LIST_FOR_EACH_ENTRY( font, &font_cache, struct cached_font, entry )
+    {
+        total += font->size;
+        count++;
+        if (!font->ref) unused++;
+    }
+
+    LIST_FOR_EACH_ENTRY_SAFE_REV( font, next, &font_cache, struct cached_font, entry )
+    {
+        if (unused <= MAX_UNUSED_FONTS && total <= glyph_cache_budget) break;
+        if (font->ref) continue;
+
+        TRACE_(glyphcache)( "evicting %d %s, %d bytes\n", font->lf.lfHeight,
+                            debugstr_w(font->lf.lfFaceName), font->size );
+        total -= font->size;
+        count--;
+        unused--;
+        list_remove( &font->entry );
+        free_cached_font( font );
+    }
+
+    /* Leave some headroom, so that this doesn't run again for every string. */
+    LIST_FOR_EACH_ENTRY_REV( font, &font_cache, struct cached_font, entry )
+    {
+        if (total <= glyph_cache_budget / 4 * 3) break;
+        if (!TryAcquireSRWLockExclusive( &font->lock )) continue;
+        freed = trim_font_glyphs( font );
+        ReleaseSRWLockExclusive( &font->lock );
+
+        TRACE_(glyphcache)( "trimmed %d %s by %d bytes\n", font->lf.lfHeight,
+                            debugstr_w(font->lf.lfFaceName), freed );
+        total -= freed;
+    }
+
+    TRACE_(glyphcache)( "%u fonts, %lu bytes, %d hits, %d misses\n", count, total,
+                        glyph_cache_hits, glyph_cache_misses );
+}
+
 static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 {
-    struct cached_font font, *ptr, *last_unused = NULL;
-    UINT i = 0, j, k;
+    static BOOL budget_initialized;
+    struct cached_font font, *ptr;
 
     GetObjectW( hfont, sizeof(font.lf), &font.lf );
     font.xform = dc->xformWorld2Vport;
@@ -573,37 +720,24 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
     font.hash = font_cache_hash( &font );
 
     EnterCriticalSection( &font_cache_cs );
+    if (!budget_initialized)
+    {
+        glyph_cache_budget = get_glyph_cache_budget();
+        budget_initialized = TRUE;
+    }
+
     LIST_FOR_EACH_ENTRY( ptr, &font_cache, struct cached_font, entry )
     {
         if (!font_cache_cmp( &font, ptr ))
         {
             InterlockedIncrement( &ptr->ref );
             list_remove( &ptr->entry );
+            list_add_head( &font_cache, &ptr->entry );
             goto done;
         }
-        if (!ptr->ref)
-        {
-            i++;
-            last_unused = ptr;
-        }
     }
 
-    if (i > 5)  /* keep at least 5 of the most-recently used fonts around */
-    {
-        ptr = last_unused;
-        for (i = 0; i < GLYPH_NBTYPES; i++)
-        {
-            for (j = 0; j < GLYPH_CACHE_PAGES; j++)
-            {
-                if (!ptr->glyphs[i][j]) continue;
-                for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
-                    HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j][k] );
-                HeapFree( GetProcessHeap(), 0, ptr->glyphs[i][j] );
-            }
-        }
-        list_remove( &ptr->entry );
-    }
-    else if (!(ptr = HeapAlloc( GetProcessHeap(), 0, sizeof(*ptr) )))
+    if (!(ptr = HeapAlloc( GetProcessHeap(), 0, sizeof(*ptr) )))
     {
         LeaveCriticalSection( &font_cache_cs );
         return NULL;
@@ -611,9 +745,12 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 
     *ptr = font;
     ptr->ref = 1;
+    ptr->size = 0;
+    InitializeSRWLock( &ptr->lock );
     memset( ptr->glyphs, 0, sizeof(ptr->glyphs) );
-done:
     list_add_head( &font_cache, &ptr->entry );
+    trim_font_cache();
+done:
     LeaveCriticalSection( &font_cache_cs );
     TRACE( "%d %s -> %p\n", ptr->lf.lfHeight, debugstr_w(ptr->lf.lfFaceName), ptr );
     return ptr;
@@ -625,7 +762,7 @@ void release_cached_font( struct cached_font *font )
 }
 
 static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT index, UINT flags,
-                                              struct cached_glyph *glyph )
+                                              struct cached_glyph *glyph, DWORD size )
 {
     struct cached_glyph *ret;
     enum glyph_type type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
@@ -646,7 +783,12 @@ static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT ind
             HeapFree( GetProcessHeap(), 0, ptr );
     }
     ret = InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page][entry], glyph, NULL );
-    if (!ret) ret = glyph;
+    if (!ret)
+    {
+        InterlockedExchangeAdd( &font->size, FIELD_OFFSET( struct cached_glyph, bits[size] ));
+        InterlockedExchangeAdd( &glyph_cache_size, FIELD_OFFSET( struct cached_glyph, bits[size] ));
+        ret = glyph;
+    }
     else HeapFree( GetProcessHeap(), 0, glyph );
     return ret;
 }
@@ -805,14 +947,15 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
 
 done:
     glyph->metrics = metrics;
-    return add_cached_glyph( font, index, flags, glyph );
+    glyph->used = TRUE;
+    return add_cached_glyph( font, index, flags, glyph, size );
 }
 
 static void render_string( DC *dc, dib_info *dib, struct cached_font *font, INT x, INT y,
                            UINT flags, const WCHAR *str, UINT count, const INT *dx,
                            const struct clipped_rects *clipped_rects, RECT *bounds )
 {
-    UINT i;
+    UINT i, misses = 0;
     struct cached_glyph *glyph;
     dib_info glyph_dib;
     DWORD text_color;
@@ -831,10 +974,15 @@ static void render_string( DC *dc, dib_info *dib, struct cached_font *font, INT
     else
         get_aa_ranges( dib->funcs->pixel_to_colorref( dib, text_color ), intensity.ranges );
 
+    AcquireSRWLockShared( &font->lock );
     for (i = 0; i < count; i++)
     {
-        if (!(glyph = get_cached_glyph( font, str[i], flags )) &&
-            !(glyph = cache_glyph_bitmap( dc, font, str[i], flags ))) continue;
+        if (!(glyph = get_cached_glyph( font, str[i], flags )))
+        {
+            misses++;
+            if (!(glyph = cache_glyph_bitmap( dc, font, str[i], flags ))) continue;
+        }
+        else if (!glyph->used) glyph->used = TRUE;
 
         glyph_dib.width       = glyph->metrics.gmBlackBoxX;
         glyph_dib.height      = glyph->metrics.gmBlackBoxY;
@@ -861,6 +1009,20 @@ static void render_string( DC *dc, dib_info *dib, struct cached_font *font, INT
             y += glyph->metrics.gmCellIncY;
         }
     }
+    ReleaseSRWLockShared( &font->lock );
+
+    if (glyph_cache_size > glyph_cache_budget)
+    {
+        EnterCriticalSection( &font_cache_cs );
+        trim_font_cache();
+        LeaveCriticalSection( &font_cache_cs );
+    }
+
+    if (TRACE_ON(glyphcache))
+    {
+        InterlockedExchangeAdd( &glyph_cache_hits, count - misses );
+        InterlockedExchangeAdd( &glyph_cache_misses, misses );
+    }
 }
 
 BOOL render_aa_text_bitmapinfo( DC *dc, BITMAPINFO *info, struct gdi_image_bits *bits,
@@ -1623,7 +1623,7 @@ static BOOL insert_face_in_family_list( Face *face, Family *family )
  * NB This function stores the ptrs to the strings to save copying.
  * Don't free them after calling.
  */
-static Family *create_family( WCHAR *family_name, WCHAR *english_name )
+static Family *create_family( const WCHAR *family_name, const WCHAR *english_name )
 {
     Family * const family = HeapAlloc( GetProcessHeap(), 0, sizeof(*family) );
     family->refcount = 1;
@@ -1944,6 +1944,23 @@ static WCHAR *get_vertical_name( WCHAR *name )
     return name;
 }
 
+static Family *find_or_create_family( const WCHAR *family_name, const WCHAR *english_name )
+{
+    Family *family;
+
+    if ((family = find_family_from_name( family_name ))) family->refcount++;
+    else if ((family = create_family( family_name, english_name )) && english_name)
+    {
+        FontSubst *subst = HeapAlloc( GetProcessHeap(), 0, sizeof(*subst) );
+        subst->from.name = strdupW( english_name );
+        subst->from.charset = -1;
+        subst->to.name = strdupW( family_name );
+        subst->to.charset = -1;
+        add_font_subst( &font_subst_list, subst, 0 );
+    }
+    return family;
+}
+
 static Family *get_family( FT_Face ft_face, BOOL vertical )
 {
     Family *family;
@@ -1964,16 +1981,7 @@ static Family *get_family( FT_Face ft_face, BOOL vertical )
         english_name = get_vertical_name( english_name );
     }
 
-    if ((family = find_family_from_name( family_name ))) family->refcount++;
-    else if ((family = create_family( family_name, english_name )) && english_name)
-    {
-        FontSubst *subst = HeapAlloc( GetProcessHeap(), 0, sizeof(*subst) );
-        subst->from.name = strdupW( english_name );
-        subst->from.charset = -1;
-        subst->to.name = strdupW( family_name );
-        subst->to.charset = -1;
-        add_font_subst( &font_subst_list, subst, 0 );
-    }
+    family = find_or_create_family( family_name, english_name );
 
     HeapFree( GetProcessHeap(), 0, family_name );
     HeapFree( GetProcessHeap(), 0, english_name );
@@ -2161,15 +2169,8 @@ static Face *create_face( FT_Face ft_face, FT_Long face_index, const char *file,
     return face;
 }
 
-static void AddFaceToList(FT_Face ft_face, const char *file, void *font_data_ptr, DWORD font_data_size,
-                          FT_Long face_index, DWORD flags )
+static void add_face_to_family( Face *face, Family *family, DWORD flags )
 {
-    Face *face;
-    Family *family;
-
-    face = create_face( ft_face, face_index, file, font_data_ptr, font_data_size, flags );
-    family = get_family( ft_face, flags & ADDFONT_VERTICAL_FONT );
-
     if (insert_face_in_family_list( face, family ))
     {
         if (flags & ADDFONT_ADD_TO_CACHE)
@@ -2180,6 +2181,476 @@ static void AddFaceToList(FT_Face ft_face, const char *file, void *font_data_ptr
     release_family( family );
 }
 
+/*************************************************************
+ * Persistent font catalog
+ *
+ * The catalog is a binary file stored in the prefix that records the faces
+ * found in every system font file, keyed by unix path, size and modification
+ * time.  It is mapped read-only while the font list is built, so that unchanged
+ * font files don't have to be opened through FreeType, and it is rewritten
+ * whenever a font file was added, changed or removed.
+ */
+
+#define FONT_CATALOG_MAGIC   0x4346574e  /* "NWFC" */
+#define FONT_CATALOG_VERSION 1
+#define FONT_CATALOG_NO_NAME (~0u)
+
+struct font_catalog_header
+{
+    DWORD magic;
+    DWORD version;
+    DWORD lcid;           /* family and face names depend on the system locale */
+    DWORD file_count;
+    DWORD face_count;
+    DWORD strings_size;   /* in bytes */
+};
+
+struct font_catalog_file
+{
+    ULONGLONG size;
+    ULONGLONG mtime;
+    DWORD     path;        /* offset of the unix file name in the string table */
+    DWORD     flags;       /* ADDFONT_ALLOW_BITMAP */
+    DWORD     first_face;
+    DWORD     face_count;
+};
+
+struct font_catalog_face
+{
+    DWORD         family_name;   /* string table offsets */
+    DWORD         english_name;
+    DWORD         style_name;
+    DWORD         full_name;
+    LONG          face_index;
+    DWORD         flags;         /* ADDFONT_VERTICAL_FONT */
+    DWORD         ntm_flags;
+    LONG          font_version;
+    FONTSIGNATURE fs;
+    DWORD         scalable;
+    SHORT         height;
+    SHORT         width;
+    LONG          size;
+    LONG          x_ppem;
+    LONG          y_ppem;
+    SHORT         internal_leading;
+    SHORT         pad;
+};
+
+struct font_catalog
+{
+    void                           *view;
+    const struct font_catalog_file *files;
+    const struct font_catalog_face *faces;
+    const char                     *strings;
+    DWORD                           file_count;
+    DWORD                           strings_size;
+    /* catalog being built for the next run */
+    struct font_catalog_file       *new_files;
+    struct font_catalog_face       *new_faces;
+    char                           *new_strings;
+    DWORD                           new_file_count, new_files_size;
+    DWORD                           new_face_count, new_faces_size;
+    DWORD                           new_strings_len, new_strings_size;
+    struct font_catalog_file       *recording;  /* file whose faces are being recorded */
+    DWORD                           hits;
+    DWORD                           misses;
+};
+
+static struct font_catalog *font_catalog;
+
+static BOOL get_font_catalog_path( WCHAR *path )
+{
+    static const WCHAR wineconfigdirW[] = {'W','I','N','E','C','O','N','F','I','G','D','I','R',0};
+    static const WCHAR fontcacheW[] = {'\\','f','o','n','t','c','a','c','h','e','.','b','i','n',0};
+    DWORD len = GetEnvironmentVariableW( wineconfigdirW, path, MAX_PATH );
+
+    if (!len || len + ARRAY_SIZE(fontcacheW) > MAX_PATH) return FALSE;
+    strcatW( path, fontcacheW );
+    path[1] = '\\';  /* change \??\ to \\?\ */
+    return TRUE;
+}
+
+static int compare_font_catalog_files( const char *path1, DWORD flags1, const char *path2, DWORD flags2 )
+{
+    int res = strcmp( path1, path2 );
+    if (res) return res;
+    return flags1 - flags2;
+}
+
+static BOOL validate_font_catalog( struct font_catalog *catalog, const struct font_catalog_header *header,
+                                   SIZE_T size )
+{
+    const struct font_catalog_file *file;
+    const struct font_catalog_face *face;
+    SIZE_T needed;
+    DWORD i;
+
+    if (size < sizeof(*header)) return FALSE;
+    if (header->magic != FONT_CATALOG_MAGIC || header->version != FONT_CATALOG_VERSION) return FALSE;
+    if (header->lcid != GetSystemDefaultLCID()) return FALSE;
+    if (header->file_count > size / sizeof(*file) || header->face_count > size / sizeof(*face)) return FALSE;
+
+    needed = sizeof(*header) + header->file_count * sizeof(*file) + header->face_count * sizeof(*face);
+    if (needed > size || header->strings_size != size - needed) return FALSE;
+
+    catalog->files = (const struct font_catalog_file *)(header + 1);
+    catalog->faces = (const struct font_catalog_face *)(catalog->files + header->file_count);
+    catalog->strings = (const char *)(catalog->faces + header->face_count);
+    catalog->file_count = header->file_count;
+    catalog->strings_size = header->strings_size;
+
+#define CHECK_STRING(offset) \
+    if ((offset) >= catalog->strings_size || !memchr( catalog->strings + (offset), 0, catalog->strings_size - (offset) )) \
+        return FALSE
+#define CHECK_STRINGW(offset) \
+    if ((offset) % sizeof(WCHAR) || (offset) >= catalog->strings_size) return FALSE
+
+    for (i = 0, file = catalog->files; i < header->file_count; i++, file++)
+    {
+        CHECK_STRING( file->path );
+        if (file->first_face > header->face_count || file->face_count > header->face_count - file->first_face)
+            return FALSE;
+        if (i && compare_font_catalog_files( catalog->strings + file[-1].path, file[-1].flags,
+                                             catalog->strings + file->path, file->flags ) >= 0)
+            return FALSE;
+    }
+    for (i = 0, face = catalog->faces; i < header->face_count; i++, face++)
+    {
+        CHECK_STRINGW( face->family_name );
+        CHECK_STRINGW( face->style_name );
+        CHECK_STRINGW( face->full_name );
+        if (face->english_name != FONT_CATALOG_NO_NAME) CHECK_STRINGW( face->english_name );
+    }
+#undef CHECK_STRINGW
+#undef CHECK_STRING
+
+    /* WCHAR strings are stored null-terminated, the table must end on one */
+    return !catalog->strings_size || (catalog->strings_size % sizeof(WCHAR) == 0 &&
+           !((const WCHAR *)(catalog->strings + catalog->strings_size))[-1]);
+}
+
+static void open_font_catalog(void)
+{
+    struct font_catalog *catalog;
+    WCHAR path[MAX_PATH];
+    LARGE_INTEGER size;
+    HANDLE file, mapping;
+
+    if (!(catalog = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*catalog) ))) return;
+    font_catalog = catalog;
+
+    if (!get_font_catalog_path( path )) return;
+    file = CreateFileW( path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, 0 );
+    if (file == INVALID_HANDLE_VALUE) return;
+
+    if (GetFileSizeEx( file, &size ) && size.QuadPart && size.QuadPart < 0x7fffffff &&
+        (mapping = CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL )))
+    {
+        catalog->view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+        CloseHandle( mapping );
+    }
+    CloseHandle( file );
+
+    if (catalog->view && !validate_font_catalog( catalog, catalog->view, size.QuadPart ))
+    {
+        WARN( "ignoring invalid font catalog %s\n", debugstr_w(path) );
+        catalog->files = NULL;
+        catalog->faces = NULL;
+        catalog->file_count = 0;
+    }
+}
+
+static DWORD font_catalog_add_string( struct font_catalog *catalog, const void *str, DWORD len )
+{
+    DWORD offset = (catalog->new_strings_len + 1) & ~1;  /* keep WCHAR strings aligned */
+
+    if (offset + len > catalog->new_strings_size)
+    {
+        DWORD new_size = max( max( 4096, catalog->new_strings_size * 2 ), offset + len );
+        char *new_strings;
+
+        if (catalog->new_strings)
+            new_strings = HeapReAlloc( GetProcessHeap(), 0, catalog->new_strings, new_size );
+        else
+            new_strings = HeapAlloc( GetProcessHeap(), 0, new_size );
+        if (!new_strings) return FONT_CATALOG_NO_NAME;
+        catalog->new_strings = new_strings;
+        catalog->new_strings_size = new_size;
+    }
+    if (offset > catalog->new_strings_len) catalog->new_strings[catalog->new_strings_len] = 0;
+    memcpy( catalog->new_strings + offset, str, len );
+    catalog->new_strings_len = offset + len;
+    return offset;
+}
+
+static inline DWORD font_catalog_add_stringW( struct font_catalog *catalog, const WCHAR *str )
+{
+    if (!str) return FONT_CATALOG_NO_NAME;
+    return font_catalog_add_string( catalog, str, (strlenW( str ) + 1) * sizeof(WCHAR) );
+}
+
+static BOOL font_catalog_grow( void **array, DWORD *size, DWORD count, DWORD elem_size )
+{
+    DWORD new_size;
+    void *new_array;
+
+    if (count < *size) return TRUE;
+    new_size = max( 64, *size * 2 );
+    if (*array) new_array = HeapReAlloc( GetProcessHeap(), 0, *array, new_size * elem_size );
+    else new_array = HeapAlloc( GetProcessHeap(), 0, new_size * elem_size );
+    if (!new_array) return FALSE;
+    *array = new_array;
+    *size = new_size;
+    return TRUE;
+}
+
+static struct font_catalog_file *font_catalog_add_file( struct font_catalog *catalog, const char *file,
+                                                        const struct stat *st, DWORD flags )
+{
+    struct font_catalog_file *entry;
+
+    if (!font_catalog_grow( (void **)&catalog->new_files, &catalog->new_files_size,
+                            catalog->new_file_count, sizeof(*entry) ))
+        return NULL;
+
+    entry = &catalog->new_files[catalog->new_file_count];
+    entry->size = st->st_size;
+    entry->mtime = st->st_mtime;
+    entry->flags = flags & ADDFONT_ALLOW_BITMAP;
+    entry->first_face = catalog->new_face_count;
+    entry->face_count = 0;
+    if ((entry->path = font_catalog_add_string( catalog, file, strlen( file ) + 1 )) == FONT_CATALOG_NO_NAME)
+        return NULL;
+    catalog->new_file_count++;
+    return entry;
+}
+
+static void font_catalog_add_face( struct font_catalog *catalog, const Face *face, const Family *family )
+{
+    struct font_catalog_face *entry;
+
+    if (!catalog->recording) return;
+    if (!font_catalog_grow( (void **)&catalog->new_faces, &catalog->new_faces_size,
+                            catalog->new_face_count, sizeof(*entry) ))
+    {
+        /* forget about this file rather than storing an incomplete face list */
+        catalog->new_file_count--;
+        catalog->recording = NULL;
+        return;
+    }
+
+    entry = &catalog->new_faces[catalog->new_face_count++];
+    entry->family_name = font_catalog_add_stringW( catalog, family->family_name );
+    entry->english_name = font_catalog_add_stringW( catalog, family->english_name[0] ? family->english_name : NULL );
+    entry->style_name = font_catalog_add_stringW( catalog, face->style_name );
+    entry->full_name = font_catalog_add_stringW( catalog, face->full_name );
+    entry->face_index = face->face_index;
+    entry->flags = face->flags & ADDFONT_VERTICAL_FONT;
+    entry->ntm_flags = face->ntmFlags;
+    entry->font_version = face->font_version;
+    entry->fs = face->fs;
+    entry->scalable = face->scalable;
+    entry->height = face->size.height;
+    entry->width = face->size.width;
+    entry->size = face->size.size;
+    entry->x_ppem = face->size.x_ppem;
+    entry->y_ppem = face->size.y_ppem;
+    entry->internal_leading = face->size.internal_leading;
+    entry->pad = 0;
+    catalog->recording->face_count++;
+}
+
+static const struct font_catalog_file *find_font_catalog_file( const struct font_catalog *catalog,
+                                                               const char *file, DWORD flags )
+{
+    int min = 0, max = catalog->file_count - 1;
+
+    while (min <= max)
+    {
+        int pos = (min + max) / 2;
+        int res = compare_font_catalog_files( file, flags, catalog->strings + catalog->files[pos].path,
+                                              catalog->files[pos].flags );
+        if (!res) return &catalog->files[pos];
+        if (res < 0) max = pos - 1;
+        else min = pos + 1;
+    }
+    return NULL;
+}
+
+static inline const WCHAR *font_catalog_string( const struct font_catalog *catalog, DWORD offset )
+{
+    if (offset == FONT_CATALOG_NO_NAME) return NULL;
+    return (const WCHAR *)(catalog->strings + offset);
+}
+
+/* add the faces of a font file from the catalog; returns -1 if the file isn't in it or is out of date */
+static int add_font_from_catalog( const char *file, DWORD flags )
+{
+    struct font_catalog *catalog = font_catalog;
+    const struct font_catalog_file *entry;
+    const struct font_catalog_face *cached;
+    struct stat st;
+    DWORD i;
+
+    if (!catalog) return -1;
+    catalog->recording = NULL;
+    if (!(flags & ADDFONT_ADD_TO_CACHE) || stat( file, &st )) return -1;
+
+    if (!(entry = find_font_catalog_file( catalog, file, flags & ADDFONT_ALLOW_BITMAP )) ||
+        entry->size != st.st_size || entry->mtime != st.st_mtime)
+    {
+        /* the caller loads the file through FreeType, record the faces it finds */
+        catalog->misses++;
+        catalog->recording = font_catalog_add_file( catalog, file, &st, flags );
+        return -1;
+    }
+
+    catalog->hits++;
+    catalog->recording = font_catalog_add_file( catalog, file, &st, flags );
+    if (!HIWORD( flags )) flags |= ADDFONT_AA_FLAGS( default_aa_flags );
+
+    for (i = 0, cached = catalog->faces + entry->first_face; i < entry->face_count; i++, cached++)
+    {
+        Family *family;
+        Face *face = HeapAlloc( GetProcessHeap(), 0, sizeof(*face) );
+
+        face->refcount = 1;
+        face->style_name = strdupW( font_catalog_string( catalog, cached->style_name ));
+        face->full_name = strdupW( font_catalog_string( catalog, cached->full_name ));
+        face->file = towstr( CP_UNIXCP, file );
+        face->dev = st.st_dev;
+        face->ino = st.st_ino;
+        face->font_data_ptr = NULL;
+        face->font_data_size = 0;
+        face->face_index = cached->face_index;
+        face->fs = cached->fs;
+        face->ntmFlags = cached->ntm_flags;
+        face->font_version = cached->font_version;
+        face->scalable = cached->scalable;
+        face->size.height = cached->height;
+        face->size.width = cached->width;
+        face->size.size = cached->size;
+        face->size.x_ppem = cached->x_ppem;
+        face->size.y_ppem = cached->y_ppem;
+        face->size.internal_leading = cached->internal_leading;
+        face->flags = flags | cached->flags;
+        face->family = NULL;
+        face->cached_enum_data = NULL;
+
+        family = find_or_create_family( font_catalog_string( catalog, cached->family_name ),
+                                        font_catalog_string( catalog, cached->english_name ));
+        font_catalog_add_face( catalog, face, family );
+        add_face_to_family( face, family, face->flags );
+    }
+    catalog->recording = NULL;
+    return entry->face_count;
+}
+
+/* string table used while sorting the new catalog, accessed under the font mutex */
+static const char *font_catalog_sort_strings;
+
+static int sort_font_catalog_files( const void *p1, const void *p2 )
+{
+    const struct font_catalog_file *file1 = p1, *file2 = p2;
+
+    return compare_font_catalog_files( font_catalog_sort_strings + file1->path, file1->flags,
+                                       font_catalog_sort_strings + file2->path, file2->flags );
+}
+
+/* sort the new file entries and drop duplicates for files that were added more than once */
+static void sort_font_catalog( struct font_catalog *catalog )
+{
+    DWORD i, j;
+
+    font_catalog_sort_strings = catalog->new_strings;
+    qsort( catalog->new_files, catalog->new_file_count, sizeof(*catalog->new_files), sort_font_catalog_files );
+    for (i = j = 0; i < catalog->new_file_count; i++)
+    {
+        if (j && !sort_font_catalog_files( &catalog->new_files[j - 1], &catalog->new_files[i] )) continue;
+        catalog->new_files[j++] = catalog->new_files[i];
+    }
+    catalog->new_file_count = j;
+    font_catalog_sort_strings = NULL;
+}
+
+static void write_font_catalog( struct font_catalog *catalog )
+{
+    static const WCHAR tmpW[] = {'.','t','m','p',0};
+    static const WCHAR emptyW[] = {0};
+    struct font_catalog_header header;
+    WCHAR path[MAX_PATH], tmp_path[MAX_PATH + ARRAY_SIZE(tmpW)];
+    DWORD written;
+    HANDLE file;
+    BOOL ret;
+
+    if (!get_font_catalog_path( path )) return;
+
+    /* keep the table null-terminated and its size a multiple of WCHAR */
+    if (font_catalog_add_stringW( catalog, emptyW ) == FONT_CATALOG_NO_NAME) return;
+
+    header.magic = FONT_CATALOG_MAGIC;
+    header.version = FONT_CATALOG_VERSION;
+    header.lcid = GetSystemDefaultLCID();
+    header.file_count = catalog->new_file_count;
+    header.face_count = catalog->new_face_count;
+    header.strings_size = catalog->new_strings_len;
+
+    strcpyW( tmp_path, path );
+    strcatW( tmp_path, tmpW );
+    file = CreateFileW( tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, 0 );
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        WARN( "can't create %s, error %u\n", debugstr_w(tmp_path), GetLastError() );
+        return;
+    }
+    ret = WriteFile( file, &header, sizeof(header), &written, NULL ) &&
+          WriteFile( file, catalog->new_files, header.file_count * sizeof(*catalog->new_files), &written, NULL ) &&
+          WriteFile( file, catalog->new_faces, header.face_count * sizeof(*catalog->new_faces), &written, NULL ) &&
+          WriteFile( file, catalog->new_strings, header.strings_size, &written, NULL );
+    CloseHandle( file );
+
+    if (!ret || !MoveFileExW( tmp_path, path, MOVEFILE_REPLACE_EXISTING ))
+    {
+        WARN( "failed to write %s, error %u\n", debugstr_w(path), GetLastError() );
+        DeleteFileW( tmp_path );
+        return;
+    }
+    TRACE( "wrote %u files, %u faces to %s\n", header.file_count, header.face_count, debugstr_w(path) );
+}
+
+static void close_font_catalog(void)
+{
+    struct font_catalog *catalog = font_catalog;
+
+    if (!catalog) return;
+    font_catalog = NULL;
+
+    TRACE( "%u hits, %u misses\n", catalog->hits, catalog->misses );
+
+    /* unmap first, the file may be replaced */
+    if (catalog->view) UnmapViewOfFile( catalog->view );
+    sort_font_catalog( catalog );
+    if (catalog->misses || catalog->new_file_count != catalog->file_count) write_font_catalog( catalog );
+
+    HeapFree( GetProcessHeap(), 0, catalog->new_files );
+    HeapFree( GetProcessHeap(), 0, catalog->new_faces );
+    HeapFree( GetProcessHeap(), 0, catalog->new_strings );
+    HeapFree( GetProcessHeap(), 0, catalog );
+}
+
+static void AddFaceToList(FT_Face ft_face, const char *file, void *font_data_ptr, DWORD font_data_size,
+                          FT_Long face_index, DWORD flags )
+{
+    Face *face;
+    Family *family;
+
+    face = create_face( ft_face, face_index, file, font_data_ptr, font_data_size, flags );
+    family = get_family( ft_face, flags & ADDFONT_VERTICAL_FONT );
+
+    if (file && font_catalog) font_catalog_add_face( font_catalog, face, family );
+    add_face_to_family( face, family, flags );
+}
+
 static FT_Face new_ft_face( const char *file, void *font_data_ptr, DWORD font_data_size,
                             FT_Long face_index, BOOL allow_bitmap )
 {
@@ -2286,6 +2757,9 @@ static INT AddFontToList(const char *file, void *font_data_ptr, DWORD font_data_
     }
 #endif /* HAVE_CARBON_CARBON_H */
 
+    if (file && (ret = add_font_from_catalog( file, flags )) >= 0) return ret;
+    ret = 0;
+
     do {
         FONTSIGNATURE fs;
 
@@ -4260,6 +4734,8 @@ static void init_font_list(void)
 
     delete_external_font_keys();
 
+    open_font_catalog();
+
     /* load the system bitmap fonts */
     load_system_fonts();
 
@@ -4369,6 +4845,8 @@ static void init_font_list(void)
         }
         RegCloseKey(hkey);
     }
+
+    close_font_catalog();
 }
 
 static BOOL move_to_front(const WCHAR *name)
@@ -399,6 +399,47 @@ static GpStatus get_clip_hrgn(GpGraphics *graphics, HRGN *hrgn)
     return stat;
 }
 
+/* Composites whole rows onto 32bpp ARGB and RGB bitmaps, which store the same
+ * ARGB values GdipBitmapGetPixel and GdipBitmapSetPixel would use. */
+static void alpha_blend_bmp_span(GpBitmap *dst_bitmap, INT dst_x, INT dst_y,
+    const BYTE *src, INT src_width, INT src_height, INT src_stride, PixelFormat fmt,
+    CompositingMode comp_mode)
+{
+    DWORD alpha_mask = dst_bitmap->format == PixelFormat32bppRGB ? 0xff000000 : 0;
+    DWORD store_mask = ~alpha_mask;
+    INT x, y, start_x, end_x;
+
+    start_x = max(0, -dst_x);
+    end_x = min(src_width, dst_bitmap->width - dst_x);
+
+    for (y = max(0, -dst_y); y < src_height && y + dst_y < dst_bitmap->height; y++)
+    {
+        const ARGB *src_row = (const ARGB *)(src + src_stride * y);
+        DWORD *dst_row = (DWORD *)(dst_bitmap->bits + dst_bitmap->stride * (y + dst_y)) + dst_x;
+
+        for (x = start_x; x < end_x; x++)
+        {
+            ARGB src_color = src_row[x];
+
+            if (comp_mode == CompositingModeSourceCopy)
+            {
+                dst_row[x] = (src_color & 0xff000000) ? src_color & store_mask : 0;
+                continue;
+            }
+
+            if (!(src_color & 0xff000000))
+                continue;
+
+            if ((src_color & 0xff000000) == 0xff000000)
+                dst_row[x] = src_color & store_mask;
+            else if (fmt & PixelFormatPAlpha)
+                dst_row[x] = color_over_fgpremult(dst_row[x] | alpha_mask, src_color) & store_mask;
+            else
+                dst_row[x] = color_over(dst_row[x] | alpha_mask, src_color) & store_mask;
+        }
+    }
+}
+
 /* Draw ARGB data to the given graphics object */
 static GpStatus alpha_blend_bmp_pixels(GpGraphics *graphics, INT dst_x, INT dst_y,
     const BYTE *src, INT src_width, INT src_height, INT src_stride, const PixelFormat fmt)
@@ -409,6 +450,14 @@ static GpStatus alpha_blend_bmp_pixels(GpGraphics *graphics, INT dst_x, INT dst_
 
     GdipGetCompositingMode(graphics, &comp_mode);
 
+    if (dst_bitmap->bits && (dst_bitmap->format == PixelFormat32bppARGB ||
+        dst_bitmap->format == PixelFormat32bppRGB))
+    {
+        alpha_blend_bmp_span(dst_bitmap, dst_x, dst_y, src, src_width, src_height,
+            src_stride, fmt, comp_mode);
+        return Ok;
+    }
+
     for (y=0; y<src_height; y++)
     {
         for (x=0; x<src_width; x++)
@@ -952,7 +1001,23 @@ static void get_bitmap_sample_size(InterpolationMode interpolation, WrapMode wra
     rect->Height = bottom - top + 1;
 }
 
-static ARGB sample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT width,
+/* Sampling state for one draw call, so that whole destination spans can be
+ * resampled without redoing the setup for each pixel. */
+struct bitmap_sampler
+{
+    const GpRect *src_rect;     /* area of the bitmap present in bits */
+    const ARGB *bits;
+    UINT width, height;         /* size of the whole bitmap */
+    const GpImageAttributes *attributes;
+    InterpolationMode interpolation;
+    PixelOffsetMode offset_mode;
+    GpPointF origin;            /* source point of destination pixel (0,0) */
+    REAL x_dx, x_dy, y_dx, y_dy;
+    BOOL clip;                  /* destination pixels mapping outside bounds are transparent */
+    GpRectF bounds;
+};
+
+static ARGB sample_bitmap_pixel(GDIPCONST GpRect *src_rect, const ARGB *bits, UINT width,
     UINT height, INT x, INT y, GDIPCONST GpImageAttributes *attributes)
 {
     if (attributes->wrap == WrapModeClamp)
@@ -995,20 +1060,31 @@ static ARGB sample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT wi
         return 0xffcd0084;
     }
 
-    return ((DWORD*)(bits))[(x - src_rect->X) + (y - src_rect->Y) * src_rect->Width];
+    return bits[(x - src_rect->X) + (y - src_rect->Y) * src_rect->Width];
+}
+
+/* Inside the bitmap neither clamping nor tiling changes the co-ordinates, so
+ * pixels can be read directly when both are also inside the sampled area. */
+static inline BOOL sample_is_direct(const struct bitmap_sampler *sampler, INT left, INT top,
+    INT right, INT bottom)
+{
+    const GpRect *rect = sampler->src_rect;
+
+    return left >= 0 && top >= 0 && right < sampler->width && bottom < sampler->height &&
+        left >= rect->X && top >= rect->Y &&
+        right < rect->X + rect->Width && bottom < rect->Y + rect->Height;
 }
 
-static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT width,
-    UINT height, GpPointF *point, GDIPCONST GpImageAttributes *attributes,
-    InterpolationMode interpolation, PixelOffsetMode offset_mode)
+static ARGB resample_bitmap_pixel(const struct bitmap_sampler *sampler, const GpPointF *point)
 {
+    const GpRect *src_rect = sampler->src_rect;
     static int fixme;
 
-    switch (interpolation)
+    switch (sampler->interpolation)
     {
     default:
         if (!fixme++)
-            FIXME("Unimplemented interpolation %i\n", interpolation);
+            FIXME("Unimplemented interpolation %i\n", sampler->interpolation);
         /* fall-through */
     case InterpolationModeBilinear:
     {
@@ -1026,17 +1102,34 @@ static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT
         bottomy = (INT)ceilf(point->Y);
 
         if (leftx == rightx && topy == bottomy)
-            return sample_bitmap_pixel(src_rect, bits, width, height,
-                leftx, topy, attributes);
-
-        topleft = sample_bitmap_pixel(src_rect, bits, width, height,
-            leftx, topy, attributes);
-        topright = sample_bitmap_pixel(src_rect, bits, width, height,
-            rightx, topy, attributes);
-        bottomleft = sample_bitmap_pixel(src_rect, bits, width, height,
-            leftx, bottomy, attributes);
-        bottomright = sample_bitmap_pixel(src_rect, bits, width, height,
-            rightx, bottomy, attributes);
+            return sample_bitmap_pixel(src_rect, sampler->bits, sampler->width, sampler->height,
+                leftx, topy, sampler->attributes);
+
+        if (sample_is_direct(sampler, leftx, topy, rightx, bottomy))
+        {
+            const ARGB *top_row = sampler->bits + (topy - src_rect->Y) * src_rect->Width - src_rect->X;
+            const ARGB *bottom_row = top_row + (bottomy - topy) * src_rect->Width;
+
+            topleft = top_row[leftx];
+            topright = top_row[rightx];
+            bottomleft = bottom_row[leftx];
+            bottomright = bottom_row[rightx];
+        }
+        else
+        {
+            topleft = sample_bitmap_pixel(src_rect, sampler->bits, sampler->width, sampler->height,
+                leftx, topy, sampler->attributes);
+            topright = sample_bitmap_pixel(src_rect, sampler->bits, sampler->width, sampler->height,
+                rightx, topy, sampler->attributes);
+            bottomleft = sample_bitmap_pixel(src_rect, sampler->bits, sampler->width, sampler->height,
+                leftx, bottomy, sampler->attributes);
+            bottomright = sample_bitmap_pixel(src_rect, sampler->bits, sampler->width, sampler->height,
+                rightx, bottomy, sampler->attributes);
+        }
+
+        /* Blending equal colors gives the same color back, unless it's fully transparent. */
+        if (topleft == topright && topleft == bottomleft && topleft == bottomright)
+            return (topleft & 0xff000000) ? topleft : 0;
 
         x_offset = point->X - leftxf;
         top = blend_colors(topleft, topright, x_offset);
@@ -1047,7 +1140,7 @@ static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT
     case InterpolationModeNearestNeighbor:
     {
         FLOAT pixel_offset;
-        switch (offset_mode)
+        switch (sampler->offset_mode)
         {
         default:
         case PixelOffsetModeNone:
@@ -1060,10 +1153,30 @@ static ARGB resample_bitmap_pixel(GDIPCONST GpRect *src_rect, LPBYTE bits, UINT
             pixel_offset = 0.0;
             break;
         }
-        return sample_bitmap_pixel(src_rect, bits, width, height,
-            floorf(point->X + pixel_offset), floorf(point->Y + pixel_offset), attributes);
+        return sample_bitmap_pixel(src_rect, sampler->bits, sampler->width, sampler->height,
+            floorf(point->X + pixel_offset), floorf(point->Y + pixel_offset), sampler->attributes);
+    }
+
     }
+}
+
+/* Resamples count destination pixels starting at (x,y). */
+static void resample_bitmap_span(const struct bitmap_sampler *sampler, INT x, INT y, INT count, ARGB *dst)
+{
+    const GpRectF *bounds = &sampler->bounds;
+    GpPointF point;
+    INT i;
 
+    for (i = 0; i < count; i++, x++)
+    {
+        point.X = sampler->origin.X + x * sampler->x_dx + y * sampler->y_dx;
+        point.Y = sampler->origin.Y + x * sampler->x_dy + y * sampler->y_dy;
+
+        if (sampler->clip && !(point.X >= bounds->X && point.X < bounds->X + bounds->Width &&
+                point.Y >= bounds->Y && point.Y < bounds->Y + bounds->Height))
+            dst[i] = 0;
+        else
+            dst[i] = resample_bitmap_pixel(sampler, &point);
     }
 }
 
@@ -1190,9 +1303,9 @@ static GpStatus brush_fill_pixels(GpGraphics *graphics, GpBrush *brush,
     {
         int x, y;
         GpSolidFill *fill = (GpSolidFill*)brush;
-        for (x=0; x<fill_area->Width; x++)
-            for (y=0; y<fill_area->Height; y++)
-                argb_pixels[x + y*cdwStride] = fill->color;
+        for (y=0; y<fill_area->Height; y++, argb_pixels += cdwStride)
+            for (x=0; x<fill_area->Width; x++)
+                argb_pixels[x] = fill->color;
         return Ok;
     }
     case BrushTypeHatchFill:
@@ -1265,11 +1378,30 @@ static GpStatus brush_fill_pixels(GpGraphics *graphics, GpBrush *brush,
 
             for (y=0; y<fill_area->Height; y++)
             {
+                DWORD *row = argb_pixels + y*cdwStride;
+
+                /* Every row of a horizontal gradient is the same, and every
+                 * row of a vertical one is a single color. */
+                if (y && y_delta == 0.0f)
+                {
+                    memcpy(row, argb_pixels, fill_area->Width * sizeof(*row));
+                    continue;
+                }
+
+                if (x_delta == 0.0f)
+                {
+                    ARGB color = blend_line_gradient(fill, draw_points[0].X + y * y_delta);
+
+                    for (x=0; x<fill_area->Width; x++)
+                        row[x] = color;
+                    continue;
+                }
+
                 for (x=0; x<fill_area->Width; x++)
                 {
                     REAL pos = draw_points[0].X + x * x_delta + y * y_delta;
 
-                    argb_pixels[x + y*cdwStride] = blend_line_gradient(fill, pos);
+                    row[x] = blend_line_gradient(fill, pos);
                 }
             }
         }
@@ -1281,7 +1413,7 @@ static GpStatus brush_fill_pixels(GpGraphics *graphics, GpBrush *brush,
         GpTexture *fill = (GpTexture*)brush;
         GpPointF draw_points[3];
         GpStatus stat;
-        int x, y;
+        int y;
         GpBitmap *bitmap;
         int src_stride;
         GpRect src_area;
@@ -1356,25 +1488,24 @@ static GpStatus brush_fill_pixels(GpGraphics *graphics, GpBrush *brush,
 
         if (stat == Ok)
         {
-            REAL x_dx = draw_points[1].X - draw_points[0].X;
-            REAL x_dy = draw_points[1].Y - draw_points[0].Y;
-            REAL y_dx = draw_points[2].X - draw_points[0].X;
-            REAL y_dy = draw_points[2].Y - draw_points[0].Y;
+            struct bitmap_sampler sampler;
+
+            sampler.src_rect = &src_area;
+            sampler.bits = (const ARGB *)fill->bitmap_bits;
+            sampler.width = bitmap->width;
+            sampler.height = bitmap->height;
+            sampler.attributes = fill->imageattributes;
+            sampler.interpolation = graphics->interpolation;
+            sampler.offset_mode = graphics->pixeloffset;
+            sampler.origin = draw_points[0];
+            sampler.x_dx = draw_points[1].X - draw_points[0].X;
+            sampler.x_dy = draw_points[1].Y - draw_points[0].Y;
+            sampler.y_dx = draw_points[2].X - draw_points[0].X;
+            sampler.y_dy = draw_points[2].Y - draw_points[0].Y;
+            sampler.clip = FALSE;
 
             for (y=0; y<fill_area->Height; y++)
-            {
-                for (x=0; x<fill_area->Width; x++)
-                {
-                    GpPointF point;
-                    point.X = draw_points[0].X + x * x_dx + y * y_dx;
-                    point.Y = draw_points[0].Y + y * x_dy + y * y_dy;
-
-                    argb_pixels[x + y*cdwStride] = resample_bitmap_pixel(
-                        &src_area, fill->bitmap_bits, bitmap->width, bitmap->height,
-                        &point, fill->imageattributes, graphics->interpolation,
-                        graphics->pixeloffset);
-                }
-            }
+                resample_bitmap_span(&sampler, 0, y, fill_area->Width, argb_pixels + y*cdwStride);
         }
 
         return stat;
@@ -3125,7 +3256,8 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
             RECT dst_area;
             GpRectF graphics_bounds;
             GpRect src_area;
-            int i, x, y, src_stride, dst_stride;
+            int i, y, src_stride, dst_stride;
+            struct bitmap_sampler sampler;
             GpMatrix dst_to_src;
             REAL m11, m12, m21, m22, mdx, mdy;
             LPBYTE src_data, dst_data, dst_dyn_data=NULL;
@@ -3133,7 +3265,6 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
             InterpolationMode interpolation = graphics->interpolation;
             PixelOffsetMode offset_mode = graphics->pixeloffset;
             GpPointF dst_to_src_points[3] = {{0.0, 0.0}, {1.0, 0.0}, {0.0, 1.0}};
-            REAL x_dx, x_dy, y_dx, y_dy;
             static const GpImageAttributes defaultImageAttributes = {WrapModeClamp, 0, FALSE};
 
             if (!imageAttributes)
@@ -3234,29 +3365,28 @@ GpStatus WINGDIPAPI GdipDrawImagePointsRect(GpGraphics *graphics, GpImage *image
 
                 GdipTransformMatrixPoints(&dst_to_src, dst_to_src_points, 3);
 
-                x_dx = dst_to_src_points[1].X - dst_to_src_points[0].X;
-                x_dy = dst_to_src_points[1].Y - dst_to_src_points[0].Y;
-                y_dx = dst_to_src_points[2].X - dst_to_src_points[0].X;
-                y_dy = dst_to_src_points[2].Y - dst_to_src_points[0].Y;
-
-                for (x=dst_area.left; x<dst_area.right; x++)
+                sampler.src_rect = &src_area;
+                sampler.bits = (const ARGB *)src_data;
+                sampler.width = bitmap->width;
+                sampler.height = bitmap->height;
+                sampler.attributes = imageAttributes;
+                sampler.interpolation = interpolation;
+                sampler.offset_mode = offset_mode;
+                sampler.origin = dst_to_src_points[0];
+                sampler.x_dx = dst_to_src_points[1].X - dst_to_src_points[0].X;
+                sampler.x_dy = dst_to_src_points[1].Y - dst_to_src_points[0].Y;
+                sampler.y_dx = dst_to_src_points[2].X - dst_to_src_points[0].X;
+                sampler.y_dy = dst_to_src_points[2].Y - dst_to_src_points[0].Y;
+                sampler.clip = TRUE;
+                sampler.bounds.X = srcx;
+                sampler.bounds.Y = srcy;
+                sampler.bounds.Width = srcwidth;
+                sampler.bounds.Height = srcheight;
+
+                for (y=dst_area.top; y<dst_area.bottom; y++)
                 {
-                    for (y=dst_area.top; y<dst_area.bottom; y++)
-                    {
-                        GpPointF src_pointf;
-                        ARGB *dst_color;
-
-                        src_pointf.X = dst_to_src_points[0].X + x * x_dx + y * y_dx;
-                        src_pointf.Y = dst_to_src_points[0].Y + x * x_dy + y * y_dy;
-
-                        dst_color = (ARGB*)(dst_data + dst_stride * (y - dst_area.top) + sizeof(ARGB) * (x - dst_area.left));
-
-                        if (src_pointf.X >= srcx && src_pointf.X < srcx + srcwidth && src_pointf.Y >= srcy && src_pointf.Y < srcy+srcheight)
-                            *dst_color = resample_bitmap_pixel(&src_area, src_data, bitmap->width, bitmap->height, &src_pointf,
-                                                               imageAttributes, interpolation, offset_mode);
-                        else
-                            *dst_color = 0;
-                    }
+                    resample_bitmap_span(&sampler, dst_area.left, y, dst_area.right - dst_area.left,
+                        (ARGB *)(dst_data + dst_stride * (y - dst_area.top)));
                 }
             }
             else
@@ -6611,6 +6611,60 @@ static void test_GdipFillRectanglesOnBitmapTextureBrush(void)
     GdipFree(src_img_data);
 }
 
+static void test_GdipFillRectangleRotatedTextureBrush(void)
+{
+    GpBitmap *src_bitmap, *dst_bitmap;
+    GpGraphics *graphics;
+    GpTexture *brush;
+    GpStatus status;
+    ARGB color;
+    UINT x, y;
+
+    /* The top half of the texture is red and the bottom half blue. Rotated
+     * by 90 degrees, the brush's color depends on the x coordinate only. */
+    status = GdipCreateBitmapFromScan0(8, 8, 0, PixelFormat32bppARGB, NULL, &src_bitmap);
+    expect(Ok, status);
+    for (y = 0; y < 8; y++)
+    {
+        for (x = 0; x < 8; x++)
+        {
+            status = GdipBitmapSetPixel(src_bitmap, x, y, y < 4 ? 0xffff0000 : 0xff0000ff);
+            expect(Ok, status);
+        }
+    }
+
+    status = GdipCreateTexture((GpImage *)src_bitmap, WrapModeTile, &brush);
+    expect(Ok, status);
+    status = GdipRotateTextureTransform(brush, 90.0f, MatrixOrderAppend);
+    expect(Ok, status);
+
+    status = GdipCreateBitmapFromScan0(8, 8, 0, PixelFormat32bppARGB, NULL, &dst_bitmap);
+    expect(Ok, status);
+    status = GdipGetImageGraphicsContext((GpImage *)dst_bitmap, &graphics);
+    expect(Ok, status);
+    status = GdipSetInterpolationMode(graphics, InterpolationModeNearestNeighbor);
+    expect(Ok, status);
+
+    status = GdipFillRectangleI(graphics, (GpBrush *)brush, 0, 0, 8, 8);
+    expect(Ok, status);
+
+    for (y = 1; y < 8; y += 5)
+    {
+        status = GdipBitmapGetPixel(dst_bitmap, 1, y, &color);
+        expect(Ok, status);
+        ok(color == 0xff0000ff, "Expected 0xff0000ff at 1,%u, got %08x.\n", y, color);
+
+        status = GdipBitmapGetPixel(dst_bitmap, 6, y, &color);
+        expect(Ok, status);
+        ok(color == 0xffff0000, "Expected 0xffff0000 at 6,%u, got %08x.\n", y, color);
+    }
+
+    GdipDeleteGraphics(graphics);
+    GdipDeleteBrush((GpBrush *)brush);
+    GdipDisposeImage((GpImage *)dst_bitmap);
+    GdipDisposeImage((GpImage *)src_bitmap);
+}
+
 static void test_GdipDrawImagePointsRectOnMemoryDC(void)
 {
     ARGB color[6] = {0,0,0,0,0,0};
@@ -7029,6 +7083,103 @@ static void test_gdi_interop_hdc(void)
     DeleteObject(hbm);
 }
 
+static void test_software_rendering(void)
+{
+    static const GpPointF rotated[3] = {{64.0, 4.0}, {124.0, 64.0}, {4.0, 64.0}};
+    GpPointF start = {0.0, 0.0}, end = {128.0, 0.0};
+    GpGraphics *graphics;
+    GpBitmap *target, *image;
+    GpLineGradient *gradient;
+    GpSolidFill *brush;
+    GpPath *path;
+    GpPen *pen;
+    GpStatus status;
+    ARGB color, color2;
+    DWORD start_time;
+    int i, x, y;
+
+    status = GdipCreateBitmapFromScan0(128, 128, 0, PixelFormat32bppARGB, NULL, &target);
+    expect(Ok, status);
+    status = GdipGetImageGraphicsContext((GpImage *)target, &graphics);
+    expect(Ok, status);
+
+    status = GdipCreateBitmapFromScan0(64, 64, 0, PixelFormat32bppARGB, NULL, &image);
+    expect(Ok, status);
+    for (y = 0; y < 64; y++)
+        for (x = 0; x < 64; x++)
+            GdipBitmapSetPixel(image, x, y, 0xff208040);
+
+    /* A rotated, bilinear filtered opaque image keeps its color away from the edges. */
+    status = GdipSetInterpolationMode(graphics, InterpolationModeBilinear);
+    expect(Ok, status);
+    status = GdipDrawImagePoints(graphics, (GpImage *)image, rotated, 3);
+    expect(Ok, status);
+    status = GdipBitmapGetPixel(target, 64, 40, &color);
+    expect(Ok, status);
+    ok(color == 0xff208040, "got %08x\n", color);
+    status = GdipBitmapGetPixel(target, 2, 2, &color);
+    expect(Ok, status);
+    ok(color == 0, "got %08x\n", color);
+
+    /* A horizontal gradient has the same color down each column. */
+    status = GdipCreateLineBrush(&start, &end, 0xff000000, 0xffffffff, WrapModeTile, &gradient);
+    expect(Ok, status);
+    status = GdipFillRectangle(graphics, (GpBrush *)gradient, 0.0, 0.0, 128.0, 128.0);
+    expect(Ok, status);
+    for (x = 0; x < 128; x += 9)
+    {
+        status = GdipBitmapGetPixel(target, x, 3, &color);
+        expect(Ok, status);
+        status = GdipBitmapGetPixel(target, x, 100, &color2);
+        expect(Ok, status);
+        ok(color == color2, "%d: got %08x and %08x\n", x, color, color2);
+    }
+    status = GdipBitmapGetPixel(target, 2, 50, &color);
+    expect(Ok, status);
+    status = GdipBitmapGetPixel(target, 125, 50, &color2);
+    expect(Ok, status);
+    ok((color & 0xff) < (color2 & 0xff), "got %08x and %08x\n", color, color2);
+
+    if (winetest_interactive)
+    {
+        status = GdipCreateSolidFill(0x80ff0000, &brush);
+        expect(Ok, status);
+        status = GdipCreatePen1(0xff0000ff, 3.0, UnitPixel, &pen);
+        expect(Ok, status);
+        status = GdipCreatePath(FillModeAlternate, &path);
+        expect(Ok, status);
+        for (i = 0; i < 16; i++)
+            GdipAddPathEllipse(path, i * 4.0, i * 3.0, 120.0 - i * 6.0, 100.0 - i * 5.0);
+
+        start_time = GetTickCount();
+        for (i = 0; i < 200; i++)
+            GdipDrawImagePoints(graphics, (GpImage *)image, rotated, 3);
+        trace("rotated images: %u ms\n", GetTickCount() - start_time);
+
+        start_time = GetTickCount();
+        for (i = 0; i < 200; i++)
+            GdipFillRectangle(graphics, (GpBrush *)gradient, 0.0, 0.0, 128.0, 128.0);
+        trace("gradient fills: %u ms\n", GetTickCount() - start_time);
+
+        start_time = GetTickCount();
+        for (i = 0; i < 200; i++)
+        {
+            GdipFillPath(graphics, (GpBrush *)brush, path);
+            GdipDrawPath(graphics, pen, path);
+        }
+        trace("paths: %u ms\n", GetTickCount() - start_time);
+
+        GdipDeletePath(path);
+        GdipDeletePen(pen);
+        GdipDeleteBrush((GpBrush *)brush);
+    }
+
+    GdipDeleteBrush((GpBrush *)gradient);
+    GdipDisposeImage((GpImage *)image);
+    GdipDeleteGraphics(graphics);
+    GdipDisposeImage((GpImage *)target);
+}
+
 START_TEST(graphics)
 {
     struct GdiplusStartupInput gdiplusStartupInput;
@@ -7117,6 +7268,7 @@ START_TEST(graphics)
     test_GdipFillRectanglesOnMemoryDCSolidBrush();
     test_GdipFillRectanglesOnMemoryDCTextureBrush();
     test_GdipFillRectanglesOnBitmapTextureBrush();
+    test_GdipFillRectangleRotatedTextureBrush();
     test_GdipDrawImagePointsRectOnMemoryDC();
     test_container_rects();
     test_GdipGraphicsSetAbort();
@@ -7124,6 +7276,7 @@ START_TEST(graphics)
     test_hdc_caching();
     test_gdi_interop_bitmap();
     test_gdi_interop_hdc();
+    test_software_rendering();
 
     GdiplusShutdown(gdiplusToken);
     DestroyWindow( hwnd );
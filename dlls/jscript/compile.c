@@ -331,6 +331,25 @@ static HRESULT push_instr_uint_str(compiler_ctx_t *ctx, jsop_t op, unsigned arg1
     return S_OK;
 }
 
+static HRESULT push_instr_uint_uint(compiler_ctx_t *ctx, jsop_t op, unsigned arg1, unsigned arg2)
+{
+    unsigned instr;
+
+    instr = push_instr(ctx, op);
+    if(!instr)
+        return E_OUTOFMEMORY;
+
+    instr_ptr(ctx, instr)->u.arg[0].uint = arg1;
+    instr_ptr(ctx, instr)->u.arg[1].uint = arg2;
+    return S_OK;
+}
+
+/* Allocates a property lookup cache for an instruction. Slots are numbered from 1. */
+static unsigned alloc_prop_cache(compiler_ctx_t *ctx)
+{
+    return ++ctx->code->prop_cache_cnt;
+}
+
 static HRESULT push_instr_double(compiler_ctx_t *ctx, jsop_t op, double arg)
 {
     unsigned instr;
@@ -395,7 +414,7 @@ static HRESULT compile_member_expression(compiler_ctx_t *ctx, member_expression_
     if(FAILED(hres))
         return hres;
 
-    return push_instr_bstr(ctx, OP_member, expr->identifier);
+    return push_instr_bstr_uint(ctx, OP_member, expr->identifier, alloc_prop_cache(ctx));
 }
 
 #define LABEL_FLAG 0x80000000
@@ -463,7 +482,7 @@ static HRESULT emit_identifier(compiler_ctx_t *ctx, const WCHAR *identifier)
     int local_ref;
     if(bind_local(ctx, identifier, &local_ref))
         return push_instr_int(ctx, OP_local, local_ref);
-    return push_instr_bstr(ctx, OP_ident, identifier);
+    return push_instr_bstr_uint(ctx, OP_ident, identifier, alloc_prop_cache(ctx));
 }
 
 static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *expr, unsigned flags)
@@ -488,7 +507,7 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_uint(ctx, OP_memberid, flags);
+        hres = push_instr_uint_uint(ctx, OP_memberid, flags, 0);
         break;
     }
     case EXPR_MEMBER: {
@@ -508,7 +527,8 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_uint(ctx, OP_memberid, flags);
+        /* The name is constant, so the lookup may be cached. */
+        hres = push_instr_uint_uint(ctx, OP_memberid, flags, alloc_prop_cache(ctx));
         break;
     }
     DEFAULT_UNREACHABLE;
@@ -2256,6 +2276,7 @@ void release_bytecode(bytecode_t *code)
     heap_pool_free(&code->heap);
     heap_free(code->bstr_pool);
     heap_free(code->str_pool);
+    heap_free(code->prop_caches);
     heap_free(code->instrs);
     heap_free(code);
 }
@@ -2486,13 +2507,200 @@ static HRESULT compile_arguments(compiler_ctx_t *ctx, const WCHAR *args)
     return parse_arguments(ctx, args, ctx->code->global_code.params, NULL);
 }
 
+/*
+ * Compiled code is cached, so that scripts loaded by many short-lived script
+ * engines are compiled only once. Bytecode uses non-atomic reference counts
+ * (including the ones of the strings in its pools), so an entry is only ever
+ * used by the thread that compiled it, and only while nothing but the cache
+ * holds a reference to it. That also lets us update the per-use fields
+ * (source context and starting line) on reuse.
+ */
+#define CODE_CACHE_BUDGET (16 * 1024 * 1024)
+
+typedef struct {
+    struct list entry;
+    bytecode_t *code;
+    DWORD thread_id;
+    unsigned hash;
+    DWORD version;
+    BOOL from_eval;
+    WCHAR *args;
+    WCHAR *delimiter;
+    size_t size;
+} code_cache_entry_t;
+
+static struct list code_cache = LIST_INIT(code_cache);
+static size_t code_cache_size;
+
+static CRITICAL_SECTION code_cache_cs;
+static CRITICAL_SECTION_DEBUG code_cache_cs_debug =
+{
+    0, 0, &code_cache_cs,
+    { &code_cache_cs_debug.ProcessLocksList, &code_cache_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": code_cache_cs") }
+};
+static CRITICAL_SECTION code_cache_cs = { &code_cache_cs_debug, -1, 0, 0, 0, 0 };
+
+static unsigned code_cache_hash(const WCHAR *source)
+{
+    unsigned h = 2166136261u;
+
+    for(; *source; source++)
+        h = (h ^ *source) * 16777619u;
+    return h;
+}
+
+static inline BOOL strings_equal(const WCHAR *str1, const WCHAR *str2)
+{
+    return str1 && str2 ? !wcscmp(str1, str2) : str1 == str2;
+}
+
+static void free_code_cache_entry(code_cache_entry_t *entry)
+{
+    list_remove(&entry->entry);
+    code_cache_size -= entry->size;
+    release_bytecode(entry->code);
+    heap_free(entry->args);
+    heap_free(entry->delimiter);
+    heap_free(entry);
+}
+
+static BOOL is_thread_alive(DWORD thread_id)
+{
+    HANDLE thread;
+    DWORD code;
+
+    if(!(thread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, thread_id)))
+        return FALSE;
+    if(!GetExitCodeThread(thread, &code))
+        code = 0;
+    CloseHandle(thread);
+    return code == STILL_ACTIVE;
+}
+
+/* Frees least recently used entries until size more bytes fit in the budget. */
+static BOOL code_cache_make_room(size_t size)
+{
+    code_cache_entry_t *entry, *prev;
+    DWORD thread_id = GetCurrentThreadId();
+
+    LIST_FOR_EACH_ENTRY_SAFE_REV(entry, prev, &code_cache, code_cache_entry_t, entry) {
+        if(code_cache_size + size <= CODE_CACHE_BUDGET)
+            break;
+
+        /* Entries of other threads may only be freed once their thread is gone. */
+        if(entry->thread_id == thread_id ? entry->code->ref == 1 : !is_thread_alive(entry->thread_id))
+            free_code_cache_entry(entry);
+    }
+
+    return code_cache_size + size <= CODE_CACHE_BUDGET;
+}
+
+static bytecode_t *lookup_code_cache(script_ctx_t *ctx, const WCHAR *source, unsigned hash, const WCHAR *args,
+        const WCHAR *delimiter, BOOL from_eval)
+{
+    DWORD thread_id = GetCurrentThreadId();
+    code_cache_entry_t *entry;
+    bytecode_t *code = NULL;
+
+    EnterCriticalSection(&code_cache_cs);
+
+    LIST_FOR_EACH_ENTRY(entry, &code_cache, code_cache_entry_t, entry) {
+        if(entry->hash != hash || entry->thread_id != thread_id || entry->version != ctx->version
+           || entry->from_eval != from_eval || entry->code->ref != 1
+           || !strings_equal(entry->args, args) || !strings_equal(entry->delimiter, delimiter)
+           || wcscmp(entry->code->source, source))
+            continue;
+
+        list_remove(&entry->entry);
+        list_add_head(&code_cache, &entry->entry);
+        code = bytecode_addref(entry->code);
+        break;
+    }
+
+    LeaveCriticalSection(&code_cache_cs);
+    return code;
+}
+
+static void add_to_code_cache(script_ctx_t *ctx, bytecode_t *code, unsigned hash, const WCHAR *args,
+        const WCHAR *delimiter, BOOL from_eval, unsigned instr_cnt)
+{
+    code_cache_entry_t *entry;
+    size_t size;
+
+    size = sizeof(*code) + sizeof(*entry) + (lstrlenW(code->source) + 1) * sizeof(WCHAR) * 2
+        + instr_cnt * sizeof(instr_t) + (code->bstr_cnt + code->str_cnt) * 32
+        + code->prop_cache_cnt * sizeof(*code->prop_caches);
+    if(size > CODE_CACHE_BUDGET / 4)
+        return;
+
+    if(!(entry = heap_alloc_zero(sizeof(*entry))))
+        return;
+    if((args && !(entry->args = heap_strdupW(args)))
+       || (delimiter && !(entry->delimiter = heap_strdupW(delimiter)))) {
+        heap_free(entry->args);
+        heap_free(entry);
+        return;
+    }
+
+    entry->code = bytecode_addref(code);
+    entry->thread_id = GetCurrentThreadId();
+    entry->hash = hash;
+    entry->version = ctx->version;
+    entry->from_eval = from_eval;
+    entry->size = size;
+
+    EnterCriticalSection(&code_cache_cs);
+
+    if(code_cache_make_room(size)) {
+        list_add_head(&code_cache, &entry->entry);
+        code_cache_size += size;
+        entry = NULL;
+    }
+
+    LeaveCriticalSection(&code_cache_cs);
+
+    if(entry) {
+        release_bytecode(entry->code);
+        heap_free(entry->args);
+        heap_free(entry->delimiter);
+        heap_free(entry);
+    }
+}
+
+void free_code_cache(void)
+{
+    code_cache_entry_t *entry, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE(entry, next, &code_cache, code_cache_entry_t, entry)
+        free_code_cache_entry(entry);
+}
+
 HRESULT compile_script(script_ctx_t *ctx, const WCHAR *code, UINT64 source_context, unsigned start_line,
                        const WCHAR *args, const WCHAR *delimiter, BOOL from_eval, BOOL use_decode,
                        named_item_t *named_item, bytecode_t **ret)
 {
     compiler_ctx_t compiler = {0};
+    BOOL cacheable;
+    unsigned hash = 0;
     HRESULT hres;
 
+    /* Encoded scripts are decoded in place and conditional compilation depends on the context state. */
+    cacheable = !use_decode && !named_item && !ctx->cc;
+    if(cacheable) {
+        bytecode_t *cached;
+
+        hash = code_cache_hash(code ? code : L"");
+        if((cached = lookup_code_cache(ctx, code ? code : L"", hash, args, delimiter, from_eval))) {
+            TRACE("using cached code %p\n", cached);
+            cached->source_context = source_context;
+            cached->start_line = start_line;
+            cached->is_persistent = FALSE;
+            *ret = cached;
+            return S_OK;
+        }
+    }
+
     hres = init_code(&compiler, code, source_context, start_line);
     if(FAILED(hres))
         return hres;
@@ -2529,11 +2737,22 @@ HRESULT compile_script(script_ctx_t *ctx, const WCHAR *code, UINT64 source_conte
         return DISP_E_EXCEPTION;
     }
 
+    if(compiler.code->prop_cache_cnt) {
+        compiler.code->prop_caches = heap_alloc_zero(compiler.code->prop_cache_cnt * sizeof(*compiler.code->prop_caches));
+        if(!compiler.code->prop_caches) {
+            release_bytecode(compiler.code);
+            return E_OUTOFMEMORY;
+        }
+    }
+
     if(named_item) {
         compiler.code->named_item = named_item;
         named_item->ref++;
     }
 
+    if(cacheable && !ctx->cc)
+        add_to_code_cache(ctx, compiler.code, hash, args, delimiter, from_eval, compiler.code_off);
+
     *ret = compiler.code;
     return S_OK;
 }
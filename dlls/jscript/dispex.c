@@ -60,6 +60,119 @@ struct _dispex_prop_t {
     int bucket_next;
 };
 
+struct _jsdisp_shape_t {
+    LONG64 id;
+    jsdisp_shape_t *parent;
+    jsdisp_shape_t *next;
+    unsigned hash;
+    WCHAR *name;
+};
+
+/* Limits the memory used by scripts that use objects as dictionaries. */
+#define MAX_SHAPE_CNT 0x10000
+
+/* Shape ids are unique in the process, because bytecode caches may outlive the script context. */
+static LONG64 last_shape_id;
+
+static jsdisp_shape_t *alloc_shape(script_ctx_t *ctx, jsdisp_shape_t *parent, const WCHAR *name, unsigned hash)
+{
+    size_t size = name ? (lstrlenW(name)+1)*sizeof(WCHAR) : 0;
+    jsdisp_shape_t *shape;
+    LONG64 id;
+
+    shape = heap_pool_alloc(&ctx->shape_heap, sizeof(*shape));
+    if(!shape)
+        return NULL;
+
+    if(name) {
+        shape->name = heap_pool_alloc(&ctx->shape_heap, size);
+        if(!shape->name)
+            return NULL;
+        memcpy(shape->name, name, size);
+    }else {
+        shape->name = NULL;
+    }
+
+    do {
+        id = last_shape_id;
+    }while(InterlockedCompareExchange64(&last_shape_id, id+1, id) != id);
+
+    shape->id = id+1;
+    shape->parent = parent;
+    shape->next = NULL;
+    shape->hash = hash;
+    return shape;
+}
+
+static inline unsigned get_shape_idx(script_ctx_t *ctx, jsdisp_shape_t *parent, unsigned hash)
+{
+    return ((hash ^ (unsigned)parent->id) * GOLDEN_RATIO) & (ctx->shape_table_size-1);
+}
+
+static jsdisp_shape_t *get_root_shape(script_ctx_t *ctx)
+{
+    if(!ctx->root_shape)
+        ctx->root_shape = alloc_shape(ctx, NULL, NULL, 0);
+    return ctx->root_shape;
+}
+
+/* Returns the shape of an object of the given shape after adding a property. */
+static jsdisp_shape_t *get_child_shape(script_ctx_t *ctx, jsdisp_shape_t *parent, const WCHAR *name, unsigned hash)
+{
+    jsdisp_shape_t *shape, **table;
+    unsigned i, idx;
+
+    if(ctx->shape_table_size) {
+        for(shape = ctx->shape_table[get_shape_idx(ctx, parent, hash)]; shape; shape = shape->next) {
+            if(shape->parent == parent && shape->hash == hash && !wcscmp(shape->name, name))
+                return shape;
+        }
+    }
+
+    if(ctx->shape_cnt >= MAX_SHAPE_CNT)
+        return NULL;
+
+    if(ctx->shape_cnt >= ctx->shape_table_size) {
+        unsigned new_size = ctx->shape_table_size ? ctx->shape_table_size*2 : 64;
+
+        table = heap_alloc_zero(new_size*sizeof(*table));
+        if(!table)
+            return NULL;
+
+        for(i = 0; i < ctx->shape_table_size; i++) {
+            while((shape = ctx->shape_table[i])) {
+                ctx->shape_table[i] = shape->next;
+                idx = ((shape->hash ^ (unsigned)shape->parent->id) * GOLDEN_RATIO) & (new_size-1);
+                shape->next = table[idx];
+                table[idx] = shape;
+            }
+        }
+
+        heap_free(ctx->shape_table);
+        ctx->shape_table = table;
+        ctx->shape_table_size = new_size;
+    }
+
+    shape = alloc_shape(ctx, parent, name, hash);
+    if(!shape)
+        return NULL;
+
+    idx = get_shape_idx(ctx, parent, hash);
+    shape->next = ctx->shape_table[idx];
+    ctx->shape_table[idx] = shape;
+    ctx->shape_cnt++;
+    return shape;
+}
+
+void release_shapes(script_ctx_t *ctx)
+{
+    heap_free(ctx->shape_table);
+    ctx->shape_table = NULL;
+    ctx->shape_table_size = ctx->shape_cnt = 0;
+    ctx->root_shape = NULL;
+    heap_pool_free(&ctx->shape_heap);
+}
+
 static inline DISPID prop_to_id(jsdisp_t *This, dispex_prop_t *prop)
 {
     return prop - This->props;
@@ -196,6 +309,9 @@ static inline dispex_prop_t* alloc_prop(jsdisp_t *This, const WCHAR *name, prop_
     bucket = get_props_idx(This, prop->hash);
     prop->bucket_next = This->props[bucket].bucket_head;
     This->props[bucket].bucket_head = This->prop_cnt++;
+
+    if(This->shape)
+        This->shape = get_child_shape(This->ctx, This->shape, prop->name, prop->hash);
     return prop;
 }
 
@@ -1752,6 +1868,7 @@ HRESULT init_dispex(jsdisp_t *dispex, script_ctx_t *ctx, const builtin_info_t *b
 
     script_addref(ctx);
     dispex->ctx = ctx;
+    dispex->shape = get_root_shape(ctx);
 
     return S_OK;
 }
@@ -1897,6 +2014,32 @@ HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *
     return DISP_E_UNKNOWNNAME;
 }
 
+/*
+ * Same as jsdisp_get_id(), but skips the lookup if the object has the shape
+ * that was seen the last time the cache was used. Properties are never moved
+ * to a different DISPID, so only deleted properties need the full lookup.
+ */
+HRESULT jsdisp_get_id_cached(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, prop_cache_t *cache, DISPID *id)
+{
+    HRESULT hres;
+
+    if(!cache)
+        return jsdisp_get_id(jsdisp, name, flags, id);
+
+    if(jsdisp->shape && jsdisp->shape->id == cache->shape_id
+       && jsdisp->props[cache->id].type != PROP_DELETED) {
+        *id = cache->id;
+        return S_OK;
+    }
+
+    hres = jsdisp_get_id(jsdisp, name, flags, id);
+    if(SUCCEEDED(hres) && jsdisp->shape) {
+        cache->shape_id = jsdisp->shape->id;
+        cache->id = *id;
+    }
+    return hres;
+}
+
 HRESULT jsdisp_call_value(jsdisp_t *jsfunc, IDispatch *jsthis, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
 {
     HRESULT hres;
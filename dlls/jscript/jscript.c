@@ -80,8 +80,10 @@ void script_release(script_ctx_t *ctx)
     if(ctx->cc)
         release_cc(ctx->cc);
     heap_pool_free(&ctx->tmp_heap);
+    release_shapes(ctx);
     if(ctx->last_match)
         jsstr_release(ctx->last_match);
+    release_regexp_cache(ctx);
     assert(!ctx->stack_top);
     heap_free(ctx->stack);
 
@@ -733,6 +735,7 @@ static HRESULT WINAPI JScript_SetScriptSite(IActiveScript *iface,
         ctx->acc = jsval_undefined();
         list_init(&ctx->named_items);
         heap_pool_init(&ctx->tmp_heap);
+        heap_pool_init(&ctx->shape_heap);
 
         hres = create_jscaller(ctx);
         if(FAILED(hres)) {
@@ -1104,6 +1107,7 @@ static HRESULT WINAPI JScriptParse_ParseScriptText(IActiveScriptParse *iface,
                 hres = jsval_to_variant(r, pvarResult);
             jsval_release(r);
         }
+        release_bytecode(code);
 
         return leave_script(This->ctx, hres);
     }
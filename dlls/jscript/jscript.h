@@ -238,6 +238,19 @@ typedef struct {
     HRESULT (*idx_put)(jsdisp_t*,unsigned,jsval_t);
 } builtin_info_t;
 
+/*
+ * Objects that had the same property names added in the same order share a
+ * shape, so a property found in one of them lives at the same DISPID in all
+ * of them. A NULL shape means that the object is not tracked.
+ */
+typedef struct _jsdisp_shape_t jsdisp_shape_t;
+
+/* Remembers the result of a property lookup for objects of a given shape. */
+typedef struct {
+    LONG64 shape_id;
+    DISPID id;
+} prop_cache_t;
+
 struct jsdisp_t {
     IDispatchEx IDispatchEx_iface;
 
@@ -246,6 +259,7 @@ struct jsdisp_t {
     DWORD buf_size;
     DWORD prop_cnt;
     dispex_prop_t *props;
+    jsdisp_shape_t *shape;
     script_ctx_t *ctx;
 
     jsdisp_t *prototype;
@@ -307,6 +321,7 @@ HRESULT jsdisp_propput_idx(jsdisp_t*,DWORD,jsval_t) DECLSPEC_HIDDEN;
 HRESULT jsdisp_propget_name(jsdisp_t*,LPCWSTR,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_idx(jsdisp_t*,DWORD,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_id(jsdisp_t*,const WCHAR*,DWORD,DISPID*) DECLSPEC_HIDDEN;
+HRESULT jsdisp_get_id_cached(jsdisp_t*,const WCHAR*,DWORD,prop_cache_t*,DISPID*) DECLSPEC_HIDDEN;
 HRESULT disp_delete(IDispatch*,DISPID,BOOL*) DECLSPEC_HIDDEN;
 HRESULT disp_delete_name(script_ctx_t*,IDispatch*,jsstr_t*,BOOL*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_delete_idx(jsdisp_t*,DWORD) DECLSPEC_HIDDEN;
@@ -405,6 +420,11 @@ typedef struct {
     unsigned length;
 } match_result_t;
 
+typedef struct {
+    jsstr_t *src;
+    struct regexp_t *regexp;
+} regexp_cache_entry_t;
+
 struct _script_ctx_t {
     LONG ref;
 
@@ -425,6 +445,12 @@ struct _script_ctx_t {
 
     heap_pool_t tmp_heap;
 
+    heap_pool_t shape_heap;
+    jsdisp_shape_t *root_shape;
+    jsdisp_shape_t **shape_table;
+    unsigned shape_table_size;
+    unsigned shape_cnt;
+
     jsval_t *stack;
     unsigned stack_top;
     jsval_t acc;
@@ -434,6 +460,8 @@ struct _script_ctx_t {
     DWORD last_match_index;
     DWORD last_match_length;
 
+    regexp_cache_entry_t regexp_cache[16];
+
     jsdisp_t *global;
     jsdisp_t *function_constr;
     jsdisp_t *array_constr;
@@ -456,6 +484,8 @@ struct _script_ctx_t {
 };
 
 void script_release(script_ctx_t*) DECLSPEC_HIDDEN;
+void release_shapes(script_ctx_t*) DECLSPEC_HIDDEN;
+void free_code_cache(void) DECLSPEC_HIDDEN;
 
 static inline void script_addref(script_ctx_t *ctx)
 {
@@ -490,6 +520,7 @@ struct match_state_t;
 HRESULT regexp_match_next(script_ctx_t*,jsdisp_t*,DWORD,jsstr_t*,struct match_state_t**) DECLSPEC_HIDDEN;
 HRESULT parse_regexp_flags(const WCHAR*,DWORD,DWORD*) DECLSPEC_HIDDEN;
 HRESULT regexp_string_match(script_ctx_t*,jsdisp_t*,jsstr_t*,jsval_t*) DECLSPEC_HIDDEN;
+void release_regexp_cache(script_ctx_t*) DECLSPEC_HIDDEN;
 
 BOOL bool_obj_value(jsdisp_t*) DECLSPEC_HIDDEN;
 unsigned array_get_length(jsdisp_t*) DECLSPEC_HIDDEN;
@@ -573,7 +573,7 @@ static void RegExp_destructor(jsdisp_t *dispex)
     RegExpInstance *This = regexp_from_jsdisp(dispex);
 
     if(This->jsregexp)
-        regexp_destroy(This->jsregexp);
+        regexp_release(This->jsregexp);
     jsval_release(This->last_index_val);
     jsstr_release(This->str);
     heap_free(This);
@@ -639,8 +639,18 @@ static HRESULT alloc_regexp(script_ctx_t *ctx, jsdisp_t *object_prototype, RegEx
     return S_OK;
 }
 
+static regexp_cache_entry_t *get_regexp_cache_entry(script_ctx_t *ctx, const WCHAR *str, DWORD len, DWORD flags)
+{
+    unsigned h = flags, i;
+
+    for(i = 0; i < len; i++)
+        h = h * 31 + str[i];
+    return ctx->regexp_cache + h % ARRAY_SIZE(ctx->regexp_cache);
+}
+
 HRESULT create_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags, jsdisp_t **ret)
 {
+    regexp_cache_entry_t *cache_entry;
     RegExpInstance *regexp;
     const WCHAR *str;
     HRESULT hres;
@@ -655,9 +665,20 @@ HRESULT create_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags, jsdisp_t **r
     if(FAILED(hres))
         return hres;
 
-    regexp->str = jsstr_addref(src);
     regexp->last_index_val = jsval_number(0);
 
+    /* Regexp literals in loops and functions are compiled on every evaluation, reuse them. */
+    cache_entry = get_regexp_cache_entry(ctx, str, jsstr_length(src), flags);
+    if(cache_entry->regexp && cache_entry->regexp->flags == flags && jsstr_eq(cache_entry->src, src)) {
+        /* The compiled regexp refers to the cached string. */
+        regexp->str = jsstr_addref(cache_entry->src);
+        regexp->jsregexp = regexp_addref(cache_entry->regexp);
+        *ret = &regexp->dispex;
+        return S_OK;
+    }
+
+    regexp->str = jsstr_addref(src);
+
     regexp->jsregexp = regexp_new(ctx, &ctx->tmp_heap, str, jsstr_length(regexp->str), flags, FALSE);
     if(!regexp->jsregexp) {
         WARN("regexp_new failed\n");
@@ -665,10 +686,30 @@ HRESULT create_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags, jsdisp_t **r
         return E_FAIL;
     }
 
+    if(cache_entry->regexp) {
+        regexp_release(cache_entry->regexp);
+        jsstr_release(cache_entry->src);
+    }
+    cache_entry->src = jsstr_addref(src);
+    cache_entry->regexp = regexp_addref(regexp->jsregexp);
+
     *ret = &regexp->dispex;
     return S_OK;
 }
 
+void release_regexp_cache(script_ctx_t *ctx)
+{
+    unsigned i;
+
+    for(i = 0; i < ARRAY_SIZE(ctx->regexp_cache); i++) {
+        if(!ctx->regexp_cache[i].regexp)
+            continue;
+        regexp_release(ctx->regexp_cache[i].regexp);
+        jsstr_release(ctx->regexp_cache[i].src);
+        ctx->regexp_cache[i].regexp = NULL;
+    }
+}
+
 HRESULT create_regexp_var(script_ctx_t *ctx, jsval_t src_arg, jsval_t *flags_arg, jsdisp_t **ret)
 {
     unsigned flags = 0;
@@ -3070,6 +3070,52 @@ good:
     return x;
 }
 
+static const WCHAR *find_literal(const regexp_t *re, const WCHAR *cp, const WCHAR *end)
+{
+    const WCHAR *lit = re->literal;
+    DWORD len = re->literal_len;
+    WCHAR last = lit[len - 1];
+
+    if (len == 1) {
+        for (; cp < end; cp++) {
+            if (*cp == last)
+                return cp;
+        }
+        return NULL;
+    }
+
+    /* Horspool search, with the shift table indexed by the low byte of chars. */
+    while (end - cp >= len) {
+        WCHAR c = cp[len - 1];
+        if (c == last && !memcmp(cp, lit, (len - 1) * sizeof(WCHAR)))
+            return cp;
+        cp += re->literal_shift[c & 0xff];
+    }
+    return NULL;
+}
+
+/* Skips positions at which the regexp can't match, returns NULL if there are none left. */
+static const WCHAR *next_match_start(REGlobalData *gData, const WCHAR *cp)
+{
+    regexp_t *re = gData->regexp;
+
+    if (re->bol_anchor && cp != gData->cpbegin && !(re->flags & REG_MULTILINE))
+        return NULL;
+
+    if (re->literal_prefix)
+        return find_literal(re, cp, gData->cpend);
+
+    if (re->has_first_chars) {
+        for (; cp < gData->cpend; cp++) {
+            if (*cp < 256 ? re->first_chars[*cp >> 3] & (1 << (*cp & 7)) : re->first_high)
+                return cp;
+        }
+        return NULL;
+    }
+
+    return cp;
+}
+
 static match_state_t *MatchRegExp(REGlobalData *gData, match_state_t *x)
 {
     match_state_t *result;
@@ -3082,6 +3128,8 @@ static match_state_t *MatchRegExp(REGlobalData *gData, match_state_t *x)
      * in order to detect end-of-input/line condition.
      */
     for (cp2 = cp; cp2 <= gData->cpend; cp2++) {
+        if (!(gData->regexp->flags & REG_STICKY) && !(cp2 = next_match_start(gData, cp2)))
+            break;
         gData->skipped = cp2 - cp;
         x->cp = cp2;
         for (j = 0; j < gData->regexp->parenCount; j++)
@@ -3154,6 +3202,14 @@ HRESULT regexp_execute(regexp_t *regexp, void *cx, heap_pool_t *pool,
     gData.skipped = 0;
     gData.pool = pool;
 
+    /* Every match contains the literal, don't bother matching if it's not there. */
+    if(regexp->literal && !regexp->literal_prefix && !(regexp->flags & REG_STICKY)
+       && !find_literal(regexp, result->cp, gData.cpend)) {
+        heap_pool_clear(mark);
+        result->match_len = 0;
+        return S_FALSE;
+    }
+
     hres = InitMatch(regexp, cx, pool, &gData);
     if(FAILED(hres)) {
         WARN("InitMatch failed\n");
@@ -3178,8 +3234,11 @@ HRESULT regexp_execute(regexp_t *regexp, void *cx, heap_pool_t *pool,
     return S_OK;
 }
 
-void regexp_destroy(regexp_t *re)
+void regexp_release(regexp_t *re)
 {
+    if (--re->ref)
+        return;
+
     if (re->classList) {
         UINT i;
         for (i = 0; i < re->classCount; i++) {
@@ -3189,9 +3248,162 @@ void regexp_destroy(regexp_t *re)
         }
         heap_free(re->classList);
     }
+    heap_free(re->literal);
     heap_free(re);
 }
 
+static void add_first_char(regexp_t *re, WCHAR c)
+{
+    re->first_chars[c >> 3] |= 1 << (c & 7);
+}
+
+/*
+ * Computes the set of chars that may start a match of the node list. Returns
+ * FALSE if it can't be determined or the list may match an empty string.
+ */
+static BOOL calc_first_chars(regexp_t *re, WORD flags, RENode *node)
+{
+    UINT i;
+
+    for (; node; node = node->next) {
+        switch (node->op) {
+        case REOP_EMPTY:
+        case REOP_BOL:
+        case REOP_EOL:
+        case REOP_WBDRY:
+        case REOP_WNONBDRY:
+        case REOP_ASSERT:
+        case REOP_ASSERT_NOT:
+            /* zero width, the next node consumes the first char */
+            continue;
+        case REOP_FLAT:
+            if (flags & REG_FOLD) {
+                /* Matched using towupper(), any char above 255 may map to a char of ours. */
+                WCHAR uch = towupper(node->u.flat.chr);
+                for (i = 0; i < 256; i++) {
+                    if (towupper(i) == uch)
+                        add_first_char(re, i);
+                }
+                re->first_high = TRUE;
+            } else if (node->u.flat.chr < 256) {
+                add_first_char(re, node->u.flat.chr);
+            } else {
+                re->first_high = TRUE;
+            }
+            return TRUE;
+        case REOP_DIGIT:
+            for (i = '0'; i <= '9'; i++)
+                add_first_char(re, i);
+            return TRUE;
+        case REOP_ALNUM:
+            for (i = 0; i < 128; i++) {
+                if (JS_ISWORD(i))
+                    add_first_char(re, i);
+            }
+            return TRUE;
+        case REOP_SPACE:
+            for (i = 0; i < 256; i++) {
+                if (iswspace(i))
+                    add_first_char(re, i);
+            }
+            re->first_high = TRUE;
+            return TRUE;
+        case REOP_ALT:
+        case REOP_ALTPREREQ:
+        case REOP_ALTPREREQ2:
+            return calc_first_chars(re, flags, node->kid)
+                && calc_first_chars(re, flags, node->u.kid2);
+        case REOP_LPAREN:
+            return calc_first_chars(re, flags, node->kid);
+        case REOP_QUANT:
+            return node->u.range.min && calc_first_chars(re, flags, node->kid);
+        default:
+            return FALSE;
+        }
+    }
+
+    return FALSE;
+}
+
+static DWORD get_flat_len(RENode *node)
+{
+    return node->kid ? node->u.flat.length : 1;
+}
+
+static BOOL set_literal(regexp_t *re, RENode *node, RENode *end, BOOL prefix)
+{
+    DWORD len = 0, i;
+    RENode *iter;
+
+    for (iter = node; iter != end; iter = iter->next)
+        len += get_flat_len(iter);
+    len = min(len, 255);
+
+    re->literal = heap_alloc(len * sizeof(WCHAR));
+    if (!re->literal)
+        return FALSE;
+
+    for (iter = node; iter != end && re->literal_len < len; iter = iter->next) {
+        if (iter->kid) {
+            DWORD n = min(get_flat_len(iter), len - re->literal_len);
+            memcpy(re->literal + re->literal_len, iter->kid, n * sizeof(WCHAR));
+            re->literal_len += n;
+        } else {
+            re->literal[re->literal_len++] = iter->u.flat.chr;
+        }
+    }
+
+    for (i = 0; i < 256; i++)
+        re->literal_shift[i] = len;
+    for (i = 0; i + 1 < len; i++)
+        re->literal_shift[re->literal[i] & 0xff] = len - 1 - i;
+
+    re->literal_prefix = prefix;
+    return TRUE;
+}
+
+/*
+ * Analyzes the top level of the parsed regexp to find out where matches may
+ * start, so that MatchRegExp does not need to run the bytecode at every
+ * position of the input.
+ */
+static BOOL init_prefilter(regexp_t *re, WORD flags, RENode *tree)
+{
+    RENode *node, *end, *best = NULL, *best_end = NULL;
+    DWORD len, best_len = 0;
+
+    if (tree && tree->op == REOP_BOL)
+        re->bol_anchor = TRUE;
+
+    re->has_first_chars = calc_first_chars(re, flags, tree);
+
+    /* Case insensitive literals would need folding in the search, skip them. */
+    if (flags & REG_FOLD)
+        return TRUE;
+
+    for (node = tree; node && (node->op == REOP_BOL || node->op == REOP_EMPTY); node = node->next);
+
+    for (end = node, len = 0; end && end->op == REOP_FLAT; end = end->next)
+        len += get_flat_len(end);
+    if (len)
+        return set_literal(re, node, end, TRUE);
+
+    /* Otherwise look for the longest literal that every match has to contain. */
+    for (; node; node = node->next) {
+        if (node->op != REOP_FLAT)
+            continue;
+        for (end = node, len = 0; end && end->op == REOP_FLAT; end = end->next)
+            len += get_flat_len(end);
+        if (len > best_len) {
+            best = node;
+            best_end = end;
+            best_len = len;
+        }
+    }
+
+    return !best || set_literal(re, best, best_end, FALSE);
+}
+
 regexp_t* regexp_new(void *cx, heap_pool_t *pool, const WCHAR *str,
         DWORD str_len, WORD flags, BOOL flat)
 {
@@ -3238,16 +3450,17 @@ regexp_t* regexp_new(void *cx, heap_pool_t *pool, const WCHAR *str,
             goto out;
     }
     resize = offsetof(regexp_t, program) + state.progLength + 1;
-    re = heap_alloc(resize);
+    re = heap_alloc_zero(resize);
     if (!re)
         goto out;
+    re->ref = 1;
 
     assert(state.classBitmapsMem <= CLASS_BITMAPS_MEM_LIMIT);
     re->classCount = state.classCount;
     if (re->classCount) {
         re->classList = heap_alloc(re->classCount * sizeof(RECharSet));
         if (!re->classList) {
-            regexp_destroy(re);
+            regexp_release(re);
             re = NULL;
             goto out;
         }
@@ -3257,8 +3470,8 @@ regexp_t* regexp_new(void *cx, heap_pool_t *pool, const WCHAR *str,
         re->classList = NULL;
     }
     endPC = EmitREBytecode(&state, re, state.treeDepth, re->program, state.result);
-    if (!endPC) {
-        regexp_destroy(re);
+    if (!endPC || !init_prefilter(re, flags, state.result)) {
+        regexp_release(re);
         re = NULL;
         goto out;
     }
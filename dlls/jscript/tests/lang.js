@@ -1898,6 +1898,65 @@ function returnTest() {
 
 ok(returnTest() === undefined, "returnTest = " + returnTest());
 
+/* Property lookups are cached per instruction, make sure the cache notices changes. */
+(function() {
+    function Point(x, y) { this.x = x; this.y = y; }
+    Point.prototype.z = 3;
+
+    function getX(o) { return o.x; }
+    function getZ(o) { return o.z; }
+    function setX(o, v) { o.x = v; }
+
+    var p1 = new Point(1, 2), p2 = new Point(4, 5), o = {y: 7, x: 8}, i, r;
+
+    for(i = 0; i < 3; i++) {
+        r = getX(p1);
+        ok(r === 1, "getX(p1) = " + r);
+        r = getX(p2);
+        ok(r === 4, "getX(p2) = " + r);
+        r = getX(o);
+        ok(r === 8, "getX(o) = " + r);
+    }
+
+    setX(p1, 10);
+    setX(o, 11);
+    ok(p1.x === 10, "p1.x = " + p1.x);
+    ok(o.x === 11, "o.x = " + o.x);
+    ok(getX(p2) === 4, "getX(p2) = " + getX(p2));
+
+    delete p1.x;
+    r = getX(p1);
+    ok(r === undefined, "getX(p1) after delete = " + r);
+    Point.prototype.x = 6;
+    r = getX(p1);
+    ok(r === 6, "getX(p1) from prototype = " + r);
+    setX(p1, 12);
+    r = getX(p1);
+    ok(r === 12, "getX(p1) after set = " + r);
+    ok(Point.prototype.x === 6, "Point.prototype.x = " + Point.prototype.x);
+
+    ok(getZ(p2) === 3, "getZ(p2) = " + getZ(p2));
+    Point.prototype.z = 13;
+    ok(getZ(p2) === 13, "getZ(p2) = " + getZ(p2));
+    p2.z = 14;
+    ok(getZ(p2) === 14, "getZ(p2) = " + getZ(p2));
+    delete p2.z;
+    ok(getZ(p2) === 13, "getZ(p2) = " + getZ(p2));
+    delete Point.prototype.z;
+    ok(getZ(p2) === undefined, "getZ(p2) = " + getZ(p2));
+})();
+
+cacheTestGlobal = 1;
+function getCacheTestGlobal() { return cacheTestGlobal; }
+ok(getCacheTestGlobal() === 1, "getCacheTestGlobal() = " + getCacheTestGlobal());
+cacheTestGlobal = 2;
+ok(getCacheTestGlobal() === 2, "getCacheTestGlobal() = " + getCacheTestGlobal());
+delete cacheTestGlobal;
+try {
+    getCacheTestGlobal();
+    ok(false, "expected exception");
+}catch(e) {}
+
 ActiveXObject = 1;
 ok(ActiveXObject === 1, "ActiveXObject = " + ActiveXObject);
 
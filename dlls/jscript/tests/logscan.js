@@ -0,0 +1,59 @@
+/*
+ * Copyright 2020 Wine Project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+
+/* Regular expression microbenchmark: scanning log lines for rare literals,
+ * anchored patterns and patterns starting with a character class. The
+ * patterns are rebuilt in the loop, like scripts calling new RegExp() or
+ * String.match() with a string argument do. */
+
+function make_log() {
+    var lines = [], levels = ["INFO", "DEBUG", "WARN", "INFO", "INFO"], i;
+
+    for(i = 0; i < 500; i++) {
+        lines.push("2020-09-" + (10 + i % 20) + " 12:" + (10 + i % 50) + ":00 " + levels[i % levels.length]
+                   + " worker" + (i % 8) + ": processed request " + i
+                   + (i % 97 ? "" : " ERROR timeout while reading socket"));
+    }
+
+    return lines;
+}
+
+function run() {
+    var lines = make_log(), errors = 0, warns = 0, workers = 0, digits = 0, i, j, m;
+
+    for(j = 0; j < 20; j++) {
+        for(i = 0; i < lines.length; i++) {
+            if(new RegExp("ERROR (\\w+)").test(lines[i]))
+                errors++;
+            if(/^\S+ \S+ WARN/.test(lines[i]))
+                warns++;
+            if((m = lines[i].match("worker([0-7]):")) && m[1] === "3")
+                workers++;
+            m = lines[i].match(/[0-9]+$/);
+            if(m)
+                digits += m[0].length;
+        }
+    }
+
+    return errors + "," + warns + "," + workers + "," + digits;
+}
+
+var result = run();
+if(result !== "120,2000,1260,27500")
+    throw new Error("unexpected result " + result);
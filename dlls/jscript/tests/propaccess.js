@@ -0,0 +1,53 @@
+/*
+ * Copyright 2020 Wine Project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/* Property access microbenchmark: member reads and writes on objects
+ * sharing a layout, prototype method calls and global lookups. */
+
+function Vector(x, y, z) {
+    this.x = x;
+    this.y = y;
+    this.z = z;
+}
+
+Vector.prototype.dot = function(v) {
+    return this.x * v.x + this.y * v.y + this.z * v.z;
+};
+
+var scale = 2;
+
+function run() {
+    var vectors = [], sum = 0, i, j, v;
+
+    for(i = 0; i < 100; i++)
+        vectors.push(new Vector(i, i + 1, i + 2));
+
+    for(j = 0; j < 200; j++) {
+        for(i = 0; i < vectors.length; i++) {
+            v = vectors[i];
+            v.x = v.x + scale;
+            sum += v.dot(vectors[0]) + v.y * scale - v.z;
+        }
+    }
+
+    return sum;
+}
+
+var result = run();
+if(result !== 1277730000)
+    throw new Error("unexpected result " + result);
@@ -713,4 +713,31 @@ ok(re.ignoreCase === false, "re.ignoreCase = " + re.ignoreCase);
 ok(re.multiline === true, "re.multiline = " + re.multiline);
 ok(re.global === true, "re.global = " + re.global);
 
+re = new RegExp("b+c");
+var re2 = new RegExp("b+c", "g");
+ok(re.global === false, "re.global = " + re.global);
+ok(re2.global === true, "re2.global = " + re2.global);
+ok(re2.test("abbc") === true, "re2.test(abbc) failed");
+ok(re2.lastIndex === 4, "re2.lastIndex = " + re2.lastIndex);
+ok(re.lastIndex === 0, "re.lastIndex = " + re.lastIndex);
+re2 = new RegExp("b+c");
+ok(re2 !== re, "re2 === re");
+re2.lastIndex = 3;
+ok(re.lastIndex === 0, "re.lastIndex = " + re.lastIndex);
+
+m = "xx\nabc abc".match(/^abc/m);
+ok(m.index === 3, "m.index = " + m.index);
+ok("xx\nabc".match(/^abc/) === null, "matched ^abc without multiline");
+m = "x ABc".match(/abc/i);
+ok(m.index === 2, "m.index = " + m.index);
+m = "a1b2 cd error here".match(/\w+ error/);
+ok(m[0] === "cd error", "m[0] = " + m[0]);
+ok(/\w+ error/.test("a1b2 cd eror here") === false, "matched missing literal");
+m = "...x9y".match(/[xy]\d/);
+ok(m.index === 3, "m.index = " + m.index);
+m = "aaa".match(/a*?$/);
+ok(m.index === 0 && m[0] === "aaa", "m = " + m);
+m = "xyz".match(/q*/);
+ok(m.index === 0 && m[0] === "", "m = " + m);
+
 reportSuccess();
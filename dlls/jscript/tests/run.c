@@ -2376,6 +2376,81 @@ static void test_error_reports(void)
     }
 }
 
+/* Compiled code may be reused by later engines, but per-parse state must not leak between them. */
+static void test_code_cache(void)
+{
+    IActiveScriptParse *parser;
+    IActiveScript *engine;
+    DWORD source_context;
+    ULONG line_number;
+    unsigned i;
+    HRESULT hres;
+    VARIANT v;
+
+    for(i = 0; i < 2; i++) {
+        engine = create_script();
+        if(!engine)
+            return;
+
+        hres = IActiveScript_QueryInterface(engine, &IID_IActiveScriptParse, (void**)&parser);
+        ok(hres == S_OK, "Could not get IActiveScriptParse: %08x\n", hres);
+
+        hres = IActiveScriptParse_InitNew(parser);
+        ok(hres == S_OK, "InitNew failed: %08x\n", hres);
+
+        hres = IActiveScript_SetScriptSite(engine, &ActiveScriptSite_CheckError);
+        ok(hres == S_OK, "SetScriptSite failed: %08x\n", hres);
+
+        /* persistent only in the second engine */
+        hres = IActiveScriptParse_ParseScriptText(parser, L"var cache_test = 1;\n", NULL, NULL, NULL, 0, 0,
+                i ? SCRIPTTEXT_ISPERSISTENT : 0, NULL, NULL);
+        ok(hres == S_OK, "[%u] ParseScriptText failed: %08x\n", i, hres);
+
+        hres = IActiveScript_SetScriptState(engine, SCRIPTSTATE_STARTED);
+        ok(hres == S_OK, "SetScriptState(SCRIPTSTATE_STARTED) failed: %08x\n", hres);
+
+        /* errors are reported with the source context and starting line of this parse */
+        script_error = NULL;
+        SET_EXPECT(ActiveScriptSite_OnScriptError);
+        hres = IActiveScriptParse_ParseScriptText(parser, L"var x = 1;\nundefinedFunction();\n", NULL, NULL, NULL,
+                10 + i, 3 * i, 0, NULL, NULL);
+        ok(hres == SCRIPT_E_REPORTED, "[%u] ParseScriptText returned: %08x\n", i, hres);
+        CHECK_CALLED(ActiveScriptSite_OnScriptError);
+
+        if(script_error) {
+            source_context = 0xdeadbeef;
+            line_number = 0xdeadbeef;
+            hres = IActiveScriptError_GetSourcePosition(script_error, &source_context, &line_number, NULL);
+            ok(hres == S_OK, "GetSourcePosition failed: %08x\n", hres);
+            ok(source_context == 10 + i, "[%u] source_context = %x\n", i, source_context);
+            ok(line_number == 3 * i + 1, "[%u] line = %u\n", i, line_number);
+            IActiveScriptError_Release(script_error);
+        }
+
+        hres = IActiveScript_SetScriptState(engine, SCRIPTSTATE_UNINITIALIZED);
+        ok(hres == S_OK, "SetScriptState(SCRIPTSTATE_UNINITIALIZED) failed: %08x\n", hres);
+
+        hres = IActiveScript_SetScriptSite(engine, &ActiveScriptSite_CheckError);
+        ok(hres == S_OK, "SetScriptSite failed: %08x\n", hres);
+
+        hres = IActiveScript_SetScriptState(engine, SCRIPTSTATE_STARTED);
+        ok(hres == S_OK, "SetScriptState(SCRIPTSTATE_STARTED) failed: %08x\n", hres);
+
+        V_VT(&v) = VT_EMPTY;
+        hres = IActiveScriptParse_ParseScriptText(parser, L"typeof(cache_test)", NULL, NULL, NULL, 0, 0,
+                SCRIPTTEXT_ISEXPRESSION, &v, NULL);
+        ok(hres == S_OK, "[%u] ParseScriptText failed: %08x\n", i, hres);
+        ok(V_VT(&v) == VT_BSTR, "[%u] V_VT(v) = %d\n", i, V_VT(&v));
+        if(V_VT(&v) == VT_BSTR)
+            ok(!lstrcmpW(V_BSTR(&v), i ? L"number" : L"undefined"), "[%u] typeof(cache_test) = %s\n",
+               i, wine_dbgstr_w(V_BSTR(&v)));
+        VariantClear(&v);
+
+        IActiveScriptParse_Release(parser);
+        close_script(engine);
+    }
+}
+
 #define run_script(a) _run_script(__LINE__,a)
 static void _run_script(unsigned line, const WCHAR *src)
 {
@@ -3433,6 +3508,7 @@ static BOOL run_tests(void)
     test_invokeex();
     test_eval();
     test_error_reports();
+    test_code_cache();
 
     run_bom_tests();
 
@@ -3581,6 +3657,8 @@ static void run_benchmarks(void)
     run_benchmark("dna.js");
     run_benchmark("base64.js");
     run_benchmark("validateinput.js");
+    run_benchmark("propaccess.js");
+    run_benchmark("logscan.js");
 }
 
 static BOOL check_jscript(void)
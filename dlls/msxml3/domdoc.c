@@ -209,6 +209,7 @@ typedef struct _xmldoc_priv {
     LONG refs;
     struct list orphans;
     domdoc_properties* properties;
+    struct selection_cache *selection_cache;
 } xmldoc_priv;
 
 typedef struct _orphan_entry {
@@ -281,6 +282,7 @@ static xmldoc_priv * create_priv(void)
         priv->refs = 0;
         list_init( &priv->orphans );
         priv->properties = NULL;
+        priv->selection_cache = NULL;
     }
 
     return priv;
@@ -623,6 +625,7 @@ LONG xmldoc_release_refs(xmlDocPtr doc, LONG refs)
             heap_free( orphan );
         }
         free_properties(priv->properties);
+        free_selection_cache(priv->selection_cache);
         heap_free(doc->_private);
 
         xmlFreeDoc(doc);
@@ -668,6 +671,30 @@ HRESULT xmldoc_remove_orphan(xmlDocPtr doc, xmlNodePtr node)
     return S_FALSE;
 }
 
+struct selection_cache *xmldoc_get_selection_cache(xmlDocPtr doc)
+{
+    xmldoc_priv *priv = priv_from_xmlDocPtr(doc);
+    struct selection_cache *cache;
+
+    if (!priv)
+        return NULL;
+    if (!priv->selection_cache && (cache = create_selection_cache()))
+    {
+        if (InterlockedCompareExchangePointer((void **)&priv->selection_cache, cache, NULL))
+            free_selection_cache(cache);
+    }
+    return priv->selection_cache;
+}
+
+/* Called whenever nodes are added, removed or changed in the document tree. */
+void xmldoc_modified(xmlDocPtr doc)
+{
+    xmldoc_priv *priv = doc ? priv_from_xmlDocPtr(doc) : NULL;
+
+    if (priv)
+        selection_cache_reset_index(priv->selection_cache);
+}
+
 static inline xmlDocPtr get_doc( domdoc *This )
 {
     return This->node.node->doc;
@@ -1666,6 +1693,8 @@ static HRESULT WINAPI domdoc_put_documentElement(
     if (refcount) xmldoc_add_refs(get_doc(This), refcount);
     oldRoot = xmlDocSetRootElement( get_doc(This), xmlNode->node);
     if (refcount) xmldoc_release_refs(old_doc, refcount);
+    xmldoc_modified(get_doc(This));
+    xmldoc_modified(old_doc);
     IXMLDOMNode_Release( elementNode );
 
     if(oldRoot)
@@ -2993,6 +3022,7 @@ static HRESULT WINAPI domdoc_setProperty(
     {
         xmlChar *nsStr = (xmlChar*)This->properties->selectNsStr;
         struct list *pNsList;
+        xmldoc_priv *priv;
         VARIANT varStr;
         HRESULT hr;
         BSTR bstr;
@@ -3011,6 +3041,10 @@ static HRESULT WINAPI domdoc_setProperty(
 
         pNsList = &(This->properties->selectNsList);
         clear_selectNsList(pNsList);
+
+        /* XSLPattern queries are translated using the selection namespaces */
+        priv = priv_from_xmlDocPtr(get_doc(This));
+        selection_cache_reset_queries(priv->selection_cache);
         heap_free(nsStr);
         nsStr = xmlchar_from_wchar(bstr);
 
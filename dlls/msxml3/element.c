@@ -1318,6 +1318,7 @@ static HRESULT WINAPI domelem_setAttribute(
 
     if (!xmlSetNsProp(element, NULL, xml_name, xml_value))
         hr = E_FAIL;
+    xmldoc_modified(element->doc);
 
     heap_free(xml_value);
     heap_free(xml_name);
@@ -1477,6 +1478,7 @@ static HRESULT WINAPI domelem_setAttributeNode(
     attr = xmlSetNsProp(get_element(This), NULL, name, value);
     if (attr)
         attr_node->parent = (IXMLDOMNode*)iface;
+    xmldoc_modified(get_element(This)->doc);
 
     SysFreeString(nameW);
     VariantClear(&valueW);
@@ -1691,6 +1693,7 @@ static HRESULT domelem_set_named_item(xmlNodePtr node, IXMLDOMNode *newItem, IXM
             WARN("%p is not an orphan of %p\n", ThisNew->node, ThisNew->node->doc);
 
     nodeNew = xmlAddChild(node, ThisNew->node);
+    xmldoc_modified(node->doc);
 
     if(namedItem)
         *namedItem = create_node( nodeNew );
@@ -1743,6 +1746,7 @@ static HRESULT domelem_remove_qualified_item(xmlNodePtr node, BSTR name, BSTR ur
         if (xmlRemoveProp(attr) == -1)
             ERR("xmlRemoveProp failed\n");
     }
+    xmldoc_modified(node->doc);
 
     return S_OK;
 }
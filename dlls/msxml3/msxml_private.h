@@ -288,6 +288,14 @@ extern HRESULT xmldoc_remove_orphan( xmlDocPtr doc, xmlNodePtr node ) DECLSPEC_H
 extern void xmldoc_link_xmldecl(xmlDocPtr doc, xmlNodePtr node) DECLSPEC_HIDDEN;
 extern xmlNodePtr xmldoc_unlink_xmldecl(xmlDocPtr doc) DECLSPEC_HIDDEN;
 extern MSXML_VERSION xmldoc_version( xmlDocPtr doc ) DECLSPEC_HIDDEN;
+extern void xmldoc_modified( xmlDocPtr doc ) DECLSPEC_HIDDEN;
+
+struct selection_cache;
+extern struct selection_cache *xmldoc_get_selection_cache( xmlDocPtr doc ) DECLSPEC_HIDDEN;
+extern struct selection_cache *create_selection_cache( void ) DECLSPEC_HIDDEN;
+extern void free_selection_cache( struct selection_cache *cache ) DECLSPEC_HIDDEN;
+extern void selection_cache_reset_index( struct selection_cache *cache ) DECLSPEC_HIDDEN;
+extern void selection_cache_reset_queries( struct selection_cache *cache ) DECLSPEC_HIDDEN;
 
 extern HRESULT XMLElement_create( xmlNodePtr node, LPVOID *ppObj, BOOL own ) DECLSPEC_HIDDEN;
 
@@ -264,6 +264,7 @@ HRESULT node_set_content(xmlnode *This, LPCWSTR value)
         return E_OUTOFMEMORY;
 
     xmlNodeSetContent(This->node, str);
+    xmldoc_modified(This->node->doc);
     heap_free(str);
     return S_OK;
 }
@@ -285,6 +286,7 @@ static HRESULT node_set_content_escaped(xmlnode *This, LPCWSTR value)
     }
 
     xmlNodeSetContent(This->node, escaped);
+    xmldoc_modified(This->node->doc);
 
     heap_free(str);
     xmlFree(escaped);
@@ -546,6 +548,9 @@ HRESULT node_insert_before(xmlnode *This, IXMLDOMNode *new_child, const VARIANT
         node_obj->parent = This->iface;
     }
 
+    xmldoc_modified(This->node->doc);
+    xmldoc_modified(doc);
+
     if(ret)
     {
         IXMLDOMNode_AddRef(new_child);
@@ -607,6 +612,8 @@ HRESULT node_replace_child(xmlnode *This, IXMLDOMNode *newChild, IXMLDOMNode *ol
     if (refcount) xmldoc_add_refs(old_child->node->doc, refcount);
     xmlReplaceNode(old_child->node, new_child->node);
     if (refcount) xmldoc_release_refs(leaving_doc, refcount);
+    xmldoc_modified(old_child->node->doc);
+    xmldoc_modified(leaving_doc);
     new_child->parent = old_child->parent;
     old_child->parent = NULL;
 
@@ -642,6 +649,7 @@ HRESULT node_remove_child(xmlnode *This, IXMLDOMNode* child, IXMLDOMNode** oldCh
     xmlUnlinkNode(child_node->node);
     child_node->parent = NULL;
     xmldoc_add_orphan(child_node->node->doc, child_node->node);
+    xmldoc_modified(child_node->node->doc);
 
     if(oldChild)
     {
@@ -893,6 +901,7 @@ HRESULT node_put_text(xmlnode *This, BSTR text)
     heap_free(str);
 
     xmlNodeSetContent(This->node, str2);
+    xmldoc_modified(This->node->doc);
     xmlFree(str2);
 
     return S_OK;
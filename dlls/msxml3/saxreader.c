@@ -158,6 +158,15 @@ struct bstrpool
     unsigned int len;
 };
 
+/* Growable string buffer, reused for strings that are only borrowed by
+   the handler for the duration of a callback. */
+struct saxbuffer
+{
+    WCHAR *data;
+    int len;
+    int size;
+};
+
 typedef struct
 {
     BSTR prefix;
@@ -237,6 +246,7 @@ typedef struct
     xmlSAXHandler sax;
     BOOL isParsing;
     struct bstrpool pool;
+    char *input_buffer;
     saxreader_feature features;
     BSTR xmldecl_version;
     MSXML_VERSION version;
@@ -313,14 +323,15 @@ typedef struct
     struct list elements;
 
     BSTR namespaceUri;
+    struct saxbuffer scratch;
     int attr_alloc_count;
     int attr_count;
     struct _attributes
     {
-        BSTR szLocalname;
+        struct saxbuffer localname;
         BSTR szURI;
-        BSTR szValue;
-        BSTR szQName;
+        struct saxbuffer value;
+        struct saxbuffer qname;
     } *attributes;
 } saxlocator;
 
@@ -523,27 +534,91 @@ static element_entry * pop_element_ns(saxlocator *locator)
     return element;
 }
 
+static BOOL saxbuffer_reserve(struct saxbuffer *buffer, int size)
+{
+    WCHAR *data;
+
+    if (size <= buffer->size)
+        return TRUE;
+
+    size = max(size, max(buffer->size * 2, 64));
+    if (!(data = heap_realloc(buffer->data, size * sizeof(WCHAR))))
+        return FALSE;
+
+    buffer->data = data;
+    buffer->size = size;
+    return TRUE;
+}
+
+/* UTF-8 input never takes more UTF-16 code units than bytes, so the
+   buffer is sized from the input length without a separate counting pass. */
+static int saxbuffer_append_xmlCharN(struct saxbuffer *buffer, const xmlChar *str, int len)
+{
+    if (len)
+        len = MultiByteToWideChar(CP_UTF8, 0, (LPCSTR)str, len, buffer->data + buffer->len,
+                buffer->size - buffer->len);
+    buffer->len += len;
+    buffer->data[buffer->len] = 0;
+    return len;
+}
+
+static WCHAR *saxbuffer_from_xmlCharN(struct saxbuffer *buffer, const xmlChar *str, int len)
+{
+    if (len == -1)
+        len = xmlStrlen(str);
+
+    if (!saxbuffer_reserve(buffer, len + 1))
+        return NULL;
+
+    buffer->len = 0;
+    saxbuffer_append_xmlCharN(buffer, str, len);
+    return buffer->data;
+}
+
+static WCHAR *saxbuffer_from_qname(struct saxbuffer *buffer, const xmlChar *prefix, const xmlChar *name)
+{
+    int prefix_len, name_len;
+
+    if (!prefix || !*prefix)
+        return saxbuffer_from_xmlCharN(buffer, name, -1);
+
+    prefix_len = xmlStrlen(prefix);
+    name_len = xmlStrlen(name);
+    if (!saxbuffer_reserve(buffer, prefix_len + name_len + 2))
+        return NULL;
+
+    buffer->len = 0;
+    saxbuffer_append_xmlCharN(buffer, prefix, prefix_len);
+    buffer->data[buffer->len++] = ':';
+    saxbuffer_append_xmlCharN(buffer, name, name_len);
+    return buffer->data;
+}
+
+static void saxbuffer_free(struct saxbuffer *buffer)
+{
+    heap_free(buffer->data);
+    buffer->data = NULL;
+    buffer->len = buffer->size = 0;
+}
+
 static BSTR find_element_uri(saxlocator *locator, const xmlChar *uri)
 {
     element_entry *element;
-    BSTR uriW;
+    WCHAR *uriW;
     int i;
 
     if (!uri) return NULL;
 
-    uriW = bstr_from_xmlChar(uri);
+    if (!(uriW = saxbuffer_from_xmlCharN(&locator->scratch, uri, -1)))
+        return NULL;
 
     LIST_FOR_EACH_ENTRY(element, &locator->elements, element_entry, entry)
     {
         for (i=0; i < element->ns_count; i++)
             if (!strcmpW(uriW, element->ns[i].uri))
-            {
-                SysFreeString(uriW);
                 return element->ns[i].uri;
-            }
     }
 
-    SysFreeString(uriW);
     ERR("namespace uri not found, %s\n", debugstr_a((char*)uri));
     return NULL;
 }
@@ -670,6 +745,26 @@ static BSTR pooled_bstr_from_xmlCharN(struct bstrpool *pool, const xmlChar *buf,
     return pool_entry;
 }
 
+static HRESULT saxreader_saxcharactersN(saxlocator *locator, const xmlChar *str, int len)
+{
+    struct saxcontenthandler_iface *content = saxreader_get_contenthandler(locator->saxreader);
+    const WCHAR *chars;
+
+    if (!saxreader_has_handler(locator, SAXContentHandler)) return S_OK;
+
+    /* BSTRs passed to VB handlers are kept alive until the next parse, other
+       handlers only get to look at the string for the duration of the call. */
+    if (locator->vbInterface)
+    {
+        BSTR bstr = pooled_bstr_from_xmlCharN(&locator->saxreader->pool, str, len);
+        return IVBSAXContentHandler_characters(content->vbhandler, &bstr);
+    }
+
+    if (!(chars = saxbuffer_from_xmlCharN(&locator->scratch, str, len)))
+        return E_OUTOFMEMORY;
+    return ISAXContentHandler_characters(content->handler, chars, locator->scratch.len);
+}
+
 static void format_error_message_from_id(saxlocator *This, HRESULT hr)
 {
     struct saxerrorhandler_iface *handler = saxreader_get_errorhandler(This->saxreader);
@@ -1161,8 +1256,8 @@ static HRESULT WINAPI isaxattributes_getLocalName(
     if(!is_valid_attr_index(This, index)) return E_INVALIDARG;
     if(!pLocalName || !pLocalNameLength) return E_POINTER;
 
-    *pLocalNameLength = SysStringLen(This->attributes[index].szLocalname);
-    *pLocalName = This->attributes[index].szLocalname;
+    *pLocalNameLength = This->attributes[index].localname.len;
+    *pLocalName = This->attributes[index].localname.data;
 
     return S_OK;
 }
@@ -1179,8 +1274,8 @@ static HRESULT WINAPI isaxattributes_getQName(
     if(!is_valid_attr_index(This, index)) return E_INVALIDARG;
     if(!pQName || !pQNameLength) return E_POINTER;
 
-    *pQNameLength = SysStringLen(This->attributes[index].szQName);
-    *pQName = This->attributes[index].szQName;
+    *pQNameLength = This->attributes[index].qname.len;
+    *pQName = This->attributes[index].qname.data;
 
     return S_OK;
 }
@@ -1204,10 +1299,10 @@ static HRESULT WINAPI isaxattributes_getName(
 
     *pUriLength = SysStringLen(This->attributes[index].szURI);
     *uri = This->attributes[index].szURI;
-    *pLocalNameSize = SysStringLen(This->attributes[index].szLocalname);
-    *localName = This->attributes[index].szLocalname;
-    *pQNameLength = SysStringLen(This->attributes[index].szQName);
-    *QName = This->attributes[index].szQName;
+    *pLocalNameSize = This->attributes[index].localname.len;
+    *localName = This->attributes[index].localname.data;
+    *pQNameLength = This->attributes[index].qname.len;
+    *QName = This->attributes[index].qname.data;
 
     TRACE("(%s, %s, %s)\n", debugstr_w(*uri), debugstr_w(*localName), debugstr_w(*QName));
 
@@ -1232,12 +1327,12 @@ static HRESULT WINAPI isaxattributes_getIndexFromName(
     for(i=0; i<This->attr_count; i++)
     {
         if(cUriLength!=SysStringLen(This->attributes[i].szURI)
-                || cocalNameLength!=SysStringLen(This->attributes[i].szLocalname))
+                || cocalNameLength!=This->attributes[i].localname.len)
             continue;
         if(cUriLength && memcmp(pUri, This->attributes[i].szURI,
                     sizeof(WCHAR)*cUriLength))
             continue;
-        if(cocalNameLength && memcmp(pLocalName, This->attributes[i].szLocalname,
+        if(cocalNameLength && memcmp(pLocalName, This->attributes[i].localname.data,
                     sizeof(WCHAR)*cocalNameLength))
             continue;
 
@@ -1263,8 +1358,8 @@ static HRESULT WINAPI isaxattributes_getIndexFromQName(
 
     for(i=0; i<This->attr_count; i++)
     {
-        if(nQNameLength!=SysStringLen(This->attributes[i].szQName)) continue;
-        if(memcmp(pQName, This->attributes[i].szQName, sizeof(WCHAR)*nQNameLength)) continue;
+        if(nQNameLength!=This->attributes[i].qname.len) continue;
+        if(memcmp(pQName, This->attributes[i].qname.data, sizeof(WCHAR)*nQNameLength)) continue;
 
         *index = i;
         return S_OK;
@@ -1326,8 +1421,8 @@ static HRESULT WINAPI isaxattributes_getValue(
     if(!is_valid_attr_index(This, index)) return E_INVALIDARG;
     if(!value || !nValue) return E_POINTER;
 
-    *nValue = SysStringLen(This->attributes[index].szValue);
-    *value = This->attributes[index].szValue;
+    *nValue = This->attributes[index].value.len;
+    *value = This->attributes[index].value.data;
 
     TRACE("(%s:%d)\n", debugstr_w(*value), *nValue);
 
@@ -1397,26 +1492,15 @@ static const struct ISAXAttributesVtbl isaxattributes_vtbl =
 /* Libxml2 escapes '&' back to char reference '&#38;' in attribute value,
    so when document has escaped value with '&amp;' it's parsed to '&' and then
    escaped to '&#38;'. This function takes care of ampersands only. */
-static BSTR saxreader_get_unescaped_value(const xmlChar *buf, int len)
+static WCHAR *saxreader_get_unescaped_value(struct saxbuffer *buffer, const xmlChar *buf, int len)
 {
     static const WCHAR ampescW[] = {'&','#','3','8',';',0};
-    WCHAR *dest, *ptrW, *str;
-    DWORD str_len;
-    BSTR bstr;
+    WCHAR *dest, *ptrW;
 
-    if (!buf)
+    if (!saxbuffer_from_xmlCharN(buffer, buf, len))
         return NULL;
 
-    str_len = MultiByteToWideChar(CP_UTF8, 0, (LPCSTR)buf, len, NULL, 0);
-    if (len != -1) str_len++;
-
-    str = heap_alloc(str_len*sizeof(WCHAR));
-    if (!str) return NULL;
-
-    MultiByteToWideChar(CP_UTF8, 0, (LPCSTR)buf, len, str, str_len);
-    if (len != -1) str[str_len-1] = 0;
-
-    ptrW = str;
+    ptrW = buffer->data;
     while ((dest = strstrW(ptrW, ampescW)))
     {
         WCHAR *src;
@@ -1426,40 +1510,21 @@ static BSTR saxreader_get_unescaped_value(const xmlChar *buf, int len)
         dest++;
 
         /* move together with null terminator */
-        memmove(dest, src, (strlenW(src) + 1)*sizeof(WCHAR));
+        memmove(dest, src, (buffer->len - (src - buffer->data) + 1)*sizeof(WCHAR));
+        buffer->len -= src - dest;
 
-        ptrW++;
+        ptrW = dest;
     }
 
-    bstr = SysAllocString(str);
-    heap_free(str);
-
-    return bstr;
+    return buffer->data;
 }
 
-static void free_attribute_values(saxlocator *locator)
-{
-    int i;
-
-    for (i = 0; i < locator->attr_count; i++)
-    {
-        SysFreeString(locator->attributes[i].szLocalname);
-        locator->attributes[i].szLocalname = NULL;
-
-        SysFreeString(locator->attributes[i].szValue);
-        locator->attributes[i].szValue = NULL;
-
-        SysFreeString(locator->attributes[i].szQName);
-        locator->attributes[i].szQName = NULL;
-    }
-}
 
 static HRESULT SAXAttributes_populate(saxlocator *locator,
         int nb_namespaces, const xmlChar **xmlNamespaces,
         int nb_attributes, const xmlChar **xmlAttributes)
 {
     static const xmlChar xmlns[] = "xmlns";
-    static const WCHAR xmlnsW[] = { 'x','m','l','n','s',0 };
 
     struct _attributes *attrs;
     int i;
@@ -1475,7 +1540,6 @@ static HRESULT SAXAttributes_populate(saxlocator *locator,
         attrs = heap_realloc_zero(locator->attributes, new_size * sizeof(struct _attributes));
         if(!attrs)
         {
-            free_attribute_values(locator);
             locator->attr_count = 0;
             return E_OUTOFMEMORY;
         }
@@ -1487,21 +1551,18 @@ static HRESULT SAXAttributes_populate(saxlocator *locator,
         attrs = locator->attributes;
     }
 
+    /* attribute strings are rewritten in place for every element */
     for (i = 0; i < nb_namespaces; i++)
     {
-        SysFreeString(attrs[nb_attributes+i].szLocalname);
-        attrs[nb_attributes+i].szLocalname = SysAllocStringLen(NULL, 0);
-
-        attrs[nb_attributes+i].szURI = locator->namespaceUri;
+        struct _attributes *attr = &attrs[nb_attributes+i];
 
-        SysFreeString(attrs[nb_attributes+i].szValue);
-        attrs[nb_attributes+i].szValue = bstr_from_xmlChar(xmlNamespaces[2*i+1]);
+        attr->szURI = locator->namespaceUri;
 
-        SysFreeString(attrs[nb_attributes+i].szQName);
-        if(!xmlNamespaces[2*i])
-            attrs[nb_attributes+i].szQName = SysAllocString(xmlnsW);
-        else
-            attrs[nb_attributes+i].szQName = QName_from_xmlChar(xmlns, xmlNamespaces[2*i]);
+        if (!saxbuffer_from_xmlCharN(&attr->localname, NULL, 0) ||
+            !saxbuffer_from_xmlCharN(&attr->value, xmlNamespaces[2*i+1], -1) ||
+            !saxbuffer_from_qname(&attr->qname, xmlNamespaces[2*i] ? xmlns : NULL,
+                    xmlNamespaces[2*i] ? xmlNamespaces[2*i] : xmlns))
+            goto oom;
     }
 
     for (i = 0; i < nb_attributes; i++)
@@ -1514,17 +1575,18 @@ static HRESULT SAXAttributes_populate(saxlocator *locator,
             /* that's an important feature to keep same uri pointer for every reported attribute */
             attrs[i].szURI = find_element_uri(locator, xmlAttributes[i*5+2]);
 
-        SysFreeString(attrs[i].szLocalname);
-        attrs[i].szLocalname = bstr_from_xmlChar(xmlAttributes[i*5]);
-
-        SysFreeString(attrs[i].szValue);
-        attrs[i].szValue = saxreader_get_unescaped_value(xmlAttributes[i*5+3], xmlAttributes[i*5+4]-xmlAttributes[i*5+3]);
-
-        SysFreeString(attrs[i].szQName);
-        attrs[i].szQName = QName_from_xmlChar(xmlAttributes[i*5+1], xmlAttributes[i*5]);
+        if (!saxbuffer_from_xmlCharN(&attrs[i].localname, xmlAttributes[i*5], -1) ||
+            !saxreader_get_unescaped_value(&attrs[i].value, xmlAttributes[i*5+3],
+                    xmlAttributes[i*5+4]-xmlAttributes[i*5+3]) ||
+            !saxbuffer_from_qname(&attrs[i].qname, xmlAttributes[i*5+1], xmlAttributes[i*5]))
+            goto oom;
     }
 
     return S_OK;
+
+oom:
+    locator->attr_count = 0;
+    return E_OUTOFMEMORY;
 }
 
 /*** LibXML callbacks ***/
@@ -1723,7 +1785,6 @@ static void libxmlEndElementNS(
 
     if (!saxreader_has_handler(This, SAXContentHandler))
     {
-        free_attribute_values(This);
         This->attr_count = 0;
         free_element_entry(element);
         return;
@@ -1745,7 +1806,6 @@ static void libxmlEndElementNS(
                 local ? local : &empty_str, SysStringLen(local),
                 element->qname, SysStringLen(element->qname));
 
-    free_attribute_values(This);
     This->attr_count = 0;
 
     if (sax_callback_failed(This, hr))
@@ -1783,7 +1843,6 @@ static void libxmlCharacters(
         int len)
 {
     saxlocator *This = ctx;
-    BSTR Chars;
     HRESULT hr;
     xmlChar *cur, *end;
     BOOL lastEvent = FALSE;
@@ -1840,8 +1899,7 @@ static void libxmlCharacters(
                 This->column = 0;
         }
 
-        Chars = pooled_bstr_from_xmlCharN(&This->saxreader->pool, cur, end-cur);
-        hr = saxreader_saxcharacters(This, Chars);
+        hr = saxreader_saxcharactersN(This, cur, end-cur);
 
         if (sax_callback_failed(This, hr))
         {
@@ -1911,12 +1969,15 @@ static void libxmlComment(void *ctx, const xmlChar *value)
 
     if (!saxreader_has_handler(This, SAXLexicalHandler)) return;
 
-    bValue = pooled_bstr_from_xmlChar(&This->saxreader->pool, value);
-
     if (This->vbInterface)
+    {
+        bValue = pooled_bstr_from_xmlChar(&This->saxreader->pool, value);
         hr = IVBSAXLexicalHandler_comment(handler->vbhandler, &bValue);
+    }
+    else if (saxbuffer_from_xmlCharN(&This->scratch, value, -1))
+        hr = ISAXLexicalHandler_comment(handler->handler, This->scratch.data, This->scratch.len);
     else
-        hr = ISAXLexicalHandler_comment(handler->handler, bValue, SysStringLen(bValue));
+        hr = E_OUTOFMEMORY;
 
     if(FAILED(hr))
         format_error_message_from_id(This, hr);
@@ -2347,11 +2408,12 @@ static ULONG WINAPI isaxlocator_Release(
 
         for(index = 0; index < This->attr_alloc_count; index++)
         {
-            SysFreeString(This->attributes[index].szLocalname);
-            SysFreeString(This->attributes[index].szValue);
-            SysFreeString(This->attributes[index].szQName);
+            saxbuffer_free(&This->attributes[index].localname);
+            saxbuffer_free(&This->attributes[index].value);
+            saxbuffer_free(&This->attributes[index].qname);
         }
         heap_free(This->attributes);
+        saxbuffer_free(&This->scratch);
 
         /* element stack */
         LIST_FOR_EACH_ENTRY_SAFE(element, element2, &This->elements, element_entry, entry)
@@ -2585,16 +2647,23 @@ static HRESULT internal_parseBuffer(saxreader *This, const char *buffer, int siz
     return hr;
 }
 
+/* Streams are read with a large buffer, parsing cost is dominated by libxml2
+   per chunk overhead otherwise. Each read is parsed as soon as it returns, and
+   the buffer is kept for subsequent parses. */
+#define SAX_INPUT_BUFFER_SIZE 0x10000
+
 static HRESULT internal_parseStream(saxreader *This, ISequentialStream *stream, BOOL vbInterface)
 {
     saxlocator *locator;
     HRESULT hr;
     ULONG dataRead;
-    char data[2048];
     int ret;
 
+    if (!This->input_buffer && !(This->input_buffer = heap_alloc(SAX_INPUT_BUFFER_SIZE)))
+        return E_OUTOFMEMORY;
+
     dataRead = 0;
-    hr = ISequentialStream_Read(stream, data, sizeof(data), &dataRead);
+    hr = ISequentialStream_Read(stream, This->input_buffer, SAX_INPUT_BUFFER_SIZE, &dataRead);
     if(FAILED(hr)) return hr;
 
     hr = SAXLocator_create(This, &locator, vbInterface);
@@ -2602,7 +2671,7 @@ static HRESULT internal_parseStream(saxreader *This, ISequentialStream *stream,
 
     locator->pParserCtxt = xmlCreatePushParserCtxt(
             &locator->saxreader->sax, locator,
-            data, dataRead, NULL);
+            This->input_buffer, dataRead, NULL);
     if(!locator->pParserCtxt)
     {
         ISAXLocator_Release(&locator->ISAXLocator_iface);
@@ -2613,16 +2682,16 @@ static HRESULT internal_parseStream(saxreader *This, ISequentialStream *stream,
 
     do {
         dataRead = 0;
-        hr = ISequentialStream_Read(stream, data, sizeof(data), &dataRead);
+        hr = ISequentialStream_Read(stream, This->input_buffer, SAX_INPUT_BUFFER_SIZE, &dataRead);
         if (FAILED(hr) || !dataRead) break;
 
-        ret = xmlParseChunk(locator->pParserCtxt, data, dataRead, 0);
+        ret = xmlParseChunk(locator->pParserCtxt, This->input_buffer, dataRead, 0);
         hr = ret!=XML_ERR_OK && locator->ret==S_OK ? E_FAIL : locator->ret;
     }while(hr == S_OK);
 
     if(SUCCEEDED(hr))
     {
-        ret = xmlParseChunk(locator->pParserCtxt, data, 0, 1);
+        ret = xmlParseChunk(locator->pParserCtxt, This->input_buffer, 0, 1);
         hr = ret!=XML_ERR_OK && locator->ret==S_OK ? E_FAIL : locator->ret;
     }
 
@@ -2963,6 +3032,7 @@ static ULONG WINAPI saxxmlreader_Release(
 
         SysFreeString(This->xmldecl_version);
         free_bstr_pool(&This->pool);
+        heap_free(This->input_buffer);
 
         heap_free( This );
     }
@@ -3466,6 +3536,7 @@ HRESULT SAXXMLReader_create(MSXML_VERSION version, LPVOID *ppObj)
     reader->pool.pool = NULL;
     reader->pool.index = 0;
     reader->pool.len = 0;
+    reader->input_buffer = NULL;
     reader->features = Namespaces | NamespacePrefixes;
     reader->version = version;
 
@@ -42,6 +42,7 @@
 #include "msxml_private.h"
 
 #include "wine/debug.h"
+#include "wine/rbtree.h"
 
 /* This file implements the object returned by a XPath query. Note that this is
  * not the IXMLDOMNodeList returned by childNodes - it's implemented in nodelist.c.
@@ -767,10 +768,393 @@ static void query_serror(void* ctx, xmlErrorPtr err)
     LIBXML2_CALLBACK_SERROR(domselection_create, err);
 }
 
+/* Applications tend to run the same few queries over and over, so compiled
+ * expressions are kept per document, most recently used first. */
+#define MAX_CACHED_QUERIES 32
+
+typedef struct
+{
+    struct list entry;
+    xmlChar *query;
+    BOOL xpath;
+    xmlXPathCompExprPtr comp;
+} cached_query;
+
+typedef struct
+{
+    struct wine_rb_entry entry;
+    xmlChar *key;
+    xmlNodePtr *nodes;
+    unsigned int count;
+    unsigned int size;
+} node_index_entry;
+
+/* Shared by all selections on the document, which free-threaded documents
+ * may run concurrently. The lock is held across evaluation, so compiled
+ * queries and indexed nodes can't be freed while they are in use. */
+struct selection_cache
+{
+    CRITICAL_SECTION cs;
+    struct list queries;
+    unsigned int query_count;
+
+    /* Elements by name and by "id" attribute value, in document order.
+     * Built on first use, dropped when the document tree changes. */
+    BOOL index_valid;
+    struct wine_rb_tree names;
+    struct wine_rb_tree ids;
+};
+
+static int node_index_compare(const void *key, const struct wine_rb_entry *entry)
+{
+    return xmlStrcmp(key, WINE_RB_ENTRY_VALUE(entry, node_index_entry, entry)->key);
+}
+
+static void free_node_index_entry(struct wine_rb_entry *entry, void *context)
+{
+    node_index_entry *index_entry = WINE_RB_ENTRY_VALUE(entry, node_index_entry, entry);
+
+    xmlFree(index_entry->key);
+    heap_free(index_entry->nodes);
+    heap_free(index_entry);
+}
+
+struct selection_cache *create_selection_cache(void)
+{
+    struct selection_cache *cache = heap_alloc(sizeof(*cache));
+
+    if (!cache)
+        return NULL;
+
+    InitializeCriticalSection(&cache->cs);
+    cache->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": selection_cache.cs");
+    list_init(&cache->queries);
+    cache->query_count = 0;
+    cache->index_valid = FALSE;
+    wine_rb_init(&cache->names, node_index_compare);
+    wine_rb_init(&cache->ids, node_index_compare);
+    return cache;
+}
+
+void selection_cache_reset_index(struct selection_cache *cache)
+{
+    if (!cache)
+        return;
+
+    EnterCriticalSection(&cache->cs);
+    if (cache->index_valid)
+    {
+        wine_rb_clear(&cache->names, free_node_index_entry, NULL);
+        wine_rb_clear(&cache->ids, free_node_index_entry, NULL);
+        cache->index_valid = FALSE;
+    }
+    LeaveCriticalSection(&cache->cs);
+}
+
+static void free_cached_query(cached_query *query)
+{
+    list_remove(&query->entry);
+    xmlXPathFreeCompExpr(query->comp);
+    xmlFree(query->query);
+    heap_free(query);
+}
+
+void selection_cache_reset_queries(struct selection_cache *cache)
+{
+    cached_query *query, *query2;
+
+    if (!cache)
+        return;
+
+    EnterCriticalSection(&cache->cs);
+    LIST_FOR_EACH_ENTRY_SAFE(query, query2, &cache->queries, cached_query, entry)
+        free_cached_query(query);
+    cache->query_count = 0;
+    LeaveCriticalSection(&cache->cs);
+}
+
+void free_selection_cache(struct selection_cache *cache)
+{
+    if (!cache)
+        return;
+
+    selection_cache_reset_queries(cache);
+    selection_cache_reset_index(cache);
+    cache->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&cache->cs);
+    heap_free(cache);
+}
+
+static BOOL node_index_add(struct wine_rb_tree *tree, const xmlChar *key, xmlNodePtr node)
+{
+    struct wine_rb_entry *entry = wine_rb_get(tree, key);
+    node_index_entry *index_entry;
+
+    if (entry)
+        index_entry = WINE_RB_ENTRY_VALUE(entry, node_index_entry, entry);
+    else
+    {
+        if (!(index_entry = heap_alloc_zero(sizeof(*index_entry))))
+            return FALSE;
+        if (!(index_entry->key = xmlStrdup(key)))
+        {
+            heap_free(index_entry);
+            return FALSE;
+        }
+        wine_rb_put(tree, index_entry->key, &index_entry->entry);
+    }
+
+    if (index_entry->count == index_entry->size)
+    {
+        unsigned int size = index_entry->size ? index_entry->size * 2 : 4;
+        xmlNodePtr *nodes = heap_realloc(index_entry->nodes, size * sizeof(*nodes));
+
+        if (!nodes)
+            return FALSE;
+        index_entry->nodes = nodes;
+        index_entry->size = size;
+    }
+
+    index_entry->nodes[index_entry->count++] = node;
+    return TRUE;
+}
+
+static BOOL index_element(struct selection_cache *cache, xmlNodePtr node)
+{
+    xmlAttrPtr attr;
+    xmlChar *value;
+    BOOL ret;
+
+    if (!node_index_add(&cache->names, node->name, node))
+        return FALSE;
+
+    for (attr = node->properties; attr; attr = attr->next)
+    {
+        if (!attr->ns && xmlStrEqual(attr->name, BAD_CAST "id"))
+            break;
+    }
+    if (!attr)
+        return TRUE;
+
+    value = xmlNodeGetContent((xmlNodePtr)attr);
+    ret = node_index_add(&cache->ids, value ? value : BAD_CAST "", node);
+    xmlFree(value);
+    return ret;
+}
+
+static BOOL build_node_index(struct selection_cache *cache, xmlDocPtr doc)
+{
+    xmlNodePtr node = doc->children;
+
+    while (node)
+    {
+        if (node->type == XML_ELEMENT_NODE)
+        {
+            if (!index_element(cache, node))
+            {
+                cache->index_valid = TRUE;
+                selection_cache_reset_index(cache);
+                return FALSE;
+            }
+            if (node->children)
+            {
+                node = node->children;
+                continue;
+            }
+        }
+
+        while (!node->next && node->parent != (xmlNodePtr)doc)
+            node = node->parent;
+        node = node->next;
+    }
+
+    cache->index_valid = TRUE;
+    return TRUE;
+}
+
+static BOOL is_name_char(xmlChar c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           c == '_' || c == '-' || c == '.';
+}
+
+/* Recognizes "//name" and "//name[@id='value']", where name may also be "*"
+ * when filtering by id. These select the same elements in XPath and
+ * XSLPattern modes, except for how the name test treats namespaces. */
+static BOOL parse_indexed_query(const xmlChar *query, xmlChar **name, xmlChar **id)
+{
+    static const char * const operators[] = {"and", "or", "div", "mod"};
+    const xmlChar *p = query + 2, *name_end, *value = NULL;
+    unsigned int i;
+    xmlChar quote;
+
+    *name = *id = NULL;
+
+    if (query[0] != '/' || query[1] != '/')
+        return FALSE;
+
+    if (*p == '*')
+        p++;
+    else if ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || *p == '_')
+    {
+        while (is_name_char(*p)) p++;
+        for (i = 0; i < ARRAY_SIZE(operators); i++)
+        {
+            if (xmlStrlen(BAD_CAST operators[i]) == p - query - 2 &&
+                    !xmlStrncmp(query + 2, BAD_CAST operators[i], p - query - 2))
+                return FALSE;
+        }
+    }
+    else
+        return FALSE;
+    name_end = p;
+
+    if (*p)
+    {
+        if (xmlStrncmp(p, BAD_CAST "[@id=", 5))
+            return FALSE;
+        p += 5;
+        if (*p != '\'' && *p != '"')
+            return FALSE;
+        quote = *p++;
+        value = p;
+        while (*p && *p != quote) p++;
+        if (!*p || p[1] != ']' || p[2])
+            return FALSE;
+    }
+    else if (query[2] == '*')
+        return FALSE;
+
+    if (!(*name = xmlStrndup(query + 2, name_end - query - 2)))
+        return FALSE;
+    if (value && !(*id = xmlStrndup(value, p - value)))
+    {
+        xmlFree(*name);
+        *name = NULL;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static BOOL element_name_matches(xmlNodePtr node, const xmlChar *name, BOOL xpath)
+{
+    if (name[0] == '*' && !name[1])
+        return TRUE;
+    if (!xmlStrEqual(node->name, name))
+        return FALSE;
+    /* XPath name tests require no namespace, XSLPattern ones compare qualified names. */
+    return xpath ? !node->ns : !node->ns || !node->ns->prefix;
+}
+
+static BOOL is_in_document_tree(xmlNodePtr node)
+{
+    while (node->parent)
+        node = node->parent;
+    return node == (xmlNodePtr)node->doc;
+}
+
+static xmlXPathObjectPtr select_from_index(struct selection_cache *cache, xmlNodePtr node,
+        const xmlChar *query, BOOL xpath)
+{
+    xmlXPathObjectPtr result = NULL;
+    struct wine_rb_entry *entry;
+    node_index_entry *index_entry;
+    xmlChar *name, *id;
+    unsigned int i;
+
+    if (!cache || !parse_indexed_query(query, &name, &id))
+        return NULL;
+
+    if (!is_in_document_tree(node) || (!cache->index_valid && !build_node_index(cache, node->doc)))
+        goto done;
+
+    if (!(result = xmlXPathNewNodeSet(NULL)))
+        goto done;
+
+    entry = id ? wine_rb_get(&cache->ids, id) : wine_rb_get(&cache->names, name);
+    if (!entry)
+        goto done;
+
+    index_entry = WINE_RB_ENTRY_VALUE(entry, node_index_entry, entry);
+    for (i = 0; i < index_entry->count; i++)
+    {
+        if (element_name_matches(index_entry->nodes[i], name, xpath))
+            xmlXPathNodeSetAddUnique(result->nodesetval, index_entry->nodes[i]);
+    }
+
+done:
+    xmlFree(name);
+    xmlFree(id);
+    return result;
+}
+
+static xmlXPathCompExprPtr compile_query(xmlXPathContextPtr ctxt, const xmlChar *query, BOOL xpath)
+{
+    xmlXPathCompExprPtr comp;
+    xmlChar *pattern_query;
+
+    if (xpath)
+        return xmlXPathCtxtCompile(ctxt, query);
+
+    if (!(pattern_query = XSLPattern_to_XPath(ctxt, query)))
+        return NULL;
+    comp = xmlXPathCtxtCompile(ctxt, pattern_query);
+    xmlFree(pattern_query);
+    return comp;
+}
+
+static xmlXPathObjectPtr evaluate_query(struct selection_cache *cache, xmlXPathContextPtr ctxt,
+        const xmlChar *query, BOOL xpath)
+{
+    xmlXPathObjectPtr result;
+    xmlXPathCompExprPtr comp;
+    cached_query *entry;
+
+    if (cache)
+    {
+        LIST_FOR_EACH_ENTRY(entry, &cache->queries, cached_query, entry)
+        {
+            if (entry->xpath == xpath && xmlStrEqual(entry->query, query))
+            {
+                list_remove(&entry->entry);
+                list_add_head(&cache->queries, &entry->entry);
+                return xmlXPathCompiledEval(entry->comp, ctxt);
+            }
+        }
+    }
+
+    if (!(comp = compile_query(ctxt, query, xpath)))
+        return NULL;
+
+    result = xmlXPathCompiledEval(comp, ctxt);
+
+    if (cache && (entry = heap_alloc(sizeof(*entry))))
+    {
+        if ((entry->query = xmlStrdup(query)))
+        {
+            entry->xpath = xpath;
+            entry->comp = comp;
+            list_add_head(&cache->queries, &entry->entry);
+            if (++cache->query_count > MAX_CACHED_QUERIES)
+            {
+                free_cached_query(LIST_ENTRY(list_tail(&cache->queries), cached_query, entry));
+                cache->query_count--;
+            }
+            return result;
+        }
+        heap_free(entry);
+    }
+
+    xmlXPathFreeCompExpr(comp);
+    return result;
+}
+
 HRESULT create_selection(xmlNodePtr node, xmlChar* query, IXMLDOMNodeList **out)
 {
     domselection *This = heap_alloc(sizeof(domselection));
     xmlXPathContextPtr ctxt = xmlXPathNewContext(node->doc);
+    struct selection_cache *cache;
+    BOOL xpath;
     HRESULT hr;
 
     TRACE("(%p, %s, %p)\n", node, debugstr_a((char const*)query), out);
@@ -795,15 +1179,13 @@ HRESULT create_selection(xmlNodePtr node, xmlChar* query, IXMLDOMNodeList **out)
     ctxt->node = node;
     registerNamespaces(ctxt);
 
-    if (is_xpathmode(This->node->doc))
+    xpath = is_xpathmode(This->node->doc);
+    if (xpath)
     {
         xmlXPathRegisterAllFunctions(ctxt);
-        This->result = xmlXPathEvalExpression(query, ctxt);
     }
     else
     {
-        xmlChar* pattern_query = XSLPattern_to_XPath(ctxt, query);
-
         xmlXPathRegisterFunc(ctxt, (xmlChar const*)"not", xmlXPathNotFunction);
         xmlXPathRegisterFunc(ctxt, (xmlChar const*)"boolean", xmlXPathBooleanFunction);
 
@@ -817,11 +1199,15 @@ HRESULT create_selection(xmlNodePtr node, xmlChar* query, IXMLDOMNodeList **out)
         xmlXPathRegisterFunc(ctxt, (xmlChar const*)"OP_ILEq", XSLPattern_OP_ILEq);
         xmlXPathRegisterFunc(ctxt, (xmlChar const*)"OP_IGt", XSLPattern_OP_IGt);
         xmlXPathRegisterFunc(ctxt, (xmlChar const*)"OP_IGEq", XSLPattern_OP_IGEq);
-
-        This->result = xmlXPathEvalExpression(pattern_query, ctxt);
-        xmlFree(pattern_query);
     }
 
+    if ((cache = xmldoc_get_selection_cache(node->doc)))
+        EnterCriticalSection(&cache->cs);
+    if (!(This->result = select_from_index(cache, node, query, xpath)))
+        This->result = evaluate_query(cache, ctxt, query, xpath);
+    if (cache)
+        LeaveCriticalSection(&cache->cs);
+
     if (!This->result || This->result->type != XPATH_NODESET)
     {
         hr = E_FAIL;
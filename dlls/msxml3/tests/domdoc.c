@@ -8496,6 +8496,234 @@ static void test_selectSingleNode(void)
     free_bstrs();
 }
 
+static const char selection_cacheXML[] =
+"<?xml version=\"1.0\"?>"
+"<root xmlns:foo=\"urn:foo\">"
+"<item id=\"a\"/><item id=\"b\"><item id=\"c\"/></item>"
+"<foo:item id=\"a\"/><other id=\"b\"/>"
+"</root>";
+
+static void test_selection_cache(void)
+{
+    IXMLDOMNode *root, *node;
+    IXMLDOMNodeList *list;
+    IXMLDOMDocument2 *doc;
+    IXMLDOMElement *elem;
+    VARIANT_BOOL b;
+    VARIANT var;
+    HRESULT hr;
+    int i;
+
+    doc = create_document(&IID_IXMLDOMDocument2);
+
+    hr = IXMLDOMDocument2_loadXML(doc, _bstr_(selection_cacheXML), &b);
+    EXPECT_HR(hr, S_OK);
+    ok(b == VARIANT_TRUE, "failed to load XML string\n");
+
+    hr = IXMLDOMDocument2_selectSingleNode(doc, _bstr_("root"), &root);
+    EXPECT_HR(hr, S_OK);
+
+    /* repeated queries give the same results */
+    for (i = 0; i < 2; i++)
+    {
+        ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//item"), &list));
+        EXPECT_LIST_LEN(list, 3);
+        IXMLDOMNodeList_Release(list);
+
+        ole_check(IXMLDOMNode_selectNodes(root, _bstr_("//*[@id='a']"), &list));
+        EXPECT_LIST_LEN(list, 2);
+        IXMLDOMNodeList_Release(list);
+
+        ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//item[@id=\"b\"]"), &list));
+        EXPECT_LIST_LEN(list, 1);
+        IXMLDOMNodeList_Release(list);
+
+        ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//foo:item"), &list));
+        EXPECT_LIST_LEN(list, 1);
+        IXMLDOMNodeList_Release(list);
+    }
+
+    /* results follow tree changes */
+    hr = IXMLDOMDocument2_createElement(doc, _bstr_("item"), &elem);
+    EXPECT_HR(hr, S_OK);
+    hr = IXMLDOMElement_setAttribute(elem, _bstr_("id"), _variantbstr_("d"));
+    EXPECT_HR(hr, S_OK);
+    hr = IXMLDOMNode_appendChild(root, (IXMLDOMNode *)elem, NULL);
+    EXPECT_HR(hr, S_OK);
+
+    ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//item"), &list));
+    EXPECT_LIST_LEN(list, 4);
+    IXMLDOMNodeList_Release(list);
+
+    ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//*[@id='d']"), &list));
+    EXPECT_LIST_LEN(list, 1);
+    IXMLDOMNodeList_Release(list);
+
+    hr = IXMLDOMElement_setAttribute(elem, _bstr_("id"), _variantbstr_("a"));
+    EXPECT_HR(hr, S_OK);
+
+    ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//*[@id='d']"), &list));
+    EXPECT_LIST_LEN(list, 0);
+    IXMLDOMNodeList_Release(list);
+
+    ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//*[@id='a']"), &list));
+    EXPECT_LIST_LEN(list, 3);
+    IXMLDOMNodeList_Release(list);
+
+    hr = IXMLDOMNode_removeChild(root, (IXMLDOMNode *)elem, &node);
+    EXPECT_HR(hr, S_OK);
+    IXMLDOMNode_Release(node);
+
+    ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//item"), &list));
+    EXPECT_LIST_LEN(list, 3);
+    IXMLDOMNodeList_Release(list);
+
+    IXMLDOMElement_Release(elem);
+
+    /* XSLPattern queries depend on selection namespaces */
+    ole_check(IXMLDOMDocument2_setProperty(doc, _bstr_("SelectionNamespaces"), _variantbstr_("xmlns:foo='urn:bar'")));
+    ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//foo:item"), &list));
+    EXPECT_LIST_LEN(list, 0);
+    IXMLDOMNodeList_Release(list);
+
+    /* XPath name tests don't match elements in a namespace */
+    ole_check(IXMLDOMDocument2_setProperty(doc, _bstr_("SelectionLanguage"), _variantbstr_("XPath")));
+    ole_check(IXMLDOMDocument2_setProperty(doc, _bstr_("SelectionNamespaces"), _variantbstr_("xmlns:foo='urn:foo'")));
+
+    ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//item"), &list));
+    EXPECT_LIST_LEN(list, 3);
+    IXMLDOMNodeList_Release(list);
+
+    ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//foo:item"), &list));
+    EXPECT_LIST_LEN(list, 1);
+    IXMLDOMNodeList_Release(list);
+
+    ole_check(IXMLDOMDocument2_selectNodes(doc, _bstr_("//*[@id='a']"), &list));
+    EXPECT_LIST_LEN(list, 2);
+    IXMLDOMNodeList_Release(list);
+
+    V_VT(&var) = VT_EMPTY;
+    hr = IXMLDOMDocument2_getProperty(doc, _bstr_("SelectionLanguage"), &var);
+    EXPECT_HR(hr, S_OK);
+    ok(!lstrcmpW(V_BSTR(&var), _bstr_("XPath")), "got %s\n", wine_dbgstr_w(V_BSTR(&var)));
+    VariantClear(&var);
+
+    IXMLDOMNode_Release(root);
+    IXMLDOMDocument2_Release(doc);
+    free_bstrs();
+}
+
+static DWORD WINAPI selection_cache_thread(void *arg)
+{
+    IXMLDOMDocument2 *doc = arg;
+    IXMLDOMNodeList *list;
+    char query[32];
+    BSTR str;
+    HRESULT hr;
+    LONG len;
+    int i;
+
+    CoInitializeEx(NULL, COINIT_MULTITHREADED);
+    for (i = 0; i < 200; i++)
+    {
+        sprintf(query, "//item[@id='%c']", 'a' + i % 3);
+        str = alloc_str_from_narrow(query);
+        hr = IXMLDOMDocument2_selectNodes(doc, str, &list);
+        SysFreeString(str);
+        ok(hr == S_OK, "query %s failed: %#x\n", query, hr);
+        if (hr != S_OK) break;
+        hr = IXMLDOMNodeList_get_length(list, &len);
+        ok(hr == S_OK && len == 1, "%s: got %#x, length %d\n", query, hr, len);
+        IXMLDOMNodeList_Release(list);
+
+        /* more distinct queries than the cache holds, so entries get evicted */
+        sprintf(query, "/root/item[%d]", 1 + i % 40);
+        str = alloc_str_from_narrow(query);
+        hr = IXMLDOMDocument2_selectNodes(doc, str, &list);
+        SysFreeString(str);
+        ok(hr == S_OK, "query %s failed: %#x\n", query, hr);
+        if (hr != S_OK) break;
+        IXMLDOMNodeList_Release(list);
+    }
+    CoUninitialize();
+    return 0;
+}
+
+static void test_selection_cache_threads(void)
+{
+    IXMLDOMDocument2 *doc;
+    HANDLE threads[4];
+    VARIANT_BOOL b;
+    HRESULT hr;
+    int i;
+
+    if (!is_clsid_supported(&CLSID_FreeThreadedDOMDocument, &IID_IXMLDOMDocument2))
+        return;
+
+    hr = CoCreateInstance(&CLSID_FreeThreadedDOMDocument, NULL, CLSCTX_INPROC_SERVER, &IID_IXMLDOMDocument2, (void**)&doc);
+    EXPECT_HR(hr, S_OK);
+    hr = IXMLDOMDocument2_loadXML(doc, _bstr_(selection_cacheXML), &b);
+    EXPECT_HR(hr, S_OK);
+    ok(b == VARIANT_TRUE, "failed to load XML string\n");
+    ole_check(IXMLDOMDocument2_setProperty(doc, _bstr_("SelectionLanguage"), _variantbstr_("XPath")));
+
+    for (i = 0; i < ARRAY_SIZE(threads); i++)
+        threads[i] = CreateThread(NULL, 0, selection_cache_thread, doc, 0, NULL);
+    for (i = 0; i < ARRAY_SIZE(threads); i++)
+    {
+        ok(!WaitForSingleObject(threads[i], 20000), "thread %d timed out\n", i);
+        CloseHandle(threads[i]);
+    }
+
+    IXMLDOMDocument2_Release(doc);
+    free_bstrs();
+}
+
+static void test_selection_benchmark(void)
+{
+    static const char *queries[] =
+    {
+        "//item[@id='i1500']",
+        "//item",
+        "/root/item[@id='i10']/value",
+        "//value[. > 1990]",
+    };
+    IXMLDOMNodeList *list;
+    IXMLDOMDocument2 *doc;
+    DWORD start, i, j;
+    VARIANT_BOOL b;
+    HRESULT hr;
+    char *xml;
+    int pos;
+
+    xml = HeapAlloc(GetProcessHeap(), 0, 2000 * 64 + 64);
+    pos = sprintf(xml, "<root>");
+    for (i = 0; i < 2000; i++)
+        pos += sprintf(xml + pos, "<item id=\"i%u\"><value>%u</value></item>", i, i);
+    strcpy(xml + pos, "</root>");
+
+    doc = create_document(&IID_IXMLDOMDocument2);
+    hr = IXMLDOMDocument2_loadXML(doc, _bstr_(xml), &b);
+    ok(hr == S_OK && b == VARIANT_TRUE, "failed to load XML string\n");
+    HeapFree(GetProcessHeap(), 0, xml);
+    ole_check(IXMLDOMDocument2_setProperty(doc, _bstr_("SelectionLanguage"), _variantbstr_("XPath")));
+
+    for (i = 0; i < ARRAY_SIZE(queries); i++)
+    {
+        start = GetTickCount();
+        for (j = 0; j < 200; j++)
+        {
+            hr = IXMLDOMDocument2_selectNodes(doc, _bstr_(queries[i]), &list);
+            ok(hr == S_OK, "query %s failed: %#x\n", queries[i], hr);
+            IXMLDOMNodeList_Release(list);
+        }
+        trace("%s: %u ms\n", queries[i], GetTickCount() - start);
+    }
+
+    IXMLDOMDocument2_Release(doc);
+    free_bstrs();
+}
+
 static void test_events(void)
 {
     IConnectionPointContainer *conn;
@@ -13514,6 +13742,8 @@ START_TEST(domdoc)
     test_get_prefix();
     test_default_properties();
     test_selectSingleNode();
+    test_selection_cache();
+    test_selection_cache_threads();
     test_events();
     test_createProcessingInstruction();
     test_put_nodeTypedValue();
@@ -13548,6 +13778,9 @@ START_TEST(domdoc)
     test_xsltemplate();
     test_xsltext();
 
+    if (winetest_interactive)
+        test_selection_benchmark();
+
     if (is_clsid_supported(&CLSID_MXNamespaceManager40, &IID_IMXNamespaceManager))
     {
         test_mxnamespacemanager();
@@ -5751,6 +5751,214 @@ static void test_mxwriter_indent(void)
     free_bstrs();
 }
 
+struct counting_handler
+{
+    ISAXContentHandler ISAXContentHandler_iface;
+    LONG elements;
+    LONG chars;
+    LONG attr_chars;
+};
+
+static inline struct counting_handler *impl_from_counting_handler(ISAXContentHandler *iface)
+{
+    return CONTAINING_RECORD(iface, struct counting_handler, ISAXContentHandler_iface);
+}
+
+static HRESULT WINAPI counting_QueryInterface(ISAXContentHandler *iface, REFIID riid, void **obj)
+{
+    if (IsEqualGUID(riid, &IID_IUnknown) || IsEqualGUID(riid, &IID_ISAXContentHandler))
+    {
+        *obj = iface;
+        return S_OK;
+    }
+
+    *obj = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG WINAPI counting_AddRef(ISAXContentHandler *iface)
+{
+    return 2;
+}
+
+static ULONG WINAPI counting_Release(ISAXContentHandler *iface)
+{
+    return 1;
+}
+
+static HRESULT WINAPI counting_putDocumentLocator(ISAXContentHandler *iface, ISAXLocator *locator)
+{
+    return S_OK;
+}
+
+static HRESULT WINAPI counting_startDocument(ISAXContentHandler *iface)
+{
+    return S_OK;
+}
+
+static HRESULT WINAPI counting_endDocument(ISAXContentHandler *iface)
+{
+    return S_OK;
+}
+
+static HRESULT WINAPI counting_startPrefixMapping(ISAXContentHandler *iface, const WCHAR *prefix,
+        int prefix_len, const WCHAR *uri, int uri_len)
+{
+    return S_OK;
+}
+
+static HRESULT WINAPI counting_endPrefixMapping(ISAXContentHandler *iface, const WCHAR *prefix, int len)
+{
+    return S_OK;
+}
+
+static HRESULT WINAPI counting_startElement(ISAXContentHandler *iface, const WCHAR *uri, int uri_len,
+        const WCHAR *localname, int local_len, const WCHAR *qname, int qname_len, ISAXAttributes *attrs)
+{
+    struct counting_handler *handler = impl_from_counting_handler(iface);
+    const WCHAR *value;
+    int count, len, i;
+    HRESULT hr;
+
+    handler->elements++;
+
+    hr = ISAXAttributes_getLength(attrs, &count);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+    for (i = 0; i < count; i++)
+    {
+        hr = ISAXAttributes_getValue(attrs, i, &value, &len);
+        ok(hr == S_OK, "got 0x%08x\n", hr);
+        handler->attr_chars += len;
+    }
+
+    return S_OK;
+}
+
+static HRESULT WINAPI counting_endElement(ISAXContentHandler *iface, const WCHAR *uri, int uri_len,
+        const WCHAR *localname, int local_len, const WCHAR *qname, int qname_len)
+{
+    return S_OK;
+}
+
+static HRESULT WINAPI counting_characters(ISAXContentHandler *iface, const WCHAR *chars, int len)
+{
+    struct counting_handler *handler = impl_from_counting_handler(iface);
+    handler->chars += len;
+    return S_OK;
+}
+
+static HRESULT WINAPI counting_ignorableWhitespace(ISAXContentHandler *iface, const WCHAR *chars, int len)
+{
+    return S_OK;
+}
+
+static HRESULT WINAPI counting_processingInstruction(ISAXContentHandler *iface, const WCHAR *target,
+        int target_len, const WCHAR *data, int data_len)
+{
+    return S_OK;
+}
+
+static HRESULT WINAPI counting_skippedEntity(ISAXContentHandler *iface, const WCHAR *name, int len)
+{
+    return S_OK;
+}
+
+static const ISAXContentHandlerVtbl counting_handler_vtbl =
+{
+    counting_QueryInterface,
+    counting_AddRef,
+    counting_Release,
+    counting_putDocumentLocator,
+    counting_startDocument,
+    counting_endDocument,
+    counting_startPrefixMapping,
+    counting_endPrefixMapping,
+    counting_startElement,
+    counting_endElement,
+    counting_characters,
+    counting_ignorableWhitespace,
+    counting_processingInstruction,
+    counting_skippedEntity
+};
+
+/* Each record is 64 bytes, with 6 characters of text and 9 of attribute values. */
+static IStream *create_records_stream(int count)
+{
+    static const char header[] = "<?xml version=\"1.0\"?>\n<records>";
+    static const char footer[] = "</records>";
+    ULARGE_INTEGER size;
+    LARGE_INTEGER pos;
+    IStream *stream;
+    char record[65];
+    HRESULT hr;
+    int i;
+
+    hr = CreateStreamOnHGlobal(NULL, TRUE, &stream);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+
+    size.QuadPart = count * 64 + sizeof(header) + sizeof(footer);
+    IStream_SetSize(stream, size);
+
+    IStream_Write(stream, header, sizeof(header) - 1, NULL);
+    for (i = 0; i < count; i++)
+    {
+        sprintf(record, "<r id=\"%06d\" k=\"a&amp;b\"><v>%06d</v></r>%19s\n", i, i, "");
+        IStream_Write(stream, record, 64, NULL);
+    }
+    IStream_Write(stream, footer, sizeof(footer) - 1, NULL);
+
+    pos.QuadPart = 0;
+    IStream_Seek(stream, pos, STREAM_SEEK_SET, NULL);
+    return stream;
+}
+
+static void parse_records(int count, BOOL benchmark)
+{
+    struct counting_handler handler = {{&counting_handler_vtbl}};
+    ISAXXMLReader *reader;
+    IStream *stream;
+    DWORD start;
+    VARIANT var;
+    HRESULT hr;
+
+    hr = CoCreateInstance(&CLSID_SAXXMLReader, NULL, CLSCTX_INPROC_SERVER,
+            &IID_ISAXXMLReader, (void**)&reader);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+
+    hr = ISAXXMLReader_putContentHandler(reader, &handler.ISAXContentHandler_iface);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+
+    stream = create_records_stream(count);
+    V_VT(&var) = VT_UNKNOWN;
+    V_UNKNOWN(&var) = (IUnknown*)stream;
+
+    start = GetTickCount();
+    hr = ISAXXMLReader_parse(reader, var);
+    ok(hr == S_OK, "got 0x%08x\n", hr);
+    if (benchmark)
+    {
+        DWORD elapsed = max(GetTickCount() - start, 1);
+        trace("parsed %d records (%u KB) in %u ms, %u MB/s\n", count, count * 64 / 1024, elapsed,
+                count * 64 / 1024 * 1000 / 1024 / elapsed);
+    }
+
+    ok(handler.elements == count * 2 + 1, "got %d elements\n", handler.elements);
+    ok(handler.attr_chars == count * 9, "got %d attribute characters\n", handler.attr_chars);
+    ok(handler.chars >= count * 6, "got %d characters\n", handler.chars);
+
+    IStream_Release(stream);
+    ISAXXMLReader_Release(reader);
+}
+
+static void test_saxreader_large_stream(void)
+{
+    /* Larger than the input buffer, so the document is parsed in several chunks. */
+    parse_records(5000, FALSE);
+
+    if (winetest_interactive)
+        parse_records(500000, TRUE);
+}
+
 START_TEST(saxreader)
 {
     ISAXXMLReader *reader;
@@ -5779,6 +5987,7 @@ START_TEST(saxreader)
     test_saxreader_features();
     test_saxreader_encoding();
     test_saxreader_dispex();
+    test_saxreader_large_stream();
 
     /* MXXMLWriter tests */
     get_class_support_data(mxwriter_support_data, &IID_IMXWriter);
@@ -1420,6 +1420,78 @@ static void resolve_labels(compile_ctx_t *ctx, unsigned off)
     ctx->labels_cnt = 0;
 }
 
+/* Matches lookup_identifier, see get_local in interp.c for the slot layout. */
+static BOOL lookup_local_slot(function_t *func, const WCHAR *name, unsigned *ret)
+{
+    unsigned i;
+
+    if((func->type == FUNC_FUNCTION || func->type == FUNC_PROPGET || func->type == FUNC_DEFGET)
+       && !wcsicmp(name, func->name)) {
+        *ret = func->var_cnt + func->arg_cnt;
+        return TRUE;
+    }
+
+    for(i = 0; i < func->var_cnt; i++) {
+        if(!wcsicmp(func->vars[i].name, name)) {
+            *ret = i;
+            return TRUE;
+        }
+    }
+
+    for(i = 0; i < func->arg_cnt; i++) {
+        if(!wcsicmp(func->args[i].name, name)) {
+            *ret = func->var_cnt + i;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/* Binds references to local variables, so that they don't need to be looked up by name at run time. */
+static void resolve_locals(compile_ctx_t *ctx, function_t *func)
+{
+    instr_t *instr;
+    unsigned slot;
+
+    for(instr = ctx->code->instrs+func->code_off; instr < ctx->code->instrs+ctx->instr_cnt; instr++) {
+        switch(instr->op) {
+        case OP_icall:
+            if(lookup_local_slot(func, instr->arg1.bstr, &slot)) {
+                instr->op = OP_local;
+                instr->arg1.uint = slot;
+            }
+            break;
+        case OP_assign_ident:
+            if(lookup_local_slot(func, instr->arg1.bstr, &slot)) {
+                instr->op = OP_assign_local;
+                instr->arg1.uint = slot;
+            }
+            break;
+        case OP_set_ident:
+            if(lookup_local_slot(func, instr->arg1.bstr, &slot)) {
+                instr->op = OP_set_local;
+                instr->arg1.uint = slot;
+            }
+            break;
+        case OP_incc:
+            if(lookup_local_slot(func, instr->arg1.bstr, &slot)) {
+                instr->op = OP_incc_local;
+                instr->arg1.uint = slot;
+            }
+            break;
+        case OP_step:
+            if(lookup_local_slot(func, instr->arg2.bstr, &slot)) {
+                instr->op = OP_step_local;
+                instr->arg2.uint = slot;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 static HRESULT fill_array_desc(compile_ctx_t *ctx, dim_decl_t *dim_decl, array_desc_t *array_desc)
 {
     unsigned dim_cnt = 0, i;
@@ -1531,6 +1603,9 @@ static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *f
         assert(array_id == func->array_cnt);
     }
 
+    if(func->type != FUNC_GLOBAL)
+        resolve_locals(ctx, func);
+
     return S_OK;
 }
 
@@ -1778,10 +1853,10 @@ static HRESULT compile_class(compile_ctx_t *ctx, class_decl_t *class_decl)
     return S_OK;
 }
 
-static BOOL lookup_script_identifier(compile_ctx_t *ctx, script_ctx_t *script, const WCHAR *identifier)
+static BOOL lookup_script_identifier(vbscode_t *new_code, script_ctx_t *script, const WCHAR *identifier)
 {
     ScriptDisp *contexts[] = {
-        ctx->code->named_item ? ctx->code->named_item->script_obj : NULL,
+        new_code->named_item ? new_code->named_item->script_obj : NULL,
         script->script_obj
     };
     class_desc_t *class;
@@ -1791,15 +1866,8 @@ static BOOL lookup_script_identifier(compile_ctx_t *ctx, script_ctx_t *script, c
     for(c = 0; c < ARRAY_SIZE(contexts); c++) {
         if(!contexts[c]) continue;
 
-        for(i = 0; i < contexts[c]->global_vars_cnt; i++) {
-            if(!wcsicmp(contexts[c]->global_vars[i]->name, identifier))
-                return TRUE;
-        }
-
-        for(i = 0; i < contexts[c]->global_funcs_cnt; i++) {
-            if(!wcsicmp(contexts[c]->global_funcs[i]->name, identifier))
-                return TRUE;
-        }
+        if(find_global_var(contexts[c], identifier, &i) || find_global_func(contexts[c], identifier, &i))
+            return TRUE;
 
         for(class = contexts[c]->classes; class; class = class->next) {
             if(!wcsicmp(class->name, identifier))
@@ -1812,7 +1880,7 @@ static BOOL lookup_script_identifier(compile_ctx_t *ctx, script_ctx_t *script, c
         var_desc_t *vars = code->main_code.vars;
         function_t *func;
 
-        if(!code->pending_exec || (code->named_item && code->named_item != ctx->code->named_item))
+        if(!code->pending_exec || (code->named_item && code->named_item != new_code->named_item))
             continue;
 
         for(i = 0; i < var_cnt; i++) {
@@ -1834,21 +1902,21 @@ static BOOL lookup_script_identifier(compile_ctx_t *ctx, script_ctx_t *script, c
     return FALSE;
 }
 
-static HRESULT check_script_collisions(compile_ctx_t *ctx, script_ctx_t *script)
+static HRESULT check_script_collisions(vbscode_t *code, script_ctx_t *script)
 {
-    unsigned i, var_cnt = ctx->code->main_code.var_cnt;
-    var_desc_t *vars = ctx->code->main_code.vars;
+    unsigned i, var_cnt = code->main_code.var_cnt;
+    var_desc_t *vars = code->main_code.vars;
     class_desc_t *class;
 
     for(i = 0; i < var_cnt; i++) {
-        if(lookup_script_identifier(ctx, script, vars[i].name)) {
+        if(lookup_script_identifier(code, script, vars[i].name)) {
             FIXME("%s: redefined\n", debugstr_w(vars[i].name));
             return E_FAIL;
         }
     }
 
-    for(class = ctx->code->classes; class; class = class->next) {
-        if(lookup_script_identifier(ctx, script, class->name)) {
+    for(class = code->classes; class; class = class->next) {
+        if(lookup_script_identifier(code, script, class->name)) {
             FIXME("%s: redefined\n", debugstr_w(class->name));
             return E_FAIL;
         }
@@ -1928,8 +1996,167 @@ static void release_compiler(compile_ctx_t *ctx)
         release_vbscode(ctx->code);
 }
 
-HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *item_name, const WCHAR *delimiter,
-                       DWORD_PTR cookie, unsigned start_line, DWORD flags, vbscode_t **ret)
+/*
+ * Compiled code is cached, so that scripts loaded by many short-lived script
+ * engines are compiled only once. Code is reference counted without atomic
+ * operations, so an entry is only used by the thread that compiled it, and
+ * only while nothing but the cache holds a reference to it. That also lets us
+ * reset the per-use fields of vbscode_t on reuse.
+ */
+#define CODE_CACHE_BUDGET (16 * 1024 * 1024)
+
+typedef struct {
+    struct list entry;
+    vbscode_t *code;
+    DWORD thread_id;
+    unsigned hash;
+    DWORD flags;
+    WCHAR *delimiter;
+    size_t size;
+} code_cache_entry_t;
+
+static struct list code_cache = LIST_INIT(code_cache);
+static size_t code_cache_size;
+
+static CRITICAL_SECTION code_cache_cs;
+static CRITICAL_SECTION_DEBUG code_cache_cs_debug =
+{
+    0, 0, &code_cache_cs,
+    { &code_cache_cs_debug.ProcessLocksList, &code_cache_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": code_cache_cs") }
+};
+static CRITICAL_SECTION code_cache_cs = { &code_cache_cs_debug, -1, 0, 0, 0, 0 };
+
+/* Flags that don't change the compiled code. */
+#define CODE_CACHE_IGNORED_FLAGS SCRIPTTEXT_ISPERSISTENT
+
+static unsigned code_cache_hash(const WCHAR *source)
+{
+    unsigned h = 2166136261u;
+
+    for(; *source; source++)
+        h = (h ^ *source) * 16777619u;
+    return h;
+}
+
+static void free_code_cache_entry(code_cache_entry_t *entry)
+{
+    list_remove(&entry->entry);
+    code_cache_size -= entry->size;
+    release_vbscode(entry->code);
+    heap_free(entry->delimiter);
+    heap_free(entry);
+}
+
+static BOOL is_thread_alive(DWORD thread_id)
+{
+    HANDLE thread;
+    DWORD code;
+
+    if(!(thread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, thread_id)))
+        return FALSE;
+    if(!GetExitCodeThread(thread, &code))
+        code = 0;
+    CloseHandle(thread);
+    return code == STILL_ACTIVE;
+}
+
+/* Frees least recently used entries until size more bytes fit in the budget. */
+static BOOL code_cache_make_room(size_t size)
+{
+    code_cache_entry_t *entry, *prev;
+    DWORD thread_id = GetCurrentThreadId();
+
+    LIST_FOR_EACH_ENTRY_SAFE_REV(entry, prev, &code_cache, code_cache_entry_t, entry) {
+        if(code_cache_size + size <= CODE_CACHE_BUDGET)
+            break;
+
+        /* Entries of other threads may only be freed once their thread is gone. */
+        if(entry->thread_id == thread_id ? entry->code->ref == 1 : !is_thread_alive(entry->thread_id))
+            free_code_cache_entry(entry);
+    }
+
+    return code_cache_size + size <= CODE_CACHE_BUDGET;
+}
+
+static vbscode_t *lookup_code_cache(const WCHAR *source, unsigned hash, const WCHAR *delimiter, DWORD flags)
+{
+    DWORD thread_id = GetCurrentThreadId();
+    code_cache_entry_t *entry;
+    vbscode_t *code = NULL;
+
+    EnterCriticalSection(&code_cache_cs);
+
+    LIST_FOR_EACH_ENTRY(entry, &code_cache, code_cache_entry_t, entry) {
+        if(entry->hash != hash || entry->thread_id != thread_id || entry->code->ref != 1
+           || entry->flags != (flags & ~CODE_CACHE_IGNORED_FLAGS)
+           || (entry->delimiter && delimiter ? wcscmp(entry->delimiter, delimiter) : entry->delimiter != delimiter)
+           || wcscmp(entry->code->source, source))
+            continue;
+
+        list_remove(&entry->entry);
+        list_add_head(&code_cache, &entry->entry);
+        code = entry->code;
+        grab_vbscode(code);
+        break;
+    }
+
+    LeaveCriticalSection(&code_cache_cs);
+    return code;
+}
+
+static void add_to_code_cache(compile_ctx_t *ctx, unsigned hash, const WCHAR *delimiter, DWORD flags)
+{
+    vbscode_t *code = ctx->code;
+    code_cache_entry_t *entry;
+    size_t size;
+
+    size = sizeof(*code) + sizeof(*entry) + (lstrlenW(code->source) + 1) * sizeof(WCHAR) * 2
+        + ctx->instr_cnt * sizeof(instr_t) + code->bstr_cnt * 32;
+    if(size > CODE_CACHE_BUDGET / 4)
+        return;
+
+    if(!(entry = heap_alloc_zero(sizeof(*entry))))
+        return;
+    if(delimiter && !(entry->delimiter = heap_strdupW(delimiter))) {
+        heap_free(entry);
+        return;
+    }
+
+    grab_vbscode(code);
+    entry->code = code;
+    entry->thread_id = GetCurrentThreadId();
+    entry->hash = hash;
+    entry->flags = flags & ~CODE_CACHE_IGNORED_FLAGS;
+    entry->size = size;
+
+    EnterCriticalSection(&code_cache_cs);
+
+    if(code_cache_make_room(size)) {
+        list_add_head(&code_cache, &entry->entry);
+        code_cache_size += size;
+        entry = NULL;
+    }
+
+    LeaveCriticalSection(&code_cache_cs);
+
+    if(entry) {
+        release_vbscode(entry->code);
+        heap_free(entry->delimiter);
+        heap_free(entry);
+    }
+}
+
+void free_code_cache(void)
+{
+    code_cache_entry_t *entry, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE(entry, next, &code_cache, code_cache_entry_t, entry)
+        free_code_cache_entry(entry);
+}
+
+static HRESULT compile_code(script_ctx_t *script, const WCHAR *src, const WCHAR *item_name, const WCHAR *delimiter,
+                            DWORD_PTR cookie, unsigned start_line, DWORD flags, BOOL use_cache, vbscode_t **ret)
 {
     function_decl_t *func_decl;
     named_item_t *item = NULL;
@@ -1937,6 +2164,7 @@ HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *item
     function_t *new_func;
     compile_ctx_t ctx;
     vbscode_t *code;
+    unsigned hash = 0;
     HRESULT hres;
 
     if(item_name) {
@@ -1948,6 +2176,26 @@ HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *item
         if(!item->script_obj) item = NULL;
     }
 
+    /* Code bound to a named item refers to it, so it can't be shared. */
+    if(use_cache && !item) {
+        hash = code_cache_hash(src ? src : L"");
+        if((code = lookup_code_cache(src ? src : L"", hash, delimiter, flags))) {
+            /* On collision, compile again to report the error. */
+            if(SUCCEEDED(check_script_collisions(code, script))) {
+                TRACE("using cached code %p\n", code);
+                code->cookie = cookie;
+                code->start_line = start_line;
+                code->pending_exec = FALSE;
+                code->is_persistent = (flags & SCRIPTTEXT_ISPERSISTENT) != 0;
+                if(code->last_class) code->last_class->next = NULL;
+                list_add_tail(&script->code_list, &code->entry);
+                *ret = code;
+                return S_OK;
+            }
+            release_vbscode(code);
+        }
+    }
+
     memset(&ctx, 0, sizeof(ctx));
     code = ctx.code = alloc_vbscode(&ctx, src, cookie, start_line);
     if(!ctx.code)
@@ -1999,7 +2247,7 @@ HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *item
         }
     }
 
-    hres = check_script_collisions(&ctx, script);
+    hres = check_script_collisions(ctx.code, script);
     if(FAILED(hres)) {
         hres = compile_error(script, &ctx, hres);
         release_compiler(&ctx);
@@ -2011,6 +2259,9 @@ HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *item
     if(TRACE_ON(vbscript_disas))
         dump_code(&ctx);
 
+    if(use_cache && !item)
+        add_to_code_cache(&ctx, hash, delimiter, flags);
+
     ctx.code = NULL;
     release_compiler(&ctx);
 
@@ -2019,6 +2270,12 @@ HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *item
     return S_OK;
 }
 
+HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *item_name, const WCHAR *delimiter,
+                       DWORD_PTR cookie, unsigned start_line, DWORD flags, vbscode_t **ret)
+{
+    return compile_code(script, src, item_name, delimiter, cookie, start_line, flags, TRUE, ret);
+}
+
 HRESULT compile_procedure(script_ctx_t *script, const WCHAR *src, const WCHAR *item_name, const WCHAR *delimiter,
                           DWORD_PTR cookie, unsigned start_line, DWORD flags, class_desc_t **ret)
 {
@@ -2026,8 +2283,9 @@ HRESULT compile_procedure(script_ctx_t *script, const WCHAR *src, const WCHAR *i
     vbscode_t *code;
     HRESULT hres;
 
-    hres = compile_script(script, src, item_name, delimiter, cookie, start_line,
-                          flags & ~SCRIPTTEXT_ISPERSISTENT, &code);
+    /* The procedure descriptor is allocated from the code, so it's not cached. */
+    hres = compile_code(script, src, item_name, delimiter, cookie, start_line,
+                        flags & ~SCRIPTTEXT_ISPERSISTENT, FALSE, &code);
     if(FAILED(hres))
         return hres;
 
@@ -58,15 +58,33 @@ typedef struct regexp_t {
     struct RECharSet    *classList;    /* list of [...] bitmaps */
     const WCHAR         *source;       /* locked source string, sans // */
     DWORD               source_len;
+    LONG                ref;
+
+    /* Match start prefilter, see init_prefilter() */
+    BOOL                bol_anchor;    /* matches only at line beginnings */
+    BOOL                has_first_chars;
+    BOOL                first_high;    /* chars >= 256 may start a match */
+    BYTE                first_chars[32]; /* bitmap of chars < 256 that may start a match */
+    WCHAR               *literal;      /* literal present in every match */
+    DWORD               literal_len;
+    BOOL                literal_prefix; /* every match starts with the literal */
+    BYTE                literal_shift[256];
+
     jsbytecode          program[1];    /* regular expression bytecode */
 } regexp_t;
 
 regexp_t* regexp_new(void*, heap_pool_t*, const WCHAR*, DWORD, WORD, BOOL) DECLSPEC_HIDDEN;
-void regexp_destroy(regexp_t*) DECLSPEC_HIDDEN;
+void regexp_release(regexp_t*) DECLSPEC_HIDDEN;
 HRESULT regexp_execute(regexp_t*, void*, heap_pool_t*, const WCHAR*,
         DWORD, match_state_t*) DECLSPEC_HIDDEN;
 HRESULT regexp_set_flags(regexp_t**, void*, heap_pool_t*, WORD) DECLSPEC_HIDDEN;
 
+static inline regexp_t *regexp_addref(regexp_t *re)
+{
+    re->ref++;
+    return re;
+}
+
 static inline match_state_t* alloc_match_state(regexp_t *regexp,
         heap_pool_t *pool, const WCHAR *pos)
 {
@@ -2863,6 +2863,94 @@ static void test_multiple_parse(void)
     close_script(script);
 }
 
+/* Compiled code may be reused by later engines, but per-parse state must not leak between them. */
+static void test_code_cache(void)
+{
+    IActiveScriptParse *parser;
+    IActiveScriptError *error;
+    IActiveScript *engine;
+    DWORD source_context;
+    ULONG line_number;
+    unsigned i;
+    HRESULT hres;
+    VARIANT var;
+
+    for(i = 0; i < 2; i++) {
+        if(!(engine = create_and_init_script(0, FALSE)))
+            return;
+
+        hres = IActiveScript_QueryInterface(engine, &IID_IActiveScriptParse, (void**)&parser);
+        ok(hres == S_OK, "Could not get IActiveScriptParse: %08x\n", hres);
+
+        hres = IActiveScriptParse_ParseScriptText(parser, L"class CacheTestBase\nend class\n",
+                                                  NULL, NULL, NULL, 0, 0, 0, NULL, NULL);
+        ok(hres == S_OK, "[%u] ParseScriptText failed: %08x\n", i, hres);
+
+        /* persistent only in the second engine */
+        hres = IActiveScriptParse_ParseScriptText(parser,
+                                                  L"class CacheTestClass\n"
+                                                  L"    public value\n"
+                                                  L"end class\n"
+                                                  L"dim cache_test\n"
+                                                  L"set cache_test = new CacheTestClass\n"
+                                                  L"cache_test.value = 1\n",
+                                                  NULL, NULL, NULL, 0, 0, i ? SCRIPTTEXT_ISPERSISTENT : 0, NULL, NULL);
+        ok(hres == S_OK, "[%u] ParseScriptText failed: %08x\n", i, hres);
+
+        hres = IActiveScript_SetScriptState(engine, SCRIPTSTATE_STARTED);
+        ok(hres == S_OK, "SetScriptState(SCRIPTSTATE_STARTED) failed: %08x\n", hres);
+
+        /* classes are registered with this engine */
+        hres = IActiveScriptParse_ParseScriptText(parser, L"typename(new CacheTestBase) & typename(cache_test)",
+                                                  NULL, NULL, NULL, 0, 0, SCRIPTTEXT_ISEXPRESSION, &var, NULL);
+        ok(hres == S_OK, "[%u] ParseScriptText failed: %08x\n", i, hres);
+        ok(V_VT(&var) == VT_BSTR, "[%u] Expected VT_BSTR, got %s\n", i, vt2a(&var));
+        if(V_VT(&var) == VT_BSTR)
+            ok(!wcscmp(V_BSTR(&var), L"CacheTestBaseCacheTestClass"), "[%u] got %s\n", i, wine_dbgstr_w(V_BSTR(&var)));
+        VariantClear(&var);
+
+        /* errors are reported with the source context and starting line of this parse */
+        error = NULL;
+        store_script_error = &error;
+        SET_EXPECT(OnScriptError);
+        hres = IActiveScriptParse_ParseScriptText(parser, L"x = 1\nerr.raise 5\n",
+                                                  NULL, NULL, NULL, 10 + i, 3 * i, 0, NULL, NULL);
+        ok(hres == MAKE_VBSERROR(5), "[%u] ParseScriptText returned: %08x\n", i, hres);
+        CHECK_CALLED(OnScriptError);
+
+        if(error) {
+            source_context = 0xdeadbeef;
+            line_number = 0xdeadbeef;
+            hres = IActiveScriptError_GetSourcePosition(error, &source_context, &line_number, NULL);
+            ok(hres == S_OK, "GetSourcePosition failed: %08x\n", hres);
+            ok(source_context == 10 + i, "[%u] source_context = %x\n", i, source_context);
+            ok(line_number == 3 * i + 1, "[%u] line = %u\n", i, line_number);
+            IActiveScriptError_Release(error);
+        }
+
+        /* only persistent code runs again, registering its class again */
+        hres = IActiveScript_SetScriptState(engine, SCRIPTSTATE_UNINITIALIZED);
+        ok(hres == S_OK, "SetScriptState(SCRIPTSTATE_UNINITIALIZED) failed: %08x\n", hres);
+
+        hres = IActiveScript_SetScriptSite(engine, &ActiveScriptSite);
+        ok(hres == S_OK, "SetScriptSite failed: %08x\n", hres);
+
+        hres = IActiveScript_SetScriptState(engine, SCRIPTSTATE_STARTED);
+        ok(hres == S_OK, "SetScriptState(SCRIPTSTATE_STARTED) failed: %08x\n", hres);
+
+        hres = IActiveScriptParse_ParseScriptText(parser, L"typename(cache_test)",
+                                                  NULL, NULL, NULL, 0, 0, SCRIPTTEXT_ISEXPRESSION, &var, NULL);
+        ok(hres == S_OK, "[%u] ParseScriptText failed: %08x\n", i, hres);
+        ok(V_VT(&var) == VT_BSTR, "[%u] Expected VT_BSTR, got %s\n", i, vt2a(&var));
+        if(V_VT(&var) == VT_BSTR)
+            ok(!wcscmp(V_BSTR(&var), i ? L"CacheTestClass" : L"Empty"), "[%u] got %s\n", i, wine_dbgstr_w(V_BSTR(&var)));
+        VariantClear(&var);
+
+        IActiveScriptParse_Release(parser);
+        close_script(engine);
+    }
+}
+
 static BSTR get_script_from_file(const char *filename)
 {
     DWORD size, len;
@@ -3217,6 +3305,52 @@ static void run_tests(void)
     test_parse_context();
     test_callbacks();
     test_multiple_parse();
+    test_code_cache();
+}
+
+static void run_benchmarks(void)
+{
+    static const unsigned global_cnt = 2000;
+    LARGE_INTEGER freq, start, end;
+    char *src, *ptr;
+    unsigned i;
+    BSTR str;
+    HRESULT hres;
+
+    trace("Running benchmarks...\n");
+
+    /* Many globals, with the ones used in the loop declared last. */
+    src = HeapAlloc(GetProcessHeap(), 0, global_cnt * 32 + 1024);
+    ptr = src;
+    for(i = 0; i < global_cnt; i++)
+        ptr += sprintf(ptr, "Dim gvar%u\n", i);
+    strcpy(ptr, "Function bench(n)\n"
+                "    Dim i, sum\n"
+                "    sum = 0\n"
+                "    For i = 1 To n\n"
+                "        gvar1999 = gvar1999 + i\n"
+                "        gvar1998 = gvar1998 + 1\n"
+                "        sum = sum + i\n"
+                "    Next\n"
+                "    bench = sum\n"
+                "End Function\n"
+                "Call ok(bench(200000) = 20000100000, \"bench(200000) = \" & bench(200000))\n"
+                "Call ok(gvar1999 = 40000200000, \"gvar1999 = \" & gvar1999)\n"
+                "Call ok(gvar1998 = 400000, \"gvar1998 = \" & gvar1998)\n");
+
+    str = a2bstr(src);
+    HeapFree(GetProcessHeap(), 0, src);
+
+    strict_dispid_check = FALSE;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    hres = parse_script(SCRIPTITEM_GLOBALMEMBERS, str, NULL);
+    QueryPerformanceCounter(&end);
+    ok(hres == S_OK, "parse_script failed: %08x\n", hres);
+    SysFreeString(str);
+
+    trace("globals benchmark ran in %u ms\n",
+          (unsigned)((end.QuadPart - start.QuadPart) * 1000 / freq.QuadPart));
 }
 
 static BOOL check_vbscript(void)
@@ -3261,6 +3395,9 @@ START_TEST(run)
         run_from_file(argv[2]);
     }else {
         run_tests();
+
+        if(winetest_interactive)
+            run_benchmarks();
     }
 
     CoUninitialize();
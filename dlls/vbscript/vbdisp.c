@@ -1255,7 +1255,9 @@ static ULONG WINAPI ScriptDisp_Release(IDispatchEx *iface)
 
         heap_pool_free(&This->heap);
         heap_free(This->global_vars);
+        heap_free(This->global_vars_map.entries);
         heap_free(This->global_funcs);
+        heap_free(This->global_funcs_map.entries);
         heap_free(This);
     }
 
@@ -1362,18 +1364,14 @@ static HRESULT WINAPI ScriptDisp_GetDispID(IDispatchEx *iface, BSTR bstrName, DW
     if(!This->ctx)
         return E_UNEXPECTED;
 
-    for(i = 0; i < This->global_vars_cnt; i++) {
-        if(!wcsicmp(This->global_vars[i]->name, bstrName)) {
-            *pid = i + 1;
-            return S_OK;
-        }
+    if(find_global_var(This, bstrName, &i)) {
+        *pid = i + 1;
+        return S_OK;
     }
 
-    for(i = 0; i < This->global_funcs_cnt; i++) {
-        if(!wcsicmp(This->global_funcs[i]->name, bstrName)) {
-            *pid = i + 1 + DISPID_FUNCTION_MASK;
-            return S_OK;
-        }
+    if(find_global_func(This, bstrName, &i)) {
+        *pid = i + 1 + DISPID_FUNCTION_MASK;
+        return S_OK;
     }
 
     *pid = -1;
@@ -1500,6 +1498,155 @@ HRESULT create_script_disp(script_ctx_t *ctx, ScriptDisp **ret)
     return S_OK;
 }
 
+static unsigned ident_hash(const WCHAR *name)
+{
+    unsigned h = 0;
+
+    for(; *name; name++)
+        h = h * 31 + towlower(*name);
+    return h;
+}
+
+static const WCHAR *get_map_name(ScriptDisp *obj, ident_map_t *map, unsigned idx)
+{
+    return map == &obj->global_funcs_map ? obj->global_funcs[idx]->name : obj->global_vars[idx]->name;
+}
+
+/* Returns the entry of the name, or the free entry where it should be inserted. */
+static ident_map_entry_t *find_map_entry(ScriptDisp *obj, ident_map_t *map, const WCHAR *name, unsigned hash)
+{
+    unsigned i, mask = map->size - 1;
+
+    for(i = hash & mask; map->entries[i].idx; i = (i + 1) & mask) {
+        if(map->entries[i].hash == hash && !wcsicmp(get_map_name(obj, map, map->entries[i].idx - 1), name))
+            break;
+    }
+
+    return map->entries + i;
+}
+
+static BOOL lookup_map(ScriptDisp *obj, ident_map_t *map, const WCHAR *name, unsigned *ret)
+{
+    ident_map_entry_t *entry;
+
+    if(!map->cnt)
+        return FALSE;
+
+    entry = find_map_entry(obj, map, name, ident_hash(name));
+    if(!entry->idx)
+        return FALSE;
+
+    *ret = entry->idx - 1;
+    return TRUE;
+}
+
+static HRESULT add_to_map(ScriptDisp *obj, ident_map_t *map, unsigned idx)
+{
+    const WCHAR *name = get_map_name(obj, map, idx);
+    unsigned hash = ident_hash(name);
+    ident_map_entry_t *entry;
+
+    if((map->cnt + 1) * 2 > map->size) {
+        unsigned i, j, new_size = map->size ? map->size * 2 : 32;
+        ident_map_entry_t *new_entries;
+
+        new_entries = heap_alloc_zero(new_size * sizeof(*new_entries));
+        if(!new_entries)
+            return E_OUTOFMEMORY;
+
+        for(i = 0; i < map->size; i++) {
+            if(!map->entries[i].idx)
+                continue;
+            for(j = map->entries[i].hash & (new_size - 1); new_entries[j].idx; j = (j + 1) & (new_size - 1));
+            new_entries[j] = map->entries[i];
+        }
+
+        heap_free(map->entries);
+        map->entries = new_entries;
+        map->size = new_size;
+    }
+
+    /* The first definition of a name wins, like in a linear search. */
+    entry = find_map_entry(obj, map, name, hash);
+    if(!entry->idx) {
+        entry->hash = hash;
+        entry->idx = idx + 1;
+        map->cnt++;
+    }
+    return S_OK;
+}
+
+BOOL find_global_var(ScriptDisp *obj, const WCHAR *name, unsigned *ret)
+{
+    return lookup_map(obj, &obj->global_vars_map, name, ret);
+}
+
+BOOL find_global_func(ScriptDisp *obj, const WCHAR *name, unsigned *ret)
+{
+    return lookup_map(obj, &obj->global_funcs_map, name, ret);
+}
+
+HRESULT add_global_var(ScriptDisp *obj, dynamic_var_t *var)
+{
+    HRESULT hres;
+
+    if(obj->global_vars_cnt == obj->global_vars_size) {
+        size_t new_size = obj->global_vars_size ? obj->global_vars_size * 2 : 16;
+        dynamic_var_t **new_vars;
+
+        if(obj->global_vars)
+            new_vars = heap_realloc(obj->global_vars, new_size * sizeof(*new_vars));
+        else
+            new_vars = heap_alloc(new_size * sizeof(*new_vars));
+        if(!new_vars)
+            return E_OUTOFMEMORY;
+        obj->global_vars = new_vars;
+        obj->global_vars_size = new_size;
+    }
+
+    obj->global_vars[obj->global_vars_cnt] = var;
+    hres = add_to_map(obj, &obj->global_vars_map, obj->global_vars_cnt);
+    if(FAILED(hres))
+        return hres;
+
+    obj->global_vars_cnt++;
+    return S_OK;
+}
+
+HRESULT add_global_func(ScriptDisp *obj, function_t *func)
+{
+    unsigned i;
+    HRESULT hres;
+
+    if(find_global_func(obj, func->name, &i)) {
+        /* global function already exists, replace it */
+        obj->global_funcs[i] = func;
+        return S_OK;
+    }
+
+    if(obj->global_funcs_cnt == obj->global_funcs_size) {
+        size_t new_size = obj->global_funcs_size ? obj->global_funcs_size * 2 : 16;
+        function_t **new_funcs;
+
+        if(obj->global_funcs)
+            new_funcs = heap_realloc(obj->global_funcs, new_size * sizeof(*new_funcs));
+        else
+            new_funcs = heap_alloc(new_size * sizeof(*new_funcs));
+        if(!new_funcs)
+            return E_OUTOFMEMORY;
+        obj->global_funcs = new_funcs;
+        obj->global_funcs_size = new_size;
+    }
+
+    obj->global_funcs[obj->global_funcs_cnt] = func;
+    hres = add_to_map(obj, &obj->global_funcs_map, obj->global_funcs_cnt);
+    if(FAILED(hres))
+        return hres;
+
+    obj->global_funcs_cnt++;
+    return S_OK;
+}
+
 void collect_objects(script_ctx_t *ctx)
 {
     vbdisp_t *iter, *iter2;
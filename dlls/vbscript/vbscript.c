@@ -94,9 +94,9 @@ static inline BOOL is_started(VBScript *This)
 static HRESULT exec_global_code(script_ctx_t *ctx, vbscode_t *code, VARIANT *res)
 {
     ScriptDisp *obj = ctx->script_obj;
-    function_t *func_iter, **new_funcs;
-    dynamic_var_t *var, **new_vars;
-    size_t cnt, i;
+    function_t *func_iter;
+    dynamic_var_t *var;
+    size_t i;
     HRESULT hres;
 
     if(code->named_item) {
@@ -107,34 +107,6 @@ static HRESULT exec_global_code(script_ctx_t *ctx, vbscode_t *code, VARIANT *res
         obj = code->named_item->script_obj;
     }
 
-    cnt = obj->global_vars_cnt + code->main_code.var_cnt;
-    if (cnt > obj->global_vars_size)
-    {
-        if (obj->global_vars)
-            new_vars = heap_realloc(obj->global_vars, cnt * sizeof(*new_vars));
-        else
-            new_vars = heap_alloc(cnt * sizeof(*new_vars));
-        if (!new_vars)
-            return E_OUTOFMEMORY;
-        obj->global_vars = new_vars;
-        obj->global_vars_size = cnt;
-    }
-
-    cnt = obj->global_funcs_cnt;
-    for (func_iter = code->funcs; func_iter; func_iter = func_iter->next)
-        cnt++;
-    if (cnt > obj->global_funcs_size)
-    {
-        if (obj->global_funcs)
-            new_funcs = heap_realloc(obj->global_funcs, cnt * sizeof(*new_funcs));
-        else
-            new_funcs = heap_alloc(cnt * sizeof(*new_funcs));
-        if (!new_funcs)
-            return E_OUTOFMEMORY;
-        obj->global_funcs = new_funcs;
-        obj->global_funcs_size = cnt;
-    }
-
     for (i = 0; i < code->main_code.var_cnt; i++)
     {
         if (!(var = heap_pool_alloc(&obj->heap, sizeof(*var))))
@@ -147,24 +119,16 @@ static HRESULT exec_global_code(script_ctx_t *ctx, vbscode_t *code, VARIANT *res
         var->is_const = FALSE;
         var->array = NULL;
 
-        obj->global_vars[obj->global_vars_cnt + i] = var;
+        hres = add_global_var(obj, var);
+        if (FAILED(hres))
+            return hres;
     }
 
-    obj->global_vars_cnt += code->main_code.var_cnt;
-
     for (func_iter = code->funcs; func_iter; func_iter = func_iter->next)
     {
-        for (i = 0; i < obj->global_funcs_cnt; i++)
-        {
-            if (!wcsicmp(obj->global_funcs[i]->name, func_iter->name))
-            {
-                /* global function already exists, replace it */
-                obj->global_funcs[i] = func_iter;
-                break;
-            }
-        }
-        if (i == obj->global_funcs_cnt)
-            obj->global_funcs[obj->global_funcs_cnt++] = func_iter;
+        hres = add_global_func(obj, func_iter);
+        if (FAILED(hres))
+            return hres;
     }
 
     if (code->classes)
@@ -437,6 +437,125 @@ static void test_private_data(VkPhysicalDevice vk_physical_device)
     vkDestroyDevice(vk_device, NULL);
 }
 
+static void test_conversion_performance(VkPhysicalDevice vk_physical_device)
+{
+    static const unsigned int iteration_count = 10000;
+    VkBufferMemoryBarrier buffer_barriers[16];
+    VkCommandBufferAllocateInfo allocate_info;
+    VkCommandBufferInheritanceInfo inheritance;
+    VkMemoryRequirements memory_requirements;
+    VkCommandBufferBeginInfo begin_info;
+    LARGE_INTEGER start, end, freq;
+    VkMemoryAllocateInfo memory_info;
+    VkCommandPoolCreateInfo pool_info;
+    VkBufferCreateInfo buffer_info;
+    VkCommandBuffer vk_cmd_buffer;
+    uint32_t queue_family_index;
+    VkDeviceMemory vk_memory;
+    VkCommandPool vk_cmd_pool;
+    VkDevice vk_device;
+    VkBuffer vk_buffer;
+    unsigned int i;
+    VkResult vr;
+
+    if ((vr = create_device(vk_physical_device, 0, NULL, NULL, &vk_device)) < 0)
+    {
+        skip("Failed to create device, vr %d.\n", vr);
+        return;
+    }
+
+    find_queue_family(vk_physical_device, VK_QUEUE_GRAPHICS_BIT, &queue_family_index);
+
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.pNext = NULL;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = queue_family_index;
+    vr = vkCreateCommandPool(vk_device, &pool_info, NULL, &vk_cmd_pool);
+    ok(vr == VK_SUCCESS, "Got unexpected VkResult %d.\n", vr);
+
+    allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocate_info.pNext = NULL;
+    allocate_info.commandPool = vk_cmd_pool;
+    allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount = 1;
+    vr = vkAllocateCommandBuffers(vk_device, &allocate_info, &vk_cmd_buffer);
+    ok(vr == VK_SUCCESS, "Got unexpected VkResult %d.\n", vr);
+
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.pNext = NULL;
+    buffer_info.flags = 0;
+    buffer_info.size = 0x1000;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    buffer_info.queueFamilyIndexCount = 0;
+    buffer_info.pQueueFamilyIndices = NULL;
+    vr = vkCreateBuffer(vk_device, &buffer_info, NULL, &vk_buffer);
+    ok(vr == VK_SUCCESS, "Got unexpected VkResult %d.\n", vr);
+
+    vkGetBufferMemoryRequirements(vk_device, vk_buffer, &memory_requirements);
+    memory_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memory_info.pNext = NULL;
+    memory_info.allocationSize = memory_requirements.size;
+    for (memory_info.memoryTypeIndex = 0; memory_info.memoryTypeIndex < 32; ++memory_info.memoryTypeIndex)
+    {
+        if (memory_requirements.memoryTypeBits & (1u << memory_info.memoryTypeIndex))
+            break;
+    }
+    vr = vkAllocateMemory(vk_device, &memory_info, NULL, &vk_memory);
+    ok(vr == VK_SUCCESS, "Got unexpected VkResult %d.\n", vr);
+    vr = vkBindBufferMemory(vk_device, vk_buffer, vk_memory, 0);
+    ok(vr == VK_SUCCESS, "Got unexpected VkResult %d.\n", vr);
+
+    for (i = 0; i < ARRAY_SIZE(buffer_barriers); ++i)
+    {
+        buffer_barriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        buffer_barriers[i].pNext = NULL;
+        buffer_barriers[i].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        buffer_barriers[i].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        buffer_barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        buffer_barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        buffer_barriers[i].buffer = vk_buffer;
+        buffer_barriers[i].offset = i * 0x100;
+        buffer_barriers[i].size = 0x100;
+    }
+
+    inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.pNext = NULL;
+    inheritance.renderPass = VK_NULL_HANDLE;
+    inheritance.subpass = 0;
+    inheritance.framebuffer = VK_NULL_HANDLE;
+    inheritance.occlusionQueryEnable = VK_FALSE;
+    inheritance.queryFlags = 0;
+    inheritance.pipelineStatistics = 0;
+
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.pNext = NULL;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    begin_info.pInheritanceInfo = &inheritance;
+
+    /* On 32-bit, both calls go through structure conversion in the thunks. */
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    for (i = 0; i < iteration_count; ++i)
+    {
+        vr = vkBeginCommandBuffer(vk_cmd_buffer, &begin_info);
+        ok(vr == VK_SUCCESS, "Got unexpected VkResult %d.\n", vr);
+        vkCmdPipelineBarrier(vk_cmd_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0, 0, NULL, ARRAY_SIZE(buffer_barriers), buffer_barriers, 0, NULL);
+        vr = vkEndCommandBuffer(vk_cmd_buffer);
+        ok(vr == VK_SUCCESS, "Got unexpected VkResult %d.\n", vr);
+    }
+    QueryPerformanceCounter(&end);
+    if (winetest_debug > 1)
+        trace("%u command buffers with %u buffer barriers each took %.2f ms.\n", iteration_count,
+                (unsigned int)ARRAY_SIZE(buffer_barriers), (end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart);
+
+    vkDestroyBuffer(vk_device, vk_buffer, NULL);
+    vkFreeMemory(vk_device, vk_memory, NULL);
+    vkDestroyCommandPool(vk_device, vk_cmd_pool, NULL);
+    vkDestroyDevice(vk_device, NULL);
+}
+
 static void for_each_device(void (*test_func)(VkPhysicalDevice))
 {
     VkPhysicalDevice *vk_physical_devices;
@@ -481,4 +600,5 @@ START_TEST(vulkan)
     test_unsupported_instance_extensions();
     for_each_device(test_unsupported_device_extensions);
     for_each_device(test_private_data);
+    for_each_device(test_conversion_performance);
 }
@@ -36,6 +36,7 @@
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
 struct FormatConverter;
+struct conversion_kernel;
 
 enum pixelformat {
     format_1bppIndexed,
@@ -81,6 +82,7 @@ typedef struct FormatConverter {
     WICBitmapDitherType dither;
     double alpha_threshold;
     IWICPalette *palette;
+    const struct conversion_kernel *kernel;
     CRITICAL_SECTION lock; /* must be held when initialized */
 } FormatConverter;
 
@@ -91,6 +93,61 @@ static inline float to_sRGB_component(float f)
     return 1.055f * powf(f, 1.0f/2.4f) - 0.055f;
 }
 
+static inline BYTE to_sRGB_byte_slow(float f)
+{
+    return (BYTE)floorf(to_sRGB_component(f) * 255.0f + 0.51f);
+}
+
+/* srgb_thresholds[k] is the smallest value in [0, 1] that converts to k or
+ * more, srgb_buckets[] holds the conversion of the start of each of
+ * SRGB_BUCKETS equal intervals, so only a threshold or two needs to be
+ * checked per value. Both are derived from to_sRGB_byte_slow(), which
+ * keeps the results identical to it. */
+#define SRGB_BUCKETS 4096
+static float srgb_thresholds[256];
+static BYTE srgb_buckets[SRGB_BUCKETS + 1];
+static INIT_ONCE srgb_init_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL WINAPI init_srgb_tables(INIT_ONCE *once, void *param, void **context)
+{
+    union { DWORD i; float f; } lo, hi, mid;
+    UINT i, k;
+
+    for (k = 1; k < 256; k++)
+    {
+        /* non-negative floats are ordered like their bit patterns */
+        lo.f = 0.0f;
+        hi.f = 1.0f;
+        while (lo.i < hi.i)
+        {
+            mid.i = lo.i + (hi.i - lo.i) / 2;
+            if (to_sRGB_byte_slow(mid.f) >= k) hi.i = mid.i;
+            else lo.i = mid.i + 1;
+        }
+        srgb_thresholds[k] = lo.f;
+    }
+
+    for (i = 0, k = 0; i <= SRGB_BUCKETS; i++)
+    {
+        float f = (float)i / SRGB_BUCKETS;
+        while (k < 255 && f >= srgb_thresholds[k + 1]) k++;
+        srgb_buckets[i] = k;
+    }
+
+    return TRUE;
+}
+
+static inline BYTE to_sRGB_byte(float f)
+{
+    UINT k;
+
+    if (!(f >= 0.0f && f <= 1.0f)) return to_sRGB_byte_slow(f);
+
+    k = srgb_buckets[(UINT)(f * SRGB_BUCKETS)];
+    while (k < 255 && f >= srgb_thresholds[k + 1]) k++;
+    return k;
+}
+
 #if 0 /* FIXME: enable once needed */
 static inline float from_sRGB_component(float f)
 {
@@ -1122,6 +1179,8 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
                 INT x, y;
                 BYTE *src = srcdata, *dst = pbBuffer;
 
+                InitOnceExecuteOnce(&srgb_init_once, init_srgb_tables, NULL, NULL);
+
                 for (y = 0; y < prc->Height; y++)
                 {
                     float *gray_float = (float *)src;
@@ -1129,7 +1188,7 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
 
                     for (x = 0; x < prc->Width; x++)
                     {
-                        BYTE gray = (BYTE)floorf(to_sRGB_component(gray_float[x]) * 255.0f + 0.51f);
+                        BYTE gray = to_sRGB_byte(gray_float[x]);
                         *bgr++ = gray;
                         *bgr++ = gray;
                         *bgr++ = gray;
@@ -1342,13 +1401,15 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
                 INT x, y;
                 BYTE *src = srcdata, *dst = pbBuffer;
 
+                InitOnceExecuteOnce(&srgb_init_once, init_srgb_tables, NULL, NULL);
+
                 for (y=0; y < prc->Height; y++)
                 {
                     float *srcpixel = (float*)src;
                     BYTE *dstpixel = dst;
 
                     for (x=0; x < prc->Width; x++)
-                        *dstpixel++ = (BYTE)floorf(to_sRGB_component(*srcpixel++) * 255.0f + 0.51f);
+                        *dstpixel++ = to_sRGB_byte(*srcpixel++);
 
                     src += srcstride;
                     dst += cbStride;
@@ -1376,6 +1437,8 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
         INT x, y;
         BYTE *src = srcdata, *dst = pbBuffer;
 
+        InitOnceExecuteOnce(&srgb_init_once, init_srgb_tables, NULL, NULL);
+
         for (y = 0; y < prc->Height; y++)
         {
             BYTE *bgr = src;
@@ -1384,8 +1447,7 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
             {
                 float gray = (bgr[2] * 0.2126f + bgr[1] * 0.7152f + bgr[0] * 0.0722f) / 255.0f;
 
-                gray = to_sRGB_component(gray) * 255.0f;
-                dst[x] = (BYTE)floorf(gray + 0.51f);
+                dst[x] = to_sRGB_byte(gray);
                 bgr += 3;
             }
             src += srcstride;
@@ -1484,6 +1546,266 @@ static HRESULT copypixels_to_8bppIndexed(struct FormatConverter *This, const WIC
     return hr;
 }
 
+/* Row kernels for the most common conversions. They produce the same
+ * results as the generic paths above, but work a pixel or several pixels
+ * at a time on whole words. src and dst may point to the same row when both
+ * formats have the same pixel size. Rows are only byte aligned, so words are
+ * accessed with load_dword() and store_dword(). */
+typedef void (*convert_row_func)(const BYTE *src, BYTE *dst, UINT width);
+
+struct conversion_kernel
+{
+    enum pixelformat src_format;
+    enum pixelformat dst_format;
+    UINT src_bpp, dst_bpp; /* bytes per pixel */
+    convert_row_func convert_row;
+};
+
+static inline DWORD load_dword(const BYTE *ptr)
+{
+    DWORD value;
+
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static inline void store_dword(BYTE *ptr, DWORD value)
+{
+    memcpy(ptr, &value, sizeof(value));
+}
+
+/* BGR -> BGRA or RGB -> RGBA, alpha set to 255 */
+static void convert_row_24_to_32(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x + 4 <= width; x += 4)
+    {
+        DWORD s0 = load_dword(src), s1 = load_dword(src + 4), s2 = load_dword(src + 8);
+
+        store_dword(dst, 0xff000000 | s0);
+        store_dword(dst + 4, 0xff000000 | s0 >> 24 | s1 << 8);
+        store_dword(dst + 8, 0xff000000 | s1 >> 16 | s2 << 16);
+        store_dword(dst + 12, 0xff000000 | s2 >> 8);
+        src += 12;
+        dst += 16;
+    }
+
+    for (; x < width; x++, src += 3, dst += 4)
+        store_dword(dst, 0xff000000 | src[2] << 16 | src[1] << 8 | src[0]);
+}
+
+/* RGB -> BGRA or BGR -> RGBA, alpha set to 255 */
+static void convert_row_24_to_32_swap(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 3, dst += 4)
+        store_dword(dst, 0xff000000 | src[0] << 16 | src[1] << 8 | src[2]);
+}
+
+/* BGRA -> BGR or RGBA -> RGB */
+static void convert_row_32_to_24(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x + 4 <= width; x += 4)
+    {
+        DWORD s0 = load_dword(src), s1 = load_dword(src + 4);
+        DWORD s2 = load_dword(src + 8), s3 = load_dword(src + 12);
+
+        store_dword(dst, (s0 & 0xffffff) | s1 << 24);
+        store_dword(dst + 4, (s1 >> 8 & 0xffff) | s2 << 16);
+        store_dword(dst + 8, (s2 >> 16 & 0xff) | s3 << 8);
+        src += 16;
+        dst += 12;
+    }
+
+    for (; x < width; x++, src += 4, dst += 3)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+    }
+}
+
+/* BGRA -> RGB or RGBA -> BGR */
+static void convert_row_32_to_24_swap(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 3)
+    {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+    }
+}
+
+static void convert_row_set_alpha(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 4)
+        store_dword(dst, load_dword(src) | 0xff000000);
+}
+
+static void convert_row_swap(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 4)
+    {
+        DWORD pixel = load_dword(src);
+        store_dword(dst, (pixel & 0xff00ff00) | (pixel >> 16 & 0xff) | (pixel & 0xff) << 16);
+    }
+}
+
+static void convert_row_swap_set_alpha(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 4)
+    {
+        DWORD pixel = load_dword(src);
+        store_dword(dst, 0xff000000 | (pixel & 0x0000ff00) | (pixel >> 16 & 0xff) | (pixel & 0xff) << 16);
+    }
+}
+
+static void convert_row_premultiply(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 4)
+    {
+        DWORD pixel = load_dword(src), alpha = pixel >> 24, rb, g;
+
+        if (alpha != 255)
+        {
+            /* v / 255 == (v + (v >> 8) + 1) >> 8 for v <= 255 * 255, which
+             * lets the two outer channels share one multiplication */
+            rb = (pixel & 0x00ff00ff) * alpha;
+            rb = ((rb + (rb >> 8 & 0x00ff00ff) + 0x00010001) >> 8) & 0x00ff00ff;
+            g = (pixel >> 8 & 0xff) * alpha;
+            g = (g + (g >> 8) + 1) >> 8;
+            pixel = (pixel & 0xff000000) | rb | g << 8;
+        }
+        store_dword(dst, pixel);
+    }
+}
+
+static void convert_row_unpremultiply(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x, alpha, last_alpha = 0, factor = 0;
+
+    for (x = 0; x < width; x++, src += 4, dst += 4)
+    {
+        alpha = src[3];
+        if (alpha != 0 && alpha != 255)
+        {
+            /* (v * factor) >> 16 == v * 255 / alpha for all v <= 255 */
+            if (alpha != last_alpha)
+            {
+                factor = (255 * 65536 + alpha - 1) / alpha;
+                last_alpha = alpha;
+            }
+            dst[0] = (src[0] * factor) >> 16;
+            dst[1] = (src[1] * factor) >> 16;
+            dst[2] = (src[2] * factor) >> 16;
+        }
+        else
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+        dst[3] = alpha;
+    }
+}
+
+static const struct conversion_kernel conversion_kernels[] =
+{
+    {format_24bppBGR, format_32bppBGRA, 3, 4, convert_row_24_to_32},
+    {format_24bppBGR, format_32bppBGR, 3, 4, convert_row_24_to_32},
+    {format_24bppBGR, format_32bppPBGRA, 3, 4, convert_row_24_to_32},
+    {format_24bppBGR, format_32bppRGBA, 3, 4, convert_row_24_to_32_swap},
+    {format_24bppBGR, format_32bppRGB, 3, 4, convert_row_24_to_32_swap},
+    {format_24bppBGR, format_32bppPRGBA, 3, 4, convert_row_24_to_32_swap},
+    {format_24bppRGB, format_32bppRGBA, 3, 4, convert_row_24_to_32},
+    {format_24bppRGB, format_32bppRGB, 3, 4, convert_row_24_to_32},
+    {format_24bppRGB, format_32bppPRGBA, 3, 4, convert_row_24_to_32},
+    {format_24bppRGB, format_32bppBGRA, 3, 4, convert_row_24_to_32_swap},
+    {format_24bppRGB, format_32bppBGR, 3, 4, convert_row_24_to_32_swap},
+    {format_24bppRGB, format_32bppPBGRA, 3, 4, convert_row_24_to_32_swap},
+    {format_32bppBGR, format_24bppBGR, 4, 3, convert_row_32_to_24},
+    {format_32bppBGRA, format_24bppBGR, 4, 3, convert_row_32_to_24},
+    {format_32bppPBGRA, format_24bppBGR, 4, 3, convert_row_32_to_24},
+    {format_32bppRGBA, format_24bppBGR, 4, 3, convert_row_32_to_24_swap},
+    {format_32bppBGR, format_24bppRGB, 4, 3, convert_row_32_to_24_swap},
+    {format_32bppBGRA, format_24bppRGB, 4, 3, convert_row_32_to_24_swap},
+    {format_32bppPBGRA, format_24bppRGB, 4, 3, convert_row_32_to_24_swap},
+    {format_32bppBGR, format_32bppBGRA, 4, 4, convert_row_set_alpha},
+    {format_32bppBGR, format_32bppPBGRA, 4, 4, convert_row_set_alpha},
+    {format_32bppRGB, format_32bppRGBA, 4, 4, convert_row_set_alpha},
+    {format_32bppRGB, format_32bppPRGBA, 4, 4, convert_row_set_alpha},
+    {format_32bppBGRA, format_32bppRGBA, 4, 4, convert_row_swap},
+    {format_32bppBGRA, format_32bppRGB, 4, 4, convert_row_swap},
+    {format_32bppBGR, format_32bppRGBA, 4, 4, convert_row_swap_set_alpha},
+    {format_32bppBGR, format_32bppRGB, 4, 4, convert_row_swap_set_alpha},
+    {format_32bppBGRA, format_32bppPBGRA, 4, 4, convert_row_premultiply},
+    {format_32bppRGBA, format_32bppPRGBA, 4, 4, convert_row_premultiply},
+    {format_32bppPBGRA, format_32bppBGRA, 4, 4, convert_row_unpremultiply},
+    {format_32bppPRGBA, format_32bppRGBA, 4, 4, convert_row_unpremultiply},
+};
+
+static const struct conversion_kernel *find_conversion_kernel(enum pixelformat src, enum pixelformat dst)
+{
+    UINT i;
+
+    for (i = 0; i < ARRAY_SIZE(conversion_kernels); i++)
+        if (conversion_kernels[i].src_format == src && conversion_kernels[i].dst_format == dst)
+            return &conversion_kernels[i];
+
+    return NULL;
+}
+
+static HRESULT copypixels_with_kernel(struct FormatConverter *This, const WICRect *prc,
+    UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
+{
+    const struct conversion_kernel *kernel = This->kernel;
+    UINT srcstride, srcdatasize;
+    BYTE *srcdata, *src, *dst;
+    HRESULT hr;
+    INT y;
+
+    if (kernel->src_bpp == kernel->dst_bpp)
+    {
+        hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+        if (FAILED(hr)) return hr;
+
+        for (y = 0, dst = pbBuffer; y < prc->Height; y++, dst += cbStride)
+            kernel->convert_row(dst, dst, prc->Width);
+
+        return S_OK;
+    }
+
+    srcstride = kernel->src_bpp * prc->Width;
+    srcdatasize = srcstride * prc->Height;
+
+    srcdata = heap_alloc(srcdatasize);
+    if (!srcdata) return E_OUTOFMEMORY;
+
+    hr = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+    if (SUCCEEDED(hr))
+    {
+        for (y = 0, src = srcdata, dst = pbBuffer; y < prc->Height; y++, src += srcstride, dst += cbStride)
+            kernel->convert_row(src, dst, prc->Width);
+    }
+
+    heap_free(srcdata);
+    return hr;
+}
+
 static const struct pixelformatinfo supported_formats[] = {
     {format_1bppIndexed, &GUID_WICPixelFormat1bppIndexed, NULL},
     {format_2bppIndexed, &GUID_WICPixelFormat2bppIndexed, NULL},
@@ -1662,6 +1984,9 @@ static HRESULT WINAPI FormatConverter_CopyPixels(IWICFormatConverter *iface,
             prc = &rc;
         }
 
+        if (This->kernel)
+            return copypixels_with_kernel(This, prc, cbStride, cbBufferSize, pbBuffer);
+
         return This->dst_format->copy_function(This, prc, cbStride, cbBufferSize,
             pbBuffer, This->src_format->format);
     }
@@ -1755,6 +2080,7 @@ static HRESULT WINAPI FormatConverter_Initialize(IWICFormatConverter *iface,
         This->dither = dither;
         This->alpha_threshold = alpha_threshold;
         This->palette = palette;
+        This->kernel = find_conversion_kernel(srcinfo->format, dstinfo->format);
         This->source = source;
     }
     else
@@ -1838,6 +2164,7 @@ HRESULT FormatConverter_CreateInstance(REFIID iid, void** ppv)
     This->ref = 1;
     This->source = NULL;
     This->palette = NULL;
+    This->kernel = NULL;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": FormatConverter.lock");
 
@@ -68,6 +68,8 @@ static const WCHAR wszJpegYCrCbSubsampling[] = {'J','p','e','g','Y','C','r','C',
 static const WCHAR wszSuppressApp0[] = {'S','u','p','p','r','e','s','s','A','p','p','0',0};
 
 #define MAKE_FUNCPTR(f) static typeof(f) * p##f
+MAKE_FUNCPTR(jpeg_abort_decompress);
+MAKE_FUNCPTR(jpeg_calc_output_dimensions);
 MAKE_FUNCPTR(jpeg_CreateCompress);
 MAKE_FUNCPTR(jpeg_CreateDecompress);
 MAKE_FUNCPTR(jpeg_destroy_compress);
@@ -93,6 +95,8 @@ static void *load_libjpeg(void)
         return NULL; \
     }
 
+        LOAD_FUNCPTR(jpeg_abort_decompress);
+        LOAD_FUNCPTR(jpeg_calc_output_dimensions);
         LOAD_FUNCPTR(jpeg_CreateCompress);
         LOAD_FUNCPTR(jpeg_CreateDecompress);
         LOAD_FUNCPTR(jpeg_destroy_compress);
@@ -147,16 +151,22 @@ typedef struct {
     IWICBitmapDecoder IWICBitmapDecoder_iface;
     IWICBitmapFrameDecode IWICBitmapFrameDecode_iface;
     IWICMetadataBlockReader IWICMetadataBlockReader_iface;
+    IWICBitmapSourceTransform IWICBitmapSourceTransform_iface;
     LONG ref;
     BOOL initialized;
     BOOL cinfo_initialized;
+    BOOL header_ready; /* header has been read and decompression not started */
     IStream *stream;
+    ULARGE_INTEGER data_position; /* stream position after the header read by Initialize */
     struct jpeg_decompress_struct cinfo;
     struct jpeg_error_mgr jerr;
     struct jpeg_source_mgr source_mgr;
     BYTE source_buffer[1024];
+    UINT width, height;
     UINT bpp, stride;
-    BYTE *image_data;
+    BYTE *image_data; /* decoded on first use */
+    UINT scaled_denom, scaled_stride;
+    BYTE *scaled_data; /* last image decoded at a reduced size */
     CRITICAL_SECTION lock;
 } JpegDecoder;
 
@@ -180,6 +190,11 @@ static inline JpegDecoder *impl_from_IWICMetadataBlockReader(IWICMetadataBlockRe
     return CONTAINING_RECORD(iface, JpegDecoder, IWICMetadataBlockReader_iface);
 }
 
+static inline JpegDecoder *impl_from_IWICBitmapSourceTransform(IWICBitmapSourceTransform *iface)
+{
+    return CONTAINING_RECORD(iface, JpegDecoder, IWICBitmapSourceTransform_iface);
+}
+
 static HRESULT WINAPI JpegDecoder_QueryInterface(IWICBitmapDecoder *iface, REFIID iid,
     void **ppv)
 {
@@ -227,6 +242,7 @@ static ULONG WINAPI JpegDecoder_Release(IWICBitmapDecoder *iface)
         if (This->cinfo_initialized) pjpeg_destroy_decompress(&This->cinfo);
         if (This->stream) IStream_Release(This->stream);
         HeapFree(GetProcessHeap(), 0, This->image_data);
+        HeapFree(GetProcessHeap(), 0, This->scaled_data);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -297,6 +313,126 @@ static void source_mgr_term_source(j_decompress_ptr cinfo)
 {
 }
 
+static BOOL set_out_color_space(JpegDecoder *This)
+{
+    switch (This->cinfo.jpeg_color_space)
+    {
+    case JCS_GRAYSCALE:
+        This->cinfo.out_color_space = JCS_GRAYSCALE;
+        return TRUE;
+    case JCS_RGB:
+    case JCS_YCbCr:
+        This->cinfo.out_color_space = JCS_RGB;
+        return TRUE;
+    case JCS_CMYK:
+    case JCS_YCCK:
+        This->cinfo.out_color_space = JCS_CMYK;
+        return TRUE;
+    default:
+        ERR("Unknown JPEG color space %i\n", This->cinfo.jpeg_color_space);
+        return FALSE;
+    }
+}
+
+/* Decodes the image at 1/denom of its size. libjpeg does the scaling in the
+ * IDCT, which is much cheaper than decoding the full image. The stream is
+ * rewound when the header read by Initialize has already been consumed, and
+ * otherwise returned to where the header ended, since the caller may have
+ * used the stream in between. Must be called with the lock held. */
+static HRESULT jpeg_decode(JpegDecoder *This, UINT denom, BYTE **data, UINT *stride)
+{
+    BYTE * volatile image_data = NULL;
+    LARGE_INTEGER seek;
+    jmp_buf jmpbuf;
+    UINT data_size, i;
+    int ret;
+
+    This->cinfo.client_data = jmpbuf;
+
+    if (setjmp(jmpbuf))
+    {
+        heap_free(image_data);
+        This->header_ready = FALSE;
+        return E_FAIL;
+    }
+
+    if (This->header_ready)
+    {
+        seek.QuadPart = This->data_position.QuadPart;
+        IStream_Seek(This->stream, seek, STREAM_SEEK_SET, NULL);
+    }
+    else
+    {
+        pjpeg_abort_decompress(&This->cinfo);
+
+        seek.QuadPart = 0;
+        IStream_Seek(This->stream, seek, STREAM_SEEK_SET, NULL);
+        This->source_mgr.bytes_in_buffer = 0;
+
+        ret = pjpeg_read_header(&This->cinfo, TRUE);
+        if (ret != JPEG_HEADER_OK || !set_out_color_space(This))
+        {
+            WARN("failed to read jpeg header again, ret %d\n", ret);
+            return E_FAIL;
+        }
+    }
+    This->header_ready = FALSE;
+
+    This->cinfo.scale_num = 1;
+    This->cinfo.scale_denom = denom;
+
+    if (!pjpeg_start_decompress(&This->cinfo))
+    {
+        ERR("jpeg_start_decompress failed\n");
+        return E_FAIL;
+    }
+
+    *stride = (This->bpp * This->cinfo.output_width + 7) / 8;
+    data_size = *stride * This->cinfo.output_height;
+
+    image_data = heap_alloc(data_size);
+    if (!image_data)
+        return E_OUTOFMEMORY;
+
+    while (This->cinfo.output_scanline < This->cinfo.output_height)
+    {
+        UINT first_scanline = This->cinfo.output_scanline;
+        UINT max_rows;
+        JSAMPROW out_rows[4];
+        JDIMENSION ret;
+
+        max_rows = min(This->cinfo.output_height-first_scanline, 4);
+        for (i=0; i<max_rows; i++)
+            out_rows[i] = image_data + *stride * (first_scanline+i);
+
+        ret = pjpeg_read_scanlines(&This->cinfo, out_rows, max_rows);
+        if (ret == 0)
+        {
+            ERR("read_scanlines failed\n");
+            heap_free(image_data);
+            return E_FAIL;
+        }
+    }
+
+    if (This->bpp == 24)
+    {
+        /* libjpeg gives us RGB data and we want BGR, so byteswap the data */
+        reverse_bgr8(3, image_data,
+            This->cinfo.output_width, This->cinfo.output_height,
+            *stride);
+    }
+
+    if (This->cinfo.out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
+    {
+        /* Adobe JPEG's have inverted CMYK data. */
+        for (i=0; i<data_size; i++)
+            image_data[i] ^= 0xff;
+    }
+
+    *data = image_data;
+    return S_OK;
+}
+
 static HRESULT WINAPI JpegDecoder_Initialize(IWICBitmapDecoder *iface, IStream *pIStream,
     WICDecodeOptions cacheOptions)
 {
@@ -304,7 +440,6 @@ static HRESULT WINAPI JpegDecoder_Initialize(IWICBitmapDecoder *iface, IStream *
     int ret;
     LARGE_INTEGER seek;
     jmp_buf jmpbuf;
-    UINT data_size, i;
 
     TRACE("(%p,%p,%u)\n", iface, pIStream, cacheOptions);
 
@@ -358,80 +493,26 @@ static HRESULT WINAPI JpegDecoder_Initialize(IWICBitmapDecoder *iface, IStream *
         return E_FAIL;
     }
 
-    switch (This->cinfo.jpeg_color_space)
+    if (!set_out_color_space(This))
     {
-    case JCS_GRAYSCALE:
-        This->cinfo.out_color_space = JCS_GRAYSCALE;
-        break;
-    case JCS_RGB:
-    case JCS_YCbCr:
-        This->cinfo.out_color_space = JCS_RGB;
-        break;
-    case JCS_CMYK:
-    case JCS_YCCK:
-        This->cinfo.out_color_space = JCS_CMYK;
-        break;
-    default:
-        ERR("Unknown JPEG color space %i\n", This->cinfo.jpeg_color_space);
         LeaveCriticalSection(&This->lock);
         return E_FAIL;
     }
 
-    if (!pjpeg_start_decompress(&This->cinfo))
-    {
-        ERR("jpeg_start_decompress failed\n");
-        LeaveCriticalSection(&This->lock);
-        return E_FAIL;
-    }
+    /* The image is only decoded when its pixels are needed, possibly at a
+     * reduced size through IWICBitmapSourceTransform. */
+    pjpeg_calc_output_dimensions(&This->cinfo);
 
     if (This->cinfo.out_color_space == JCS_GRAYSCALE) This->bpp = 8;
     else if (This->cinfo.out_color_space == JCS_CMYK) This->bpp = 32;
     else This->bpp = 24;
 
-    This->stride = (This->bpp * This->cinfo.output_width + 7) / 8;
-    data_size = This->stride * This->cinfo.output_height;
-
-    This->image_data = heap_alloc(data_size);
-    if (!This->image_data)
-    {
-        LeaveCriticalSection(&This->lock);
-        return E_OUTOFMEMORY;
-    }
-
-    while (This->cinfo.output_scanline < This->cinfo.output_height)
-    {
-        UINT first_scanline = This->cinfo.output_scanline;
-        UINT max_rows;
-        JSAMPROW out_rows[4];
-        JDIMENSION ret;
-
-        max_rows = min(This->cinfo.output_height-first_scanline, 4);
-        for (i=0; i<max_rows; i++)
-            out_rows[i] = This->image_data + This->stride * (first_scanline+i);
-
-        ret = pjpeg_read_scanlines(&This->cinfo, out_rows, max_rows);
-        if (ret == 0)
-        {
-            ERR("read_scanlines failed\n");
-            LeaveCriticalSection(&This->lock);
-            return E_FAIL;
-        }
-    }
-
-    if (This->bpp == 24)
-    {
-        /* libjpeg gives us RGB data and we want BGR, so byteswap the data */
-        reverse_bgr8(3, This->image_data,
-            This->cinfo.output_width, This->cinfo.output_height,
-            This->stride);
-    }
+    This->width = This->cinfo.output_width;
+    This->height = This->cinfo.output_height;
 
-    if (This->cinfo.out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
-    {
-        /* Adobe JPEG's have inverted CMYK data. */
-        for (i=0; i<data_size; i++)
-            This->image_data[i] ^= 0xff;
-    }
+    seek.QuadPart = 0;
+    IStream_Seek(This->stream, seek, STREAM_SEEK_CUR, &This->data_position);
+    This->header_ready = TRUE;
 
     This->initialized = TRUE;
 
@@ -552,6 +633,10 @@ static HRESULT WINAPI JpegDecoder_Frame_QueryInterface(IWICBitmapFrameDecode *if
     {
         *ppv = &This->IWICBitmapFrameDecode_iface;
     }
+    else if (IsEqualIID(&IID_IWICBitmapSourceTransform, iid))
+    {
+        *ppv = &This->IWICBitmapSourceTransform_iface;
+    }
     else
     {
         *ppv = NULL;
@@ -578,23 +663,28 @@ static HRESULT WINAPI JpegDecoder_Frame_GetSize(IWICBitmapFrameDecode *iface,
     UINT *puiWidth, UINT *puiHeight)
 {
     JpegDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
-    *puiWidth = This->cinfo.output_width;
-    *puiHeight = This->cinfo.output_height;
+    *puiWidth = This->width;
+    *puiHeight = This->height;
     TRACE("(%p)->(%u,%u)\n", iface, *puiWidth, *puiHeight);
     return S_OK;
 }
 
+static const WICPixelFormatGUID *get_pixel_format(JpegDecoder *This)
+{
+    if (This->cinfo.out_color_space == JCS_RGB)
+        return &GUID_WICPixelFormat24bppBGR;
+    else if (This->cinfo.out_color_space == JCS_CMYK)
+        return &GUID_WICPixelFormat32bppCMYK;
+    else /* This->cinfo.out_color_space == JCS_GRAYSCALE */
+        return &GUID_WICPixelFormat8bppGray;
+}
+
 static HRESULT WINAPI JpegDecoder_Frame_GetPixelFormat(IWICBitmapFrameDecode *iface,
     WICPixelFormatGUID *pPixelFormat)
 {
     JpegDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
     TRACE("(%p,%p)\n", iface, pPixelFormat);
-    if (This->cinfo.out_color_space == JCS_RGB)
-        memcpy(pPixelFormat, &GUID_WICPixelFormat24bppBGR, sizeof(GUID));
-    else if (This->cinfo.out_color_space == JCS_CMYK)
-        memcpy(pPixelFormat, &GUID_WICPixelFormat32bppCMYK, sizeof(GUID));
-    else /* This->cinfo.out_color_space == JCS_GRAYSCALE */
-        memcpy(pPixelFormat, &GUID_WICPixelFormat8bppGray, sizeof(GUID));
+    memcpy(pPixelFormat, get_pixel_format(This), sizeof(GUID));
     return S_OK;
 }
 
@@ -643,12 +733,22 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
     JpegDecoder *This = impl_from_IWICBitmapFrameDecode(iface);
+    HRESULT hr = S_OK;
 
     TRACE("(%p,%s,%u,%u,%p)\n", iface, debug_wic_rect(prc), cbStride, cbBufferSize, pbBuffer);
 
-    return copy_pixels(This->bpp, This->image_data,
-        This->cinfo.output_width, This->cinfo.output_height, This->stride,
-        prc, cbStride, cbBufferSize, pbBuffer);
+    EnterCriticalSection(&This->lock);
+
+    if (!This->image_data)
+        hr = jpeg_decode(This, 1, &This->image_data, &This->stride);
+
+    if (SUCCEEDED(hr))
+        hr = copy_pixels(This->bpp, This->image_data, This->width, This->height,
+            This->stride, prc, cbStride, cbBufferSize, pbBuffer);
+
+    LeaveCriticalSection(&This->lock);
+
+    return hr;
 }
 
 static HRESULT WINAPI JpegDecoder_Frame_GetMetadataQueryReader(IWICBitmapFrameDecode *iface,
@@ -692,6 +792,141 @@ static const IWICBitmapFrameDecodeVtbl JpegDecoder_Frame_Vtbl = {
     JpegDecoder_Frame_GetThumbnail
 };
 
+/* libjpeg can decode at 1/2, 1/4 and 1/8 of the size, rounding up. */
+static void get_scaled_size(JpegDecoder *This, UINT denom, UINT *width, UINT *height)
+{
+    *width = (This->width + denom - 1) / denom;
+    *height = (This->height + denom - 1) / denom;
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_QueryInterface(IWICBitmapSourceTransform *iface,
+    REFIID iid, void **ppv)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    return IWICBitmapFrameDecode_QueryInterface(&This->IWICBitmapFrameDecode_iface, iid, ppv);
+}
+
+static ULONG WINAPI JpegDecoder_Transform_AddRef(IWICBitmapSourceTransform *iface)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    return IWICBitmapDecoder_AddRef(&This->IWICBitmapDecoder_iface);
+}
+
+static ULONG WINAPI JpegDecoder_Transform_Release(IWICBitmapSourceTransform *iface)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    return IWICBitmapDecoder_Release(&This->IWICBitmapDecoder_iface);
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_CopyPixels(IWICBitmapSourceTransform *iface,
+    const WICRect *prc, UINT width, UINT height, WICPixelFormatGUID *format,
+    WICBitmapTransformOptions transform, UINT stride, UINT buffer_size, BYTE *buffer)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    UINT denom, scaled_width, scaled_height;
+    HRESULT hr = S_OK;
+
+    TRACE("(%p,%s,%u,%u,%s,%u,%u,%u,%p)\n", iface, debug_wic_rect(prc), width, height,
+        debugstr_guid(format), transform, stride, buffer_size, buffer);
+
+    if (!format) return E_INVALIDARG;
+
+    if (!IsEqualGUID(format, get_pixel_format(This)))
+        return WINCODEC_ERR_UNSUPPORTEDPIXELFORMAT;
+
+    if (transform != WICBitmapTransformRotate0)
+        return WINCODEC_ERR_UNSUPPORTEDOPERATION;
+
+    for (denom = 1; denom <= 8; denom *= 2)
+    {
+        get_scaled_size(This, denom, &scaled_width, &scaled_height);
+        if (scaled_width == width && scaled_height == height) break;
+    }
+    if (denom > 8)
+    {
+        FIXME("unsupported size %ux%u\n", width, height);
+        return E_INVALIDARG;
+    }
+
+    if (denom == 1)
+        return IWICBitmapFrameDecode_CopyPixels(&This->IWICBitmapFrameDecode_iface, prc,
+            stride, buffer_size, buffer);
+
+    EnterCriticalSection(&This->lock);
+
+    if (This->scaled_denom != denom)
+    {
+        heap_free(This->scaled_data);
+        This->scaled_data = NULL;
+        This->scaled_denom = 0;
+
+        hr = jpeg_decode(This, denom, &This->scaled_data, &This->scaled_stride);
+        if (SUCCEEDED(hr)) This->scaled_denom = denom;
+    }
+
+    if (SUCCEEDED(hr))
+        hr = copy_pixels(This->bpp, This->scaled_data, width, height, This->scaled_stride,
+            prc, stride, buffer_size, buffer);
+
+    LeaveCriticalSection(&This->lock);
+
+    return hr;
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_GetClosestSize(IWICBitmapSourceTransform *iface,
+    UINT *width, UINT *height)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    UINT denom, scaled_width, scaled_height;
+
+    TRACE("(%p,%p,%p)\n", iface, width, height);
+
+    if (!width || !height) return E_INVALIDARG;
+
+    for (denom = 8; denom > 1; denom /= 2)
+    {
+        get_scaled_size(This, denom, &scaled_width, &scaled_height);
+        if (scaled_width >= *width && scaled_height >= *height) break;
+    }
+
+    get_scaled_size(This, denom, width, height);
+    return S_OK;
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_GetClosestPixelFormat(IWICBitmapSourceTransform *iface,
+    WICPixelFormatGUID *format)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+
+    TRACE("(%p,%p)\n", iface, format);
+
+    if (!format) return E_INVALIDARG;
+
+    memcpy(format, get_pixel_format(This), sizeof(GUID));
+    return S_OK;
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_DoesSupportTransform(IWICBitmapSourceTransform *iface,
+    WICBitmapTransformOptions transform, BOOL *supported)
+{
+    TRACE("(%p,%u,%p)\n", iface, transform, supported);
+
+    if (!supported) return E_INVALIDARG;
+
+    *supported = transform == WICBitmapTransformRotate0;
+    return S_OK;
+}
+
+static const IWICBitmapSourceTransformVtbl JpegDecoder_Transform_Vtbl = {
+    JpegDecoder_Transform_QueryInterface,
+    JpegDecoder_Transform_AddRef,
+    JpegDecoder_Transform_Release,
+    JpegDecoder_Transform_CopyPixels,
+    JpegDecoder_Transform_GetClosestSize,
+    JpegDecoder_Transform_GetClosestPixelFormat,
+    JpegDecoder_Transform_DoesSupportTransform
+};
+
 static HRESULT WINAPI JpegDecoder_Block_QueryInterface(IWICMetadataBlockReader *iface, REFIID iid,
     void **ppv)
 {
@@ -780,11 +1015,15 @@ HRESULT JpegDecoder_CreateInstance(REFIID iid, void** ppv)
     This->IWICBitmapDecoder_iface.lpVtbl = &JpegDecoder_Vtbl;
     This->IWICBitmapFrameDecode_iface.lpVtbl = &JpegDecoder_Frame_Vtbl;
     This->IWICMetadataBlockReader_iface.lpVtbl = &JpegDecoder_Block_Vtbl;
+    This->IWICBitmapSourceTransform_iface.lpVtbl = &JpegDecoder_Transform_Vtbl;
     This->ref = 1;
     This->initialized = FALSE;
     This->cinfo_initialized = FALSE;
+    This->header_ready = FALSE;
     This->stream = NULL;
     This->image_data = NULL;
+    This->scaled_denom = 0;
+    This->scaled_data = NULL;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": JpegDecoder.lock");
 
@@ -20,6 +20,7 @@
 #include "config.h"
 
 #include <stdarg.h>
+#include <math.h>
 
 #define COBJMACROS
 
@@ -29,10 +30,23 @@
 
 #include "wincodecs_private.h"
 
+#include "wine/heap.h"
 #include "wine/debug.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+/* Weights of the source pixels contributing to each destination pixel along
+ * one axis, in fixed point with FILTER_BITS fractional bits. */
+#define FILTER_BITS 14
+
+struct scaler_filter
+{
+    UINT taps;          /* maximum number of contributing source pixels */
+    INT *start;         /* first contributing source pixel */
+    UINT *count;        /* number of contributing source pixels */
+    short *weights;     /* taps entries per destination pixel */
+};
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -42,11 +56,138 @@ typedef struct BitmapScaler {
     UINT src_width, src_height;
     WICBitmapInterpolationMode mode;
     UINT bpp;
+    struct scaler_filter filter_x, filter_y;
+    IWICBitmapSourceTransform *transform; /* source scaled to src_width x src_height */
+    WICPixelFormatGUID transform_format;
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
-    void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*,void*);
+    UINT (*fn_get_scratch_size)(struct BitmapScaler*,const WICRect*);
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
+static void free_filter(struct scaler_filter *filter)
+{
+    heap_free(filter->start);
+    heap_free(filter->count);
+    heap_free(filter->weights);
+    memset(filter, 0, sizeof(*filter));
+}
+
+static float filter_linear(float x)
+{
+    x = fabsf(x);
+    return x < 1.0f ? 1.0f - x : 0.0f;
+}
+
+/* Keys cubic convolution with a = -0.5 */
+static float filter_cubic(float x)
+{
+    x = fabsf(x);
+    if (x < 1.0f) return (1.5f * x - 2.5f) * x * x + 1.0f;
+    if (x < 2.0f) return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+    return 0.0f;
+}
+
+/* Computes the contributions of the source pixels to each destination pixel.
+ * When downscaling, the filters are stretched over the footprint of the
+ * destination pixel so that every source pixel is accounted for. Fant
+ * interpolation weights source pixels by the area the destination pixel
+ * covers. */
+static HRESULT init_filter(struct scaler_filter *filter, UINT src_size, UINT dst_size,
+    WICBitmapInterpolationMode mode)
+{
+    float scale = (float)src_size / dst_size, filter_scale = max(scale, 1.0f), support;
+    float (*filter_fn)(float) = NULL;
+    float *weights;
+    UINT i, dst;
+
+    switch (mode)
+    {
+    case WICBitmapInterpolationModeLinear:
+        filter_fn = filter_linear;
+        support = 1.0f;
+        break;
+    case WICBitmapInterpolationModeCubic:
+    case WICBitmapInterpolationModeHighQualityCubic:
+        filter_fn = filter_cubic;
+        support = 2.0f;
+        break;
+    default: /* WICBitmapInterpolationModeFant */
+        support = 0.5f;
+        break;
+    }
+
+    filter->taps = (UINT)ceilf(2.0f * support * filter_scale) + 2;
+    filter->start = heap_alloc(dst_size * sizeof(*filter->start));
+    filter->count = heap_alloc(dst_size * sizeof(*filter->count));
+    filter->weights = heap_calloc(dst_size * filter->taps, sizeof(*filter->weights));
+    weights = heap_alloc(filter->taps * sizeof(*weights));
+
+    if (!filter->start || !filter->count || !filter->weights || !weights)
+    {
+        free_filter(filter);
+        heap_free(weights);
+        return E_OUTOFMEMORY;
+    }
+
+    for (dst = 0; dst < dst_size; dst++)
+    {
+        float center = (dst + 0.5f) * scale, sum = 0.0f;
+        short *fixed = filter->weights + dst * filter->taps;
+        INT first, last, total, largest;
+        UINT count;
+
+        if (filter_fn)
+        {
+            first = floorf(center - support * filter_scale - 0.5f);
+            last = ceilf(center + support * filter_scale - 0.5f);
+        }
+        else
+        {
+            first = floorf(dst * scale);
+            last = ceilf((dst + 1) * scale) - 1;
+        }
+        first = max(first, 0);
+        last = min(last, (INT)src_size - 1);
+        last = min(last, first + (INT)filter->taps - 1);
+
+        for (i = 0; first + (INT)i <= last; i++)
+        {
+            float pos = first + i;
+
+            if (filter_fn)
+                weights[i] = filter_fn((pos + 0.5f - center) / filter_scale);
+            else
+                weights[i] = min(pos + 1.0f, (dst + 1) * scale) - max(pos, dst * scale);
+            sum += weights[i];
+        }
+        count = i;
+
+        if (!count || sum == 0.0f)
+        {
+            first = min((UINT)center, src_size - 1);
+            count = 1;
+            weights[0] = sum = 1.0f;
+        }
+
+        /* round to fixed point, keeping the total exact */
+        total = largest = 0;
+        for (i = 0; i < count; i++)
+        {
+            fixed[i] = floorf(weights[i] / sum * (1 << FILTER_BITS) + 0.5f);
+            total += fixed[i];
+            if (fixed[i] > fixed[largest]) largest = i;
+        }
+        fixed[largest] += (1 << FILTER_BITS) - total;
+
+        filter->start[dst] = first;
+        filter->count[dst] = count;
+    }
+
+    heap_free(weights);
+    return S_OK;
+}
+
 static inline BitmapScaler *impl_from_IWICBitmapScaler(IWICBitmapScaler *iface)
 {
     return CONTAINING_RECORD(iface, BitmapScaler, IWICBitmapScaler_iface);
@@ -108,6 +249,9 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        if (This->transform) IWICBitmapSourceTransform_Release(This->transform);
+        free_filter(&This->filter_x);
+        free_filter(&This->filter_y);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -190,7 +334,7 @@ static void NearestNeighbor_GetRequiredSourceRect(BitmapScaler *This,
 
 static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     UINT dst_x, UINT dst_y, UINT dst_width,
-    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer)
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer, void *scratch)
 {
     UINT i;
     UINT bytesperpixel = This->bpp/8;
@@ -205,6 +349,182 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+static UINT NearestNeighbor_GetScratchSize(BitmapScaler *This, const WICRect *src_rect)
+{
+    return 0;
+}
+
+static void Filter_GetRequiredSourceRect(BitmapScaler *This,
+    UINT x, UINT y, WICRect *src_rect)
+{
+    src_rect->X = This->filter_x.start[x];
+    src_rect->Y = This->filter_y.start[y];
+    src_rect->Width = This->filter_x.count[x];
+    src_rect->Height = This->filter_y.count[y];
+}
+
+static UINT Filter_GetScratchSize(BitmapScaler *This, const WICRect *src_rect)
+{
+    return src_rect->Width * (This->bpp / 8) * sizeof(INT);
+}
+
+static inline BYTE clamp_filtered(INT value)
+{
+    value = (value + (1 << (2 * FILTER_BITS - 9))) >> (2 * FILTER_BITS - 8);
+    return value < 0 ? 0 : value > 255 ? 255 : value;
+}
+
+/* Filters the source rows vertically into scratch, keeping 6 fractional bits,
+ * then filters the result horizontally. */
+static void Filter_CopyScanline(BitmapScaler *This,
+    UINT dst_x, UINT dst_y, UINT dst_width,
+    BYTE **src_data, UINT src_data_x, UINT src_data_y, BYTE *pbBuffer, void *scratch)
+{
+    UINT bytesperpixel = This->bpp / 8;
+    const short *weights = This->filter_y.weights + dst_y * This->filter_y.taps;
+    BYTE **rows = src_data + This->filter_y.start[dst_y] - src_data_y;
+    UINT count = This->filter_y.count[dst_y];
+    UINT last_x = dst_x + dst_width - 1;
+    UINT columns = (This->filter_x.start[last_x] + This->filter_x.count[last_x] - src_data_x) * bytesperpixel;
+    INT *accum = scratch;
+    UINT i, j, x;
+
+    memset(accum, 0, columns * sizeof(*accum));
+    for (j = 0; j < count; j++)
+    {
+        const BYTE *row = rows[j];
+        INT weight = weights[j];
+
+        for (i = 0; i < columns; i++)
+            accum[i] += weight * row[i];
+    }
+    for (i = 0; i < columns; i++)
+        accum[i] = (accum[i] + (1 << (FILTER_BITS - 7))) >> (FILTER_BITS - 6);
+
+    for (x = 0; x < dst_width; x++)
+    {
+        const INT *src = accum + (This->filter_x.start[dst_x + x] - src_data_x) * bytesperpixel;
+        BYTE *dst = pbBuffer + x * bytesperpixel;
+
+        weights = This->filter_x.weights + (dst_x + x) * This->filter_x.taps;
+        count = This->filter_x.count[dst_x + x];
+
+        if (bytesperpixel == 4)
+        {
+            INT sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+
+            for (j = 0; j < count; j++, src += 4)
+            {
+                sum0 += weights[j] * src[0];
+                sum1 += weights[j] * src[1];
+                sum2 += weights[j] * src[2];
+                sum3 += weights[j] * src[3];
+            }
+            dst[0] = clamp_filtered(sum0);
+            dst[1] = clamp_filtered(sum1);
+            dst[2] = clamp_filtered(sum2);
+            dst[3] = clamp_filtered(sum3);
+        }
+        else
+        {
+            for (i = 0; i < bytesperpixel; i++)
+            {
+                INT sum = 0;
+
+                for (j = 0; j < count; j++)
+                    sum += weights[j] * src[j * bytesperpixel + i];
+                dst[i] = clamp_filtered(sum);
+            }
+        }
+    }
+}
+
+/* Destination rows are independent, so filtering large images is spread over
+ * the thread pool in chunks of SCANLINE_CHUNK rows. */
+#define SCANLINE_CHUNK 8
+#define SCANLINE_PARALLEL_COST (1 << 20)
+
+struct scanline_job
+{
+    BitmapScaler *scaler;
+    const WICRect *dst_rect;
+    const WICRect *src_rect;
+    BYTE **src_rows;
+    BYTE *buffer;
+    UINT stride;
+    UINT scratch_size;
+    LONG next_row;
+};
+
+static void copy_scanline_chunks(struct scanline_job *job, void *scratch)
+{
+    BitmapScaler *This = job->scaler;
+    LONG first, last, y;
+
+    while ((first = InterlockedExchangeAdd(&job->next_row, SCANLINE_CHUNK)) < job->dst_rect->Height)
+    {
+        last = min(first + SCANLINE_CHUNK, job->dst_rect->Height);
+        for (y = first; y < last; y++)
+        {
+            This->fn_copy_scanline(This, job->dst_rect->X, job->dst_rect->Y + y, job->dst_rect->Width,
+                job->src_rows, job->src_rect->X, job->src_rect->Y, job->buffer + job->stride * y, scratch);
+        }
+    }
+}
+
+static void CALLBACK copy_scanlines_callback(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+{
+    struct scanline_job *job = context;
+    void *scratch;
+
+    /* the calling thread copies whatever rows are left */
+    if (!(scratch = heap_alloc(job->scratch_size))) return;
+    copy_scanline_chunks(job, scratch);
+    heap_free(scratch);
+}
+
+static HRESULT copy_scanlines(struct scanline_job *job)
+{
+    BitmapScaler *This = job->scaler;
+    UINT threads = 1, i;
+    UINT64 cost;
+    SYSTEM_INFO info;
+    TP_WORK *work = NULL;
+    void *scratch = NULL;
+
+    job->scratch_size = This->fn_get_scratch_size(This, job->src_rect);
+    job->next_row = 0;
+
+    if (job->scratch_size && !(scratch = heap_alloc(job->scratch_size)))
+        return E_OUTOFMEMORY;
+
+    if (job->scratch_size)
+    {
+        cost = (UINT64)job->dst_rect->Height * (job->src_rect->Width * This->filter_y.taps +
+            job->dst_rect->Width * This->filter_x.taps) * (This->bpp / 8);
+        GetSystemInfo(&info);
+        if (cost >= SCANLINE_PARALLEL_COST)
+            threads = min(info.dwNumberOfProcessors, (job->dst_rect->Height + SCANLINE_CHUNK - 1) / SCANLINE_CHUNK);
+    }
+
+    if (threads > 1 && (work = CreateThreadpoolWork(copy_scanlines_callback, job, NULL)))
+    {
+        for (i = 1; i < threads; i++)
+            SubmitThreadpoolWork(work);
+    }
+
+    copy_scanline_chunks(job, scratch);
+
+    if (work)
+    {
+        WaitForThreadpoolWorkCallbacks(work, FALSE);
+        CloseThreadpoolWork(work);
+    }
+
+    heap_free(scratch);
+    return S_OK;
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -259,6 +579,12 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
         goto end;
     }
 
+    if (!dest_rect.Width || !dest_rect.Height)
+    {
+        hr = S_OK;
+        goto end;
+    }
+
     /* MSDN recommends calling CopyPixels once for each scanline from top to
      * bottom, and claims codecs optimize for this. Ideally, when called in this
      * way, we should avoid requesting a scanline from the source more than
@@ -293,16 +619,25 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     for (y=0; y<src_rect.Height; y++)
         src_rows[y] = src_bits + y * src_bytesperrow;
 
-    hr = IWICBitmapSource_CopyPixels(This->source, &src_rect, src_bytesperrow,
-        buffer_size, src_bits);
+    if (This->transform)
+        hr = IWICBitmapSourceTransform_CopyPixels(This->transform, &src_rect, This->src_width,
+            This->src_height, &This->transform_format, WICBitmapTransformRotate0,
+            src_bytesperrow, buffer_size, src_bits);
+    else
+        hr = IWICBitmapSource_CopyPixels(This->source, &src_rect, src_bytesperrow,
+            buffer_size, src_bits);
 
     if (SUCCEEDED(hr))
     {
-        for (y=0; y < dest_rect.Height; y++)
-        {
-            This->fn_copy_scanline(This, dest_rect.X, dest_rect.Y+y, dest_rect.Width,
-                src_rows, src_rect.X, src_rect.Y, pbBuffer + cbStride * y);
-        }
+        struct scanline_job job;
+
+        job.scaler = This;
+        job.dst_rect = &dest_rect;
+        job.src_rect = &src_rect;
+        job.src_rows = src_rows;
+        job.buffer = pbBuffer;
+        job.stride = cbStride;
+        hr = copy_scanlines(&job);
     }
 
     HeapFree(GetProcessHeap(), 0, src_rows);
@@ -314,6 +649,111 @@ end:
     return hr;
 }
 
+static HRESULT init_nearest_neighbor(BitmapScaler *This, IWICBitmapSource *source)
+{
+    HRESULT hr = S_OK;
+
+    if ((This->bpp % 8) == 0)
+    {
+        IWICBitmapSource_AddRef(source);
+        This->source = source;
+    }
+    else
+    {
+        hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
+            source, &This->source);
+        This->bpp = 32;
+    }
+    This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
+    This->fn_copy_scanline = NearestNeighbor_CopyScanline;
+    This->fn_get_scratch_size = NearestNeighbor_GetScratchSize;
+    return hr;
+}
+
+/* Formats with one byte per channel, which can be filtered channel by channel. */
+static BOOL is_filterable_format(const WICPixelFormatGUID *format)
+{
+    static const WICPixelFormatGUID *formats[] =
+    {
+        &GUID_WICPixelFormat8bppGray,
+        &GUID_WICPixelFormat24bppBGR,
+        &GUID_WICPixelFormat24bppRGB,
+        &GUID_WICPixelFormat32bppBGR,
+        &GUID_WICPixelFormat32bppRGB,
+        &GUID_WICPixelFormat32bppBGRA,
+        &GUID_WICPixelFormat32bppRGBA,
+        &GUID_WICPixelFormat32bppPBGRA,
+        &GUID_WICPixelFormat32bppPRGBA,
+        &GUID_WICPixelFormat32bppCMYK,
+    };
+    UINT i;
+
+    for (i = 0; i < ARRAY_SIZE(formats); i++)
+        if (IsEqualGUID(format, formats[i])) return TRUE;
+
+    return FALSE;
+}
+
+/* Decoders such as JPEG can produce a smaller version of the image much more
+ * cheaply than the full one, use it if it is still at least as large as the
+ * destination. */
+static void init_source_transform(BitmapScaler *This, IWICBitmapSource *source,
+    const WICPixelFormatGUID *format)
+{
+    IWICBitmapSourceTransform *transform;
+    WICPixelFormatGUID closest_format = *format;
+    UINT width = This->width, height = This->height;
+    BOOL supported = FALSE;
+
+    if (FAILED(IWICBitmapSource_QueryInterface(source, &IID_IWICBitmapSourceTransform, (void **)&transform)))
+        return;
+
+    if (SUCCEEDED(IWICBitmapSourceTransform_GetClosestSize(transform, &width, &height)) &&
+        SUCCEEDED(IWICBitmapSourceTransform_GetClosestPixelFormat(transform, &closest_format)) &&
+        SUCCEEDED(IWICBitmapSourceTransform_DoesSupportTransform(transform, WICBitmapTransformRotate0, &supported)) &&
+        supported && IsEqualGUID(&closest_format, format) &&
+        width >= This->width && height >= This->height &&
+        width <= This->src_width && height <= This->src_height &&
+        (width < This->src_width || height < This->src_height))
+    {
+        TRACE("using %ux%u source transform\n", width, height);
+        This->transform = transform;
+        This->transform_format = *format;
+        This->src_width = width;
+        This->src_height = height;
+        return;
+    }
+
+    IWICBitmapSourceTransform_Release(transform);
+}
+
+static HRESULT init_filters(BitmapScaler *This, IWICBitmapSource *source,
+    const WICPixelFormatGUID *format, WICBitmapInterpolationMode mode)
+{
+    HRESULT hr;
+
+    init_source_transform(This, source, format);
+
+    hr = init_filter(&This->filter_x, This->src_width, This->width, mode);
+    if (SUCCEEDED(hr))
+        hr = init_filter(&This->filter_y, This->src_height, This->height, mode);
+
+    if (FAILED(hr))
+    {
+        free_filter(&This->filter_x);
+        if (This->transform) IWICBitmapSourceTransform_Release(This->transform);
+        This->transform = NULL;
+        return hr;
+    }
+
+    IWICBitmapSource_AddRef(source);
+    This->source = source;
+    This->fn_get_required_source_rect = Filter_GetRequiredSourceRect;
+    This->fn_copy_scanline = Filter_CopyScanline;
+    This->fn_get_scratch_size = Filter_GetScratchSize;
+    return S_OK;
+}
+
 static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     IWICBitmapSource *pISource, UINT uiWidth, UINT uiHeight,
     WICBitmapInterpolationMode mode)
@@ -353,23 +793,24 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+        case WICBitmapInterpolationModeHighQualityCubic:
+            if (is_filterable_format(&src_pixelformat))
+            {
+                hr = init_filters(This, pISource, &src_pixelformat, mode);
+                break;
+            }
+            FIXME("mode %i is not supported for format %s, using nearest neighbor\n",
+                mode, debugstr_guid(&src_pixelformat));
+            hr = init_nearest_neighbor(This, pISource);
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
         case WICBitmapInterpolationModeNearestNeighbor:
-            if ((This->bpp % 8) == 0)
-            {
-                IWICBitmapSource_AddRef(pISource);
-                This->source = pISource;
-            }
-            else
-            {
-                hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
-                    pISource, &This->source);
-                This->bpp = 32;
-            }
-            This->fn_get_required_source_rect = NearestNeighbor_GetRequiredSourceRect;
-            This->fn_copy_scanline = NearestNeighbor_CopyScanline;
+            hr = init_nearest_neighbor(This, pISource);
             break;
         }
     }
@@ -529,6 +970,9 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    memset(&This->filter_x, 0, sizeof(This->filter_x));
+    memset(&This->filter_y, 0, sizeof(This->filter_y));
+    This->transform = NULL;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
@@ -1312,6 +1312,147 @@ static void test_bitmap_scaler(void)
     IWICBitmap_Release(bitmap);
 }
 
+static void test_bitmap_scaler_modes(void)
+{
+    static const WICBitmapInterpolationMode modes[] =
+    {
+        WICBitmapInterpolationModeLinear,
+        WICBitmapInterpolationModeCubic,
+        WICBitmapInterpolationModeFant,
+        WICBitmapInterpolationModeHighQualityCubic,
+    };
+    static const struct
+    {
+        UINT width, height;
+    }
+    sizes[] = { {3, 2}, {7, 5}, {11, 9}, {1, 1} };
+    static const BYTE gray_2x2[] = { 10, 20, 30, 40 };
+    BYTE color_7x5[7 * 5 * 3], ramp_32x1[32], buf[11 * 9 * 3];
+    IWICBitmapScaler *scaler;
+    WICRect rc;
+    IWICBitmap *bitmap;
+    UINT i, j, k;
+    HRESULT hr;
+
+    for (i = 0; i < sizeof(color_7x5); i += 3)
+    {
+        color_7x5[i] = 0x40;
+        color_7x5[i + 1] = 0x80;
+        color_7x5[i + 2] = 0xc0;
+    }
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 7, 5, &GUID_WICPixelFormat24bppBGR,
+        7 * 3, sizeof(color_7x5), color_7x5, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#x.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(modes); i++)
+    {
+        for (j = 0; j < ARRAY_SIZE(sizes); j++)
+        {
+            hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+            ok(hr == S_OK, "Failed to create bitmap scaler, hr %#x.\n", hr);
+
+            hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap,
+                sizes[j].width, sizes[j].height, modes[i]);
+            ok(hr == S_OK || broken(hr == E_INVALIDARG && modes[i] == WICBitmapInterpolationModeHighQualityCubic),
+                "%u: Failed to initialize bitmap scaler, hr %#x.\n", modes[i], hr);
+            if (hr == S_OK)
+            {
+                memset(buf, 0, sizeof(buf));
+                hr = IWICBitmapScaler_CopyPixels(scaler, NULL, sizes[j].width * 3, sizeof(buf), buf);
+                ok(hr == S_OK, "%u: Failed to copy pixels, hr %#x.\n", modes[i], hr);
+
+                for (k = 0; k < sizes[j].width * sizes[j].height * 3; k += 3)
+                {
+                    if (buf[k] != 0x40 || buf[k + 1] != 0x80 || buf[k + 2] != 0xc0) break;
+                }
+                ok(k == sizes[j].width * sizes[j].height * 3, "%u: %ux%u: unexpected pixel %u %02x%02x%02x.\n",
+                    modes[i], sizes[j].width, sizes[j].height, k / 3, buf[k], buf[k + 1], buf[k + 2]);
+
+                /* Empty rectangles don't copy anything. */
+                memset(buf, 0xcc, sizeof(buf));
+                rc.X = rc.Y = 0;
+                rc.Width = 0;
+                rc.Height = sizes[j].height;
+                hr = IWICBitmapScaler_CopyPixels(scaler, &rc, sizes[j].width * 3, sizeof(buf), buf);
+                ok(hr == S_OK, "%u: Failed to copy pixels, hr %#x.\n", modes[i], hr);
+                rc.Width = sizes[j].width;
+                rc.Height = 0;
+                hr = IWICBitmapScaler_CopyPixels(scaler, &rc, sizes[j].width * 3, sizeof(buf), buf);
+                ok(hr == S_OK, "%u: Failed to copy pixels, hr %#x.\n", modes[i], hr);
+                ok(buf[0] == 0xcc, "%u: unexpected pixel %02x.\n", modes[i], buf[0]);
+            }
+
+            IWICBitmapScaler_Release(scaler);
+        }
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* Downscaling by two averages the source pixels. */
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 2, 2, &GUID_WICPixelFormat8bppGray,
+        2, sizeof(gray_2x2), (BYTE *)gray_2x2, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#x.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(modes); i++)
+    {
+        if (modes[i] != WICBitmapInterpolationModeLinear && modes[i] != WICBitmapInterpolationModeFant)
+            continue;
+
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#x.\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 1, 1, modes[i]);
+        ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#x.\n", hr);
+
+        buf[0] = 0;
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 1, 1, buf);
+        ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+        ok(buf[0] == 25 || broken(buf[0] == 24 || buf[0] == 26), "%u: unexpected pixel %u.\n", modes[i], buf[0]);
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* Symmetric filters preserve a linear ramp, so halving it gives 8 * x + 4,
+     * while nearest neighbor would be off by 2. Cubic filters reach past the
+     * edges, so only check the inner pixels for them. */
+    for (i = 0; i < sizeof(ramp_32x1); i++)
+        ramp_32x1[i] = 4 * i + 2;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 32, 1, &GUID_WICPixelFormat8bppGray,
+        32, sizeof(ramp_32x1), ramp_32x1, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#x.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(modes); i++)
+    {
+        BOOL cubic = modes[i] == WICBitmapInterpolationModeCubic
+                || modes[i] == WICBitmapInterpolationModeHighQualityCubic;
+
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#x.\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 16, 1, modes[i]);
+        ok(hr == S_OK || broken(hr == E_INVALIDARG && modes[i] == WICBitmapInterpolationModeHighQualityCubic),
+            "%u: Failed to initialize bitmap scaler, hr %#x.\n", modes[i], hr);
+        if (hr == S_OK)
+        {
+            memset(buf, 0, sizeof(buf));
+            hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 16, 16, buf);
+            ok(hr == S_OK, "%u: Failed to copy pixels, hr %#x.\n", modes[i], hr);
+
+            for (k = cubic ? 3 : 0; k < (cubic ? 13 : 16); k++)
+                ok(abs(buf[k] - (int)(8 * k + 4)) <= 1, "%u: pixel %u: got %u, expected %u.\n",
+                    modes[i], k, buf[k], 8 * k + 4);
+        }
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+}
+
 static LONG obj_refcount(void *obj)
 {
     IUnknown_AddRef((IUnknown *)obj);
@@ -1482,6 +1623,7 @@ START_TEST(bitmap)
     test_CreateBitmapFromHBITMAP();
     test_clipper();
     test_bitmap_scaler();
+    test_bitmap_scaler_modes();
 
     IWICImagingFactory_Release(factory);
 
@@ -1849,6 +1849,207 @@ static void test_converter_8bppIndexed(void)
     DeleteTestBitmap(src_obj);
 }
 
+static HRESULT convert_bitmap_data(const struct bitmap_data *src, const GUID *format,
+    UINT stride, UINT size, BYTE *bits)
+{
+    BitmapTestSrc *src_obj;
+    IWICBitmapSource *dst_bitmap;
+    HRESULT hr;
+
+    CreateTestBitmap(src, &src_obj);
+
+    hr = WICConvertBitmapSource(format, &src_obj->IWICBitmapSource_iface, &dst_bitmap);
+    if (hr == S_OK)
+    {
+        hr = IWICBitmapSource_CopyPixels(dst_bitmap, NULL, stride, size, bits);
+        IWICBitmapSource_Release(dst_bitmap);
+    }
+
+    DeleteTestBitmap(src_obj);
+    return hr;
+}
+
+struct pixel_layout
+{
+    const GUID *format;
+    UINT bpp;
+    BOOL rgb;           /* red comes first */
+    BOOL alpha;         /* has an alpha channel */
+    BOOL premultiplied;
+};
+
+static const struct pixel_layout layout_24bppBGR = {&GUID_WICPixelFormat24bppBGR, 24};
+static const struct pixel_layout layout_24bppRGB = {&GUID_WICPixelFormat24bppRGB, 24, TRUE};
+static const struct pixel_layout layout_32bppBGR = {&GUID_WICPixelFormat32bppBGR, 32};
+static const struct pixel_layout layout_32bppRGB = {&GUID_WICPixelFormat32bppRGB, 32, TRUE};
+static const struct pixel_layout layout_32bppBGRA = {&GUID_WICPixelFormat32bppBGRA, 32, FALSE, TRUE};
+static const struct pixel_layout layout_32bppRGBA = {&GUID_WICPixelFormat32bppRGBA, 32, TRUE, TRUE};
+static const struct pixel_layout layout_32bppPBGRA = {&GUID_WICPixelFormat32bppPBGRA, 32, FALSE, TRUE, TRUE};
+static const struct pixel_layout layout_32bppPRGBA = {&GUID_WICPixelFormat32bppPRGBA, 32, TRUE, TRUE, TRUE};
+
+static void expected_pixel(const struct pixel_layout *src_layout, const BYTE *src,
+    const struct pixel_layout *dst_layout, BYTE *dst)
+{
+    BYTE b, g, r, a;
+
+    b = src_layout->rgb ? src[2] : src[0];
+    g = src[1];
+    r = src_layout->rgb ? src[0] : src[2];
+    a = src_layout->alpha ? src[3] : 255;
+
+    if (src_layout->premultiplied && !dst_layout->premultiplied && a != 0 && a != 255)
+    {
+        b = b * 255 / a;
+        g = g * 255 / a;
+        r = r * 255 / a;
+    }
+    else if (!src_layout->premultiplied && dst_layout->premultiplied && a != 255)
+    {
+        b = b * a / 255;
+        g = g * a / 255;
+        r = r * a / 255;
+    }
+
+    dst[0] = dst_layout->rgb ? r : b;
+    dst[1] = g;
+    dst[2] = dst_layout->rgb ? b : r;
+    if (dst_layout->alpha) dst[3] = a;
+}
+
+static void test_conversion_kernels(void)
+{
+    static const struct
+    {
+        const struct pixel_layout *src, *dst;
+    }
+    tests[] =
+    {
+        {&layout_24bppBGR, &layout_32bppBGRA},
+        {&layout_24bppBGR, &layout_32bppPBGRA},
+        {&layout_24bppBGR, &layout_32bppRGBA},
+        {&layout_24bppRGB, &layout_32bppBGRA},
+        {&layout_24bppRGB, &layout_32bppRGBA},
+        {&layout_32bppBGR, &layout_24bppBGR},
+        {&layout_32bppBGRA, &layout_24bppBGR},
+        {&layout_32bppBGRA, &layout_24bppRGB},
+        {&layout_32bppRGBA, &layout_24bppBGR},
+        {&layout_32bppBGR, &layout_32bppBGRA},
+        {&layout_32bppRGB, &layout_32bppPRGBA},
+        {&layout_32bppBGRA, &layout_32bppRGBA},
+        {&layout_32bppBGR, &layout_32bppRGBA},
+        {&layout_32bppBGRA, &layout_32bppPBGRA},
+        {&layout_32bppRGBA, &layout_32bppPRGBA},
+        {&layout_32bppPBGRA, &layout_32bppBGRA},
+        {&layout_32bppPRGBA, &layout_32bppRGBA},
+    };
+    /* odd width to cover the pixels left over by multi-pixel steps */
+    static const UINT width = 37, height = 3;
+    BYTE src_bits[4 * 37 * 3], dst_bits[(4 * 37 + 4) * 3], expect[4];
+    struct bitmap_data src_data;
+    UINT i, j, x, y, src_stride, dst_stride, channels, seed = 12345;
+    HRESULT hr;
+
+    for (i = 0; i < ARRAY_SIZE(tests); i++)
+    {
+        const struct pixel_layout *src = tests[i].src, *dst = tests[i].dst;
+
+        src_stride = width * src->bpp / 8;
+        for (j = 0; j < src_stride * height; j++)
+        {
+            seed = seed * 1103515245 + 12345;
+            src_bits[j] = seed >> 16;
+        }
+        /* make sure fully transparent and opaque pixels are present */
+        if (src->alpha)
+        {
+            src_bits[3] = 0;
+            src_bits[7] = 255;
+        }
+        /* premultiplied colors are not larger than alpha */
+        if (src->premultiplied)
+        {
+            for (j = 0; j < width * height; j++)
+                for (x = 0; x < 3; x++)
+                    src_bits[j * 4 + x] = src_bits[j * 4 + 3] ? src_bits[j * 4 + x] % (src_bits[j * 4 + 3] + 1) : 0;
+        }
+
+        src_data.format = src->format;
+        src_data.bpp = src->bpp;
+        src_data.bits = src_bits;
+        src_data.width = width;
+        src_data.height = height;
+        src_data.xres = 96.0;
+        src_data.yres = 96.0;
+        src_data.alt_data = NULL;
+
+        dst_stride = width * dst->bpp / 8 + 4;
+        memset(dst_bits, 0xcc, sizeof(dst_bits));
+        hr = convert_bitmap_data(&src_data, dst->format, dst_stride, dst_stride * height, dst_bits);
+        ok(hr == S_OK, "%u: conversion failed, hr %#x\n", i, hr);
+        if (hr != S_OK) continue;
+
+        /* the padding byte of 32bppBGR and 32bppRGB is undefined */
+        channels = dst->alpha ? 4 : 3;
+        for (y = 0; y < height; y++)
+        {
+            for (x = 0; x < width; x++)
+            {
+                const BYTE *s = src_bits + y * src_stride + x * src->bpp / 8;
+                const BYTE *d = dst_bits + y * dst_stride + x * dst->bpp / 8;
+
+                expected_pixel(src, s, dst, expect);
+                for (j = 0; j < channels; j++)
+                {
+                    /* Windows may round differently when scaling by alpha */
+                    ok(d[j] == expect[j] || broken(abs(d[j] - expect[j]) <= 1),
+                       "%u: pixel %u,%u channel %u: got %u, expected %u\n", i, x, y, j, d[j], expect[j]);
+                }
+            }
+        }
+    }
+}
+
+static void test_gray_float_to_8bpp_gray(void)
+{
+    static const UINT width = 1024;
+    float src_bits[1024];
+    BYTE dst_bits[1024];
+    struct bitmap_data src_data;
+    HRESULT hr;
+    UINT x;
+
+    for (x = 0; x < width; x++)
+        src_bits[x] = x / (float)(width - 1);
+
+    src_data.format = &GUID_WICPixelFormat32bppGrayFloat;
+    src_data.bpp = 32;
+    src_data.bits = (const BYTE *)src_bits;
+    src_data.width = width;
+    src_data.height = 1;
+    src_data.xres = 96.0;
+    src_data.yres = 96.0;
+    src_data.alt_data = NULL;
+
+    hr = convert_bitmap_data(&src_data, &GUID_WICPixelFormat8bppGray, width, width, dst_bits);
+    ok(hr == S_OK, "conversion failed, hr %#x\n", hr);
+    if (hr != S_OK) return;
+
+    for (x = 0; x < width; x++)
+    {
+        float f = src_bits[x];
+        BYTE expect;
+
+        /* sRGB gamma, see https://www.w3.org/Graphics/Color/srgb */
+        if (f <= 0.0031308f) f = 12.92f * f;
+        else f = 1.055f * powf(f, 1.0f / 2.4f) - 0.055f;
+        expect = (BYTE)floorf(f * 255.0f + 0.51f);
+
+        ok(dst_bits[x] == expect || broken(abs(dst_bits[x] - expect) <= 1) /* XP */ ||
+           broken(dst_bits[x] == (BYTE)floorf(src_bits[x] * 255.0f + 0.51f)) /* XP */,
+           "%u: got %u, expected %u\n", x, dst_bits[x], expect);
+    }
+}
+
 START_TEST(converter)
 {
     HRESULT hr;
@@ -1904,6 +2105,8 @@ START_TEST(converter)
     test_invalid_conversion();
     test_default_converter();
     test_converter_8bppIndexed();
+    test_conversion_kernels();
+    test_gray_float_to_8bpp_gray();
 
     test_encoder(&testdata_8bppIndexed, &CLSID_WICGifEncoder,
                  &testdata_8bppIndexed, &CLSID_WICGifDecoder, "GIF encoder 8bppIndexed");
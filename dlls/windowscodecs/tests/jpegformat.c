@@ -43,6 +43,70 @@ static const char jpeg_adobe_cmyk_1x5[] =
     "\x00\x00\xff\xda\x00\x0e\x04\x01\x00\x02\x11\x03\x11\x04\x00\x00"
     "\x3f\x00\x40\x44\x02\x1e\xa4\x1f\xff\xd9";
 
+/* 16x16 grayscale, four uniform 8x8 blocks of 0x20, 0x60 / 0xa0, 0xe0. */
+static const char jpeg_gray_16x16[] =
+    "\xff\xd8\xff\xe0\x00\x10\x4a\x46\x49\x46\x00\x01\x01\x00\x00\x01"
+    "\x00\x01\x00\x00\xff\xdb\x00\x43\x00\x01\x01\x01\x01\x01\x01\x01"
+    "\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01"
+    "\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01"
+    "\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01\x01"
+    "\x01\x01\x01\x01\x01\x01\x01\x01\x01\xff\xc0\x00\x0b\x08\x00\x10"
+    "\x00\x10\x01\x01\x11\x00\xff\xc4\x00\x14\x00\x01\x00\x00\x00\x00"
+    "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x0a\xff\xc4\x00\x14"
+    "\x10\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+    "\x00\x00\xff\xda\x00\x08\x01\x01\x00\x00\x3f\x00\x1f\xe4\x00\x40"
+    "\x04\x00\xff\xd9";
+
+static void test_source_transform(IWICBitmapFrameDecode *frame, const BYTE *expected, UINT size)
+{
+    IWICBitmapSourceTransform *transform;
+    WICPixelFormatGUID format;
+    UINT width, height;
+    BYTE data[5 * 4];
+    BOOL supported;
+    HRESULT hr;
+
+    hr = IWICBitmapFrameDecode_QueryInterface(frame, &IID_IWICBitmapSourceTransform, (void **)&transform);
+    ok(hr == S_OK || broken(hr == E_NOINTERFACE) /* xp */, "QueryInterface error %#x\n", hr);
+    if (hr != S_OK) return;
+
+    supported = FALSE;
+    hr = IWICBitmapSourceTransform_DoesSupportTransform(transform, WICBitmapTransformRotate0, &supported);
+    ok(hr == S_OK, "DoesSupportTransform error %#x\n", hr);
+    ok(supported, "Rotate0 should be supported\n");
+
+    hr = IWICBitmapFrameDecode_GetPixelFormat(frame, &format);
+    ok(hr == S_OK, "GetPixelFormat error %#x\n", hr);
+    hr = IWICBitmapSourceTransform_GetClosestPixelFormat(transform, &format);
+    ok(hr == S_OK, "GetClosestPixelFormat error %#x\n", hr);
+    ok(IsEqualGUID(&format, &GUID_WICPixelFormat32bppCMYK) ||
+        broken(IsEqualGUID(&format, &GUID_WICPixelFormat24bppBGR)), /* xp/2003 */
+        "unexpected pixel format %s\n", wine_dbgstr_guid(&format));
+
+    width = height = 5;
+    hr = IWICBitmapSourceTransform_GetClosestSize(transform, &width, &height);
+    ok(hr == S_OK, "GetClosestSize error %#x\n", hr);
+    ok(width == 1 && height == 5, "got %ux%u\n", width, height);
+
+    width = height = 1;
+    hr = IWICBitmapSourceTransform_GetClosestSize(transform, &width, &height);
+    ok(hr == S_OK, "GetClosestSize error %#x\n", hr);
+    ok(width == 1 && height >= 1 && height <= 5, "got %ux%u\n", width, height);
+
+    memset(data, 0xcc, sizeof(data));
+    hr = IWICBitmapSourceTransform_CopyPixels(transform, NULL, width, height, &format,
+        WICBitmapTransformRotate0, 4, sizeof(data), data);
+    ok(hr == S_OK, "CopyPixels error %#x\n", hr);
+
+    memset(data, 0xcc, sizeof(data));
+    hr = IWICBitmapSourceTransform_CopyPixels(transform, NULL, 1, 5, &format,
+        WICBitmapTransformRotate0, 4, sizeof(data), data);
+    ok(hr == S_OK, "CopyPixels error %#x\n", hr);
+    ok(!memcmp(data, expected, size), "unexpected image data\n");
+
+    IWICBitmapSourceTransform_Release(transform);
+}
+
 static void test_decode_adobe_cmyk(void)
 {
     IWICBitmapDecoder *decoder;
@@ -53,6 +117,7 @@ static void test_decode_adobe_cmyk(void)
     HGLOBAL hjpegdata;
     char *jpegdata;
     IStream *jpegstream;
+    LARGE_INTEGER seek;
     GUID guidresult;
     UINT count=0, width=0, height=0;
     BYTE imagedata[5 * 4] = {1};
@@ -121,6 +186,11 @@ static void test_decode_adobe_cmyk(void)
                     broken(IsEqualGUID(&guidresult, &GUID_WICPixelFormat24bppBGR)), /* xp/2003 */
                     "unexpected pixel format: %s\n", wine_dbgstr_guid(&guidresult));
 
+                /* Moving the stream after Initialize must not affect decoding. */
+                seek.QuadPart = 0;
+                hr = IStream_Seek(jpegstream, seek, STREAM_SEEK_SET, NULL);
+                ok(hr == S_OK, "Seek failed, hr=%x\n", hr);
+
                 /* We want to be sure our state tracking will not impact output
                  * data on subsequent calls */
                 for(i=2; i>0; --i)
@@ -132,6 +202,8 @@ static void test_decode_adobe_cmyk(void)
                             "unexpected image data\n");
                 }
 
+                test_source_transform(framedecode, imagedata, sizeof(imagedata));
+
                 hr = IWICImagingFactory_CreatePalette(factory, &palette);
                 ok(SUCCEEDED(hr), "CreatePalette failed, hr=%x\n", hr);
 
@@ -154,12 +226,95 @@ static void test_decode_adobe_cmyk(void)
     IWICImagingFactory_Release(factory);
 }
 
+static void test_scaler_quarter_size(void)
+{
+    static const BYTE expected[4 * 4] =
+    {
+        0x20, 0x20, 0x60, 0x60,
+        0x20, 0x20, 0x60, 0x60,
+        0xa0, 0xa0, 0xe0, 0xe0,
+        0xa0, 0xa0, 0xe0, 0xe0,
+    };
+    IWICBitmapFrameDecode *framedecode;
+    IWICImagingFactory *factory;
+    IWICBitmapDecoder *decoder;
+    IWICBitmapScaler *scaler;
+    IStream *jpegstream;
+    HGLOBAL hjpegdata;
+    char *jpegdata;
+    UINT width, height, i;
+    BYTE buf[4 * 4];
+    WICRect rc;
+    HRESULT hr;
+
+    hr = CoCreateInstance(&CLSID_WICJpegDecoder, NULL, CLSCTX_INPROC_SERVER,
+        &IID_IWICBitmapDecoder, (void **)&decoder);
+    ok(SUCCEEDED(hr), "CoCreateInstance failed, hr=%x\n", hr);
+    if (FAILED(hr)) return;
+
+    hr = CoCreateInstance(&CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER,
+        &IID_IWICImagingFactory, (void **)&factory);
+    ok(SUCCEEDED(hr), "CoCreateInstance failed, hr=%x\n", hr);
+
+    hjpegdata = GlobalAlloc(GMEM_MOVEABLE, sizeof(jpeg_gray_16x16));
+    jpegdata = GlobalLock(hjpegdata);
+    memcpy(jpegdata, jpeg_gray_16x16, sizeof(jpeg_gray_16x16));
+    GlobalUnlock(hjpegdata);
+
+    hr = CreateStreamOnHGlobal(hjpegdata, FALSE, &jpegstream);
+    ok(SUCCEEDED(hr), "CreateStreamOnHGlobal failed, hr=%x\n", hr);
+
+    hr = IWICBitmapDecoder_Initialize(decoder, jpegstream, WICDecodeMetadataCacheOnLoad);
+    ok(hr == S_OK, "Initialize failed, hr=%x\n", hr);
+
+    hr = IWICBitmapDecoder_GetFrame(decoder, 0, &framedecode);
+    ok(SUCCEEDED(hr), "GetFrame failed, hr=%x\n", hr);
+
+    /* The decoder can produce the 4x4 image directly, so the scaler reads it
+     * through IWICBitmapSourceTransform instead of decoding at full size. */
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "Failed to create bitmap scaler, hr %#x.\n", hr);
+
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)framedecode, 4, 4,
+        WICBitmapInterpolationModeFant);
+    ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#x.\n", hr);
+
+    width = height = 0;
+    hr = IWICBitmapScaler_GetSize(scaler, &width, &height);
+    ok(hr == S_OK, "Failed to get size, hr %#x.\n", hr);
+    ok(width == 4 && height == 4, "Unexpected size %ux%u.\n", width, height);
+
+    memset(buf, 0, sizeof(buf));
+    hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 4, sizeof(buf), buf);
+    ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+    for (i = 0; i < sizeof(buf); i++)
+        ok(abs(buf[i] - expected[i]) <= 1, "pixel %u: got %#x, expected %#x.\n", i, buf[i], expected[i]);
+
+    rc.X = 1;
+    rc.Y = 1;
+    rc.Width = 2;
+    rc.Height = 2;
+    memset(buf, 0, sizeof(buf));
+    hr = IWICBitmapScaler_CopyPixels(scaler, &rc, 2, sizeof(buf), buf);
+    ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+    for (i = 0; i < 4; i++)
+        ok(abs(buf[i] - expected[(1 + i / 2) * 4 + 1 + i % 2]) <= 1, "pixel %u: got %#x, expected %#x.\n",
+            i, buf[i], expected[(1 + i / 2) * 4 + 1 + i % 2]);
+
+    IWICBitmapScaler_Release(scaler);
+    IWICBitmapFrameDecode_Release(framedecode);
+    IStream_Release(jpegstream);
+    GlobalFree(hjpegdata);
+    IWICBitmapDecoder_Release(decoder);
+    IWICImagingFactory_Release(factory);
+}
 
 START_TEST(jpegformat)
 {
     CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
 
     test_decode_adobe_cmyk();
+    test_scaler_quarter_size();
 
     CoUninitialize();
 }
@@ -837,7 +837,7 @@ static void adapter_vk_uninit_3d(struct wined3d_device *device)
     wined3d_context_vk_cleanup(context_vk);
 }
 
-static void *wined3d_bo_vk_map(struct wined3d_bo_vk *bo, struct wined3d_context_vk *context_vk)
+void *wined3d_bo_vk_map(struct wined3d_bo_vk *bo, struct wined3d_context_vk *context_vk)
 {
     const struct wined3d_vk_info *vk_info;
     struct wined3d_device_vk *device_vk;
@@ -954,7 +954,8 @@ static void *adapter_vk_map_bo_address(struct wined3d_context *context,
 
     if ((map_flags & WINED3D_MAP_DISCARD) && bo->command_buffer_id > context_vk->completed_command_buffer_id)
     {
-        if (wined3d_context_vk_create_bo(context_vk, bo->size, bo->usage, bo->memory_type, &tmp))
+        if (wined3d_context_vk_create_ring_bo(context_vk, bo->size, bo->usage, bo->memory_type, &tmp)
+                || wined3d_context_vk_create_bo(context_vk, bo->size, bo->usage, bo->memory_type, &tmp))
         {
             list_move_head(&tmp.users, &bo->users);
             wined3d_context_vk_destroy_bo(context_vk, bo);
@@ -1007,6 +1008,8 @@ static void *adapter_vk_map_bo_address(struct wined3d_context *context,
         wined3d_context_vk_reference_bo(context_vk, bo);
     }
 
+    if (bo->command_buffer_id > context_vk->completed_command_buffer_id)
+        ++context_vk->stream_stats.stalls;
     if (bo->command_buffer_id == context_vk->current_command_buffer.id)
         wined3d_context_vk_submit_command_buffer(context_vk, 0, NULL, NULL, 0, NULL);
     wined3d_context_vk_wait_command_buffer(context_vk, bo->command_buffer_id);
@@ -28,6 +28,7 @@
 #include "wined3d_private.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 
 VkCompareOp vk_compare_op_from_wined3d(enum wined3d_cmp_func op)
 {
@@ -491,6 +492,7 @@ BOOL wined3d_context_vk_create_bo(struct wined3d_context_vk *context_vk, VkDevic
     list_init(&bo->users);
     bo->command_buffer_id = 0;
     bo->slab = NULL;
+    bo->ring_allocation_id = 0;
 
     TRACE("Created buffer 0x%s, memory 0x%s for bo %p.\n",
             wine_dbgstr_longlong(bo->vk_buffer), wine_dbgstr_longlong(bo->vk_memory), bo);
@@ -498,6 +500,224 @@ BOOL wined3d_context_vk_create_bo(struct wined3d_context_vk *context_vk, VkDevic
     return TRUE;
 }
 
+static void wined3d_context_vk_trace_stream_stats(const struct wined3d_context_vk *context_vk)
+{
+    const struct wined3d_bo_stream_stats_vk *stats = &context_vk->stream_stats;
+
+    TRACE_(d3d_perf)("Streamed %s bytes in %u ring allocations, %u fallbacks, %u stalls.\n",
+            wine_dbgstr_longlong(stats->bytes_streamed), stats->allocations, stats->fallbacks, stats->stalls);
+}
+
+static struct wined3d_bo_ring_vk *wined3d_context_vk_get_bo_ring(struct wined3d_context_vk *context_vk)
+{
+    struct wined3d_bo_ring_vk *ring;
+
+    if ((ring = context_vk->bo_ring))
+        return ring;
+
+    /* The ring is only useful if it can stay mapped, and we only keep
+     * persistent mappings around when we have the address space for it. */
+    if (sizeof(void *) < sizeof(uint64_t) || context_vk->bo_ring_failed)
+        return NULL;
+
+    /* Don't retry on every discard map if the ring can't be created, e.g.
+     * because the device has no memory type that is both device local and
+     * host visible. */
+    context_vk->bo_ring_failed = true;
+
+    if (!(ring = heap_alloc_zero(sizeof(*ring))))
+    {
+        ERR("Failed to allocate bo ring.\n");
+        return NULL;
+    }
+
+    if (!wined3d_context_vk_create_bo(context_vk, WINED3D_BO_RING_VK_SIZE, WINED3D_BO_RING_VK_USAGE,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, &ring->bo))
+    {
+        WARN("Failed to create ring bo, not using a bo ring.\n");
+        heap_free(ring);
+        return NULL;
+    }
+
+    if (!wined3d_bo_vk_map(&ring->bo, context_vk))
+    {
+        ERR("Failed to map ring bo.\n");
+        wined3d_context_vk_destroy_bo(context_vk, &ring->bo);
+        heap_free(ring);
+        return NULL;
+    }
+    context_vk->bo_ring_failed = false;
+    ring->next_allocation_id = 1;
+
+    TRACE("Created bo ring %p.\n", ring);
+
+    return context_vk->bo_ring = ring;
+}
+
+/* Allocations are normally released in about the order they were made, so
+ * this mostly behaves like a ring buffer. Released allocations are
+ * reclaimed in any order though, and allocating skips over allocations
+ * that are still in use, so a single long-lived bo can't stall the ring. */
+static bool wined3d_bo_ring_vk_allocate(struct wined3d_bo_ring_vk *ring, struct wined3d_context_vk *context_vk,
+        VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *offset)
+{
+    uint64_t completed_id = context_vk->completed_command_buffer_id;
+    struct wined3d_bo_ring_allocation_vk *allocation;
+    SIZE_T i, j, count;
+    VkDeviceSize start;
+    bool wrapped;
+
+    for (i = 0, j = 0; i < ring->allocation_count; ++i)
+    {
+        allocation = &ring->allocations[i];
+        if (allocation->released && allocation->command_buffer_id <= completed_id)
+            continue;
+        if (i != j)
+            ring->allocations[j] = *allocation;
+        ++j;
+    }
+    if (!(ring->allocation_count = count = j))
+        ring->head = 0;
+
+    start = (ring->head + (alignment - 1)) & ~(alignment - 1);
+    for (i = 0; i < count && ring->allocations[i].end <= start; ++i);
+    wrapped = false;
+    while (start + size > (i < count ? ring->allocations[i].start : ring->bo.size))
+    {
+        if (i < count)
+        {
+            start = (ring->allocations[i++].end + (alignment - 1)) & ~(alignment - 1);
+            continue;
+        }
+        if (wrapped)
+            return false;
+        wrapped = true;
+        start = 0;
+        i = 0;
+        wined3d_context_vk_trace_stream_stats(context_vk);
+    }
+
+    if (!wined3d_array_reserve((void **)&ring->allocations, &ring->allocations_size,
+            count + 1, sizeof(*ring->allocations)))
+    {
+        ERR("Failed to reserve ring allocation.\n");
+        return false;
+    }
+
+    memmove(&ring->allocations[i + 1], &ring->allocations[i], (count - i) * sizeof(*ring->allocations));
+    ++ring->allocation_count;
+    allocation = &ring->allocations[i];
+    allocation->id = ring->next_allocation_id++;
+    allocation->start = start;
+    allocation->end = start + size;
+    allocation->command_buffer_id = 0;
+    allocation->released = false;
+    ring->head = allocation->end;
+    *offset = start;
+
+    return true;
+}
+
+static void wined3d_bo_ring_vk_release(struct wined3d_bo_ring_vk *ring, uint64_t id,
+        VkDeviceSize start, uint64_t command_buffer_id)
+{
+    struct wined3d_bo_ring_allocation_vk *allocation;
+    SIZE_T l = 0, r = ring->allocation_count, m;
+
+    while (l < r)
+    {
+        m = l + (r - l) / 2;
+        allocation = &ring->allocations[m];
+        if (allocation->start == start)
+        {
+            if (allocation->id != id)
+                break;
+            allocation->command_buffer_id = command_buffer_id;
+            allocation->released = true;
+            return;
+        }
+        if (allocation->start < start)
+            l = m + 1;
+        else
+            r = m;
+    }
+
+    ERR("Invalid ring allocation id 0x%s.\n", wine_dbgstr_longlong(id));
+}
+
+/* Suballocate "bo" from the context's streaming ring. This is used for
+ * renaming busy buffers on WINED3D_MAP_DISCARD; the ring is persistently
+ * mapped, and regions are only reused once the command buffers that
+ * referenced them have completed. */
+bool wined3d_context_vk_create_ring_bo(struct wined3d_context_vk *context_vk, VkDeviceSize size,
+        VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_type, struct wined3d_bo_vk *bo)
+{
+    const struct wined3d_adapter_vk *adapter_vk = wined3d_adapter_vk(context_vk->c.device->adapter);
+    const VkPhysicalDeviceLimits *limits = &adapter_vk->device_limits;
+    struct wined3d_bo_ring_vk *ring;
+    VkDeviceSize alignment, offset;
+
+    if ((usage & ~WINED3D_BO_RING_VK_USAGE) || !(memory_type & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+            || !size || size > WINED3D_BO_RING_VK_SIZE / 4)
+        return false;
+
+    if (!(ring = wined3d_context_vk_get_bo_ring(context_vk)))
+        return false;
+
+    /* The ring is device local, which doesn't imply e.g. host cached memory
+     * for readback. */
+    if ((ring->bo.memory_type & memory_type) != memory_type)
+        return false;
+
+    alignment = WINED3D_SLAB_BO_MIN_OBJECT_ALIGN;
+    if ((usage & (VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT))
+            && limits->minTexelBufferOffsetAlignment > alignment)
+        alignment = limits->minTexelBufferOffsetAlignment;
+    if ((usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) && limits->minUniformBufferOffsetAlignment > alignment)
+        alignment = limits->minUniformBufferOffsetAlignment;
+
+    if (!wined3d_bo_ring_vk_allocate(ring, context_vk, size, alignment, &offset))
+    {
+        wined3d_context_vk_poll_command_buffers(context_vk);
+        if (!wined3d_bo_ring_vk_allocate(ring, context_vk, size, alignment, &offset))
+        {
+            TRACE("Bo ring %p is full.\n", ring);
+            ++context_vk->stream_stats.fallbacks;
+            return false;
+        }
+    }
+
+    *bo = ring->bo;
+    bo->memory = NULL;
+    bo->ring_allocation_id = ring->next_allocation_id - 1;
+    bo->buffer_offset = ring->bo.buffer_offset + offset;
+    bo->memory_offset = ring->bo.memory_offset + offset;
+    bo->size = size;
+    bo->usage = usage;
+    bo->memory_type = memory_type;
+    list_init(&bo->users);
+    bo->command_buffer_id = 0;
+
+    context_vk->stream_stats.bytes_streamed += size;
+    ++context_vk->stream_stats.allocations;
+
+    TRACE("Using buffer 0x%s, offset 0x%s from ring %p for bo %p.\n",
+            wine_dbgstr_longlong(bo->vk_buffer), wine_dbgstr_longlong(bo->buffer_offset), ring, bo);
+
+    return true;
+}
+
+static void wined3d_context_vk_destroy_bo_ring(struct wined3d_context_vk *context_vk)
+{
+    struct wined3d_bo_ring_vk *ring = context_vk->bo_ring;
+
+    wined3d_context_vk_trace_stream_stats(context_vk);
+    wined3d_context_vk_destroy_bo(context_vk, &ring->bo);
+    heap_free(ring->allocations);
+    heap_free(ring);
+    context_vk->bo_ring = NULL;
+}
+
 static struct wined3d_retired_object_vk *wined3d_context_vk_get_retired_object_vk(struct wined3d_context_vk *context_vk)
 {
     struct wined3d_retired_objects_vk *retired = &context_vk->retired;
@@ -798,6 +1018,13 @@ void wined3d_context_vk_destroy_bo(struct wined3d_context_vk *context_vk, const
 
     TRACE("context_vk %p, bo %p.\n", context_vk, bo);
 
+    if (bo->ring_allocation_id)
+    {
+        wined3d_bo_ring_vk_release(context_vk->bo_ring, bo->ring_allocation_id,
+                bo->buffer_offset - context_vk->bo_ring->bo.buffer_offset, bo->command_buffer_id);
+        return;
+    }
+
     if (bo->slab)
     {
         object_size = bo->slab->bo.size / 32;
@@ -1297,6 +1524,8 @@ void wined3d_context_vk_cleanup(struct wined3d_context_vk *context_vk)
     if (context_vk->vk_framebuffer)
         VK_CALL(vkDestroyFramebuffer(device_vk->vk_device, context_vk->vk_framebuffer, NULL));
     VK_CALL(vkDestroyCommandPool(device_vk->vk_device, context_vk->vk_command_pool, NULL));
+    if (context_vk->bo_ring)
+        wined3d_context_vk_destroy_bo_ring(context_vk);
     wined3d_context_vk_cleanup_resources(context_vk);
     wined3d_context_vk_destroy_query_pools(context_vk, &context_vk->free_occlusion_query_pools);
     wined3d_context_vk_destroy_query_pools(context_vk, &context_vk->free_timestamp_query_pools);
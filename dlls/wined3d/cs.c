@@ -18,9 +18,13 @@
 
 #include "config.h"
 #include "wine/port.h"
+
+#include <stdlib.h>
+
 #include "wined3d_private.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 WINE_DECLARE_DEBUG_CHANNEL(fps);
 
 #define WINED3D_INITIAL_CS_SIZE 4096
@@ -519,6 +523,28 @@ static void wined3d_cs_exec_nop(struct wined3d_cs *cs, const void *data)
 {
 }
 
+static int wined3d_frame_time_compare(const void *a, const void *b)
+{
+    float t1 = *(const float *)a, t2 = *(const float *)b;
+
+    return t1 < t2 ? -1 : t1 > t2;
+}
+
+static void wined3d_swapchain_trace_frame_times(struct wined3d_swapchain *swapchain)
+{
+    unsigned int count = swapchain->frame_time_count;
+    float *times = swapchain->frame_times;
+
+    if (!count)
+        return;
+
+    qsort(times, count, sizeof(*times), wined3d_frame_time_compare);
+    TRACE_(fps)("%p frame times: p50 %.2fms, p90 %.2fms, p99 %.2fms, max %.2fms over %u frames\n",
+            swapchain, times[count / 2], times[count * 9 / 10], times[count * 99 / 100],
+            times[count - 1], count);
+    swapchain->frame_time_count = 0;
+}
+
 static void wined3d_cs_exec_present(struct wined3d_cs *cs, const void *data)
 {
     struct wined3d_texture *logo_texture, *cursor_texture, *back_buffer;
@@ -585,13 +611,25 @@ static void wined3d_cs_exec_present(struct wined3d_cs *cs, const void *data)
     if (TRACE_ON(fps))
     {
         DWORD time = GetTickCount();
+        LARGE_INTEGER now, freq;
         ++swapchain->frames;
 
+        QueryPerformanceCounter(&now);
+        if (swapchain->prev_present.QuadPart
+                && swapchain->frame_time_count < ARRAY_SIZE(swapchain->frame_times))
+        {
+            QueryPerformanceFrequency(&freq);
+            swapchain->frame_times[swapchain->frame_time_count++]
+                    = 1000.0f * (now.QuadPart - swapchain->prev_present.QuadPart) / freq.QuadPart;
+        }
+        swapchain->prev_present = now;
+
         /* every 1.5 seconds */
         if (time - swapchain->prev_time > 1500)
         {
             TRACE_(fps)("%p @ approx %.2ffps\n",
                     swapchain, 1000.0 * swapchain->frames / (time - swapchain->prev_time));
+            wined3d_swapchain_trace_frame_times(swapchain);
             swapchain->prev_time = time;
             swapchain->frames = 0;
         }
@@ -2432,11 +2470,48 @@ done:
     wined3d_resource_release(resource);
 }
 
+static size_t wined3d_cs_get_update_size(const struct wined3d_resource *resource, const struct wined3d_box *box,
+        unsigned int row_pitch, unsigned int slice_pitch)
+{
+    const struct wined3d_format *format = resource->format;
+    unsigned int row_size, row_count, unused;
+
+    if (resource->type == WINED3D_RTYPE_BUFFER)
+        return box->right - box->left;
+
+    wined3d_format_calculate_pitch(format, 1, box->right - box->left, box->bottom - box->top, &row_size, &unused);
+    row_count = (box->bottom - box->top + format->block_height - 1) / format->block_height;
+
+    return (size_t)(box->back - box->front - 1) * slice_pitch + (size_t)(row_count - 1) * row_pitch + row_size;
+}
+
 void wined3d_cs_emit_update_sub_resource(struct wined3d_cs *cs, struct wined3d_resource *resource,
         unsigned int sub_resource_idx, const struct wined3d_box *box, const void *data, unsigned int row_pitch,
         unsigned int slice_pitch)
 {
     struct wined3d_cs_update_sub_resource *op;
+    size_t size;
+
+    /* For small updates, copying the data into the packet is cheaper than
+     * waiting for the CS thread to read it. */
+    if (cs->thread && (size = wined3d_cs_get_update_size(resource, box, row_pitch, slice_pitch))
+            <= WINED3D_CS_UPDATE_COPY_SIZE)
+    {
+        op = wined3d_cs_require_space(cs, sizeof(*op) + size, WINED3D_CS_QUEUE_MAP);
+        op->opcode = WINED3D_CS_OP_UPDATE_SUB_RESOURCE;
+        op->resource = resource;
+        op->sub_resource_idx = sub_resource_idx;
+        op->box = *box;
+        op->data.row_pitch = row_pitch;
+        op->data.slice_pitch = slice_pitch;
+        op->data.data = op + 1;
+        memcpy(op + 1, data, size);
+
+        wined3d_resource_acquire(resource);
+
+        wined3d_cs_submit(cs, WINED3D_CS_QUEUE_MAP);
+        return;
+    }
 
     op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_MAP);
     op->opcode = WINED3D_CS_OP_UPDATE_SUB_RESOURCE;
@@ -2450,8 +2525,7 @@ void wined3d_cs_emit_update_sub_resource(struct wined3d_cs *cs, struct wined3d_r
     wined3d_resource_acquire(resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_MAP);
-    /* The data pointer may go away, so we need to wait until it is read.
-     * Copying the data may be faster if it's small. */
+    /* The data pointer may go away, so we need to wait until it is read. */
     wined3d_cs_finish(cs, WINED3D_CS_QUEUE_MAP);
 }
 
@@ -2697,6 +2771,30 @@ static BOOL wined3d_cs_queue_is_empty(const struct wined3d_cs *cs, const struct
     return *(volatile LONG *)&queue->head == queue->tail;
 }
 
+static LONG64 wined3d_cs_get_time(void)
+{
+    LARGE_INTEGER counter;
+
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+static void wined3d_cs_trace_stats(struct wined3d_cs *cs)
+{
+    const struct wined3d_cs_stats *stats = &cs->stats;
+    LARGE_INTEGER freq;
+
+    QueryPerformanceFrequency(&freq);
+    TRACE_(d3d_perf)("%p: %u packets, max queue depth %lu, queue sizes %lu/%lu, %u grows, "
+            "producer stall %.2fms, consumer idle %.2fms, %u sleeps, spin limit %u.\n",
+            cs, stats->packet_count, (unsigned long)stats->max_queue_depth,
+            (unsigned long)cs->queue[WINED3D_CS_QUEUE_DEFAULT].size,
+            (unsigned long)cs->queue[WINED3D_CS_QUEUE_MAP].size, stats->grow_count,
+            1000.0 * stats->producer_stall_time / freq.QuadPart,
+            1000.0 * stats->consumer_idle_time / freq.QuadPart,
+            stats->sleep_count, cs->spin_limit);
+}
+
 static void wined3d_cs_queue_submit(struct wined3d_cs_queue *queue, struct wined3d_cs *cs)
 {
     struct wined3d_cs_packet *packet;
@@ -2704,10 +2802,19 @@ static void wined3d_cs_queue_submit(struct wined3d_cs_queue *queue, struct wined
 
     packet = (struct wined3d_cs_packet *)&queue->data[queue->head];
     packet_size = FIELD_OFFSET(struct wined3d_cs_packet, data[packet->size]);
-    InterlockedExchange(&queue->head, (queue->head + packet_size) & (WINED3D_CS_QUEUE_SIZE - 1));
+    InterlockedExchange(&queue->head, (queue->head + packet_size) & (queue->size - 1));
+
+    if (cs->collect_stats)
+    {
+        SIZE_T depth = (queue->head - *(volatile LONG *)&queue->tail) & (queue->size - 1);
+
+        ++cs->stats.packet_count;
+        if (depth > cs->stats.max_queue_depth)
+            cs->stats.max_queue_depth = depth;
+    }
 
     if (InterlockedCompareExchange(&cs->waiting_for_event, FALSE, TRUE))
-        SetEvent(cs->event);
+        RtlWakeAddressSingle(&cs->waiting_for_event);
 }
 
 static void wined3d_cs_mt_submit(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
@@ -2718,24 +2825,149 @@ static void wined3d_cs_mt_submit(struct wined3d_cs *cs, enum wined3d_cs_queue_id
     wined3d_cs_queue_submit(&cs->queue[queue_id], cs);
 }
 
+struct wined3d_cs_wait
+{
+    unsigned int spin_count;
+    LONG64 start;
+};
+
+/* Waits for the CS thread to move the tail of "queue" away from "tail".
+ * Consumption is usually quick, so spin for a while before going to sleep;
+ * wined3d_cs_run() wakes us up when "waiting_for_space" is set. */
+static void wined3d_cs_queue_wait(struct wined3d_cs *cs, struct wined3d_cs_queue *queue,
+        LONG tail, struct wined3d_cs_wait *wait)
+{
+    if (cs->collect_stats && !wait->start)
+        wait->start = wined3d_cs_get_time();
+
+    if (wait->spin_count < WINED3D_CS_WAIT_SPIN_COUNT)
+    {
+        ++wait->spin_count;
+        wined3d_pause();
+        return;
+    }
+
+    InterlockedIncrement(&cs->waiting_for_space);
+    if (*(volatile LONG *)&queue->tail == tail)
+        RtlWaitOnAddress(&queue->tail, &tail, sizeof(tail), NULL);
+    InterlockedDecrement(&cs->waiting_for_space);
+}
+
+static void wined3d_cs_wait_done(struct wined3d_cs *cs, const struct wined3d_cs_wait *wait)
+{
+    if (wait->start)
+        cs->stats.producer_stall_time += wined3d_cs_get_time() - wait->start;
+}
+
+/* Called when a packet doesn't fit in the free space of "queue". Returns
+ * whether the queue has been filling up for a while, rather than for a
+ * single burst, which is better handled by waiting. */
+static BOOL wined3d_cs_queue_stalled(struct wined3d_cs_queue *queue)
+{
+    DWORD now = GetTickCount();
+
+    if (queue->stall_count && now - queue->stall_time < WINED3D_CS_QUEUE_STALL_GAP)
+        return FALSE;
+    if (!queue->stall_count || now - queue->stall_start > WINED3D_CS_QUEUE_STALL_INTERVAL)
+    {
+        queue->stall_start = now;
+        queue->stall_count = 0;
+    }
+    queue->stall_time = now;
+
+    if (++queue->stall_count < WINED3D_CS_QUEUE_GROW_STALLS)
+        return FALSE;
+    queue->stall_count = 0;
+    return TRUE;
+}
+
+/* Replaces the queue data with a larger buffer. This waits for the CS thread
+ * to drain the queue; once head and tail meet the CS thread doesn't access
+ * the data until the next submit, which publishes the new buffer. The head
+ * position stays valid, since the buffer grows. */
+static BOOL wined3d_cs_queue_grow(struct wined3d_cs *cs, struct wined3d_cs_queue *queue, size_t size)
+{
+    struct wined3d_cs_wait wait = {0};
+    SIZE_T new_size = queue->size * 2;
+    BYTE *data;
+    LONG tail;
+
+    while (new_size <= size)
+        new_size *= 2;
+    if (new_size > WINED3D_CS_QUEUE_MAX_SIZE || !(data = heap_alloc(new_size)))
+        return FALSE;
+
+    TRACE("Growing queue %p from %lu to %lu bytes.\n", queue, (unsigned long)queue->size, (unsigned long)new_size);
+
+    while ((tail = *(volatile LONG *)&queue->tail) != queue->head)
+        wined3d_cs_queue_wait(cs, queue, tail, &wait);
+    wined3d_cs_wait_done(cs, &wait);
+
+    heap_free(queue->data);
+    queue->data = data;
+    queue->size = new_size;
+    queue->resize_time = GetTickCount();
+    ++cs->stats.grow_count;
+
+    return TRUE;
+}
+
+/* Halves the size of an empty queue that hasn't stalled for a while, so that
+ * a past burst doesn't keep a large queue around. The head has to stay
+ * within the smaller buffer. */
+static void wined3d_cs_queue_shrink(struct wined3d_cs_queue *queue)
+{
+    SIZE_T new_size = queue->size / 2;
+    DWORD now = GetTickCount();
+    BYTE *data;
+
+    if (now - queue->resize_time < WINED3D_CS_QUEUE_SHRINK_DELAY
+            || now - queue->stall_time < WINED3D_CS_QUEUE_SHRINK_DELAY
+            || queue->head >= new_size || !(data = heap_alloc(new_size)))
+        return;
+
+    TRACE("Shrinking queue %p from %lu to %lu bytes.\n", queue, (unsigned long)queue->size, (unsigned long)new_size);
+
+    heap_free(queue->data);
+    queue->data = data;
+    queue->size = new_size;
+    queue->resize_time = now;
+}
+
 static void *wined3d_cs_queue_require_space(struct wined3d_cs_queue *queue, size_t size, struct wined3d_cs *cs)
 {
-    size_t queue_size = ARRAY_SIZE(queue->data);
-    size_t header_size, packet_size, remaining;
+    size_t header_size, packet_size, remaining, used;
+    struct wined3d_cs_wait wait = {0};
     struct wined3d_cs_packet *packet;
 
     header_size = FIELD_OFFSET(struct wined3d_cs_packet, data[0]);
     packet_size = FIELD_OFFSET(struct wined3d_cs_packet, data[size]);
     packet_size = (packet_size + header_size - 1) & ~(header_size - 1);
     size = packet_size - header_size;
-    if (packet_size >= WINED3D_CS_QUEUE_SIZE)
+
+    remaining = queue->size - queue->head;
+    used = (queue->head - *(volatile LONG *)&queue->tail) & (queue->size - 1);
+    /* The packet doesn't fit in the free space, which includes the part
+     * skipped when wrapping around. A queue that keeps filling up is too
+     * small for the application, so grow it instead of waiting, up to
+     * WINED3D_CS_QUEUE_MAX_SIZE. Packets larger than the queue always need
+     * a larger one. */
+    if (used + packet_size + (remaining < packet_size ? remaining : 0) >= queue->size)
     {
-        ERR("Packet size %lu >= queue size %u.\n",
-                (unsigned long)packet_size, WINED3D_CS_QUEUE_SIZE);
-        return NULL;
+        if ((packet_size >= queue->size || wined3d_cs_queue_stalled(queue))
+                && !wined3d_cs_queue_grow(cs, queue, packet_size) && packet_size >= queue->size)
+        {
+            ERR("Packet size %lu >= queue size %lu.\n",
+                    (unsigned long)packet_size, (unsigned long)queue->size);
+            return NULL;
+        }
+    }
+    else if (!used && queue->size > WINED3D_CS_QUEUE_SIZE && packet_size < queue->size / 2)
+    {
+        wined3d_cs_queue_shrink(queue);
     }
 
-    remaining = queue_size - queue->head;
+    remaining = queue->size - queue->head;
     if (remaining < packet_size)
     {
         size_t nop_size = remaining - header_size;
@@ -2761,7 +2993,7 @@ static void *wined3d_cs_queue_require_space(struct wined3d_cs_queue *queue, size
         /* Empty. */
         if (head == tail)
             break;
-        new_pos = (head + packet_size) & (WINED3D_CS_QUEUE_SIZE - 1);
+        new_pos = (head + packet_size) & (queue->size - 1);
         /* Head ahead of tail. We checked the remaining size above, so we only
          * need to make sure we don't make head equal to tail. */
         if (head > tail && (new_pos != tail))
@@ -2773,7 +3005,9 @@ static void *wined3d_cs_queue_require_space(struct wined3d_cs_queue *queue, size
 
         TRACE("Waiting for free space. Head %u, tail %u, packet size %lu.\n",
                 head, tail, (unsigned long)packet_size);
+        wined3d_cs_queue_wait(cs, queue, tail, &wait);
     }
+    wined3d_cs_wait_done(cs, &wait);
 
     packet = (struct wined3d_cs_packet *)&queue->data[queue->head];
     packet->size = size;
@@ -2790,11 +3024,16 @@ static void *wined3d_cs_mt_require_space(struct wined3d_cs *cs, size_t size, enu
 
 static void wined3d_cs_mt_finish(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
 {
+    struct wined3d_cs_queue *queue = &cs->queue[queue_id];
+    struct wined3d_cs_wait wait = {0};
+    LONG tail;
+
     if (cs->thread_id == GetCurrentThreadId())
         return wined3d_cs_st_finish(cs, queue_id);
 
-    while (cs->queue[queue_id].head != *(volatile LONG *)&cs->queue[queue_id].tail)
-        wined3d_pause();
+    while ((tail = *(volatile LONG *)&queue->tail) != queue->head)
+        wined3d_cs_queue_wait(cs, queue, tail, &wait);
+    wined3d_cs_wait_done(cs, &wait);
 }
 
 static const struct wined3d_cs_ops wined3d_cs_mt_ops =
@@ -2822,6 +3061,8 @@ static void poll_queries(struct wined3d_cs *cs)
 
 static void wined3d_cs_wait_event(struct wined3d_cs *cs)
 {
+    static const LONG waiting = TRUE;
+
     InterlockedExchange(&cs->waiting_for_event, TRUE);
 
     /* The main thread might have enqueued a command and blocked on it after
@@ -2829,14 +3070,44 @@ static void wined3d_cs_wait_event(struct wined3d_cs *cs)
      * "waiting_for_event" was set.
      *
      * Likewise, we can race with the main thread when resetting
-     * "waiting_for_event", in which case we would need to call
-     * WaitForSingleObject() because the main thread called SetEvent(). */
+     * "waiting_for_event", in which case the main thread already reset it
+     * and RtlWaitOnAddress() returns immediately. */
     if (!(wined3d_cs_queue_is_empty(cs, &cs->queue[WINED3D_CS_QUEUE_DEFAULT])
             && wined3d_cs_queue_is_empty(cs, &cs->queue[WINED3D_CS_QUEUE_MAP]))
             && InterlockedCompareExchange(&cs->waiting_for_event, FALSE, TRUE))
         return;
 
-    WaitForSingleObject(cs->event, INFINITE);
+    while (*(volatile LONG *)&cs->waiting_for_event)
+        RtlWaitOnAddress(&cs->waiting_for_event, &waiting, sizeof(waiting), NULL);
+    ++cs->stats.sleep_count;
+}
+
+static void wined3d_cs_queue_set_tail(struct wined3d_cs *cs, struct wined3d_cs_queue *queue, LONG tail)
+{
+    InterlockedExchange(&queue->tail, tail);
+    if (*(volatile LONG *)&cs->waiting_for_space)
+        RtlWakeAddressAll(&queue->tail);
+}
+
+/* Adjusts the number of iterations the CS thread spins on an empty queue
+ * before going to sleep. When work arrives while spinning, move the limit
+ * towards twice the observed gap; when spinning didn't pay off, halve it. */
+static void wined3d_cs_update_spin_limit(struct wined3d_cs *cs, unsigned int spin_count, BOOL slept)
+{
+    unsigned int target;
+
+    if (slept)
+    {
+        cs->spin_limit = max(cs->spin_limit / 2, WINED3D_CS_SPIN_COUNT_MIN);
+        return;
+    }
+
+    target = min(spin_count, WINED3D_CS_SPIN_COUNT / 2) * 2;
+    if (target > cs->spin_limit)
+        cs->spin_limit += (target - cs->spin_limit) / 8;
+    else
+        cs->spin_limit -= (cs->spin_limit - target) / 8;
+    cs->spin_limit = max(cs->spin_limit, WINED3D_CS_SPIN_COUNT_MIN);
 }
 
 static DWORD WINAPI wined3d_cs_run(void *ctx)
@@ -2848,6 +3119,8 @@ static DWORD WINAPI wined3d_cs_run(void *ctx)
     enum wined3d_cs_op opcode;
     HMODULE wined3d_module;
     unsigned int poll = 0;
+    BOOL slept = FALSE;
+    BYTE *data;
     LONG tail;
 
     TRACE("Started.\n");
@@ -2864,6 +3137,12 @@ static DWORD WINAPI wined3d_cs_run(void *ctx)
         {
             poll_queries(cs);
             poll = 0;
+
+            if (cs->collect_stats && GetTickCount() - cs->stats.prev_time > WINED3D_CS_STATS_INTERVAL)
+            {
+                wined3d_cs_trace_stats(cs);
+                cs->stats.prev_time = GetTickCount();
+            }
         }
 
         queue = &cs->queue[WINED3D_CS_QUEUE_MAP];
@@ -2872,15 +3151,35 @@ static DWORD WINAPI wined3d_cs_run(void *ctx)
             queue = &cs->queue[WINED3D_CS_QUEUE_DEFAULT];
             if (wined3d_cs_queue_is_empty(cs, queue))
             {
-                if (++spin_count >= WINED3D_CS_SPIN_COUNT && list_empty(&cs->query_poll_list))
+                if (cs->collect_stats && !cs->stats.idle_start)
+                    cs->stats.idle_start = wined3d_cs_get_time();
+
+                if (++spin_count >= cs->spin_limit && list_empty(&cs->query_poll_list))
+                {
                     wined3d_cs_wait_event(cs);
+                    wined3d_cs_update_spin_limit(cs, spin_count, TRUE);
+                    spin_count = 0;
+                    slept = TRUE;
+                }
                 continue;
             }
         }
+        if (spin_count && !slept)
+            wined3d_cs_update_spin_limit(cs, spin_count, FALSE);
         spin_count = 0;
+        slept = FALSE;
+
+        if (cs->stats.idle_start)
+        {
+            cs->stats.consumer_idle_time += wined3d_cs_get_time() - cs->stats.idle_start;
+            cs->stats.idle_start = 0;
+        }
 
         tail = queue->tail;
-        packet = (struct wined3d_cs_packet *)&queue->data[tail];
+        /* The data of an empty queue may have been replaced by
+         * wined3d_cs_queue_grow(). */
+        data = *(BYTE *volatile *)&queue->data;
+        packet = (struct wined3d_cs_packet *)&data[tail];
         if (packet->size)
         {
             opcode = *(const enum wined3d_cs_op *)packet->data;
@@ -2898,20 +3197,31 @@ static DWORD WINAPI wined3d_cs_run(void *ctx)
         }
 
         tail += FIELD_OFFSET(struct wined3d_cs_packet, data[packet->size]);
-        tail &= (WINED3D_CS_QUEUE_SIZE - 1);
-        InterlockedExchange(&queue->tail, tail);
+        tail &= (queue->size - 1);
+        wined3d_cs_queue_set_tail(cs, queue, tail);
     }
 
-    cs->queue[WINED3D_CS_QUEUE_MAP].tail = cs->queue[WINED3D_CS_QUEUE_MAP].head;
-    cs->queue[WINED3D_CS_QUEUE_DEFAULT].tail = cs->queue[WINED3D_CS_QUEUE_DEFAULT].head;
+    if (cs->collect_stats)
+        wined3d_cs_trace_stats(cs);
+    wined3d_cs_queue_set_tail(cs, &cs->queue[WINED3D_CS_QUEUE_MAP], cs->queue[WINED3D_CS_QUEUE_MAP].head);
+    wined3d_cs_queue_set_tail(cs, &cs->queue[WINED3D_CS_QUEUE_DEFAULT], cs->queue[WINED3D_CS_QUEUE_DEFAULT].head);
     TRACE("Stopped.\n");
     FreeLibraryAndExitThread(wined3d_module, 0);
 }
 
+static void wined3d_cs_cleanup_queues(struct wined3d_cs *cs)
+{
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(cs->queue); ++i)
+        heap_free(cs->queue[i].data);
+}
+
 struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device)
 {
     const struct wined3d_d3d_info *d3d_info = &device->adapter->d3d_info;
     struct wined3d_cs *cs;
+    unsigned int i;
 
     if (!(cs = heap_alloc_zero(sizeof(*cs))))
         return NULL;
@@ -2929,19 +3239,27 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device)
             && !RtlIsCriticalSectionLockedByThread(NtCurrentTeb()->Peb->LoaderLock))
     {
         cs->ops = &wined3d_cs_mt_ops;
+        cs->spin_limit = WINED3D_CS_SPIN_COUNT_MIN;
+        cs->collect_stats = TRACE_ON(d3d_perf);
+        cs->stats.prev_time = GetTickCount();
 
-        if (!(cs->event = CreateEventW(NULL, FALSE, FALSE, NULL)))
+        for (i = 0; i < ARRAY_SIZE(cs->queue); ++i)
         {
-            ERR("Failed to create command stream event.\n");
-            heap_free(cs->data);
-            goto fail;
+            cs->queue[i].size = WINED3D_CS_QUEUE_SIZE;
+            if (!(cs->queue[i].data = heap_alloc(cs->queue[i].size)))
+            {
+                ERR("Failed to allocate command stream queue.\n");
+                wined3d_cs_cleanup_queues(cs);
+                heap_free(cs->data);
+                goto fail;
+            }
         }
 
         if (!(GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
                 (const WCHAR *)wined3d_cs_run, &cs->wined3d_module)))
         {
             ERR("Failed to get wined3d module handle.\n");
-            CloseHandle(cs->event);
+            wined3d_cs_cleanup_queues(cs);
             heap_free(cs->data);
             goto fail;
         }
@@ -2950,7 +3268,7 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device)
         {
             ERR("Failed to create wined3d command stream thread.\n");
             FreeLibrary(cs->wined3d_module);
-            CloseHandle(cs->event);
+            wined3d_cs_cleanup_queues(cs);
             heap_free(cs->data);
             goto fail;
         }
@@ -2970,8 +3288,7 @@ void wined3d_cs_destroy(struct wined3d_cs *cs)
     {
         wined3d_cs_emit_stop(cs);
         CloseHandle(cs->thread);
-        if (!CloseHandle(cs->event))
-            ERR("Closing event failed.\n");
+        wined3d_cs_cleanup_queues(cs);
     }
 
     state_cleanup(&cs->state);
@@ -34,6 +34,7 @@
 
 #include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
 #ifdef HAVE_FLOAT_H
 # include <float.h>
 #endif
@@ -42,6 +43,7 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d_shader);
 WINE_DECLARE_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 WINE_DECLARE_DEBUG_CHANNEL(winediag);
 
 #define WINED3D_GLSL_SAMPLE_PROJECTED   0x01
@@ -127,6 +129,18 @@ struct constant_heap
     unsigned int size;
 };
 
+struct glsl_program_cache
+{
+    WCHAR *path;
+    UINT64 driver_hash;
+    UINT64 size;
+    UINT64 max_size;
+    unsigned int hits;
+    unsigned int misses;
+    unsigned int stores;
+    BOOL initialised;
+};
+
 /* GLSL shader private data */
 struct shader_glsl_priv
 {
@@ -144,6 +158,13 @@ struct shader_glsl_priv
     struct wine_rb_tree ffp_fragment_shaders;
     BOOL ffp_proj_control;
     BOOL legacy_lighting;
+
+    struct glsl_program_cache program_cache;
+
+    /* Shaders compiled in parallel whose info log hasn't been printed yet. */
+    GLuint *pending_info_logs;
+    SIZE_T pending_info_logs_size;
+    SIZE_T pending_info_log_count;
 };
 
 struct glsl_vs_program
@@ -271,6 +292,14 @@ struct glsl_program_key
     GLuint cs_id;
 };
 
+/* Link state that is not part of the shader sources. */
+struct glsl_program_link_args
+{
+    WORD attribs_map;
+    BYTE vs_major;
+    BYTE dual_source;
+};
+
 struct shader_glsl_ctx_priv
 {
     const struct wined3d_gl_info *gl_info;
@@ -553,7 +582,8 @@ void print_glsl_info_log(const struct wined3d_gl_info *gl_info, GLuint id, BOOL
 }
 
 /* Context activation is done by the caller. */
-static void shader_glsl_compile(const struct wined3d_gl_info *gl_info, GLuint shader, const char *src)
+static void shader_glsl_compile(struct shader_glsl_priv *priv, const struct wined3d_gl_info *gl_info,
+        GLuint shader, const char *src)
 {
     const char *ptr, *line;
 
@@ -569,7 +599,55 @@ static void shader_glsl_compile(const struct wined3d_gl_info *gl_info, GLuint sh
     checkGLcall("glShaderSource");
     GL_EXTCALL(glCompileShader(shader));
     checkGLcall("glCompileShader");
-    print_glsl_info_log(gl_info, shader, FALSE);
+    /* Querying the info log waits for the compilation to finish, so with
+     * parallel compilation the log is printed when the shader is linked. */
+    if (!gl_info->supported[ARB_PARALLEL_SHADER_COMPILE] || TRACE_ON(d3d_shader))
+        print_glsl_info_log(gl_info, shader, FALSE);
+    else if ((WARN_ON(d3d_shader) || FIXME_ON(d3d_shader))
+            && wined3d_array_reserve((void **)&priv->pending_info_logs, &priv->pending_info_logs_size,
+            priv->pending_info_log_count + 1, sizeof(*priv->pending_info_logs)))
+        priv->pending_info_logs[priv->pending_info_log_count++] = shader;
+}
+
+/* Prints the info logs of the pending shaders attached to the program, and
+ * forgets the ones that have been deleted in the meantime.
+ *
+ * Context activation is done by the caller. */
+static void shader_glsl_print_pending_info_logs(struct shader_glsl_priv *priv,
+        const struct wined3d_gl_info *gl_info, GLuint program)
+{
+    GLint i, shader_count = 0;
+    GLuint *shaders, shader;
+    SIZE_T j;
+
+    if (!priv->pending_info_log_count)
+        return;
+
+    GL_EXTCALL(glGetProgramiv(program, GL_ATTACHED_SHADERS, &shader_count));
+    if (!(shaders = heap_calloc(shader_count, sizeof(*shaders))))
+        return;
+    GL_EXTCALL(glGetAttachedShaders(program, shader_count, &shader_count, shaders));
+
+    for (j = 0; j < priv->pending_info_log_count;)
+    {
+        shader = priv->pending_info_logs[j];
+        for (i = 0; i < shader_count; ++i)
+        {
+            if (shaders[i] == shader)
+                break;
+        }
+        if (i == shader_count && GL_EXTCALL(glIsShader(shader)))
+        {
+            ++j;
+            continue;
+        }
+        if (i < shader_count)
+            print_glsl_info_log(gl_info, shader, FALSE);
+        priv->pending_info_logs[j] = priv->pending_info_logs[--priv->pending_info_log_count];
+    }
+    checkGLcall("print pending info logs");
+
+    heap_free(shaders);
 }
 
 /* Context activation is done by the caller. */
@@ -7212,7 +7290,7 @@ static GLuint shader_glsl_generate_vs3_rasterizer_input_setup(struct shader_glsl
 
     ret = GL_EXTCALL(glCreateShader(GL_VERTEX_SHADER));
     checkGLcall("glCreateShader(GL_VERTEX_SHADER)");
-    shader_glsl_compile(gl_info, ret, buffer->buffer);
+    shader_glsl_compile(priv, gl_info, ret, buffer->buffer);
 
     return ret;
 }
@@ -7906,7 +7984,7 @@ static GLuint shader_glsl_generate_fragment_shader(const struct wined3d_context_
 
     shader_id = GL_EXTCALL(glCreateShader(GL_FRAGMENT_SHADER));
     TRACE("Compiling shader object %u.\n", shader_id);
-    shader_glsl_compile(gl_info, shader_id, buffer->buffer);
+    shader_glsl_compile(context_gl->c.device->shader_priv, gl_info, shader_id, buffer->buffer);
 
     return shader_id;
 }
@@ -8045,7 +8123,7 @@ static GLuint shader_glsl_generate_vertex_shader(const struct wined3d_context_gl
 
     shader_id = GL_EXTCALL(glCreateShader(GL_VERTEX_SHADER));
     TRACE("Compiling shader object %u.\n", shader_id);
-    shader_glsl_compile(gl_info, shader_id, buffer->buffer);
+    shader_glsl_compile(context_gl->c.device->shader_priv, gl_info, shader_id, buffer->buffer);
 
     return shader_id;
 }
@@ -8181,7 +8259,7 @@ static GLuint shader_glsl_generate_hull_shader(const struct wined3d_context_gl *
 
     shader_id = GL_EXTCALL(glCreateShader(GL_TESS_CONTROL_SHADER));
     TRACE("Compiling shader object %u.\n", shader_id);
-    shader_glsl_compile(gl_info, shader_id, buffer->buffer);
+    shader_glsl_compile(context_gl->c.device->shader_priv, gl_info, shader_id, buffer->buffer);
 
     return shader_id;
 }
@@ -8285,7 +8363,7 @@ static GLuint shader_glsl_generate_domain_shader(const struct wined3d_context_gl
 
     shader_id = GL_EXTCALL(glCreateShader(GL_TESS_EVALUATION_SHADER));
     TRACE("Compiling shader object %u.\n", shader_id);
-    shader_glsl_compile(gl_info, shader_id, buffer->buffer);
+    shader_glsl_compile(context_gl->c.device->shader_priv, gl_info, shader_id, buffer->buffer);
 
     return shader_id;
 }
@@ -8388,7 +8466,7 @@ static GLuint shader_glsl_generate_geometry_shader(const struct wined3d_context_
 
     shader_id = GL_EXTCALL(glCreateShader(GL_GEOMETRY_SHADER));
     TRACE("Compiling shader object %u.\n", shader_id);
-    shader_glsl_compile(gl_info, shader_id, buffer->buffer);
+    shader_glsl_compile(context_gl->c.device->shader_priv, gl_info, shader_id, buffer->buffer);
 
     return shader_id;
 }
@@ -8458,7 +8536,7 @@ static GLuint shader_glsl_generate_compute_shader(const struct wined3d_context_g
 
     shader_id = GL_EXTCALL(glCreateShader(GL_COMPUTE_SHADER));
     TRACE("Compiling shader object %u.\n", shader_id);
-    shader_glsl_compile(gl_info, shader_id, buffer->buffer);
+    shader_glsl_compile(context_gl->c.device->shader_priv, gl_info, shader_id, buffer->buffer);
 
     return shader_id;
 }
@@ -9204,7 +9282,7 @@ static GLuint shader_glsl_generate_ffp_vertex_shader(struct shader_glsl_priv *pr
     shader_addline(buffer, "}\n");
 
     shader_obj = GL_EXTCALL(glCreateShader(GL_VERTEX_SHADER));
-    shader_glsl_compile(gl_info, shader_obj, buffer->buffer);
+    shader_glsl_compile(priv, gl_info, shader_obj, buffer->buffer);
 
     return shader_obj;
 }
@@ -9853,7 +9931,7 @@ static GLuint shader_glsl_generate_ffp_fragment_shader(struct shader_glsl_priv *
     shader_addline(buffer, "}\n");
 
     shader_id = GL_EXTCALL(glCreateShader(GL_FRAGMENT_SHADER));
-    shader_glsl_compile(gl_info, shader_id, buffer->buffer);
+    shader_glsl_compile(priv, gl_info, shader_id, buffer->buffer);
 
     string_buffer_release(&priv->string_buffers, tex_reg_name);
     return shader_id;
@@ -10051,6 +10129,359 @@ static void shader_glsl_init_ps_uniform_locations(const struct wined3d_gl_info *
     string_buffer_release(&priv->string_buffers, name);
 }
 
+#define WINED3D_GLSL_PROGRAM_CACHE_MAGIC    0x50443357  /* "W3DP" */
+#define WINED3D_GLSL_PROGRAM_CACHE_VERSION  1
+/* 16 hex digits and ".bin", plus ".tmp" while an entry is being written. */
+#define WINED3D_GLSL_PROGRAM_CACHE_NAME_LENGTH  (16 + 4)
+#define WINED3D_GLSL_PROGRAM_CACHE_TMP_LENGTH   (WINED3D_GLSL_PROGRAM_CACHE_NAME_LENGTH + 4)
+
+struct glsl_program_cache_header
+{
+    DWORD magic;
+    DWORD version;
+    UINT64 key;
+    GLenum binary_format;
+    DWORD binary_size;
+};
+
+static UINT64 glsl_program_cache_hash(UINT64 hash, const void *data, SIZE_T size)
+{
+    const BYTE *ptr = data;
+
+    /* FNV-1a */
+    while (size--)
+        hash = (hash ^ *ptr++) * 0x100000001b3ull;
+    return hash;
+}
+
+static int glsl_program_cache_compare_hash(const void *a, const void *b)
+{
+    const UINT64 *h1 = a, *h2 = b;
+
+    return *h1 < *h2 ? -1 : *h1 > *h2;
+}
+
+static void glsl_program_cache_get_file_name(const struct glsl_program_cache *cache, UINT64 key, WCHAR *name)
+{
+    static const WCHAR extW[] = {'.','b','i','n',0};
+    static const WCHAR hexW[] = {'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'};
+    unsigned int i;
+
+    lstrcpyW(name, cache->path);
+    name += lstrlenW(name);
+    for (i = 0; i < 16; ++i)
+        *name++ = hexW[(key >> (60 - 4 * i)) & 0xf];
+    lstrcpyW(name, extW);
+}
+
+/* Evict the least recently used entries until the cache fits in its budget. */
+static void glsl_program_cache_trim(struct glsl_program_cache *cache, UINT64 required)
+{
+    static const WCHAR maskW[] = {'*','.','b','i','n',0};
+    WCHAR path[MAX_PATH], oldest_name[MAX_PATH];
+    FILETIME oldest_time = {0};
+    WIN32_FIND_DATAW data;
+    UINT64 oldest_size;
+    HANDLE handle;
+
+    while (cache->size + required > cache->max_size)
+    {
+        lstrcpyW(path, cache->path);
+        lstrcatW(path, maskW);
+        if ((handle = FindFirstFileW(path, &data)) == INVALID_HANDLE_VALUE)
+        {
+            cache->size = 0;
+            return;
+        }
+        oldest_name[0] = 0;
+        oldest_size = 0;
+        cache->size = 0;
+        do
+        {
+            UINT64 size = ((UINT64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+
+            cache->size += size;
+            if (lstrlenW(data.cFileName) != WINED3D_GLSL_PROGRAM_CACHE_NAME_LENGTH)
+                continue;
+            if (!oldest_name[0] || CompareFileTime(&data.ftLastWriteTime, &oldest_time) < 0)
+            {
+                lstrcpynW(oldest_name, data.cFileName, ARRAY_SIZE(oldest_name));
+                oldest_time = data.ftLastWriteTime;
+                oldest_size = size;
+            }
+        } while (FindNextFileW(handle, &data));
+        FindClose(handle);
+
+        if (!oldest_name[0] || cache->size + required <= cache->max_size)
+            return;
+
+        lstrcpyW(path, cache->path);
+        lstrcatW(path, oldest_name);
+        TRACE("Evicting program binary %s.\n", debugstr_w(path));
+        if (!DeleteFileW(path))
+            return;
+        cache->size -= oldest_size;
+    }
+}
+
+/* Context activation is done by the caller. */
+static void glsl_program_cache_init(struct glsl_program_cache *cache, const struct wined3d_gl_info *gl_info)
+{
+    static const WCHAR configdirW[] = {'W','I','N','E','C','O','N','F','I','G','D','I','R',0};
+    static const WCHAR cachedirW[] = {'\\','w','i','n','e','d','3','d','_','c','a','c','h','e','\\',0};
+    static const GLenum strings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION};
+    GLint format_count = 0;
+    unsigned int i;
+    DWORD len;
+
+    cache->initialised = TRUE;
+
+    if (!wined3d_settings.shader_cache_size)
+        return;
+    if (!gl_info->supported[ARB_GET_PROGRAM_BINARY])
+    {
+        TRACE("Program binaries are not supported, not using the program binary cache.\n");
+        return;
+    }
+    gl_info->gl_ops.gl.p_glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if (!format_count)
+    {
+        TRACE("No program binary formats available, not using the program binary cache.\n");
+        return;
+    }
+
+    if (!(len = GetEnvironmentVariableW(configdirW, NULL, 0)))
+        return;
+    if (!(cache->path = heap_alloc((len + ARRAY_SIZE(cachedirW)) * sizeof(WCHAR))))
+        return;
+    GetEnvironmentVariableW(configdirW, cache->path, len);
+    if (cache->path[1] == '?') cache->path[1] = '\\';  /* \??\ prefix */
+    lstrcatW(cache->path, cachedirW);
+    /* Entry names are built in MAX_PATH buffers. */
+    if (lstrlenW(cache->path) + WINED3D_GLSL_PROGRAM_CACHE_TMP_LENGTH >= MAX_PATH)
+    {
+        WARN("Program binary cache path %s is too long, not using the program binary cache.\n",
+                debugstr_w(cache->path));
+        heap_free(cache->path);
+        cache->path = NULL;
+        return;
+    }
+    if (!CreateDirectoryW(cache->path, NULL) && GetLastError() != ERROR_ALREADY_EXISTS)
+    {
+        WARN("Failed to create program binary cache directory %s.\n", debugstr_w(cache->path));
+        heap_free(cache->path);
+        cache->path = NULL;
+        return;
+    }
+
+    /* A driver update invalidates all the binaries, so make it part of the key. */
+    cache->driver_hash = 0xcbf29ce484222325ull;
+    for (i = 0; i < ARRAY_SIZE(strings); ++i)
+    {
+        const char *str = (const char *)gl_info->gl_ops.gl.p_glGetString(strings[i]);
+
+        if (str)
+            cache->driver_hash = glsl_program_cache_hash(cache->driver_hash, str, strlen(str) + 1);
+    }
+
+    cache->max_size = (UINT64)wined3d_settings.shader_cache_size * 1024 * 1024;
+    cache->size = ~(UINT64)0 >> 1;
+    glsl_program_cache_trim(cache, 0);
+
+    TRACE("Using program binary cache %s, %s bytes used.\n",
+            debugstr_w(cache->path), wine_dbgstr_longlong(cache->size));
+}
+
+/* The key covers the driver, the sources of all the attached shaders, and
+ * any state that affects linking but is not part of the sources.
+ *
+ * Context activation is done by the caller. */
+static BOOL glsl_program_cache_get_key(const struct glsl_program_cache *cache,
+        const struct wined3d_gl_info *gl_info, GLuint program_id,
+        const struct glsl_program_link_args *link_args, UINT64 *key)
+{
+    GLint i, shader_count, source_size = 0, tmp;
+    GLuint *shaders = NULL;
+    UINT64 *hashes = NULL;
+    char *source = NULL;
+    BOOL ret = FALSE;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_ATTACHED_SHADERS, &shader_count));
+    if (!(shaders = heap_calloc(shader_count, sizeof(*shaders)))
+            || !(hashes = heap_calloc(shader_count, sizeof(*hashes))))
+        goto done;
+
+    GL_EXTCALL(glGetAttachedShaders(program_id, shader_count, NULL, shaders));
+    for (i = 0; i < shader_count; ++i)
+    {
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &tmp));
+        if (source_size < tmp)
+        {
+            heap_free(source);
+            if (!(source = heap_alloc(tmp)))
+                goto done;
+            source_size = tmp;
+        }
+        GL_EXTCALL(glGetShaderSource(shaders[i], source_size, &tmp, source));
+        hashes[i] = glsl_program_cache_hash(0xcbf29ce484222325ull, source, tmp);
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_TYPE, &tmp));
+        hashes[i] = glsl_program_cache_hash(hashes[i], &tmp, sizeof(tmp));
+    }
+    checkGLcall("get shader sources");
+
+    /* The order in which shaders are returned is unspecified. */
+    qsort(hashes, shader_count, sizeof(*hashes), glsl_program_cache_compare_hash);
+    *key = glsl_program_cache_hash(cache->driver_hash, hashes, shader_count * sizeof(*hashes));
+    *key = glsl_program_cache_hash(*key, link_args, sizeof(*link_args));
+    ret = TRUE;
+
+done:
+    heap_free(source);
+    heap_free(hashes);
+    heap_free(shaders);
+    return ret;
+}
+
+/* Context activation is done by the caller. */
+static BOOL glsl_program_cache_load(struct glsl_program_cache *cache,
+        const struct wined3d_gl_info *gl_info, GLuint program_id, UINT64 key)
+{
+    struct glsl_program_cache_header header;
+    WCHAR name[MAX_PATH];
+    GLint status = 0;
+    void *data = NULL;
+    FILETIME now;
+    HANDLE file;
+    DWORD size;
+
+    glsl_program_cache_get_file_name(cache, key, name);
+    if ((file = CreateFileW(name, GENERIC_READ | FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, 0, NULL)) == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    if (ReadFile(file, &header, sizeof(header), &size, NULL) && size == sizeof(header)
+            && header.magic == WINED3D_GLSL_PROGRAM_CACHE_MAGIC
+            && header.version == WINED3D_GLSL_PROGRAM_CACHE_VERSION && header.key == key
+            && (data = heap_alloc(header.binary_size))
+            && ReadFile(file, data, header.binary_size, &size, NULL) && size == header.binary_size)
+    {
+        GL_EXTCALL(glProgramBinary(program_id, header.binary_format, data, header.binary_size));
+        GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+        checkGLcall("glProgramBinary");
+    }
+    heap_free(data);
+
+    if (status)
+    {
+        /* Keep recently used entries from being evicted. */
+        GetSystemTimeAsFileTime(&now);
+        SetFileTime(file, NULL, NULL, &now);
+    }
+    CloseHandle(file);
+
+    if (!status)
+    {
+        /* Stale or corrupt entry, e.g. from a driver that rejects its own old binaries. */
+        WARN("Discarding unusable program binary %s.\n", debugstr_w(name));
+        DeleteFileW(name);
+    }
+    return status;
+}
+
+/* Context activation is done by the caller. */
+static void glsl_program_cache_store(struct glsl_program_cache *cache,
+        const struct wined3d_gl_info *gl_info, GLuint program_id, UINT64 key)
+{
+    static const WCHAR tmpW[] = {'.','t','m','p',0};
+    struct glsl_program_cache_header header;
+    WCHAR name[MAX_PATH], tmp_name[MAX_PATH];
+    GLint status, length = 0;
+    GLsizei size;
+    HANDLE file;
+    DWORD written;
+    void *data;
+    BOOL ret;
+
+    GL_EXTCALL(glGetProgramiv(program_id, GL_LINK_STATUS, &status));
+    if (!status)
+        return;
+    GL_EXTCALL(glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0 || length > cache->max_size || !(data = heap_alloc(length)))
+        return;
+    GL_EXTCALL(glGetProgramBinary(program_id, length, &size, &header.binary_format, data));
+    checkGLcall("glGetProgramBinary");
+
+    header.magic = WINED3D_GLSL_PROGRAM_CACHE_MAGIC;
+    header.version = WINED3D_GLSL_PROGRAM_CACHE_VERSION;
+    header.key = key;
+    header.binary_size = size;
+
+    glsl_program_cache_trim(cache, sizeof(header) + size);
+
+    /* Write to a private file first, so that other processes never see partial entries. */
+    glsl_program_cache_get_file_name(cache, key, name);
+    lstrcpyW(tmp_name, name);
+    lstrcatW(tmp_name, tmpW);
+    if ((file = CreateFileW(tmp_name, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL)) == INVALID_HANDLE_VALUE)
+    {
+        heap_free(data);
+        return;
+    }
+    ret = WriteFile(file, &header, sizeof(header), &written, NULL) && written == sizeof(header)
+            && WriteFile(file, data, size, &written, NULL) && written == size;
+    CloseHandle(file);
+    heap_free(data);
+
+    if (ret && MoveFileExW(tmp_name, name, MOVEFILE_REPLACE_EXISTING))
+    {
+        cache->size += sizeof(header) + size;
+        ++cache->stores;
+    }
+    else
+    {
+        DeleteFileW(tmp_name);
+    }
+}
+
+/* Link a program, using a previously stored binary if there is one.
+ *
+ * Context activation is done by the caller. */
+static void shader_glsl_link_program(struct shader_glsl_priv *priv, const struct wined3d_gl_info *gl_info,
+        GLuint program_id, const struct glsl_program_link_args *link_args)
+{
+    struct glsl_program_cache *cache = &priv->program_cache;
+    UINT64 key;
+
+    shader_glsl_print_pending_info_logs(priv, gl_info, program_id);
+
+    if (!cache->initialised)
+        glsl_program_cache_init(cache, gl_info);
+
+    if (!cache->path || !link_args
+            || !glsl_program_cache_get_key(cache, gl_info, program_id, link_args, &key))
+    {
+        TRACE("Linking GLSL shader program %u.\n", program_id);
+        GL_EXTCALL(glLinkProgram(program_id));
+        shader_glsl_validate_link(gl_info, program_id);
+        return;
+    }
+
+    if (glsl_program_cache_load(cache, gl_info, program_id, key))
+    {
+        TRACE("Loaded GLSL shader program %u from binary %s.\n", program_id, wine_dbgstr_longlong(key));
+        ++cache->hits;
+        return;
+    }
+    ++cache->misses;
+
+    TRACE("Linking GLSL shader program %u.\n", program_id);
+    GL_EXTCALL(glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    GL_EXTCALL(glLinkProgram(program_id));
+    shader_glsl_validate_link(gl_info, program_id);
+
+    glsl_program_cache_store(cache, gl_info, program_id, key);
+}
+
 static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
         const struct wined3d_context_gl *context_gl, struct wined3d_shader *shader)
 {
@@ -10059,6 +10490,7 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
     struct wined3d_string_buffer *buffer = &priv->shader_buffer;
     struct glsl_cs_compiled_shader *gl_shaders;
     struct glsl_shader_private *shader_data;
+    struct glsl_program_link_args link_args;
     struct glsl_shader_prog_link *entry;
     GLuint shader_id, program_id;
 
@@ -10114,9 +10546,8 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
 
     list_add_head(&shader->linked_programs, &entry->cs.shader_entry);
 
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    memset(&link_args, 0, sizeof(link_args));
+    shader_glsl_link_program(priv, gl_info, program_id, &link_args);
 
     GL_EXTCALL(glUseProgram(program_id));
     checkGLcall("glUseProgram");
@@ -10199,6 +10630,7 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
     struct list *ps_list, *vs_list;
     WORD attribs_map;
     struct wined3d_string_buffer *tmp_name;
+    struct glsl_program_link_args link_args;
 
     if (!(context_gl->c.shader_update_mask & (1u << WINED3D_SHADER_TYPE_VERTEX)) && ctx_data->glsl_program)
     {
@@ -10446,10 +10878,13 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
         list_add_head(ps_list, &entry->ps.shader_entry);
     }
 
-    /* Link the program */
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    /* Link the program. Transform feedback varyings are not part of the
+     * shader sources, so don't try to cache programs using them. */
+    link_args.attribs_map = vshader ? vshader->reg_maps.input_registers : (1u << WINED3D_FFP_ATTRIBS_COUNT) - 1;
+    link_args.vs_major = vshader ? vshader->reg_maps.shader_version.major : 0;
+    link_args.dual_source = state->blend_state && state->blend_state->dual_source;
+    shader_glsl_link_program(priv, gl_info, program_id,
+            gshader && gshader->u.gs.so_desc.element_count ? NULL : &link_args);
 
     shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
             vshader ? vshader->limits->constant_float : 0);
@@ -10605,15 +11040,52 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
 
 static void shader_glsl_precompile(void *shader_priv, struct wined3d_shader *shader)
 {
+    const struct wined3d_shader_version *version = &shader->reg_maps.shader_version;
+    const struct ps_np2fixup_info *np2fixup_info;
     struct wined3d_device *device = shader->device;
+    struct shader_glsl_priv *priv = shader_priv;
+    struct ps_compile_args ps_compile_args;
+    struct wined3d_context_gl *context_gl;
     struct wined3d_context *context;
+    struct wined3d_state *state;
 
-    if (shader->reg_maps.shader_version.type == WINED3D_SHADER_TYPE_COMPUTE)
+    if (version->type == WINED3D_SHADER_TYPE_COMPUTE)
     {
         context = context_acquire(device, NULL, 0);
         shader_glsl_compile_compute_shader(shader_priv, wined3d_context_gl(context), shader);
         context_release(context);
+        return;
+    }
+
+    /* Translate and submit shaders for compilation when they are created,
+     * instead of at the first draw using them. With ARB_parallel_shader_compile
+     * the driver compiles them in the background, and the draw only has to
+     * wait if compilation isn't done yet. The compile arguments of the other
+     * stages depend on the shaders they are linked with, so only do this for
+     * hull shaders and SM4+ pixel shaders. */
+    if (version->major < 4 || (version->type != WINED3D_SHADER_TYPE_PIXEL
+            && version->type != WINED3D_SHADER_TYPE_HULL))
+        return;
+
+    context = context_acquire(device, NULL, 0);
+    context_gl = wined3d_context_gl(context);
+    if (version->type == WINED3D_SHADER_TYPE_HULL)
+    {
+        find_glsl_hull_shader(context_gl, priv, shader);
+    }
+    else if ((state = heap_alloc_zero(sizeof(*state))))
+    {
+        /* The state the shader will be drawn with isn't known yet, so build
+         * the arguments from the default state. SM4+ pixel shaders are always
+         * fed by a vertex or geometry shader. */
+        state_init(state, context->d3d_info, WINED3D_STATE_NO_REF | WINED3D_STATE_INIT_DEFAULT);
+        find_ps_compile_args(state, shader, FALSE, &ps_compile_args, context);
+        ps_compile_args.vp_mode = WINED3D_VP_MODE_SHADER;
+        find_glsl_fragment_shader(context_gl, &priv->shader_buffer, &priv->string_buffers,
+                shader, &ps_compile_args, &np2fixup_info);
+        heap_free(state);
     }
+    context_release(context);
 }
 
 /* Context activation is done by the caller. */
@@ -11069,6 +11541,12 @@ static void shader_glsl_free(struct wined3d_device *device, struct wined3d_conte
 {
     struct shader_glsl_priv *priv = device->shader_priv;
 
+    if (priv->program_cache.path)
+        TRACE_(d3d_perf)("Program binary cache: %u hits, %u misses, %u stored.\n",
+                priv->program_cache.hits, priv->program_cache.misses, priv->program_cache.stores);
+    heap_free(priv->program_cache.path);
+    heap_free(priv->pending_info_logs);
+
     wine_rb_destroy(&priv->program_lookup, NULL, NULL);
     constant_heap_free(&priv->pconst_heap);
     constant_heap_free(&priv->vconst_heap);
@@ -11105,6 +11583,13 @@ static void shader_glsl_init_context_state(struct wined3d_context *context)
 
     gl_info->gl_ops.gl.p_glEnable(GL_PROGRAM_POINT_SIZE);
     checkGLcall("GL_PROGRAM_POINT_SIZE");
+
+    /* Let the driver compile shaders on as many threads as it likes. */
+    if (gl_info->supported[ARB_PARALLEL_SHADER_COMPILE])
+    {
+        GL_EXTCALL(glMaxShaderCompilerThreadsARB(~0u));
+        checkGLcall("glMaxShaderCompilerThreadsARB");
+    }
 }
 
 static unsigned int shader_glsl_get_shader_model(const struct wined3d_gl_info *gl_info)
@@ -2459,14 +2459,15 @@ static void wined3d_texture_gl_upload_data(struct wined3d_context *context,
         for (z = 0; z < update_d; ++z, src_mem += src_slice_pitch)
         {
             if (decompress)
-                compressed_format->decompress(src_mem, converted_mem, src_row_pitch, src_slice_pitch,
-                        dst_row_pitch, dst_slice_pitch, update_w, update_h, 1);
+                wined3d_format_convert_slice(compressed_format, compressed_format->decompress, src_mem,
+                        converted_mem, src_row_pitch, src_slice_pitch, dst_row_pitch, dst_slice_pitch,
+                        update_w, update_h);
             else if (alpha_fixup_format_id != WINED3DFMT_UNKNOWN)
                 wined3d_fixup_alpha(src_format, src_mem, src_row_pitch, converted_mem, dst_row_pitch,
                         update_w, update_h);
             else
-                src_format->upload(src_mem, converted_mem, src_row_pitch, src_slice_pitch,
-                        dst_row_pitch, dst_slice_pitch, update_w, update_h, 1);
+                wined3d_format_convert_slice(src_format, src_format->upload, src_mem, converted_mem,
+                        src_row_pitch, src_slice_pitch, dst_row_pitch, dst_slice_pitch, update_w, update_h);
 
             wined3d_texture_gl_upload_bo(src_format, target, level, dst_row_pitch, dst_x, dst_y,
                     dst_z + z, update_w, update_h, 1, converted_mem, srgb, dst_texture, gl_info);
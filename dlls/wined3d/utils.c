@@ -427,28 +427,30 @@ static void decompress_dxtn_block(const BYTE *src, BYTE *dst, unsigned int width
         unsigned int height, unsigned int dst_row_pitch, enum wined3d_format_id format_id)
 {
     const UINT64 *s = (const UINT64 *)src;
-    BOOL bc1_alpha = FALSE;
-    DWORD colour_table[4];
+    DWORD colour_table[4], alpha[16];
     BYTE alpha_table[8];
     UINT64 alpha_bits;
     DWORD colour_bits;
     unsigned int x, y;
-    BYTE colour_idx;
     DWORD *dst_row;
-    BYTE alpha;
 
+    /* Resolve the per-format work once per block, so that the pixel loop
+     * below is just two table lookups. */
     if (format_id == WINED3DFMT_BC1_UNORM)
     {
         WORD colour0, colour1;
 
-        alpha_bits = 0;
-
         colour0 = s[0] & 0xffff;
         colour1 = (s[0] >> 16) & 0xffff;
         colour_bits = (s[0] >> 32) & 0xffffffff;
         build_dxtn_colour_table(colour0, colour1, colour_table, format_id);
+        for (x = 0; x < 4; ++x)
+        {
+            colour_table[x] |= 0xff000000;
+        }
         if (colour0 <= colour1)
-            bc1_alpha = TRUE;
+            colour_table[3] = 0x00000000;
+        memset(alpha, 0, sizeof(alpha));
     }
     else
     {
@@ -457,39 +459,43 @@ static void decompress_dxtn_block(const BYTE *src, BYTE *dst, unsigned int width
         {
             build_bc3_alpha_table(alpha_bits & 0xff, (alpha_bits >> 8) & 0xff, alpha_table);
             alpha_bits >>= 16;
+            for (x = 0; x < 16; ++x, alpha_bits >>= 3)
+            {
+                alpha[x] = (DWORD)alpha_table[alpha_bits & 0x7] << 24;
+            }
+        }
+        else
+        {
+            for (x = 0; x < 16; ++x, alpha_bits >>= 4)
+            {
+                /* (2⁸ - 1) / (2⁴ - 1) ≈ 2⁸ / 2⁴ + 2⁸ / 2⁸ */
+                alpha[x] = (alpha_bits & 0xf) * 0x11000000u;
+            }
         }
 
         colour_bits = (s[1] >> 32) & 0xffffffff;
         build_dxtn_colour_table(s[1] & 0xffff, (s[1] >> 16) & 0xffff, colour_table, format_id);
     }
 
+    if (width == 4 && height == 4)
+    {
+        for (y = 0; y < 4; ++y, colour_bits >>= 8)
+        {
+            dst_row = (DWORD *)&dst[y * dst_row_pitch];
+            dst_row[0] = alpha[y * 4 + 0] | colour_table[colour_bits & 0x3];
+            dst_row[1] = alpha[y * 4 + 1] | colour_table[(colour_bits >> 2) & 0x3];
+            dst_row[2] = alpha[y * 4 + 2] | colour_table[(colour_bits >> 4) & 0x3];
+            dst_row[3] = alpha[y * 4 + 3] | colour_table[(colour_bits >> 6) & 0x3];
+        }
+        return;
+    }
+
     for (y = 0; y < height; ++y)
     {
         dst_row = (DWORD *)&dst[y * dst_row_pitch];
         for (x = 0; x < width; ++x)
         {
-            colour_idx = (colour_bits >> (y * 8 + x * 2)) & 0x3;
-            switch (format_id)
-            {
-                case WINED3DFMT_BC1_UNORM:
-                    alpha = bc1_alpha && colour_idx == 3 ? 0x00 : 0xff;
-                    break;
-
-                case WINED3DFMT_BC2_UNORM:
-                    alpha = (alpha_bits >> (y * 16 + x * 4)) & 0xf;
-                    /* (2⁸ - 1) / (2⁴ - 1) ≈ 2⁸ / 2⁴ + 2⁸ / 2⁸ */
-                    alpha |= alpha << 4;
-                    break;
-
-                case WINED3DFMT_BC3_UNORM:
-                    alpha = alpha_table[(alpha_bits >> (y * 12 + x * 3)) & 0x7];
-                    break;
-
-                default:
-                    alpha = 0xff;
-                    break;
-            }
-            dst_row[x] = (alpha << 24) | colour_table[colour_idx];
+            dst_row[x] = alpha[y * 4 + x] | colour_table[(colour_bits >> (y * 8 + x * 2)) & 0x3];
         }
     }
 }
@@ -4310,6 +4316,71 @@ void wined3d_format_calculate_pitch(const struct wined3d_format *format, unsigne
     TRACE("Returning row pitch %u, slice pitch %u.\n", *row_pitch, *slice_pitch);
 }
 
+struct wined3d_format_convert_job
+{
+    void (*convert)(const BYTE *src, BYTE *dst, unsigned int src_row_pitch, unsigned int src_slice_pitch,
+            unsigned int dst_row_pitch, unsigned int dst_slice_pitch,
+            unsigned int width, unsigned int height, unsigned int depth);
+    const BYTE *src;
+    BYTE *dst;
+    unsigned int src_row_pitch, src_slice_pitch;
+    unsigned int dst_row_pitch, dst_slice_pitch;
+    unsigned int width, height;
+    unsigned int block_height;
+    unsigned int chunk_height;
+};
+
+static void wined3d_format_convert_chunk(void *ctx, unsigned int chunk)
+{
+    const struct wined3d_format_convert_job *job = ctx;
+    unsigned int y = chunk * job->chunk_height;
+
+    job->convert(job->src + (y / job->block_height) * job->src_row_pitch, job->dst + y * job->dst_row_pitch,
+            job->src_row_pitch, job->src_slice_pitch, job->dst_row_pitch, job->dst_slice_pitch,
+            job->width, min(job->chunk_height, job->height - y), 1);
+}
+
+/* Run an upload or decompression function over a single slice. Large slices
+ * are split into bands of rows, which are converted in parallel on the
+ * thread pool. */
+void wined3d_format_convert_slice(const struct wined3d_format *format,
+        void (*convert)(const BYTE *src, BYTE *dst, unsigned int src_row_pitch, unsigned int src_slice_pitch,
+        unsigned int dst_row_pitch, unsigned int dst_slice_pitch,
+        unsigned int width, unsigned int height, unsigned int depth),
+        const BYTE *src, BYTE *dst, unsigned int src_row_pitch, unsigned int src_slice_pitch,
+        unsigned int dst_row_pitch, unsigned int dst_slice_pitch, unsigned int width, unsigned int height)
+{
+    struct wined3d_format_convert_job job;
+    unsigned int thread_count, chunk_count;
+
+    if (width * height < WINED3D_CONVERT_PARALLEL_MIN_PIXELS
+            || (format->flags[WINED3D_GL_RES_TYPE_TEX_2D] & WINED3DFMT_FLAG_HEIGHT_SCALE)
+            || (thread_count = wine_parallel_thread_count(WINED3D_CONVERT_MAX_THREADS)) < 2)
+    {
+        convert(src, dst, src_row_pitch, src_slice_pitch, dst_row_pitch, dst_slice_pitch, width, height, 1);
+        return;
+    }
+
+    job.convert = convert;
+    job.src = src;
+    job.dst = dst;
+    job.src_row_pitch = src_row_pitch;
+    job.src_slice_pitch = src_slice_pitch;
+    job.dst_row_pitch = dst_row_pitch;
+    job.dst_slice_pitch = dst_slice_pitch;
+    job.width = width;
+    job.height = height;
+    job.block_height = format->block_height;
+    chunk_count = thread_count * WINE_PARALLEL_ITEMS_PER_THREAD;
+    job.chunk_height = (height + chunk_count - 1) / chunk_count;
+    job.chunk_height = (job.chunk_height + job.block_height - 1) / job.block_height * job.block_height;
+    chunk_count = (height + job.chunk_height - 1) / job.chunk_height;
+
+    TRACE("Converting %ux%u slice in %u bands of %u rows.\n", width, height, chunk_count, job.chunk_height);
+
+    wine_parallel_for(chunk_count, thread_count, wined3d_format_convert_chunk, &job);
+}
+
 UINT wined3d_format_calculate_size(const struct wined3d_format *format, UINT alignment,
         UINT width, UINT height, UINT depth)
 {
@@ -57,6 +57,7 @@
 #include "wined3d_gl.h"
 #include "wined3d_vk.h"
 #include "wine/list.h"
+#include "wine/parallel.h"
 #include "wine/rbtree.h"
 #include "wine/wgl_driver.h"
 
@@ -437,6 +438,7 @@ struct wined3d_settings
     unsigned int max_sm_gs;
     unsigned int max_sm_ps;
     unsigned int max_sm_cs;
+    unsigned int shader_cache_size;
     enum wined3d_renderer renderer;
     enum wined3d_shader_backend shader_backend;
 };
@@ -1553,6 +1555,7 @@ struct wined3d_bo_vk
     VkBuffer vk_buffer;
     struct wined3d_allocator_block *memory;
     struct wined3d_bo_slab_vk *slab;
+    uint64_t ring_allocation_id;
 
     VkDeviceMemory vk_memory;
     void *map_ptr;
@@ -1584,6 +1587,40 @@ struct wined3d_bo_slab_vk
     uint32_t map;
 };
 
+#define WINED3D_BO_RING_VK_SIZE 0x800000
+#define WINED3D_BO_RING_VK_USAGE (VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT \
+        | VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT \
+        | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT \
+        | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT)
+
+struct wined3d_bo_ring_allocation_vk
+{
+    uint64_t id;
+    VkDeviceSize start, end;
+    uint64_t command_buffer_id;
+    bool released;
+};
+
+struct wined3d_bo_ring_vk
+{
+    struct wined3d_bo_vk bo;
+    VkDeviceSize head;
+
+    /* Sorted by start offset. */
+    struct wined3d_bo_ring_allocation_vk *allocations;
+    SIZE_T allocations_size;
+    SIZE_T allocation_count;
+    uint64_t next_allocation_id;
+};
+
+struct wined3d_bo_stream_stats_vk
+{
+    uint64_t bytes_streamed;
+    unsigned int allocations;
+    unsigned int fallbacks;
+    unsigned int stalls;
+};
+
 struct wined3d_bo_address
 {
     UINT_PTR buffer_object;
@@ -2508,6 +2545,9 @@ struct wined3d_context_vk
     struct wine_rb_tree pipeline_layouts;
     struct wine_rb_tree graphics_pipelines;
     struct wine_rb_tree bo_slab_available;
+    struct wined3d_bo_ring_vk *bo_ring;
+    bool bo_ring_failed;
+    struct wined3d_bo_stream_stats_vk stream_stats;
 };
 
 static inline struct wined3d_context_vk *wined3d_context_vk(struct wined3d_context *context)
@@ -2515,6 +2555,8 @@ static inline struct wined3d_context_vk *wined3d_context_vk(struct wined3d_conte
     return CONTAINING_RECORD(context, struct wined3d_context_vk, c);
 }
 
+void *wined3d_bo_vk_map(struct wined3d_bo_vk *bo, struct wined3d_context_vk *context_vk) DECLSPEC_HIDDEN;
+
 void wined3d_context_vk_accumulate_pending_queries(struct wined3d_context_vk *context_vk) DECLSPEC_HIDDEN;
 void wined3d_context_vk_add_pending_query(struct wined3d_context_vk *context_vk,
         struct wined3d_query_vk *query_vk) DECLSPEC_HIDDEN;
@@ -2531,6 +2573,8 @@ VkCommandBuffer wined3d_context_vk_apply_draw_state(struct wined3d_context_vk *c
 void wined3d_context_vk_cleanup(struct wined3d_context_vk *context_vk) DECLSPEC_HIDDEN;
 BOOL wined3d_context_vk_create_bo(struct wined3d_context_vk *context_vk, VkDeviceSize size,
         VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_type, struct wined3d_bo_vk *bo) DECLSPEC_HIDDEN;
+bool wined3d_context_vk_create_ring_bo(struct wined3d_context_vk *context_vk, VkDeviceSize size,
+        VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_type, struct wined3d_bo_vk *bo) DECLSPEC_HIDDEN;
 void wined3d_context_vk_destroy_allocator_block(struct wined3d_context_vk *context_vk,
         struct wined3d_allocator_block *block, uint64_t command_buffer_id) DECLSPEC_HIDDEN;
 void wined3d_context_vk_destroy_bo(struct wined3d_context_vk *context_vk,
@@ -4539,12 +4583,42 @@ enum wined3d_push_constants
 
 #define WINED3D_CS_QUERY_POLL_INTERVAL  10u
 #define WINED3D_CS_QUEUE_SIZE           0x100000u
+#define WINED3D_CS_QUEUE_MAX_SIZE       0x2000000u
+#define WINED3D_CS_QUEUE_GROW_STALLS    8u
+#define WINED3D_CS_QUEUE_STALL_GAP      16u
+#define WINED3D_CS_QUEUE_STALL_INTERVAL 1000u
+#define WINED3D_CS_QUEUE_SHRINK_DELAY   10000u
 #define WINED3D_CS_SPIN_COUNT           10000000u
+#define WINED3D_CS_SPIN_COUNT_MIN       0x1000u
+#define WINED3D_CS_WAIT_SPIN_COUNT      0x1000u
+#define WINED3D_CS_UPDATE_COPY_SIZE     0x40000u
+#define WINED3D_CS_STATS_INTERVAL       1500u
 
 struct wined3d_cs_queue
 {
     LONG head, tail;
-    BYTE data[WINED3D_CS_QUEUE_SIZE];
+    /* The size is a power of two. It only changes while the queue is empty. */
+    SIZE_T size;
+    BYTE *data;
+    /* Stalls on a full queue, counted at most once per
+     * WINED3D_CS_QUEUE_STALL_GAP ms. Times are GetTickCount() values. */
+    unsigned int stall_count;
+    DWORD stall_start, stall_time;
+    DWORD resize_time;
+};
+
+/* Collected when the "d3d_perf" debug channel is enabled. Times are in
+ * performance counter ticks. */
+struct wined3d_cs_stats
+{
+    LONG64 producer_stall_time;
+    LONG64 consumer_idle_time;
+    LONG64 idle_start;
+    SIZE_T max_queue_depth;
+    unsigned int packet_count;
+    unsigned int sleep_count;
+    unsigned int grow_count;
+    DWORD prev_time;
 };
 
 struct wined3d_cs_ops
@@ -4571,9 +4645,13 @@ struct wined3d_cs
     struct list query_poll_list;
     BOOL queries_flushed;
 
-    HANDLE event;
-    BOOL waiting_for_event;
+    LONG waiting_for_event;
+    LONG waiting_for_space;
+    unsigned int spin_limit;
     LONG pending_presents;
+
+    BOOL collect_stats;
+    struct wined3d_cs_stats stats;
 };
 
 struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device) DECLSPEC_HIDDEN;
@@ -5038,6 +5116,8 @@ struct wined3d_swapchain_ops
     void (*swapchain_frontbuffer_updated)(struct wined3d_swapchain *swapchain);
 };
 
+#define WINED3D_FRAME_TIME_SAMPLES 512
+
 struct wined3d_swapchain
 {
     LONG ref;
@@ -5057,6 +5137,9 @@ struct wined3d_swapchain
     unsigned int max_frame_latency;
 
     LONG prev_time, frames;   /* Performance tracking */
+    LARGE_INTEGER prev_present;
+    unsigned int frame_time_count;
+    float frame_times[WINED3D_FRAME_TIME_SAMPLES];
 
     struct wined3d_swapchain_state state;
     HWND win_handle;
@@ -5601,12 +5684,22 @@ struct wined3d_format
     enum wined3d_format_id typeless_id;
 };
 
+#define WINED3D_CONVERT_PARALLEL_MIN_PIXELS 0x40000
+#define WINED3D_CONVERT_MAX_THREADS 8
+
 const struct wined3d_format *wined3d_get_format(const struct wined3d_adapter *adapter,
         enum wined3d_format_id format_id, unsigned int bind_flags) DECLSPEC_HIDDEN;
 void wined3d_format_calculate_pitch(const struct wined3d_format *format, unsigned int alignment,
         unsigned int width, unsigned int height, unsigned int *row_pitch, unsigned int *slice_pitch) DECLSPEC_HIDDEN;
 UINT wined3d_format_calculate_size(const struct wined3d_format *format,
         UINT alignment, UINT width, UINT height, UINT depth) DECLSPEC_HIDDEN;
+void wined3d_format_convert_slice(const struct wined3d_format *format,
+        void (*convert)(const BYTE *src, BYTE *dst, unsigned int src_row_pitch, unsigned int src_slice_pitch,
+        unsigned int dst_row_pitch, unsigned int dst_slice_pitch,
+        unsigned int width, unsigned int height, unsigned int depth),
+        const BYTE *src, BYTE *dst, unsigned int src_row_pitch, unsigned int src_slice_pitch,
+        unsigned int dst_row_pitch, unsigned int dst_slice_pitch,
+        unsigned int width, unsigned int height) DECLSPEC_HIDDEN;
 DWORD wined3d_format_convert_from_float(const struct wined3d_format *format,
         const struct wined3d_color *color) DECLSPEC_HIDDEN;
 void wined3d_format_copy_data(const struct wined3d_format *format, const uint8_t *src,
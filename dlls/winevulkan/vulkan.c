@@ -217,20 +217,8 @@ static struct VkQueue_T *wine_vk_device_alloc_queues(struct VkDevice_T *device,
     return queues;
 }
 
-static void wine_vk_device_free_create_info(VkDeviceCreateInfo *create_info)
-{
-    VkDeviceGroupDeviceCreateInfo *group_info;
-
-    if ((group_info = wine_vk_find_struct(create_info, DEVICE_GROUP_DEVICE_CREATE_INFO)))
-    {
-        heap_free((void *)group_info->pPhysicalDevices);
-    }
-
-    free_VkDeviceCreateInfo_struct_chain(create_info);
-}
-
-static VkResult wine_vk_device_convert_create_info(const VkDeviceCreateInfo *src,
-        VkDeviceCreateInfo *dst)
+static VkResult wine_vk_device_convert_create_info(struct conversion_context *ctx,
+        const VkDeviceCreateInfo *src, VkDeviceCreateInfo *dst)
 {
     VkDeviceGroupDeviceCreateInfo *group_info;
     unsigned int i;
@@ -238,7 +226,7 @@ static VkResult wine_vk_device_convert_create_info(const VkDeviceCreateInfo *src
 
     *dst = *src;
 
-    if ((res = convert_VkDeviceCreateInfo_struct_chain(src->pNext, dst)) < 0)
+    if ((res = convert_VkDeviceCreateInfo_struct_chain(ctx, src->pNext, dst)) < 0)
     {
         WARN("Failed to convert VkDeviceCreateInfo pNext chain, res=%d.\n", res);
         return res;
@@ -249,11 +237,9 @@ static VkResult wine_vk_device_convert_create_info(const VkDeviceCreateInfo *src
     {
         VkPhysicalDevice *physical_devices;
 
-        if (!(physical_devices = heap_calloc(group_info->physicalDeviceCount, sizeof(*physical_devices))))
-        {
-            free_VkDeviceCreateInfo_struct_chain(dst);
+        if (!(physical_devices = conversion_context_alloc(ctx,
+                group_info->physicalDeviceCount * sizeof(*physical_devices))))
             return VK_ERROR_OUT_OF_HOST_MEMORY;
-        }
         for (i = 0; i < group_info->physicalDeviceCount; ++i)
         {
             physical_devices[i] = group_info->pPhysicalDevices[i]->phys_dev;
@@ -273,7 +259,6 @@ static VkResult wine_vk_device_convert_create_info(const VkDeviceCreateInfo *src
         if (!wine_vk_device_extension_supported(extension_name))
         {
             WARN("Extension %s is not supported.\n", debugstr_a(extension_name));
-            wine_vk_device_free_create_info(dst);
             return VK_ERROR_EXTENSION_NOT_PRESENT;
         }
     }
@@ -334,15 +319,15 @@ static void wine_vk_init_once(void)
  * This function takes care of extensions handled at winevulkan layer, a Wine graphics
  * driver is responsible for handling e.g. surface extensions.
  */
-static VkResult wine_vk_instance_convert_create_info(const VkInstanceCreateInfo *src,
-        VkInstanceCreateInfo *dst, struct VkInstance_T *object)
+static VkResult wine_vk_instance_convert_create_info(struct conversion_context *ctx,
+        const VkInstanceCreateInfo *src, VkInstanceCreateInfo *dst, struct VkInstance_T *object)
 {
     unsigned int i;
     VkResult res;
 
     *dst = *src;
 
-    if ((res = convert_VkInstanceCreateInfo_struct_chain(src->pNext, dst)) < 0)
+    if ((res = convert_VkInstanceCreateInfo_struct_chain(ctx, src->pNext, dst)) < 0)
     {
         WARN("Failed to convert VkInstanceCreateInfo pNext chain, res=%d.\n", res);
         return res;
@@ -368,7 +353,6 @@ static VkResult wine_vk_instance_convert_create_info(const VkInstanceCreateInfo
         if (!wine_vk_instance_extension_supported(extension_name))
         {
             WARN("Extension %s is not supported.\n", debugstr_a(extension_name));
-            free_VkInstanceCreateInfo_struct_chain(dst);
             return VK_ERROR_EXTENSION_NOT_PRESENT;
         }
     }
@@ -564,6 +548,7 @@ VkResult WINAPI wine_vkCreateDevice(VkPhysicalDevice phys_dev,
         const VkAllocationCallbacks *allocator, VkDevice *device)
 {
     VkDeviceCreateInfo create_info_host;
+    struct conversion_context ctx;
     uint32_t max_queue_families;
     struct VkDevice_T *object;
     unsigned int i;
@@ -590,13 +575,17 @@ VkResult WINAPI wine_vkCreateDevice(VkPhysicalDevice phys_dev,
 
     object->base.loader_magic = VULKAN_ICD_MAGIC_VALUE;
 
-    res = wine_vk_device_convert_create_info(create_info, &create_info_host);
+    init_conversion_context(&ctx);
+    res = wine_vk_device_convert_create_info(&ctx, create_info, &create_info_host);
     if (res != VK_SUCCESS)
+    {
+        free_conversion_context(&ctx);
         goto fail;
+    }
 
     res = phys_dev->instance->funcs.p_vkCreateDevice(phys_dev->phys_dev,
             &create_info_host, NULL /* allocator */, &object->device);
-    wine_vk_device_free_create_info(&create_info_host);
+    free_conversion_context(&ctx);
     if (res != VK_SUCCESS)
     {
         WARN("Failed to create device, res=%d.\n", res);
@@ -659,6 +648,7 @@ VkResult WINAPI wine_vkCreateInstance(const VkInstanceCreateInfo *create_info,
         const VkAllocationCallbacks *allocator, VkInstance *instance)
 {
     VkInstanceCreateInfo create_info_host;
+    struct conversion_context ctx;
     const VkApplicationInfo *app_info;
     struct VkInstance_T *object;
     VkResult res;
@@ -679,15 +669,17 @@ VkResult WINAPI wine_vkCreateInstance(const VkInstanceCreateInfo *create_info,
     }
     object->base.loader_magic = VULKAN_ICD_MAGIC_VALUE;
 
-    res = wine_vk_instance_convert_create_info(create_info, &create_info_host, object);
+    init_conversion_context(&ctx);
+    res = wine_vk_instance_convert_create_info(&ctx, create_info, &create_info_host, object);
     if (res != VK_SUCCESS)
     {
+        free_conversion_context(&ctx);
         wine_vk_instance_free(object);
         return res;
     }
 
     res = vk_funcs->p_vkCreateInstance(&create_info_host, NULL /* allocator */, &object->instance);
-    free_VkInstanceCreateInfo_struct_chain(&create_info_host);
+    free_conversion_context(&ctx);
     if (res != VK_SUCCESS)
     {
         ERR("Failed to create instance, res=%d\n", res);
@@ -1061,6 +1053,7 @@ VkResult WINAPI wine_vkQueueSubmit(VkQueue queue, uint32_t count,
     VkSubmitInfo *submits_host;
     VkResult res;
     VkCommandBuffer *command_buffers;
+    struct conversion_context ctx;
     unsigned int i, j, num_command_buffers;
 
     TRACE("%p %u %p 0x%s\n", queue, count, submits, wine_dbgstr_longlong(fence));
@@ -1070,11 +1063,13 @@ VkResult WINAPI wine_vkQueueSubmit(VkQueue queue, uint32_t count,
         return queue->device->funcs.p_vkQueueSubmit(queue->queue, 0, NULL, fence);
     }
 
-    submits_host = heap_calloc(count, sizeof(*submits_host));
-    if (!submits_host)
+    init_conversion_context(&ctx);
+
+    if (!(submits_host = conversion_context_alloc(&ctx, count * sizeof(*submits_host))))
     {
         ERR("Unable to allocate memory for submit buffers!\n");
-        return VK_ERROR_OUT_OF_HOST_MEMORY;
+        res = VK_ERROR_OUT_OF_HOST_MEMORY;
+        goto done;
     }
 
     for (i = 0; i < count; i++)
@@ -1082,7 +1077,7 @@ VkResult WINAPI wine_vkQueueSubmit(VkQueue queue, uint32_t count,
         memcpy(&submits_host[i], &submits[i], sizeof(*submits_host));
 
         num_command_buffers = submits[i].commandBufferCount;
-        command_buffers = heap_calloc(num_command_buffers, sizeof(*submits_host));
+        command_buffers = conversion_context_alloc(&ctx, num_command_buffers * sizeof(*command_buffers));
         if (!command_buffers)
         {
             ERR("Unable to allocate memory for command buffers!\n");
@@ -1100,11 +1095,7 @@ VkResult WINAPI wine_vkQueueSubmit(VkQueue queue, uint32_t count,
     res = queue->device->funcs.p_vkQueueSubmit(queue->queue, count, submits_host, fence);
 
 done:
-    for (i = 0; i < count; i++)
-    {
-        heap_free((void *)submits_host[i].pCommandBuffers);
-    }
-    heap_free(submits_host);
+    free_conversion_context(&ctx);
 
     TRACE("Returning %d\n", res);
     return res;
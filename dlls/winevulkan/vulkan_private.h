@@ -132,6 +132,53 @@ static inline VkCommandPool wine_cmd_pool_to_handle(struct wine_cmd_pool *cmd_po
     return (VkCommandPool)(uintptr_t)cmd_pool;
 }
 
+/* Scratch memory for the structure conversions done by thunks. Each thunk
+ * keeps a context on its stack and releases it on return, so conversions
+ * only reach the heap when they don't fit in the inline buffer. */
+struct conversion_context
+{
+    char DECLSPEC_ALIGN(8) buffer[2048];
+    uint32_t used;
+    struct list alloc_entries;
+};
+
+static inline void init_conversion_context(struct conversion_context *pool)
+{
+    pool->used = 0;
+    list_init(&pool->alloc_entries);
+}
+
+static inline void free_conversion_context(struct conversion_context *pool)
+{
+    struct list *entry, *next;
+
+    LIST_FOR_EACH_SAFE(entry, next, &pool->alloc_entries)
+    {
+        heap_free(entry);
+    }
+}
+
+static inline void *conversion_context_alloc(struct conversion_context *pool, size_t size)
+{
+    struct list *entry;
+    void *ret;
+
+    if (size <= sizeof(pool->buffer) - pool->used)
+    {
+        ret = pool->buffer + pool->used;
+        pool->used += (size + 7) & ~7;
+        return ret;
+    }
+
+    /* The list entry is 8 bytes on the 32-bit targets that need conversion,
+     * which keeps the returned memory suitably aligned for 64-bit members. */
+    if (!(entry = heap_alloc(sizeof(*entry) + size)))
+        return NULL;
+    list_add_tail(&pool->alloc_entries, entry);
+
+    return entry + 1;
+}
+
 void *wine_vk_get_device_proc_addr(const char *name) DECLSPEC_HIDDEN;
 void *wine_vk_get_instance_proc_addr(const char *name) DECLSPEC_HIDDEN;
 
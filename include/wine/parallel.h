@@ -0,0 +1,98 @@
+/*
+ * Helpers for splitting work across the thread pool
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef __WINE_WINE_PARALLEL_H
+#define __WINE_WINE_PARALLEL_H
+
+#include <windef.h>
+#include <winbase.h>
+
+/* Work is split into a few items per thread, to even out scheduling
+ * differences between the threads. */
+#define WINE_PARALLEL_ITEMS_PER_THREAD 4
+
+struct wine_parallel_job
+{
+    void (*run)(void *ctx, unsigned int index);
+    void *ctx;
+    unsigned int count;
+    LONG next;
+};
+
+/* Returns the number of threads to use for a job, at most max_threads. */
+static inline unsigned int wine_parallel_thread_count(unsigned int max_threads)
+{
+    static LONG cpu_count;
+    SYSTEM_INFO info;
+    LONG count;
+
+    if (!(count = cpu_count))
+    {
+        GetSystemInfo(&info);
+        count = info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+        InterlockedExchange(&cpu_count, count);
+    }
+
+    return (unsigned int)count < max_threads ? count : max_threads;
+}
+
+static inline void wine_parallel_job_run(struct wine_parallel_job *job)
+{
+    unsigned int index;
+
+    while ((index = InterlockedIncrement(&job->next) - 1) < job->count)
+        job->run(job->ctx, index);
+}
+
+static inline void CALLBACK wine_parallel_work(TP_CALLBACK_INSTANCE *instance, void *ctx, TP_WORK *work)
+{
+    wine_parallel_job_run(ctx);
+}
+
+/* Calls run(ctx, i) for each i in [0, count), on up to thread_count threads.
+ * The calling thread takes part as well, so this completes even if the pool
+ * is busy, and everything runs on the calling thread if no work object can
+ * be created. Returns once all calls have completed. */
+static inline void wine_parallel_for(unsigned int count, unsigned int thread_count,
+        void (*run)(void *ctx, unsigned int index), void *ctx)
+{
+    struct wine_parallel_job job;
+    TP_WORK *work = NULL;
+    unsigned int i;
+
+    job.run = run;
+    job.ctx = ctx;
+    job.count = count;
+    job.next = 0;
+
+    if (thread_count > count)
+        thread_count = count;
+    if (thread_count < 2 || !(work = CreateThreadpoolWork(wine_parallel_work, &job, NULL)))
+    {
+        wine_parallel_job_run(&job);
+        return;
+    }
+
+    for (i = 1; i < thread_count; ++i)
+        SubmitThreadpoolWork(work);
+    wine_parallel_job_run(&job);
+    WaitForThreadpoolWorkCallbacks(work, TRUE);
+    CloseThreadpoolWork(work);
+}
+
+#endif  /* __WINE_WINE_PARALLEL_H */
@@ -46,9 +46,19 @@
 struct namespace
 {
     unsigned int        hash_size;       /* size of hash table */
-    struct list         names[1];        /* array of hash entry lists */
+    unsigned int        count;           /* number of names in the table */
+    struct list        *names;           /* array of hash entry lists */
+    struct list         entry;           /* entry in the list of all namespaces */
+    unsigned int        lookups;         /* number of lookups, for statistics */
+    unsigned int        probes;          /* number of chain entries visited by lookups */
+    unsigned int        resizes;         /* number of times the table has been grown */
 };
 
+static struct list namespace_list = LIST_INIT(namespace_list);
+
+#define NAMESPACE_MAX_LOAD      2        /* grow the table above this many names per bucket */
+#define NAMESPACE_MAX_HASH_SIZE 0x100000 /* don't grow the table past this size */
+
 
 #ifdef DEBUG_OBJECTS
 static struct list object_list = LIST_INIT(object_list);
@@ -127,11 +137,40 @@ void *memdup( const void *data, size_t len )
 
 /*****************************************************************/
 
+/* grow the hash table of a namespace, rehashing the names with their stored hash */
+static void grow_namespace( struct namespace *namespace )
+{
+    unsigned int i, new_size = namespace->hash_size * 2 + 1;
+    struct object_name *ptr, *next;
+    struct list *names;
+
+    if (!(names = malloc( new_size * sizeof(*names) ))) return;  /* keep using the old table */
+    for (i = 0; i < new_size; i++) list_init( &names[i] );
+
+    for (i = 0; i < namespace->hash_size; i++)
+    {
+        LIST_FOR_EACH_ENTRY_SAFE( ptr, next, &namespace->names[i], struct object_name, entry )
+        {
+            list_remove( &ptr->entry );
+            list_add_tail( &names[ptr->hash % new_size], &ptr->entry );
+        }
+    }
+    free( namespace->names );
+    namespace->names = names;
+    namespace->hash_size = new_size;
+    namespace->resizes++;
+}
+
 void namespace_add( struct namespace *namespace, struct object_name *ptr )
 {
-    unsigned int hash = hash_strW( ptr->name, ptr->len, namespace->hash_size );
+    if (namespace->count >= namespace->hash_size * NAMESPACE_MAX_LOAD &&
+        namespace->hash_size < NAMESPACE_MAX_HASH_SIZE)
+        grow_namespace( namespace );
 
-    list_add_head( &namespace->names[hash], &ptr->entry );
+    ptr->hash = fold_hash_strW( ptr->name, ptr->len );
+    ptr->namespace = namespace;
+    list_add_head( &namespace->names[ptr->hash % namespace->hash_size], &ptr->entry );
+    namespace->count++;
 }
 
 /* allocate a name for an object */
@@ -143,6 +182,8 @@ static struct object_name *alloc_name( const struct unicode_str *name )
     {
         ptr->len = name->len;
         ptr->parent = NULL;
+        ptr->namespace = NULL;
+        ptr->hash = 0;
         memcpy( ptr->name, name->str, name->len );
     }
     return ptr;
@@ -451,19 +492,22 @@ void release_object( void *ptr )
 }
 
 /* find an object by its name; the refcount is incremented */
-struct object *find_object( const struct namespace *namespace, const struct unicode_str *name,
+struct object *find_object( struct namespace *namespace, const struct unicode_str *name,
                             unsigned int attributes )
 {
-    const struct list *list;
-    struct list *p;
+    const struct object_name *ptr;
+    unsigned int hash;
 
     if (!name || !name->len) return NULL;
 
-    list = &namespace->names[ hash_strW( name->str, name->len, namespace->hash_size ) ];
-    LIST_FOR_EACH( p, list )
+    /* the stored hash is computed on the case-folded name, so it can reject
+     * mismatches for both kinds of lookups without folding the names again */
+    hash = fold_hash_strW( name->str, name->len );
+    namespace->lookups++;
+    LIST_FOR_EACH_ENTRY( ptr, &namespace->names[hash % namespace->hash_size], const struct object_name, entry )
     {
-        const struct object_name *ptr = LIST_ENTRY( p, struct object_name, entry );
-        if (ptr->len != name->len) continue;
+        namespace->probes++;
+        if (ptr->hash != hash || ptr->len != name->len) continue;
         if (attributes & OBJ_CASE_INSENSITIVE)
         {
             if (!memicmp_strW( ptr->name, name->str, name->len ))
@@ -502,15 +546,56 @@ struct namespace *create_namespace( unsigned int hash_size )
     struct namespace *namespace;
     unsigned int i;
 
-    namespace = mem_alloc( sizeof(*namespace) + (hash_size - 1) * sizeof(namespace->names[0]) );
-    if (namespace)
+    if (!(namespace = mem_alloc( sizeof(*namespace) ))) return NULL;
+    if (!(namespace->names = mem_alloc( hash_size * sizeof(namespace->names[0]) )))
     {
-        namespace->hash_size      = hash_size;
-        for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
+        free( namespace );
+        return NULL;
     }
+    namespace->hash_size = hash_size;
+    namespace->count     = 0;
+    namespace->lookups   = 0;
+    namespace->probes    = 0;
+    namespace->resizes   = 0;
+    for (i = 0; i < hash_size; i++) list_init( &namespace->names[i] );
+    list_add_tail( &namespace_list, &namespace->entry );
     return namespace;
 }
 
+/* free a namespace; all the names must have been unlinked already */
+void free_namespace( struct namespace *namespace )
+{
+    if (!namespace) return;
+    list_remove( &namespace->entry );
+    free( namespace->names );
+    free( namespace );
+}
+
+/* dump the hash chain statistics of all the namespaces */
+void dump_namespaces(void)
+{
+    const struct namespace *namespace;
+
+    LIST_FOR_EACH_ENTRY( namespace, &namespace_list, const struct namespace, entry )
+    {
+        unsigned int i, len, used = 0, max_len = 0;
+        const struct list *p;
+
+        for (i = 0; i < namespace->hash_size; i++)
+        {
+            len = 0;
+            LIST_FOR_EACH( p, &namespace->names[i] ) len++;
+            if (len) used++;
+            if (len > max_len) max_len = len;
+        }
+        fprintf( stderr, "namespace %p: %u names in %u buckets (%u used, %u resizes), "
+                 "avg chain %.2f max %u, %u lookups avg probes %.2f\n",
+                 namespace, namespace->count, namespace->hash_size, used, namespace->resizes,
+                 used ? (double)namespace->count / used : 0.0, max_len, namespace->lookups,
+                 namespace->lookups ? (double)namespace->probes / namespace->lookups : 0.0 );
+    }
+}
+
 /* functions for unimplemented/default object operations */
 
 struct object_type *no_get_type( struct object *obj )
@@ -702,6 +787,7 @@ int no_link_name( struct object *obj, struct object_name *name, struct object *p
 void default_unlink_name( struct object *obj, struct object_name *name )
 {
     list_remove( &name->entry );
+    if (name->namespace) name->namespace->count--;
 }
 
 struct object *no_open_file( struct object *obj, unsigned int access, unsigned int sharing,
@@ -180,6 +180,7 @@ static void sighup_callback(void)
 #ifdef DEBUG_OBJECTS
     dump_objects();
 #endif
+    dump_namespaces();
 }
 
 /* SIGTERM callback */